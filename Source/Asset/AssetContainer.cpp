@@ -0,0 +1,224 @@
+﻿#include "AssetContainer.h"
+#include "../Core/Hash.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+uint32_t GetTextureRowPitch(TextureFormat format, uint32_t width)
+{
+    const uint32_t blocks = (width + 3) / 4;
+    switch (format) {
+    case TextureFormat::RGBA8Unorm:
+    case TextureFormat::R32Float:
+    case TextureFormat::D32Float:
+        return width * 4;
+    case TextureFormat::RGBA16Float:
+        return width * 8;
+    case TextureFormat::BC1Unorm:
+        return blocks * 8;
+    case TextureFormat::BC3Unorm:
+    case TextureFormat::BC7Unorm:
+        return blocks * 16;
+    }
+    return width * 4;
+}
+
+uint32_t GetTextureRowCount(TextureFormat format, uint32_t height)
+{
+    switch (format) {
+    case TextureFormat::BC1Unorm:
+    case TextureFormat::BC3Unorm:
+    case TextureFormat::BC7Unorm:
+        return (height + 3) / 4;
+    default:
+        return height;
+    }
+}
+
+void AssetContainerWriter::AddVertexBuffer(std::string_view name, const void* data, uint64_t size, uint32_t stride)
+{
+    AssetEntry entry;
+    entry.type = AssetType::VertexBuffer;
+    entry.stride = stride;
+    entry.elementCount = stride != 0 ? static_cast<uint32_t>(size / stride) : 0;
+    Add(name, entry, data, size);
+}
+
+void AssetContainerWriter::AddIndexBuffer(std::string_view name, const void* data, uint64_t size, uint32_t indexSize)
+{
+    AssetEntry entry;
+    entry.type = AssetType::IndexBuffer;
+    entry.stride = indexSize;
+    entry.elementCount = indexSize != 0 ? static_cast<uint32_t>(size / indexSize) : 0;
+    Add(name, entry, data, size);
+}
+
+void AssetContainerWriter::AddTexture(std::string_view name, const void* data, uint64_t size, uint32_t width, uint32_t height, TextureFormat format, uint32_t rowPitch, uint32_t mipCount)
+{
+    AssetEntry entry;
+    entry.type = AssetType::Texture;
+    entry.stride = rowPitch;
+    entry.elementCount = mipCount;
+    entry.width = width;
+    entry.height = height;
+    entry.format = static_cast<uint32_t>(format);
+    Add(name, entry, data, size);
+}
+
+void AssetContainerWriter::AddRaw(std::string_view name, const void* data, uint64_t size)
+{
+    Add(name, AssetEntry{}, data, size);
+}
+
+// 例外: 同じ名前（または同じハッシュ）のアセットがある場合は std::runtime_error を送出
+void AssetContainerWriter::Add(std::string_view name, const AssetEntry& entry, const void* data, uint64_t size)
+{
+    const uint64_t nameHash = HashString(name);
+    for (const PendingAsset& asset : assets) {
+        if (asset.entry.nameHash == nameHash) {
+            throw std::runtime_error("Duplicate asset name or hash: " + std::string(name));
+        }
+    }
+    PendingAsset asset;
+    asset.name = name;
+    asset.entry = entry;
+    asset.entry.nameHash = nameHash;
+    asset.entry.size = size;
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    asset.payload.assign(bytes, bytes + size);
+    assets.push_back(std::move(asset));
+}
+
+// 引数: path=出力先（既存のファイルは置き換える）
+void AssetContainerWriter::Write(const std::filesystem::path& path) const
+{
+    std::vector<const PendingAsset*> sorted;
+    for (const PendingAsset& asset : assets) {
+        sorted.push_back(&asset);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const PendingAsset* a, const PendingAsset* b) {
+        return a->entry.nameHash < b->entry.nameHash;
+    });
+
+    AssetContainerHeader header;
+    header.entryCount = static_cast<uint32_t>(sorted.size());
+    header.entryTableOffset = sizeof(AssetContainerHeader);
+    header.stringTableOffset = header.entryTableOffset + sizeof(AssetEntry) * sorted.size();
+
+    std::vector<AssetEntry> entries;
+    std::string stringTable;
+    uint64_t payloadOffset = 0;
+    for (const PendingAsset* asset : sorted) {
+        AssetEntry entry = asset->entry;
+        entry.nameOffset = static_cast<uint32_t>(stringTable.size());
+        entry.nameLength = static_cast<uint32_t>(asset->name.size());
+        stringTable += asset->name;
+        entries.push_back(entry);
+    }
+    header.stringTableSize = static_cast<uint32_t>(stringTable.size());
+    payloadOffset = AlignUp(header.stringTableOffset + stringTable.size(), ASSET_PAYLOAD_ALIGNMENT);
+    for (AssetEntry& entry : entries) {
+        entry.offset = payloadOffset;
+        payloadOffset = AlignUp(payloadOffset + entry.size, ASSET_PAYLOAD_ALIGNMENT);
+    }
+    header.fileSize = entries.empty() ? header.stringTableOffset + stringTable.size() : entries.back().offset + entries.back().size;
+
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            throw std::runtime_error("Failed to create asset container: " + tempPath.string());
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(sizeof(AssetEntry) * entries.size()));
+        file.write(stringTable.data(), static_cast<std::streamsize>(stringTable.size()));
+        uint64_t position = header.stringTableOffset + stringTable.size();
+        const char padding[ASSET_PAYLOAD_ALIGNMENT] = {};
+        for (size_t i = 0; i < entries.size(); ++i) {
+            file.write(padding, static_cast<std::streamsize>(entries[i].offset - position));
+            file.write(reinterpret_cast<const char*>(sorted[i]->payload.data()), static_cast<std::streamsize>(entries[i].size));
+            position = entries[i].offset + entries[i].size;
+        }
+        if (!file) {
+            throw std::runtime_error("Failed to write asset container: " + tempPath.string());
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error) {
+        std::filesystem::remove(tempPath, error);
+        throw std::runtime_error("Failed to replace asset container: " + path.string());
+    }
+}
+
+// ヘッダ、エントリテーブル、各エントリの名前とペイロードがファイル内に収まることを確認する
+void AssetContainer::Open(const std::filesystem::path& path)
+{
+    Close();
+    file.Open(path);
+    const uint64_t fileSize = file.GetSize();
+    AssetContainerHeader header;
+    if (fileSize < sizeof(header)) {
+        Close();
+        throw std::runtime_error("Asset container is too small: " + path.string());
+    }
+    std::memcpy(&header, file.GetData(), sizeof(header));
+    bool valid = header.magic == ASSET_CONTAINER_MAGIC && header.version == ASSET_CONTAINER_VERSION && header.fileSize == fileSize;
+    valid = valid && header.entryTableOffset % alignof(AssetEntry) == 0 && header.entryTableOffset <= fileSize &&
+            header.entryCount <= (fileSize - header.entryTableOffset) / sizeof(AssetEntry);
+    valid = valid && header.stringTableOffset <= fileSize && header.stringTableSize <= fileSize - header.stringTableOffset;
+    if (valid) {
+        entries = reinterpret_cast<const AssetEntry*>(file.GetData() + header.entryTableOffset);
+        for (uint32_t i = 0; i < header.entryCount && valid; ++i) {
+            const AssetEntry& entry = entries[i];
+            valid = entry.offset <= fileSize && entry.size <= fileSize - entry.offset &&
+                    static_cast<uint64_t>(entry.nameOffset) + entry.nameLength <= header.stringTableSize &&
+                    (i == 0 || entries[i - 1].nameHash < entry.nameHash);
+        }
+    }
+    if (!valid) {
+        Close();
+        throw std::runtime_error("Invalid asset container: " + path.string());
+    }
+    stringTable = reinterpret_cast<const char*>(file.GetData() + header.stringTableOffset);
+    entryCount = header.entryCount;
+}
+
+void AssetContainer::Close()
+{
+    file.Close();
+    entries = nullptr;
+    stringTable = nullptr;
+    entryCount = 0;
+}
+
+std::string_view AssetContainer::GetName(uint32_t index) const
+{
+    return std::string_view(stringTable + entries[index].nameOffset, entries[index].nameLength);
+}
+
+// エントリは nameHash の昇順なので二分探索する
+uint32_t AssetContainer::Find(std::string_view name) const
+{
+    const uint64_t nameHash = HashString(name);
+    const AssetEntry* end = entries + entryCount;
+    const AssetEntry* found = std::lower_bound(entries, end, nameHash, [](const AssetEntry& entry, uint64_t hash) {
+        return entry.nameHash < hash;
+    });
+    if (found == end || found->nameHash != nameHash) {
+        return INVALID_ASSET_INDEX;
+    }
+    const uint32_t index = static_cast<uint32_t>(found - entries);
+    return GetName(index) == name ? index : INVALID_ASSET_INDEX;
+}
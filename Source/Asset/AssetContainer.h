@@ -0,0 +1,120 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../Core/MappedFile.h"
+#include "../Render/CommandList.h"
+
+// アセットコンテナのファイル形式（リトルエンディアン）。
+//   AssetContainerHeader
+//   AssetEntry[entryCount]（nameHash の昇順）
+//   名前の文字列テーブル（終端なし）
+//   ペイロード（ASSET_PAYLOAD_ALIGNMENT 境界に配置）
+// ペイロードはページ境界に並ぶため、マップしたアドレスをそのままアップロードのコピー元にできる。
+
+constexpr uint32_t ASSET_CONTAINER_MAGIC = 0x54535341; // "ASST"
+constexpr uint32_t ASSET_CONTAINER_VERSION = 1;
+constexpr uint64_t ASSET_PAYLOAD_ALIGNMENT = 4096;
+constexpr uint32_t INVALID_ASSET_INDEX = UINT32_MAX;
+
+enum class AssetType : uint32_t {
+    VertexBuffer, // stride = 頂点のバイト数、elementCount = 頂点数
+    IndexBuffer,  // stride = インデックスのバイト数（2 か 4）、elementCount = インデックス数
+    Texture,      // stride = 最上位のミップの行ピッチ、elementCount = ミップ数、width/height/format（ミップは最上位から順に詰めて格納）
+    Raw,
+};
+
+struct AssetContainerHeader {
+    uint32_t magic = ASSET_CONTAINER_MAGIC;
+    uint32_t version = ASSET_CONTAINER_VERSION;
+    uint32_t entryCount = 0;
+    uint32_t stringTableSize = 0;
+    uint64_t entryTableOffset = 0;
+    uint64_t stringTableOffset = 0;
+    uint64_t fileSize = 0;
+};
+
+struct AssetEntry {
+    uint64_t nameHash = 0; // HashString(name)
+    uint64_t offset = 0;   // ファイル先頭からのペイロードの位置
+    uint64_t size = 0;
+    uint32_t nameOffset = 0; // 文字列テーブル内の名前の位置
+    uint32_t nameLength = 0;
+    AssetType type = AssetType::Raw;
+    uint32_t stride = 0;
+    uint32_t elementCount = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t format = 0; // TextureFormat
+    uint32_t reserved[2] = {};
+};
+
+static_assert(sizeof(AssetContainerHeader) == 40, "AssetContainerHeader layout must match the file format");
+static_assert(sizeof(AssetEntry) == 64, "AssetEntry layout must match the file format");
+
+// テクスチャの 1 行のバイト数（ブロック圧縮形式は 4 画素の高さのブロック 1 行ぶん）
+uint32_t GetTextureRowPitch(TextureFormat format, uint32_t width);
+// テクスチャの行数（ブロック圧縮形式はブロックの行数）
+uint32_t GetTextureRowCount(TextureFormat format, uint32_t height);
+// 詰めて格納した 1 つのミップのバイト数
+inline uint64_t GetTextureMipSize(TextureFormat format, uint32_t width, uint32_t height)
+{
+    return static_cast<uint64_t>(GetTextureRowPitch(format, width)) * GetTextureRowCount(format, height);
+}
+
+// アセットコンテナを作成する（オフラインのツールとテストデータの生成用）。
+// ペイロードは Write まで複製して保持する。
+class AssetContainerWriter {
+public:
+    // 例外: 同じ名前（または同じハッシュ）のアセットを追加した場合は std::runtime_error を送出
+    void AddVertexBuffer(std::string_view name, const void* data, uint64_t size, uint32_t stride);
+    void AddIndexBuffer(std::string_view name, const void* data, uint64_t size, uint32_t indexSize);
+    // data: 最上位から mipCount 個のミップを詰めて並べたもの
+    void AddTexture(std::string_view name, const void* data, uint64_t size, uint32_t width, uint32_t height, TextureFormat format, uint32_t rowPitch, uint32_t mipCount = 1);
+    void AddRaw(std::string_view name, const void* data, uint64_t size);
+
+    // 一時ファイルに書き出してから path に置き換える
+    // 例外: 書き込みに失敗した場合は std::runtime_error を送出
+    void Write(const std::filesystem::path& path) const;
+
+private:
+    struct PendingAsset {
+        std::string name;
+        AssetEntry entry;
+        std::vector<uint8_t> payload;
+    };
+
+    void Add(std::string_view name, const AssetEntry& entry, const void* data, uint64_t size);
+
+    std::vector<PendingAsset> assets;
+};
+
+// メモリマップしたアセットコンテナ。
+// 開くときにヘッダとエントリテーブルの範囲だけを検証し、ペイロードは読み込まない。
+// 読み取り専用なので、開いた後は複数のスレッドから参照してよい。
+class AssetContainer {
+public:
+    // 例外: ファイルを開けない、または形式が正しくない場合は std::runtime_error を送出
+    void Open(const std::filesystem::path& path);
+    void Close();
+
+    uint32_t GetEntryCount() const { return entryCount; }
+    const AssetEntry& GetEntry(uint32_t index) const { return entries[index]; }
+    std::string_view GetName(uint32_t index) const;
+    // 戻り値: 見つからない場合は INVALID_ASSET_INDEX
+    uint32_t Find(std::string_view name) const;
+
+    // マップしたペイロードの先頭（コピーしない）
+    const void* GetPayload(uint32_t index) const { return file.GetData() + entries[index].offset; }
+    // ペイロードを先読みするよう OS に依頼する
+    void Prefetch(uint32_t index) const { file.Prefetch(entries[index].offset, entries[index].size); }
+
+private:
+    MappedFile file;
+    const AssetEntry* entries = nullptr;
+    const char* stringTable = nullptr;
+    uint32_t entryCount = 0;
+};
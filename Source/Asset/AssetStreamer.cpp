@@ -0,0 +1,183 @@
+﻿#include "AssetStreamer.h"
+#include "../Core/Profiler.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// ページを読み込ませるためにアクセスする間隔（ページサイズ以下であればよい）
+constexpr uint64_t PAGE_TOUCH_STRIDE = 4096;
+
+// マップした領域の各ページを 1 バイトずつ読み、ページフォールトを読み込みジョブ内で済ませる
+uint8_t TouchPages(const void* data, uint64_t size)
+{
+    const auto* bytes = static_cast<const volatile uint8_t*>(data);
+    uint8_t sum = 0;
+    for (uint64_t offset = 0; offset < size; offset += PAGE_TOUCH_STRIDE) {
+        sum = static_cast<uint8_t>(sum + bytes[offset]);
+    }
+    if (size != 0) {
+        sum = static_cast<uint8_t>(sum + bytes[size - 1]);
+    }
+    return sum;
+}
+
+} // namespace
+
+// 引数:
+//  - jobs: 読み込みに使用するジョブシステム
+//  - memoryBudgetBytes: 読み込み中 + 読み込み済みのアセットの合計バイト数の上限
+//  - maxInFlight: 同時に実行する読み込みジョブの数
+void AssetStreamer::Initialize(JobSystem* jobs, uint64_t memoryBudgetBytes, uint32_t maxInFlight)
+{
+    Shutdown();
+    jobSystem = jobs;
+    memoryBudget = memoryBudgetBytes;
+    maxLoadsInFlight = std::max<uint32_t>(maxInFlight, 1);
+}
+
+void AssetStreamer::Shutdown()
+{
+    if (jobSystem) {
+        jobSystem->Wait(loadCounter);
+    }
+    requests.clear();
+    freeIds.clear();
+    pendingIds.clear();
+    completed.clear();
+    finishedIds.clear();
+    stats = {};
+}
+
+AssetRequestId AssetStreamer::Request(const AssetContainer& container, uint32_t entry, float priority)
+{
+    AssetRequestId id;
+    if (!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+    }
+    else {
+        id = static_cast<AssetRequestId>(requests.size());
+        requests.emplace_back();
+    }
+    RequestSlot& slot = requests[id];
+    slot.container = &container;
+    slot.entry = entry;
+    slot.priority = priority;
+    slot.state = RequestState::Pending;
+    slot.releaseWhenLoaded = false;
+    slot.requestNs = Profiler::Now();
+    pendingIds.push_back(id);
+    ++stats.pendingCount;
+    return id;
+}
+
+void AssetStreamer::SetPriority(AssetRequestId id, float priority)
+{
+    if (requests[id].state == RequestState::Pending) {
+        requests[id].priority = priority;
+    }
+}
+
+void AssetStreamer::Release(AssetRequestId id)
+{
+    RequestSlot& slot = requests[id];
+    switch (slot.state) {
+    case RequestState::Pending:
+        pendingIds.erase(std::find(pendingIds.begin(), pendingIds.end(), id));
+        --stats.pendingCount;
+        FreeSlot(id);
+        break;
+    case RequestState::Loading:
+        slot.releaseWhenLoaded = true;
+        break;
+    case RequestState::Resident:
+        stats.residentBytes -= slot.container->GetEntry(slot.entry).size;
+        --stats.residentCount;
+        FreeSlot(id);
+        break;
+    case RequestState::Free:
+        break;
+    }
+}
+
+// 待ちリクエストは優先度の降順に並べ、末尾（最も優先度の高いもの）から開始する
+void AssetStreamer::Update()
+{
+    completed.clear();
+    {
+        std::lock_guard<std::mutex> lock(finishedMutex);
+        finishedScratch.swap(finishedIds);
+    }
+    const uint64_t nowNs = Profiler::Now();
+    for (AssetRequestId id : finishedScratch) {
+        RequestSlot& slot = requests[id];
+        const AssetEntry& entry = slot.container->GetEntry(slot.entry);
+        --stats.loadingCount;
+        ++stats.completedCount;
+        stats.streamedBytes += entry.size;
+        if (slot.releaseWhenLoaded) {
+            stats.residentBytes -= entry.size;
+            FreeSlot(id);
+            continue;
+        }
+        slot.state = RequestState::Resident;
+        ++stats.residentCount;
+        AssetStreamResult result;
+        result.id = id;
+        result.container = slot.container;
+        result.entry = slot.entry;
+        result.data = slot.container->GetPayload(slot.entry);
+        result.size = entry.size;
+        result.latencyNs = nowNs - slot.requestNs;
+        completed.push_back(result);
+    }
+    finishedScratch.clear();
+
+    std::sort(pendingIds.begin(), pendingIds.end(), [this](AssetRequestId a, AssetRequestId b) {
+        return requests[a].priority > requests[b].priority;
+    });
+    while (!pendingIds.empty() && stats.loadingCount < maxLoadsInFlight) {
+        const AssetRequestId id = pendingIds.back();
+        const uint64_t size = requests[id].container->GetEntry(requests[id].entry).size;
+        if (stats.residentBytes + size > memoryBudget && stats.residentBytes != 0) {
+            ++stats.budgetStalls;
+            break;
+        }
+        pendingIds.pop_back();
+        --stats.pendingCount;
+        StartLoad(id);
+    }
+}
+
+void AssetStreamer::StartLoad(AssetRequestId id)
+{
+    RequestSlot& slot = requests[id];
+    slot.state = RequestState::Loading;
+    const AssetContainer* container = slot.container;
+    const uint32_t entry = slot.entry;
+    stats.residentBytes += container->GetEntry(entry).size;
+    stats.peakResidentBytes = std::max(stats.peakResidentBytes, stats.residentBytes);
+    ++stats.loadingCount;
+
+    auto load = [this, id, container, entry]() {
+        PROFILE_SCOPE("StreamAsset");
+        container->Prefetch(entry);
+        TouchPages(container->GetPayload(entry), container->GetEntry(entry).size);
+        std::lock_guard<std::mutex> lock(finishedMutex);
+        finishedIds.push_back(id);
+    };
+    // ワーカースレッドがない場合、キューのジョブは誰かが Wait するまで実行されないため、ここで読み込む
+    if (jobSystem->GetThreadCount() <= 1) {
+        load();
+    }
+    else {
+        jobSystem->Schedule(std::move(load), &loadCounter);
+    }
+}
+
+void AssetStreamer::FreeSlot(AssetRequestId id)
+{
+    requests[id] = {};
+    freeIds.push_back(id);
+}
@@ -0,0 +1,98 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "../Core/JobSystem.h"
+#include "AssetContainer.h"
+
+using AssetRequestId = uint32_t;
+constexpr AssetRequestId INVALID_ASSET_REQUEST_ID = UINT32_MAX;
+
+// 読み込みを終えたアセット（data はコンテナのマップをそのまま指す）
+struct AssetStreamResult {
+    AssetRequestId id = INVALID_ASSET_REQUEST_ID;
+    const AssetContainer* container = nullptr;
+    uint32_t entry = INVALID_ASSET_INDEX;
+    const void* data = nullptr;
+    uint64_t size = 0;
+    uint64_t latencyNs = 0; // Request から Update で完了を受け取るまで
+};
+
+struct AssetStreamerStats {
+    uint32_t pendingCount = 0;
+    uint32_t loadingCount = 0;
+    uint32_t residentCount = 0;   // 読み込み済みで Release されていない数
+    uint32_t completedCount = 0;  // これまでに完了した数
+    uint32_t budgetStalls = 0;    // 予算が足りずに次の読み込みを見送った Update の回数
+    uint64_t residentBytes = 0;   // 読み込み中 + 読み込み済みのバイト数
+    uint64_t peakResidentBytes = 0;
+    uint64_t streamedBytes = 0;
+};
+
+// アセットの非同期読み込みを優先度順に行うスケジューラ。
+// 読み込みはジョブシステム上でマップしたペイロードのページを先に読み込んでおく処理で、
+// 完了したアセットはコピーせずにマップしたアドレスのまま渡す。
+// 読み込み中と読み込み済みのバイト数の合計がメモリ予算を超えないように、次の読み込みを保留する
+// （予算より大きいアセットは他に何も保持していないときだけ読み込む）。
+// Request/Release/Update は同じスレッドから呼び出すこと。
+class AssetStreamer {
+public:
+    static constexpr uint32_t DEFAULT_MAX_IN_FLIGHT = 8;
+
+    ~AssetStreamer() { Shutdown(); }
+
+    // jobs: 読み込みに使用するジョブシステム（所有しない）
+    void Initialize(JobSystem* jobs, uint64_t memoryBudgetBytes, uint32_t maxInFlight = DEFAULT_MAX_IN_FLIGHT);
+    // 読み込み中のジョブの完了を待ち、すべてのリクエストを破棄する
+    void Shutdown();
+
+    // priority の小さいものから読み込む。container は Release するまで開いたままにすること
+    AssetRequestId Request(const AssetContainer& container, uint32_t entry, float priority);
+    // 読み込み待ちのリクエストの優先度を変更する（読み込み中/済みの場合は何もしない）
+    void SetPriority(AssetRequestId id, float priority);
+    // リクエストを取り消す、または読み込み済みのアセットを手放して予算を空ける
+    void Release(AssetRequestId id);
+
+    // 完了した読み込みを受け取り、予算と同時実行数の範囲で次の読み込みを開始する
+    void Update();
+    // 直前の Update で完了を受け取ったアセット
+    const std::vector<AssetStreamResult>& GetCompleted() const { return completed; }
+
+    uint64_t GetMemoryBudget() const { return memoryBudget; }
+    const AssetStreamerStats& GetStats() const { return stats; }
+
+private:
+    enum class RequestState : uint8_t {
+        Free,
+        Pending,
+        Loading,
+        Resident,
+    };
+
+    struct RequestSlot {
+        const AssetContainer* container = nullptr;
+        uint32_t entry = INVALID_ASSET_INDEX;
+        float priority = 0.0f;
+        RequestState state = RequestState::Free;
+        bool releaseWhenLoaded = false; // 読み込み中に Release された
+        uint64_t requestNs = 0;
+    };
+
+    void StartLoad(AssetRequestId id);
+    void FreeSlot(AssetRequestId id);
+
+    JobSystem* jobSystem = nullptr;
+    uint64_t memoryBudget = 0;
+    uint32_t maxLoadsInFlight = DEFAULT_MAX_IN_FLIGHT;
+    std::vector<RequestSlot> requests;
+    std::vector<AssetRequestId> freeIds;
+    std::vector<AssetRequestId> pendingIds;
+    std::vector<AssetStreamResult> completed;
+    JobCounter loadCounter;
+
+    std::mutex finishedMutex;
+    std::vector<AssetRequestId> finishedIds; // ジョブが読み込みを終えたリクエスト
+    std::vector<AssetRequestId> finishedScratch;
+    AssetStreamerStats stats;
+};
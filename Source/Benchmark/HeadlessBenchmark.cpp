@@ -0,0 +1,503 @@
+﻿#include "HeadlessBenchmark.h"
+#include "../Core/AllocationCounter.h"
+#include "../Core/CpuFeatures.h"
+#include "../Core/JobSystem.h"
+#include "../Core/Profiler.h"
+#include "../Render/FrameRenderer.h"
+#include "../Render/NullRenderBackend.h"
+#include "../Scene/SampleScenes.h"
+#include "../Scene/SceneRegistry.h"
+#include "../Scene/SimulationThread.h"
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// ベンチマークで 1 フレームに進める模擬クロックの時間
+constexpr uint64_t BENCHMARK_FRAME_NS = 1000000000ull / 60;
+// ヌルバックエンドの仮想バックバッファとフレームメモリ
+constexpr uint32_t BENCHMARK_WIDTH = 1280;
+constexpr uint32_t BENCHMARK_HEIGHT = 720;
+constexpr uint64_t BENCHMARK_FRAME_MEMORY_CAPACITY = 32ull * 1024 * 1024;
+
+uint32_t ParseCount(const std::string& argument, const std::string& value)
+{
+    try {
+        size_t length = 0;
+        const unsigned long parsed = std::stoul(value, &length);
+        if (length == value.size() && parsed <= UINT32_MAX) {
+            return static_cast<uint32_t>(parsed);
+        }
+    }
+    catch (const std::exception&) {
+    }
+    throw std::invalid_argument("Invalid value for " + argument + ": " + value);
+}
+
+double ParseMilliseconds(const std::string& argument, const std::string& value)
+{
+    try {
+        size_t length = 0;
+        const double parsed = std::stod(value, &length);
+        if (length == value.size() && parsed > 0.0) {
+            return parsed;
+        }
+    }
+    catch (const std::exception&) {
+    }
+    throw std::invalid_argument("Invalid value for " + argument + ": " + value);
+}
+
+// text を JSON の文字列として引用符付きで書き出す（トレースのパスなど任意の文字列に使う）
+void WriteJsonString(std::ostream& stream, const std::string& text)
+{
+    stream << '"';
+    for (const char c : text) {
+        switch (c) {
+        case '"':
+            stream << "\\\"";
+            break;
+        case '\\':
+            stream << "\\\\";
+            break;
+        case '\n':
+            stream << "\\n";
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(c));
+                stream << escaped;
+            }
+            else {
+                stream << c;
+            }
+            break;
+        }
+    }
+    stream << '"';
+}
+
+// 再生結果を --output（空の場合は標準出力）へ書き出す
+// 例外: ファイルに書き込めない場合は std::runtime_error を送出
+template <typename WriteFunction>
+void WriteReplayOutput(const std::string& output, WriteFunction write)
+{
+    if (output.empty()) {
+        write(std::cout);
+        return;
+    }
+    std::ofstream file(output, std::ios::binary | std::ios::trunc);
+    write(file);
+    if (!file) {
+        throw std::runtime_error("Failed to write benchmark output: " + output);
+    }
+}
+
+double ToMilliseconds(uint64_t nanoseconds)
+{
+    return static_cast<double>(nanoseconds) / 1e6;
+}
+
+void WriteSummary(std::ostream& stream, const char* name, const FrameTimeSummary& summary)
+{
+    char text[256];
+    std::snprintf(text, sizeof(text), "\"%s\":{\"average\":%.4f,\"p50\":%.4f,\"p95\":%.4f,\"p99\":%.4f,\"max\":%.4f}",
+                  name, summary.averageMs, summary.p50Ms, summary.p95Ms, summary.p99Ms, summary.maxMs);
+    stream << text;
+}
+
+} // namespace
+
+// 引数は "--name=value" または "--flag" の形式。プログラム名は含めずに渡す。
+BenchmarkOptions ParseBenchmarkOptions(const std::vector<std::string>& args)
+{
+    BenchmarkOptions options;
+    for (const std::string& arg : args) {
+        const size_t separator = arg.find('=');
+        const std::string name = arg.substr(0, separator);
+        const std::string value = separator == std::string::npos ? std::string() : arg.substr(separator + 1);
+        if (name == "--headless") {
+            options.headless = true;
+        }
+        else if (name == "--list-scenes") {
+            options.listScenes = true;
+        }
+        else if (name == "--scene") {
+            options.scene = value;
+        }
+        else if (name == "--frames") {
+            options.frames = ParseCount(name, value);
+        }
+        else if (name == "--warmup") {
+            options.warmupFrames = ParseCount(name, value);
+        }
+        else if (name == "--threads") {
+            options.threads = ParseCount(name, value);
+        }
+        else if (name == "--frames-in-flight") {
+            options.framesInFlight = ParseCount(name, value);
+        }
+        else if (name == "--output") {
+            options.output = value;
+        }
+        else if (name == "--trace") {
+            options.trace = value;
+        }
+        else if (name == "--present-mode") {
+            if (!ParsePresentMode(value, options.presentMode)) {
+                throw std::invalid_argument("Invalid value for --present-mode: " + value);
+            }
+        }
+        else if (name == "--pacing-trace") {
+            options.pacingTrace = value;
+        }
+        else if (name == "--refresh-rate") {
+            options.refreshRate = ParseCount(name, value);
+            if (options.refreshRate == 0) {
+                throw std::invalid_argument("Invalid value for --refresh-rate: " + value);
+            }
+        }
+        else if (name == "--dynamic-resolution") {
+            options.dynamicResolution = true;
+        }
+        else if (name == "--target-frame-ms") {
+            options.targetFrameMs = ParseMilliseconds(name, value);
+        }
+        else if (name == "--resolution-trace") {
+            options.resolutionTrace = value;
+        }
+        else {
+            throw std::invalid_argument("Unknown argument: " + arg);
+        }
+    }
+    return options;
+}
+
+// 1 フレーム = SimulationThread::Advance（シーンとインスタンスの固定刻みの更新）+ FrameRenderer::Render。
+// ウィンドウモードと同じ経路を、シミュレーションスレッドを起動せずに模擬クロックで呼び出し元のスレッドから実行する。
+BenchmarkResult RunBenchmark(const BenchmarkOptions& options, IRenderBackend& backend, JobSystem& jobSystem)
+{
+    const std::string sceneName = options.scene.empty() ? DEFAULT_SCENE_NAME : options.scene;
+    std::unique_ptr<IScene> scene = GetSceneRegistry().Create(sceneName);
+    if (!scene) {
+        throw std::runtime_error("Unknown scene: " + sceneName);
+    }
+    auto renderer = std::make_unique<FrameRenderer>();
+    renderer->Initialize(&backend, &jobSystem);
+    if (options.dynamicResolution) {
+        DynamicResolutionSettings resolutionSettings;
+        resolutionSettings.targetFrameMs = options.targetFrameMs;
+        renderer->EnableDynamicResolution(resolutionSettings);
+    }
+    scene->Initialize(*renderer);
+    uint64_t simulatedTimeNs = 0;
+    SimulationThread simulation;
+    simulation.Initialize(scene.get(), renderer.get(), [&simulatedTimeNs]() { return simulatedTimeNs; });
+
+    const uint32_t frameCount = std::max<uint32_t>(options.frames, 1);
+    FrameTimeStats frameTimes;
+    FrameTimeStats updateTimes;
+    FrameTimeStats renderTimes;
+    frameTimes.Initialize(frameCount);
+    updateTimes.Initialize(frameCount);
+    renderTimes.Initialize(frameCount);
+
+    BenchmarkResult result;
+    result.scene = sceneName;
+    result.backend = backend.GetName();
+    result.simdLevel = GetSimdLevelName(renderer->GetInstances().GetSimdLevel());
+    result.frames = frameCount;
+    result.threads = jobSystem.GetThreadCount();
+
+    uint64_t measureStartNs = 0;
+    uint64_t commandsAtStart = 0;
+    AllocationCounts allocationsAtStart;
+    double drawItems = 0.0;
+    double commandLists = 0.0;
+    double instances = 0.0;
+    double renderScale = 0.0;
+    const uint32_t totalFrames = options.warmupFrames + frameCount;
+    for (uint32_t frame = 0; frame < totalFrames; ++frame) {
+        const bool measuring = frame >= options.warmupFrames;
+        if (frame == options.warmupFrames) {
+            if (!options.trace.empty()) {
+                GetProfiler().BeginCapture();
+            }
+            commandsAtStart = backend.GetExecutedCommandCount();
+            allocationsAtStart = GetAllocationCounts();
+            renderer->GetAllocationTracker().Reset();
+            measureStartNs = Profiler::Now();
+        }
+
+        const uint64_t frameStartNs = Profiler::Now();
+        simulatedTimeNs += BENCHMARK_FRAME_NS;
+        {
+            PROFILE_SCOPE("Update");
+            simulation.Advance();
+        }
+        const uint64_t updateEndNs = Profiler::Now();
+        scene->PrepareRender(*renderer);
+        renderer->Render(simulation.GetRenderTimeNs());
+        const uint64_t frameEndNs = Profiler::Now();
+
+        if (measuring) {
+            frameTimes.AddSample(ToMilliseconds(frameEndNs - frameStartNs));
+            updateTimes.AddSample(ToMilliseconds(updateEndNs - frameStartNs));
+            renderTimes.AddSample(ToMilliseconds(frameEndNs - updateEndNs));
+            const FrameRenderStats& stats = renderer->GetLastFrameStats();
+            drawItems += stats.drawItemCount;
+            commandLists += stats.commandListCount;
+            instances += stats.instanceCount;
+            renderScale += stats.renderScale;
+            result.skippedInstanceFrames += stats.instancesSkipped ? 1 : 0;
+            result.renderGraph = stats.renderGraph;
+            const AllocationTracker& tracker = renderer->GetAllocationTracker();
+            for (uint32_t tag = 0; tag < ALLOCATION_TAG_COUNT; ++tag) {
+                const TaggedAllocationCounts& counts = tracker.GetLastFrame(static_cast<AllocationTag>(tag));
+                TaggedAllocationRates& rates = result.allocationsByTag[tag];
+                rates.heapAllocations += static_cast<double>(counts.heapAllocations);
+                rates.heapBytes += static_cast<double>(counts.heapBytes);
+                rates.poolAllocations += static_cast<double>(counts.poolAllocations);
+                rates.poolBytes += static_cast<double>(counts.poolBytes);
+            }
+        }
+    }
+
+    const AllocationCounts allocationsAtEnd = GetAllocationCounts();
+    result.totalTimeMs = ToMilliseconds(Profiler::Now() - measureStartNs);
+    backend.WaitForIdle();
+    if (!options.trace.empty()) {
+        GetProfiler().EndCapture();
+    }
+
+    result.frameTime = frameTimes.GetSummary();
+    result.updateTime = updateTimes.GetSummary();
+    result.renderTime = renderTimes.GetSummary();
+    result.allocationsPerFrame = static_cast<double>(allocationsAtEnd.allocationCount - allocationsAtStart.allocationCount) / frameCount;
+    result.allocatedBytesPerFrame = static_cast<double>(allocationsAtEnd.allocatedBytes - allocationsAtStart.allocatedBytes) / frameCount;
+    for (TaggedAllocationRates& rates : result.allocationsByTag) {
+        rates.heapAllocations /= frameCount;
+        rates.heapBytes /= frameCount;
+        rates.poolAllocations /= frameCount;
+        rates.poolBytes /= frameCount;
+    }
+    result.executedCommandsPerFrame = static_cast<double>(backend.GetExecutedCommandCount() - commandsAtStart) / frameCount;
+    result.drawItemsPerFrame = drawItems / frameCount;
+    result.commandListsPerFrame = commandLists / frameCount;
+    result.instancesPerFrame = instances / frameCount;
+    result.renderScale = renderScale / frameCount;
+    scene->GetMetrics(result.sceneMetrics);
+    return result;
+}
+
+void WriteBenchmarkJson(const BenchmarkResult& result, std::ostream& stream)
+{
+    char text[512];
+    stream << "{\n";
+    stream << "  \"scene\":\"" << result.scene << "\",\n";
+    stream << "  \"backend\":\"" << result.backend << "\",\n";
+    stream << "  \"simdLevel\":\"" << result.simdLevel << "\",\n";
+    stream << "  \"frames\":" << result.frames << ",\n";
+    stream << "  \"threads\":" << result.threads << ",\n";
+    std::snprintf(text, sizeof(text), "  \"totalTimeMs\":%.3f,\n", result.totalTimeMs);
+    stream << text;
+    stream << "  \"timeMs\":{";
+    WriteSummary(stream, "frame", result.frameTime);
+    stream << ",";
+    WriteSummary(stream, "update", result.updateTime);
+    stream << ",";
+    WriteSummary(stream, "render", result.renderTime);
+    stream << "},\n";
+    std::snprintf(text, sizeof(text), "  \"allocationsPerFrame\":{\"count\":%.2f,\"bytes\":%.1f},\n",
+                  result.allocationsPerFrame, result.allocatedBytesPerFrame);
+    stream << text;
+    stream << "  \"allocationsByTag\":{";
+    for (uint32_t tag = 0; tag < ALLOCATION_TAG_COUNT; ++tag) {
+        const TaggedAllocationRates& rates = result.allocationsByTag[tag];
+        std::snprintf(text, sizeof(text), "%s\"%s\":{\"heap\":%.2f,\"heapBytes\":%.1f,\"pool\":%.2f,\"poolBytes\":%.1f}",
+                      tag == 0 ? "" : ",", GetAllocationTagName(static_cast<AllocationTag>(tag)), rates.heapAllocations, rates.heapBytes, rates.poolAllocations, rates.poolBytes);
+        stream << text;
+    }
+    stream << "},\n";
+    std::snprintf(text, sizeof(text), "  \"commandsPerFrame\":{\"executed\":%.1f,\"drawItems\":%.1f,\"commandLists\":%.2f,\"instances\":%.1f},\n",
+                  result.executedCommandsPerFrame, result.drawItemsPerFrame, result.commandListsPerFrame, result.instancesPerFrame);
+    stream << text;
+    std::snprintf(text, sizeof(text), "  \"renderScale\":%.4f,\n", result.renderScale);
+    stream << text;
+    const RenderGraphStats& graph = result.renderGraph;
+    std::snprintf(text, sizeof(text), "  \"renderGraph\":{\"passes\":%u,\"culledPasses\":%u,\"barrierBatches\":%u,\"barriers\":%u,\"splitBarriers\":%u,\"aliasingBarriers\":%u,\"transientTextures\":%u,\"transientBytes\":%llu,\"transientHeapBytes\":%llu},\n",
+                  graph.passCount, graph.culledPassCount, graph.barrierBatchCount, graph.barrierCount, graph.splitBarrierCount, graph.aliasingBarrierCount,
+                  graph.transientTextureCount, static_cast<unsigned long long>(graph.transientBytes), static_cast<unsigned long long>(graph.transientHeapBytes));
+    stream << text;
+    stream << "  \"sceneMetrics\":{";
+    for (size_t i = 0; i < result.sceneMetrics.size(); ++i) {
+        std::snprintf(text, sizeof(text), "%s\"%s\":%.4f", i == 0 ? "" : ",", result.sceneMetrics[i].first.c_str(), result.sceneMetrics[i].second);
+        stream << text;
+    }
+    stream << "},\n";
+    stream << "  \"skippedInstanceFrames\":" << result.skippedInstanceFrames << "\n";
+    stream << "}\n";
+}
+
+void WritePacingReplayJson(const std::string& tracePath, const FramePacingSettings& settings, const PacingReplayResult& result, std::ostream& stream)
+{
+    char text[512];
+    stream << "{\n";
+    stream << "  \"pacingTrace\":";
+    WriteJsonString(stream, tracePath);
+    stream << ",\n";
+    std::snprintf(text, sizeof(text), "  \"refreshIntervalMs\":%.4f,\n  \"frames\":%u,\n  \"missedDeadlines\":%u,\n",
+                  settings.refreshIntervalMs, result.frameCount, result.missedDeadlines);
+    stream << text;
+    std::snprintf(text, sizeof(text), "  \"delayMs\":{\"average\":%.4f,\"max\":%.4f},\n",
+                  result.averageDelayMs, result.maxDelayMs);
+    stream << text;
+    std::snprintf(text, sizeof(text), "  \"gpuPrediction\":{\"meanAbsoluteErrorMs\":%.4f,\"underpredictions\":%u}\n",
+                  result.gpuPredictionErrorMs, result.gpuUnderpredictions);
+    stream << text;
+    stream << "}\n";
+}
+
+void WriteResolutionReplayJson(const std::vector<std::string>& traceNames, const DynamicResolutionSettings& settings, const ResolutionReplayModel& model,
+                               const std::vector<ResolutionReplayResult>& results, std::ostream& stream)
+{
+    char text[512];
+    stream << "{\n";
+    std::snprintf(text, sizeof(text), "  \"targetFrameMs\":%.4f,\n  \"fixedMs\":%.4f,\n  \"latencyFrames\":%u,\n  \"traces\":[\n",
+                  settings.targetFrameMs, model.fixedMs, model.latencyFrames);
+    stream << text;
+    for (size_t i = 0; i < results.size(); ++i) {
+        const ResolutionReplayResult& result = results[i];
+        stream << "    {\"trace\":";
+        WriteJsonString(stream, traceNames[i]);
+        stream << ",";
+        std::snprintf(text, sizeof(text), "\"frames\":%u,\"scaleChanges\":%u,\"directionReversals\":%u,\"lastChangeFrame\":%u,"
+                      "\"overBudgetFrames\":%u,\"unavoidableOverBudgetFrames\":%u,",
+                      result.frameCount, result.scaleChanges, result.directionReversals, result.lastChangeFrame,
+                      result.overBudgetFrames, result.unavoidableOverBudgetFrames);
+        stream << text;
+        std::snprintf(text, sizeof(text), "\"scale\":{\"average\":%.4f,\"min\":%.4f,\"final\":%.4f},\"frameMs\":{\"average\":%.4f,\"max\":%.4f}}%s\n",
+                      result.averageScale, result.minScale, result.finalScale, result.averageFrameMs, result.maxFrameMs,
+                      i + 1 < results.size() ? "," : "");
+        stream << text;
+    }
+    stream << "  ]\n}\n";
+}
+
+// ウィンドウや D3D12 デバイスを作らずに、ヌルバックエンドで計測して結果を書き出す
+int RunHeadlessBenchmark(const BenchmarkOptions& options)
+{
+    RegisterSampleScenes(GetSceneRegistry());
+    if (options.listScenes) {
+        for (const SceneEntry& entry : GetSceneRegistry().GetEntries()) {
+            std::cout << entry.name << "\t" << entry.description << "\n";
+        }
+        return 0;
+    }
+
+    if (!options.pacingTrace.empty()) {
+        try {
+            FramePacingSettings settings;
+            settings.refreshIntervalMs = 1000.0 / options.refreshRate;
+            const PacingReplayResult result = ReplayFramePacing(LoadFrameTimeTrace(options.pacingTrace), settings);
+            WriteReplayOutput(options.output, [&](std::ostream& stream) {
+                WritePacingReplayJson(options.pacingTrace, settings, result, stream);
+            });
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Pacing replay failed: " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    // 合成した負荷は --frames のフレーム数で生成する
+    if (!options.resolutionTrace.empty()) {
+        try {
+            DynamicResolutionSettings settings;
+            settings.targetFrameMs = options.targetFrameMs;
+            const ResolutionReplayModel model;
+            std::vector<std::string> traceNames;
+            std::vector<std::vector<double>> traces;
+            std::vector<SyntheticLoad> loads; // 合成した負荷のときだけ traces と同じ順に並ぶ
+            SyntheticLoad load;
+            if (options.resolutionTrace == "synthetic") {
+                for (uint32_t i = 0; i < static_cast<uint32_t>(SyntheticLoad::Count); ++i) {
+                    loads.push_back(static_cast<SyntheticLoad>(i));
+                }
+            }
+            else if (ParseSyntheticLoad(options.resolutionTrace, load)) {
+                loads.push_back(load);
+            }
+            for (SyntheticLoad syntheticLoad : loads) {
+                traceNames.push_back(GetSyntheticLoadName(syntheticLoad));
+                traces.push_back(GenerateSyntheticLoad(syntheticLoad, options.frames, settings.targetFrameMs));
+            }
+            if (loads.empty()) {
+                std::vector<double> gpuMs;
+                for (const FrameTimeSample& sample : LoadFrameTimeTrace(options.resolutionTrace)) {
+                    gpuMs.push_back(sample.gpuMs);
+                }
+                traceNames.push_back(options.resolutionTrace);
+                traces.push_back(std::move(gpuMs));
+            }
+            std::vector<ResolutionReplayResult> results;
+            for (const std::vector<double>& trace : traces) {
+                results.push_back(ReplayDynamicResolution(trace, settings, model));
+            }
+            WriteReplayOutput(options.output, [&](std::ostream& stream) {
+                WriteResolutionReplayJson(traceNames, settings, model, results, stream);
+            });
+            // 合成した負荷は期待する挙動を満たさなければ失敗にする（記録したトレースは評価だけ行う）
+            int exitCode = 0;
+            for (size_t i = 0; i < loads.size(); ++i) {
+                std::string failure;
+                if (!CheckSyntheticReplay(loads[i], results[i], settings, failure)) {
+                    std::cerr << "Resolution replay check failed (" << traceNames[i] << "): " << failure << "\n";
+                    exitCode = 1;
+                }
+            }
+            return exitCode;
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Resolution replay failed: " << e.what() << "\n";
+            return 1;
+        }
+    }
+
+    int exitCode = 0;
+    GetProfiler().SetThreadName("Main");
+    GetJobSystem().Initialize(options.threads);
+    try {
+        auto backend = std::make_unique<NullRenderBackend>();
+        backend->Initialize(&GetJobSystem(), BENCHMARK_WIDTH, BENCHMARK_HEIGHT, options.framesInFlight, BENCHMARK_FRAME_MEMORY_CAPACITY);
+        const BenchmarkResult result = RunBenchmark(options, *backend, GetJobSystem());
+
+        if (options.output.empty()) {
+            WriteBenchmarkJson(result, std::cout);
+        }
+        else {
+            std::ofstream file(options.output, std::ios::binary | std::ios::trunc);
+            WriteBenchmarkJson(result, file);
+            if (!file) {
+                throw std::runtime_error("Failed to write benchmark output: " + options.output);
+            }
+        }
+        if (!options.trace.empty() && !GetProfiler().WriteChromeTrace(options.trace)) {
+            throw std::runtime_error("Failed to write trace: " + options.trace);
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Benchmark failed: " << e.what() << "\n";
+        exitCode = 1;
+    }
+    GetJobSystem().Shutdown();
+    return exitCode;
+}
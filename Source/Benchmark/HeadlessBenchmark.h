@@ -0,0 +1,87 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "../Core/AllocationTracker.h"
+#include "../Core/FrameTimeStats.h"
+#include "../Render/DynamicResolutionController.h"
+#include "../Render/FramePacingController.h"
+#include "../Render/RenderGraph.h"
+#include "../Scene/SceneRegistry.h"
+
+class IRenderBackend;
+class JobSystem;
+
+// コマンドライン引数から得るベンチマーク/起動オプション
+struct BenchmarkOptions {
+    bool headless = false;       // --headless: ウィンドウと GPU を使わずにヌルバックエンドで実行
+    bool listScenes = false;     // --list-scenes: 登録済みシーンを表示して終了
+    std::string scene;           // --scene=<name>（空の場合は既定のシーン）
+    uint32_t frames = 1000;      // --frames=<n>: 計測するフレーム数
+    uint32_t warmupFrames = 60;  // --warmup=<n>: 計測前に捨てるフレーム数
+    uint32_t threads = 0;        // --threads=<n>: ワーカースレッド数（0 = ハードウェアスレッド数 - 1）
+    uint32_t framesInFlight = 2; // --frames-in-flight=<n>
+    std::string output;          // --output=<path>: 結果の JSON の出力先（空の場合は標準出力）
+    std::string trace;           // --trace=<path>: 計測区間の Chrome トレースの出力先
+    PresentMode presentMode = PresentMode::VSync; // --present-mode=vsync|low-latency|uncapped（ウィンドウモード）
+    std::string pacingTrace;     // --pacing-trace=<path>: 記録したフレーム時間をペーシング制御に再生して評価する
+    uint32_t refreshRate = 60;   // --refresh-rate=<hz>: 再生時のリフレッシュレート
+    bool dynamicResolution = false; // --dynamic-resolution: GPU 時間に合わせて描画解像度を変え、バックバッファへ拡大する
+    double targetFrameMs = 1000.0 / 60.0; // --target-frame-ms=<ms>: 動的解像度の GPU 時間の目標
+    // --resolution-trace=<path>|synthetic|<constant|step|ramp|noisy|spikes>:
+    // 記録したフレーム時間の GPU 列（倍率 1 での時間とみなす）または合成した負荷を動的解像度の制御に再生して評価する
+    std::string resolutionTrace;
+};
+
+// タグごとのフレームあたりの平均の確保数とバイト数
+struct TaggedAllocationRates {
+    double heapAllocations = 0.0;
+    double heapBytes = 0.0;
+    double poolAllocations = 0.0; // フレームアリーナ/固定サイズプールからの確保
+    double poolBytes = 0.0;
+};
+
+// 計測結果（時間はミリ秒、回数はフレームあたりの平均）
+struct BenchmarkResult {
+    std::string scene;
+    std::string backend;
+    std::string simdLevel;
+    uint32_t frames = 0;
+    uint32_t threads = 0;
+    double totalTimeMs = 0.0;
+    FrameTimeSummary frameTime;  // Update + Render
+    FrameTimeSummary updateTime;
+    FrameTimeSummary renderTime;
+    double allocationsPerFrame = 0.0;
+    double allocatedBytesPerFrame = 0.0;
+    TaggedAllocationRates allocationsByTag[ALLOCATION_TAG_COUNT];
+    double executedCommandsPerFrame = 0.0;
+    double drawItemsPerFrame = 0.0;
+    double commandListsPerFrame = 0.0;
+    double instancesPerFrame = 0.0;
+    double renderScale = 1.0;           // 動的解像度の倍率の平均
+    uint32_t skippedInstanceFrames = 0; // フレームメモリ不足でインスタンス描画を省略したフレーム数
+    RenderGraphStats renderGraph;       // 最後に計測したフレームのレンダーグラフ
+    SceneMetrics sceneMetrics;          // シーン固有の計測値（IScene::GetMetrics）
+};
+
+// 例外: 不明な引数や不正な値の場合は std::invalid_argument を送出
+BenchmarkOptions ParseBenchmarkOptions(const std::vector<std::string>& args);
+
+// scene を backend 上で warmupFrames + frames フレーム実行し、計測区間の統計を返す。
+// 模擬クロックを 1 フレーム 1/60 秒ずつ進め、実行ごとに同じ内容のフレームになるようにする。
+// 例外: シーンが見つからない場合は std::runtime_error を送出
+BenchmarkResult RunBenchmark(const BenchmarkOptions& options, IRenderBackend& backend, JobSystem& jobSystem);
+
+void WriteBenchmarkJson(const BenchmarkResult& result, std::ostream& stream);
+void WritePacingReplayJson(const std::string& tracePath, const FramePacingSettings& settings, const PacingReplayResult& result, std::ostream& stream);
+// traceNames と results は同じ順序で、トレースごとに 1 要素ずつ書き出す
+void WriteResolutionReplayJson(const std::vector<std::string>& traceNames, const DynamicResolutionSettings& settings, const ResolutionReplayModel& model,
+                               const std::vector<ResolutionReplayResult>& results, std::ostream& stream);
+
+// --headless の処理全体（ジョブシステムとヌルバックエンドの初期化、実行、結果の出力）。
+// --pacing-trace / --resolution-trace を指定した場合はシーンを実行せず、トレースの再生結果を出力する。
+// 戻り値: プロセスの終了コード
+int RunHeadlessBenchmark(const BenchmarkOptions& options);
@@ -0,0 +1,493 @@
+﻿#include "AssetCooker.h"
+#include "CookManifest.h"
+#include "ImageFile.h"
+#include "MeshFile.h"
+#include "MeshOptimizer.h"
+#include "MipGenerator.h"
+#include "../Asset/AssetContainer.h"
+#include "../Core/Hash.h"
+#include "../Core/JobSystem.h"
+#include "../Core/MappedFile.h"
+#include "../Core/Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+// 出力の形式や変換の処理を変えたら上げる（すべての入力が再変換される）
+constexpr uint64_t COOKER_VERSION = 1;
+constexpr const char* COOK_MANIFEST_FILE_NAME = "CookManifest.txt";
+constexpr const char* COOKED_FILE_EXTENSION = ".assets";
+// 16bit のインデックスで表せる頂点数
+constexpr uint32_t MAX_16BIT_INDEXED_VERTICES = 65536;
+// ベンチマークのメッシュ（BENCHMARK_GRID_SIZE x BENCHMARK_GRID_SIZE の四角形を三角形の順序をばらばらにして並べる）
+constexpr uint32_t BENCHMARK_GRID_SIZE = 256;
+
+uint32_t ParseCount(const std::string& argument, const std::string& value)
+{
+    try {
+        size_t length = 0;
+        const unsigned long parsed = std::stoul(value, &length);
+        if (length == value.size() && parsed <= UINT32_MAX) {
+            return static_cast<uint32_t>(parsed);
+        }
+    }
+    catch (const std::exception&) {
+    }
+    throw std::invalid_argument("Invalid value for " + argument + ": " + value);
+}
+
+bool ParseSimdLevel(const std::string& name, SimdLevel& level)
+{
+    const SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 };
+    const char* names[] = { "scalar", "sse2", "avx2" };
+    for (uint32_t i = 0; i < 3; ++i) {
+        if (name == names[i]) {
+            level = levels[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* GetTextureCompressionName(TextureCompression compression)
+{
+    switch (compression) {
+    case TextureCompression::Auto:
+        return "auto";
+    case TextureCompression::BC1:
+        return "bc1";
+    case TextureCompression::BC3:
+        return "bc3";
+    case TextureCompression::BC7:
+        return "bc7";
+    }
+    return "auto";
+}
+
+double ToSeconds(uint64_t nanoseconds)
+{
+    return static_cast<double>(nanoseconds) / 1e9;
+}
+
+// 出力に影響する設定だけを含める（SIMD レベルとスレッド数は出力を変えない）
+uint64_t ComputeSettingsHash(const CookerOptions& options, bool texture)
+{
+    uint64_t hash = HashCombine(HASH_SEED, COOKER_VERSION);
+    hash = HashCombine(hash, texture ? 1 : 2);
+    if (texture) {
+        hash = HashCombine(hash, static_cast<uint64_t>(options.compression));
+        hash = HashCombine(hash, options.generateMips ? 1 : 0);
+        hash = HashCombine(hash, options.srgb ? 1 : 0);
+    }
+    return hash;
+}
+
+BlockFormat SelectBlockFormat(TextureCompression compression, const Image& image)
+{
+    switch (compression) {
+    case TextureCompression::BC1:
+        return BlockFormat::BC1;
+    case TextureCompression::BC3:
+        return BlockFormat::BC3;
+    case TextureCompression::BC7:
+        return BlockFormat::BC7;
+    case TextureCompression::Auto:
+        break;
+    }
+    return image.HasAlpha() ? BlockFormat::BC3 : BlockFormat::BC1;
+}
+
+// 全ミップを最上位から順に圧縮して詰めたテクスチャを 1 つ追加する
+void CookTexture(const std::filesystem::path& path, const std::string& name, const CookerOptions& options, JobSystem& jobs,
+                 AssetContainerWriter& writer, CookStats& stats, std::ostream& log)
+{
+    const uint64_t startNs = Profiler::Now();
+    const Image image = LoadImageFile(path);
+    const BlockFormat blockFormat = SelectBlockFormat(options.compression, image);
+    const TextureFormat textureFormat = GetBlockTextureFormat(blockFormat);
+    MipSettings mipSettings;
+    mipSettings.srgb = options.srgb;
+    std::vector<Image> mips;
+    if (options.generateMips) {
+        mips = GenerateMipChain(image, mipSettings, jobs);
+    }
+    else {
+        mips.push_back(image);
+    }
+
+    uint64_t totalSize = 0;
+    uint64_t pixels = 0;
+    for (const Image& mip : mips) {
+        totalSize += GetTextureMipSize(textureFormat, mip.width, mip.height);
+        pixels += static_cast<uint64_t>(mip.width) * mip.height;
+    }
+    std::vector<uint8_t> data(totalSize);
+    uint64_t offset = 0;
+    for (const Image& mip : mips) {
+        CompressImage(mip, blockFormat, options.simdLevel, jobs, data.data() + offset);
+        offset += GetTextureMipSize(textureFormat, mip.width, mip.height);
+    }
+    writer.AddTexture(name, data.data(), data.size(), image.width, image.height, textureFormat,
+                      GetTextureRowPitch(textureFormat, image.width), static_cast<uint32_t>(mips.size()));
+
+    const uint64_t elapsedNs = Profiler::Now() - startNs;
+    stats.texturePixels += pixels;
+    stats.textureTimeNs += elapsedNs;
+    char text[256];
+    std::snprintf(text, sizeof(text), "cooked %s (%ux%u %s, %zu mips, %.1f MP/s)\n", name.c_str(), image.width, image.height,
+                  GetBlockFormatName(blockFormat), mips.size(), static_cast<double>(pixels) / 1e6 / (std::max)(ToSeconds(elapsedNs), 1e-9));
+    log << text;
+}
+
+// 頂点キャッシュに合わせて三角形を並べ替え、頂点を参照順に詰めてから、頂点とインデックスを追加する
+void CookMesh(const std::filesystem::path& path, const std::string& name, AssetContainerWriter& writer, CookStats& stats, std::ostream& log)
+{
+    const uint64_t startNs = Profiler::Now();
+    Mesh mesh = LoadObjMesh(path);
+    const uint32_t originalVertexCount = static_cast<uint32_t>(mesh.vertices.size());
+    const double acmrBefore = ComputeAverageCacheMissRatio(mesh.indices.data(), mesh.indices.size(), originalVertexCount);
+    OptimizeVertexCache(mesh.indices.data(), mesh.indices.size(), originalVertexCount);
+    const double acmrAfter = ComputeAverageCacheMissRatio(mesh.indices.data(), mesh.indices.size(), originalVertexCount);
+    const uint32_t vertexCount = OptimizeVertexFetch(mesh.vertices.data(), originalVertexCount, sizeof(ColorVertex), mesh.indices.data(), mesh.indices.size());
+    mesh.vertices.resize(vertexCount);
+
+    writer.AddVertexBuffer(name + "/vertices", mesh.vertices.data(), mesh.vertices.size() * sizeof(ColorVertex), ColorVertexStream::STRIDE);
+    if (vertexCount <= MAX_16BIT_INDEXED_VERTICES) {
+        const std::vector<uint16_t> indices16(mesh.indices.begin(), mesh.indices.end());
+        writer.AddIndexBuffer(name + "/indices", indices16.data(), indices16.size() * sizeof(uint16_t), sizeof(uint16_t));
+    }
+    else {
+        writer.AddIndexBuffer(name + "/indices", mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t), sizeof(uint32_t));
+    }
+
+    stats.meshTriangles += mesh.indices.size() / 3;
+    stats.meshTimeNs += Profiler::Now() - startNs;
+    char text[256];
+    std::snprintf(text, sizeof(text), "cooked %s (%zu triangles, %u vertices, ACMR %.3f -> %.3f)\n", name.c_str(), mesh.indices.size() / 3,
+                  vertexCount, acmrBefore, acmrAfter);
+    log << text;
+}
+
+// ベンチマークの画像: なめらかな勾配、細かい縞、乱数のノイズ、アルファの円を重ねる
+Image GenerateBenchmarkImage(uint32_t size)
+{
+    Image image;
+    image.width = size;
+    image.height = size;
+    image.pixels.resize(static_cast<size_t>(size) * size * 4);
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> noise(-12, 12);
+    const float center = size * 0.5f;
+    for (uint32_t y = 0; y < size; ++y) {
+        for (uint32_t x = 0; x < size; ++x) {
+            const float u = static_cast<float>(x) / size;
+            const float v = static_cast<float>(y) / size;
+            const float stripes = 0.5f + 0.5f * std::sin((u * 37.0f + v * 11.0f) * 6.2831853f);
+            const float base[3] = { 255.0f * u, 255.0f * v, 255.0f * (0.3f + 0.7f * stripes * (1.0f - u)) };
+            uint8_t* pixel = image.GetPixel(x, y);
+            for (uint32_t c = 0; c < 3; ++c) {
+                pixel[c] = static_cast<uint8_t>(std::clamp(static_cast<int>(base[c]) + noise(random), 0, 255));
+            }
+            const float dx = x - center;
+            const float dy = y - center;
+            const float distance = std::sqrt(dx * dx + dy * dy) / center;
+            pixel[3] = static_cast<uint8_t>(std::clamp(static_cast<int>((1.2f - distance) * 400.0f), 0, 255));
+        }
+    }
+    return image;
+}
+
+// alpha: アルファも含めて比較する
+double ComputePsnr(const Image& reference, const Image& decoded, bool alpha)
+{
+    const uint32_t channels = alpha ? 4 : 3;
+    double squaredError = 0.0;
+    for (size_t i = 0; i < reference.pixels.size(); i += 4) {
+        for (uint32_t c = 0; c < channels; ++c) {
+            const double d = static_cast<double>(reference.pixels[i + c]) - decoded.pixels[i + c];
+            squaredError += d * d;
+        }
+    }
+    const double meanSquaredError = squaredError / (static_cast<double>(reference.pixels.size() / 4) * channels);
+    return meanSquaredError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError) : 99.0;
+}
+
+} // namespace
+
+// 引数は "--name=value" または "--flag" の形式。プログラム名は含めずに渡す。
+CookerOptions ParseCookerOptions(const std::vector<std::string>& args)
+{
+    CookerOptions options;
+    for (const std::string& arg : args) {
+        const size_t separator = arg.find('=');
+        const std::string name = arg.substr(0, separator);
+        const std::string value = separator == std::string::npos ? std::string() : arg.substr(separator + 1);
+        if (name == "--input") {
+            options.input = value;
+        }
+        else if (name == "--output") {
+            options.output = value;
+        }
+        else if (name == "--threads") {
+            options.threads = ParseCount(name, value);
+        }
+        else if (name == "--format") {
+            BlockFormat format;
+            if (value == "auto") {
+                options.compression = TextureCompression::Auto;
+            }
+            else if (ParseBlockFormat(value, format)) {
+                const TextureCompression compressions[] = { TextureCompression::BC1, TextureCompression::BC3, TextureCompression::BC7 };
+                options.compression = compressions[static_cast<uint32_t>(format)];
+            }
+            else {
+                throw std::invalid_argument("Invalid value for --format: " + value);
+            }
+        }
+        else if (name == "--no-mips") {
+            options.generateMips = false;
+        }
+        else if (name == "--linear") {
+            options.srgb = false;
+        }
+        else if (name == "--simd") {
+            if (!ParseSimdLevel(value, options.simdLevel)) {
+                throw std::invalid_argument("Invalid value for --simd: " + value);
+            }
+        }
+        else if (name == "--force") {
+            options.force = true;
+        }
+        else if (name == "--benchmark") {
+            options.benchmark = true;
+        }
+        else if (name == "--benchmark-size") {
+            options.benchmarkSize = ParseCount(name, value);
+            if (options.benchmarkSize == 0) {
+                throw std::invalid_argument("Invalid value for --benchmark-size: " + value);
+            }
+        }
+        else if (name == "--help") {
+            options.help = true;
+        }
+        else {
+            throw std::invalid_argument("Unknown argument: " + arg);
+        }
+    }
+    if (!options.benchmark && !options.help && (options.input.empty() || options.output.empty())) {
+        throw std::invalid_argument("--input and --output are required");
+    }
+    return options;
+}
+
+void WriteCookerUsage(std::ostream& stream)
+{
+    stream << "Usage: AssetCooker --input=<dir> --output=<dir> [options]\n"
+              "       AssetCooker --benchmark [--benchmark-size=<n>] [--threads=<n>]\n"
+              "  --format=auto|bc1|bc3|bc7  texture compression (auto: BC1 if opaque, otherwise BC3)\n"
+              "  --no-mips                  write only the top mip\n"
+              "  --linear                   filter mips without sRGB conversion\n"
+              "  --simd=scalar|sse2|avx2    encoder kernels (output is identical for every level)\n"
+              "  --threads=<n>              worker threads (0 = hardware threads - 1)\n"
+              "  --force                    ignore the cook manifest and cook every input\n";
+}
+
+CookStats CookDirectory(const CookerOptions& options, JobSystem& jobs, std::ostream& log)
+{
+    PROFILE_SCOPE("CookDirectory");
+    const uint64_t startNs = Profiler::Now();
+    const std::filesystem::path inputRoot(options.input);
+    const std::filesystem::path outputRoot(options.output);
+    if (!std::filesystem::is_directory(inputRoot)) {
+        throw std::runtime_error("Input directory not found: " + options.input);
+    }
+    std::filesystem::create_directories(outputRoot);
+
+    // 走査の順序に依存しないよう相対パス順に処理する
+    std::vector<std::filesystem::path> inputs;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(inputRoot)) {
+        if (entry.is_regular_file() && (IsImageFile(entry.path()) || IsMeshFile(entry.path()))) {
+            inputs.push_back(entry.path());
+        }
+    }
+    std::sort(inputs.begin(), inputs.end());
+
+    const std::filesystem::path manifestPath = outputRoot / COOK_MANIFEST_FILE_NAME;
+    CookManifest manifest;
+    if (!options.force) {
+        manifest.Load(manifestPath);
+    }
+    CookManifest previous = manifest;
+
+    CookStats stats;
+    stats.inputs = static_cast<uint32_t>(inputs.size());
+    for (const std::filesystem::path& path : inputs) {
+        const std::string name = std::filesystem::relative(path, inputRoot).generic_string();
+        const std::filesystem::path outputPath = outputRoot / (name + COOKED_FILE_EXTENSION);
+        previous.Remove(name);
+        try {
+            const bool texture = IsImageFile(path);
+            CookRecord record;
+            record.settingsHash = ComputeSettingsHash(options, texture);
+            {
+                MappedFile file;
+                file.Open(path);
+                record.contentHash = HashBytes(file.GetData(), file.GetSize());
+            }
+            if (manifest.IsUpToDate(name, record) && std::filesystem::exists(outputPath)) {
+                ++stats.skipped;
+                continue;
+            }
+
+            AssetContainerWriter writer;
+            if (texture) {
+                CookTexture(path, name, options, jobs, writer, stats, log);
+            }
+            else {
+                CookMesh(path, name, writer, stats, log);
+            }
+            std::filesystem::create_directories(outputPath.parent_path());
+            writer.Write(outputPath);
+            manifest.Set(name, record);
+            ++stats.cooked;
+        }
+        catch (const std::exception& e) {
+            log << "failed " << name << ": " << e.what() << "\n";
+            manifest.Remove(name);
+            ++stats.failed;
+        }
+    }
+
+    // 今回の入力にない記録は削除された入力のもの
+    for (const auto& [name, record] : previous.GetRecords()) {
+        std::error_code error;
+        std::filesystem::remove(outputRoot / (name + COOKED_FILE_EXTENSION), error);
+        manifest.Remove(name);
+        ++stats.removed;
+    }
+    manifest.Save(manifestPath);
+    stats.totalTimeNs = Profiler::Now() - startNs;
+    return stats;
+}
+
+// 圧縮はスレッド数 1（未初期化のジョブシステムで呼び出し元のスレッドだけで実行）と全スレッドで計測し、
+// SIMD レベルごとの出力が一致することも確認する
+void RunCookerBenchmark(const CookerOptions& options, JobSystem& jobs, std::ostream& stream)
+{
+    const Image image = GenerateBenchmarkImage(options.benchmarkSize);
+    const double megapixels = static_cast<double>(image.width) * image.height / 1e6;
+    char text[512];
+    stream << "{\n";
+    std::snprintf(text, sizeof(text), "  \"simdLevel\":\"%s\",\n  \"threads\":%u,\n  \"imageSize\":%u,\n",
+                  GetSimdLevelName(GetSupportedSimdLevel()), jobs.GetThreadCount(), options.benchmarkSize);
+    stream << text;
+
+    MipSettings mipSettings;
+    uint64_t startNs = Profiler::Now();
+    const std::vector<Image> mips = GenerateMipChain(image, mipSettings, jobs);
+    const double mipSeconds = ToSeconds(Profiler::Now() - startNs);
+    std::snprintf(text, sizeof(text), "  \"mipGeneration\":{\"mips\":%zu,\"ms\":%.3f,\"megapixelsPerSecond\":%.2f},\n",
+                  mips.size(), mipSeconds * 1e3, megapixels / mipSeconds);
+    stream << text;
+
+    JobSystem serialJobs;
+    JobSystem* jobSystems[2] = { &serialJobs, &jobs };
+    const SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 };
+    stream << "  \"textureCompression\":[\n";
+    bool first = true;
+    for (uint32_t f = 0; f < static_cast<uint32_t>(BlockFormat::Count); ++f) {
+        const BlockFormat format = static_cast<BlockFormat>(f);
+        const uint64_t size = GetTextureMipSize(GetBlockTextureFormat(format), image.width, image.height);
+        std::vector<uint8_t> reference(size);
+        std::vector<uint8_t> output(size);
+        for (const SimdLevel level : levels) {
+            if (level > GetSupportedSimdLevel()) {
+                continue;
+            }
+            for (JobSystem* jobSystem : jobSystems) {
+                startNs = Profiler::Now();
+                CompressImage(image, format, level, *jobSystem, output.data());
+                const double seconds = ToSeconds(Profiler::Now() - startNs);
+                if (level == SimdLevel::Scalar && jobSystem == &serialJobs) {
+                    reference = output;
+                }
+                const bool alpha = format != BlockFormat::BC1;
+                const double psnr = ComputePsnr(image, DecompressImage(output.data(), image.width, image.height, format), alpha);
+                std::snprintf(text, sizeof(text), "%s    {\"format\":\"%s\",\"simd\":\"%s\",\"threads\":%u,\"ms\":%.2f,\"megapixelsPerSecond\":%.2f,\"psnr\":%.2f,\"matchesScalar\":%s}",
+                              first ? "" : ",\n", GetBlockFormatName(format), GetSimdLevelName(level), (std::max)(jobSystem->GetThreadCount(), 1u),
+                              seconds * 1e3, megapixels / seconds, psnr, output == reference ? "true" : "false");
+                stream << text;
+                first = false;
+            }
+        }
+    }
+    stream << "\n  ],\n";
+
+    // 格子のメッシュの三角形の順序を乱数で並べ替えたものを最適化する
+    const uint32_t gridVertices = BENCHMARK_GRID_SIZE + 1;
+    std::vector<uint32_t> indices;
+    for (uint32_t y = 0; y < BENCHMARK_GRID_SIZE; ++y) {
+        for (uint32_t x = 0; x < BENCHMARK_GRID_SIZE; ++x) {
+            const uint32_t v = y * gridVertices + x;
+            indices.insert(indices.end(), { v, v + 1, v + gridVertices, v + 1, v + gridVertices + 1, v + gridVertices });
+        }
+    }
+    const uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    const uint32_t vertexCount = gridVertices * gridVertices;
+    std::vector<uint32_t> order(triangleCount);
+    for (uint32_t t = 0; t < triangleCount; ++t) {
+        order[t] = t;
+    }
+    std::shuffle(order.begin(), order.end(), std::mt19937(1));
+    std::vector<uint32_t> shuffled(indices.size());
+    for (uint32_t t = 0; t < triangleCount; ++t) {
+        std::copy(indices.begin() + order[t] * 3, indices.begin() + order[t] * 3 + 3, shuffled.begin() + t * 3);
+    }
+    const double acmrBefore = ComputeAverageCacheMissRatio(shuffled.data(), shuffled.size(), vertexCount);
+    startNs = Profiler::Now();
+    OptimizeVertexCache(shuffled.data(), shuffled.size(), vertexCount);
+    const double optimizeSeconds = ToSeconds(Profiler::Now() - startNs);
+    const double acmrAfter = ComputeAverageCacheMissRatio(shuffled.data(), shuffled.size(), vertexCount);
+    std::snprintf(text, sizeof(text), "  \"vertexCache\":{\"triangles\":%u,\"cacheSize\":%u,\"acmrBefore\":%.4f,\"acmrAfter\":%.4f,\"ms\":%.2f,\"megatrianglesPerSecond\":%.3f}\n",
+                  triangleCount, MEASURED_VERTEX_CACHE_SIZE, acmrBefore, acmrAfter, optimizeSeconds * 1e3, triangleCount / 1e6 / optimizeSeconds);
+    stream << text << "}\n";
+}
+
+int RunAssetCooker(const CookerOptions& options)
+{
+    if (options.help) {
+        WriteCookerUsage(std::cout);
+        return 0;
+    }
+    GetProfiler().SetThreadName("Main");
+    GetJobSystem().Initialize(options.threads);
+    try {
+        if (options.benchmark) {
+            RunCookerBenchmark(options, GetJobSystem(), std::cout);
+            return 0;
+        }
+        const CookStats stats = CookDirectory(options, GetJobSystem(), std::cout);
+        char text[256];
+        std::snprintf(text, sizeof(text), "%u inputs: %u cooked, %u up to date, %u failed, %u removed in %.1f ms (%s, %u threads)\n",
+                      stats.inputs, stats.cooked, stats.skipped, stats.failed, stats.removed, ToSeconds(stats.totalTimeNs) * 1e3,
+                      GetTextureCompressionName(options.compression), GetJobSystem().GetThreadCount());
+        std::cout << text;
+        if (stats.texturePixels != 0) {
+            std::snprintf(text, sizeof(text), "textures: %.2f MP in %.1f ms (%.1f MP/s)\n", stats.texturePixels / 1e6,
+                          ToSeconds(stats.textureTimeNs) * 1e3, stats.texturePixels / 1e6 / ToSeconds(stats.textureTimeNs));
+            std::cout << text;
+        }
+        return stats.failed == 0 ? 0 : 1;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Cook failed: " << e.what() << "\n";
+        return 1;
+    }
+}
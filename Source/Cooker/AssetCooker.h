@@ -0,0 +1,63 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "BlockCompression.h"
+#include "../Core/CpuFeatures.h"
+
+class JobSystem;
+
+// テクスチャの圧縮形式の選び方
+enum class TextureCompression : uint8_t {
+    Auto, // 不透明な画像は BC1、アルファを含む画像は BC3
+    BC1,
+    BC3,
+    BC7,
+};
+
+// コマンドライン引数から得る変換の設定
+struct CookerOptions {
+    std::string input;          // --input=<dir>: 変換する入力のディレクトリ（サブディレクトリを含む）
+    std::string output;         // --output=<dir>: 出力先（入力ごとに <相対パス>.assets を作る）
+    uint32_t threads = 0;       // --threads=<n>: ワーカースレッド数（0 = ハードウェアスレッド数 - 1）
+    TextureCompression compression = TextureCompression::Auto; // --format=auto|bc1|bc3|bc7
+    bool generateMips = true;   // --no-mips: 最上位のミップだけを出力する
+    bool srgb = true;           // --linear: ミップの縮小で色を sRGB として扱わない（法線マップなど）
+    SimdLevel simdLevel = GetSupportedSimdLevel(); // --simd=scalar|sse2|avx2（出力はレベルによらず同じ）
+    bool force = false;         // --force: 前回の記録を無視してすべて変換する
+    bool benchmark = false;     // --benchmark: 合成した入力で変換の速度を計測して JSON を出力する
+    uint32_t benchmarkSize = 2048; // --benchmark-size=<n>: 計測に使う画像の辺の長さ
+    bool help = false;          // --help
+};
+
+// 1 回の実行の集計
+struct CookStats {
+    uint32_t inputs = 0;
+    uint32_t cooked = 0;
+    uint32_t skipped = 0;  // 内容と設定が前回と同じ
+    uint32_t failed = 0;
+    uint32_t removed = 0;  // 入力が削除されたため消した出力
+    uint64_t texturePixels = 0;   // 圧縮した画素数（全ミップ）
+    uint64_t textureTimeNs = 0;   // 読み込み、ミップ生成、圧縮の時間
+    uint64_t meshTriangles = 0;
+    uint64_t meshTimeNs = 0;
+    uint64_t totalTimeNs = 0;
+};
+
+// 例外: 不明な引数や不正な値の場合は std::invalid_argument を送出
+CookerOptions ParseCookerOptions(const std::vector<std::string>& args);
+void WriteCookerUsage(std::ostream& stream);
+
+// input の画像（.ppm/.pam/.tga）とメッシュ（.obj）を変換して output へ書き出す。
+// 内容と設定が前回と同じ入力は省略し、削除された入力の出力は消す。
+// 個々の入力の失敗は log に書き出して続行する。
+// 例外: 入力のディレクトリがない、または記録を保存できない場合は std::runtime_error を送出
+CookStats CookDirectory(const CookerOptions& options, JobSystem& jobs, std::ostream& log);
+
+// 合成した画像とメッシュでミップ生成、各形式/各 SIMD レベルの圧縮、頂点キャッシュ最適化の速度を計測する
+void RunCookerBenchmark(const CookerOptions& options, JobSystem& jobs, std::ostream& stream);
+
+// 戻り値: プロセスの終了コード
+int RunAssetCooker(const CookerOptions& options);
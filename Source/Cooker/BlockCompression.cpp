@@ -0,0 +1,637 @@
+﻿#include "BlockCompression.h"
+#include "../Asset/AssetContainer.h"
+#include "../Core/JobSystem.h"
+#include "../Core/Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+// 端点は画素の主成分の軸上の範囲から求め、割り当てた番号から最小二乗法で端点を求め直して誤差が減れば採用する。
+// 誤差はチャンネルごとの二乗誤差の単純な和（知覚的な重みは付けない）。
+
+namespace {
+
+// 1 ジョブで圧縮するブロック行の数の目安
+constexpr uint32_t BLOCK_ROWS_PER_JOB = 2;
+// 主成分の軸を求めるべき乗法の反復回数
+constexpr uint32_t POWER_ITERATIONS = 8;
+// 端点を求め直す回数
+constexpr uint32_t REFINE_ITERATIONS = 2;
+// BC7 の 4bit 番号の補間の重み（/64）
+constexpr uint32_t BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+constexpr uint32_t BC7_MODE6 = 6;
+
+struct Endpoints {
+    float start[4];
+    float end[4];
+};
+
+float Clamp255(float value)
+{
+    return value < 0.0f ? 0.0f : (value > 255.0f ? 255.0f : value);
+}
+
+const float* GetChannel(const BlockPixels& pixels, uint32_t channel)
+{
+    const float* channels[4] = { pixels.r, pixels.g, pixels.b, pixels.a };
+    return channels[channel];
+}
+
+// 画素の平均と、共分散行列の最大固有値の固有ベクトル（べき乗法）の方向に画素を射影した範囲を端点にする。
+// inset: 範囲の両端を内側に寄せる割合（量子化の誤差が外側に出すぎないようにする）
+Endpoints ComputePrincipalEndpoints(const BlockPixels& pixels, uint32_t channels, float inset)
+{
+    float mean[4] = {};
+    for (uint32_t c = 0; c < channels; ++c) {
+        const float* values = GetChannel(pixels, c);
+        for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; ++i) {
+            mean[c] += values[i];
+        }
+        mean[c] /= BLOCK_PIXEL_COUNT;
+    }
+    float covariance[4][4] = {};
+    for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; ++i) {
+        float d[4] = {};
+        for (uint32_t c = 0; c < channels; ++c) {
+            d[c] = GetChannel(pixels, c)[i] - mean[c];
+        }
+        for (uint32_t row = 0; row < channels; ++row) {
+            for (uint32_t column = 0; column < channels; ++column) {
+                covariance[row][column] += d[row] * d[column];
+            }
+        }
+    }
+    // 分散の最大のチャンネルの行から始めると、ほとんどの場合数回で収束する
+    uint32_t largest = 0;
+    for (uint32_t c = 1; c < channels; ++c) {
+        largest = covariance[c][c] > covariance[largest][largest] ? c : largest;
+    }
+    float axis[4] = {};
+    for (uint32_t c = 0; c < channels; ++c) {
+        axis[c] = covariance[largest][c];
+    }
+    for (uint32_t iteration = 0; iteration < POWER_ITERATIONS; ++iteration) {
+        float next[4] = {};
+        float length = 0.0f;
+        for (uint32_t row = 0; row < channels; ++row) {
+            for (uint32_t column = 0; column < channels; ++column) {
+                next[row] += covariance[row][column] * axis[column];
+            }
+            length = (std::max)(length, std::fabs(next[row]));
+        }
+        if (length <= 0.0f) {
+            break;
+        }
+        for (uint32_t c = 0; c < channels; ++c) {
+            axis[c] = next[c] / length;
+        }
+    }
+
+    float minT = 0.0f;
+    float maxT = 0.0f;
+    float axisLengthSquared = 0.0f;
+    for (uint32_t c = 0; c < channels; ++c) {
+        axisLengthSquared += axis[c] * axis[c];
+    }
+    if (axisLengthSquared > 0.0f) {
+        for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; ++i) {
+            float t = 0.0f;
+            for (uint32_t c = 0; c < channels; ++c) {
+                t += (GetChannel(pixels, c)[i] - mean[c]) * axis[c];
+            }
+            t /= axisLengthSquared;
+            minT = i == 0 ? t : (std::min)(minT, t);
+            maxT = i == 0 ? t : (std::max)(maxT, t);
+        }
+        const float margin = (maxT - minT) * inset;
+        minT += margin;
+        maxT -= margin;
+    }
+    Endpoints endpoints = {};
+    for (uint32_t c = 0; c < channels; ++c) {
+        endpoints.start[c] = Clamp255(mean[c] + axis[c] * minT);
+        endpoints.end[c] = Clamp255(mean[c] + axis[c] * maxT);
+    }
+    return endpoints;
+}
+
+// 番号 k の画素が (1 - w[k]) * start + w[k] * end になるとみなして、誤差が最小の端点を解く。
+// 戻り値: 番号が 1 種類しかなく解けない場合は false
+bool RefineEndpoints(const BlockPixels& pixels, uint32_t channels, const uint8_t* indices, const float* weights, Endpoints& endpoints)
+{
+    float aa = 0.0f;
+    float ab = 0.0f;
+    float bb = 0.0f;
+    float ax[4] = {};
+    float bx[4] = {};
+    for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; ++i) {
+        const float w = weights[indices[i]];
+        const float v = 1.0f - w;
+        aa += v * v;
+        ab += v * w;
+        bb += w * w;
+        for (uint32_t c = 0; c < channels; ++c) {
+            ax[c] += v * GetChannel(pixels, c)[i];
+            bx[c] += w * GetChannel(pixels, c)[i];
+        }
+    }
+    const float determinant = aa * bb - ab * ab;
+    if (std::fabs(determinant) < 1e-6f) {
+        return false;
+    }
+    for (uint32_t c = 0; c < channels; ++c) {
+        endpoints.start[c] = Clamp255((bb * ax[c] - ab * bx[c]) / determinant);
+        endpoints.end[c] = Clamp255((aa * bx[c] - ab * ax[c]) / determinant);
+    }
+    return true;
+}
+
+// 128bit までのビット列を下位から詰める
+class BlockBitWriter {
+public:
+    void Write(uint32_t value, uint32_t count)
+    {
+        for (uint32_t i = 0; i < count; ++i, ++position) {
+            if ((value >> i) & 1) {
+                bits[position / 64] |= 1ull << (position % 64);
+            }
+        }
+    }
+    void Store(uint8_t* output, uint32_t byteCount) const
+    {
+        for (uint32_t i = 0; i < byteCount; ++i) {
+            output[i] = static_cast<uint8_t>(bits[i / 8] >> ((i % 8) * 8));
+        }
+    }
+
+private:
+    uint64_t bits[2] = {};
+    uint32_t position = 0;
+};
+
+class BlockBitReader {
+public:
+    BlockBitReader(const uint8_t* block, uint32_t byteCount)
+    {
+        for (uint32_t i = 0; i < byteCount; ++i) {
+            bits[i / 8] |= static_cast<uint64_t>(block[i]) << ((i % 8) * 8);
+        }
+    }
+    uint32_t Read(uint32_t count)
+    {
+        uint32_t value = 0;
+        for (uint32_t i = 0; i < count; ++i, ++position) {
+            value |= static_cast<uint32_t>((bits[position / 64] >> (position % 64)) & 1) << i;
+        }
+        return value;
+    }
+
+private:
+    uint64_t bits[2] = {};
+    uint32_t position = 0;
+};
+
+// ---- BC1（BC3 の色ブロックと共通） ----
+
+uint16_t QuantizeRgb565(const float color[4])
+{
+    const uint32_t r = static_cast<uint32_t>(color[0] * 31.0f / 255.0f + 0.5f);
+    const uint32_t g = static_cast<uint32_t>(color[1] * 63.0f / 255.0f + 0.5f);
+    const uint32_t b = static_cast<uint32_t>(color[2] * 31.0f / 255.0f + 0.5f);
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void ExpandRgb565(uint16_t value, uint32_t color[3])
+{
+    const uint32_t r = (value >> 11) & 31;
+    const uint32_t g = (value >> 5) & 63;
+    const uint32_t b = value & 31;
+    color[0] = (r << 3) | (r >> 2);
+    color[1] = (g << 2) | (g >> 4);
+    color[2] = (b << 3) | (b >> 2);
+}
+
+// 4 色モードのパレットの番号 k の補間の重み（0 = color0、1 = color1）
+constexpr float BC1_WEIGHTS[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+struct ColorBlockCandidate {
+    uint16_t color0 = 0;
+    uint16_t color1 = 0;
+    uint8_t indices[BLOCK_PIXEL_COUNT] = {};
+    float error = 0.0f;
+};
+
+// 端点を 565 に量子化し、color0 > color1（4 色モード）の順にしてから画素を割り当てる
+ColorBlockCandidate EvaluateColorEndpoints(const BlockPixels& pixels, const Endpoints& endpoints, const BlockKernelTable& kernels)
+{
+    ColorBlockCandidate candidate;
+    candidate.color0 = QuantizeRgb565(endpoints.end);
+    candidate.color1 = QuantizeRgb565(endpoints.start);
+    if (candidate.color0 < candidate.color1) {
+        std::swap(candidate.color0, candidate.color1);
+    }
+    uint32_t c0[3];
+    uint32_t c1[3];
+    ExpandRgb565(candidate.color0, c0);
+    ExpandRgb565(candidate.color1, c1);
+    BlockPalette palette;
+    palette.count = 4;
+    float* channels[3] = { palette.r, palette.g, palette.b };
+    for (uint32_t c = 0; c < 3; ++c) {
+        for (uint32_t k = 0; k < 4; ++k) {
+            channels[c][k] = (1.0f - BC1_WEIGHTS[k]) * c0[c] + BC1_WEIGHTS[k] * c1[c];
+        }
+    }
+    std::fill(palette.a, palette.a + 4, 0.0f);
+    const BlockErrorWeights weights = { 1.0f, 1.0f, 1.0f, 0.0f };
+    candidate.error = kernels.selectIndices(pixels, palette, weights, candidate.indices);
+    return candidate;
+}
+
+// 戻り値: 色の二乗誤差の合計
+float EncodeColorBlock(const BlockPixels& pixels, const BlockKernelTable& kernels, uint8_t* output)
+{
+    Endpoints endpoints = ComputePrincipalEndpoints(pixels, 3, 1.0f / 16.0f);
+    ColorBlockCandidate best = EvaluateColorEndpoints(pixels, endpoints, kernels);
+    for (uint32_t iteration = 0; iteration < REFINE_ITERATIONS && best.error > 0.0f; ++iteration) {
+        if (!RefineEndpoints(pixels, 3, best.indices, BC1_WEIGHTS, endpoints)) {
+            break;
+        }
+        const ColorBlockCandidate candidate = EvaluateColorEndpoints(pixels, endpoints, kernels);
+        if (candidate.error >= best.error) {
+            break;
+        }
+        best = candidate;
+    }
+
+    uint32_t indexBits = 0;
+    for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; ++i) {
+        indexBits |= static_cast<uint32_t>(best.indices[i]) << (i * 2);
+    }
+    output[0] = static_cast<uint8_t>(best.color0);
+    output[1] = static_cast<uint8_t>(best.color0 >> 8);
+    output[2] = static_cast<uint8_t>(best.color1);
+    output[3] = static_cast<uint8_t>(best.color1 >> 8);
+    std::memcpy(output + 4, &indexBits, 4);
+    return best.error;
+}
+
+// forceFourColors: BC3 の色ブロックは端点の大小によらず 4 色で展開する
+void DecodeColorBlock(const uint8_t* block, bool forceFourColors, uint8_t rgba[BLOCK_PIXEL_COUNT * 4])
+{
+    const uint16_t color0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+    const uint16_t color1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+    uint32_t palette[4][4];
+    ExpandRgb565(color0, palette[0]);
+    ExpandRgb565(color1, palette[1]);
+    palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+    const bool fourColors = forceFourColors || color0 > color1;
+    for (uint32_t c = 0; c < 3; ++c) {
+        if (fourColors) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        else {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    if (!fourColors) {
+        palette[3][3] = 0;
+    }
+    uint32_t indexBits;
+    std::memcpy(&indexBits, block + 4, 4);
+    for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; ++i) {
+        const uint32_t* color = palette[(indexBits >> (i * 2)) & 3];
+        for (uint32_t c = 0; c < 4; ++c) {
+            rgba[i * 4 + c] = static_cast<uint8_t>(color[c]);
+        }
+    }
+}
+
+// ---- BC3 のアルファブロック ----
+
+// alpha0 > alpha1 の 8 段階モードだけを使う（全画素が同じ値の場合は alpha0 == alpha1 で番号はすべて 0）
+void EncodeAlphaBlock(const BlockPixels& pixels, const BlockKernelTable& kernels, uint8_t* output)
+{
+    float minAlpha = pixels.a[0];
+    float maxAlpha = pixels.a[0];
+    for (uint32_t i = 1; i < BLOCK_PIXEL_COUNT; ++i) {
+        minAlpha = (std::min)(minAlpha, pixels.a[i]);
+        maxAlpha = (std::max)(maxAlpha, pixels.a[i]);
+    }
+    const uint32_t alpha0 = static_cast<uint32_t>(maxAlpha + 0.5f);
+    const uint32_t alpha1 = static_cast<uint32_t>(minAlpha + 0.5f);
+    output[0] = static_cast<uint8_t>(alpha0);
+    output[1] = static_cast<uint8_t>(alpha1);
+    uint8_t indices[BLOCK_PIXEL_COUNT] = {};
+    if (alpha0 > alpha1) {
+        BlockPalette palette;
+        palette.count = 8;
+        palette.a[0] = static_cast<float>(alpha0);
+        palette.a[1] = static_cast<float>(alpha1);
+        for (uint32_t k = 1; k < 7; ++k) {
+            palette.a[k + 1] = static_cast<float>(((7 - k) * alpha0 + k * alpha1) / 7);
+        }
+        std::fill(palette.r, palette.r + 8, 0.0f);
+        std::fill(palette.g, palette.g + 8, 0.0f);
+        std::fill(palette.b, palette.b + 8, 0.0f);
+        const BlockErrorWeights weights = { 0.0f, 0.0f, 0.0f, 1.0f };
+        kernels.selectIndices(pixels, palette, weights, indices);
+    }
+    uint64_t indexBits = 0;
+    for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; ++i) {
+        indexBits |= static_cast<uint64_t>(indices[i]) << (i * 3);
+    }
+    for (uint32_t i = 0; i < 6; ++i) {
+        output[2 + i] = static_cast<uint8_t>(indexBits >> (i * 8));
+    }
+}
+
+void DecodeAlphaBlock(const uint8_t* block, uint8_t rgba[BLOCK_PIXEL_COUNT * 4])
+{
+    const uint32_t alpha0 = block[0];
+    const uint32_t alpha1 = block[1];
+    uint32_t palette[8] = { alpha0, alpha1 };
+    if (alpha0 > alpha1) {
+        for (uint32_t k = 1; k < 7; ++k) {
+            palette[k + 1] = ((7 - k) * alpha0 + k * alpha1) / 7;
+        }
+    }
+    else {
+        for (uint32_t k = 1; k < 5; ++k) {
+            palette[k + 1] = ((5 - k) * alpha0 + k * alpha1) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+    uint64_t indexBits = 0;
+    for (uint32_t i = 0; i < 6; ++i) {
+        indexBits |= static_cast<uint64_t>(block[2 + i]) << (i * 8);
+    }
+    for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; ++i) {
+        rgba[i * 4 + 3] = static_cast<uint8_t>(palette[(indexBits >> (i * 3)) & 7]);
+    }
+}
+
+// ---- BC7 モード 6（1 サブセット、RGBA 各 7bit + 端点ごとの P ビット、4bit の番号） ----
+
+struct Bc7Candidate {
+    uint32_t endpoint0[4] = {}; // 7bit
+    uint32_t endpoint1[4] = {};
+    uint32_t pbit0 = 0;
+    uint32_t pbit1 = 0;
+    uint8_t indices[BLOCK_PIXEL_COUNT] = {};
+    float error = 0.0f;
+};
+
+uint32_t QuantizeBc7Channel(float value, uint32_t pbit)
+{
+    const float quantized = std::floor((value - static_cast<float>(pbit)) * 0.5f + 0.5f);
+    return static_cast<uint32_t>(quantized < 0.0f ? 0.0f : (quantized > 127.0f ? 127.0f : quantized));
+}
+
+uint32_t InterpolateBc7(uint32_t e0, uint32_t e1, uint32_t weight)
+{
+    return ((64 - weight) * e0 + weight * e1 + 32) >> 6;
+}
+
+// P ビットの 4 通りの組み合わせを試し、誤差が最小のものを返す
+Bc7Candidate EvaluateBc7Endpoints(const BlockPixels& pixels, const Endpoints& endpoints, const BlockKernelTable& kernels)
+{
+    Bc7Candidate best;
+    for (uint32_t combination = 0; combination < 4; ++combination) {
+        Bc7Candidate candidate;
+        candidate.pbit0 = combination & 1;
+        candidate.pbit1 = combination >> 1;
+        BlockPalette palette;
+        palette.count = 16;
+        float* channels[4] = { palette.r, palette.g, palette.b, palette.a };
+        for (uint32_t c = 0; c < 4; ++c) {
+            candidate.endpoint0[c] = QuantizeBc7Channel(endpoints.start[c], candidate.pbit0);
+            candidate.endpoint1[c] = QuantizeBc7Channel(endpoints.end[c], candidate.pbit1);
+            const uint32_t e0 = candidate.endpoint0[c] * 2 + candidate.pbit0;
+            const uint32_t e1 = candidate.endpoint1[c] * 2 + candidate.pbit1;
+            for (uint32_t k = 0; k < 16; ++k) {
+                channels[c][k] = static_cast<float>(InterpolateBc7(e0, e1, BC7_WEIGHTS4[k]));
+            }
+        }
+        candidate.error = kernels.selectIndices(pixels, palette, BlockErrorWeights{}, candidate.indices);
+        if (combination == 0 || candidate.error < best.error) {
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+void EncodeBc7Block(const BlockPixels& pixels, const BlockKernelTable& kernels, uint8_t* output)
+{
+    float weights[16];
+    for (uint32_t k = 0; k < 16; ++k) {
+        weights[k] = BC7_WEIGHTS4[k] / 64.0f;
+    }
+    Endpoints endpoints = ComputePrincipalEndpoints(pixels, 4, 0.0f);
+    Bc7Candidate best = EvaluateBc7Endpoints(pixels, endpoints, kernels);
+    for (uint32_t iteration = 0; iteration < REFINE_ITERATIONS && best.error > 0.0f; ++iteration) {
+        if (!RefineEndpoints(pixels, 4, best.indices, weights, endpoints)) {
+            break;
+        }
+        const Bc7Candidate candidate = EvaluateBc7Endpoints(pixels, endpoints, kernels);
+        if (candidate.error >= best.error) {
+            break;
+        }
+        best = candidate;
+    }
+
+    // 先頭の画素の番号の最上位ビットは省略されるため、0 になるよう端点を入れ替える
+    if (best.indices[0] >= 8) {
+        std::swap(best.endpoint0, best.endpoint1);
+        std::swap(best.pbit0, best.pbit1);
+        for (uint8_t& index : best.indices) {
+            index = static_cast<uint8_t>(15 - index);
+        }
+    }
+    BlockBitWriter writer;
+    writer.Write(1u << BC7_MODE6, BC7_MODE6 + 1);
+    for (uint32_t c = 0; c < 4; ++c) {
+        writer.Write(best.endpoint0[c], 7);
+        writer.Write(best.endpoint1[c], 7);
+    }
+    writer.Write(best.pbit0, 1);
+    writer.Write(best.pbit1, 1);
+    writer.Write(best.indices[0], 3);
+    for (uint32_t i = 1; i < BLOCK_PIXEL_COUNT; ++i) {
+        writer.Write(best.indices[i], 4);
+    }
+    writer.Store(output, 16);
+}
+
+void DecodeBc7Block(const uint8_t* block, uint8_t rgba[BLOCK_PIXEL_COUNT * 4])
+{
+    std::memset(rgba, 0, BLOCK_PIXEL_COUNT * 4);
+    BlockBitReader reader(block, 16);
+    uint32_t mode = 0;
+    while (mode < 8 && reader.Read(1) == 0) {
+        ++mode;
+    }
+    if (mode != BC7_MODE6) {
+        return;
+    }
+    uint32_t endpoints[2][4];
+    for (uint32_t c = 0; c < 4; ++c) {
+        endpoints[0][c] = reader.Read(7);
+        endpoints[1][c] = reader.Read(7);
+    }
+    const uint32_t pbit0 = reader.Read(1);
+    const uint32_t pbit1 = reader.Read(1);
+    for (uint32_t c = 0; c < 4; ++c) {
+        endpoints[0][c] = endpoints[0][c] * 2 + pbit0;
+        endpoints[1][c] = endpoints[1][c] * 2 + pbit1;
+    }
+    for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; ++i) {
+        const uint32_t index = reader.Read(i == 0 ? 3 : 4);
+        for (uint32_t c = 0; c < 4; ++c) {
+            rgba[i * 4 + c] = static_cast<uint8_t>(InterpolateBc7(endpoints[0][c], endpoints[1][c], BC7_WEIGHTS4[index]));
+        }
+    }
+}
+
+// ブロック (blockX, blockY) の画素を読み込む（画像の外は端の画素を繰り返す）
+void LoadBlock(const Image& image, uint32_t blockX, uint32_t blockY, BlockPixels& pixels)
+{
+    for (uint32_t y = 0; y < 4; ++y) {
+        const uint32_t sourceY = (std::min)(blockY * 4 + y, image.height - 1);
+        for (uint32_t x = 0; x < 4; ++x) {
+            const uint8_t* pixel = image.GetPixel((std::min)(blockX * 4 + x, image.width - 1), sourceY);
+            const uint32_t i = y * 4 + x;
+            pixels.r[i] = pixel[0];
+            pixels.g[i] = pixel[1];
+            pixels.b[i] = pixel[2];
+            pixels.a[i] = pixel[3];
+        }
+    }
+}
+
+} // namespace
+
+const char* GetBlockFormatName(BlockFormat format)
+{
+    switch (format) {
+    case BlockFormat::BC1:
+        return "bc1";
+    case BlockFormat::BC3:
+        return "bc3";
+    case BlockFormat::BC7:
+        return "bc7";
+    case BlockFormat::Count:
+        break;
+    }
+    return "unknown";
+}
+
+bool ParseBlockFormat(std::string_view name, BlockFormat& format)
+{
+    for (uint32_t i = 0; i < static_cast<uint32_t>(BlockFormat::Count); ++i) {
+        if (name == GetBlockFormatName(static_cast<BlockFormat>(i))) {
+            format = static_cast<BlockFormat>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t GetBlockBytes(BlockFormat format)
+{
+    return format == BlockFormat::BC1 ? 8 : 16;
+}
+
+TextureFormat GetBlockTextureFormat(BlockFormat format)
+{
+    switch (format) {
+    case BlockFormat::BC1:
+        return TextureFormat::BC1Unorm;
+    case BlockFormat::BC3:
+        return TextureFormat::BC3Unorm;
+    case BlockFormat::BC7:
+    case BlockFormat::Count:
+        break;
+    }
+    return TextureFormat::BC7Unorm;
+}
+
+void EncodeBlock(BlockFormat format, const BlockPixels& pixels, const BlockKernelTable& kernels, uint8_t* output)
+{
+    switch (format) {
+    case BlockFormat::BC1:
+        EncodeColorBlock(pixels, kernels, output);
+        break;
+    case BlockFormat::BC3:
+        EncodeAlphaBlock(pixels, kernels, output);
+        EncodeColorBlock(pixels, kernels, output + 8);
+        break;
+    case BlockFormat::BC7:
+    case BlockFormat::Count:
+        EncodeBc7Block(pixels, kernels, output);
+        break;
+    }
+}
+
+void DecodeBlock(BlockFormat format, const uint8_t* block, uint8_t rgba[BLOCK_PIXEL_COUNT * 4])
+{
+    switch (format) {
+    case BlockFormat::BC1:
+        DecodeColorBlock(block, false, rgba);
+        break;
+    case BlockFormat::BC3:
+        DecodeColorBlock(block + 8, true, rgba);
+        DecodeAlphaBlock(block, rgba);
+        break;
+    case BlockFormat::BC7:
+    case BlockFormat::Count:
+        DecodeBc7Block(block, rgba);
+        break;
+    }
+}
+
+void CompressImage(const Image& image, BlockFormat format, SimdLevel level, JobSystem& jobs, uint8_t* output)
+{
+    PROFILE_SCOPE("CompressImage");
+    const BlockKernelTable& kernels = GetBlockKernels(level);
+    const uint32_t blocksX = (image.width + 3) / 4;
+    const uint32_t blocksY = (image.height + 3) / 4;
+    const uint32_t blockBytes = GetBlockBytes(format);
+    jobs.ParallelFor(blocksY, BLOCK_ROWS_PER_JOB, [&](uint32_t begin, uint32_t end) {
+        BlockPixels pixels;
+        for (uint32_t blockY = begin; blockY < end; ++blockY) {
+            uint8_t* row = output + static_cast<size_t>(blockY) * blocksX * blockBytes;
+            for (uint32_t blockX = 0; blockX < blocksX; ++blockX) {
+                LoadBlock(image, blockX, blockY, pixels);
+                EncodeBlock(format, pixels, kernels, row + static_cast<size_t>(blockX) * blockBytes);
+            }
+        }
+    });
+}
+
+Image DecompressImage(const uint8_t* data, uint32_t width, uint32_t height, BlockFormat format)
+{
+    Image image;
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(static_cast<size_t>(width) * height * 4);
+    const uint32_t blocksX = (width + 3) / 4;
+    const uint32_t blocksY = (height + 3) / 4;
+    const uint32_t blockBytes = GetBlockBytes(format);
+    uint8_t rgba[BLOCK_PIXEL_COUNT * 4];
+    for (uint32_t blockY = 0; blockY < blocksY; ++blockY) {
+        for (uint32_t blockX = 0; blockX < blocksX; ++blockX) {
+            DecodeBlock(format, data + (static_cast<size_t>(blockY) * blocksX + blockX) * blockBytes, rgba);
+            for (uint32_t y = 0; y < 4 && blockY * 4 + y < height; ++y) {
+                for (uint32_t x = 0; x < 4 && blockX * 4 + x < width; ++x) {
+                    std::memcpy(image.GetPixel(blockX * 4 + x, blockY * 4 + y), rgba + (y * 4 + x) * 4, 4);
+                }
+            }
+        }
+    }
+    return image;
+}
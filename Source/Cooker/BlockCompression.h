@@ -0,0 +1,35 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include "BlockCompressionKernels.h"
+#include "ImageFile.h"
+#include "../Render/CommandList.h"
+
+class JobSystem;
+
+// 出力するブロック圧縮形式
+enum class BlockFormat : uint8_t {
+    BC1, // RGB（アルファは無視する）
+    BC3, // RGB + 補間アルファ
+    BC7, // RGBA（モード 6 のみを使用）
+    Count,
+};
+
+const char* GetBlockFormatName(BlockFormat format);
+// 戻り値: 名前（"bc1" など）が不明な場合は false
+bool ParseBlockFormat(std::string_view name, BlockFormat& format);
+uint32_t GetBlockBytes(BlockFormat format);
+TextureFormat GetBlockTextureFormat(BlockFormat format);
+
+// 1 ブロック（4x4 画素）を圧縮して GetBlockBytes(format) バイトを書き出す
+void EncodeBlock(BlockFormat format, const BlockPixels& pixels, const BlockKernelTable& kernels, uint8_t* output);
+// 1 ブロックを RGBA8 の 16 画素（行優先）に展開する（BC7 はモード 6 のみ対応し、それ以外は 0 にする）
+void DecodeBlock(BlockFormat format, const uint8_t* block, uint8_t rgba[BLOCK_PIXEL_COUNT * 4]);
+
+// image 全体をブロック行ごとにジョブシステム上で並列に圧縮する。
+// 端の欠けたブロックは端の画素を繰り返して埋める。
+// output: GetTextureMipSize(GetBlockTextureFormat(format), width, height) バイト
+void CompressImage(const Image& image, BlockFormat format, SimdLevel level, JobSystem& jobs, uint8_t* output);
+// CompressImage の出力を展開する（品質の計測用）
+Image DecompressImage(const uint8_t* data, uint32_t width, uint32_t height, BlockFormat format);
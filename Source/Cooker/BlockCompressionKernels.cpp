@@ -0,0 +1,147 @@
+﻿#include "BlockCompressionKernels.h"
+
+#if SIMD_X86
+#include <immintrin.h>
+#endif
+
+// 圧縮結果が実行した CPU に依存しないよう（コンテンツハッシュによる差分ビルドで出力が揺れないよう）、
+// すべての実装で同じ順序の乗算と加算で誤差を求め（FMA は使わない）、画素ごとの誤差を番号順に合計する。
+
+namespace {
+
+float SumErrors(const float* errors)
+{
+    float total = 0.0f;
+    for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; ++i) {
+        total += errors[i];
+    }
+    return total;
+}
+
+float SelectIndicesScalar(const BlockPixels& pixels, const BlockPalette& palette, const BlockErrorWeights& weights, uint8_t indices[BLOCK_PIXEL_COUNT])
+{
+    float errors[BLOCK_PIXEL_COUNT];
+    for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; ++i) {
+        float best = 0.0f;
+        uint8_t bestIndex = 0;
+        for (uint32_t p = 0; p < palette.count; ++p) {
+            const float dr = pixels.r[i] - palette.r[p];
+            const float dg = pixels.g[i] - palette.g[p];
+            const float db = pixels.b[i] - palette.b[p];
+            const float da = pixels.a[i] - palette.a[p];
+            const float error = dr * dr * weights.r + dg * dg * weights.g + db * db * weights.b + da * da * weights.a;
+            if (p == 0 || error < best) {
+                best = error;
+                bestIndex = static_cast<uint8_t>(p);
+            }
+        }
+        errors[i] = best;
+        indices[i] = bestIndex;
+    }
+    return SumErrors(errors);
+}
+
+const BlockKernelTable SCALAR_KERNELS = { SimdLevel::Scalar, SelectIndicesScalar };
+
+#if SIMD_X86
+
+// 4 画素ずつ、パレットの各色との誤差を求めて最小値と番号をマスクで選ぶ
+float SelectIndicesSSE2(const BlockPixels& pixels, const BlockPalette& palette, const BlockErrorWeights& weights, uint8_t indices[BLOCK_PIXEL_COUNT])
+{
+    alignas(16) float errors[BLOCK_PIXEL_COUNT];
+    alignas(16) int32_t bestIndices[BLOCK_PIXEL_COUNT];
+    const __m128 wr = _mm_set1_ps(weights.r);
+    const __m128 wg = _mm_set1_ps(weights.g);
+    const __m128 wb = _mm_set1_ps(weights.b);
+    const __m128 wa = _mm_set1_ps(weights.a);
+    for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; i += 4) {
+        const __m128 r = _mm_load_ps(pixels.r + i);
+        const __m128 g = _mm_load_ps(pixels.g + i);
+        const __m128 b = _mm_load_ps(pixels.b + i);
+        const __m128 a = _mm_load_ps(pixels.a + i);
+        __m128 best = _mm_set1_ps(3.0e38f);
+        __m128i bestIndex = _mm_setzero_si128();
+        for (uint32_t p = 0; p < palette.count; ++p) {
+            const __m128 dr = _mm_sub_ps(r, _mm_set1_ps(palette.r[p]));
+            const __m128 dg = _mm_sub_ps(g, _mm_set1_ps(palette.g[p]));
+            const __m128 db = _mm_sub_ps(b, _mm_set1_ps(palette.b[p]));
+            const __m128 da = _mm_sub_ps(a, _mm_set1_ps(palette.a[p]));
+            __m128 error = _mm_mul_ps(_mm_mul_ps(dr, dr), wr);
+            error = _mm_add_ps(error, _mm_mul_ps(_mm_mul_ps(dg, dg), wg));
+            error = _mm_add_ps(error, _mm_mul_ps(_mm_mul_ps(db, db), wb));
+            error = _mm_add_ps(error, _mm_mul_ps(_mm_mul_ps(da, da), wa));
+            const __m128 closer = _mm_cmplt_ps(error, best);
+            best = _mm_or_ps(_mm_and_ps(closer, error), _mm_andnot_ps(closer, best));
+            const __m128i closerMask = _mm_castps_si128(closer);
+            bestIndex = _mm_or_si128(_mm_and_si128(closerMask, _mm_set1_epi32(static_cast<int>(p))), _mm_andnot_si128(closerMask, bestIndex));
+        }
+        _mm_store_ps(errors + i, best);
+        _mm_store_si128(reinterpret_cast<__m128i*>(bestIndices + i), bestIndex);
+    }
+    for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; ++i) {
+        indices[i] = static_cast<uint8_t>(bestIndices[i]);
+    }
+    return SumErrors(errors);
+}
+
+SIMD_TARGET_AVX2 float SelectIndicesAVX2(const BlockPixels& pixels, const BlockPalette& palette, const BlockErrorWeights& weights, uint8_t indices[BLOCK_PIXEL_COUNT])
+{
+    alignas(32) float errors[BLOCK_PIXEL_COUNT];
+    alignas(32) int32_t bestIndices[BLOCK_PIXEL_COUNT];
+    const __m256 wr = _mm256_set1_ps(weights.r);
+    const __m256 wg = _mm256_set1_ps(weights.g);
+    const __m256 wb = _mm256_set1_ps(weights.b);
+    const __m256 wa = _mm256_set1_ps(weights.a);
+    for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; i += 8) {
+        const __m256 r = _mm256_load_ps(pixels.r + i);
+        const __m256 g = _mm256_load_ps(pixels.g + i);
+        const __m256 b = _mm256_load_ps(pixels.b + i);
+        const __m256 a = _mm256_load_ps(pixels.a + i);
+        __m256 best = _mm256_set1_ps(3.0e38f);
+        __m256i bestIndex = _mm256_setzero_si256();
+        for (uint32_t p = 0; p < palette.count; ++p) {
+            const __m256 dr = _mm256_sub_ps(r, _mm256_set1_ps(palette.r[p]));
+            const __m256 dg = _mm256_sub_ps(g, _mm256_set1_ps(palette.g[p]));
+            const __m256 db = _mm256_sub_ps(b, _mm256_set1_ps(palette.b[p]));
+            const __m256 da = _mm256_sub_ps(a, _mm256_set1_ps(palette.a[p]));
+            __m256 error = _mm256_mul_ps(_mm256_mul_ps(dr, dr), wr);
+            error = _mm256_add_ps(error, _mm256_mul_ps(_mm256_mul_ps(dg, dg), wg));
+            error = _mm256_add_ps(error, _mm256_mul_ps(_mm256_mul_ps(db, db), wb));
+            error = _mm256_add_ps(error, _mm256_mul_ps(_mm256_mul_ps(da, da), wa));
+            const __m256 closer = _mm256_cmp_ps(error, best, _CMP_LT_OQ);
+            best = _mm256_blendv_ps(best, error, closer);
+            bestIndex = _mm256_blendv_epi8(bestIndex, _mm256_set1_epi32(static_cast<int>(p)), _mm256_castps_si256(closer));
+        }
+        _mm256_store_ps(errors + i, best);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(bestIndices + i), bestIndex);
+    }
+    for (uint32_t i = 0; i < BLOCK_PIXEL_COUNT; ++i) {
+        indices[i] = static_cast<uint8_t>(bestIndices[i]);
+    }
+    return SumErrors(errors);
+}
+
+const BlockKernelTable SSE2_KERNELS = { SimdLevel::SSE2, SelectIndicesSSE2 };
+const BlockKernelTable AVX2_KERNELS = { SimdLevel::AVX2, SelectIndicesAVX2 };
+
+#endif
+
+} // namespace
+
+const BlockKernelTable& GetBlockKernels(SimdLevel level)
+{
+    if (level > GetSupportedSimdLevel()) {
+        level = GetSupportedSimdLevel();
+    }
+#if SIMD_X86
+    switch (level) {
+    case SimdLevel::AVX2:
+        return AVX2_KERNELS;
+    case SimdLevel::SSE2:
+        return SSE2_KERNELS;
+    case SimdLevel::Scalar:
+        break;
+    }
+#endif
+    return SCALAR_KERNELS;
+}
@@ -0,0 +1,46 @@
+﻿#pragma once
+
+#include <cstdint>
+#include "../Core/CpuFeatures.h"
+
+// ブロック圧縮のエンコーダが候補の端点ごとに何度も呼ぶ、画素の割り当ての SIMD カーネル。
+// 4x4 ブロックの 16 画素をチャンネルごとの配列（SoA）で持ち、パレットの最も近い色の番号を選ぶ。
+
+constexpr uint32_t BLOCK_PIXEL_COUNT = 16;
+constexpr uint32_t MAX_BLOCK_PALETTE_SIZE = 16;
+
+// 画素/パレットの値は 0 ～ 255 の float
+struct BlockPixels {
+    alignas(32) float r[BLOCK_PIXEL_COUNT];
+    alignas(32) float g[BLOCK_PIXEL_COUNT];
+    alignas(32) float b[BLOCK_PIXEL_COUNT];
+    alignas(32) float a[BLOCK_PIXEL_COUNT];
+};
+
+struct BlockPalette {
+    float r[MAX_BLOCK_PALETTE_SIZE];
+    float g[MAX_BLOCK_PALETTE_SIZE];
+    float b[MAX_BLOCK_PALETTE_SIZE];
+    float a[MAX_BLOCK_PALETTE_SIZE];
+    uint32_t count = 0;
+};
+
+// 誤差に掛けるチャンネルごとの重み（0 のチャンネルは無視される）
+struct BlockErrorWeights {
+    float r = 1.0f;
+    float g = 1.0f;
+    float b = 1.0f;
+    float a = 1.0f;
+};
+
+// 各画素をパレットの最も近い色（重み付き二乗誤差が最小、同じ場合は小さい番号）に割り当てる。
+// 戻り値: 16 画素の誤差の合計
+using SelectBlockIndicesFunction = float (*)(const BlockPixels& pixels, const BlockPalette& palette, const BlockErrorWeights& weights, uint8_t indices[BLOCK_PIXEL_COUNT]);
+
+struct BlockKernelTable {
+    SimdLevel level;
+    SelectBlockIndicesFunction selectIndices;
+};
+
+// level が実行中の CPU でサポートされない場合は、サポートされる最上位のレベルを返す
+const BlockKernelTable& GetBlockKernels(SimdLevel level);
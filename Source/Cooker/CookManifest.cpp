@@ -0,0 +1,49 @@
+﻿#include "CookManifest.h"
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+void CookManifest::Load(const std::filesystem::path& path)
+{
+    records.clear();
+    std::ifstream file(path, std::ios::binary);
+    std::string line;
+    while (std::getline(file, line)) {
+        CookRecord record;
+        int consumed = 0;
+        if (std::sscanf(line.c_str(), "%16" SCNx64 " %16" SCNx64 " %n", &record.contentHash, &record.settingsHash, &consumed) == 2 &&
+            consumed > 0 && static_cast<size_t>(consumed) < line.size()) {
+            records[line.substr(static_cast<size_t>(consumed))] = record;
+        }
+    }
+}
+
+void CookManifest::Save(const std::filesystem::path& path) const
+{
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        char text[64];
+        for (const auto& [input, record] : records) {
+            std::snprintf(text, sizeof(text), "%016" PRIx64 " %016" PRIx64 " ", record.contentHash, record.settingsHash);
+            file << text << input << "\n";
+        }
+        if (!file) {
+            throw std::runtime_error("Failed to write cook manifest: " + tempPath.string());
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error) {
+        std::filesystem::remove(tempPath, error);
+        throw std::runtime_error("Failed to replace cook manifest: " + path.string());
+    }
+}
+
+bool CookManifest::IsUpToDate(const std::string& input, const CookRecord& record) const
+{
+    const auto found = records.find(input);
+    return found != records.end() && found->second.contentHash == record.contentHash && found->second.settingsHash == record.settingsHash;
+}
@@ -0,0 +1,32 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+
+// 前回の実行で変換した入力の記録。入力の内容のハッシュと変換設定のハッシュが一致し、
+// 出力が残っている入力は変換を省略する（タイムスタンプは使わないため、チェックアウトやコピーで再変換されない）。
+// ファイル形式は 1 行 1 入力のテキスト:「内容のハッシュ 設定のハッシュ 入力の相対パス」（ハッシュは 16 桁の 16 進数）。
+struct CookRecord {
+    uint64_t contentHash = 0;
+    uint64_t settingsHash = 0;
+};
+
+class CookManifest {
+public:
+    // 存在しない場合は空にする。形式の正しくない行は無視する（その入力は再変換される）
+    void Load(const std::filesystem::path& path);
+    // 一時ファイルに書き出してから path に置き換える
+    // 例外: 書き込みに失敗した場合は std::runtime_error を送出
+    void Save(const std::filesystem::path& path) const;
+
+    bool IsUpToDate(const std::string& input, const CookRecord& record) const;
+    void Set(const std::string& input, const CookRecord& record) { records[input] = record; }
+    void Remove(const std::string& input) { records.erase(input); }
+
+    const std::map<std::string, CookRecord>& GetRecords() const { return records; }
+
+private:
+    std::map<std::string, CookRecord> records; // 入力の相対パス（'/' 区切り）順
+};
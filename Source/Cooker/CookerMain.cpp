@@ -0,0 +1,21 @@
+﻿#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "AssetCooker.h"
+
+// オフラインのアセット変換ツール（ランタイムとは別の実行ファイル）。
+// D3D12 やウィンドウに依存しないため、Windows 以外でもビルドして実行できる。
+int main(int argc, char** argv)
+{
+    CookerOptions options;
+    try {
+        options = ParseCookerOptions(std::vector<std::string>(argv + 1, argv + argc));
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        WriteCookerUsage(std::cerr);
+        return 1;
+    }
+    return RunAssetCooker(options);
+}
@@ -0,0 +1,224 @@
+﻿#include "ImageFile.h"
+#include "../Core/MappedFile.h"
+#include <cctype>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+std::string GetLowerExtension(const std::filesystem::path& path)
+{
+    std::string extension = path.extension().string();
+    for (char& c : extension) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return extension;
+}
+
+// ヘッダのテキストを空白とコメント（# から行末）を飛ばしながらトークン単位で読む
+class HeaderReader {
+public:
+    HeaderReader(const uint8_t* data, uint64_t size) : data(data), size(size) {}
+
+    std::string NextToken()
+    {
+        SkipSpaceAndComments();
+        std::string token;
+        while (position < size && !std::isspace(data[position])) {
+            token += static_cast<char>(data[position++]);
+        }
+        return token;
+    }
+    // 単一の空白の後が画素データの先頭
+    uint64_t SkipSingleSpace()
+    {
+        if (position < size) {
+            ++position;
+        }
+        return position;
+    }
+    uint32_t NextNumber(const std::filesystem::path& path)
+    {
+        const std::string token = NextToken();
+        if (token.empty() || token.size() > 9 || token.find_first_not_of("0123456789") != std::string::npos) {
+            throw std::runtime_error("Invalid image header: " + path.string());
+        }
+        return static_cast<uint32_t>(std::stoul(token));
+    }
+
+private:
+    void SkipSpaceAndComments()
+    {
+        while (position < size) {
+            if (data[position] == '#') {
+                while (position < size && data[position] != '\n') {
+                    ++position;
+                }
+            }
+            else if (std::isspace(data[position])) {
+                ++position;
+            }
+            else {
+                break;
+            }
+        }
+    }
+
+    const uint8_t* data;
+    uint64_t size;
+    uint64_t position = 0;
+};
+
+// channels 個のチャンネルが並んだ画素を RGBA8 へ広げる（1 = グレー、2 = グレー + アルファ）
+void ExpandPixels(const uint8_t* source, uint32_t channels, Image& image)
+{
+    const size_t count = static_cast<size_t>(image.width) * image.height;
+    image.pixels.resize(count * 4);
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t* in = source + i * channels;
+        uint8_t* out = image.pixels.data() + i * 4;
+        if (channels <= 2) {
+            out[0] = out[1] = out[2] = in[0];
+            out[3] = channels == 2 ? in[1] : 255;
+        }
+        else {
+            out[0] = in[0];
+            out[1] = in[1];
+            out[2] = in[2];
+            out[3] = channels == 4 ? in[3] : 255;
+        }
+    }
+}
+
+void CheckPixelData(const std::filesystem::path& path, uint64_t offset, uint64_t fileSize, const Image& image, uint32_t channels)
+{
+    if (image.width == 0 || image.height == 0 || offset > fileSize ||
+        static_cast<uint64_t>(image.width) * image.height * channels > fileSize - offset) {
+        throw std::runtime_error("Truncated or empty image: " + path.string());
+    }
+}
+
+Image LoadNetpbm(const std::filesystem::path& path, const MappedFile& file)
+{
+    HeaderReader reader(file.GetData(), file.GetSize());
+    const std::string magic = reader.NextToken();
+    Image image;
+    uint32_t channels = 3;
+    uint32_t maxValue = 0;
+    if (magic == "P6") {
+        image.width = reader.NextNumber(path);
+        image.height = reader.NextNumber(path);
+        maxValue = reader.NextNumber(path);
+    }
+    else if (magic == "P7") {
+        std::string tupleType;
+        for (std::string token = reader.NextToken(); token != "ENDHDR"; token = reader.NextToken()) {
+            if (token == "WIDTH") {
+                image.width = reader.NextNumber(path);
+            }
+            else if (token == "HEIGHT") {
+                image.height = reader.NextNumber(path);
+            }
+            else if (token == "DEPTH") {
+                channels = reader.NextNumber(path);
+            }
+            else if (token == "MAXVAL") {
+                maxValue = reader.NextNumber(path);
+            }
+            else if (token == "TUPLTYPE") {
+                tupleType = reader.NextToken();
+            }
+            else if (token.empty()) {
+                throw std::runtime_error("Missing ENDHDR in PAM header: " + path.string());
+            }
+        }
+        if (channels < 1 || channels > 4) {
+            throw std::runtime_error("Unsupported PAM depth: " + path.string());
+        }
+    }
+    else {
+        throw std::runtime_error("Unsupported Netpbm format (P6/P7 only): " + path.string());
+    }
+    if (maxValue != 255) {
+        throw std::runtime_error("Only 8-bit Netpbm images are supported: " + path.string());
+    }
+    const uint64_t offset = reader.SkipSingleSpace();
+    CheckPixelData(path, offset, file.GetSize(), image, channels);
+    ExpandPixels(file.GetData() + offset, channels, image);
+    return image;
+}
+
+// TGA は BGR(A) の順で、記述子のビット 5 が立っていなければ下の行から並ぶ
+Image LoadTga(const std::filesystem::path& path, const MappedFile& file)
+{
+    constexpr uint64_t TGA_HEADER_SIZE = 18;
+    const uint8_t* header = file.GetData();
+    if (file.GetSize() < TGA_HEADER_SIZE) {
+        throw std::runtime_error("Truncated TGA header: " + path.string());
+    }
+    const uint32_t imageType = header[2];
+    const uint32_t bitsPerPixel = header[16];
+    if (imageType != 2 || (bitsPerPixel != 24 && bitsPerPixel != 32) || header[1] != 0) {
+        throw std::runtime_error("Only uncompressed 24/32-bit true-color TGA is supported: " + path.string());
+    }
+    Image image;
+    image.width = header[12] | (header[13] << 8);
+    image.height = header[14] | (header[15] << 8);
+    const uint32_t channels = bitsPerPixel / 8;
+    const uint64_t offset = TGA_HEADER_SIZE + header[0];
+    CheckPixelData(path, offset, file.GetSize(), image, channels);
+    ExpandPixels(file.GetData() + offset, channels, image);
+    const bool topDown = (header[17] & 0x20) != 0;
+    for (uint32_t y = 0; y < image.height; ++y) {
+        for (uint32_t x = 0; x < image.width; ++x) {
+            uint8_t* pixel = image.GetPixel(x, y);
+            std::swap(pixel[0], pixel[2]);
+        }
+    }
+    if (!topDown) {
+        const size_t rowBytes = static_cast<size_t>(image.width) * 4;
+        std::vector<uint8_t> row(rowBytes);
+        for (uint32_t y = 0; y < image.height / 2; ++y) {
+            uint8_t* top = image.GetPixel(0, y);
+            uint8_t* bottom = image.GetPixel(0, image.height - 1 - y);
+            std::memcpy(row.data(), top, rowBytes);
+            std::memcpy(top, bottom, rowBytes);
+            std::memcpy(bottom, row.data(), rowBytes);
+        }
+    }
+    return image;
+}
+
+} // namespace
+
+bool Image::HasAlpha() const
+{
+    for (size_t i = 3; i < pixels.size(); i += 4) {
+        if (pixels[i] != 255) {
+            return true;
+        }
+    }
+    return false;
+}
+
+Image LoadImageFile(const std::filesystem::path& path)
+{
+    MappedFile file;
+    file.Open(path);
+    const std::string extension = GetLowerExtension(path);
+    if (extension == ".tga") {
+        return LoadTga(path, file);
+    }
+    if (extension == ".ppm" || extension == ".pam") {
+        return LoadNetpbm(path, file);
+    }
+    throw std::runtime_error("Unsupported image file: " + path.string());
+}
+
+bool IsImageFile(const std::filesystem::path& path)
+{
+    const std::string extension = GetLowerExtension(path);
+    return extension == ".ppm" || extension == ".pam" || extension == ".tga";
+}
@@ -0,0 +1,27 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+// RGBA8 の画像（行の間に隙間なし、左上が先頭）
+struct Image {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> pixels; // width * height * 4 バイト
+
+    uint8_t* GetPixel(uint32_t x, uint32_t y) { return pixels.data() + (static_cast<size_t>(y) * width + x) * 4; }
+    const uint8_t* GetPixel(uint32_t x, uint32_t y) const { return pixels.data() + (static_cast<size_t>(y) * width + x) * 4; }
+    // 不透明でない画素があるか
+    bool HasAlpha() const;
+};
+
+// 拡張子で判別して読み込み、RGBA8 に変換する。対応形式:
+//  - .ppm: バイナリの PPM（P6、最大値 255）。アルファは 255
+//  - .pam: PAM（P7、TUPLTYPE RGB / RGB_ALPHA / GRAYSCALE、最大値 255）
+//  - .tga: 非圧縮の TGA（24/32bit トゥルーカラー）
+// 例外: ファイルを読めない、または未対応の形式の場合は std::runtime_error を送出
+Image LoadImageFile(const std::filesystem::path& path);
+
+// 読み込める拡張子か（小文字で比較する）
+bool IsImageFile(const std::filesystem::path& path);
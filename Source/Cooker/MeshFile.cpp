@@ -0,0 +1,108 @@
+﻿#include "MeshFile.h"
+#include "../Core/MappedFile.h"
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace {
+
+// 行内のトークンを空白区切りで読む（行末で空のトークンを返す）
+class LineTokenizer {
+public:
+    LineTokenizer(const char* begin, const char* end) : cursor(begin), end(end) {}
+
+    std::string_view Next()
+    {
+        while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r')) {
+            ++cursor;
+        }
+        const char* start = cursor;
+        while (cursor < end && *cursor != ' ' && *cursor != '\t' && *cursor != '\r') {
+            ++cursor;
+        }
+        return std::string_view(start, static_cast<size_t>(cursor - start));
+    }
+
+private:
+    const char* cursor;
+    const char* end;
+};
+
+bool ParseFloat(std::string_view token, float& value)
+{
+    if (token.empty()) {
+        return false;
+    }
+    const std::string text(token);
+    char* parsedEnd = nullptr;
+    value = std::strtof(text.c_str(), &parsedEnd);
+    return parsedEnd == text.c_str() + text.size();
+}
+
+// "a/t/n" の a を 0 始まりの頂点番号に変換する
+uint32_t ParseFaceIndex(std::string_view token, size_t vertexCount, const std::filesystem::path& path, size_t line)
+{
+    const std::string text(token.substr(0, token.find('/')));
+    char* parsedEnd = nullptr;
+    const long value = std::strtol(text.c_str(), &parsedEnd, 10);
+    const long long index = value < 0 ? static_cast<long long>(vertexCount) + value : static_cast<long long>(value) - 1;
+    if (text.empty() || parsedEnd != text.c_str() + text.size() || value == 0 || index < 0 || index >= static_cast<long long>(vertexCount)) {
+        throw std::runtime_error("Invalid face index at " + path.string() + ":" + std::to_string(line));
+    }
+    return static_cast<uint32_t>(index);
+}
+
+} // namespace
+
+Mesh LoadObjMesh(const std::filesystem::path& path)
+{
+    MappedFile file;
+    file.Open(path);
+    const char* cursor = reinterpret_cast<const char*>(file.GetData());
+    const char* fileEnd = cursor + file.GetSize();
+    Mesh mesh;
+    std::vector<uint32_t> polygon;
+    for (size_t line = 1; cursor < fileEnd; ++line) {
+        const char* lineEnd = cursor;
+        while (lineEnd < fileEnd && *lineEnd != '\n') {
+            ++lineEnd;
+        }
+        LineTokenizer tokens(cursor, lineEnd);
+        const std::string_view keyword = tokens.Next();
+        if (keyword == "v") {
+            float values[6] = { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+            uint32_t count = 0;
+            for (std::string_view token = tokens.Next(); !token.empty() && count < 6; token = tokens.Next(), ++count) {
+                if (!ParseFloat(token, values[count])) {
+                    throw std::runtime_error("Invalid vertex at " + path.string() + ":" + std::to_string(line));
+                }
+            }
+            if (count < 2) {
+                throw std::runtime_error("Invalid vertex at " + path.string() + ":" + std::to_string(line));
+            }
+            mesh.vertices.push_back({ values[0], values[1], values[3], values[4], values[5] });
+        }
+        else if (keyword == "f") {
+            polygon.clear();
+            for (std::string_view token = tokens.Next(); !token.empty(); token = tokens.Next()) {
+                polygon.push_back(ParseFaceIndex(token, mesh.vertices.size(), path, line));
+            }
+            for (size_t i = 2; i < polygon.size(); ++i) {
+                mesh.indices.insert(mesh.indices.end(), { polygon[0], polygon[i - 1], polygon[i] });
+            }
+        }
+        cursor = lineEnd < fileEnd ? lineEnd + 1 : fileEnd;
+    }
+    return mesh;
+}
+
+bool IsMeshFile(const std::filesystem::path& path)
+{
+    std::string extension = path.extension().string();
+    for (char& c : extension) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return extension == ".obj";
+}
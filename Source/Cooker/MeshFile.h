@@ -0,0 +1,21 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+#include "../Render/BuiltinPipelineStates.h"
+
+// BuiltinPipeline::VertexColor で描画するインデックス付き三角形リスト
+struct Mesh {
+    std::vector<ColorVertex> vertices;
+    std::vector<uint32_t> indices;
+};
+
+// Wavefront OBJ を読み込む。対応する要素:
+//  - v x y [z [r g b]]: 位置（z は無視する）と頂点カラー（省略時は白）
+//  - f a b c ...: 多角形（扇形に三角形へ分割する）。"a/t/n" 形式は位置の番号だけを使い、負の番号は末尾からの相対位置
+// それ以外の行は無視する。
+// 例外: ファイルを読めない、または番号が範囲外の場合は std::runtime_error を送出
+Mesh LoadObjMesh(const std::filesystem::path& path);
+
+bool IsMeshFile(const std::filesystem::path& path);
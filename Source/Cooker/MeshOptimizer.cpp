@@ -0,0 +1,210 @@
+﻿#include "MeshOptimizer.h"
+#include "../Core/Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// Forsyth のアルゴリズムの模擬 LRU キャッシュのサイズとスコアの係数（原著の値）
+constexpr uint32_t FORSYTH_CACHE_SIZE = 32;
+constexpr float CACHE_DECAY_POWER = 1.5f;
+constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+constexpr float VALENCE_BOOST_SCALE = 2.0f;
+constexpr float VALENCE_BOOST_POWER = 0.5f;
+// 残りの三角形数のスコアを表で引く範囲
+constexpr uint32_t VALENCE_TABLE_SIZE = 64;
+
+struct ScoreTables {
+    float cache[FORSYTH_CACHE_SIZE];
+    float valence[VALENCE_TABLE_SIZE];
+};
+
+const ScoreTables& GetScoreTables()
+{
+    static const ScoreTables tables = [] {
+        ScoreTables t;
+        for (uint32_t i = 0; i < FORSYTH_CACHE_SIZE; ++i) {
+            // 直前の三角形の 3 頂点は、次の三角形で同じ辺を使いすぎないよう固定の低めの値にする
+            t.cache[i] = i < 3 ? LAST_TRIANGLE_SCORE : std::pow(1.0f - static_cast<float>(i - 3) / (FORSYTH_CACHE_SIZE - 3), CACHE_DECAY_POWER);
+        }
+        t.valence[0] = 0.0f;
+        for (uint32_t i = 1; i < VALENCE_TABLE_SIZE; ++i) {
+            t.valence[i] = VALENCE_BOOST_SCALE * std::pow(static_cast<float>(i), -VALENCE_BOOST_POWER);
+        }
+        return t;
+    }();
+    return tables;
+}
+
+float ComputeVertexScore(int32_t cachePosition, uint32_t remainingTriangles)
+{
+    if (remainingTriangles == 0) {
+        return -1.0f;
+    }
+    const ScoreTables& tables = GetScoreTables();
+    const float cacheScore = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+    const float valenceScore = remainingTriangles < VALENCE_TABLE_SIZE
+                                   ? tables.valence[remainingTriangles]
+                                   : VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+    return cacheScore + valenceScore;
+}
+
+} // namespace
+
+// 頂点ごとに未出力の三角形の一覧とスコアを持ち、出力した三角形の頂点をキャッシュの先頭へ移すたびに
+// キャッシュ内の頂点と、それを使う三角形のスコアだけを更新する。
+// 次の三角形はキャッシュ内の頂点を使う三角形から選び、候補がなければ未出力の三角形を先頭から探す。
+void OptimizeVertexCache(uint32_t* indices, size_t indexCount, uint32_t vertexCount)
+{
+    PROFILE_SCOPE("OptimizeVertexCache");
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // 頂点ごとの三角形の一覧（CSR 形式）
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        ++remaining[indices[i]];
+    }
+    std::vector<uint32_t> adjacencyOffsets(static_cast<size_t>(vertexCount) + 1, 0);
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        adjacencyOffsets[v + 1] = adjacencyOffsets[v] + remaining[v];
+    }
+    std::vector<uint32_t> adjacency(adjacencyOffsets[vertexCount]);
+    std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        for (uint32_t k = 0; k < 3; ++k) {
+            const uint32_t v = indices[t * 3 + k];
+            adjacency[fill[v]++] = static_cast<uint32_t>(t);
+        }
+    }
+
+    std::vector<int32_t> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        vertexScores[v] = ComputeVertexScore(-1, remaining[v]);
+    }
+    std::vector<float> triangleScores(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t) {
+        triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+    }
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+
+    uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+    uint32_t cacheCount = 0;
+    size_t nextUnemitted = 0;
+    size_t bestTriangle = 0;
+    float bestScore = triangleScores[0];
+    for (size_t t = 1; t < triangleCount; ++t) {
+        if (triangleScores[t] > bestScore) {
+            bestScore = triangleScores[t];
+            bestTriangle = t;
+        }
+    }
+
+    for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount) {
+        if (bestScore < 0.0f) {
+            while (emitted[nextUnemitted]) {
+                ++nextUnemitted;
+            }
+            bestTriangle = nextUnemitted;
+        }
+        const uint32_t* triangle = indices + bestTriangle * 3;
+        emitted[bestTriangle] = 1;
+        output.insert(output.end(), triangle, triangle + 3);
+
+        // 出力した三角形を各頂点の一覧から取り除く
+        for (uint32_t k = 0; k < 3; ++k) {
+            const uint32_t v = triangle[k];
+            uint32_t* begin = adjacency.data() + adjacencyOffsets[v];
+            uint32_t* end = begin + remaining[v];
+            std::iter_swap(std::find(begin, end, static_cast<uint32_t>(bestTriangle)), end - 1);
+            --remaining[v];
+        }
+
+        // 三角形の頂点を先頭に置き、残りの頂点を後ろにずらす（溢れた頂点はキャッシュから外れる）
+        uint32_t newCache[FORSYTH_CACHE_SIZE + 3];
+        uint32_t newCount = 0;
+        for (uint32_t k = 0; k < 3; ++k) {
+            newCache[newCount++] = triangle[k];
+        }
+        for (uint32_t i = 0; i < cacheCount; ++i) {
+            const uint32_t v = cache[i];
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                newCache[newCount++] = v;
+            }
+        }
+        for (uint32_t i = FORSYTH_CACHE_SIZE; i < newCount; ++i) {
+            cachePositions[newCache[i]] = -1;
+            vertexScores[newCache[i]] = ComputeVertexScore(-1, remaining[newCache[i]]);
+        }
+        cacheCount = (std::min)(newCount, FORSYTH_CACHE_SIZE);
+        std::memcpy(cache, newCache, cacheCount * sizeof(uint32_t));
+        for (uint32_t i = 0; i < cacheCount; ++i) {
+            cachePositions[cache[i]] = static_cast<int32_t>(i);
+            vertexScores[cache[i]] = ComputeVertexScore(static_cast<int32_t>(i), remaining[cache[i]]);
+        }
+
+        // キャッシュ内の頂点を使う三角形のスコアを更新し、その中から次の三角形を選ぶ
+        bestScore = -1.0f;
+        for (uint32_t i = 0; i < cacheCount; ++i) {
+            const uint32_t v = cache[i];
+            for (uint32_t j = 0; j < remaining[v]; ++j) {
+                const uint32_t t = adjacency[adjacencyOffsets[v] + j];
+                const float score = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+                triangleScores[t] = score;
+                if (score > bestScore) {
+                    bestScore = score;
+                    bestTriangle = t;
+                }
+            }
+        }
+    }
+    std::copy(output.begin(), output.end(), indices);
+}
+
+uint32_t OptimizeVertexFetch(void* vertices, uint32_t vertexCount, uint32_t vertexStride, uint32_t* indices, size_t indexCount)
+{
+    constexpr uint32_t UNUSED = UINT32_MAX;
+    std::vector<uint32_t> remap(vertexCount, UNUSED);
+    uint32_t nextVertex = 0;
+    for (size_t i = 0; i < indexCount; ++i) {
+        uint32_t& mapped = remap[indices[i]];
+        if (mapped == UNUSED) {
+            mapped = nextVertex++;
+        }
+        indices[i] = mapped;
+    }
+    const auto* source = static_cast<const uint8_t*>(vertices);
+    std::vector<uint8_t> reordered(static_cast<size_t>(nextVertex) * vertexStride);
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+        if (remap[v] != UNUSED) {
+            std::memcpy(reordered.data() + static_cast<size_t>(remap[v]) * vertexStride, source + static_cast<size_t>(v) * vertexStride, vertexStride);
+        }
+    }
+    std::memcpy(vertices, reordered.data(), reordered.size());
+    return nextVertex;
+}
+
+double ComputeAverageCacheMissRatio(const uint32_t* indices, size_t indexCount, uint32_t vertexCount, uint32_t cacheSize)
+{
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) {
+        return 0.0;
+    }
+    // 頂点ごとにキャッシュへ入れた時点の通し番号を持ち、cacheSize 回以上前に入れたものを追い出し済みとみなす
+    std::vector<uint64_t> insertedAt(vertexCount, 0);
+    uint64_t insertions = 0;
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        const uint32_t v = indices[i];
+        if (insertedAt[v] == 0 || insertions - insertedAt[v] >= cacheSize) {
+            insertedAt[v] = ++insertions;
+        }
+    }
+    return static_cast<double>(insertions) / static_cast<double>(triangleCount);
+}
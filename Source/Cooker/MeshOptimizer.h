@@ -0,0 +1,21 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// インデックス付き三角形リストの並べ替え。indices の値はすべて vertexCount 未満であること。
+
+// 頂点キャッシュのヒット率の計測に使う FIFO キャッシュのサイズ（一般的な GPU の後段頂点キャッシュ相当）
+constexpr uint32_t MEASURED_VERTEX_CACHE_SIZE = 16;
+
+// 三角形の順序を頂点キャッシュに合わせて並べ替える（Tom Forsyth の線形時間アルゴリズム）。
+// キャッシュ内の頂点と、残りの三角形が少ない頂点を使う三角形を優先して出力する。
+void OptimizeVertexCache(uint32_t* indices, size_t indexCount, uint32_t vertexCount);
+
+// 頂点を最初に参照される順に並べ替え、参照されない頂点を取り除いて indices を付け替える。
+// OptimizeVertexCache の後に呼ぶと、頂点の読み込みもほぼ連続したアドレスになる。
+// 戻り値: 残った頂点数（vertices の先頭に詰める）
+uint32_t OptimizeVertexFetch(void* vertices, uint32_t vertexCount, uint32_t vertexStride, uint32_t* indices, size_t indexCount);
+
+// cacheSize の FIFO キャッシュで 1 三角形あたりに変換する頂点数（ACMR、最小 0.5 程度、最大 3）
+double ComputeAverageCacheMissRatio(const uint32_t* indices, size_t indexCount, uint32_t vertexCount, uint32_t cacheSize = MEASURED_VERTEX_CACHE_SIZE);
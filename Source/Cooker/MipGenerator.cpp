@@ -0,0 +1,93 @@
+﻿#include "MipGenerator.h"
+#include "../Core/JobSystem.h"
+#include "../Core/Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 1 ジョブで縮小する出力の行数の目安
+constexpr uint32_t MIP_ROWS_PER_JOB = 16;
+// 線形値から sRGB への変換表の分解能
+constexpr uint32_t LINEAR_TO_SRGB_TABLE_SIZE = 4096;
+
+struct SrgbTables {
+    float toLinear[256];
+    uint8_t toSrgb[LINEAR_TO_SRGB_TABLE_SIZE + 1];
+};
+
+const SrgbTables& GetSrgbTables()
+{
+    static const SrgbTables tables = [] {
+        SrgbTables t;
+        for (uint32_t i = 0; i < 256; ++i) {
+            const float c = i / 255.0f;
+            t.toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        for (uint32_t i = 0; i <= LINEAR_TO_SRGB_TABLE_SIZE; ++i) {
+            const float l = static_cast<float>(i) / LINEAR_TO_SRGB_TABLE_SIZE;
+            const float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            t.toSrgb[i] = static_cast<uint8_t>(c * 255.0f + 0.5f);
+        }
+        return t;
+    }();
+    return tables;
+}
+
+// source の 2x2 画素を平均して destination の行 [beginRow, endRow) を作る
+void DownsampleRows(const Image& source, Image& destination, uint32_t beginRow, uint32_t endRow, bool srgb)
+{
+    const SrgbTables& tables = GetSrgbTables();
+    for (uint32_t y = beginRow; y < endRow; ++y) {
+        const uint32_t y0 = (std::min)(y * 2, source.height - 1);
+        const uint32_t y1 = (std::min)(y * 2 + 1, source.height - 1);
+        for (uint32_t x = 0; x < destination.width; ++x) {
+            const uint32_t x0 = (std::min)(x * 2, source.width - 1);
+            const uint32_t x1 = (std::min)(x * 2 + 1, source.width - 1);
+            const uint8_t* p[4] = { source.GetPixel(x0, y0), source.GetPixel(x1, y0), source.GetPixel(x0, y1), source.GetPixel(x1, y1) };
+            uint8_t* out = destination.GetPixel(x, y);
+            for (uint32_t c = 0; c < 3; ++c) {
+                if (srgb) {
+                    const float sum = tables.toLinear[p[0][c]] + tables.toLinear[p[1][c]] + tables.toLinear[p[2][c]] + tables.toLinear[p[3][c]];
+                    out[c] = tables.toSrgb[static_cast<uint32_t>(sum * 0.25f * LINEAR_TO_SRGB_TABLE_SIZE + 0.5f)];
+                }
+                else {
+                    out[c] = static_cast<uint8_t>((p[0][c] + p[1][c] + p[2][c] + p[3][c] + 2) / 4);
+                }
+            }
+            out[3] = static_cast<uint8_t>((p[0][3] + p[1][3] + p[2][3] + p[3][3] + 2) / 4);
+        }
+    }
+}
+
+} // namespace
+
+uint32_t GetMipCount(uint32_t width, uint32_t height, uint32_t minSize)
+{
+    uint32_t count = 1;
+    while ((width > minSize || height > minSize) && (width > 1 || height > 1)) {
+        width = (std::max)(width / 2, 1u);
+        height = (std::max)(height / 2, 1u);
+        ++count;
+    }
+    return count;
+}
+
+std::vector<Image> GenerateMipChain(const Image& source, const MipSettings& settings, JobSystem& jobs)
+{
+    PROFILE_SCOPE("GenerateMipChain");
+    const uint32_t mipCount = GetMipCount(source.width, source.height, settings.minSize);
+    std::vector<Image> mips(mipCount);
+    mips[0] = source;
+    for (uint32_t level = 1; level < mipCount; ++level) {
+        const Image& upper = mips[level - 1];
+        Image& mip = mips[level];
+        mip.width = (std::max)(upper.width / 2, 1u);
+        mip.height = (std::max)(upper.height / 2, 1u);
+        mip.pixels.resize(static_cast<size_t>(mip.width) * mip.height * 4);
+        jobs.ParallelFor(mip.height, MIP_ROWS_PER_JOB, [&](uint32_t begin, uint32_t end) {
+            DownsampleRows(upper, mip, begin, end, settings.srgb);
+        });
+    }
+    return mips;
+}
@@ -0,0 +1,22 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "ImageFile.h"
+
+class JobSystem;
+
+struct MipSettings {
+    // 色を sRGB として線形空間で平均する（アルファは常に線形）
+    bool srgb = true;
+    // 生成する最小の辺の長さ（1 の場合は 1x1 まで）
+    uint32_t minSize = 1;
+};
+
+// source を最上位として、各辺を半分（切り捨て、最小 1）にしたミップを minSize まで生成する。
+// 各画素は 1 つ上のミップの 2x2 画素の平均（奇数の辺は端の画素を重複して使う）。
+// 行単位でジョブシステム上に分割して並列に処理する。
+// 戻り値: 最上位（source の複製）を含むミップの配列
+std::vector<Image> GenerateMipChain(const Image& source, const MipSettings& settings, JobSystem& jobs);
+
+uint32_t GetMipCount(uint32_t width, uint32_t height, uint32_t minSize = 1);
@@ -0,0 +1,43 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// 指定したアライメントでメモリを確保する STL アロケータ。
+// SIMD のアラインされたロード/ストアを使う SoA 配列に使用する。
+template <typename T, size_t Alignment>
+class AlignedAllocator {
+public:
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept
+    {
+    }
+
+    T* allocate(size_t count)
+    {
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{ Alignment }));
+    }
+    void deallocate(T* pointer, size_t) noexcept
+    {
+        ::operator delete(pointer, std::align_val_t{ Alignment });
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept
+    {
+        return true;
+    }
+};
+
+// 32 バイト（AVX のレジスタ幅）境界にそろえた配列
+template <typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T, 32>>;
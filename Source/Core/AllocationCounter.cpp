@@ -0,0 +1,169 @@
+﻿#include "AllocationCounter.h"
+#include "AllocationTracker.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<uint64_t> g_allocationCount{ 0 };
+std::atomic<uint64_t> g_allocatedBytes{ 0 };
+std::atomic<uint64_t> g_freeCount{ 0 };
+
+void* CountedAllocate(std::size_t size, std::size_t alignment)
+{
+    g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    RecordHeapAllocation(size);
+    if (size == 0) {
+        size = 1;
+    }
+    if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        return std::malloc(size);
+    }
+#ifdef _MSC_VER
+    return _aligned_malloc(size, alignment);
+#else
+    // aligned_alloc はサイズがアライメントの倍数である必要がある
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+void CountedFree(void* pointer, std::size_t alignment) noexcept
+{
+    if (!pointer) {
+        return;
+    }
+    g_freeCount.fetch_add(1, std::memory_order_relaxed);
+#ifdef _MSC_VER
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        _aligned_free(pointer);
+        return;
+    }
+#else
+    (void)alignment;
+#endif
+    std::free(pointer);
+}
+
+void* AllocateOrThrow(std::size_t size, std::size_t alignment)
+{
+    void* pointer = CountedAllocate(size, alignment);
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+constexpr std::size_t DEFAULT_ALIGNMENT = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+} // namespace
+
+AllocationCounts GetAllocationCounts()
+{
+    AllocationCounts counts;
+    counts.allocationCount = g_allocationCount.load(std::memory_order_relaxed);
+    counts.allocatedBytes = g_allocatedBytes.load(std::memory_order_relaxed);
+    counts.freeCount = g_freeCount.load(std::memory_order_relaxed);
+    return counts;
+}
+
+void* operator new(std::size_t size)
+{
+    return AllocateOrThrow(size, DEFAULT_ALIGNMENT);
+}
+
+void* operator new[](std::size_t size)
+{
+    return AllocateOrThrow(size, DEFAULT_ALIGNMENT);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAllocate(size, DEFAULT_ALIGNMENT);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    return CountedAllocate(size, DEFAULT_ALIGNMENT);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return AllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return AllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return CountedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return CountedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* pointer) noexcept
+{
+    CountedFree(pointer, DEFAULT_ALIGNMENT);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    CountedFree(pointer, DEFAULT_ALIGNMENT);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    CountedFree(pointer, DEFAULT_ALIGNMENT);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    CountedFree(pointer, DEFAULT_ALIGNMENT);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+    CountedFree(pointer, DEFAULT_ALIGNMENT);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+    CountedFree(pointer, DEFAULT_ALIGNMENT);
+}
+
+void operator delete(void* pointer, std::align_val_t alignment) noexcept
+{
+    CountedFree(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* pointer, std::align_val_t alignment) noexcept
+{
+    CountedFree(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t alignment) noexcept
+{
+    CountedFree(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t alignment) noexcept
+{
+    CountedFree(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    CountedFree(pointer, static_cast<std::size_t>(alignment));
+}
+
+void operator delete[](void* pointer, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    CountedFree(pointer, static_cast<std::size_t>(alignment));
+}
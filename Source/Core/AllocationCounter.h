@@ -0,0 +1,17 @@
+﻿#pragma once
+
+#include <cstdint>
+
+// グローバルな operator new/delete を置き換えて、ヒープ確保の回数とバイト数を数える。
+// ベンチマークで計測区間の前後の差を取り、フレームあたりの確保数を求めるために使用する。
+// カウンタはスレッド間で共有する relaxed なアトミック変数で、確保 1 回あたりのコストは加算 2 回のみ。
+// 用途ごとの内訳はスレッドごとのカウンタにも加算する（AllocationTracker.h）。
+
+struct AllocationCounts {
+    uint64_t allocationCount = 0;
+    uint64_t allocatedBytes = 0; // 要求されたサイズの合計（解放しても減らない）
+    uint64_t freeCount = 0;
+};
+
+// プログラム開始からの累計
+AllocationCounts GetAllocationCounts();
@@ -0,0 +1,135 @@
+﻿#include "AllocationTracker.h"
+#include <atomic>
+
+namespace {
+
+// カウンタのブロックを専有できるスレッド数（超えたスレッドは共有ブロックをアトミックに加算する）
+constexpr uint32_t MAX_TRACKED_THREADS = 64;
+
+enum CounterIndex : uint32_t {
+    HEAP_ALLOCATIONS,
+    HEAP_BYTES,
+    POOL_ALLOCATIONS,
+    POOL_BYTES,
+    COUNTER_COUNT,
+};
+
+// 1 スレッド分のカウンタ。書き込むのは所有するスレッドだけなので、読み取りと加算を分けても値は失われない
+struct alignas(64) ThreadCounters {
+    std::atomic<uint64_t> values[ALLOCATION_TAG_COUNT][COUNTER_COUNT];
+};
+
+// ゼロ初期化される静的配列（operator new から使うため、動的な初期化や確保を伴わないこと）
+ThreadCounters g_threadCounters[MAX_TRACKED_THREADS];
+ThreadCounters g_sharedCounters;
+std::atomic<uint32_t> g_threadCounterCount{ 0 };
+
+thread_local ThreadCounters* t_counters = nullptr;
+thread_local AllocationTag t_tag = AllocationTag::Untagged;
+
+void AddCounters(uint64_t allocationCounter, uint64_t bytes)
+{
+    ThreadCounters* counters = t_counters;
+    if (!counters) {
+        const uint32_t index = g_threadCounterCount.fetch_add(1, std::memory_order_relaxed);
+        counters = index < MAX_TRACKED_THREADS ? &g_threadCounters[index] : &g_sharedCounters;
+        t_counters = counters;
+    }
+    std::atomic<uint64_t>* values = counters->values[static_cast<uint32_t>(t_tag)];
+    if (counters == &g_sharedCounters) {
+        values[allocationCounter].fetch_add(1, std::memory_order_relaxed);
+        values[allocationCounter + 1].fetch_add(bytes, std::memory_order_relaxed);
+        return;
+    }
+    values[allocationCounter].store(values[allocationCounter].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    values[allocationCounter + 1].store(values[allocationCounter + 1].load(std::memory_order_relaxed) + bytes, std::memory_order_relaxed);
+}
+
+void AddTotals(const ThreadCounters& counters, uint32_t tag, TaggedAllocationCounts& totals)
+{
+    totals.heapAllocations += counters.values[tag][HEAP_ALLOCATIONS].load(std::memory_order_relaxed);
+    totals.heapBytes += counters.values[tag][HEAP_BYTES].load(std::memory_order_relaxed);
+    totals.poolAllocations += counters.values[tag][POOL_ALLOCATIONS].load(std::memory_order_relaxed);
+    totals.poolBytes += counters.values[tag][POOL_BYTES].load(std::memory_order_relaxed);
+}
+
+} // namespace
+
+const char* GetAllocationTagName(AllocationTag tag)
+{
+    switch (tag) {
+    case AllocationTag::Untagged:
+        return "untagged";
+    case AllocationTag::Scene:
+        return "scene";
+    case AllocationTag::Instances:
+        return "instances";
+    case AllocationTag::RenderGraph:
+        return "renderGraph";
+    case AllocationTag::CommandRecording:
+        return "commandRecording";
+    case AllocationTag::Particles:
+        return "particles";
+    case AllocationTag::Jobs:
+        return "jobs";
+    case AllocationTag::Count:
+        break;
+    }
+    return "unknown";
+}
+
+AllocationTag GetCurrentAllocationTag()
+{
+    return t_tag;
+}
+
+AllocationTag SetCurrentAllocationTag(AllocationTag tag)
+{
+    const AllocationTag previous = t_tag;
+    t_tag = tag;
+    return previous;
+}
+
+void RecordHeapAllocation(uint64_t bytes)
+{
+    AddCounters(HEAP_ALLOCATIONS, bytes);
+}
+
+void RecordPoolAllocation(uint64_t bytes)
+{
+    AddCounters(POOL_ALLOCATIONS, bytes);
+}
+
+TaggedAllocationCounts GetTaggedAllocationCounts(AllocationTag tag)
+{
+    TaggedAllocationCounts totals;
+    const uint32_t threadCount = g_threadCounterCount.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < threadCount && i < MAX_TRACKED_THREADS; ++i) {
+        AddTotals(g_threadCounters[i], static_cast<uint32_t>(tag), totals);
+    }
+    AddTotals(g_sharedCounters, static_cast<uint32_t>(tag), totals);
+    return totals;
+}
+
+void AllocationTracker::Reset()
+{
+    for (uint32_t tag = 0; tag < ALLOCATION_TAG_COUNT; ++tag) {
+        previousTotals[tag] = GetTaggedAllocationCounts(static_cast<AllocationTag>(tag));
+        lastFrame[tag] = {};
+    }
+    frameCount = 0;
+}
+
+void AllocationTracker::EndFrame()
+{
+    for (uint32_t tag = 0; tag < ALLOCATION_TAG_COUNT; ++tag) {
+        const TaggedAllocationCounts totals = GetTaggedAllocationCounts(static_cast<AllocationTag>(tag));
+        TaggedAllocationCounts& frame = lastFrame[tag];
+        frame.heapAllocations = totals.heapAllocations - previousTotals[tag].heapAllocations;
+        frame.heapBytes = totals.heapBytes - previousTotals[tag].heapBytes;
+        frame.poolAllocations = totals.poolAllocations - previousTotals[tag].poolAllocations;
+        frame.poolBytes = totals.poolBytes - previousTotals[tag].poolBytes;
+        previousTotals[tag] = totals;
+    }
+    ++frameCount;
+}
@@ -0,0 +1,69 @@
+﻿#pragma once
+
+#include <cstdint>
+
+// 確保の用途（サブシステム）。スレッドごとに現在の用途を持ち、その間の確保をこの用途として数える
+enum class AllocationTag : uint8_t {
+    Untagged,
+    Scene,            // シーンの更新
+    Instances,        // インスタンスの更新/スナップショット/描画アイテムの書き出し
+    RenderGraph,      // レンダーグラフの構築と実行
+    CommandRecording, // 描画コマンドの並列記録
+    Particles,        // 粒子の更新と書き出し、非同期コンピュートへの投入
+    Jobs,             // ジョブシステムのジョブ
+    Count,
+};
+
+constexpr uint32_t ALLOCATION_TAG_COUNT = static_cast<uint32_t>(AllocationTag::Count);
+
+const char* GetAllocationTagName(AllocationTag tag);
+
+// 用途ごとの確保数
+struct TaggedAllocationCounts {
+    uint64_t heapAllocations = 0; // operator new の回数
+    uint64_t heapBytes = 0;
+    uint64_t poolAllocations = 0; // フレームアリーナ/固定サイズプールからの切り出し（ヒープを使わない）
+    uint64_t poolBytes = 0;
+};
+
+// 現在のスレッドの用途
+AllocationTag GetCurrentAllocationTag();
+// 戻り値: 直前の用途
+AllocationTag SetCurrentAllocationTag(AllocationTag tag);
+
+// スコープの間だけ現在のスレッドの用途を切り替える
+class AllocationTagScope {
+public:
+    explicit AllocationTagScope(AllocationTag tag) : previous(SetCurrentAllocationTag(tag)) {}
+    ~AllocationTagScope() { SetCurrentAllocationTag(previous); }
+    AllocationTagScope(const AllocationTagScope&) = delete;
+    AllocationTagScope& operator=(const AllocationTagScope&) = delete;
+
+private:
+    AllocationTag previous;
+};
+
+// 現在のスレッドの用途で数える（ヒープは AllocationCounter の operator new から呼び出す）
+void RecordHeapAllocation(uint64_t bytes);
+void RecordPoolAllocation(uint64_t bytes);
+
+// プログラム開始からの用途ごとの累計（全スレッドの合計）
+TaggedAllocationCounts GetTaggedAllocationCounts(AllocationTag tag);
+
+// 用途ごとの確保数をフレーム単位に区切る。
+// カウンタはスレッドごとに分けて持ち、確保 1 回あたりのコストは競合しない加算だけにする。
+class AllocationTracker {
+public:
+    // 現在の累計を基準にして計測をやり直す
+    void Reset();
+    // 前回の EndFrame（または Reset）からの差分を 1 フレーム分として締める
+    void EndFrame();
+
+    const TaggedAllocationCounts& GetLastFrame(AllocationTag tag) const { return lastFrame[static_cast<uint32_t>(tag)]; }
+    uint64_t GetFrameCount() const { return frameCount; }
+
+private:
+    TaggedAllocationCounts previousTotals[ALLOCATION_TAG_COUNT];
+    TaggedAllocationCounts lastFrame[ALLOCATION_TAG_COUNT];
+    uint64_t frameCount = 0;
+};
@@ -0,0 +1,30 @@
+﻿#pragma once
+
+#include <cstdint>
+
+// x86/x64 向けに SIMD 版の実装をビルドするかどうか
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SIMD_X86 1
+#else
+#define SIMD_X86 0
+#endif
+
+// AVX2 版の関数に付ける属性。MSVC は /arch 指定なしで AVX2 の組み込み関数を生成できるが、
+// GCC/Clang は関数単位でターゲットを有効にする必要がある。
+#if SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+#define SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define SIMD_TARGET_AVX2
+#endif
+
+// 実行時に選択する SIMD 実装のレベル
+enum class SimdLevel : uint8_t {
+    Scalar,
+    SSE2,
+    AVX2,
+};
+
+// 実行中の CPU と OS がサポートする最上位のレベルを返す（結果はキャッシュされる）
+SimdLevel GetSupportedSimdLevel();
+
+const char* GetSimdLevelName(SimdLevel level);
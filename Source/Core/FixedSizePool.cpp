@@ -0,0 +1,137 @@
+﻿#include "FixedSizePool.h"
+#include "AllocationTracker.h"
+#include "JobSystem.h"
+#include <algorithm>
+
+FixedSizePool::~FixedSizePool()
+{
+    ReleaseChunks();
+}
+
+void FixedSizePool::Initialize(size_t blockSize, size_t blockAlignment, uint32_t blocksPerChunk, uint32_t workerCount)
+{
+    ReleaseChunks();
+    this->blockAlignment = std::max(blockAlignment, alignof(FreeBlock));
+    // 空きリストのリンクを置けて、並べてもアライメントが崩れない大きさにそろえる
+    this->blockSize = (std::max(blockSize, sizeof(FreeBlock)) + this->blockAlignment - 1) / this->blockAlignment * this->blockAlignment;
+    this->blocksPerChunk = std::max(blocksPerChunk, BATCH_SIZE);
+    cacheCount = workerCount;
+    caches = std::make_unique<WorkerCache[]>(workerCount);
+}
+
+// ワーカーはキャッシュから取り出すだけ（空のときだけ共有リストから補充する）
+void* FixedSizePool::Allocate()
+{
+    const uint32_t workerIndex = JobSystem::GetCurrentWorkerIndex();
+    FreeBlock* block = nullptr;
+    if (workerIndex < cacheCount) {
+        WorkerCache& cache = caches[workerIndex];
+        if (!cache.head) {
+            Refill(cache);
+        }
+        block = cache.head;
+        cache.head = block->next;
+        --cache.count;
+    }
+    else {
+        std::lock_guard<std::mutex> lock(sharedMutex);
+        if (!sharedHead) {
+            uint32_t count = 0;
+            sharedHead = AllocateChunk(count);
+        }
+        block = sharedHead;
+        sharedHead = block->next;
+    }
+    RecordPoolAllocation(blockSize);
+    return block;
+}
+
+void FixedSizePool::Free(void* pointer)
+{
+    if (!pointer) {
+        return;
+    }
+    FreeBlock* block = static_cast<FreeBlock*>(pointer);
+    const uint32_t workerIndex = JobSystem::GetCurrentWorkerIndex();
+    if (workerIndex < cacheCount) {
+        WorkerCache& cache = caches[workerIndex];
+        block->next = cache.head;
+        cache.head = block;
+        if (++cache.count >= BATCH_SIZE * 2) {
+            Drain(cache);
+        }
+        return;
+    }
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    block->next = sharedHead;
+    sharedHead = block;
+}
+
+uint32_t FixedSizePool::GetChunkCount() const
+{
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    return static_cast<uint32_t>(chunks.size());
+}
+
+void FixedSizePool::Refill(WorkerCache& cache)
+{
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    if (!sharedHead) {
+        uint32_t count = 0;
+        cache.head = AllocateChunk(count);
+        cache.count = count;
+        return;
+    }
+    FreeBlock* head = sharedHead;
+    FreeBlock* tail = head;
+    uint32_t count = 1;
+    while (count < BATCH_SIZE && tail->next) {
+        tail = tail->next;
+        ++count;
+    }
+    sharedHead = tail->next;
+    tail->next = cache.head;
+    cache.head = head;
+    cache.count += count;
+}
+
+void FixedSizePool::Drain(WorkerCache& cache)
+{
+    FreeBlock* head = cache.head;
+    FreeBlock* tail = head;
+    for (uint32_t i = 1; i < BATCH_SIZE; ++i) {
+        tail = tail->next;
+    }
+    cache.head = tail->next;
+    cache.count -= BATCH_SIZE;
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    tail->next = sharedHead;
+    sharedHead = head;
+}
+
+// 呼び出し元で sharedMutex を取得しておくこと。
+// 戻り値: 新しいチャンクのブロックをつないだリスト（count にブロック数）
+FixedSizePool::FreeBlock* FixedSizePool::AllocateChunk(uint32_t& count)
+{
+    std::byte* chunk = static_cast<std::byte*>(::operator new(blockSize * blocksPerChunk, std::align_val_t{ blockAlignment }));
+    chunks.push_back(chunk);
+    FreeBlock* head = nullptr;
+    for (uint32_t i = blocksPerChunk; i-- > 0;) {
+        FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + blockSize * i);
+        block->next = head;
+        head = block;
+    }
+    count = blocksPerChunk;
+    return head;
+}
+
+void FixedSizePool::ReleaseChunks()
+{
+    for (void* chunk : chunks) {
+        ::operator delete(chunk, std::align_val_t{ blockAlignment });
+    }
+    chunks.clear();
+    sharedHead = nullptr;
+    caches.reset();
+    cacheCount = 0;
+}
@@ -0,0 +1,91 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+// 同じ大きさのブロックを切り出すプール。
+// ジョブシステムのワーカーごとにキャッシュ（空きリスト）を持ち、確保/解放はロックなしでキャッシュに対して行う。
+// キャッシュが空になったとき/溜まりすぎたときだけ、共有の空きリストと BATCH_SIZE 個ずつまとめて受け渡す。
+// 別のスレッドで確保したブロックを解放してもよい（解放したスレッドのキャッシュに入る）。
+// ワーカー以外のスレッドは共有の空きリストをロックして直接使う。
+class FixedSizePool {
+public:
+    static constexpr uint32_t BATCH_SIZE = 64;
+
+    FixedSizePool() = default;
+    ~FixedSizePool();
+    FixedSizePool(const FixedSizePool&) = delete;
+    FixedSizePool& operator=(const FixedSizePool&) = delete;
+
+    // 引数:
+    //  - blockSize/blockAlignment: ブロックの大きさとアライメント
+    //  - blocksPerChunk: ブロックが足りないときにまとめて確保する数
+    //  - workerCount: キャッシュを持つワーカー数（JobSystem::GetThreadCount()）
+    // 以前のブロックはすべて解放する（使用中のブロックがないこと）
+    void Initialize(size_t blockSize, size_t blockAlignment, uint32_t blocksPerChunk, uint32_t workerCount);
+
+    // 例外: チャンクを確保できない場合は std::bad_alloc を送出
+    void* Allocate();
+    void Free(void* block);
+
+    size_t GetBlockSize() const { return blockSize; }
+    // 確保済みのチャンク数（一度確保したチャンクは Initialize/破棄まで解放しない）
+    uint32_t GetChunkCount() const;
+
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+    struct alignas(64) WorkerCache {
+        FreeBlock* head = nullptr;
+        uint32_t count = 0;
+    };
+
+    // 共有の空きリストから最大 BATCH_SIZE 個を cache へ移す（空なら新しいチャンクを切り出す）
+    void Refill(WorkerCache& cache);
+    // cache から BATCH_SIZE 個を共有の空きリストへ戻す
+    void Drain(WorkerCache& cache);
+    FreeBlock* AllocateChunk(uint32_t& count);
+    void ReleaseChunks();
+
+    size_t blockSize = 0;
+    size_t blockAlignment = alignof(std::max_align_t);
+    uint32_t blocksPerChunk = 0;
+    std::unique_ptr<WorkerCache[]> caches;
+    uint32_t cacheCount = 0;
+
+    mutable std::mutex sharedMutex;
+    FreeBlock* sharedHead = nullptr;
+    std::vector<void*> chunks;
+};
+
+// FixedSizePool から T を作成/破棄する
+template <typename T>
+class ObjectPool {
+public:
+    void Initialize(uint32_t objectsPerChunk, uint32_t workerCount)
+    {
+        pool.Initialize(sizeof(T), alignof(T), objectsPerChunk, workerCount);
+    }
+
+    template <typename... Args>
+    T* New(Args&&... args)
+    {
+        return new (pool.Allocate()) T(std::forward<Args>(args)...);
+    }
+    void Delete(T* object)
+    {
+        object->~T();
+        pool.Free(object);
+    }
+
+    const FixedSizePool& GetPool() const { return pool; }
+
+private:
+    FixedSizePool pool;
+};
@@ -0,0 +1,52 @@
+﻿#include "FixedTimestep.h"
+#include <algorithm>
+
+// 引数:
+//  - stepNs: 1 ステップの長さ（0 の場合は 1ns として扱う）
+//  - maxStepsPerAdvance: 処理が追いつかないときに 1 回で実行するステップ数の上限
+void FixedTimestep::Initialize(uint64_t stepNs, uint32_t maxStepsPerAdvance)
+{
+    this->stepNs = std::max<uint64_t>(stepNs, 1);
+    this->maxStepsPerAdvance = std::max<uint32_t>(maxStepsPerAdvance, 1);
+    Reset(0);
+}
+
+void FixedTimestep::Reset(uint64_t nowNs)
+{
+    lastTimeNs = nowNs;
+    stateTimeNs = nowNs;
+    accumulatedNs = 0;
+    stepCount = 0;
+    droppedNs = 0;
+}
+
+// 上限を超えたステップは実行せずに時間だけ進め、状態の時刻が時計から離れていかないようにする
+// （処理落ちが続くとステップが溜まり続けて回復できなくなるのを防ぐ）。
+// 時計が戻った場合は経過 0 として扱う。
+uint32_t FixedTimestep::Advance(uint64_t nowNs)
+{
+    if (nowNs > lastTimeNs) {
+        accumulatedNs += nowNs - lastTimeNs;
+        lastTimeNs = nowNs;
+    }
+    const uint64_t pendingSteps = accumulatedNs / stepNs;
+    accumulatedNs -= pendingSteps * stepNs;
+    stateTimeNs += pendingSteps * stepNs;
+
+    const uint32_t steps = static_cast<uint32_t>(std::min<uint64_t>(pendingSteps, maxStepsPerAdvance));
+    droppedNs += (pendingSteps - steps) * stepNs;
+    stepCount += steps;
+    return steps;
+}
+
+// 2 状態の時刻が同じ（まだ 1 回しか公開していない）場合は最新の状態をそのまま使う
+float GetInterpolationAlpha(uint64_t previousTimeNs, uint64_t currentTimeNs, uint64_t renderTimeNs)
+{
+    if (currentTimeNs <= previousTimeNs || renderTimeNs >= currentTimeNs) {
+        return 1.0f;
+    }
+    if (renderTimeNs <= previousTimeNs) {
+        return 0.0f;
+    }
+    return static_cast<float>(static_cast<double>(renderTimeNs - previousTimeNs) / static_cast<double>(currentTimeNs - previousTimeNs));
+}
@@ -0,0 +1,44 @@
+﻿#pragma once
+
+#include <cstdint>
+
+// 固定刻みのシミュレーション時間を管理するアキュムレータ。
+// 時刻はすべて呼び出し側の時計のナノ秒で受け取り、実時間に依存しないため模擬クロックでも使用できる。
+// 経過時間を整数で積算するので、刻みの数え漏れや浮動小数点の誤差の蓄積は起こらない。
+class FixedTimestep {
+public:
+    // stepNs: 1 ステップの長さ
+    // maxStepsPerAdvance: 1 回の Advance で実行するステップ数の上限（超えた分の時間は捨てる）
+    void Initialize(uint64_t stepNs, uint32_t maxStepsPerAdvance);
+    // nowNs を時刻 0 のステップの開始として積算をやり直す
+    void Reset(uint64_t nowNs);
+
+    // nowNs までに経過した時間を積算する。
+    // 戻り値: 今回実行すべきステップ数（0 ～ maxStepsPerAdvance）
+    uint32_t Advance(uint64_t nowNs);
+
+    uint64_t GetStepNs() const { return stepNs; }
+    float GetStepSeconds() const { return static_cast<float>(static_cast<double>(stepNs) / 1e9); }
+    // 最新の状態が表す時刻（呼び出し側の時計の値。捨てた時間も含めて進める）
+    uint64_t GetStateTimeNs() const { return stateTimeNs; }
+    // 次のステップを実行できるようになる時刻
+    uint64_t GetNextStepTimeNs() const { return stateTimeNs + stepNs; }
+    // 積算済みでまだステップに消費していない時間（0 ～ stepNs - 1）
+    uint64_t GetAccumulatedNs() const { return accumulatedNs; }
+    uint64_t GetStepCount() const { return stepCount; }
+    // 上限を超えたために捨てた時間の合計
+    uint64_t GetDroppedNs() const { return droppedNs; }
+
+private:
+    uint64_t stepNs = 1;
+    uint32_t maxStepsPerAdvance = 1;
+    uint64_t lastTimeNs = 0;
+    uint64_t stateTimeNs = 0;
+    uint64_t accumulatedNs = 0;
+    uint64_t stepCount = 0;
+    uint64_t droppedNs = 0;
+};
+
+// renderTimeNs が previousTimeNs ～ currentTimeNs の 2 状態のどこにあたるか（0 = previous、1 = current。範囲外は端に丸める）。
+// 描画側は 1 ステップ遅らせた時刻を渡すことで、常に公開済みの 2 状態の間を補間できる
+float GetInterpolationAlpha(uint64_t previousTimeNs, uint64_t currentTimeNs, uint64_t renderTimeNs);
@@ -0,0 +1,120 @@
+﻿#include "FrameArena.h"
+#include "AllocationTracker.h"
+#include <algorithm>
+
+namespace {
+
+// ブロックの先頭のアライメント（キャッシュライン）
+constexpr size_t BLOCK_ALIGNMENT = 64;
+
+std::byte* AlignPointer(std::byte* pointer, size_t alignment)
+{
+    const uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+    return pointer + (((address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1)) - address);
+}
+
+} // namespace
+
+FrameArena::~FrameArena()
+{
+    ReleaseBlocks();
+}
+
+// 引数:
+//  - blockSize: 最初のブロックと追加するブロックの大きさ
+void FrameArena::Initialize(size_t blockSize)
+{
+    ReleaseBlocks();
+    this->blockSize = std::max<size_t>(blockSize, BLOCK_ALIGNMENT);
+    capacity = this->blockSize;
+    base = static_cast<std::byte*>(::operator new(capacity, std::align_val_t{ BLOCK_ALIGNMENT }));
+    offset.store(0, std::memory_order_relaxed);
+    peakBytes = 0;
+}
+
+// 最初のブロックに収まる間はロックを取らずにオフセットを進め、収まらなければ追加のブロックから切り出す
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+    if (!base) {
+        return AllocateOverflow(size, alignment);
+    }
+    size_t current = offset.load(std::memory_order_relaxed);
+    while (true) {
+        const size_t aligned = static_cast<size_t>(AlignPointer(base + std::min(current, capacity), alignment) - base);
+        const size_t next = aligned + size;
+        if (next > capacity) {
+            return AllocateOverflow(size, alignment);
+        }
+        if (offset.compare_exchange_weak(current, next, std::memory_order_relaxed)) {
+            RecordPoolAllocation(size);
+            return base + aligned;
+        }
+    }
+}
+
+void FrameArena::Reset()
+{
+    const size_t usedBytes = GetUsedBytes();
+    peakBytes = std::max(peakBytes, usedBytes);
+    if (overflowBlocks) {
+        // 次のフレームからは最大使用量が 1 ブロックに収まるように作り直す
+        ReleaseOverflowBlocks();
+        ::operator delete(base, std::align_val_t{ BLOCK_ALIGNMENT });
+        capacity = (peakBytes + blockSize - 1) / blockSize * blockSize;
+        base = static_cast<std::byte*>(::operator new(capacity, std::align_val_t{ BLOCK_ALIGNMENT }));
+    }
+    overflowBytes = 0;
+    overflowBlockCount = 0;
+    offset.store(0, std::memory_order_relaxed);
+}
+
+size_t FrameArena::GetUsedBytes() const
+{
+    return std::min(offset.load(std::memory_order_relaxed), capacity) + overflowBytes;
+}
+
+// 例外: ブロックを確保できない場合は std::bad_alloc を送出
+void* FrameArena::AllocateOverflow(size_t size, size_t alignment)
+{
+    std::lock_guard<std::mutex> lock(overflowMutex);
+    std::byte* aligned = overflowCursor ? AlignPointer(overflowCursor, alignment) : nullptr;
+    if (!aligned || aligned + size > overflowEnd) {
+        const size_t blockBytes = sizeof(OverflowBlock) + std::max(blockSize, size + alignment);
+        OverflowBlock* block = static_cast<OverflowBlock*>(::operator new(blockBytes));
+        block->next = overflowBlocks;
+        overflowBlocks = block;
+        ++overflowBlockCount;
+        overflowCursor = reinterpret_cast<std::byte*>(block + 1);
+        overflowEnd = reinterpret_cast<std::byte*>(block) + blockBytes;
+        aligned = AlignPointer(overflowCursor, alignment);
+    }
+    overflowBytes += static_cast<size_t>(aligned + size - overflowCursor);
+    overflowCursor = aligned + size;
+    RecordPoolAllocation(size);
+    return aligned;
+}
+
+void FrameArena::ReleaseOverflowBlocks()
+{
+    OverflowBlock* block = overflowBlocks;
+    while (block) {
+        OverflowBlock* next = block->next;
+        ::operator delete(block);
+        block = next;
+    }
+    overflowBlocks = nullptr;
+    overflowCursor = nullptr;
+    overflowEnd = nullptr;
+}
+
+void FrameArena::ReleaseBlocks()
+{
+    ReleaseOverflowBlocks();
+    overflowBytes = 0;
+    overflowBlockCount = 0;
+    if (base) {
+        ::operator delete(base, std::align_val_t{ BLOCK_ALIGNMENT });
+        base = nullptr;
+    }
+    capacity = 0;
+}
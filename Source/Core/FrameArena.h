@@ -0,0 +1,77 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// フレーム単位でまとめて解放する線形アロケータ。
+// 複数のスレッドから同時に Allocate でき、通常はブロック内のオフセットを CAS で進めるだけで確保する。
+// ブロックが足りない場合はロックを取って追加のブロックをつなぎ、次の Reset で使用量の最大値に合わせた
+// 1 ブロックへまとめ直す（定常状態ではヒープを使わない）。
+// デストラクタは呼び出さないため、トリビアルに破棄できる型だけを置くこと。
+class FrameArena {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 256 * 1024;
+
+    FrameArena() = default;
+    ~FrameArena();
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // 最初のブロックを確保する（既存のブロックは解放する）
+    void Initialize(size_t blockSize = DEFAULT_BLOCK_SIZE);
+
+    // size バイトを alignment 境界（2 のべき乗）で確保する。次の Reset まで有効
+    // 例外: 追加のブロックを確保できない場合は std::bad_alloc を送出
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    template <typename T>
+    T* AllocateArray(size_t count)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "FrameArena does not run destructors");
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+    template <typename T, typename... Args>
+    T* New(Args&&... args)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "FrameArena does not run destructors");
+        return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // すべての確保を解放する。Allocate と同時に呼び出さないこと（確保した領域を参照し終えた後に呼び出す）
+    void Reset();
+
+    // 今回の Reset 以降に使用したバイト数（アライメントの詰め物を含む）
+    size_t GetUsedBytes() const;
+    size_t GetCapacity() const { return capacity; }
+    // これまでの 1 フレームの使用量の最大値
+    size_t GetPeakBytes() const { return peakBytes; }
+    // 今フレームに追加したブロック数
+    uint32_t GetOverflowBlockCount() const { return overflowBlockCount; }
+
+private:
+    struct OverflowBlock {
+        OverflowBlock* next;
+    };
+
+    void* AllocateOverflow(size_t size, size_t alignment);
+    void ReleaseOverflowBlocks();
+    void ReleaseBlocks();
+
+    std::byte* base = nullptr;
+    size_t capacity = 0;
+    size_t blockSize = DEFAULT_BLOCK_SIZE;
+    std::atomic<size_t> offset{ 0 };
+
+    std::mutex overflowMutex;
+    OverflowBlock* overflowBlocks = nullptr; // 最後に追加したブロックが先頭
+    std::byte* overflowCursor = nullptr;
+    std::byte* overflowEnd = nullptr;
+    size_t overflowBytes = 0;
+    uint32_t overflowBlockCount = 0;
+    size_t peakBytes = 0;
+};
@@ -0,0 +1,58 @@
+﻿#include "FrameTimeStats.h"
+#include <algorithm>
+#include <cmath>
+
+void FrameTimeStats::Initialize(uint32_t windowSize)
+{
+    samples.assign(std::max<uint32_t>(windowSize, 1), 0.0);
+    sorted.reserve(samples.size());
+    Reset();
+}
+
+// ウィンドウが埋まったら最も古いサンプルを上書きする
+void FrameTimeStats::AddSample(double frameTimeMs)
+{
+    if (samples.empty()) {
+        Initialize();
+    }
+    samples[next] = frameTimeMs;
+    next = (next + 1) % static_cast<uint32_t>(samples.size());
+    count = std::min(count + 1, static_cast<uint32_t>(samples.size()));
+}
+
+void FrameTimeStats::Reset()
+{
+    next = 0;
+    count = 0;
+}
+
+FrameTimeSummary FrameTimeStats::GetSummary() const
+{
+    FrameTimeSummary summary;
+    if (count == 0) {
+        return summary;
+    }
+    sorted.assign(samples.begin(), samples.begin() + count);
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (double sample : sorted) {
+        total += sample;
+    }
+    summary.sampleCount = count;
+    summary.averageMs = total / count;
+    summary.p50Ms = GetSortedPercentile(sorted, 50.0);
+    summary.p95Ms = GetSortedPercentile(sorted, 95.0);
+    summary.p99Ms = GetSortedPercentile(sorted, 99.0);
+    summary.maxMs = sorted.back();
+    return summary;
+}
+
+double GetSortedPercentile(const std::vector<double>& values, double percentile)
+{
+    if (values.empty()) {
+        return 0.0;
+    }
+    const double rank = std::ceil(percentile / 100.0 * static_cast<double>(values.size()));
+    const size_t index = static_cast<size_t>(std::clamp(rank, 1.0, static_cast<double>(values.size()))) - 1;
+    return values[index];
+}
@@ -0,0 +1,38 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// 直近のフレーム時間の要約（ミリ秒）
+struct FrameTimeSummary {
+    uint32_t sampleCount = 0;
+    double averageMs = 0.0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+};
+
+// 直近 windowSize フレームの時間を保持し、平均とパーセンタイルを計算する。
+// パーセンタイルは最近傍順位法（ソート済み配列の ceil(p * n) 番目）で求める。
+class FrameTimeStats {
+public:
+    static constexpr uint32_t DEFAULT_WINDOW_SIZE = 512;
+
+    void Initialize(uint32_t windowSize = DEFAULT_WINDOW_SIZE);
+    void AddSample(double frameTimeMs);
+    void Reset();
+
+    // 戻り値: サンプルがない場合はすべて 0
+    FrameTimeSummary GetSummary() const;
+    uint32_t GetSampleCount() const { return count; }
+
+private:
+    std::vector<double> samples; // リングバッファ
+    uint32_t next = 0;
+    uint32_t count = 0;
+    mutable std::vector<double> sorted; // GetSummary の作業領域
+};
+
+// ソート済みの values から最近傍順位法でパーセンタイル（percentile は 0 ～ 100）を求める
+double GetSortedPercentile(const std::vector<double>& values, double percentile);
@@ -0,0 +1,43 @@
+﻿#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// FNV-1a 64bit ハッシュ。プラットフォームやコンパイラに依存しない値になるため、
+// ディスク上のキャッシュキーやコンテンツハッシュに使用できる。
+
+constexpr uint64_t HASH_SEED = 14695981039346656037ull;
+constexpr uint64_t HASH_PRIME = 1099511628211ull;
+
+constexpr uint64_t HashString(std::string_view text, uint64_t seed = HASH_SEED)
+{
+    uint64_t hash = seed;
+    for (char c : text) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= HASH_PRIME;
+    }
+    return hash;
+}
+
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = HASH_SEED)
+{
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= HASH_PRIME;
+    }
+    return hash;
+}
+
+// 64bit 値をリトルエンディアンのバイト列として混ぜ込む
+constexpr uint64_t HashCombine(uint64_t seed, uint64_t value)
+{
+    uint64_t hash = seed;
+    for (int i = 0; i < 8; ++i) {
+        hash ^= (value >> (i * 8)) & 0xff;
+        hash *= HASH_PRIME;
+    }
+    return hash;
+}
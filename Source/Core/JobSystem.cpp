@@ -0,0 +1,182 @@
+﻿#include "JobSystem.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <string>
+
+namespace {
+thread_local uint32_t t_workerIndex = JobSystem::INVALID_WORKER_INDEX;
+}
+
+JobSystem::~JobSystem()
+{
+    Shutdown();
+}
+
+// ワーカースレッドを起動し、呼び出し元スレッドをワーカー 0 として登録する。
+// 引数: workerThreadCount=追加で起動するスレッド数（0 の場合は自動）
+void JobSystem::Initialize(uint32_t workerThreadCount)
+{
+    if (running.load()) {
+        return;
+    }
+    if (workerThreadCount == 0) {
+        const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        workerThreadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+
+    queues.clear();
+    for (uint32_t i = 0; i < workerThreadCount + 1; ++i) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    jobPool.Initialize(JOBS_PER_CHUNK, workerThreadCount + 1);
+    t_workerIndex = 0;
+    running.store(true);
+    for (uint32_t i = 1; i <= workerThreadCount; ++i) {
+        threads.emplace_back(&JobSystem::WorkerMain, this, i);
+    }
+}
+
+void JobSystem::Shutdown()
+{
+    if (!running.load()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        running.store(false);
+    }
+    sleepCondition.notify_all();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    threads.clear();
+
+    // ワーカー停止後に残ったジョブは呼び出し元で実行する
+    while (TryRunOneJob(0)) {
+    }
+    queues.clear();
+    t_workerIndex = INVALID_WORKER_INDEX;
+}
+
+// ワーカーから投入されたジョブは自スレッドのキューへ、外部スレッドからのジョブは
+// キューを順番に選んで積む。
+void JobSystem::Schedule(JobFunction job, JobCounter* counter)
+{
+    if (queues.empty()) {
+        job();
+        return;
+    }
+    if (counter) {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Job* node = nullptr;
+    {
+        AllocationTagScope tagScope(AllocationTag::Jobs);
+        node = jobPool.New();
+    }
+    node->function = std::move(job);
+    node->counter = counter;
+    node->tag = GetCurrentAllocationTag();
+
+    const uint32_t queueCount = static_cast<uint32_t>(queues.size());
+    const uint32_t queueIndex = t_workerIndex < queueCount
+                                    ? t_workerIndex
+                                    : nextExternalQueue.fetch_add(1, std::memory_order_relaxed) % queueCount;
+    {
+        WorkQueue& queue = *queues[queueIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        node->previous = queue.tail;
+        if (queue.tail) {
+            queue.tail->next = node;
+        }
+        else {
+            queue.head = node;
+        }
+        queue.tail = node;
+    }
+    queuedJobs.fetch_add(1, std::memory_order_release);
+
+    // 待機判定と wait の間に通知が抜けないよう、一度ロックを取ってから起こす
+    { std::lock_guard<std::mutex> lock(sleepMutex); }
+    sleepCondition.notify_one();
+}
+
+void JobSystem::Wait(const JobCounter& counter)
+{
+    const uint32_t workerIndex = t_workerIndex;
+    while (!counter.IsDone()) {
+        if (!TryRunOneJob(workerIndex)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+uint32_t JobSystem::GetCurrentWorkerIndex()
+{
+    return t_workerIndex;
+}
+
+void JobSystem::WorkerMain(uint32_t workerIndex)
+{
+    t_workerIndex = workerIndex;
+    GetProfiler().SetThreadName(("Worker " + std::to_string(workerIndex)).c_str());
+    while (true) {
+        if (TryRunOneJob(workerIndex)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleepCondition.wait(lock, [this]() {
+            return queuedJobs.load(std::memory_order_acquire) > 0 || !running.load();
+        });
+        if (!running.load() && queuedJobs.load(std::memory_order_acquire) == 0) {
+            break;
+        }
+    }
+}
+
+// 自分のキューの末尾から 1 件取り出し、空なら他のキューの先頭から盗んで実行する。
+// 戻り値: ジョブを実行した場合 true
+bool JobSystem::TryRunOneJob(uint32_t workerIndex)
+{
+    const uint32_t queueCount = static_cast<uint32_t>(queues.size());
+    if (queueCount == 0) {
+        return false;
+    }
+
+    Job* job = workerIndex < queueCount ? TryPop(workerIndex, true) : nullptr;
+    const uint32_t start = workerIndex < queueCount ? workerIndex : 0;
+    for (uint32_t i = 1; !job && i <= queueCount; ++i) {
+        job = TryPop((start + i) % queueCount, false);
+    }
+    if (!job) {
+        return false;
+    }
+
+    {
+        AllocationTagScope tagScope(job->tag);
+        job->function();
+    }
+    JobCounter* counter = job->counter;
+    jobPool.Delete(job);
+    if (counter) {
+        counter->pending.fetch_sub(1, std::memory_order_release);
+    }
+    return true;
+}
+
+JobSystem::Job* JobSystem::TryPop(uint32_t queueIndex, bool fromBack)
+{
+    WorkQueue& queue = *queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    Job* job = fromBack ? queue.tail : queue.head;
+    if (!job) {
+        return nullptr;
+    }
+    Job* previous = job->previous;
+    Job* next = job->next;
+    (previous ? previous->next : queue.head) = next;
+    (next ? next->previous : queue.tail) = previous;
+    queuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+    return job;
+}
@@ -0,0 +1,106 @@
+﻿#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "AllocationTracker.h"
+#include "FixedSizePool.h"
+
+using JobFunction = std::function<void()>;
+
+// ジョブの完了待ちに使うカウンタ。Schedule で加算され、ジョブ完了時に減算される。
+class JobCounter {
+public:
+    bool IsDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+    std::atomic<uint32_t> pending{ 0 };
+};
+
+// ワークスティーリング方式のジョブシステム。
+// スレッドごとにキューを持ち、自分のキューは後ろから（LIFO）、他スレッドのキューは前から（FIFO）取り出す。
+// Initialize を呼んだスレッドをワーカー 0 とし、Wait 中はそのスレッドもジョブを実行する。
+// ジョブはワーカーごとのキャッシュを持つ固定サイズプールから確保し、投入と実行でヒープを使わない。
+class JobSystem {
+public:
+    static constexpr uint32_t INVALID_WORKER_INDEX = UINT32_MAX;
+
+    ~JobSystem();
+
+    // ワーカースレッドを起動する。workerThreadCount=0 の場合はハードウェアスレッド数 - 1
+    void Initialize(uint32_t workerThreadCount = 0);
+    // 残っているジョブを破棄せずに実行し終えてからワーカースレッドを停止する
+    void Shutdown();
+
+    // ジョブを投入する。counter を指定すると Wait で完了を待てる。
+    // ジョブ内で例外を送出しないこと。未初期化の場合はその場で実行する。
+    // ジョブは投入したスレッドの確保の用途（AllocationTag）を引き継いで実行する。
+    void Schedule(JobFunction job, JobCounter* counter = nullptr);
+    // counter のジョブがすべて完了するまで、待機中のスレッドもジョブを実行しながら待つ
+    void Wait(const JobCounter& counter);
+    // [0, count) を grainSize 単位に分割して並列実行し、完了まで待つ。
+    // 各ジョブは function を参照するだけなので、std::function への変換やヒープ確保は発生しない
+    template <typename Function>
+    void ParallelFor(uint32_t count, uint32_t grainSize, const Function& function);
+
+    // 呼び出し元を含むジョブ実行スレッド数
+    uint32_t GetThreadCount() const { return static_cast<uint32_t>(queues.size()); }
+    // 現在のスレッドのワーカー番号（ジョブシステム外のスレッドでは INVALID_WORKER_INDEX）
+    static uint32_t GetCurrentWorkerIndex();
+
+private:
+    // 1 チャンクで確保するジョブ数
+    static constexpr uint32_t JOBS_PER_CHUNK = 256;
+
+    // キューは両端から取り出すため、双方向リストでつなぐ
+    struct Job {
+        JobFunction function;
+        JobCounter* counter = nullptr;
+        AllocationTag tag = AllocationTag::Untagged;
+        Job* previous = nullptr;
+        Job* next = nullptr;
+    };
+    struct WorkQueue {
+        std::mutex mutex;
+        Job* head = nullptr;
+        Job* tail = nullptr;
+    };
+
+    void WorkerMain(uint32_t workerIndex);
+    bool TryRunOneJob(uint32_t workerIndex);
+    // 戻り値: キューが空の場合は nullptr
+    Job* TryPop(uint32_t queueIndex, bool fromBack);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    ObjectPool<Job> jobPool;
+    std::vector<std::thread> threads;
+    std::atomic<bool> running{ false };
+    std::atomic<uint32_t> queuedJobs{ 0 };
+    std::atomic<uint32_t> nextExternalQueue{ 0 };
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+};
+
+template <typename Function>
+void JobSystem::ParallelFor(uint32_t count, uint32_t grainSize, const Function& function)
+{
+    if (count == 0) {
+        return;
+    }
+    grainSize = (std::max)(grainSize, 1u);
+    JobCounter counter;
+    for (uint32_t begin = 0; begin < count; begin += grainSize) {
+        const uint32_t end = (std::min)(begin + grainSize, count);
+        Schedule([&function, begin, end]() { function(begin, end); }, &counter);
+    }
+    Wait(counter);
+}
+
+inline JobSystem& GetJobSystem() { static JobSystem jobSystem; return jobSystem; }
@@ -0,0 +1,123 @@
+﻿#include "MappedFile.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+// 引数: path=マップするファイル（すでに開いている場合は先に閉じる）
+void MappedFile::Open(const std::filesystem::path& path)
+{
+    Close();
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Failed to open file: " + path.string());
+    }
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        throw std::runtime_error("Failed to map empty file: " + path.string());
+    }
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        throw std::runtime_error("Failed to map file: " + path.string());
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = static_cast<const uint8_t*>(view);
+    size = static_cast<uint64_t>(fileSize.QuadPart);
+}
+
+void MappedFile::Close()
+{
+    if (data) {
+        UnmapViewOfFile(data);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle) {
+        CloseHandle(fileHandle);
+    }
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+    data = nullptr;
+    size = 0;
+}
+
+void MappedFile::Prefetch(uint64_t offset, uint64_t length) const
+{
+    if (!data || offset >= size) {
+        return;
+    }
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = const_cast<uint8_t*>(data + offset);
+    range.NumberOfBytes = static_cast<SIZE_T>((std::min)(length, size - offset));
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+#else
+
+// 引数: path=マップするファイル（すでに開いている場合は先に閉じる）
+void MappedFile::Open(const std::filesystem::path& path)
+{
+    Close();
+    const int file = open(path.c_str(), O_RDONLY);
+    if (file < 0) {
+        throw std::runtime_error("Failed to open file: " + path.string());
+    }
+    struct stat status {};
+    if (fstat(file, &status) != 0 || status.st_size == 0) {
+        close(file);
+        throw std::runtime_error("Failed to map empty file: " + path.string());
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, file, 0);
+    if (view == MAP_FAILED) {
+        close(file);
+        throw std::runtime_error("Failed to map file: " + path.string());
+    }
+    fileDescriptor = file;
+    data = static_cast<const uint8_t*>(view);
+    size = static_cast<uint64_t>(status.st_size);
+}
+
+void MappedFile::Close()
+{
+    if (data) {
+        munmap(const_cast<uint8_t*>(data), static_cast<size_t>(size));
+    }
+    if (fileDescriptor >= 0) {
+        close(fileDescriptor);
+    }
+    fileDescriptor = -1;
+    data = nullptr;
+    size = 0;
+}
+
+// madvise はページ境界から指定する必要があるため、先頭を切り下げる
+void MappedFile::Prefetch(uint64_t offset, uint64_t length) const
+{
+    if (!data || offset >= size) {
+        return;
+    }
+    const uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    const uint64_t begin = offset / pageSize * pageSize;
+    const uint64_t end = offset + (length < size - offset ? length : size - offset);
+    madvise(const_cast<uint8_t*>(data + begin), static_cast<size_t>(end - begin), MADV_WILLNEED);
+}
+
+#endif
@@ -0,0 +1,35 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+// 読み取り専用でメモリマップしたファイル。
+// 内容はコピーせずにマップしたアドレスから直接参照する（ページは最初のアクセス時に読み込まれる）。
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // 例外: ファイルを開けない、空、またはマップできない場合は std::runtime_error を送出
+    void Open(const std::filesystem::path& path);
+    void Close();
+
+    bool IsOpen() const { return data != nullptr; }
+    const uint8_t* GetData() const { return data; }
+    uint64_t GetSize() const { return size; }
+
+    // [offset, offset + length) を先読みするよう OS に依頼する（完了は待たない）
+    void Prefetch(uint64_t offset, uint64_t length) const;
+
+private:
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fileDescriptor = -1;
+#endif
+    const uint8_t* data = nullptr;
+    uint64_t size = 0;
+};
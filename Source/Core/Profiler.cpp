@@ -0,0 +1,218 @@
+﻿#include "Profiler.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+
+// 最後に記録したプロファイラとトラック（Profiler のインスタンスが変わったら登録し直す）
+struct ThreadTrackCache {
+    const void* owner = nullptr;
+    void* track = nullptr;
+};
+thread_local ThreadTrackCache t_trackCache;
+
+void WriteJsonString(std::ostream& stream, const char* text)
+{
+    stream << '"';
+    for (const char* c = text; *c != '\0'; ++c) {
+        switch (*c) {
+        case '"':
+            stream << "\\\"";
+            break;
+        case '\\':
+            stream << "\\\\";
+            break;
+        case '\n':
+            stream << "\\n";
+            break;
+        default:
+            if (static_cast<unsigned char>(*c) < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned char>(*c));
+                stream << escaped;
+            }
+            else {
+                stream << *c;
+            }
+            break;
+        }
+    }
+    stream << '"';
+}
+
+// Chrome トレースの時刻はマイクロ秒（小数可）
+void WriteMicroseconds(std::ostream& stream, uint64_t ns)
+{
+    char text[32];
+    std::snprintf(text, sizeof(text), "%llu.%03u", static_cast<unsigned long long>(ns / 1000), static_cast<unsigned>(ns % 1000));
+    stream << text;
+}
+
+} // namespace
+
+// 書き込み側は tail を acquire で読み、空きがあれば要素を書いてから head を release で進める
+bool ProfileEventRing::Push(const ProfileEvent& event)
+{
+    const uint32_t currentHead = head.load(std::memory_order_relaxed);
+    if (currentHead - tail.load(std::memory_order_acquire) == CAPACITY) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    events[currentHead & (CAPACITY - 1)] = event;
+    head.store(currentHead + 1, std::memory_order_release);
+    return true;
+}
+
+bool ProfileEventRing::Pop(ProfileEvent& event)
+{
+    const uint32_t currentTail = tail.load(std::memory_order_relaxed);
+    if (currentTail == head.load(std::memory_order_acquire)) {
+        return false;
+    }
+    event = events[currentTail & (CAPACITY - 1)];
+    tail.store(currentTail + 1, std::memory_order_release);
+    return true;
+}
+
+Profiler::Profiler()
+{
+    originNs = Now();
+    gpuTrack = &AddTrack("GPU");
+}
+
+uint64_t Profiler::Now()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+    Track& track = GetCurrentThreadTrack();
+    std::lock_guard<std::mutex> lock(mutex);
+    track.name = name;
+}
+
+void Profiler::Record(const ProfileEvent& event)
+{
+    if (!IsEnabled()) {
+        return;
+    }
+    GetCurrentThreadTrack().ring.Push(event);
+}
+
+void Profiler::RecordGpuEvent(const ProfileEvent& event)
+{
+    if (!IsEnabled()) {
+        return;
+    }
+    gpuTrack->ring.Push(event);
+}
+
+// 既存のキャプチャを捨てて新しく開始する
+void Profiler::BeginCapture()
+{
+    Collect();
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& track : tracks) {
+        track->captured.clear();
+    }
+    capturing = true;
+}
+
+void Profiler::EndCapture()
+{
+    Collect();
+    capturing = false;
+}
+
+void Profiler::Collect()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    ProfileEvent event;
+    for (auto& track : tracks) {
+        while (track->ring.Pop(event)) {
+            if (capturing) {
+                track->captured.push_back(event);
+            }
+        }
+    }
+}
+
+// 各イベントを完了イベント（"ph":"X"）として、トラック名をメタデータイベントとして出力する
+void Profiler::WriteChromeTrace(std::ostream& stream) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    stream << "{\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& track : tracks) {
+        stream << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << track->id << ",\"args\":{\"name\":";
+        WriteJsonString(stream, track->name.c_str());
+        stream << "}}";
+        first = false;
+        for (const ProfileEvent& event : track->captured) {
+            const uint64_t start = event.startNs > originNs ? event.startNs - originNs : 0;
+            const uint64_t duration = event.endNs > event.startNs ? event.endNs - event.startNs : 0;
+            stream << ",\n{\"name\":";
+            WriteJsonString(stream, event.name);
+            stream << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << track->id << ",\"ts\":";
+            WriteMicroseconds(stream, start);
+            stream << ",\"dur\":";
+            WriteMicroseconds(stream, duration);
+            stream << "}";
+        }
+    }
+    stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+bool Profiler::WriteChromeTrace(const std::filesystem::path& path) const
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    WriteChromeTrace(file);
+    return static_cast<bool>(file);
+}
+
+size_t Profiler::GetCapturedEventCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t count = 0;
+    for (const auto& track : tracks) {
+        count += track->captured.size();
+    }
+    return count;
+}
+
+uint64_t Profiler::GetDroppedEventCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t count = 0;
+    for (const auto& track : tracks) {
+        count += track->ring.GetDroppedCount();
+    }
+    return count;
+}
+
+// 初回だけロックを取ってトラックを登録し、以降はスレッドローカルのキャッシュを使う
+Profiler::Track& Profiler::GetCurrentThreadTrack()
+{
+    if (t_trackCache.owner != this) {
+        std::lock_guard<std::mutex> lock(mutex);
+        Track& track = AddTrack("Thread " + std::to_string(tracks.size()));
+        t_trackCache.owner = this;
+        t_trackCache.track = &track;
+    }
+    return *static_cast<Track*>(t_trackCache.track);
+}
+
+// 呼び出し元で mutex を保持しておくこと（コンストラクタを除く）
+Profiler::Track& Profiler::AddTrack(const std::string& name)
+{
+    auto track = std::make_unique<Track>();
+    track->id = static_cast<uint32_t>(tracks.size());
+    track->name = name;
+    tracks.push_back(std::move(track));
+    return *tracks.back();
+}
@@ -0,0 +1,132 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// PROFILE_SCOPE を空にしてビルドする場合は 0 を定義する
+#ifndef ENABLE_PROFILER
+#define ENABLE_PROFILER 1
+#endif
+
+// 計測区間 1 つ分（時刻は Profiler::Now() と同じ基準のナノ秒）
+struct ProfileEvent {
+    const char* name = nullptr; // 文字列リテラルなど、プロファイラより長く生存する文字列
+    uint64_t startNs = 0;
+    uint64_t endNs = 0;
+};
+
+// 1 スレッドが書き込み、収集スレッドが読み出す固定長のリング（SPSC、ロックなし）。
+// 満杯のときは書き込みを捨てて破棄数だけ数える。
+class ProfileEventRing {
+public:
+    static constexpr uint32_t CAPACITY = 1u << 14; // 2 のべき乗
+
+    // 書き込み側のスレッドからのみ呼び出す
+    bool Push(const ProfileEvent& event);
+    // 読み出し側のスレッドからのみ呼び出す
+    bool Pop(ProfileEvent& event);
+
+    uint64_t GetDroppedCount() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    ProfileEvent events[CAPACITY];
+    alignas(64) std::atomic<uint32_t> head{ 0 }; // 次に書き込む位置（書き込み側のみ更新）
+    alignas(64) std::atomic<uint32_t> tail{ 0 }; // 次に読み出す位置（読み出し側のみ更新）
+    std::atomic<uint64_t> dropped{ 0 };
+};
+
+// CPU/GPU の計測区間を集めて Chrome トレース形式（chrome://tracing, Perfetto）で書き出す。
+// 各スレッドは初回の記録時に自分専用のリングを登録し、以降はロックを取らずに書き込む。
+// 収集（Collect）は 1 つのスレッド（通常はメインスレッド）から定期的に呼び出す。
+class Profiler {
+public:
+    Profiler();
+
+    // 現在時刻（steady_clock 基準のナノ秒）
+    static uint64_t Now();
+
+    // 記録の有効/無効（無効の間は PROFILE_SCOPE が何も記録しない）
+    void SetEnabled(bool value) { enabled.store(value, std::memory_order_relaxed); }
+    bool IsEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    // 呼び出し元スレッドのトレース上の名前を設定する
+    void SetThreadName(const char* name);
+    // 呼び出し元スレッドのリングへ記録する
+    void Record(const ProfileEvent& event);
+    // GPU トラックへ記録する（GPU の計測結果を読み出す 1 スレッドからのみ呼び出す）
+    void RecordGpuEvent(const ProfileEvent& event);
+
+    // キャプチャ中は Collect で取り出したイベントを保持し、それ以外は捨てる
+    void BeginCapture();
+    void EndCapture();
+    bool IsCapturing() const { return capturing; }
+
+    // すべてのリングを空にする（リングが溢れないよう毎フレーム呼び出す）
+    void Collect();
+
+    // キャプチャしたイベントを Chrome トレースの JSON として書き出す
+    void WriteChromeTrace(std::ostream& stream) const;
+    // 戻り値: ファイルを開けない場合は false
+    bool WriteChromeTrace(const std::filesystem::path& path) const;
+
+    size_t GetCapturedEventCount() const;
+    uint64_t GetDroppedEventCount() const;
+
+private:
+    struct Track {
+        uint32_t id = 0;
+        std::string name;
+        ProfileEventRing ring;
+        std::vector<ProfileEvent> captured; // Collect を呼ぶスレッドのみが触る
+    };
+
+    Track& GetCurrentThreadTrack();
+    Track& AddTrack(const std::string& name);
+
+    std::atomic<bool> enabled{ true };
+    bool capturing = false;
+    uint64_t originNs = 0; // トレースの時刻 0
+
+    mutable std::mutex mutex; // tracks の追加と、収集/書き出しを保護する
+    std::vector<std::unique_ptr<Track>> tracks;
+    Track* gpuTrack = nullptr;
+};
+
+inline Profiler& GetProfiler() { static Profiler profiler; return profiler; }
+
+// スコープの開始から終了までを 1 イベントとして記録する
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* scopeName)
+        : name(scopeName), startNs(GetProfiler().IsEnabled() ? Profiler::Now() : 0)
+    {
+    }
+    ~ProfileScope()
+    {
+        if (startNs != 0) {
+            GetProfiler().Record({ name, startNs, Profiler::Now() });
+        }
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    uint64_t startNs;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if ENABLE_PROFILER
+// name は文字列リテラルを渡す（ポインタのまま保持する）
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
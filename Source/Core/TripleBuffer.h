@@ -0,0 +1,46 @@
+﻿#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// 書き込み側 1 スレッドと読み出し側 1 スレッドの間で最新の値を受け渡すロックフリーのトリプルバッファ。
+// 3 つのバッファを「書き込み中」「受け渡し待ち」「読み出し中」に割り当て、Publish/Acquire は
+// 受け渡し待ちのインデックスとの atomic な交換だけで行う。どちらの側も相手を待つことはなく、
+// 読み出し側が間に合わなかった値は次の Publish で上書きされる（常に最新だけが届く）。
+template <typename T>
+class TripleBuffer {
+public:
+    // 書き込み側: 次に公開する値を書き込むバッファ（前回 Publish 以前の内容が残っている）
+    T& GetWriteBuffer() { return buffers[writeIndex]; }
+
+    // 書き込み側: GetWriteBuffer の内容を公開し、空いたバッファを次の書き込み先にする
+    void Publish()
+    {
+        const uint32_t previous = shared.exchange(writeIndex | DIRTY_BIT, std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    // 読み出し側: 新しく公開された値があれば読み出し用バッファと交換する。
+    // 戻り値: 新しい値を取得した場合 true（false の場合は前回の値のまま）
+    bool Acquire()
+    {
+        if ((shared.load(std::memory_order_relaxed) & DIRTY_BIT) == 0) {
+            return false;
+        }
+        const uint32_t previous = shared.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    // 読み出し側: 最後に Acquire した値（一度も公開されていない場合は初期値）
+    const T& GetReadBuffer() const { return buffers[readIndex]; }
+
+private:
+    static constexpr uint32_t INDEX_MASK = 0x3;
+    static constexpr uint32_t DIRTY_BIT = 0x4; // 受け渡し待ちのバッファが未読
+
+    T buffers[3] = {};
+    alignas(64) uint32_t writeIndex = 0; // 書き込み側だけが参照
+    alignas(64) uint32_t readIndex = 1;  // 読み出し側だけが参照
+    alignas(64) std::atomic<uint32_t> shared{ 2 };
+};
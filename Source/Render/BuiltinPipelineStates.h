@@ -0,0 +1,52 @@
+﻿#pragma once
+
+#include <cstddef>
+#include "InstanceStorage.h"
+#include "PipelineState.h"
+#include "VertexFormat.h"
+
+// BuiltinPipeline の頂点形式と固定機能ステート。
+// シーンはこの構造体で頂点データを作り、バックエンドは同じ記述から入力レイアウトと PSO を作る。
+
+// BuiltinPipeline::VertexColor の頂点
+struct ColorVertex {
+    float x, y;
+    float r, g, b;
+};
+
+// BuiltinPipeline::Instanced のメッシュ頂点
+struct MeshVertex {
+    float x, y;
+};
+
+using ColorVertexStream = VertexStream<ColorVertex, VertexInputRate::PerVertex,
+                                       VertexAttribute<"POSITION", VertexElementFormat::Float2>,
+                                       VertexAttribute<"COLOR", VertexElementFormat::Float3>>;
+using MeshVertexStream = VertexStream<MeshVertex, VertexInputRate::PerVertex,
+                                      VertexAttribute<"POSITION", VertexElementFormat::Float2>>;
+using InstanceStream = VertexStream<InstanceGpuData, VertexInputRate::PerInstance,
+                                    VertexAttribute<"INSTANCE_POSITION", VertexElementFormat::Float2>,
+                                    VertexAttribute<"INSTANCE_ROTATION", VertexElementFormat::Float1>,
+                                    VertexAttribute<"INSTANCE_SCALE", VertexElementFormat::Float1>,
+                                    VertexAttribute<"INSTANCE_COLOR", VertexElementFormat::Float4>>;
+
+using VertexColorLayout = VertexLayout<ColorVertexStream>;
+using InstancedLayout = VertexLayout<MeshVertexStream, InstanceStream>; // スロット 0: メッシュ、スロット 1: インスタンス
+
+// 属性のオフセットが構造体のメンバと一致すること
+static_assert(ColorVertexStream::OFFSETS[1] == offsetof(ColorVertex, r));
+static_assert(InstanceStream::OFFSETS[1] == offsetof(InstanceGpuData, rotation));
+static_assert(InstanceStream::OFFSETS[2] == offsetof(InstanceGpuData, scale));
+static_assert(InstanceStream::OFFSETS[3] == offsetof(InstanceGpuData, colorR));
+static_assert(InstancedLayout::ELEMENTS[1].slot == 1 && InstancedLayout::ELEMENTS[1].rate == VertexInputRate::PerInstance);
+
+// 不透明な 2D 三角形（深度なし）
+constexpr PipelineStateKey VERTEX_COLOR_PIPELINE_STATE = PipelineStateBuilder().Cull(CullMode::Back).InputLayout<VertexColorLayout>().Build();
+// 回転しても表裏が変わらない 2D スプライトのためカリングなし
+constexpr PipelineStateKey INSTANCED_PIPELINE_STATE = PipelineStateBuilder().Cull(CullMode::None).InputLayout<InstancedLayout>().Build();
+// 頂点入力なしの全画面三角形
+constexpr PipelineStateKey UPSCALE_PIPELINE_STATE = PipelineStateBuilder().Cull(CullMode::None).Build();
+
+static_assert(VERTEX_COLOR_PIPELINE_STATE.hash != INSTANCED_PIPELINE_STATE.hash);
+static_assert(INSTANCED_PIPELINE_STATE.hash != UPSCALE_PIPELINE_STATE.hash);
+static_assert(UPSCALE_PIPELINE_STATE == PipelineStateBuilder().Cull(CullMode::None).InputLayout<EmptyVertexLayout>().Build());
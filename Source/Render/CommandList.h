@@ -0,0 +1,144 @@
+﻿#pragma once
+
+#include <cstdint>
+
+// バックエンドに依存しないコマンド記録インターフェース。
+// リソース/レンダーターゲット/パイプラインは各バックエンドが発行する ID で参照する。
+
+using ResourceId = uint32_t;
+using RenderTargetId = uint32_t;
+using PipelineId = uint32_t;
+using ShaderResourceId = uint32_t;
+
+constexpr uint32_t INVALID_RESOURCE_ID = UINT32_MAX;
+
+enum class ResourceState : uint8_t {
+    Common,
+    Present,
+    RenderTarget,
+    CopySource,
+    CopyDest,
+    VertexBuffer,
+    IndexBuffer,
+    ConstantBuffer,
+    ShaderResource,
+    UnorderedAccess,
+    DepthWrite,
+    DepthRead,
+    GenericRead,
+};
+
+enum class BarrierType : uint8_t {
+    Transition,
+    Aliasing, // 同じメモリを使う別のリソースへ切り替える（切り替え後の内容は未定義）
+};
+
+// 分割バリア。BeginOnly から同じリソースの EndOnly までの間に GPU が遷移を進められる
+enum class BarrierSplit : uint8_t {
+    None,
+    BeginOnly,
+    EndOnly,
+};
+
+struct ResourceBarrier {
+    BarrierType type = BarrierType::Transition;
+    BarrierSplit split = BarrierSplit::None;
+    ResourceId resource = INVALID_RESOURCE_ID;    // 遷移対象 / エイリアシング後に使用するリソース
+    ResourceId aliasBefore = INVALID_RESOURCE_ID; // エイリアシング前に使用していたリソース（INVALID = 不特定）
+    ResourceState before = ResourceState::Common;
+    ResourceState after = ResourceState::Common;
+};
+
+enum class TextureFormat : uint8_t {
+    RGBA8Unorm,
+    RGBA16Float,
+    R32Float,
+    D32Float,
+    // ブロック圧縮形式（4x4 画素のブロック単位、アセットのテクスチャ用でレンダーターゲットにはできない）
+    BC1Unorm, // 8 バイト/ブロック、RGB + 1bit アルファ
+    BC3Unorm, // 16 バイト/ブロック、RGB + 補間アルファ
+    BC7Unorm, // 16 バイト/ブロック、RGBA
+};
+
+struct TextureDesc {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    TextureFormat format = TextureFormat::RGBA8Unorm;
+
+    bool operator==(const TextureDesc& other) const { return width == other.width && height == other.height && format == other.format; }
+};
+
+// バックエンドが一時的に貸し出すテクスチャ（深度フォーマットの場合 renderTarget と shaderResource は INVALID_RESOURCE_ID）。
+// shaderResource はそのフレームの記録中だけ有効
+struct TransientTexture {
+    ResourceId resource = INVALID_RESOURCE_ID;
+    RenderTargetId renderTarget = INVALID_RESOURCE_ID;
+    ShaderResourceId shaderResource = INVALID_RESOURCE_ID;
+};
+
+enum class PrimitiveTopology : uint8_t {
+    TriangleList,
+    TriangleStrip,
+    LineList,
+    PointList,
+};
+
+struct Viewport {
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+    float minDepth = 0.0f;
+    float maxDepth = 1.0f;
+};
+
+struct ScissorRect {
+    int32_t left = 0;
+    int32_t top = 0;
+    int32_t right = 0;
+    int32_t bottom = 0;
+};
+
+// 頂点バッファの GPU アドレス範囲（D3D12_VERTEX_BUFFER_VIEW と同じ構成）
+struct VertexBufferView {
+    uint64_t gpuAddress = 0;
+    uint32_t sizeInBytes = 0;
+    uint32_t strideInBytes = 0;
+};
+
+// 1 本のコマンドリストへの記録操作。
+// 1 つのインスタンスは同時に 1 スレッドからのみ記録すること（別インスタンスは並列に記録できる）。
+class ICommandList {
+public:
+    virtual ~ICommandList() = default;
+
+    // frameSlot 用のアロケータでリストをリセットして記録を開始する
+    virtual void Begin(uint32_t frameSlot) = 0;
+    // 記録を終了してキューへ投入できる状態にする
+    virtual void End() = 0;
+
+    virtual void TransitionResource(ResourceId resource, ResourceState before, ResourceState after) = 0;
+    // 複数のバリアを 1 回の呼び出しで発行する
+    virtual void ResourceBarriers(const ResourceBarrier* barriers, uint32_t count) = 0;
+    virtual void SetRenderTarget(RenderTargetId target) = 0;
+    virtual void ClearRenderTarget(RenderTargetId target, const float color[4]) = 0;
+    virtual void SetViewport(const Viewport& viewport) = 0;
+    virtual void SetScissorRect(const ScissorRect& rect) = 0;
+    virtual void SetPipeline(PipelineId pipeline) = 0;
+    virtual void SetPrimitiveTopology(PrimitiveTopology topology) = 0;
+    virtual void SetVertexBuffer(uint32_t slot, const VertexBufferView& view) = 0;
+    // パイプラインのテクスチャ入力 slot に view を設定する（SetPipeline の後に呼び出す）
+    virtual void SetShaderResource(uint32_t slot, ShaderResourceId view) = 0;
+    virtual void DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance) = 0;
+    // コンピュートシェーダをスレッドグループ数 x × y × z で実行する（パイプラインとリソースはバックエンド固有の方法で設定済みであること）
+    virtual void Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) = 0;
+};
+
+// 記録済みコマンドリストを GPU へ投入するキュー。
+class ICommandQueue {
+public:
+    virtual ~ICommandQueue() = default;
+
+    // lists を配列の順序どおりに 1 回の投入で実行する
+    virtual void ExecuteCommandLists(ICommandList* const* lists, uint32_t count) = 0;
+};
@@ -0,0 +1,249 @@
+﻿#include "D3D12CommandList.h"
+#include <algorithm>
+#include <stdexcept>
+
+ResourceId D3D12ResourceRegistry::RegisterResource(ID3D12Resource* resource)
+{
+    resources.push_back(resource);
+    return static_cast<ResourceId>(resources.size() - 1);
+}
+
+RenderTargetId D3D12ResourceRegistry::RegisterRenderTarget(D3D12_CPU_DESCRIPTOR_HANDLE rtv)
+{
+    renderTargets.push_back(rtv);
+    return static_cast<RenderTargetId>(renderTargets.size() - 1);
+}
+
+PipelineId D3D12ResourceRegistry::RegisterPipeline(ID3D12PipelineState* pipelineState, ID3D12RootSignature* rootSignature, uint64_t key)
+{
+    for (size_t i = 0; i < pipelines.size(); ++i) {
+        if (pipelines[i].key == key) {
+            return static_cast<PipelineId>(i);
+        }
+    }
+    pipelines.push_back({ pipelineState, rootSignature, key });
+    return static_cast<PipelineId>(pipelines.size() - 1);
+}
+
+ShaderResourceId D3D12ResourceRegistry::RegisterShaderResource(D3D12_GPU_DESCRIPTOR_HANDLE table)
+{
+    shaderResources.push_back(table);
+    return static_cast<ShaderResourceId>(shaderResources.size() - 1);
+}
+
+// スロット数分のアロケータとコマンドリストを作成し、クローズ状態にしておく。
+// 引数:
+//  - device: 作成に使用するデバイス
+//  - framesInFlight: アロケータを作成するフレームスロット数
+//  - resourceRegistry: ID から D3D12 オブジェクトを引くテーブル（所有しない）
+//  - type: アロケータとリストの種類（投入するキューの種類と一致させる）
+void D3D12CommandList::Initialize(ID3D12Device* device, uint32_t framesInFlight, const D3D12ResourceRegistry* resourceRegistry, D3D12_COMMAND_LIST_TYPE type)
+{
+    registry = resourceRegistry;
+    for (uint32_t i = 0; i < framesInFlight; ++i) {
+        if (FAILED(device->CreateCommandAllocator(type, IID_PPV_ARGS(&allocators[i])))) {
+            throw std::runtime_error("Failed to create command allocator");
+        }
+    }
+    if (FAILED(device->CreateCommandList(0, type, allocators[0].Get(), nullptr, IID_PPV_ARGS(&commandList)))) {
+        throw std::runtime_error("Failed to create command list");
+    }
+    commandList->Close();
+}
+
+// アロケータのリセットは、このスロットを前回使用したフレームの GPU 完了後（FrameScheduler::BeginFrame 後）に行うこと
+void D3D12CommandList::Begin(uint32_t frameSlot)
+{
+    ID3D12CommandAllocator* allocator = allocators[frameSlot].Get();
+    allocator->Reset();
+    commandList->Reset(allocator, nullptr);
+    currentRootSignature = nullptr;
+    currentPipelineKey = 0;
+    if (descriptorHeap) {
+        ID3D12DescriptorHeap* heaps[] = { descriptorHeap };
+        commandList->SetDescriptorHeaps(_countof(heaps), heaps);
+    }
+}
+
+void D3D12CommandList::End()
+{
+    commandList->Close();
+}
+
+void D3D12CommandList::TransitionResource(ResourceId resource, ResourceState before, ResourceState after)
+{
+    D3D12_RESOURCE_BARRIER barrier{};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barrier.Transition.pResource = registry->GetResource(resource);
+    barrier.Transition.StateBefore = ToD3D12ResourceState(before);
+    barrier.Transition.StateAfter = ToD3D12ResourceState(after);
+    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    commandList->ResourceBarrier(1, &barrier);
+}
+
+// スタック上の配列に変換し、MAX_BARRIERS_PER_CALL 件ずつ ResourceBarrier を呼び出す
+void D3D12CommandList::ResourceBarriers(const ResourceBarrier* barriers, uint32_t count)
+{
+    constexpr uint32_t MAX_BARRIERS_PER_CALL = 32;
+    D3D12_RESOURCE_BARRIER nativeBarriers[MAX_BARRIERS_PER_CALL];
+    for (uint32_t offset = 0; offset < count; offset += MAX_BARRIERS_PER_CALL) {
+        const uint32_t chunk = (std::min)(count - offset, MAX_BARRIERS_PER_CALL);
+        for (uint32_t i = 0; i < chunk; ++i) {
+            const ResourceBarrier& barrier = barriers[offset + i];
+            D3D12_RESOURCE_BARRIER& native = nativeBarriers[i];
+            native = {};
+            switch (barrier.split) {
+            case BarrierSplit::None:
+                native.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+                break;
+            case BarrierSplit::BeginOnly:
+                native.Flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+                break;
+            case BarrierSplit::EndOnly:
+                native.Flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+                break;
+            }
+            if (barrier.type == BarrierType::Aliasing) {
+                native.Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+                native.Aliasing.pResourceBefore = barrier.aliasBefore != INVALID_RESOURCE_ID ? registry->GetResource(barrier.aliasBefore) : nullptr;
+                native.Aliasing.pResourceAfter = registry->GetResource(barrier.resource);
+            }
+            else {
+                native.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+                native.Transition.pResource = registry->GetResource(barrier.resource);
+                native.Transition.StateBefore = ToD3D12ResourceState(barrier.before);
+                native.Transition.StateAfter = ToD3D12ResourceState(barrier.after);
+                native.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+            }
+        }
+        commandList->ResourceBarrier(chunk, nativeBarriers);
+    }
+}
+
+void D3D12CommandList::SetRenderTarget(RenderTargetId target)
+{
+    const D3D12_CPU_DESCRIPTOR_HANDLE rtv = registry->GetRenderTarget(target);
+    commandList->OMSetRenderTargets(1, &rtv, FALSE, nullptr);
+}
+
+void D3D12CommandList::ClearRenderTarget(RenderTargetId target, const float color[4])
+{
+    commandList->ClearRenderTargetView(registry->GetRenderTarget(target), color, 0, nullptr);
+}
+
+void D3D12CommandList::SetViewport(const Viewport& viewport)
+{
+    const D3D12_VIEWPORT d3dViewport{ viewport.x, viewport.y, viewport.width, viewport.height, viewport.minDepth, viewport.maxDepth };
+    commandList->RSSetViewports(1, &d3dViewport);
+}
+
+void D3D12CommandList::SetScissorRect(const ScissorRect& rect)
+{
+    const D3D12_RECT d3dRect{ rect.left, rect.top, rect.right, rect.bottom };
+    commandList->RSSetScissorRects(1, &d3dRect);
+}
+
+// ルートシグネチャは変化したときだけ設定する（設定するとルート引数がリセットされるため）
+// 同じ PSO が設定済みならキーの比較だけで何もしない
+void D3D12CommandList::SetPipeline(PipelineId pipeline)
+{
+    const uint64_t key = registry->GetPipelineKey(pipeline);
+    if (key == currentPipelineKey) {
+        return;
+    }
+    currentPipelineKey = key;
+    ID3D12RootSignature* rootSignature = registry->GetRootSignature(pipeline);
+    if (rootSignature != currentRootSignature) {
+        commandList->SetGraphicsRootSignature(rootSignature);
+        currentRootSignature = rootSignature;
+    }
+    commandList->SetPipelineState(registry->GetPipelineState(pipeline));
+}
+
+void D3D12CommandList::SetPrimitiveTopology(PrimitiveTopology topology)
+{
+    D3D12_PRIMITIVE_TOPOLOGY d3dTopology = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+    switch (topology) {
+    case PrimitiveTopology::TriangleList:
+        d3dTopology = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+        break;
+    case PrimitiveTopology::TriangleStrip:
+        d3dTopology = D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP;
+        break;
+    case PrimitiveTopology::LineList:
+        d3dTopology = D3D_PRIMITIVE_TOPOLOGY_LINELIST;
+        break;
+    case PrimitiveTopology::PointList:
+        d3dTopology = D3D_PRIMITIVE_TOPOLOGY_POINTLIST;
+        break;
+    }
+    commandList->IASetPrimitiveTopology(d3dTopology);
+}
+
+void D3D12CommandList::SetVertexBuffer(uint32_t slot, const VertexBufferView& view)
+{
+    const D3D12_VERTEX_BUFFER_VIEW d3dView{ view.gpuAddress, view.sizeInBytes, view.strideInBytes };
+    commandList->IASetVertexBuffers(slot, 1, &d3dView);
+}
+
+// slot はルートシグネチャのディスクリプタテーブルのパラメータ番号
+void D3D12CommandList::SetShaderResource(uint32_t slot, ShaderResourceId view)
+{
+    commandList->SetGraphicsRootDescriptorTable(slot, registry->GetShaderResource(view));
+}
+
+void D3D12CommandList::DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance)
+{
+    commandList->DrawInstanced(vertexCount, instanceCount, startVertex, startInstance);
+}
+
+void D3D12CommandList::Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+    commandList->Dispatch(groupCountX, groupCountY, groupCountZ);
+}
+
+// 配列順のまま 1 回の ExecuteCommandLists で投入する。
+void D3D12CommandQueue::ExecuteCommandLists(ICommandList* const* lists, uint32_t count)
+{
+    constexpr uint32_t MAX_LISTS_PER_SUBMIT = 64;
+    ID3D12CommandList* nativeLists[MAX_LISTS_PER_SUBMIT];
+    if (count > MAX_LISTS_PER_SUBMIT) {
+        throw std::runtime_error("Too many command lists in one submit");
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        nativeLists[i] = static_cast<D3D12CommandList*>(lists[i])->GetNative();
+    }
+    commandQueue->ExecuteCommandLists(count, nativeLists);
+}
+
+D3D12_RESOURCE_STATES ToD3D12ResourceState(ResourceState state)
+{
+    switch (state) {
+    case ResourceState::Common:
+        return D3D12_RESOURCE_STATE_COMMON;
+    case ResourceState::Present:
+        return D3D12_RESOURCE_STATE_PRESENT;
+    case ResourceState::RenderTarget:
+        return D3D12_RESOURCE_STATE_RENDER_TARGET;
+    case ResourceState::CopySource:
+        return D3D12_RESOURCE_STATE_COPY_SOURCE;
+    case ResourceState::CopyDest:
+        return D3D12_RESOURCE_STATE_COPY_DEST;
+    case ResourceState::VertexBuffer:
+    case ResourceState::ConstantBuffer:
+        return D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER;
+    case ResourceState::IndexBuffer:
+        return D3D12_RESOURCE_STATE_INDEX_BUFFER;
+    case ResourceState::ShaderResource:
+        return D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+    case ResourceState::UnorderedAccess:
+        return D3D12_RESOURCE_STATE_UNORDERED_ACCESS;
+    case ResourceState::DepthWrite:
+        return D3D12_RESOURCE_STATE_DEPTH_WRITE;
+    case ResourceState::DepthRead:
+        return D3D12_RESOURCE_STATE_DEPTH_READ;
+    case ResourceState::GenericRead:
+        return D3D12_RESOURCE_STATE_GENERIC_READ;
+    }
+    return D3D12_RESOURCE_STATE_COMMON;
+}
@@ -0,0 +1,91 @@
+﻿#pragma once
+
+#include <windows.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <vector>
+#include "CommandList.h"
+#include "FrameScheduler.h"
+
+// バックエンド非依存の ID を D3D12 オブジェクトへ対応付けるテーブル。
+// 登録はメインスレッドで行い、記録中（複数スレッドから参照される間）は変更しないこと。
+class D3D12ResourceRegistry {
+public:
+    ResourceId RegisterResource(ID3D12Resource* resource);
+    RenderTargetId RegisterRenderTarget(D3D12_CPU_DESCRIPTOR_HANDLE rtv);
+    // key: PSO の内容から求めたキー（ComputeGraphicsPipelineKey）。同じキーを登録済みの場合はその ID を返す
+    PipelineId RegisterPipeline(ID3D12PipelineState* pipelineState, ID3D12RootSignature* rootSignature, uint64_t key);
+    // シェーダ可視ヒープ上のディスクリプタテーブル（SRV 1 つ）
+    ShaderResourceId RegisterShaderResource(D3D12_GPU_DESCRIPTOR_HANDLE table);
+
+    // スワップチェーン再作成などで実体が変わった場合に差し替える
+    void UpdateResource(ResourceId id, ID3D12Resource* resource) { resources[id] = resource; }
+    void UpdateRenderTarget(RenderTargetId id, D3D12_CPU_DESCRIPTOR_HANDLE rtv) { renderTargets[id] = rtv; }
+    void UpdateShaderResource(ShaderResourceId id, D3D12_GPU_DESCRIPTOR_HANDLE table) { shaderResources[id] = table; }
+
+    ID3D12Resource* GetResource(ResourceId id) const { return resources[id]; }
+    D3D12_CPU_DESCRIPTOR_HANDLE GetRenderTarget(RenderTargetId id) const { return renderTargets[id]; }
+    ID3D12PipelineState* GetPipelineState(PipelineId id) const { return pipelines[id].pipelineState; }
+    ID3D12RootSignature* GetRootSignature(PipelineId id) const { return pipelines[id].rootSignature; }
+    uint64_t GetPipelineKey(PipelineId id) const { return pipelines[id].key; }
+    D3D12_GPU_DESCRIPTOR_HANDLE GetShaderResource(ShaderResourceId id) const { return shaderResources[id]; }
+
+private:
+    struct PipelineEntry {
+        ID3D12PipelineState* pipelineState;
+        ID3D12RootSignature* rootSignature;
+        uint64_t key;
+    };
+    std::vector<ID3D12Resource*> resources;
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> renderTargets;
+    std::vector<PipelineEntry> pipelines;
+    std::vector<D3D12_GPU_DESCRIPTOR_HANDLE> shaderResources;
+};
+
+// フレームスロットごとのコマンドアロケータを持つ ID3D12GraphicsCommandList のラッパー。
+class D3D12CommandList : public ICommandList {
+public:
+    // type: 投入先のキューの種類（非同期コンピュートには D3D12_COMMAND_LIST_TYPE_COMPUTE）
+    // 例外: 作成に失敗した場合は std::runtime_error を送出
+    void Initialize(ID3D12Device* device, uint32_t framesInFlight, const D3D12ResourceRegistry* resourceRegistry,
+                    D3D12_COMMAND_LIST_TYPE type = D3D12_COMMAND_LIST_TYPE_DIRECT);
+
+    void Begin(uint32_t frameSlot) override;
+    void End() override;
+    void TransitionResource(ResourceId resource, ResourceState before, ResourceState after) override;
+    void ResourceBarriers(const ResourceBarrier* barriers, uint32_t count) override;
+    void SetRenderTarget(RenderTargetId target) override;
+    void ClearRenderTarget(RenderTargetId target, const float color[4]) override;
+    void SetViewport(const Viewport& viewport) override;
+    void SetScissorRect(const ScissorRect& rect) override;
+    void SetPipeline(PipelineId pipeline) override;
+    void SetPrimitiveTopology(PrimitiveTopology topology) override;
+    void SetVertexBuffer(uint32_t slot, const VertexBufferView& view) override;
+    void SetShaderResource(uint32_t slot, ShaderResourceId view) override;
+    void DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance) override;
+    void Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) override;
+
+    // Begin 時に設定するシェーダ可視ヒープ（ディスクリプタテーブルを使う場合に指定する）
+    void SetDescriptorHeap(ID3D12DescriptorHeap* heap) { descriptorHeap = heap; }
+    ID3D12GraphicsCommandList* GetNative() const { return commandList.Get(); }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocators[MAX_FRAMES_IN_FLIGHT];
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> commandList;
+    const D3D12ResourceRegistry* registry = nullptr;
+    ID3D12RootSignature* currentRootSignature = nullptr;
+    uint64_t currentPipelineKey = 0; // 0 = 未設定
+    ID3D12DescriptorHeap* descriptorHeap = nullptr;
+};
+
+// ID3D12CommandQueue へ D3D12CommandList をまとめて投入する。
+class D3D12CommandQueue : public ICommandQueue {
+public:
+    void Initialize(ID3D12CommandQueue* queue) { commandQueue = queue; }
+    void ExecuteCommandLists(ICommandList* const* lists, uint32_t count) override;
+
+private:
+    ID3D12CommandQueue* commandQueue = nullptr;
+};
+
+D3D12_RESOURCE_STATES ToD3D12ResourceState(ResourceState state);
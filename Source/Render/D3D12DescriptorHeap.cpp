@@ -0,0 +1,97 @@
+﻿#include "D3D12DescriptorHeap.h"
+#include <stdexcept>
+
+// CPU 専用ヒープを作成する。
+// 引数: device=作成に使用するデバイス、heapType=ヒープ種別、capacity=ディスクリプタ数
+void D3D12StagingDescriptorHeap::Initialize(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE heapType, uint32_t capacity)
+{
+    type = heapType;
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc{};
+    heapDesc.NumDescriptors = capacity;
+    heapDesc.Type = heapType;
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+    if (FAILED(device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&heap)))) {
+        throw std::runtime_error("Failed to create staging descriptor heap");
+    }
+    cpuStart = heap->GetCPUDescriptorHandleForHeapStart();
+    descriptorSize = device->GetDescriptorHandleIncrementSize(heapType);
+    freeList.Initialize(capacity);
+}
+
+DescriptorHandle D3D12StagingDescriptorHeap::Allocate()
+{
+    DescriptorHandle handle;
+    handle.index = freeList.Allocate();
+    if (handle.IsValid()) {
+        handle.cpu.ptr = cpuStart.ptr + static_cast<SIZE_T>(handle.index) * descriptorSize;
+    }
+    return handle;
+}
+
+void D3D12StagingDescriptorHeap::Free(DescriptorHandle& handle)
+{
+    if (handle.IsValid()) {
+        freeList.Free(handle.index);
+        handle = {};
+    }
+}
+
+// シェーダ可視ヒープを作成する。
+// 引数: d3dDevice=作成に使用するデバイス、heapType=CBV_SRV_UAV または SAMPLER、capacity=ディスクリプタ数
+void D3D12ShaderVisibleDescriptorRing::Initialize(ID3D12Device* d3dDevice, D3D12_DESCRIPTOR_HEAP_TYPE heapType, uint32_t capacity)
+{
+    device = d3dDevice;
+    type = heapType;
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc{};
+    heapDesc.NumDescriptors = capacity;
+    heapDesc.Type = heapType;
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    if (FAILED(device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&heap)))) {
+        throw std::runtime_error("Failed to create shader visible descriptor heap");
+    }
+    cpuStart = heap->GetCPUDescriptorHandleForHeapStart();
+    gpuStart = heap->GetGPUDescriptorHandleForHeapStart();
+    descriptorSize = device->GetDescriptorHandleIncrementSize(heapType);
+    ring.Initialize(capacity);
+    pendingCopies.Initialize(descriptorSize);
+}
+
+DescriptorTable D3D12ShaderVisibleDescriptorRing::AllocateTable(uint32_t count)
+{
+    DescriptorTable table;
+    table.index = ring.Allocate(count);
+    if (table.IsValid()) {
+        table.cpu.ptr = cpuStart.ptr + static_cast<SIZE_T>(table.index) * descriptorSize;
+        table.gpu.ptr = gpuStart.ptr + static_cast<UINT64>(table.index) * descriptorSize;
+        table.count = count;
+    }
+    return table;
+}
+
+void D3D12ShaderVisibleDescriptorRing::StageCopy(const DescriptorTable& table, uint32_t slot, D3D12_CPU_DESCRIPTOR_HANDLE source)
+{
+    const SIZE_T dest = table.cpu.ptr + static_cast<SIZE_T>(slot) * descriptorSize;
+    pendingCopies.Add(dest, source.ptr);
+}
+
+// 範囲ごとにコピー先とコピー元の大きさは等しいため、大きさの配列は両方に同じものを渡す
+void D3D12ShaderVisibleDescriptorRing::FlushCopies()
+{
+    lastFlushCopyCount = pendingCopies.GetCopyCount();
+    const std::vector<DescriptorCopyRange>& ranges = pendingCopies.GetRanges();
+    if (ranges.empty()) {
+        return;
+    }
+    destStarts.clear();
+    destSizes.clear();
+    sourceStarts.clear();
+    for (const DescriptorCopyRange& range : ranges) {
+        destStarts.push_back({ static_cast<SIZE_T>(range.dest) });
+        destSizes.push_back(range.count);
+        sourceStarts.push_back({ static_cast<SIZE_T>(range.source) });
+    }
+    const UINT rangeCount = static_cast<UINT>(ranges.size());
+    device->CopyDescriptors(rangeCount, destStarts.data(), destSizes.data(),
+                            rangeCount, sourceStarts.data(), destSizes.data(), type);
+    pendingCopies.Clear();
+}
@@ -0,0 +1,87 @@
+﻿#pragma once
+
+#include <windows.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <vector>
+#include "DescriptorAllocator.h"
+
+// CPU 側ヒープ上の 1 ディスクリプタ
+struct DescriptorHandle {
+    D3D12_CPU_DESCRIPTOR_HANDLE cpu{};
+    uint32_t index = INVALID_DESCRIPTOR_INDEX;
+
+    bool IsValid() const { return index != INVALID_DESCRIPTOR_INDEX; }
+};
+
+// シェーダから参照できるヒープ上の連続したディスクリプタテーブル
+struct DescriptorTable {
+    D3D12_CPU_DESCRIPTOR_HANDLE cpu{};
+    D3D12_GPU_DESCRIPTOR_HANDLE gpu{};
+    uint32_t index = INVALID_DESCRIPTOR_INDEX;
+    uint32_t count = 0;
+
+    bool IsValid() const { return index != INVALID_DESCRIPTOR_INDEX; }
+};
+
+// ビュー作成用の CPU 専用ヒープ（SRV/CBV/UAV/RTV/DSV/Sampler のいずれか）。
+// 個々のディスクリプタをフリーリストで O(1) に確保/解放する。
+class D3D12StagingDescriptorHeap {
+public:
+    // 例外: ヒープの作成に失敗した場合は std::runtime_error を送出
+    void Initialize(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE heapType, uint32_t capacity);
+
+    // 戻り値: 空きがない場合は IsValid() == false のハンドル
+    DescriptorHandle Allocate();
+    void Free(DescriptorHandle& handle);
+
+    D3D12_DESCRIPTOR_HEAP_TYPE GetType() const { return type; }
+    const DescriptorHeapStats& GetStats() const { return freeList.GetStats(); }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> heap;
+    D3D12_DESCRIPTOR_HEAP_TYPE type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    D3D12_CPU_DESCRIPTOR_HANDLE cpuStart{};
+    uint32_t descriptorSize = 0;
+    DescriptorFreeList freeList;
+};
+
+// フレームごとのディスクリプタテーブルを切り出すシェーダ可視ヒープ。
+// テーブルへの書き込みは StageCopy で溜めておき、FlushCopies で 1 回の CopyDescriptors にまとめる。
+class D3D12ShaderVisibleDescriptorRing {
+public:
+    // 例外: ヒープの作成に失敗した場合は std::runtime_error を送出
+    void Initialize(ID3D12Device* d3dDevice, D3D12_DESCRIPTOR_HEAP_TYPE heapType, uint32_t capacity);
+
+    // 戻り値: 空きがない場合は IsValid() == false のテーブル
+    DescriptorTable AllocateTable(uint32_t count);
+    // table の slot 番目へ source（CPU 専用ヒープ上のディスクリプタ）をコピーする予約を行う
+    void StageCopy(const DescriptorTable& table, uint32_t slot, D3D12_CPU_DESCRIPTOR_HANDLE source);
+    // 予約済みのコピーを 1 回の CopyDescriptors で実行する（コマンドリスト投入前に呼び出す）
+    void FlushCopies();
+
+    void FinishFrame(uint64_t fenceValue) { ring.FinishFrame(fenceValue); }
+    void Retire(uint64_t completedFenceValue) { ring.Retire(completedFenceValue); }
+
+    ID3D12DescriptorHeap* GetHeap() const { return heap.Get(); }
+    const DescriptorHeapStats& GetStats() const { return ring.GetStats(); }
+    // 直前の FlushCopies でまとめたコピー数
+    uint32_t GetLastFlushCopyCount() const { return lastFlushCopyCount; }
+
+private:
+    ID3D12Device* device = nullptr;
+    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> heap;
+    D3D12_DESCRIPTOR_HEAP_TYPE type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    D3D12_CPU_DESCRIPTOR_HANDLE cpuStart{};
+    D3D12_GPU_DESCRIPTOR_HANDLE gpuStart{};
+    uint32_t descriptorSize = 0;
+    DescriptorRing ring;
+
+    // 予約済みのコピー（隣接するものは 1 範囲にまとめる）
+    DescriptorCopyBatch pendingCopies;
+    // CopyDescriptors に渡す配列（容量を使い回す）
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> destStarts;
+    std::vector<UINT> destSizes;
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> sourceStarts;
+    uint32_t lastFlushCopyCount = 0;
+};
@@ -0,0 +1,196 @@
+﻿#include "D3D12GpuMemory.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+D3D12_HEAP_FLAGS ToD3D12HeapFlags(GpuHeapClass heapClass)
+{
+    switch (heapClass) {
+    case GpuHeapClass::Buffer:
+        return D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+    case GpuHeapClass::Texture:
+        return D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+    case GpuHeapClass::RenderTarget:
+        return D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+    case GpuHeapClass::Count:
+        break;
+    }
+    return D3D12_HEAP_FLAG_NONE;
+}
+
+} // namespace
+
+// 引数:
+//  - d3dDevice: ヒープとリソースの作成に使用するデバイス
+//  - adapter: d3dDevice を作成したアダプタ
+//  - bufferUploader: 初期内容の転送と移動のコピーを記録するアップローダ（初期化済み）
+void D3D12GpuMemory::Initialize(ID3D12Device* d3dDevice, IDXGIAdapter1* adapter, D3D12Uploader* bufferUploader)
+{
+    device = d3dDevice;
+    adapter3.Reset();
+    adapter->QueryInterface(IID_PPV_ARGS(&adapter3));
+    uploader = bufferUploader;
+    allocator.Initialize(this, GpuHeapAllocatorDesc{});
+    residency.Initialize(&allocator, this, ResidencyManagerDesc{});
+    heaps.clear();
+    resources.clear();
+    pendingReleases.clear();
+    currentFence = 1;
+    UpdateBudget();
+}
+
+void D3D12GpuMemory::Shutdown()
+{
+    pendingReleases.clear();
+    resources.clear();
+    allocator.Shutdown();
+    heaps.clear();
+}
+
+// 移動元や破棄したリソースは、そのフレームの完了後に解放する。
+// 常駐の管理より先に解放し、空になったヒープを破棄するときにリソースが残らないようにする
+// （配置リソースはヒープを参照しているため、残っていても破棄自体は安全）。
+void D3D12GpuMemory::BeginFrame(uint64_t currentFenceValue, uint64_t completedFenceValue)
+{
+    currentFence = currentFenceValue;
+    while (!pendingReleases.empty() && pendingReleases.front().fenceValue <= completedFenceValue) {
+        pendingReleases.pop_front();
+    }
+    UpdateBudget();
+    residency.BeginFrame(currentFenceValue, completedFenceValue);
+}
+
+// 配置に必要な大きさとアライメントは GetResourceAllocationInfo で求める（バッファは 64KB 境界）
+GpuResourceHandle D3D12GpuMemory::CreateBuffer(const void* data, uint64_t size, D3D12_RESOURCE_FLAGS flags, bool pinned)
+{
+    D3D12_RESOURCE_DESC resDesc = MakeBufferResourceDesc(size);
+    resDesc.Flags = flags;
+    const D3D12_RESOURCE_ALLOCATION_INFO info = device->GetResourceAllocationInfo(0, 1, &resDesc);
+    GpuResourceDesc resourceDesc;
+    resourceDesc.heapClass = GpuHeapClass::Buffer;
+    resourceDesc.size = info.SizeInBytes;
+    resourceDesc.alignment = info.Alignment;
+    resourceDesc.pinned = pinned;
+
+    const GpuResourceHandle handle = residency.CreateResource(resourceDesc);
+    if (handle >= resources.size()) {
+        resources.resize(handle + 1);
+    }
+    Resource& resource = resources[handle];
+    resource.desc = resDesc;
+    resource.resource.Reset();
+    resource.contents.clear();
+    if (data) {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        resource.contents.assign(bytes, bytes + size);
+    }
+    if (pinned) {
+        residency.Use(handle);
+        std::vector<uint8_t>().swap(resource.contents);
+    }
+    return handle;
+}
+
+void D3D12GpuMemory::DestroyResource(GpuResourceHandle resource)
+{
+    residency.DestroyResource(resource);
+}
+
+ID3D12Resource* D3D12GpuMemory::Use(GpuResourceHandle resource)
+{
+    residency.Use(resource);
+    return resources[resource].resource.Get();
+}
+
+// 引数: heap=GpuHeapAllocator が割り当てたヒープ番号、heapClass=置けるリソースの種類、size=バイト数
+// 戻り値: デバイスのメモリ不足などで作成できない場合は false
+bool D3D12GpuMemory::CreateHeap(uint32_t heap, GpuHeapClass heapClass, uint64_t size)
+{
+    D3D12_HEAP_DESC heapDesc{};
+    heapDesc.SizeInBytes = size;
+    heapDesc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+    heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+    heapDesc.Flags = ToD3D12HeapFlags(heapClass);
+    Microsoft::WRL::ComPtr<ID3D12Heap> created;
+    if (FAILED(device->CreateHeap(&heapDesc, IID_PPV_ARGS(&created)))) {
+        return false;
+    }
+    if (heap >= heaps.size()) {
+        heaps.resize(heap + 1);
+    }
+    heaps[heap] = created;
+    return true;
+}
+
+void D3D12GpuMemory::DestroyHeap(uint32_t heap)
+{
+    heaps[heap].Reset();
+}
+
+// 初回も配置し直しも、保持している内容をコピーキューで転送する
+void D3D12GpuMemory::PlaceResource(GpuResourceHandle handle, const GpuAllocation& allocation, bool restoring)
+{
+    (void)restoring;
+    Resource& resource = resources[handle];
+    resource.resource = CreatePlacedResource(allocation, resource.desc);
+    UploadContents(resource);
+}
+
+// GPU は参照し終えているため、すぐに解放する
+void D3D12GpuMemory::EvictResource(GpuResourceHandle handle)
+{
+    resources[handle].resource.Reset();
+}
+
+// 新しい位置のリソースへ GPU 上でコピーする。描画キューは SubmitAndPresent でコピーの完了を待つ
+void D3D12GpuMemory::MoveResource(GpuResourceHandle handle, const GpuAllocation& from, const GpuAllocation& to)
+{
+    (void)from;
+    Resource& resource = resources[handle];
+    Microsoft::WRL::ComPtr<ID3D12Resource> moved = CreatePlacedResource(to, resource.desc);
+    uploader->CopyBuffer(moved.Get(), 0, resource.resource.Get(), 0, resource.desc.Width);
+    pendingReleases.push_back({ std::move(resource.resource), currentFence });
+    resource.resource = std::move(moved);
+}
+
+void D3D12GpuMemory::ReleaseResource(GpuResourceHandle handle)
+{
+    Resource& resource = resources[handle];
+    if (resource.resource) {
+        pendingReleases.push_back({ std::move(resource.resource), currentFence });
+    }
+    std::vector<uint8_t>().swap(resource.contents);
+}
+
+Microsoft::WRL::ComPtr<ID3D12Resource> D3D12GpuMemory::CreatePlacedResource(const GpuAllocation& allocation, const D3D12_RESOURCE_DESC& desc)
+{
+    Microsoft::WRL::ComPtr<ID3D12Resource> placed;
+    if (FAILED(device->CreatePlacedResource(heaps[allocation.heap].Get(), allocation.offset, &desc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&placed)))) {
+        throw std::runtime_error("Failed to create placed resource");
+    }
+    return placed;
+}
+
+// ステージングリングに収まる大きさずつ転送する
+void D3D12GpuMemory::UploadContents(const Resource& resource)
+{
+    const uint64_t totalSize = resource.contents.size();
+    for (uint64_t offset = 0; offset < totalSize; offset += UPLOAD_CHUNK_SIZE) {
+        uploader->UploadBuffer(resource.resource.Get(), offset, resource.contents.data() + offset, (std::min)(UPLOAD_CHUNK_SIZE, totalSize - offset));
+    }
+}
+
+// 予算を取得できない場合は前回の値（初期値は無制限）のまま
+void D3D12GpuMemory::UpdateBudget()
+{
+    DXGI_QUERY_VIDEO_MEMORY_INFO info{};
+    if (!adapter3 || FAILED(adapter3->QueryVideoMemoryInfo(0, DXGI_MEMORY_SEGMENT_GROUP_LOCAL, &info))) {
+        return;
+    }
+    const GpuHeapAllocatorStats& heapStats = allocator.GetStats();
+    const uint64_t otherUsage = info.CurrentUsage > heapStats.heapBytes ? info.CurrentUsage - heapStats.heapBytes : 0;
+    const uint64_t heapBudget = info.Budget > otherUsage ? info.Budget - otherUsage : 0;
+    const uint64_t heapFreeBytes = heapStats.heapBytes - heapStats.usedBytes;
+    residency.SetBudget(heapBudget > heapFreeBytes ? heapBudget - heapFreeBytes : 0);
+}
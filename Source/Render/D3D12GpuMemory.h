@@ -0,0 +1,84 @@
+﻿#pragma once
+
+#include <windows.h>
+#include <d3d12.h>
+#include <dxgi1_6.h>
+#include <wrl/client.h>
+#include <deque>
+#include <vector>
+#include "D3D12Uploader.h"
+#include "GpuHeapAllocator.h"
+#include "ResidencyManager.h"
+
+// GpuHeapAllocator/ResidencyManager の D3D12 バックエンド。ヒープを ID3D12Heap として作成し、
+// DEFAULT ヒープのバッファを配置リソース（CreatePlacedResource）として作成する。
+// 転送と移動のコピーは D3D12Uploader のコピーキューに記録し、描画キューはその完了を待ってから実行する。
+// 固定でないバッファは退避後に配置し直すため、初期内容を CPU 側に保持する（GPU が書き込むバッファは固定にすること）。
+// 予算は OS がこのプロセスに割り当てたローカルメモリの予算（QueryVideoMemoryInfo）から毎フレーム求める。
+// 呼び出しは描画スレッドから、コマンドの記録を始める前に行うこと。
+class D3D12GpuMemory : public IGpuHeapBackend, public IResidencyBackend {
+public:
+    // 初期内容の転送を分割する大きさ（ステージングリングの容量より小さくする）
+    static constexpr uint64_t UPLOAD_CHUNK_SIZE = 4ull * 1024 * 1024;
+
+    // adapter: 予算の取得に使用するアダプタ（IDXGIAdapter3 に対応していなければ予算を設けない）
+    // bufferUploader: 転送とコピーの記録先（所有しない）
+    void Initialize(ID3D12Device* d3dDevice, IDXGIAdapter1* adapter, D3D12Uploader* bufferUploader);
+    // GPU の完了を待った後に呼び出し、すべてのリソースとヒープを解放する
+    void Shutdown();
+
+    // フレームの先頭で呼び出し、解放を遅らせていたリソースを解放して、予算の更新と常駐の管理を行う。
+    // currentFenceValue: 今フレームが完了時に発行するフェンス値、completedFenceValue: GPU が完了済みのフェンス値
+    void BeginFrame(uint64_t currentFenceValue, uint64_t completedFenceValue);
+
+    // DEFAULT ヒープのバッファを登録する。固定のバッファはここで配置し、GPU アドレスは破棄するまで変わらない。
+    // data: 初期内容（nullptr なら転送しない）
+    // 例外: 固定のバッファを配置できない場合は std::runtime_error を送出
+    GpuResourceHandle CreateBuffer(const void* data, uint64_t size, D3D12_RESOURCE_FLAGS flags, bool pinned);
+    // GPU が参照し終えてから解放する
+    void DestroyResource(GpuResourceHandle resource);
+    // resource を今フレームで使う。退避されていれば配置し直す（GPU アドレスが変わる）
+    // 例外: 配置できない場合は std::runtime_error を送出
+    ID3D12Resource* Use(GpuResourceHandle resource);
+    // 常駐していなければ nullptr
+    ID3D12Resource* GetResource(GpuResourceHandle resource) const { return resources[resource].resource.Get(); }
+
+    const GpuHeapAllocator& GetAllocator() const { return allocator; }
+    const ResidencyManager& GetResidency() const { return residency; }
+
+    bool CreateHeap(uint32_t heap, GpuHeapClass heapClass, uint64_t size) override;
+    void DestroyHeap(uint32_t heap) override;
+    // 例外: リソースの作成に失敗した場合は std::runtime_error を送出
+    void PlaceResource(GpuResourceHandle resource, const GpuAllocation& allocation, bool restoring) override;
+    void EvictResource(GpuResourceHandle resource) override;
+    // 例外: リソースの作成に失敗した場合は std::runtime_error を送出
+    void MoveResource(GpuResourceHandle resource, const GpuAllocation& from, const GpuAllocation& to) override;
+    void ReleaseResource(GpuResourceHandle resource) override;
+
+private:
+    struct Resource {
+        D3D12_RESOURCE_DESC desc{};
+        Microsoft::WRL::ComPtr<ID3D12Resource> resource; // 常駐していない間は空
+        std::vector<uint8_t> contents;                   // 配置し直すときに転送する内容（固定のバッファは初回の転送後に破棄する）
+    };
+    struct PendingRelease {
+        Microsoft::WRL::ComPtr<ID3D12Resource> resource;
+        uint64_t fenceValue;
+    };
+
+    // 例外: 作成に失敗した場合は std::runtime_error を送出
+    Microsoft::WRL::ComPtr<ID3D12Resource> CreatePlacedResource(const GpuAllocation& allocation, const D3D12_RESOURCE_DESC& desc);
+    void UploadContents(const Resource& resource);
+    // 予算から、管理外のリソース（スワップチェーンなど）とヒープの空きを除いた分を常駐の予算にする
+    void UpdateBudget();
+
+    ID3D12Device* device = nullptr;
+    Microsoft::WRL::ComPtr<IDXGIAdapter3> adapter3;
+    D3D12Uploader* uploader = nullptr;
+    GpuHeapAllocator allocator;
+    ResidencyManager residency;
+    std::vector<Microsoft::WRL::ComPtr<ID3D12Heap>> heaps; // ヒープ番号で引く
+    std::vector<Resource> resources;                       // ハンドルで引く
+    std::deque<PendingRelease> pendingReleases;            // フェンス値の順
+    uint64_t currentFence = 1;
+};
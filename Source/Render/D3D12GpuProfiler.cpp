@@ -0,0 +1,120 @@
+﻿#include "D3D12GpuProfiler.h"
+#include "D3D12UploadRingBuffer.h"
+#include "../Core/Profiler.h"
+#include <stdexcept>
+
+// 引数:
+//  - device: クエリヒープと readback バッファを作成するデバイス
+//  - queue: 計測するコマンドキュー（タイムスタンプ周波数とクロック較正に使用）
+//  - framesInFlight: フレームスロット数（クエリ領域をこの数だけ確保する）
+void D3D12GpuProfiler::Initialize(ID3D12Device* device, ID3D12CommandQueue* queue, uint32_t framesInFlight)
+{
+    commandQueue = queue;
+    const uint32_t queryCount = GetQueryBase(framesInFlight);
+
+    D3D12_QUERY_HEAP_DESC heapDesc{};
+    heapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+    heapDesc.Count = queryCount;
+    if (FAILED(device->CreateQueryHeap(&heapDesc, IID_PPV_ARGS(&queryHeap)))) {
+        throw std::runtime_error("Failed to create timestamp query heap");
+    }
+
+    D3D12_HEAP_PROPERTIES heapProps{};
+    heapProps.Type = D3D12_HEAP_TYPE_READBACK;
+    const D3D12_RESOURCE_DESC bufferDesc = MakeBufferResourceDesc(static_cast<uint64_t>(queryCount) * sizeof(uint64_t));
+    if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &bufferDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&readbackBuffer)))) {
+        throw std::runtime_error("Failed to create timestamp readback buffer");
+    }
+    if (FAILED(commandQueue->GetTimestampFrequency(&timestampFrequency))) {
+        throw std::runtime_error("Failed to get timestamp frequency");
+    }
+    for (std::vector<Scope>& scopes : slotScopes) {
+        scopes.reserve(MAX_SCOPES_PER_FRAME);
+    }
+}
+
+void D3D12GpuProfiler::BeginFrame(uint32_t frameSlot)
+{
+    currentSlot = frameSlot;
+    if (slotResolved[frameSlot]) {
+        ReadResults(frameSlot);
+        slotResolved[frameSlot] = false;
+    }
+    slotScopes[frameSlot].clear();
+}
+
+uint32_t D3D12GpuProfiler::BeginScope(ID3D12GraphicsCommandList* commandList, const char* name)
+{
+    std::vector<Scope>& scopes = slotScopes[currentSlot];
+    if (scopes.size() >= MAX_SCOPES_PER_FRAME) {
+        return INVALID_SCOPE;
+    }
+    const uint32_t scope = static_cast<uint32_t>(scopes.size());
+    scopes.push_back({ name, false });
+    commandList->EndQuery(queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, GetQueryBase(currentSlot) + scope * 2);
+    return scope;
+}
+
+void D3D12GpuProfiler::EndScope(ID3D12GraphicsCommandList* commandList, uint32_t scope)
+{
+    if (scope == INVALID_SCOPE) {
+        return;
+    }
+    slotScopes[currentSlot][scope].ended = true;
+    commandList->EndQuery(queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, GetQueryBase(currentSlot) + scope * 2 + 1);
+}
+
+// 使用した範囲だけを readback バッファの同じオフセットへ解決する
+void D3D12GpuProfiler::EndFrame(ID3D12GraphicsCommandList* commandList)
+{
+    const uint32_t queryCount = static_cast<uint32_t>(slotScopes[currentSlot].size()) * 2;
+    if (queryCount == 0) {
+        return;
+    }
+    const uint32_t queryBase = GetQueryBase(currentSlot);
+    commandList->ResolveQueryData(queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, queryBase, queryCount,
+                                  readbackBuffer.Get(), static_cast<UINT64>(queryBase) * sizeof(uint64_t));
+    slotResolved[currentSlot] = true;
+}
+
+// GPU のタイムスタンプをクロック較正で CPU（QueryPerformanceCounter = steady_clock）の時刻へ変換して記録する
+void D3D12GpuProfiler::ReadResults(uint32_t slot)
+{
+    const std::vector<Scope>& scopes = slotScopes[slot];
+    const uint32_t queryBase = GetQueryBase(slot);
+    const D3D12_RANGE readRange{ queryBase * sizeof(uint64_t), (queryBase + scopes.size() * 2) * sizeof(uint64_t) };
+    void* mapped = nullptr;
+    if (FAILED(readbackBuffer->Map(0, &readRange, &mapped))) {
+        return;
+    }
+    const uint64_t* timestamps = static_cast<const uint64_t*>(mapped) + queryBase;
+
+    UINT64 gpuCalibration = 0;
+    UINT64 cpuCalibration = 0;
+    LARGE_INTEGER cpuFrequency{};
+    QueryPerformanceFrequency(&cpuFrequency);
+    const bool calibrated = SUCCEEDED(commandQueue->GetClockCalibration(&gpuCalibration, &cpuCalibration));
+    const double cpuCalibrationNs = static_cast<double>(cpuCalibration) * 1e9 / static_cast<double>(cpuFrequency.QuadPart);
+    const double nsPerTick = 1e9 / static_cast<double>(timestampFrequency);
+    auto toCpuNs = [&](uint64_t gpuTicks) {
+        const double deltaNs = (static_cast<double>(gpuTicks) - static_cast<double>(gpuCalibration)) * nsPerTick;
+        return static_cast<uint64_t>(cpuCalibrationNs + deltaNs);
+    };
+
+    for (uint32_t i = 0; i < scopes.size(); ++i) {
+        if (!scopes[i].ended) {
+            continue;
+        }
+        const uint64_t begin = timestamps[i * 2];
+        const uint64_t end = timestamps[i * 2 + 1];
+        if (i == 0) {
+            lastFrameTimeMs = end > begin ? static_cast<double>(end - begin) * nsPerTick / 1e6 : 0.0;
+        }
+        if (calibrated) {
+            GetProfiler().RecordGpuEvent({ scopes[i].name, toCpuNs(begin), toCpuNs(end) });
+        }
+    }
+
+    const D3D12_RANGE writtenRange{ 0, 0 };
+    readbackBuffer->Unmap(0, &writtenRange);
+}
@@ -0,0 +1,51 @@
+﻿#pragma once
+
+#include <windows.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <vector>
+#include "FrameScheduler.h"
+
+// タイムスタンプクエリで GPU 上のパス区間を計測する。
+// クエリはフレームスロットごとに別領域を使い、EndFrame で readback バッファへ解決しておく。
+// 結果はそのスロットが再利用される（= フェンスで完了が保証される）数フレーム後の BeginFrame で
+// 読み出すため、CPU が GPU の完了を待つことはない。読み出した区間は Profiler の GPU トラックへ送る。
+class D3D12GpuProfiler {
+public:
+    static constexpr uint32_t MAX_SCOPES_PER_FRAME = 64;
+    static constexpr uint32_t INVALID_SCOPE = UINT32_MAX;
+
+    // 例外: クエリヒープ/readback バッファの作成に失敗した場合は std::runtime_error を送出
+    void Initialize(ID3D12Device* device, ID3D12CommandQueue* queue, uint32_t framesInFlight);
+
+    // frameSlot を前回使用したフレームの結果を読み出してから、今フレームの記録を始める。
+    // FrameScheduler::BeginFrame の直後（スロットの完了が保証された後）に呼び出す。
+    void BeginFrame(uint32_t frameSlot);
+    // 戻り値: スコープ番号（1 フレームの上限を超えた場合は INVALID_SCOPE）
+    uint32_t BeginScope(ID3D12GraphicsCommandList* commandList, const char* name);
+    void EndScope(ID3D12GraphicsCommandList* commandList, uint32_t scope);
+    // 今フレームのクエリを解決する。フレームの最後に実行されるコマンドリストへ記録すること
+    void EndFrame(ID3D12GraphicsCommandList* commandList);
+
+    // 直近に読み出したフレームの最初のスコープの GPU 時間（ミリ秒）。未計測の場合は 0
+    double GetLastFrameTimeMs() const { return lastFrameTimeMs; }
+
+private:
+    struct Scope {
+        const char* name = nullptr;
+        bool ended = false;
+    };
+
+    uint32_t GetQueryBase(uint32_t slot) const { return slot * MAX_SCOPES_PER_FRAME * 2; }
+    void ReadResults(uint32_t slot);
+
+    ID3D12CommandQueue* commandQueue = nullptr;
+    Microsoft::WRL::ComPtr<ID3D12QueryHeap> queryHeap;
+    Microsoft::WRL::ComPtr<ID3D12Resource> readbackBuffer;
+    uint64_t timestampFrequency = 0;
+    uint32_t currentSlot = 0;
+    std::vector<Scope> slotScopes[MAX_FRAMES_IN_FLIGHT]; // スコープ i はクエリ 2i（開始）と 2i+1（終了）
+    bool slotResolved[MAX_FRAMES_IN_FLIGHT] = {};
+    double lastFrameTimeMs = 0.0;
+};
@@ -0,0 +1,15 @@
+﻿#include "D3D12GpuQueue.h"
+
+// 引数: device=フェンスを作成するデバイス、queue=投入先のキュー（所有しない）
+void D3D12GpuQueue::Initialize(ID3D12Device* device, ID3D12CommandQueue* queue)
+{
+    nativeQueue = queue;
+    commandQueue.Initialize(queue);
+    timeline.Initialize(device, queue);
+}
+
+// ID3D12CommandQueue::Wait は GPU 側の待機で、CPU はブロックしない
+void D3D12GpuQueue::Wait(IGpuQueue& source, uint64_t value)
+{
+    nativeQueue->Wait(static_cast<D3D12GpuQueue&>(source).GetFence(), value);
+}
@@ -0,0 +1,30 @@
+﻿#pragma once
+
+#include <windows.h>
+#include <d3d12.h>
+#include "D3D12CommandList.h"
+#include "D3D12GpuTimeline.h"
+#include "QueueDependencyScheduler.h"
+
+// ID3D12CommandQueue と専用のフェンスを QueueDependencyScheduler のキューとして扱う。
+// 同じキューのフレームスケジューラ用フェンスとは別のフェンスを使うため、両者の値は独立している。
+class D3D12GpuQueue : public IGpuQueue {
+public:
+    // 例外: フェンスの作成に失敗した場合は std::runtime_error を送出
+    void Initialize(ID3D12Device* device, ID3D12CommandQueue* queue);
+    void Shutdown() { timeline.Shutdown(); }
+
+    void ExecuteCommandLists(ICommandList* const* lists, uint32_t count) override { commandQueue.ExecuteCommandLists(lists, count); }
+    void Signal(uint64_t value) override { timeline.Signal(value); }
+    // source は D3D12GpuQueue であること
+    void Wait(IGpuQueue& source, uint64_t value) override;
+    uint64_t GetCompletedValue() const override { return timeline.GetCompletedValue(); }
+
+    ID3D12CommandQueue* GetNative() const { return nativeQueue; }
+    ID3D12Fence* GetFence() const { return timeline.GetFence(); }
+
+private:
+    ID3D12CommandQueue* nativeQueue = nullptr;
+    D3D12CommandQueue commandQueue;
+    D3D12GpuTimeline timeline;
+};
@@ -0,0 +1,46 @@
+﻿#include "D3D12GpuTimeline.h"
+#include <stdexcept>
+
+// フェンスとフェンスイベントを作成する。
+// 引数: device=フェンスを作成するデバイス、queue=Signal を発行するコマンドキュー
+// 例外: 作成に失敗した場合は std::runtime_error を送出
+void D3D12GpuTimeline::Initialize(ID3D12Device* device, ID3D12CommandQueue* queue)
+{
+    commandQueue = queue;
+    if (FAILED(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence)))) {
+        throw std::runtime_error("Failed to create fence");
+    }
+    fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (!fenceEvent) {
+        throw std::runtime_error("Failed to create fence event");
+    }
+}
+
+void D3D12GpuTimeline::Shutdown()
+{
+    if (fenceEvent) {
+        CloseHandle(fenceEvent);
+        fenceEvent = nullptr;
+    }
+}
+
+// Signal は GPU 側でキューがこの位置に到達したタイミングでフェンス値を設定する
+void D3D12GpuTimeline::Signal(uint64_t value)
+{
+    commandQueue->Signal(fence.Get(), value);
+}
+
+uint64_t D3D12GpuTimeline::GetCompletedValue() const
+{
+    return fence->GetCompletedValue();
+}
+
+// SetEventOnCompletion で GPU 完了時に OS イベントをシグナルさせ、WaitForSingleObject でブロックする
+void D3D12GpuTimeline::WaitForValue(uint64_t value)
+{
+    if (fence->GetCompletedValue() >= value) {
+        return;
+    }
+    fence->SetEventOnCompletion(value, fenceEvent);
+    WaitForSingleObject(fenceEvent, INFINITE);
+}
@@ -0,0 +1,26 @@
+﻿#pragma once
+
+#include <windows.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+#include "FrameScheduler.h"
+
+// ID3D12Fence とコマンドキューを使った IGpuTimeline の実装。
+class D3D12GpuTimeline : public IGpuTimeline {
+public:
+    // フェンスと待機用イベントを作成する。失敗時は std::runtime_error を送出
+    void Initialize(ID3D12Device* device, ID3D12CommandQueue* queue);
+    // 待機用イベントを破棄する
+    void Shutdown();
+
+    void Signal(uint64_t value) override;
+    uint64_t GetCompletedValue() const override;
+    void WaitForValue(uint64_t value) override;
+
+    ID3D12Fence* GetFence() const { return fence.Get(); }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12Fence> fence;
+    ID3D12CommandQueue* commandQueue = nullptr;
+    HANDLE fenceEvent = nullptr;
+};
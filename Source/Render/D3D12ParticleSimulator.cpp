@@ -0,0 +1,218 @@
+﻿#include "D3D12ParticleSimulator.h"
+#include "DirectXMain.h" // D3D12Context の完全定義が必要
+#include "D3D12ShaderCompiler.h"
+#include "../Core/JobSystem.h"
+#include "../Core/Profiler.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// ParticleKernels.cpp のスカラー版と同じ式で 1 スレッド 1 粒子を更新し、インスタンスデータを書き出す
+const char* PARTICLE_COMPUTE_SHADER = R"(
+    cbuffer Constants : register(b0) {
+        float deltaTime;
+        float gravityX;
+        float gravityY;
+        float damping;
+        float emitterX;
+        float emitterY;
+        float floorY;
+        float restitution;
+        float4 startColor;
+        float4 endColor;
+        float startScale;
+        float endScale;
+        uint particleCount;
+    };
+    struct Particle { float2 position; float2 velocity; float age; float ageRate; float2 launchVelocity; };
+    struct Instance { float2 position; float rotation; float scale; float4 color; };
+    RWStructuredBuffer<Particle> particles : register(u0);
+    RWStructuredBuffer<Instance> instances : register(u1);
+
+    [numthreads(256, 1, 1)]
+    void main(uint3 id : SV_DispatchThreadID) {
+        if (id.x >= particleCount) {
+            return;
+        }
+        Particle p = particles[id.x];
+        float2 v = (p.velocity + float2(gravityX, gravityY) * deltaTime) * damping;
+        float2 pos = p.position + v * deltaTime;
+        if (pos.y < floorY) {
+            pos.y = floorY;
+            v.y *= -restitution;
+        }
+        float age = p.age + p.ageRate * deltaTime;
+        if (age >= 1.0f) {
+            age -= 1.0f;
+            pos = float2(emitterX, emitterY);
+            v = p.launchVelocity;
+        }
+        p.position = pos;
+        p.velocity = v;
+        p.age = age;
+        particles[id.x] = p;
+
+        Instance o;
+        o.position = pos;
+        o.rotation = 0.0f;
+        o.scale = lerp(startScale, endScale, age);
+        o.color = lerp(startColor, endColor, age);
+        instances[id.x] = o;
+    }
+)";
+
+// ルートパラメータ: 0 = ルート定数 (b0)、1 = 粒子の状態 (u0)、2 = インスタンスデータ (u1)
+constexpr UINT ROOT_PARAMETER_CONSTANTS = 0;
+constexpr UINT ROOT_PARAMETER_PARTICLES = 1;
+constexpr UINT ROOT_PARAMETER_INSTANCES = 2;
+
+} // namespace
+
+// 引数:
+//  - context: コンピュートキュー（computeQueue）とスケジューラを初期化済みのコンテキスト
+// 例外:
+//  - シェーダコンパイルや D3D12 オブジェクト生成に失敗した場合は std::runtime_error を送出
+void D3D12ParticleSimulator::Create(D3D12Context& context)
+{
+    ctx = &context;
+    commandList.Initialize(ctx->device.Get(), ctx->frameScheduler.GetFramesInFlight(), &ctx->registry, D3D12_COMMAND_LIST_TYPE_COMPUTE);
+    particleCount = 0;
+    for (QueueSyncPoint& point : slotReadSyncPoints) {
+        point = {};
+    }
+
+    // ディスクリプタヒープを使わず、バッファはルート UAV で直接渡す
+    D3D12_ROOT_PARAMETER parameters[3] = {};
+    parameters[ROOT_PARAMETER_CONSTANTS].ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
+    parameters[ROOT_PARAMETER_CONSTANTS].Constants = { 0, 0, sizeof(ComputeConstants) / sizeof(uint32_t) };
+    parameters[ROOT_PARAMETER_CONSTANTS].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+    parameters[ROOT_PARAMETER_PARTICLES].ParameterType = D3D12_ROOT_PARAMETER_TYPE_UAV;
+    parameters[ROOT_PARAMETER_PARTICLES].Descriptor = { 0, 0 };
+    parameters[ROOT_PARAMETER_PARTICLES].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+    parameters[ROOT_PARAMETER_INSTANCES].ParameterType = D3D12_ROOT_PARAMETER_TYPE_UAV;
+    parameters[ROOT_PARAMETER_INSTANCES].Descriptor = { 1, 0 };
+    parameters[ROOT_PARAMETER_INSTANCES].ShaderVisibility = D3D12_SHADER_VISIBILITY_ALL;
+    D3D12_ROOT_SIGNATURE_DESC rsDesc{};
+    rsDesc.NumParameters = _countof(parameters);
+    rsDesc.pParameters = parameters;
+    Microsoft::WRL::ComPtr<ID3DBlob> serializedRS;
+    Microsoft::WRL::ComPtr<ID3DBlob> errorRS;
+    if (FAILED(D3D12SerializeRootSignature(&rsDesc, D3D_ROOT_SIGNATURE_VERSION_1, &serializedRS, &errorRS))) {
+        throw std::runtime_error("パーティクル更新のルートシグネチャのシリアライズに失敗");
+    }
+    if (FAILED(ctx->device->CreateRootSignature(0, serializedRS->GetBufferPointer(), serializedRS->GetBufferSize(), IID_PPV_ARGS(&rootSignature)))) {
+        throw std::runtime_error("パーティクル更新のルートシグネチャの作成に失敗");
+    }
+
+    // PSO ライブラリはグラフィックス PSO だけを扱うため、コンピュート PSO は直接作成する
+    std::vector<ShaderCompileRequest> shaderRequests(1);
+    shaderRequests[0] = { "ParticleCS", PARTICLE_COMPUTE_SHADER, {}, "main", "cs_5_0", 0 };
+    const std::vector<ShaderBytecode> shaders = ctx->shaderCache.GetOrCompileAll(shaderRequests, CompileShaderD3D, GetJobSystem());
+    D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc{};
+    psoDesc.pRootSignature = rootSignature.Get();
+    psoDesc.CS = { shaders[0].data(), shaders[0].size() };
+    if (FAILED(ctx->device->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(&pipelineState)))) {
+        throw std::runtime_error("パーティクル更新の PSO の作成に失敗");
+    }
+}
+
+// 状態バッファへの転送はコピーキューで行い、コンピュートキューにその完了を待たせる。
+// 作り直す場合は、古いバッファを参照する投入がすべて完了してから解放する。
+// 例外: バッファの作成や転送に失敗した場合は std::runtime_error を送出
+void D3D12ParticleSimulator::Initialize(const ParticleSystem& initialState)
+{
+    if (stateBuffer != INVALID_GPU_RESOURCE) {
+        ctx->frameScheduler.WaitForIdle();
+        DestroyBuffers();
+    }
+    particleCount = initialState.GetParticleCount();
+    const uint64_t stateSize = (std::max)(static_cast<uint64_t>(particleCount) * sizeof(GpuParticle), uint64_t(sizeof(GpuParticle)));
+    const uint64_t instanceSize = (std::max)(static_cast<uint64_t>(particleCount) * sizeof(InstanceGpuData), uint64_t(sizeof(InstanceGpuData)));
+    stateBuffer = CreateUnorderedAccessBuffer(stateSize);
+    for (uint32_t slot = 0; slot < ctx->frameScheduler.GetFramesInFlight(); ++slot) {
+        instanceBuffers[slot] = CreateUnorderedAccessBuffer(instanceSize);
+    }
+
+    // SoA を GPU の AoS に並べ替えて、ステージングリングに収まる大きさずつ転送する
+    const ParticleStreams streams = initialState.GetStreams();
+    std::vector<GpuParticle> particles(particleCount);
+    for (uint32_t i = 0; i < particleCount; ++i) {
+        particles[i] = { streams.positionX[i], streams.positionY[i], streams.velocityX[i], streams.velocityY[i],
+                         streams.age[i], streams.ageRate[i], streams.launchVelocityX[i], streams.launchVelocityY[i] };
+    }
+    const auto* bytes = reinterpret_cast<const uint8_t*>(particles.data());
+    const uint64_t totalSize = static_cast<uint64_t>(particleCount) * sizeof(GpuParticle);
+    for (uint64_t offset = 0; offset < totalSize; offset += UPLOAD_CHUNK_SIZE) {
+        ctx->uploader.UploadBuffer(ctx->gpuMemory.GetResource(stateBuffer), offset, bytes + offset, (std::min)(UPLOAD_CHUNK_SIZE, totalSize - offset));
+    }
+    ctx->uploader.Submit();
+    ctx->uploader.WaitOnQueue(ctx->computeGpuQueue.GetNative());
+}
+
+// 1 回のディスパッチで全粒子を更新し、スロットのインスタンスバッファへ書き出す。依存は次の 2 つ。
+//  - コンピュート: スロットのバッファを前回読んだ描画の完了を待つ（通常は BeginFrame で完了済みのため省略される）
+//  - 描画: 今回の更新の完了を、このフレームの描画の投入（SubmitAndPresent）で待つ
+// 状態バッファは同じキューの投入順で読み書きが直列化されるため、フレーム間のバリアは不要。
+VertexBufferView D3D12ParticleSimulator::Simulate(uint32_t frameSlot, const ParticleSimulationParams& params, const ParticleAppearance& appearance)
+{
+    PROFILE_SCOPE("SubmitParticleCompute");
+    ComputeConstants constants{};
+    constants.deltaTime = params.deltaTime;
+    constants.gravityX = params.gravityX;
+    constants.gravityY = params.gravityY;
+    constants.damping = params.damping;
+    constants.emitterX = params.emitterX;
+    constants.emitterY = params.emitterY;
+    constants.floorY = params.floorY;
+    constants.restitution = params.restitution;
+    std::copy(appearance.startColor, appearance.startColor + 4, constants.startColor);
+    std::copy(appearance.endColor, appearance.endColor + 4, constants.endColor);
+    constants.startScale = appearance.startScale;
+    constants.endScale = appearance.endScale;
+    constants.particleCount = particleCount;
+
+    ID3D12Resource* instanceBuffer = ctx->gpuMemory.GetResource(instanceBuffers[frameSlot]);
+    commandList.Begin(frameSlot);
+    ID3D12GraphicsCommandList* native = commandList.GetNative();
+    native->SetComputeRootSignature(rootSignature.Get());
+    native->SetPipelineState(pipelineState.Get());
+    native->SetComputeRoot32BitConstants(ROOT_PARAMETER_CONSTANTS, sizeof(ComputeConstants) / sizeof(uint32_t), &constants, 0);
+    native->SetComputeRootUnorderedAccessView(ROOT_PARAMETER_PARTICLES, ctx->gpuMemory.GetResource(stateBuffer)->GetGPUVirtualAddress());
+    native->SetComputeRootUnorderedAccessView(ROOT_PARAMETER_INSTANCES, instanceBuffer->GetGPUVirtualAddress());
+    commandList.Dispatch((particleCount + THREAD_GROUP_SIZE - 1) / THREAD_GROUP_SIZE, 1, 1);
+    commandList.End();
+
+    ICommandList* lists[] = { &commandList };
+    const QueueSyncPoint previousRead = slotReadSyncPoints[frameSlot];
+    const QueueSyncPoint simulated = ctx->queueScheduler.Submit(GpuQueueType::Compute, lists, 1, &previousRead, 1);
+    ctx->queueScheduler.AddPendingWait(GpuQueueType::Graphics, simulated);
+    slotReadSyncPoints[frameSlot] = ctx->queueScheduler.GetNextSyncPoint(GpuQueueType::Graphics);
+
+    VertexBufferView view;
+    view.gpuAddress = instanceBuffer->GetGPUVirtualAddress();
+    view.sizeInBytes = particleCount * static_cast<uint32_t>(sizeof(InstanceGpuData));
+    view.strideInBytes = sizeof(InstanceGpuData);
+    return view;
+}
+
+const QueueSchedulerStats& D3D12ParticleSimulator::GetQueueStats() const
+{
+    return ctx->queueScheduler.GetStats();
+}
+
+// 例外: 配置できない場合は std::runtime_error を送出
+GpuResourceHandle D3D12ParticleSimulator::CreateUnorderedAccessBuffer(uint64_t size) const
+{
+    return ctx->gpuMemory.CreateBuffer(nullptr, size, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, true);
+}
+
+void D3D12ParticleSimulator::DestroyBuffers()
+{
+    ctx->gpuMemory.DestroyResource(stateBuffer);
+    stateBuffer = INVALID_GPU_RESOURCE;
+    for (uint32_t slot = 0; slot < ctx->frameScheduler.GetFramesInFlight(); ++slot) {
+        ctx->gpuMemory.DestroyResource(instanceBuffers[slot]);
+    }
+}
@@ -0,0 +1,78 @@
+﻿#pragma once
+
+#include <windows.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include "D3D12CommandList.h"
+#include "FrameScheduler.h"
+#include "ParticleSystem.h"
+#include "QueueDependencyScheduler.h"
+#include "ResidencyManager.h"
+
+struct D3D12Context; // forward declaration
+
+// 粒子の更新をコンピュートシェーダで行い、D3D12Context のコンピュートキューへ投入する IGpuParticleSimulator。
+// 粒子の状態は GPU の構造化バッファに置いたまま毎フレーム更新し、描画に使うインスタンスデータを
+// フレームスロットごとのバッファへ書き出す。バッファは D3D12Context の gpuMemory に固定の配置リソースとして COMMON で作成し、
+// コピー/コンピュート/描画の各キューでの暗黙の状態昇格と、投入の終了時の COMMON への減衰に任せる
+// （キューをまたぐ受け渡しにバリアは不要で、順序は QueueDependencyScheduler のフェンス待ちで保証する）。
+class D3D12ParticleSimulator : public IGpuParticleSimulator {
+public:
+    // 1 スレッドグループで更新する粒子数（シェーダの numthreads と一致させる）
+    static constexpr uint32_t THREAD_GROUP_SIZE = 256;
+    // 初期状態の転送を分割する大きさ（ステージングリングの容量より小さくする）
+    static constexpr uint64_t UPLOAD_CHUNK_SIZE = 4ull * 1024 * 1024;
+
+    // コンピュート用のコマンドリスト、ルートシグネチャ、PSO を作成する。
+    // context: コンピュートキューとスケジューラを初期化済みのコンテキスト（所有しない）
+    void Create(D3D12Context& context);
+
+    void Initialize(const ParticleSystem& initialState) override;
+    VertexBufferView Simulate(uint32_t frameSlot, const ParticleSimulationParams& params, const ParticleAppearance& appearance) override;
+    uint32_t GetParticleCount() const override { return particleCount; }
+    const QueueSchedulerStats& GetQueueStats() const override;
+
+private:
+    // ルート定数（シェーダの cbuffer Constants と同じ並び。float4 は 16 バイト境界に置く）
+    struct ComputeConstants {
+        float deltaTime;
+        float gravityX;
+        float gravityY;
+        float damping;
+        float emitterX;
+        float emitterY;
+        float floorY;
+        float restitution;
+        float startColor[4];
+        float endColor[4];
+        float startScale;
+        float endScale;
+        uint32_t particleCount;
+        uint32_t padding;
+    };
+    // GPU 側の粒子 1 つ分（シェーダの Particle と同じ並び）
+    struct GpuParticle {
+        float positionX;
+        float positionY;
+        float velocityX;
+        float velocityY;
+        float age;
+        float ageRate;
+        float launchVelocityX;
+        float launchVelocityY;
+    };
+
+    // UAV として書き込める DEFAULT ヒープのバッファを固定の配置リソースとして作成する（GPU が書き込むため退避/移動しない）
+    GpuResourceHandle CreateUnorderedAccessBuffer(uint64_t size) const;
+    void DestroyBuffers();
+
+    D3D12Context* ctx = nullptr;
+    D3D12CommandList commandList; // D3D12_COMMAND_LIST_TYPE_COMPUTE、フレームスロットごとのアロケータ
+    Microsoft::WRL::ComPtr<ID3D12RootSignature> rootSignature;
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> pipelineState;
+    GpuResourceHandle stateBuffer = INVALID_GPU_RESOURCE;
+    GpuResourceHandle instanceBuffers[MAX_FRAMES_IN_FLIGHT] = {}; // 同時投入フレーム数の分だけ作成する
+    QueueSyncPoint slotReadSyncPoints[MAX_FRAMES_IN_FLIGHT]; // スロットのインスタンスバッファを最後に読む描画の完了点
+    uint32_t particleCount = 0;
+};
@@ -0,0 +1,135 @@
+﻿#include "D3D12PipelineLibrary.h"
+#include "../Core/Hash.h"
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+namespace {
+// ライブラリ内の名前は PSO 記述子から計算したキーの 16 進表記
+std::wstring MakePipelineName(uint64_t key)
+{
+    wchar_t name[32];
+    swprintf_s(name, L"%016llx", static_cast<unsigned long long>(key));
+    return name;
+}
+} // namespace
+
+// ポインタを含むメンバは指す先の内容をハッシュに含める
+uint64_t ComputeGraphicsPipelineKey(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash)
+{
+    uint64_t hash = HashCombine(HASH_SEED, rootSignatureHash);
+    hash = HashBytes(desc.VS.pShaderBytecode, desc.VS.BytecodeLength, hash);
+    hash = HashBytes(desc.PS.pShaderBytecode, desc.PS.BytecodeLength, hash);
+    hash = HashBytes(desc.DS.pShaderBytecode, desc.DS.BytecodeLength, hash);
+    hash = HashBytes(desc.HS.pShaderBytecode, desc.HS.BytecodeLength, hash);
+    hash = HashBytes(desc.GS.pShaderBytecode, desc.GS.BytecodeLength, hash);
+    hash = HashBytes(&desc.BlendState, sizeof(desc.BlendState), hash);
+    hash = HashCombine(hash, desc.SampleMask);
+    hash = HashBytes(&desc.RasterizerState, sizeof(desc.RasterizerState), hash);
+    hash = HashBytes(&desc.DepthStencilState, sizeof(desc.DepthStencilState), hash);
+    for (UINT i = 0; i < desc.InputLayout.NumElements; ++i) {
+        const D3D12_INPUT_ELEMENT_DESC& element = desc.InputLayout.pInputElementDescs[i];
+        hash = HashString(element.SemanticName, hash);
+        hash = HashCombine(hash, element.SemanticIndex);
+        hash = HashCombine(hash, element.Format);
+        hash = HashCombine(hash, element.InputSlot);
+        hash = HashCombine(hash, element.AlignedByteOffset);
+        hash = HashCombine(hash, element.InputSlotClass);
+        hash = HashCombine(hash, element.InstanceDataStepRate);
+    }
+    hash = HashCombine(hash, desc.IBStripCutValue);
+    hash = HashCombine(hash, desc.PrimitiveTopologyType);
+    hash = HashCombine(hash, desc.NumRenderTargets);
+    for (UINT i = 0; i < desc.NumRenderTargets; ++i) {
+        hash = HashCombine(hash, desc.RTVFormats[i]);
+    }
+    hash = HashCombine(hash, desc.DSVFormat);
+    hash = HashCombine(hash, desc.SampleDesc.Count);
+    hash = HashCombine(hash, desc.SampleDesc.Quality);
+    hash = HashCombine(hash, desc.Flags);
+    return hash;
+}
+
+// state.hash が入力レイアウトを含む固定機能ステートをすべて表すため、記述子のそれ以外のメンバは見ない
+uint64_t ComputeGraphicsPipelineKey(const PipelineStateKey& state, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash)
+{
+    uint64_t hash = HashCombine(HASH_SEED, rootSignatureHash);
+    hash = HashCombine(hash, state.hash);
+    hash = HashBytes(desc.VS.pShaderBytecode, desc.VS.BytecodeLength, hash);
+    hash = HashBytes(desc.PS.pShaderBytecode, desc.PS.BytecodeLength, hash);
+    hash = HashBytes(desc.DS.pShaderBytecode, desc.DS.BytecodeLength, hash);
+    hash = HashBytes(desc.HS.pShaderBytecode, desc.HS.BytecodeLength, hash);
+    hash = HashBytes(desc.GS.pShaderBytecode, desc.GS.BytecodeLength, hash);
+    return hash;
+}
+
+// 引数: d3dDevice=PSO を作成するデバイス、filePath=シリアライズしたライブラリの保存先
+void D3D12PipelineLibrary::Initialize(ID3D12Device* d3dDevice, const std::filesystem::path& filePath)
+{
+    device = d3dDevice;
+    path = filePath;
+
+    Microsoft::WRL::ComPtr<ID3D12Device1> device1;
+    if (FAILED(device.As(&device1))) {
+        return;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (file) {
+        serializedData.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    if (!serializedData.empty() && SUCCEEDED(device1->CreatePipelineLibrary(serializedData.data(), serializedData.size(), IID_PPV_ARGS(&library)))) {
+        return;
+    }
+
+    // ファイルがない、または別のドライバ/デバイスで作成されたものは破棄して空から作る
+    serializedData.clear();
+    if (FAILED(device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&library)))) {
+        library.Reset();
+    }
+    dirty = true;
+}
+
+Microsoft::WRL::ComPtr<ID3D12PipelineState> D3D12PipelineLibrary::GetOrCreateGraphicsPipeline(uint64_t key, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc)
+{
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> pipelineState;
+    const std::wstring name = MakePipelineName(key);
+    if (library && SUCCEEDED(library->LoadGraphicsPipeline(name.c_str(), &desc, IID_PPV_ARGS(&pipelineState)))) {
+        ++loadedCount;
+        return pipelineState;
+    }
+
+    if (FAILED(device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pipelineState)))) {
+        throw std::runtime_error("Failed to create graphics pipeline state");
+    }
+    ++createdCount;
+    if (library && SUCCEEDED(library->StorePipeline(name.c_str(), pipelineState.Get()))) {
+        dirty = true;
+    }
+    return pipelineState;
+}
+
+void D3D12PipelineLibrary::Save()
+{
+    if (!library || !dirty) {
+        return;
+    }
+    std::vector<uint8_t> data(library->GetSerializedSize());
+    if (data.empty() || FAILED(library->Serialize(data.data(), data.size()))) {
+        return;
+    }
+
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!file) {
+            return;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    dirty = !!error;
+}
@@ -0,0 +1,43 @@
+﻿#pragma once
+
+#include <windows.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+#include "PipelineState.h"
+
+// ID3D12PipelineLibrary を使った PSO のディスクキャッシュ。
+// 起動時にシリアライズ済みのライブラリを読み込み、見つからない PSO だけを作成して追加する。
+// ドライバやデバイスが変わって読み込めない場合は空のライブラリから作り直す。
+// PSO 記述子の内容（シェーダのバイトコードを含む）から 64bit キーを計算する。
+// ルートシグネチャはポインタしか持たないため、シリアライズ結果のハッシュを rootSignatureHash として渡す。
+uint64_t ComputeGraphicsPipelineKey(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash);
+// 固定機能ステートを PipelineStateBuilder で作った場合は、コンパイル時に求めたキーにシェーダとルートシグネチャだけを加える
+uint64_t ComputeGraphicsPipelineKey(const PipelineStateKey& state, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, uint64_t rootSignatureHash);
+
+class D3D12PipelineLibrary {
+public:
+    // ライブラリ非対応の環境では例外を送出せず、常に PSO を直接作成する
+    void Initialize(ID3D12Device* d3dDevice, const std::filesystem::path& filePath);
+
+    // key に対応する PSO をライブラリから読み込み、なければ作成してライブラリに登録する。
+    // 例外: PSO の作成に失敗した場合は std::runtime_error を送出
+    Microsoft::WRL::ComPtr<ID3D12PipelineState> GetOrCreateGraphicsPipeline(uint64_t key, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc);
+
+    // 新しく登録した PSO があればライブラリをファイルへ書き出す
+    void Save();
+
+    uint32_t GetLoadedCount() const { return loadedCount; }
+    uint32_t GetCreatedCount() const { return createdCount; }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12Device> device;
+    Microsoft::WRL::ComPtr<ID3D12PipelineLibrary> library;
+    std::filesystem::path path;
+    std::vector<uint8_t> serializedData; // ライブラリが参照するためライブラリより長く保持する
+    uint32_t loadedCount = 0;
+    uint32_t createdCount = 0;
+    bool dirty = false;
+};
@@ -0,0 +1,114 @@
+﻿#include "D3D12PipelineState.h"
+
+namespace {
+
+DXGI_FORMAT ToDxgiFormat(TextureFormat format)
+{
+    switch (format) {
+    case TextureFormat::RGBA8Unorm:
+        return DXGI_FORMAT_R8G8B8A8_UNORM;
+    case TextureFormat::RGBA16Float:
+        return DXGI_FORMAT_R16G16B16A16_FLOAT;
+    case TextureFormat::R32Float:
+        return DXGI_FORMAT_R32_FLOAT;
+    case TextureFormat::D32Float:
+        return DXGI_FORMAT_D32_FLOAT;
+    case TextureFormat::BC1Unorm:
+        return DXGI_FORMAT_BC1_UNORM;
+    case TextureFormat::BC3Unorm:
+        return DXGI_FORMAT_BC3_UNORM;
+    case TextureFormat::BC7Unorm:
+        return DXGI_FORMAT_BC7_UNORM;
+    }
+    return DXGI_FORMAT_UNKNOWN;
+}
+
+D3D12_RENDER_TARGET_BLEND_DESC ToD3D12BlendDesc(BlendMode mode)
+{
+    D3D12_RENDER_TARGET_BLEND_DESC blend{};
+    blend.BlendEnable = mode != BlendMode::Opaque;
+    blend.LogicOpEnable = FALSE;
+    blend.SrcBlend = D3D12_BLEND_ONE;
+    blend.DestBlend = D3D12_BLEND_ZERO;
+    blend.BlendOp = D3D12_BLEND_OP_ADD;
+    blend.SrcBlendAlpha = D3D12_BLEND_ONE;
+    blend.DestBlendAlpha = D3D12_BLEND_ZERO;
+    blend.BlendOpAlpha = D3D12_BLEND_OP_ADD;
+    blend.LogicOp = D3D12_LOGIC_OP_NOOP;
+    blend.RenderTargetWriteMask = D3D12_COLOR_WRITE_ENABLE_ALL;
+    switch (mode) {
+    case BlendMode::Opaque:
+        break;
+    case BlendMode::AlphaBlend:
+        blend.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+        blend.DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+        blend.DestBlendAlpha = D3D12_BLEND_INV_SRC_ALPHA;
+        break;
+    case BlendMode::Premultiplied:
+        blend.DestBlend = D3D12_BLEND_INV_SRC_ALPHA;
+        blend.DestBlendAlpha = D3D12_BLEND_INV_SRC_ALPHA;
+        break;
+    case BlendMode::Additive:
+        blend.SrcBlend = D3D12_BLEND_SRC_ALPHA;
+        blend.DestBlend = D3D12_BLEND_ONE;
+        blend.DestBlendAlpha = D3D12_BLEND_ONE;
+        break;
+    }
+    return blend;
+}
+
+D3D12_PRIMITIVE_TOPOLOGY_TYPE ToD3D12TopologyType(PrimitiveTopologyType type)
+{
+    switch (type) {
+    case PrimitiveTopologyType::Triangle:
+        return D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+    case PrimitiveTopologyType::Line:
+        return D3D12_PRIMITIVE_TOPOLOGY_TYPE_LINE;
+    case PrimitiveTopologyType::Point:
+        return D3D12_PRIMITIVE_TOPOLOGY_TYPE_POINT;
+    }
+    return D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
+}
+
+} // namespace
+
+// 全レンダーターゲットに同じブレンドを使い、サンプルマスクはすべて有効にする
+void ApplyPipelineState(const PipelineStateDesc& desc, D3D12_GRAPHICS_PIPELINE_STATE_DESC& psoDesc)
+{
+    psoDesc.BlendState = {};
+    psoDesc.BlendState.AlphaToCoverageEnable = FALSE;
+    psoDesc.BlendState.IndependentBlendEnable = FALSE;
+    const D3D12_RENDER_TARGET_BLEND_DESC blend = ToD3D12BlendDesc(desc.blend);
+    for (D3D12_RENDER_TARGET_BLEND_DESC& target : psoDesc.BlendState.RenderTarget) {
+        target = blend;
+    }
+    psoDesc.SampleMask = UINT_MAX;
+
+    D3D12_RASTERIZER_DESC& raster = psoDesc.RasterizerState;
+    raster = {};
+    raster.FillMode = desc.fill == FillMode::Wireframe ? D3D12_FILL_MODE_WIREFRAME : D3D12_FILL_MODE_SOLID;
+    raster.CullMode = desc.cull == CullMode::Back ? D3D12_CULL_MODE_BACK : desc.cull == CullMode::Front ? D3D12_CULL_MODE_FRONT : D3D12_CULL_MODE_NONE;
+    raster.FrontCounterClockwise = desc.frontCounterClockwise;
+    raster.DepthBias = D3D12_DEFAULT_DEPTH_BIAS;
+    raster.DepthBiasClamp = D3D12_DEFAULT_DEPTH_BIAS_CLAMP;
+    raster.SlopeScaledDepthBias = D3D12_DEFAULT_SLOPE_SCALED_DEPTH_BIAS;
+    raster.DepthClipEnable = desc.depthClip;
+    raster.MultisampleEnable = desc.sampleCount > 1;
+    raster.ConservativeRaster = D3D12_CONSERVATIVE_RASTERIZATION_MODE_OFF;
+
+    D3D12_DEPTH_STENCIL_DESC& depth = psoDesc.DepthStencilState;
+    depth = {};
+    depth.DepthEnable = desc.depth != DepthMode::Disabled;
+    depth.DepthWriteMask = desc.depth == DepthMode::TestWrite ? D3D12_DEPTH_WRITE_MASK_ALL : D3D12_DEPTH_WRITE_MASK_ZERO;
+    depth.DepthFunc = desc.depth == DepthMode::TestWrite ? D3D12_COMPARISON_FUNC_LESS : D3D12_COMPARISON_FUNC_LESS_EQUAL;
+    depth.StencilEnable = FALSE;
+
+    psoDesc.PrimitiveTopologyType = ToD3D12TopologyType(desc.topology);
+    psoDesc.NumRenderTargets = desc.renderTargetCount;
+    for (uint32_t i = 0; i < D3D12_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i) {
+        psoDesc.RTVFormats[i] = i < desc.renderTargetCount ? ToDxgiFormat(desc.renderTargetFormat) : DXGI_FORMAT_UNKNOWN;
+    }
+    psoDesc.DSVFormat = desc.depthFormat == NO_DEPTH_FORMAT ? DXGI_FORMAT_UNKNOWN : ToDxgiFormat(static_cast<TextureFormat>(desc.depthFormat));
+    psoDesc.SampleDesc.Count = desc.sampleCount;
+    psoDesc.SampleDesc.Quality = 0;
+}
@@ -0,0 +1,46 @@
+﻿#pragma once
+
+#include <windows.h>
+#include <d3d12.h>
+#include <array>
+#include <cstdint>
+#include "PipelineState.h"
+#include "VertexFormat.h"
+
+// PipelineStateDesc/VertexLayout から D3D12 の記述子への変換。
+
+constexpr DXGI_FORMAT ToDxgiFormat(VertexElementFormat format)
+{
+    switch (format) {
+    case VertexElementFormat::Float1:
+        return DXGI_FORMAT_R32_FLOAT;
+    case VertexElementFormat::Float2:
+        return DXGI_FORMAT_R32G32_FLOAT;
+    case VertexElementFormat::Float3:
+        return DXGI_FORMAT_R32G32B32_FLOAT;
+    case VertexElementFormat::Float4:
+        return DXGI_FORMAT_R32G32B32A32_FLOAT;
+    case VertexElementFormat::UNorm8x4:
+        return DXGI_FORMAT_R8G8B8A8_UNORM;
+    }
+    return DXGI_FORMAT_UNKNOWN;
+}
+
+// Layout の要素を D3D12_INPUT_ELEMENT_DESC の配列にする（インスタンスのスロットは 1 インスタンスごとに進める）
+template <typename Layout>
+constexpr std::array<D3D12_INPUT_ELEMENT_DESC, Layout::ELEMENT_COUNT> MakeD3D12InputLayout()
+{
+    std::array<D3D12_INPUT_ELEMENT_DESC, Layout::ELEMENT_COUNT> elements = {};
+    for (uint32_t i = 0; i < Layout::ELEMENT_COUNT; ++i) {
+        const VertexElement& element = Layout::ELEMENTS[i];
+        const bool perInstance = element.rate == VertexInputRate::PerInstance;
+        elements[i] = { element.semantic, element.semanticIndex, ToDxgiFormat(element.format), element.slot, element.offset,
+                        perInstance ? D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA : D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, perInstance ? 1u : 0u };
+    }
+    return elements;
+}
+
+// desc の固定機能ステート（ブレンド、ラスタライズ、深度、トポロジ、出力形式）を psoDesc に書き込む。
+// シェーダ、ルートシグネチャ、入力レイアウトは呼び出し元で設定する
+void ApplyPipelineState(const PipelineStateDesc& desc, D3D12_GRAPHICS_PIPELINE_STATE_DESC& psoDesc);
+
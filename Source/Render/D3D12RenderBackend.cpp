@@ -0,0 +1,138 @@
+﻿#include "D3D12RenderBackend.h"
+#include "DirectXMain.h" // D3D12Context の完全定義が必要
+#include "../Core/Profiler.h"
+
+// このスロットを前回使用したフレームの完了を待ち、完了済みのアップロード領域/ディスクリプタテーブル/配置リソースと
+// GPU タイムスタンプを回収し、一時テクスチャのプールにフレームの開始を伝えてから、バックバッファサイズでビューポート/シザーを決定する
+BackendFrame D3D12RenderBackend::BeginFrame()
+{
+    ctx->frameSlot = ctx->frameScheduler.BeginFrame();
+    ctx->gpuProfiler.BeginFrame(ctx->frameSlot);
+    const UINT64 completedFenceValue = ctx->frameScheduler.GetCompletedFenceValue();
+    ctx->frameUploadRing.Retire(completedFenceValue);
+    ctx->shaderVisibleHeap.Retire(completedFenceValue);
+    ctx->gpuMemory.BeginFrame(ctx->frameScheduler.GetCurrentFenceValue(), completedFenceValue);
+    ctx->transientPool.BeginFrame(ctx->frameSlot);
+
+    const D3D12_RESOURCE_DESC backBufferDesc = ctx->renderTargets[ctx->frameIndex]->GetDesc();
+    BackendFrame frame;
+    frame.frameSlot = ctx->frameSlot;
+    frame.backBuffer = ctx->backBufferIds[ctx->frameIndex];
+    frame.target.renderTarget = ctx->backBufferRtvIds[ctx->frameIndex];
+    frame.target.viewport = { 0.0f, 0.0f, static_cast<float>(backBufferDesc.Width), static_cast<float>(backBufferDesc.Height), 0.0f, 1.0f };
+    frame.target.scissor = { 0, 0, static_cast<int32_t>(backBufferDesc.Width), static_cast<int32_t>(backBufferDesc.Height) };
+    return frame;
+}
+
+ICommandList& D3D12RenderBackend::GetFrameBeginCommandList()
+{
+    return ctx->frameBeginCommandList;
+}
+
+ICommandList& D3D12RenderBackend::GetFrameEndCommandList()
+{
+    return ctx->frameEndCommandList;
+}
+
+ParallelCommandRecorder& D3D12RenderBackend::GetCommandRecorder()
+{
+    return ctx->commandRecorder;
+}
+
+bool D3D12RenderBackend::AllocateFrameMemory(uint64_t size, uint64_t alignment, FrameAllocation& allocation)
+{
+    UploadAllocation upload;
+    if (!ctx->frameUploadRing.Allocate(size, alignment, upload)) {
+        return false;
+    }
+    allocation.cpuAddress = upload.cpuAddress;
+    allocation.gpuAddress = upload.gpuAddress;
+    return true;
+}
+
+// コマンドリストはすべてこのバックエンドが作成した D3D12CommandList
+uint32_t D3D12RenderBackend::BeginGpuScope(ICommandList& commandList, const char* name)
+{
+    return ctx->gpuProfiler.BeginScope(static_cast<D3D12CommandList&>(commandList).GetNative(), name);
+}
+
+void D3D12RenderBackend::EndGpuScope(ICommandList& commandList, uint32_t scope)
+{
+    ctx->gpuProfiler.EndScope(static_cast<D3D12CommandList&>(commandList).GetNative(), scope);
+}
+
+void D3D12RenderBackend::ResolveGpuScopes(ICommandList& commandList)
+{
+    ctx->gpuProfiler.EndFrame(static_cast<D3D12CommandList&>(commandList).GetNative());
+}
+
+void D3D12RenderBackend::SubmitAndPresent(ICommandList* const* lists, uint32_t count)
+{
+    // 記録中に予約されたディスクリプタテーブルへのコピーをまとめて実行
+    ctx->shaderVisibleHeap.FlushCopies();
+
+    // 記録されたアップロードを投入し、描画キューにコピー完了を待たせる
+    if (ctx->uploader.HasPendingCopies()) {
+        ctx->uploader.Submit();
+        ctx->uploader.WaitOnQueue(ctx->commandQueue.Get());
+    }
+
+    // GPUに対して「記録済みのコマンドリストを実行せよ」と指示する（記録順のまま 1 回で投入）。
+    // このフレームのコンピュートの投入（パーティクルの更新など）があれば、その完了を GPU 上で待ってから実行する
+    ctx->queueScheduler.Submit(GpuQueueType::Graphics, lists, count);
+
+    // 「描画結果を画面に出す」ための最終ステップ。バックバッファをフロントバッファに切り替えて表示する
+    // 第1引数：SyncInterval
+    //    0 → 垂直同期なし（即時表示、ティアリングが発生する可能性あり）
+    //    1 → 垂直同期あり（1フレーム分待つ、通常はこれ）
+    // 第2引数：Flags
+    //    DXGI_PRESENT_ALLOW_TEARING → 可変リフレッシュレート/ウィンドウモードでもティアリングを許可する
+    //    （スワップチェーンを DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING で作成した場合のみ指定できる）
+    {
+        PROFILE_SCOPE("Present");
+        const bool uncapped = ctx->presentMode == PresentMode::Uncapped;
+        const UINT presentFlags = uncapped && ctx->tearingSupported ? DXGI_PRESENT_ALLOW_TEARING : 0;
+        ctx->swapChain->Present(uncapped ? 0 : 1, presentFlags);
+    }
+
+    // フェンス値をスロットに記録してフレームインデックスを更新（GPU の完了は待たない）
+    MoveToNextFrame();
+}
+
+void D3D12RenderBackend::WaitForIdle()
+{
+    ctx->frameScheduler.WaitForIdle();
+}
+
+// GPU アドレスを返すため固定の配置リソースとして作成し、コピーキューで転送する（次の SubmitAndPresent で投入される）
+uint64_t D3D12RenderBackend::CreateStaticBuffer(const void* data, uint64_t size)
+{
+    const GpuResourceHandle buffer = ctx->gpuMemory.CreateBuffer(data, size, D3D12_RESOURCE_FLAG_NONE, true);
+    ctx->staticBuffers.push_back(buffer);
+    return ctx->gpuMemory.GetResource(buffer)->GetGPUVirtualAddress();
+}
+
+PipelineId D3D12RenderBackend::GetBuiltinPipeline(BuiltinPipeline pipeline) const
+{
+    return ctx->builtinPipelines[static_cast<size_t>(pipeline)];
+}
+
+TransientMemoryRequirements D3D12RenderBackend::GetTransientMemoryRequirements(const TextureDesc& desc) const
+{
+    return ctx->transientPool.GetMemoryRequirements(desc);
+}
+
+TransientTexture D3D12RenderBackend::AcquireTransientTexture(const TextureDesc& desc, ResourceState initialState, uint64_t heapOffset, uint64_t heapSize)
+{
+    return ctx->transientPool.Acquire(ctx->frameSlot, desc, initialState, heapOffset, heapSize);
+}
+
+IGpuParticleSimulator* D3D12RenderBackend::GetGpuParticleSimulator()
+{
+    return &ctx->particleSimulator;
+}
+
+double D3D12RenderBackend::GetLastGpuFrameTimeMs() const
+{
+    return ctx->gpuProfiler.GetLastFrameTimeMs();
+}
@@ -0,0 +1,35 @@
+﻿#pragma once
+
+#include "RenderBackend.h"
+
+struct D3D12Context; // forward declaration
+
+// D3D12Context のスワップチェーン/コマンドリスト/アップロードリングを使う IRenderBackend。
+class D3D12RenderBackend : public IRenderBackend {
+public:
+    // context: InitD3D12 で初期化済みのコンテキスト（所有しない）
+    void Initialize(D3D12Context* context) { ctx = context; }
+
+    const char* GetName() const override { return "d3d12"; }
+    BackendFrame BeginFrame() override;
+    ICommandList& GetFrameBeginCommandList() override;
+    ICommandList& GetFrameEndCommandList() override;
+    ParallelCommandRecorder& GetCommandRecorder() override;
+    bool AllocateFrameMemory(uint64_t size, uint64_t alignment, FrameAllocation& allocation) override;
+    uint32_t BeginGpuScope(ICommandList& commandList, const char* name) override;
+    void EndGpuScope(ICommandList& commandList, uint32_t scope) override;
+    void ResolveGpuScopes(ICommandList& commandList) override;
+    void SubmitAndPresent(ICommandList* const* lists, uint32_t count) override;
+    void WaitForIdle() override;
+    // 例外: バッファの作成に失敗した場合は std::runtime_error を送出
+    uint64_t CreateStaticBuffer(const void* data, uint64_t size) override;
+    PipelineId GetBuiltinPipeline(BuiltinPipeline pipeline) const override;
+    TransientMemoryRequirements GetTransientMemoryRequirements(const TextureDesc& desc) const override;
+    TransientTexture AcquireTransientTexture(const TextureDesc& desc, ResourceState initialState, uint64_t heapOffset, uint64_t heapSize) override;
+    double GetLastGpuFrameTimeMs() const override;
+    // コンピュートキューの作業はフレームの描画が待つため、スロットのフェンス待ちでコンピュート用アロケータも再利用できる
+    IGpuParticleSimulator* GetGpuParticleSimulator() override;
+
+private:
+    D3D12Context* ctx = nullptr;
+};
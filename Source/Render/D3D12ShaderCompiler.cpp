@@ -0,0 +1,65 @@
+﻿#include "D3D12ShaderCompiler.h"
+#include <windows.h>
+#include <d3dcompiler.h>
+#include <wrl/client.h>
+#include <vector>
+
+#pragma comment(lib, "version.lib")
+
+// マクロ定義を D3D_SHADER_MACRO の配列（null 終端）に変換してコンパイルする。
+// 引数:
+//  - request: ソース、マクロ、エントリポイント、プロファイル、D3DCOMPILE_* フラグ
+//  - bytecode: 成功時にバイトコードを格納
+//  - errors: 失敗時にコンパイラのメッセージを格納
+bool CompileShaderD3D(const ShaderCompileRequest& request, ShaderBytecode& bytecode, std::string& errors)
+{
+    std::vector<D3D_SHADER_MACRO> macros;
+    macros.reserve(request.defines.size() + 1);
+    for (const auto& [name, value] : request.defines) {
+        macros.push_back({ name.c_str(), value.c_str() });
+    }
+    macros.push_back({ nullptr, nullptr });
+
+    Microsoft::WRL::ComPtr<ID3DBlob> codeBlob, errorBlob;
+    const HRESULT hr = D3DCompile(request.source.data(), request.source.size(), request.name.c_str(), macros.data(), nullptr,
+                                  request.entryPoint.c_str(), request.profile.c_str(), request.flags, 0, &codeBlob, &errorBlob);
+    if (FAILED(hr)) {
+        if (errorBlob) {
+            errors.assign(static_cast<const char*>(errorBlob->GetBufferPointer()), errorBlob->GetBufferSize());
+        }
+        else {
+            errors = "D3DCompile failed";
+        }
+        return false;
+    }
+    const auto* code = static_cast<const uint8_t*>(codeBlob->GetBufferPointer());
+    bytecode.assign(code, code + codeBlob->GetBufferSize());
+    return true;
+}
+
+// DLL が更新されるとファイルバージョンが変わり、以前のバイトコードはすべて別キーになる。
+// バージョンを取得できない場合は DLL 名だけを返す
+std::string GetD3DCompilerId()
+{
+    std::string id = D3DCOMPILER_DLL_A;
+    const HMODULE module = GetModuleHandleW(D3DCOMPILER_DLL_W);
+    wchar_t path[MAX_PATH];
+    if (!module || GetModuleFileNameW(module, path, MAX_PATH) == 0) {
+        return id;
+    }
+    DWORD handle = 0;
+    const DWORD infoSize = GetFileVersionInfoSizeW(path, &handle);
+    if (infoSize == 0) {
+        return id;
+    }
+    std::vector<uint8_t> info(infoSize);
+    VS_FIXEDFILEINFO* fileInfo = nullptr;
+    UINT fileInfoSize = 0;
+    if (!GetFileVersionInfoW(path, 0, infoSize, info.data()) ||
+        !VerQueryValueW(info.data(), L"\\", reinterpret_cast<void**>(&fileInfo), &fileInfoSize) || fileInfoSize < sizeof(VS_FIXEDFILEINFO)) {
+        return id;
+    }
+    id += " " + std::to_string(HIWORD(fileInfo->dwFileVersionMS)) + "." + std::to_string(LOWORD(fileInfo->dwFileVersionMS)) + "." +
+          std::to_string(HIWORD(fileInfo->dwFileVersionLS)) + "." + std::to_string(LOWORD(fileInfo->dwFileVersionLS));
+    return id;
+}
@@ -0,0 +1,11 @@
+﻿#pragma once
+
+#include <string>
+#include "ShaderCache.h"
+
+// D3DCompile を使って request をコンパイルする（ShaderCompileFunction として使用できる）。
+// 複数スレッドから同時に呼び出してよい。
+bool CompileShaderD3D(const ShaderCompileRequest& request, ShaderBytecode& bytecode, std::string& errors);
+
+// キャッシュキーに含めるコンパイラ識別子（読み込まれている DLL の名前とファイルバージョン）
+std::string GetD3DCompilerId();
@@ -0,0 +1,184 @@
+﻿#include "D3D12TransientResourcePool.h"
+#include <stdexcept>
+
+namespace {
+
+DXGI_FORMAT ToDxgiFormat(TextureFormat format)
+{
+    switch (format) {
+    case TextureFormat::RGBA8Unorm:
+        return DXGI_FORMAT_R8G8B8A8_UNORM;
+    case TextureFormat::RGBA16Float:
+        return DXGI_FORMAT_R16G16B16A16_FLOAT;
+    case TextureFormat::R32Float:
+        return DXGI_FORMAT_R32_FLOAT;
+    case TextureFormat::D32Float:
+        return DXGI_FORMAT_D32_FLOAT;
+    case TextureFormat::BC1Unorm:
+        return DXGI_FORMAT_BC1_UNORM;
+    case TextureFormat::BC3Unorm:
+        return DXGI_FORMAT_BC3_UNORM;
+    case TextureFormat::BC7Unorm:
+        return DXGI_FORMAT_BC7_UNORM;
+    }
+    return DXGI_FORMAT_UNKNOWN;
+}
+
+bool IsDepthFormat(TextureFormat format)
+{
+    return format == TextureFormat::D32Float;
+}
+
+D3D12_RESOURCE_DESC MakeTextureResourceDesc(const TextureDesc& desc)
+{
+    D3D12_RESOURCE_DESC resDesc{};
+    resDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+    resDesc.Width = desc.width;
+    resDesc.Height = desc.height;
+    resDesc.DepthOrArraySize = 1;
+    resDesc.MipLevels = 1;
+    resDesc.Format = ToDxgiFormat(desc.format);
+    resDesc.SampleDesc = { 1, 0 };
+    resDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+    resDesc.Flags = IsDepthFormat(desc.format) ? D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL : D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET;
+    return resDesc;
+}
+
+} // namespace
+
+// 引数:
+//  - d3dDevice: ヒープとリソースの作成に使用するデバイス
+//  - resourceRegistry/rtvDescriptorHeap/srvDescriptorHeap: 作成したリソースと RTV/SRV の登録先
+//  - shaderVisibleDescriptorHeap: フレームごとの SRV のテーブルを確保するヒープ
+void D3D12TransientResourcePool::Initialize(ID3D12Device* d3dDevice, D3D12ResourceRegistry* resourceRegistry, D3D12StagingDescriptorHeap* rtvDescriptorHeap,
+                                            D3D12StagingDescriptorHeap* srvDescriptorHeap, D3D12ShaderVisibleDescriptorRing* shaderVisibleDescriptorHeap)
+{
+    device = d3dDevice;
+    registry = resourceRegistry;
+    rtvHeap = rtvDescriptorHeap;
+    srvHeap = srvDescriptorHeap;
+    shaderVisibleHeap = shaderVisibleDescriptorHeap;
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+        slots[i] = {};
+    }
+}
+
+TransientMemoryRequirements D3D12TransientResourcePool::GetMemoryRequirements(const TextureDesc& desc) const
+{
+    const D3D12_RESOURCE_DESC resDesc = MakeTextureResourceDesc(desc);
+    const D3D12_RESOURCE_ALLOCATION_INFO info = device->GetResourceAllocationInfo(0, 1, &resDesc);
+    return { info.SizeInBytes, info.Alignment };
+}
+
+// BeginFrame でこのスロットを前回使用したフレームの完了を待った後に呼び出すため、
+// ヒープの作り直しで解放するリソースを GPU が使用していることはない
+TransientTexture D3D12TransientResourcePool::Acquire(uint32_t frameSlot, const TextureDesc& desc, ResourceState initialState, uint64_t heapOffset, uint64_t heapSize)
+{
+    Slot& slot = slots[frameSlot];
+    if (slot.heapSize < heapSize) {
+        for (Entry& entry : slot.entries) {
+            entry.resource.Reset();
+        }
+        slot.heap.Reset();
+
+        D3D12_HEAP_DESC heapDesc{};
+        heapDesc.SizeInBytes = heapSize;
+        heapDesc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+        heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+        heapDesc.Flags = D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+        if (FAILED(device->CreateHeap(&heapDesc, IID_PPV_ARGS(&slot.heap)))) {
+            throw std::runtime_error("Failed to create transient resource heap");
+        }
+        slot.heapSize = heapSize;
+    }
+
+    // 同じ要求の作成済みリソース、なければヒープの作り直しで空いたエントリか
+    // 直近 2 フレームで使われていないエントリを使う
+    Entry* found = nullptr;
+    for (Entry& entry : slot.entries) {
+        if (entry.desc == desc && entry.initialState == initialState && entry.heapOffset == heapOffset && entry.resource) {
+            found = &entry;
+            break;
+        }
+    }
+    if (!found) {
+        for (Entry& entry : slot.entries) {
+            const bool stale = entry.lastUsedFrame + 2 <= slot.frameNumber;
+            if ((!entry.resource || stale) && IsDepthFormat(entry.desc.format) == IsDepthFormat(desc.format)) {
+                found = &entry;
+                break;
+            }
+        }
+    }
+    if (!found) {
+        slot.entries.emplace_back();
+        found = &slot.entries.back();
+    }
+    if (!found->resource || !(found->desc == desc && found->initialState == initialState && found->heapOffset == heapOffset)) {
+        found->resource.Reset();
+        found->desc = desc;
+        found->initialState = initialState;
+        found->heapOffset = heapOffset;
+        CreateEntryResource(slot, *found);
+    }
+    found->lastUsedFrame = slot.frameNumber;
+
+    TransientTexture texture;
+    texture.resource = found->id;
+    texture.renderTarget = found->rtvId;
+    if (found->srv.IsValid()) {
+        const DescriptorTable table = shaderVisibleHeap->AllocateTable(1);
+        if (!table.IsValid()) {
+            throw std::runtime_error("Failed to allocate shader-visible descriptor table");
+        }
+        shaderVisibleHeap->StageCopy(table, 0, found->srv.cpu);
+        if (found->srvId == INVALID_RESOURCE_ID) {
+            found->srvId = registry->RegisterShaderResource(table.gpu);
+        }
+        else {
+            registry->UpdateShaderResource(found->srvId, table.gpu);
+        }
+        texture.shaderResource = found->srvId;
+    }
+    return texture;
+}
+
+// 例外: 作成に失敗した場合は std::runtime_error を送出
+void D3D12TransientResourcePool::CreateEntryResource(Slot& slot, Entry& entry)
+{
+    const D3D12_RESOURCE_DESC resDesc = MakeTextureResourceDesc(entry.desc);
+    if (FAILED(device->CreatePlacedResource(slot.heap.Get(), entry.heapOffset, &resDesc, ToD3D12ResourceState(entry.initialState), nullptr, IID_PPV_ARGS(&entry.resource)))) {
+        throw std::runtime_error("Failed to create transient texture");
+    }
+    if (entry.id == INVALID_RESOURCE_ID) {
+        entry.id = registry->RegisterResource(entry.resource.Get());
+    }
+    else {
+        registry->UpdateResource(entry.id, entry.resource.Get());
+    }
+
+    if (IsDepthFormat(entry.desc.format)) {
+        return;
+    }
+    if (!entry.rtv.IsValid()) {
+        entry.rtv = rtvHeap->Allocate();
+        if (!entry.rtv.IsValid()) {
+            throw std::runtime_error("Failed to allocate RTV descriptor");
+        }
+    }
+    device->CreateRenderTargetView(entry.resource.Get(), nullptr, entry.rtv.cpu);
+    if (entry.rtvId == INVALID_RESOURCE_ID) {
+        entry.rtvId = registry->RegisterRenderTarget(entry.rtv.cpu);
+    }
+    else {
+        registry->UpdateRenderTarget(entry.rtvId, entry.rtv.cpu);
+    }
+
+    if (!entry.srv.IsValid()) {
+        entry.srv = srvHeap->Allocate();
+        if (!entry.srv.IsValid()) {
+            throw std::runtime_error("Failed to allocate SRV descriptor");
+        }
+    }
+    device->CreateShaderResourceView(entry.resource.Get(), nullptr, entry.srv.cpu);
+}
@@ -0,0 +1,61 @@
+﻿#pragma once
+
+#include <windows.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <vector>
+#include "D3D12CommandList.h"
+#include "D3D12DescriptorHeap.h"
+#include "RenderGraph.h"
+
+// レンダーグラフの一時テクスチャを、フレームスロットごとのヒープへ配置して貸し出す。
+// 同じ記述子/初期状態/オフセットの要求には作成済みのリソースを返し、
+// ヒープが足りなくなったスロットだけヒープを作り直す（ID と RTV/SRV は使い回してレジストリを差し替える）。
+// 前回と前々回のフレームで使われなかったエントリは、別の記述子の要求に作り直して使う
+// （動的解像度で大きさが変わってもエントリが増え続けないようにする）。
+// カラーテクスチャの SRV は、要求のたびにそのフレームのシェーダ可視ヒープのテーブルへコピーする。
+// BeginFrame/Acquire はメインスレッドで、記録を始める前に呼び出すこと。
+class D3D12TransientResourcePool {
+public:
+    // registry/rtvHeap/srvHeap: リソースと RTV/SRV の登録先、shaderVisibleHeap: SRV のテーブルの確保先（所有しない）
+    void Initialize(ID3D12Device* d3dDevice, D3D12ResourceRegistry* resourceRegistry, D3D12StagingDescriptorHeap* rtvDescriptorHeap,
+                    D3D12StagingDescriptorHeap* srvDescriptorHeap, D3D12ShaderVisibleDescriptorRing* shaderVisibleDescriptorHeap);
+    // frameSlot の新しいフレームを開始する（エントリの使用状況の判定に使う）
+    void BeginFrame(uint32_t frameSlot) { ++slots[frameSlot].frameNumber; }
+
+    TransientMemoryRequirements GetMemoryRequirements(const TextureDesc& desc) const;
+    // 例外: ヒープ/リソースの作成や RTV/SRV の確保に失敗した場合は std::runtime_error を送出
+    TransientTexture Acquire(uint32_t frameSlot, const TextureDesc& desc, ResourceState initialState, uint64_t heapOffset, uint64_t heapSize);
+
+    uint64_t GetHeapSize(uint32_t frameSlot) const { return slots[frameSlot].heapSize; }
+
+private:
+    struct Entry {
+        TextureDesc desc;
+        ResourceState initialState = ResourceState::Common;
+        uint64_t heapOffset = 0;
+        Microsoft::WRL::ComPtr<ID3D12Resource> resource; // ヒープを作り直すと空になる
+        ResourceId id = INVALID_RESOURCE_ID;
+        DescriptorHandle rtv;
+        RenderTargetId rtvId = INVALID_RESOURCE_ID;
+        DescriptorHandle srv;
+        ShaderResourceId srvId = INVALID_RESOURCE_ID;
+        uint64_t lastUsedFrame = 0;
+    };
+
+    struct Slot {
+        Microsoft::WRL::ComPtr<ID3D12Heap> heap;
+        uint64_t heapSize = 0;
+        uint64_t frameNumber = 0;
+        std::vector<Entry> entries;
+    };
+
+    void CreateEntryResource(Slot& slot, Entry& entry);
+
+    ID3D12Device* device = nullptr;
+    D3D12ResourceRegistry* registry = nullptr;
+    D3D12StagingDescriptorHeap* rtvHeap = nullptr;
+    D3D12StagingDescriptorHeap* srvHeap = nullptr;
+    D3D12ShaderVisibleDescriptorRing* shaderVisibleHeap = nullptr;
+    Slot slots[MAX_FRAMES_IN_FLIGHT];
+};
@@ -0,0 +1,62 @@
+﻿#include "D3D12UploadRingBuffer.h"
+#include <cstring>
+#include <stdexcept>
+
+// UPLOAD ヒープにバッファを作成し、解放まで Map したままにする。
+// 引数: device=作成に使用するデバイス、capacity=リングのバイト数
+void D3D12UploadRingBuffer::Initialize(ID3D12Device* device, uint64_t capacity)
+{
+    D3D12_HEAP_PROPERTIES heapProps{};
+    heapProps.Type = D3D12_HEAP_TYPE_UPLOAD;
+    const D3D12_RESOURCE_DESC resDesc = MakeBufferResourceDesc(capacity);
+    if (FAILED(device->CreateCommittedResource(&heapProps, D3D12_HEAP_FLAG_NONE, &resDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&buffer)))) {
+        throw std::runtime_error("Failed to create upload ring buffer");
+    }
+
+    // CPU から読み戻さないので読み取り範囲は空にする
+    D3D12_RANGE readRange{ 0, 0 };
+    void* mapped = nullptr;
+    if (FAILED(buffer->Map(0, &readRange, &mapped))) {
+        throw std::runtime_error("Failed to map upload ring buffer");
+    }
+    mappedData = static_cast<uint8_t*>(mapped);
+    baseGpuAddress = buffer->GetGPUVirtualAddress();
+    ring.Initialize(capacity);
+}
+
+bool D3D12UploadRingBuffer::Allocate(uint64_t size, uint64_t alignment, UploadAllocation& allocation)
+{
+    const uint64_t offset = ring.Allocate(size, alignment);
+    if (offset == LinearRingAllocator::INVALID_OFFSET) {
+        return false;
+    }
+    allocation.cpuAddress = mappedData + offset;
+    allocation.gpuAddress = baseGpuAddress + offset;
+    allocation.resource = buffer.Get();
+    allocation.offset = offset;
+    allocation.size = size;
+    return true;
+}
+
+bool D3D12UploadRingBuffer::Upload(const void* data, uint64_t size, uint64_t alignment, UploadAllocation& allocation)
+{
+    if (!Allocate(size, alignment, allocation)) {
+        return false;
+    }
+    std::memcpy(allocation.cpuAddress, data, static_cast<size_t>(size));
+    return true;
+}
+
+D3D12_RESOURCE_DESC MakeBufferResourceDesc(uint64_t size)
+{
+    D3D12_RESOURCE_DESC resDesc{};
+    resDesc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+    resDesc.Width = size;
+    resDesc.Height = 1;
+    resDesc.DepthOrArraySize = 1;
+    resDesc.MipLevels = 1;
+    resDesc.Format = DXGI_FORMAT_UNKNOWN;
+    resDesc.SampleDesc = { 1, 0 };
+    resDesc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+    return resDesc;
+}
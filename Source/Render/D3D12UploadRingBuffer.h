@@ -0,0 +1,44 @@
+﻿#pragma once
+
+#include <windows.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+#include "LinearRingAllocator.h"
+
+// リングから切り出した UPLOAD ヒープ上の領域
+struct UploadAllocation {
+    void* cpuAddress = nullptr;
+    D3D12_GPU_VIRTUAL_ADDRESS gpuAddress = 0;
+    ID3D12Resource* resource = nullptr;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+};
+
+// 永続的にマップした UPLOAD ヒープのバッファを LinearRingAllocator で切り出す。
+// フレームごとの定数や動的頂点、コピーキュー経由のアップロードのステージングに使用する。
+class D3D12UploadRingBuffer {
+public:
+    // 例外: バッファの作成/マップに失敗した場合は std::runtime_error を送出
+    void Initialize(ID3D12Device* device, uint64_t capacity);
+
+    // 戻り値: 空きが足りない場合は false（Retire で解放されるまで割り当てられない）
+    bool Allocate(uint64_t size, uint64_t alignment, UploadAllocation& allocation);
+    // data をリングにコピーして、その領域を返す
+    bool Upload(const void* data, uint64_t size, uint64_t alignment, UploadAllocation& allocation);
+
+    void FinishFrame(uint64_t fenceValue) { ring.FinishFrame(fenceValue); }
+    void Retire(uint64_t completedFenceValue) { ring.Retire(completedFenceValue); }
+
+    uint64_t GetCapacity() const { return ring.GetCapacity(); }
+    uint64_t GetUsedSize() const { return ring.GetUsedSize(); }
+    ID3D12Resource* GetResource() const { return buffer.Get(); }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D12Resource> buffer;
+    uint8_t* mappedData = nullptr;
+    D3D12_GPU_VIRTUAL_ADDRESS baseGpuAddress = 0;
+    LinearRingAllocator ring;
+};
+
+// バッファ作成用のリソース記述子を返す
+D3D12_RESOURCE_DESC MakeBufferResourceDesc(uint64_t size);
@@ -0,0 +1,123 @@
+﻿#include "D3D12Uploader.h"
+#include <stdexcept>
+
+// コピーキュー、コマンドリスト、フェンス、ステージング用リングを作成する。
+// 引数: d3dDevice=作成に使用するデバイス、stagingCapacity=ステージング用リングのバイト数
+void D3D12Uploader::Initialize(ID3D12Device* d3dDevice, uint64_t stagingCapacity)
+{
+    device = d3dDevice;
+
+    D3D12_COMMAND_QUEUE_DESC queueDesc{};
+    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+    if (FAILED(device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&copyQueue)))) {
+        throw std::runtime_error("Failed to create copy queue");
+    }
+    timeline.Initialize(device, copyQueue.Get());
+    stagingRing.Initialize(device, stagingCapacity);
+
+    AllocatorEntry entry{};
+    if (FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&entry.allocator)))) {
+        throw std::runtime_error("Failed to create copy command allocator");
+    }
+    if (FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, entry.allocator.Get(), nullptr, IID_PPV_ARGS(&commandList)))) {
+        throw std::runtime_error("Failed to create copy command list");
+    }
+    commandList->Close();
+    allocators.push_back(entry);
+}
+
+void D3D12Uploader::Shutdown()
+{
+    WaitForIdle();
+    timeline.Shutdown();
+}
+
+// ステージングリングに空きがない場合は、記録済みのコピーを投入して完了を待ってから再試行する。
+// 例外: size がリング容量を超える場合は std::runtime_error を送出
+void D3D12Uploader::UploadBuffer(ID3D12Resource* destination, uint64_t destinationOffset, const void* data, uint64_t size)
+{
+    if (size > stagingRing.GetCapacity()) {
+        throw std::runtime_error("Upload size exceeds staging ring capacity");
+    }
+
+    Retire();
+    UploadAllocation staging;
+    if (!stagingRing.Upload(data, size, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, staging)) {
+        Submit();
+        WaitForIdle();
+        Retire();
+        if (!stagingRing.Upload(data, size, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, staging)) {
+            throw std::runtime_error("Failed to allocate staging memory");
+        }
+    }
+
+    BeginRecording();
+    commandList->CopyBufferRegion(destination, destinationOffset, staging.resource, staging.offset, size);
+}
+
+// ステージングを使わないため、リングの空きは確認しない
+void D3D12Uploader::CopyBuffer(ID3D12Resource* destination, uint64_t destinationOffset, ID3D12Resource* source, uint64_t sourceOffset, uint64_t size)
+{
+    BeginRecording();
+    commandList->CopyBufferRegion(destination, destinationOffset, source, sourceOffset, size);
+}
+
+uint64_t D3D12Uploader::Submit()
+{
+    if (!recording) {
+        return lastSubmittedFenceValue;
+    }
+    commandList->Close();
+    ID3D12CommandList* lists[] = { commandList.Get() };
+    copyQueue->ExecuteCommandLists(_countof(lists), lists);
+
+    const uint64_t fenceValue = nextFenceValue++;
+    timeline.Signal(fenceValue);
+    allocators.back().fenceValue = fenceValue;
+    stagingRing.FinishFrame(fenceValue);
+    lastSubmittedFenceValue = fenceValue;
+    recording = false;
+    return fenceValue;
+}
+
+// CPU をブロックせず、GPU 上でキュー間の待機を挿入する
+void D3D12Uploader::WaitOnQueue(ID3D12CommandQueue* queue)
+{
+    if (lastSubmittedFenceValue != 0) {
+        queue->Wait(timeline.GetFence(), lastSubmittedFenceValue);
+    }
+}
+
+void D3D12Uploader::WaitForIdle()
+{
+    if (lastSubmittedFenceValue != 0) {
+        timeline.WaitForValue(lastSubmittedFenceValue);
+    }
+}
+
+// 完了済みのアロケータを再利用し、なければ新しく作成して記録を開始する。
+void D3D12Uploader::BeginRecording()
+{
+    if (recording) {
+        return;
+    }
+    const uint64_t completed = timeline.GetCompletedValue();
+    AllocatorEntry entry{};
+    if (allocators.front().fenceValue <= completed) {
+        entry = allocators.front();
+        allocators.erase(allocators.begin());
+    }
+    else if (FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&entry.allocator)))) {
+        throw std::runtime_error("Failed to create copy command allocator");
+    }
+    entry.allocator->Reset();
+    commandList->Reset(entry.allocator.Get(), nullptr);
+    entry.fenceValue = UINT64_MAX; // 投入するまでは再利用しない
+    allocators.push_back(entry);
+    recording = true;
+}
+
+void D3D12Uploader::Retire()
+{
+    stagingRing.Retire(timeline.GetCompletedValue());
+}
@@ -0,0 +1,55 @@
+﻿#pragma once
+
+#include <windows.h>
+#include <d3d12.h>
+#include <wrl/client.h>
+#include <vector>
+#include "D3D12GpuTimeline.h"
+#include "D3D12UploadRingBuffer.h"
+
+// コピーキューを使って DEFAULT ヒープのリソースへデータを転送する。
+// ステージングにはリングバッファを使い、コピーキューのフェンスが完了した領域から再利用する。
+// バッファは COMMON 状態で作成し、コピーキュー/描画キューでの暗黙の状態昇格に任せる。
+class D3D12Uploader {
+public:
+    // 例外: キューやリングの作成に失敗した場合は std::runtime_error を送出
+    void Initialize(ID3D12Device* d3dDevice, uint64_t stagingCapacity);
+    // GPU の完了を待ってからフェンスイベントを破棄する
+    void Shutdown();
+
+    // 既存の DEFAULT ヒープのバッファへのコピーを記録する
+    void UploadBuffer(ID3D12Resource* destination, uint64_t destinationOffset, const void* data, uint64_t size);
+    // DEFAULT ヒープのバッファ間のコピーを記録する（source は描画キューからは読むだけであること）
+    void CopyBuffer(ID3D12Resource* destination, uint64_t destinationOffset, ID3D12Resource* source, uint64_t sourceOffset, uint64_t size);
+
+    // 記録済みのコピーをコピーキューへ投入する。
+    // 戻り値: コピー完了時のフェンス値（記録がない場合は最後に投入したフェンス値）
+    uint64_t Submit();
+    // 未投入のコピーが記録されているか
+    bool HasPendingCopies() const { return recording; }
+    // queue のこれ以降のコマンドを、最後に投入したコピーの完了まで GPU 上で待機させる
+    void WaitOnQueue(ID3D12CommandQueue* queue);
+    // 投入済みのコピーが完了するまで CPU で待機する
+    void WaitForIdle();
+
+    ID3D12CommandQueue* GetCopyQueue() const { return copyQueue.Get(); }
+
+private:
+    struct AllocatorEntry {
+        Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator;
+        uint64_t fenceValue;
+    };
+
+    void BeginRecording();
+    void Retire();
+
+    ID3D12Device* device = nullptr;
+    Microsoft::WRL::ComPtr<ID3D12CommandQueue> copyQueue;
+    Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> commandList;
+    std::vector<AllocatorEntry> allocators; // 投入順。先頭から完了を確認して再利用する
+    D3D12GpuTimeline timeline;
+    D3D12UploadRingBuffer stagingRing;
+    uint64_t nextFenceValue = 1;
+    uint64_t lastSubmittedFenceValue = 0;
+    bool recording = false;
+};
@@ -0,0 +1,103 @@
+﻿#include "DescriptorAllocator.h"
+#include <algorithm>
+#include <stdexcept>
+
+// 小さいインデックスから払い出されるよう、逆順にスタックへ積んでおく
+void DescriptorFreeList::Initialize(uint32_t descriptorCount)
+{
+    freeIndices.resize(descriptorCount);
+    for (uint32_t i = 0; i < descriptorCount; ++i) {
+        freeIndices[i] = descriptorCount - 1 - i;
+    }
+    allocated.assign(descriptorCount, 0);
+    stats = {};
+    stats.capacity = descriptorCount;
+}
+
+uint32_t DescriptorFreeList::Allocate()
+{
+    if (freeIndices.empty()) {
+        ++stats.failedAllocationCount;
+        return INVALID_DESCRIPTOR_INDEX;
+    }
+    const uint32_t index = freeIndices.back();
+    freeIndices.pop_back();
+    allocated[index] = 1;
+    ++stats.used;
+    ++stats.allocationCount;
+    stats.peakUsed = std::max(stats.peakUsed, stats.used);
+    return index;
+}
+
+// 二重解放をそのまま積むと同じインデックスが 2 回払い出されるため、リリースビルドでも検出して例外にする
+void DescriptorFreeList::Free(uint32_t index)
+{
+    if (index >= stats.capacity || !allocated[index]) {
+        throw std::runtime_error("Descriptor freed twice or out of range");
+    }
+    allocated[index] = 0;
+    freeIndices.push_back(index);
+    --stats.used;
+}
+
+void DescriptorRing::Initialize(uint32_t descriptorCount)
+{
+    ring.Initialize(descriptorCount);
+    stats = {};
+    stats.capacity = descriptorCount;
+}
+
+uint32_t DescriptorRing::Allocate(uint32_t count)
+{
+    const uint64_t offset = ring.Allocate(count, 1);
+    if (offset == LinearRingAllocator::INVALID_OFFSET) {
+        ++stats.failedAllocationCount;
+        return INVALID_DESCRIPTOR_INDEX;
+    }
+    ++stats.allocationCount;
+    UpdateUsed();
+    return static_cast<uint32_t>(offset);
+}
+
+void DescriptorRing::FinishFrame(uint64_t fenceValue)
+{
+    ring.FinishFrame(fenceValue);
+}
+
+void DescriptorRing::Retire(uint64_t completedFenceValue)
+{
+    ring.Retire(completedFenceValue);
+    UpdateUsed();
+}
+
+void DescriptorRing::UpdateUsed()
+{
+    stats.used = static_cast<uint32_t>(ring.GetUsedSize());
+    stats.peakUsed = std::max(stats.peakUsed, stats.used);
+}
+
+void DescriptorCopyBatch::Initialize(uint32_t descriptorStride)
+{
+    stride = descriptorStride;
+    Clear();
+}
+
+void DescriptorCopyBatch::Add(uint64_t dest, uint64_t source)
+{
+    ++copyCount;
+    if (!ranges.empty()) {
+        DescriptorCopyRange& last = ranges.back();
+        const uint64_t length = static_cast<uint64_t>(last.count) * stride;
+        if (dest == last.dest + length && source == last.source + length) {
+            ++last.count;
+            return;
+        }
+    }
+    ranges.push_back({ dest, source, 1 });
+}
+
+void DescriptorCopyBatch::Clear()
+{
+    ranges.clear();
+    copyCount = 0;
+}
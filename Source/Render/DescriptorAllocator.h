@@ -0,0 +1,84 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "LinearRingAllocator.h"
+
+// ディスクリプタヒープ内のインデックスを管理するアロケータ群（デバイス非依存）。
+
+constexpr uint32_t INVALID_DESCRIPTOR_INDEX = UINT32_MAX;
+
+// ヒープの使用状況
+struct DescriptorHeapStats {
+    uint32_t capacity = 0;
+    uint32_t used = 0;
+    uint32_t peakUsed = 0;
+    uint64_t allocationCount = 0;
+    uint64_t failedAllocationCount = 0;
+};
+
+// 個別に確保/解放するディスクリプタ用のフリーリスト。Allocate/Free とも O(1)。
+class DescriptorFreeList {
+public:
+    void Initialize(uint32_t descriptorCount);
+
+    // 戻り値: 空きがない場合は INVALID_DESCRIPTOR_INDEX
+    uint32_t Allocate();
+    // 例外: 範囲外または解放済みのインデックスを渡した場合は std::runtime_error を送出
+    void Free(uint32_t index);
+
+    const DescriptorHeapStats& GetStats() const { return stats; }
+
+private:
+    std::vector<uint32_t> freeIndices; // 末尾から取り出すスタック
+    std::vector<uint8_t> allocated; // 二重解放の検出用
+    DescriptorHeapStats stats;
+};
+
+// フレーム単位で使い捨てるディスクリプタテーブル用のリング。
+// テーブルは連続した範囲で確保し、フレームのフェンス値が完了したら再利用する。
+class DescriptorRing {
+public:
+    void Initialize(uint32_t descriptorCount);
+
+    // count 個の連続したディスクリプタを確保する
+    // 戻り値: 先頭インデックス。空きがない場合は INVALID_DESCRIPTOR_INDEX
+    uint32_t Allocate(uint32_t count);
+
+    void FinishFrame(uint64_t fenceValue);
+    void Retire(uint64_t completedFenceValue);
+
+    const DescriptorHeapStats& GetStats() const { return stats; }
+
+private:
+    void UpdateUsed();
+
+    LinearRingAllocator ring;
+    DescriptorHeapStats stats;
+};
+
+// コピー先とコピー元の両方が連続するディスクリプタのコピーを 1 範囲にまとめる（CopyDescriptors の引数を組み立てる）。
+// アドレスは CPU ディスクリプタハンドルの値、stride はディスクリプタ 1 個分のバイト数。
+struct DescriptorCopyRange {
+    uint64_t dest = 0;
+    uint64_t source = 0;
+    uint32_t count = 0;
+};
+
+class DescriptorCopyBatch {
+public:
+    void Initialize(uint32_t descriptorStride);
+
+    // 1 ディスクリプタのコピーを追加する。直前の範囲に隣接していればその範囲を伸ばす
+    void Add(uint64_t dest, uint64_t source);
+    void Clear();
+
+    const std::vector<DescriptorCopyRange>& GetRanges() const { return ranges; }
+    // 追加したコピーの数（まとめる前のディスクリプタ数）
+    uint32_t GetCopyCount() const { return copyCount; }
+
+private:
+    uint32_t stride = 0;
+    std::vector<DescriptorCopyRange> ranges;
+    uint32_t copyCount = 0;
+};
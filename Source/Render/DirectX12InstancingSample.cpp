@@ -0,0 +1,64 @@
+﻿#include "DirectX12InstancingSample.h"
+#include "DirectXMain.h" // D3D12Context の完全定義が必要
+#include "BuiltinPipelineStates.h"
+#include "D3D12PipelineState.h"
+#include "D3D12ShaderCompiler.h"
+#include "../Core/JobSystem.h"
+#include <stdexcept>
+#include <vector>
+
+// 小さなメッシュを多数インスタンス描画するパイプラインを初期化する。
+// 引数:
+//  - ctx: 共有コンテキスト（ルートシグネチャは三角形サンプルのものを共用し、
+//         BuiltinPipeline::Instanced として登録）
+// 例外:
+//  - シェーダコンパイルや D3D12 オブジェクト生成に失敗した場合は std::runtime_error を送出
+void InitializeInstancingSample(D3D12Context& ctx)
+{
+    // スロット 1 の PER_INSTANCE データ（InstanceGpuData）で回転/拡大/平行移動と色を適用する
+    const char* vsSrc = R"(
+        struct VSInput {
+            float2 pos : POSITION;
+            float2 instancePos : INSTANCE_POSITION;
+            float instanceRotation : INSTANCE_ROTATION;
+            float instanceScale : INSTANCE_SCALE;
+            float4 instanceColor : INSTANCE_COLOR;
+        };
+        struct PSInput { float4 pos : SV_Position; float4 col : COLOR; };
+        PSInput main(VSInput input) {
+            float s, c;
+            sincos(input.instanceRotation, s, c);
+            float2 p = float2(input.pos.x * c - input.pos.y * s, input.pos.x * s + input.pos.y * c);
+            PSInput o;
+            o.pos = float4(p * input.instanceScale + input.instancePos, 0.0f, 1.0f);
+            o.col = input.instanceColor;
+            return o;
+        }
+    )";
+    const char* psSrc = R"(
+        struct PSInput { float4 pos : SV_Position; float4 col : COLOR; };
+        float4 main(PSInput input) : SV_Target {
+            return input.col;
+        }
+    )";
+    std::vector<ShaderCompileRequest> shaderRequests(2);
+    shaderRequests[0] = { "InstancedVS", vsSrc, {}, "main", "vs_5_0", 0 };
+    shaderRequests[1] = { "InstancedPS", psSrc, {}, "main", "ps_5_0", 0 };
+    const std::vector<ShaderBytecode> shaders = ctx.shaderCache.GetOrCompileAll(shaderRequests, CompileShaderD3D, GetJobSystem());
+    const ShaderBytecode& vsCode = shaders[0];
+    const ShaderBytecode& psCode = shaders[1];
+
+    // スロット 0 はメッシュの頂点、スロット 1 はインスタンスごとのデータ（1 インスタンスごとに進める）。
+    // 不透明、カリングなし（回転しても表裏が変わらない 2D スプライトのため）
+    static constexpr auto inputLayout = MakeD3D12InputLayout<InstancedLayout>();
+
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc{};
+    psoDesc.pRootSignature = ctx.rootSignature.Get();
+    psoDesc.VS = { vsCode.data(), vsCode.size() };
+    psoDesc.PS = { psCode.data(), psCode.size() };
+    psoDesc.InputLayout = { inputLayout.data(), static_cast<UINT>(inputLayout.size()) };
+    ApplyPipelineState(INSTANCED_PIPELINE_STATE.desc, psoDesc);
+    const uint64_t pipelineKey = ComputeGraphicsPipelineKey(INSTANCED_PIPELINE_STATE, psoDesc, ctx.rootSignatureHash);
+    ctx.instancedPipelineState = ctx.pipelineLibrary.GetOrCreateGraphicsPipeline(pipelineKey, psoDesc);
+    ctx.builtinPipelines[static_cast<size_t>(BuiltinPipeline::Instanced)] = ctx.registry.RegisterPipeline(ctx.instancedPipelineState.Get(), ctx.rootSignature.Get(), pipelineKey);
+}
@@ -0,0 +1,7 @@
+﻿#pragma once
+
+struct D3D12Context; // forward declaration
+
+// Initializes instanced sample pipeline (PSO) as BuiltinPipeline::Instanced.
+// Requires InitializeTrianglePipeline to have created the shared root signature.
+void InitializeInstancingSample(D3D12Context& ctx);
@@ -2,5 +2,5 @@
 
 struct D3D12Context; // forward declaration
 
-// Initializes triangle sample pipeline (root signature, PSO, vertex buffer)
+// Initializes triangle sample pipeline (root signature, PSO) as BuiltinPipeline::VertexColor
 void InitializeTrianglePipeline(D3D12Context& ctx);
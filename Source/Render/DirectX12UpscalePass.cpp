@@ -0,0 +1,89 @@
+﻿#include "DirectX12UpscalePass.h"
+#include "DirectXMain.h" // D3D12Context の完全定義が必要
+#include "BuiltinPipelineStates.h"
+#include "D3D12PipelineState.h"
+#include "D3D12ShaderCompiler.h"
+#include "../Core/Hash.h"
+#include "../Core/JobSystem.h"
+#include <stdexcept>
+#include <vector>
+
+// 中間レンダーターゲットをバックバッファへ拡大するパイプラインを初期化する。
+// 頂点バッファは使わず、SV_VertexID から画面全体を覆う 1 つの三角形を生成する。
+// 引数:
+//  - ctx: 共有コンテキスト（専用のルートシグネチャと PSO を格納し、BuiltinPipeline::Upscale として登録）
+// 例外:
+//  - シェーダコンパイルや D3D12 オブジェクト生成に失敗した場合は std::runtime_error を送出
+void InitializeUpscalePipeline(D3D12Context& ctx)
+{
+    // ルート引数 0: SRV 1 つのディスクリプタテーブル、s0: バイリニア/クランプの静的サンプラ
+    D3D12_DESCRIPTOR_RANGE srvRange{};
+    srvRange.RangeType = D3D12_DESCRIPTOR_RANGE_TYPE_SRV;
+    srvRange.NumDescriptors = 1;
+    srvRange.BaseShaderRegister = 0;
+    srvRange.OffsetInDescriptorsFromTableStart = 0;
+
+    D3D12_ROOT_PARAMETER rootParameter{};
+    rootParameter.ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
+    rootParameter.DescriptorTable.NumDescriptorRanges = 1;
+    rootParameter.DescriptorTable.pDescriptorRanges = &srvRange;
+    rootParameter.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+
+    D3D12_STATIC_SAMPLER_DESC sampler{};
+    sampler.Filter = D3D12_FILTER_MIN_MAG_MIP_LINEAR;
+    sampler.AddressU = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler.AddressV = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler.AddressW = D3D12_TEXTURE_ADDRESS_MODE_CLAMP;
+    sampler.MaxLOD = D3D12_FLOAT32_MAX;
+    sampler.ShaderRegister = 0;
+    sampler.ShaderVisibility = D3D12_SHADER_VISIBILITY_PIXEL;
+
+    D3D12_ROOT_SIGNATURE_DESC rsDesc{};
+    rsDesc.NumParameters = 1;
+    rsDesc.pParameters = &rootParameter;
+    rsDesc.NumStaticSamplers = 1;
+    rsDesc.pStaticSamplers = &sampler;
+    Microsoft::WRL::ComPtr<ID3DBlob> serializedRS;
+    Microsoft::WRL::ComPtr<ID3DBlob> errorRS;
+    if (FAILED(D3D12SerializeRootSignature(&rsDesc, D3D_ROOT_SIGNATURE_VERSION_1, &serializedRS, &errorRS))) {
+        throw std::runtime_error("拡大用ルートシグネチャのシリアライズに失敗");
+    }
+    if (FAILED(ctx.device->CreateRootSignature(0, serializedRS->GetBufferPointer(), serializedRS->GetBufferSize(), IID_PPV_ARGS(&ctx.upscaleRootSignature)))) {
+        throw std::runtime_error("拡大用ルートシグネチャの作成に失敗");
+    }
+
+    // 頂点 0/1/2 を (-1, 1)、(3, 1)、(-1, -3) に置き、UV は (0, 0) ～ (2, 2) にする
+    const char* vsSrc = R"(
+        struct PSInput { float4 pos : SV_Position; float2 uv : TEXCOORD; };
+        PSInput main(uint id : SV_VertexID) {
+            PSInput o;
+            o.uv = float2((id << 1) & 2, id & 2);
+            o.pos = float4(o.uv * float2(2.0f, -2.0f) + float2(-1.0f, 1.0f), 0.0f, 1.0f);
+            return o;
+        }
+    )";
+    const char* psSrc = R"(
+        Texture2D source : register(t0);
+        SamplerState bilinear : register(s0);
+        struct PSInput { float4 pos : SV_Position; float2 uv : TEXCOORD; };
+        float4 main(PSInput input) : SV_Target {
+            return source.Sample(bilinear, input.uv);
+        }
+    )";
+    std::vector<ShaderCompileRequest> shaderRequests(2);
+    shaderRequests[0] = { "UpscaleVS", vsSrc, {}, "main", "vs_5_0", 0 };
+    shaderRequests[1] = { "UpscalePS", psSrc, {}, "main", "ps_5_0", 0 };
+    const std::vector<ShaderBytecode> shaders = ctx.shaderCache.GetOrCompileAll(shaderRequests, CompileShaderD3D, GetJobSystem());
+    const ShaderBytecode& vsCode = shaders[0];
+    const ShaderBytecode& psCode = shaders[1];
+
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc{};
+    psoDesc.pRootSignature = ctx.upscaleRootSignature.Get();
+    psoDesc.VS = { vsCode.data(), vsCode.size() };
+    psoDesc.PS = { psCode.data(), psCode.size() };
+    ApplyPipelineState(UPSCALE_PIPELINE_STATE.desc, psoDesc);
+    const uint64_t rootSignatureHash = HashBytes(serializedRS->GetBufferPointer(), serializedRS->GetBufferSize());
+    const uint64_t pipelineKey = ComputeGraphicsPipelineKey(UPSCALE_PIPELINE_STATE, psoDesc, rootSignatureHash);
+    ctx.upscalePipelineState = ctx.pipelineLibrary.GetOrCreateGraphicsPipeline(pipelineKey, psoDesc);
+    ctx.builtinPipelines[static_cast<size_t>(BuiltinPipeline::Upscale)] = ctx.registry.RegisterPipeline(ctx.upscalePipelineState.Get(), ctx.upscaleRootSignature.Get(), pipelineKey);
+}
@@ -0,0 +1,7 @@
+﻿#pragma once
+
+struct D3D12Context; // forward declaration
+
+// Initializes the full-screen upscale pipeline (PSO and its own root signature) as BuiltinPipeline::Upscale.
+// Root parameter 0 is a descriptor table with one SRV (t0); s0 is a static bilinear clamp sampler.
+void InitializeUpscalePipeline(D3D12Context& ctx);
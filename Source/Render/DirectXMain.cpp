@@ -1,5 +1,10 @@
 ﻿#include "DirectXMain.h"
+#include "DirectX12InstancingSample.h"
 #include "DirectX12TriangleSample.h"
+#include "DirectX12UpscalePass.h"
+#include "D3D12ShaderCompiler.h"
+#include "../Core/JobSystem.h"
+#include "../Core/Profiler.h"
 #include <d3dcompiler.h>
 #include <stdexcept>
 
@@ -8,9 +13,11 @@
 #pragma comment(lib, "d3dcompiler.lib")
 
 // DirectX 12 の初期化を行い、スワップチェーン/RTV/コマンドリスト等を構築する。
-// パラメータ: hwnd=ターゲットウィンドウ、width/height=バックバッファサイズ
+// パラメータ: hwnd=ターゲットウィンドウ、width/height=バックバッファサイズ、
+//            framesInFlight=GPU に先行投入するフレーム数（1 ～ MAX_FRAMES_IN_FLIGHT）、
+//            presentMode=表示方式（Uncapped でティアリング非対応の場合は垂直同期なしの通常の Present）
 // 例外: 初期化に失敗した場合は std::runtime_error を送出
-void InitD3D12(HWND hwnd, UINT width, UINT height)
+void InitD3D12(HWND hwnd, UINT width, UINT height, UINT framesInFlight, PresentMode presentMode)
 {
     auto& ctx = GetD3D12Context();
     UINT dxgiFactoryFlags = 0;
@@ -45,6 +52,19 @@ void InitD3D12(HWND hwnd, UINT width, UINT height)
     if (FAILED(ctx.device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&ctx.commandQueue)))) {
         throw std::runtime_error("Failed to create command queue");
     }
+    D3D12_COMMAND_QUEUE_DESC computeQueueDesc{};
+    computeQueueDesc.Type = D3D12_COMMAND_LIST_TYPE_COMPUTE;
+    if (FAILED(ctx.device->CreateCommandQueue(&computeQueueDesc, IID_PPV_ARGS(&ctx.computeQueue)))) {
+        throw std::runtime_error("Failed to create compute queue");
+    }
+
+    // 可変リフレッシュレートのディスプレイでティアリングを許可できるか
+    ctx.presentMode = presentMode;
+    Microsoft::WRL::ComPtr<IDXGIFactory5> factory5;
+    if (SUCCEEDED(factory.As(&factory5))) {
+        BOOL allowTearing = FALSE;
+        ctx.tearingSupported = SUCCEEDED(factory5->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allowTearing, sizeof(allowTearing))) && allowTearing;
+    }
 
     DXGI_SWAP_CHAIN_DESC1 swapChainDesc{};
     swapChainDesc.BufferCount = FRAME_COUNT;
@@ -54,6 +74,13 @@ void InitD3D12(HWND hwnd, UINT width, UINT height)
     swapChainDesc.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
     swapChainDesc.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
     swapChainDesc.SampleDesc.Count = 1;
+    if (presentMode == PresentMode::LowLatency) {
+        swapChainDesc.Flags |= DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+    }
+    if (presentMode == PresentMode::Uncapped && ctx.tearingSupported) {
+        swapChainDesc.Flags |= DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+    }
+    ctx.swapChainFlags = swapChainDesc.Flags;
 
     Microsoft::WRL::ComPtr<IDXGISwapChain1> swapChain;
     if (FAILED(factory->CreateSwapChainForHwnd(ctx.commandQueue.Get(), hwnd, &swapChainDesc, nullptr, nullptr, &swapChain))) {
@@ -65,152 +92,220 @@ void InitD3D12(HWND hwnd, UINT width, UINT height)
     swapChain.As(&ctx.swapChain);
     ctx.frameIndex = ctx.swapChain->GetCurrentBackBufferIndex();
 
-    D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc{};
-    rtvHeapDesc.NumDescriptors = FRAME_COUNT;
-    rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
-    if (FAILED(ctx.device->CreateDescriptorHeap(&rtvHeapDesc, IID_PPV_ARGS(&ctx.rtvHeap)))) {
-        throw std::runtime_error("Failed to create RTV heap");
+    // 低遅延モードでは表示待ちのフレームを 1 つに制限し、その空きを待機可能オブジェクトで待つ
+    if (presentMode == PresentMode::LowLatency) {
+        if (FAILED(ctx.swapChain->SetMaximumFrameLatency(1))) {
+            throw std::runtime_error("Failed to set maximum frame latency");
+        }
+        ctx.frameLatencyWaitable = ctx.swapChain->GetFrameLatencyWaitableObject();
     }
-    ctx.rtvDescriptorSize = ctx.device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
 
-    D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle(ctx.rtvHeap->GetCPUDescriptorHandleForHeapStart());
+    // ペーシングの基準はプライマリディスプレイのリフレッシュレート（取得できなければ 60Hz）
+    FramePacingSettings pacingSettings;
+    DEVMODEW displayMode{};
+    displayMode.dmSize = sizeof(displayMode);
+    if (EnumDisplaySettingsW(nullptr, ENUM_CURRENT_SETTINGS, &displayMode) && displayMode.dmDisplayFrequency > 1) {
+        pacingSettings.refreshIntervalMs = 1000.0 / displayMode.dmDisplayFrequency;
+    }
+    ctx.pacing.Initialize(pacingSettings);
+
+    // ビュー作成用の CPU 専用ヒープと、ディスクリプタテーブル用のシェーダ可視ヒープを作成
+    ctx.rtvHeap.Initialize(ctx.device.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_RTV, RTV_DESCRIPTOR_CAPACITY);
+    ctx.dsvHeap.Initialize(ctx.device.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_DSV, DSV_DESCRIPTOR_CAPACITY);
+    ctx.resourceViewHeap.Initialize(ctx.device.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, RESOURCE_VIEW_DESCRIPTOR_CAPACITY);
+    ctx.shaderVisibleHeap.Initialize(ctx.device.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, SHADER_VISIBLE_DESCRIPTOR_CAPACITY);
+    ctx.transientPool.Initialize(ctx.device.Get(), &ctx.registry, &ctx.rtvHeap, &ctx.resourceViewHeap, &ctx.shaderVisibleHeap);
+
     for (UINT i = 0; i < FRAME_COUNT; ++i) {
         if (FAILED(ctx.swapChain->GetBuffer(i, IID_PPV_ARGS(&ctx.renderTargets[i])))) {
             throw std::runtime_error("Failed to get back buffer");
         }
-        ctx.device->CreateRenderTargetView(ctx.renderTargets[i].Get(), nullptr, rtvHandle);
-        rtvHandle.ptr += ctx.rtvDescriptorSize;
-    }
-    if (FAILED(ctx.device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&ctx.commandAllocator)))) {
-        throw std::runtime_error("Failed to create command allocator");
-    }
-    if (FAILED(ctx.device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, ctx.commandAllocator.Get(), nullptr, IID_PPV_ARGS(&ctx.commandList)))) {
-        throw std::runtime_error("Failed to create command list");
-    }
-    ctx.commandList->Close();
-    if (FAILED(ctx.device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&ctx.fence)))) {
-        throw std::runtime_error("Failed to create fence");
+        ctx.backBufferRtvs[i] = ctx.rtvHeap.Allocate();
+        if (!ctx.backBufferRtvs[i].IsValid()) {
+            throw std::runtime_error("Failed to allocate RTV descriptor");
+        }
+        ctx.device->CreateRenderTargetView(ctx.renderTargets[i].Get(), nullptr, ctx.backBufferRtvs[i].cpu);
+        ctx.backBufferIds[i] = ctx.registry.RegisterResource(ctx.renderTargets[i].Get());
+        ctx.backBufferRtvIds[i] = ctx.registry.RegisterRenderTarget(ctx.backBufferRtvs[i].cpu);
     }
-    ctx.fenceValue = 1;
-    ctx.fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
-    if (!ctx.fenceEvent) {
-        throw std::runtime_error("Failed to create fence event");
+
+    // フェンスとフレームスケジューラを準備し、スロット数分のアロケータを持つコマンドリストを作成
+    ctx.gpuTimeline.Initialize(ctx.device.Get(), ctx.commandQueue.Get());
+    ctx.frameScheduler.Initialize(&ctx.gpuTimeline, framesInFlight);
+    const UINT slotCount = ctx.frameScheduler.GetFramesInFlight();
+    ctx.gpuProfiler.Initialize(ctx.device.Get(), ctx.commandQueue.Get(), slotCount);
+    ctx.graphicsGpuQueue.Initialize(ctx.device.Get(), ctx.commandQueue.Get());
+    ctx.computeGpuQueue.Initialize(ctx.device.Get(), ctx.computeQueue.Get());
+    ctx.queueScheduler.Initialize();
+    ctx.queueScheduler.SetQueue(GpuQueueType::Graphics, &ctx.graphicsGpuQueue);
+    ctx.queueScheduler.SetQueue(GpuQueueType::Compute, &ctx.computeGpuQueue);
+    ctx.frameBeginCommandList.Initialize(ctx.device.Get(), slotCount, &ctx.registry);
+    ctx.frameEndCommandList.Initialize(ctx.device.Get(), slotCount, &ctx.registry);
+    // レンダーグラフのパス（拡大パスなど）は前後のリストにも記録されるため、同じヒープを設定する
+    ctx.frameBeginCommandList.SetDescriptorHeap(ctx.shaderVisibleHeap.GetHeap());
+    ctx.frameEndCommandList.SetDescriptorHeap(ctx.shaderVisibleHeap.GetHeap());
+    std::vector<ICommandList*> recordingLists;
+    for (D3D12CommandList& commandList : ctx.recordingCommandLists) {
+        commandList.Initialize(ctx.device.Get(), slotCount, &ctx.registry);
+        commandList.SetDescriptorHeap(ctx.shaderVisibleHeap.GetHeap());
+        recordingLists.push_back(&commandList);
     }
+    ctx.commandRecorder.Initialize(&GetJobSystem(), std::move(recordingLists));
+    ctx.backend.Initialize(&ctx);
+    ctx.renderer.Initialize(&ctx.backend, &GetJobSystem());
+
+    // カーソル位置はメッセージではなく OS の現在値を投入直前に読み取る
+    ctx.renderer.SetInputLatch([hwnd](LatchedInput& input) {
+        POINT cursor;
+        RECT client;
+        if (!GetCursorPos(&cursor) || !ScreenToClient(hwnd, &cursor) || !GetClientRect(hwnd, &client) ||
+            client.right <= 0 || client.bottom <= 0) {
+            return false;
+        }
+        input.cursorX = 2.0f * static_cast<float>(cursor.x) / static_cast<float>(client.right) - 1.0f;
+        input.cursorY = 1.0f - 2.0f * static_cast<float>(cursor.y) / static_cast<float>(client.bottom);
+        return true;
+    });
+
+    // アップロード経路を準備し、初期リソースの転送を描画キューより先に完了させる
+    ctx.uploader.Initialize(ctx.device.Get(), UPLOAD_STAGING_CAPACITY);
+    ctx.gpuMemory.Initialize(ctx.device.Get(), hardwareAdapter.Get(), &ctx.uploader);
+    ctx.frameUploadRing.Initialize(ctx.device.Get(), FRAME_UPLOAD_CAPACITY);
 
+    // 前回起動時のシェーダ/PSO キャッシュを読み込み、新しく作成したものだけを書き戻す
+    ctx.shaderCache.Initialize(SHADER_CACHE_DIRECTORY, GetD3DCompilerId());
+    ctx.pipelineLibrary.Initialize(ctx.device.Get(), PIPELINE_LIBRARY_PATH);
+
+    // シーンが使用する組み込みパイプラインを作成
     InitializeTrianglePipeline(ctx);
+    InitializeInstancingSample(ctx);
+    InitializeUpscalePipeline(ctx);
+    ctx.particleSimulator.Create(ctx);
+
+    ctx.pipelineLibrary.Save();
+    ctx.uploader.Submit();
+    ctx.uploader.WaitOnQueue(ctx.commandQueue.Get());
 }
 
-// D3D12 リソースの後始末（フェンスイベントのクローズ）。
-void CleanupD3D12()
+// シーンを作成して描画アイテム/インスタンスバッチを登録し、シミュレーションスレッドを開始する。
+// シーンが作成した頂点バッファは最初のフレームの投入時に転送される。
+// 例外: 未登録のシーン名を指定した場合は std::runtime_error を送出
+void LoadScene(const std::string& sceneName)
 {
     auto& ctx = GetD3D12Context();
-    if (ctx.fenceEvent) {
-        CloseHandle(ctx.fenceEvent);
-        ctx.fenceEvent = nullptr;
+    ctx.simulation.Stop();
+    ctx.scene = GetSceneRegistry().Create(sceneName);
+    if (!ctx.scene) {
+        throw std::runtime_error("Unknown scene: " + sceneName);
     }
+    ctx.scene->Initialize(ctx.renderer);
+    ctx.simulation.Initialize(ctx.scene.get(), &ctx.renderer, &Profiler::Now);
+    ctx.simulation.Start();
 }
 
-// 毎フレームのゲームロジック更新（入力/物理/AI など）を行う。
-// 現状はプレースホルダとして空実装。
-void Update()
+// D3D12 リソースの後始末（フェンスイベントのクローズ）。
+// 呼び出し前に WaitForGpuIdle で GPU の完了を待っておくこと。
+void CleanupD3D12()
 {
+    auto& ctx = GetD3D12Context();
+    ctx.simulation.Stop();
+    ctx.uploader.Shutdown();
+    ctx.gpuMemory.Shutdown();
+    ctx.gpuTimeline.Shutdown();
+    ctx.graphicsGpuQueue.Shutdown();
+    ctx.computeGpuQueue.Shutdown();
+    if (ctx.frameLatencyWaitable) {
+        CloseHandle(ctx.frameLatencyWaitable);
+        ctx.frameLatencyWaitable = nullptr;
+    }
 }
 
-// 三角形描画フレームの発行処理。
-// コマンド記録、リソース遷移、RTV クリア、描画、Present、フェンス待機までを行う。
+// 1 フレームを記録して投入し、表示する。
+// 記録と投入の手順はバックエンドに依存しない FrameRenderer が行い、
+// D3D12 固有の処理（フェンス待ち、アップロード、Present）は D3D12RenderBackend が担当する。
+// ゲームロジックの更新はシミュレーションスレッドが固定刻みで行い、ここでは公開済みの状態を補間して描画するだけ。
+// 低遅延モードでは、表示キューの空きを待った後、予測した CPU/GPU 時間が次の垂直同期に間に合う範囲で
+// フレームの開始を遅らせ、補間の時刻と入力をできるだけ表示に近い時点で読み取る。
 void Render()
 {
     auto& ctx = GetD3D12Context();
-    // コマンドアロケータ/リストをリセットして記録準備
-    ctx.commandAllocator->Reset();
-    ctx.commandList->Reset(ctx.commandAllocator.Get(), ctx.pipelineState.Get());
-
-    // バックバッファサイズを取得してビューポート/シザーを設定
-    D3D12_RESOURCE_DESC backBufferDesc = ctx.renderTargets[ctx.frameIndex]->GetDesc();
-    D3D12_VIEWPORT viewport{ 0.0f, 0.0f, static_cast<float>(backBufferDesc.Width), static_cast<float>(backBufferDesc.Height), 0.0f, 1.0f };
-    ctx.commandList->RSSetViewports(1, &viewport);
-    RECT scissor{ 0, 0, (LONG)backBufferDesc.Width, (LONG)backBufferDesc.Height };
-    ctx.commandList->RSSetScissorRects(1, &scissor);
-
-    // バックバッファを PRESENT -> RENDER_TARGET に遷移
-    D3D12_RESOURCE_BARRIER barrier{};                                         // リソースの状態遷移を定義する構造体。
-    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;                    // バリアの種類を「状態遷移」に設定。
-    barrier.Transition.pResource = ctx.renderTargets[ctx.frameIndex].Get();   // 遷移対象のリソース（現在のバックバッファ）を指定。
-    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PRESENT;            // 現在の状態は「表示中 (PRESENT)」。
-    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;       // 次に使う状態は「レンダーターゲット (描画先)」。
-    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES; // 全サブリソースを対象に遷移を行う。
-    ctx.commandList->ResourceBarrier(1, &barrier);                            // コマンドリストにバリアを記録。
-
-    // 現フレームの RTV を設定しクリアカラーで初期化
-    D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle(ctx.rtvHeap->GetCPUDescriptorHandleForHeapStart());
-    rtvHandle.ptr += (SIZE_T)ctx.frameIndex * ctx.rtvDescriptorSize;
-    ctx.commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
-    const float clearColor[] = { 0.39f, 0.58f, 0.93f, 1.0f };
-    ctx.commandList->ClearRenderTargetView(rtvHandle, clearColor, 0, nullptr);
-
-    // ルートシグネチャ/IA 設定して三角形を描画
-    ctx.commandList->SetGraphicsRootSignature(ctx.rootSignature.Get());
-    ctx.commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    ctx.commandList->IASetVertexBuffers(0, 1, &ctx.vertexBufferView);
-    ctx.commandList->DrawInstanced(3, 1, 0, 0);
-
-    // バックバッファを RENDER_TARGET -> PRESENT に遷移
-    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
-    barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PRESENT;
-    ctx.commandList->ResourceBarrier(1, &barrier);
-
-    // コマンドを閉じてキューへ投入、 Present 実行、フレーム完了待機
-    ctx.commandList->Close();
-
-    // GPUに対して「記録済みのコマンドリストを実行せよ」と指示する
-    {
-        ID3D12CommandList* lists[] = { ctx.commandList.Get() };
-        ctx.commandQueue->ExecuteCommandLists(_countof(lists), lists);
-    }
-
-    // 「描画結果を画面に出す」ための最終ステップで、垂直同期を有効にしてスワップする
-    //
-    // バックバッファをフロントバッファに切り替えて、画面に描画結果を表示する
-    // 第1引数：SyncInterval
-    //    0 → 垂直同期なし（即時表示、ティアリングが発生する可能性あり）
-    //    1 → 垂直同期あり（1フレーム分待つ、通常はこれ）
-    //    2 → 2フレーム分待つ（低FPS向け）
-    // 第2引数：Flags
-    //    通常は 0（特別なオプションなし） DXGI_PRESENT_DO_NOT_WAIT などを指定すると、非同期表示を試みる
-    {
-        ctx.swapChain->Present(1, 0);
-    }
-
-    // 直前フレームの完了を待機してからフレームインデックスを更新
-    WaitForPreviousFrame();
+    if (ctx.presentMode == PresentMode::LowLatency) {
+        PROFILE_SCOPE("WaitForFrameLatency");
+        WaitForSingleObjectEx(ctx.frameLatencyWaitable, FRAME_LATENCY_WAIT_TIMEOUT_MS, TRUE);
+        const double delayMs = ctx.pacing.GetFrameStartDelayMs();
+        SleepUntil(Profiler::Now() + static_cast<uint64_t>(delayMs * 1e6));
+    }
+
+    const uint64_t frameStartNs = Profiler::Now();
+    if (ctx.scene) {
+        ctx.scene->PrepareRender(ctx.renderer);
+    }
+    ctx.renderer.Render(ctx.simulation.GetRenderTimeNs());
+
+    // GPU 時間はフレームスロットが一周した時点の値（数フレーム遅れ）を予測に使う
+    FrameTimeSample sample;
+    sample.cpuMs = static_cast<double>(Profiler::Now() - frameStartNs) / 1e6;
+    sample.gpuMs = ctx.backend.GetLastGpuFrameTimeMs();
+    ctx.pacing.AddFrame(sample);
+    if (GetProfiler().IsCapturing() && ctx.frameTimeTrace.size() < MAX_FRAME_TIME_TRACE_LENGTH) {
+        ctx.frameTimeTrace.push_back(sample);
+    }
 }
 
-// 直前フレームの GPU 完了をフェンスで待機し、バックバッファのフレームインデックスを更新する。
-void WaitForPreviousFrame()
+// ウィンドウのサイズ変更に合わせてバックバッファを作り直す。
+// ResizeBuffers はバックバッファへの参照がすべて解放されている必要があるため、GPU の完了を待ってから解放する。
+// RTV のディスクリプタとレジストリの ID は作り直したバッファにそのまま割り当て直すので、記録側は変更不要。
+// 例外: バッファの作り直しに失敗した場合は std::runtime_error を送出
+void ResizeSwapChain(UINT width, UINT height)
 {
     auto& ctx = GetD3D12Context();
+    if (width == 0 || height == 0) {
+        return;
+    }
+    const D3D12_RESOURCE_DESC currentDesc = ctx.renderTargets[0]->GetDesc();
+    if (currentDesc.Width == width && currentDesc.Height == height) {
+        return;
+    }
 
-    // 現在発行したコマンド列の完了値（フェンス値）を記録する
-    // Signal は GPU 側でコマンドが到達したタイミングでフェンス値を設定するため、
-    // この値をもとに CPU が「どこまで終わったか」を判定できる
-    const UINT64 currentFenceValue = ctx.fenceValue;
-    ctx.commandQueue->Signal(ctx.fence.Get(), currentFenceValue);
-
-    // もし GPU の完了値が currentFenceValue に達していない場合は、イベントを使って待機
-    // SetEventOnCompletion は GPU 完了時に OS イベントをシグナルし、WaitForSingleObject でブロックする
-    if (ctx.fence->GetCompletedValue() < currentFenceValue) {
-        // GPUの処理が指定したフェンス値に達したときに、指定したイベントをシグナル状態にするための設定です。
-        // つまり、GPUの完了を待つためのイベント通知を登録する処理です。
-        ctx.fence->SetEventOnCompletion(currentFenceValue, ctx.fenceEvent);
-
-        // 指定したイベントがシグナル状態になるまで、無限に待機します。
-        WaitForSingleObject(ctx.fenceEvent, INFINITE);
+    WaitForGpuIdle();
+    for (UINT i = 0; i < FRAME_COUNT; ++i) {
+        ctx.renderTargets[i].Reset();
+        ctx.registry.UpdateResource(ctx.backBufferIds[i], nullptr);
+    }
+    if (FAILED(ctx.swapChain->ResizeBuffers(FRAME_COUNT, width, height, DXGI_FORMAT_R8G8B8A8_UNORM, ctx.swapChainFlags))) {
+        throw std::runtime_error("Failed to resize swap chain");
+    }
+    for (UINT i = 0; i < FRAME_COUNT; ++i) {
+        if (FAILED(ctx.swapChain->GetBuffer(i, IID_PPV_ARGS(&ctx.renderTargets[i])))) {
+            throw std::runtime_error("Failed to get back buffer");
+        }
+        ctx.device->CreateRenderTargetView(ctx.renderTargets[i].Get(), nullptr, ctx.backBufferRtvs[i].cpu);
+        ctx.registry.UpdateResource(ctx.backBufferIds[i], ctx.renderTargets[i].Get());
     }
+    ctx.frameIndex = ctx.swapChain->GetCurrentBackBufferIndex();
+}
 
-    // 次フレーム用にフェンス値をインクリメント（以降のフレームはこの新しい値をターゲットに待機する）
-    ++ctx.fenceValue;
+// 現フレームのフェンス値を Signal し、次に使用するバックバッファを取得する。
+void MoveToNextFrame()
+{
+    auto& ctx = GetD3D12Context();
+
+    // Signal は GPU 側でコマンドが到達したタイミングでフェンス値を設定するため、
+    // スロットに記録したこの値をもとに CPU が「どこまで終わったか」を判定できる
+    // このフレームで使用したアップロード領域/ディスクリプタテーブルも、同じフェンス値の完了後に再利用する
+    const UINT64 fenceValue = ctx.frameScheduler.EndFrame();
+    ctx.frameUploadRing.FinishFrame(fenceValue);
+    ctx.shaderVisibleHeap.FinishFrame(fenceValue);
 
     // スワップチェーンの現在のバックバッファインデックスを取得
     // これで次フレームが使用すべきバックバッファを特定できる（2重/3重バッファリング対応）
     ctx.frameIndex = ctx.swapChain->GetCurrentBackBufferIndex();
 }
+
+// 投入済みのすべてのフレームが GPU で完了するまで待機する。
+// 終了処理やリソースの再作成など、GPU が参照中のオブジェクトを解放する前に呼び出す。
+void WaitForGpuIdle()
+{
+    auto& ctx = GetD3D12Context();
+    ctx.frameScheduler.WaitForIdle();
+}
@@ -4,34 +4,113 @@
 #include <d3d12.h>
 #include <dxgi1_6.h>
 #include <wrl/client.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "D3D12CommandList.h"
+#include "D3D12DescriptorHeap.h"
+#include "D3D12GpuMemory.h"
+#include "D3D12GpuProfiler.h"
+#include "D3D12GpuQueue.h"
+#include "D3D12GpuTimeline.h"
+#include "D3D12ParticleSimulator.h"
+#include "D3D12PipelineLibrary.h"
+#include "D3D12RenderBackend.h"
+#include "D3D12TransientResourcePool.h"
+#include "D3D12UploadRingBuffer.h"
+#include "D3D12Uploader.h"
+#include "FramePacingController.h"
+#include "FrameRenderer.h"
+#include "FrameScheduler.h"
+#include "ParallelCommandRecorder.h"
+#include "QueueDependencyScheduler.h"
+#include "ShaderCache.h"
+#include "../Scene/SceneRegistry.h"
+#include "../Scene/SimulationThread.h"
 
 using Microsoft::WRL::ComPtr;
 
 constexpr UINT FRAME_COUNT = 2;
+// 並列記録に使用するコマンドリストの最大数
+constexpr UINT MAX_RECORDING_COMMAND_LISTS = 8;
+// コピーキュー経由のアップロードに使うステージング領域のサイズ
+constexpr UINT64 UPLOAD_STAGING_CAPACITY = 16ull * 1024 * 1024;
+// フレームごとの定数/動的頂点/インスタンスデータに使うアップロード領域のサイズ（フレームスロット全体で共有）
+constexpr UINT64 FRAME_UPLOAD_CAPACITY = 32ull * 1024 * 1024;
+// CPU 専用ディスクリプタヒープの容量
+constexpr UINT RTV_DESCRIPTOR_CAPACITY = 256;
+constexpr UINT DSV_DESCRIPTOR_CAPACITY = 64;
+constexpr UINT RESOURCE_VIEW_DESCRIPTOR_CAPACITY = 4096;
+// フレームごとのディスクリプタテーブルを切り出すシェーダ可視ヒープの容量
+constexpr UINT SHADER_VISIBLE_DESCRIPTOR_CAPACITY = 16384;
+// コンパイル済みシェーダ/PSO ライブラリの保存先（作業ディレクトリからの相対パス）
+constexpr const wchar_t* SHADER_CACHE_DIRECTORY = L"ShaderCache";
+constexpr const wchar_t* PIPELINE_LIBRARY_PATH = L"ShaderCache/Pipelines.bin";
+// プロファイルのキャプチャ中に記録するフレーム時間の最大数
+constexpr size_t MAX_FRAME_TIME_TRACE_LENGTH = 100000;
+// 低遅延モードで待機可能オブジェクトを待つ時間の上限（ミリ秒）
+constexpr DWORD FRAME_LATENCY_WAIT_TIMEOUT_MS = 1000;
 
 struct D3D12Context {
     ComPtr<ID3D12Device> device;
     ComPtr<ID3D12CommandQueue> commandQueue;
+    ComPtr<ID3D12CommandQueue> computeQueue; // 非同期コンピュート用
     ComPtr<IDXGISwapChain3> swapChain;
-    ComPtr<ID3D12DescriptorHeap> rtvHeap;
     ComPtr<ID3D12Resource> renderTargets[FRAME_COUNT];
-    ComPtr<ID3D12CommandAllocator> commandAllocator;
-    ComPtr<ID3D12GraphicsCommandList> commandList;
-    ComPtr<ID3D12Fence> fence;
-    UINT64 fenceValue = 0;
-    HANDLE fenceEvent = nullptr;
-    UINT rtvDescriptorSize = 0;
-    UINT frameIndex = 0;
+    D3D12ResourceRegistry registry;
+    D3D12GpuQueue graphicsGpuQueue; // commandQueue への投入（スケジューラ用のフェンスを持つ）
+    D3D12GpuQueue computeGpuQueue;  // computeQueue への投入
+    QueueDependencyScheduler queueScheduler; // キュー間の依存の解決
+    D3D12ParticleSimulator particleSimulator;
+    D3D12CommandList frameBeginCommandList; // バックバッファの遷移とクリア
+    D3D12CommandList frameEndCommandList;   // Present 用の遷移
+    D3D12CommandList recordingCommandLists[MAX_RECORDING_COMMAND_LISTS]; // 並列記録用
+    ParallelCommandRecorder commandRecorder;
+    D3D12Uploader uploader;                // DEFAULT ヒープへの転送（コピーキュー）
+    D3D12UploadRingBuffer frameUploadRing; // フレーム単位で解放される動的データ
+    D3D12GpuMemory gpuMemory;              // DEFAULT ヒープの配置リソース（ヒープのプールと常駐の予算）
+    D3D12StagingDescriptorHeap rtvHeap;
+    D3D12StagingDescriptorHeap dsvHeap;
+    D3D12StagingDescriptorHeap resourceViewHeap; // SRV/CBV/UAV
+    D3D12ShaderVisibleDescriptorRing shaderVisibleHeap;
+    D3D12TransientResourcePool transientPool; // レンダーグラフの一時テクスチャ（スロットごとのヒープ）
+    ShaderCache shaderCache;
+    D3D12PipelineLibrary pipelineLibrary;
+    D3D12GpuTimeline gpuTimeline;
+    FrameScheduler frameScheduler;
+    D3D12GpuProfiler gpuProfiler;
+    PresentMode presentMode = PresentMode::VSync;
+    HANDLE frameLatencyWaitable = nullptr; // PresentMode::LowLatency のときだけ有効
+    bool tearingSupported = false;
+    UINT swapChainFlags = 0; // ResizeBuffers で作成時と同じフラグを渡す
+    FramePacingController pacing;
+    std::vector<FrameTimeSample> frameTimeTrace; // プロファイルのキャプチャ中のフレーム時間
+    UINT frameIndex = 0; // 現在のバックバッファインデックス
+    UINT frameSlot = 0;  // 現在記録中のフレームスロット（0 ～ framesInFlight-1）
     ComPtr<ID3D12RootSignature> rootSignature;
+    uint64_t rootSignatureHash = 0; // PSO キャッシュのキーに使用するシリアライズ結果のハッシュ
     ComPtr<ID3D12PipelineState> pipelineState;
-    ComPtr<ID3D12Resource> vertexBuffer;
-    D3D12_VERTEX_BUFFER_VIEW vertexBufferView{};
+    ComPtr<ID3D12PipelineState> instancedPipelineState;
+    ComPtr<ID3D12RootSignature> upscaleRootSignature; // 動的解像度の拡大パス（テクスチャ 1 枚とサンプラ）
+    ComPtr<ID3D12PipelineState> upscalePipelineState;
+    PipelineId builtinPipelines[static_cast<size_t>(BuiltinPipeline::Count)] = {};
+    std::vector<GpuResourceHandle> staticBuffers; // シーンが CreateStaticBuffer で作成した頂点バッファ（gpuMemory の固定のバッファ）
+    DescriptorHandle backBufferRtvs[FRAME_COUNT];
+    ResourceId backBufferIds[FRAME_COUNT] = {};
+    RenderTargetId backBufferRtvIds[FRAME_COUNT] = {};
+    D3D12RenderBackend backend;
+    FrameRenderer renderer;
+    std::unique_ptr<IScene> scene;
+    SimulationThread simulation; // scene を固定刻みで更新する専用スレッド
 };
 
 inline D3D12Context& GetD3D12Context() { static D3D12Context ctx; return ctx; }
 
-void InitD3D12(HWND hwnd, UINT width, UINT height);
-void Update();
+void InitD3D12(HWND hwnd, UINT width, UINT height, UINT framesInFlight = DEFAULT_FRAMES_IN_FLIGHT, PresentMode presentMode = PresentMode::VSync);
+void LoadScene(const std::string& sceneName);
 void Render();
-void WaitForPreviousFrame();
+// スワップチェーンのバックバッファを width × height に作り直す（0 や現在と同じサイズの場合は何もしない）
+void ResizeSwapChain(UINT width, UINT height);
+void MoveToNextFrame();
+void WaitForGpuIdle();
 void CleanupD3D12();
@@ -0,0 +1,266 @@
+﻿#include "DynamicResolutionController.h"
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <random>
+#include <string>
+
+namespace {
+
+// 倍率の比較に使う許容誤差（刻みの浮動小数点誤差を吸収する）
+constexpr float SCALE_EPSILON = 1e-4f;
+// SyntheticLoad::Spikes で重いフレームを挟む間隔
+constexpr uint32_t SPIKE_INTERVAL = 60;
+// CheckSyntheticReplay: 負荷が変わってから倍率が落ち着くまでに許すフレーム数
+constexpr uint32_t SETTLE_LIMIT_FRAMES = 60;
+// CheckSyntheticReplay: 目標付近で揺らぐ負荷で許す向きの反転の回数（2 回 + この数のフレームごとに 1 回）
+constexpr uint32_t NOISY_FRAMES_PER_REVERSAL = 1000;
+
+} // namespace
+
+void DynamicResolutionController::Initialize(const DynamicResolutionSettings& settings)
+{
+    this->settings = settings;
+    Reset();
+}
+
+void DynamicResolutionController::Reset()
+{
+    scale = settings.maxScale;
+    smoothedMs = 0.0;
+    framesSinceChange = 0;
+    changeCount = 0;
+}
+
+// 倍率を変えた後、最初の settleFrames 個の計測値は捨て（投入済みのフレームは古い倍率で描画されている）、
+// 次の settleFrames 個で平均をならしてから判定を始める。
+// 下げるときは描画コストの見積もりどおりに一度に下げ、上げるときは 1 刻みずつ上げる。
+// 上げる判定には下げる判定より広い余裕を取り、境界付近の揺らぎで振動しないようにする。
+// 見積もりは解像度に依存しない処理を無視するため、下げ幅は不足（次の判定で追加で下げる）、
+// 上げ幅は控えめ（上げた直後に目標を超えにくい）な方向に外れる。
+void DynamicResolutionController::AddFrame(double gpuMs)
+{
+    if (gpuMs <= 0.0) {
+        return;
+    }
+    ++framesSinceChange;
+    if (framesSinceChange <= settings.settleFrames) {
+        return;
+    }
+    if (framesSinceChange == settings.settleFrames + 1) {
+        smoothedMs = gpuMs;
+    }
+    else {
+        smoothedMs += settings.smoothing * (gpuMs - smoothedMs);
+    }
+    if (framesSinceChange < settings.settleFrames * 2) {
+        return;
+    }
+
+    const double ratio = smoothedMs / (settings.targetFrameMs * settings.headroom);
+    if (std::fabs(ratio - 1.0) <= settings.tolerance) {
+        return;
+    }
+    float next = scale;
+    if (ratio > 1.0) {
+        next = Quantize(std::max(scale * static_cast<float>(std::sqrt(1.0 / ratio)), scale - settings.maxScaleDecrease));
+    }
+    else {
+        // 上げた後も不感帯の下端に収まる場合だけ上げる（揺らぎで上げ下げを繰り返さない）
+        next = Quantize(std::min(scale * static_cast<float>(std::sqrt((1.0 - settings.tolerance) / ratio)), scale + settings.scaleStep));
+    }
+    next = std::clamp(next, settings.minScale, settings.maxScale);
+    if (std::fabs(next - scale) < SCALE_EPSILON) {
+        return;
+    }
+    scale = next;
+    framesSinceChange = 0;
+    ++changeCount;
+}
+
+void DynamicResolutionController::GetScaledSize(uint32_t width, uint32_t height, uint32_t& scaledWidth, uint32_t& scaledHeight) const
+{
+    scaledWidth = std::max(static_cast<uint32_t>(static_cast<float>(width) * scale + 0.5f), 1u);
+    scaledHeight = std::max(static_cast<uint32_t>(static_cast<float>(height) * scale + 0.5f), 1u);
+}
+
+// scaleStep の倍数に切り捨てる
+float DynamicResolutionController::Quantize(float value) const
+{
+    if (settings.scaleStep <= 0.0f) {
+        return value;
+    }
+    return std::floor(value / settings.scaleStep + SCALE_EPSILON) * settings.scaleStep;
+}
+
+// 各フレームの倍率は latencyFrames より前に完了したフレームの計測値だけから決める
+ResolutionReplayResult ReplayDynamicResolution(const std::vector<double>& fullResolutionMs, const DynamicResolutionSettings& settings, const ResolutionReplayModel& model)
+{
+    DynamicResolutionController controller;
+    controller.Initialize(settings);
+    ResolutionReplayResult result;
+    result.frameCount = static_cast<uint32_t>(fullResolutionMs.size());
+    result.minScale = controller.GetScale();
+    std::deque<double> pending;
+    double totalScale = 0.0;
+    double totalMs = 0.0;
+    int lastDirection = 0;
+    for (uint32_t frame = 0; frame < result.frameCount; ++frame) {
+        const double pixelMs = std::max(fullResolutionMs[frame] - model.fixedMs, 0.0);
+        const double fixedMs = fullResolutionMs[frame] - pixelMs;
+        const float scale = controller.GetScale();
+        const double frameMs = fixedMs + pixelMs * scale * scale;
+        totalScale += scale;
+        totalMs += frameMs;
+        result.maxFrameMs = std::max(result.maxFrameMs, frameMs);
+        result.minScale = std::min(result.minScale, scale);
+        if (frameMs > settings.targetFrameMs) {
+            ++result.overBudgetFrames;
+            if (fixedMs + pixelMs * settings.minScale * settings.minScale > settings.targetFrameMs) {
+                ++result.unavoidableOverBudgetFrames;
+            }
+        }
+
+        pending.push_back(frameMs);
+        if (pending.size() > model.latencyFrames) {
+            controller.AddFrame(pending.front());
+            pending.pop_front();
+        }
+        const float nextScale = controller.GetScale();
+        if (nextScale != scale) {
+            const int direction = nextScale > scale ? 1 : -1;
+            if (lastDirection != 0 && direction != lastDirection) {
+                ++result.directionReversals;
+            }
+            lastDirection = direction;
+            ++result.scaleChanges;
+            result.lastChangeFrame = frame + 1;
+        }
+    }
+    if (result.frameCount > 0) {
+        result.averageScale = totalScale / result.frameCount;
+        result.averageFrameMs = totalMs / result.frameCount;
+    }
+    result.finalScale = controller.GetScale();
+    return result;
+}
+
+const char* GetSyntheticLoadName(SyntheticLoad load)
+{
+    switch (load) {
+    case SyntheticLoad::Constant:
+        return "constant";
+    case SyntheticLoad::Step:
+        return "step";
+    case SyntheticLoad::Ramp:
+        return "ramp";
+    case SyntheticLoad::Noisy:
+        return "noisy";
+    case SyntheticLoad::Spikes:
+        return "spikes";
+    case SyntheticLoad::Count:
+        break;
+    }
+    return "unknown";
+}
+
+bool ParseSyntheticLoad(std::string_view name, SyntheticLoad& load)
+{
+    for (uint32_t i = 0; i < static_cast<uint32_t>(SyntheticLoad::Count); ++i) {
+        if (name == GetSyntheticLoadName(static_cast<SyntheticLoad>(i))) {
+            load = static_cast<SyntheticLoad>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<double> GenerateSyntheticLoad(SyntheticLoad load, uint32_t frameCount, double targetFrameMs)
+{
+    std::vector<double> trace(frameCount);
+    std::mt19937 random(13579);
+    std::uniform_real_distribution<double> noise(-0.2, 0.2);
+    for (uint32_t frame = 0; frame < frameCount; ++frame) {
+        double factor = 1.0;
+        switch (load) {
+        case SyntheticLoad::Constant:
+            factor = 1.5;
+            break;
+        case SyntheticLoad::Step:
+            factor = frame >= frameCount / 3 && frame < frameCount * 2 / 3 ? 1.6 : 0.6;
+            break;
+        case SyntheticLoad::Ramp:
+            factor = 0.6 + 1.2 * frame / std::max(frameCount - 1, 1u);
+            break;
+        case SyntheticLoad::Noisy:
+            factor = 1.0 + noise(random);
+            break;
+        case SyntheticLoad::Spikes:
+            factor = frame % SPIKE_INTERVAL == SPIKE_INTERVAL - 1 ? 2.5 : 0.6;
+            break;
+        case SyntheticLoad::Count:
+            break;
+        }
+        trace[frame] = targetFrameMs * factor;
+    }
+    return trace;
+}
+
+// Step は frameCount / 3 で重く、frameCount * 2 / 3 で軽くなる。落ち着くまでの超過は SETTLE_LIMIT_FRAMES 以内とする
+bool CheckSyntheticReplay(SyntheticLoad load, const ResolutionReplayResult& result, const DynamicResolutionSettings& settings, std::string& failure)
+{
+    const auto fail = [&failure](std::string reason) {
+        failure = std::move(reason);
+        return false;
+    };
+    if (result.frameCount < SETTLE_LIMIT_FRAMES * 3) {
+        return fail("at least " + std::to_string(SETTLE_LIMIT_FRAMES * 3) + " frames are required, got " + std::to_string(result.frameCount));
+    }
+    const bool lowered = result.finalScale < settings.maxScale;
+    switch (load) {
+    case SyntheticLoad::Constant:
+        if (result.directionReversals != 0) {
+            return fail("scale reversed direction " + std::to_string(result.directionReversals) + " times under a constant load");
+        }
+        if (!lowered || result.lastChangeFrame > SETTLE_LIMIT_FRAMES) {
+            return fail("scale did not settle below maxScale by frame " + std::to_string(SETTLE_LIMIT_FRAMES) +
+                        " (last change at frame " + std::to_string(result.lastChangeFrame) + ")");
+        }
+        if (result.overBudgetFrames > result.lastChangeFrame) {
+            return fail("frames stayed over budget after the scale settled");
+        }
+        break;
+    case SyntheticLoad::Step:
+        if (result.directionReversals > 1) {
+            return fail("scale reversed direction " + std::to_string(result.directionReversals) + " times under a single step");
+        }
+        if (result.overBudgetFrames > SETTLE_LIMIT_FRAMES) {
+            return fail(std::to_string(result.overBudgetFrames) + " frames over budget after the step up");
+        }
+        if (result.finalScale != settings.maxScale || result.lastChangeFrame > result.frameCount * 2 / 3 + SETTLE_LIMIT_FRAMES) {
+            return fail("scale did not return to maxScale within " + std::to_string(SETTLE_LIMIT_FRAMES) + " frames of the step down");
+        }
+        break;
+    case SyntheticLoad::Ramp:
+        if (result.directionReversals != 0) {
+            return fail("scale reversed direction " + std::to_string(result.directionReversals) + " times under a rising load");
+        }
+        if (!lowered || result.overBudgetFrames > SETTLE_LIMIT_FRAMES) {
+            return fail("scale did not follow the ramp (" + std::to_string(result.overBudgetFrames) + " frames over budget)");
+        }
+        break;
+    case SyntheticLoad::Noisy:
+        if (result.directionReversals > 2 + result.frameCount / NOISY_FRAMES_PER_REVERSAL) {
+            return fail("scale reversed direction " + std::to_string(result.directionReversals) + " times under noise");
+        }
+        break;
+    case SyntheticLoad::Spikes:
+        if (result.scaleChanges != 0) {
+            return fail("scale changed " + std::to_string(result.scaleChanges) + " times in response to single spikes");
+        }
+        break;
+    case SyntheticLoad::Count:
+        break;
+    }
+    return true;
+}
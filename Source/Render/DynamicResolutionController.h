@@ -0,0 +1,92 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct DynamicResolutionSettings {
+    double targetFrameMs = 1000.0 / 60.0; // GPU のフレーム時間の目標
+    double headroom = 0.9;                // 目標に対して狙う割合（揺らぎで目標を超えないための余裕）
+    double tolerance = 0.08;              // 狙う時間との差がこの割合以内なら倍率を変えない（不感帯）
+    double smoothing = 0.1;               // 指数移動平均の係数（小さいほど単発の重いフレームに反応しにくい）
+    float minScale = 0.5f;                // 1 辺あたりの描画解像度の倍率の範囲
+    float maxScale = 1.0f;
+    float scaleStep = 0.05f;              // 倍率の刻み（一時テクスチャの大きさの種類を抑える）
+    float maxScaleDecrease = 0.2f;        // 1 回に変える量の上限（下げるときは速く、上げるときは 1 刻みずつ）
+    uint32_t settleFrames = 4;            // 変更後に捨てる計測値の数（同じ数だけ平均してから次の判定を始める）
+};
+
+// 計測した GPU のフレーム時間から、次のフレームを描画する解像度の倍率を決める。
+// 描画コストは画素数（倍率の 2 乗）に比例するとみなし、平滑化した時間が狙う時間の不感帯を外れたときだけ
+// 倍率を刻み単位で変える。変更後は古い倍率の計測値が混ざらないように一定フレームの間は判定しない。
+// 時刻は扱わず計測値だけで動作するため、合成した負荷のトレースを再生して検証できる。
+class DynamicResolutionController {
+public:
+    void Initialize(const DynamicResolutionSettings& settings);
+    // 倍率を maxScale に戻し、計測値を捨てる
+    void Reset();
+
+    // 完了したフレームの GPU 時間を追加する（0 以下は計測値なしとして無視する）
+    void AddFrame(double gpuMs);
+
+    float GetScale() const { return scale; }
+    // width × height に倍率を掛けた描画解像度（1 以上）
+    void GetScaledSize(uint32_t width, uint32_t height, uint32_t& scaledWidth, uint32_t& scaledHeight) const;
+    double GetSmoothedMs() const { return smoothedMs; }
+    uint32_t GetChangeCount() const { return changeCount; }
+    const DynamicResolutionSettings& GetSettings() const { return settings; }
+
+private:
+    float Quantize(float value) const;
+
+    DynamicResolutionSettings settings;
+    float scale = 1.0f;
+    double smoothedMs = 0.0;
+    uint32_t framesSinceChange = 0; // 変更後に受け取った計測値の数
+    uint32_t changeCount = 0;
+};
+
+// GPU 時間のモデル: fixedMs + (fullResolutionMs - fixedMs) × 倍率²
+// （解像度に依存しない処理と画素数に比例する処理に分ける）
+struct ResolutionReplayModel {
+    double fixedMs = 1.0;
+    uint32_t latencyFrames = 2; // 計測値がコントローラに届くまでのフレーム数
+};
+
+// 負荷のトレースを DynamicResolutionController に 1 フレームずつ与えたときの結果
+struct ResolutionReplayResult {
+    uint32_t frameCount = 0;
+    uint32_t scaleChanges = 0;
+    uint32_t directionReversals = 0; // 倍率を上げた直後に下げた（またはその逆）回数。振動の指標
+    uint32_t lastChangeFrame = 0;    // 最後に倍率を変えたフレーム（収束までのフレーム数の指標）
+    uint32_t overBudgetFrames = 0;   // モデルの GPU 時間が目標を超えたフレーム数
+    uint32_t unavoidableOverBudgetFrames = 0; // 最小倍率でも目標を超えるフレーム数
+    double averageScale = 0.0;
+    float minScale = 0.0f;
+    float finalScale = 0.0f;
+    double averageFrameMs = 0.0;
+    double maxFrameMs = 0.0;
+};
+
+// fullResolutionMs: フレームごとの倍率 1 での GPU 時間
+ResolutionReplayResult ReplayDynamicResolution(const std::vector<double>& fullResolutionMs, const DynamicResolutionSettings& settings, const ResolutionReplayModel& model);
+
+// 合成した負荷（倍率 1 での GPU 時間）の種類
+enum class SyntheticLoad : uint8_t {
+    Constant, // 目標の 1.5 倍で一定
+    Step,     // 軽い負荷から重い負荷へ切り替わり、また戻る
+    Ramp,     // 軽い負荷から重い負荷へ徐々に増える
+    Noisy,    // 目標付近で ±20% 揺らぐ
+    Spikes,   // 軽い負荷に一瞬だけ重いフレームが混ざる
+    Count,
+};
+
+const char* GetSyntheticLoadName(SyntheticLoad load);
+// 戻り値: 名前が一致しない場合は false
+bool ParseSyntheticLoad(std::string_view name, SyntheticLoad& load);
+// 乱数は固定のシードを使うため、同じ引数からは常に同じトレースを返す
+std::vector<double> GenerateSyntheticLoad(SyntheticLoad load, uint32_t frameCount, double targetFrameMs);
+// 合成した負荷の再生結果が期待する挙動（振動しない、一定フレーム以内に落ち着く、単発の重いフレームに反応しない）を満たすか調べる。
+// 戻り値: 満たさない場合は false を返し、failure に理由を設定する
+bool CheckSyntheticReplay(SyntheticLoad load, const ResolutionReplayResult& result, const DynamicResolutionSettings& settings, std::string& failure);
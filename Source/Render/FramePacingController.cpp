@@ -0,0 +1,183 @@
+﻿#include "FramePacingController.h"
+#include "../Core/Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+
+// SleepUntil で OS のスリープに任せずにスピンする残り時間
+constexpr uint64_t SPIN_THRESHOLD_NS = 2000000;
+
+} // namespace
+
+const char* GetPresentModeName(PresentMode mode)
+{
+    switch (mode) {
+    case PresentMode::VSync:
+        return "vsync";
+    case PresentMode::LowLatency:
+        return "low-latency";
+    case PresentMode::Uncapped:
+        return "uncapped";
+    }
+    return "unknown";
+}
+
+bool ParsePresentMode(std::string_view name, PresentMode& mode)
+{
+    for (PresentMode candidate : { PresentMode::VSync, PresentMode::LowLatency, PresentMode::Uncapped }) {
+        if (name == GetPresentModeName(candidate)) {
+            mode = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void FramePacingController::Initialize(const FramePacingSettings& settings)
+{
+    this->settings = settings;
+    Reset();
+}
+
+void FramePacingController::Reset()
+{
+    cpu = {};
+    gpu = {};
+    frameCount = 0;
+}
+
+void FramePacingController::AddFrame(const FrameTimeSample& sample)
+{
+    if (frameCount == 0) {
+        cpu.mean = sample.cpuMs;
+        gpu.mean = sample.gpuMs;
+    }
+    else {
+        UpdateEstimate(cpu, sample.cpuMs);
+        UpdateEstimate(gpu, sample.gpuMs);
+    }
+    ++frameCount;
+}
+
+double FramePacingController::GetPredictedCpuMs() const
+{
+    return Predict(cpu);
+}
+
+double FramePacingController::GetPredictedGpuMs() const
+{
+    return Predict(gpu);
+}
+
+// 遅延 = リフレッシュ間隔 - (予測 CPU 時間 + 予測 GPU 時間 + 余裕)。
+// GPU は CPU の投入後に処理を始めるため、両者の合計が 1 間隔に収まる範囲でだけ遅らせる。
+double FramePacingController::GetFrameStartDelayMs() const
+{
+    if (frameCount == 0) {
+        return 0.0;
+    }
+    const double busyMs = GetPredictedCpuMs() + GetPredictedGpuMs() + settings.safetyMarginMs;
+    return std::max(settings.refreshIntervalMs - busyMs, 0.0);
+}
+
+// 平均と平均絶対偏差の指数移動平均（分散より外れ値の影響を受けにくい）
+void FramePacingController::UpdateEstimate(Estimate& estimate, double value) const
+{
+    const double error = value - estimate.mean;
+    estimate.mean += settings.smoothing * error;
+    estimate.deviation += settings.smoothing * (std::fabs(error) - estimate.deviation);
+}
+
+double FramePacingController::Predict(const Estimate& estimate) const
+{
+    return estimate.mean + settings.deviationScale * estimate.deviation;
+}
+
+PacingReplayResult ReplayFramePacing(const std::vector<FrameTimeSample>& trace, const FramePacingSettings& settings)
+{
+    FramePacingController controller;
+    controller.Initialize(settings);
+    PacingReplayResult result;
+    double totalDelayMs = 0.0;
+    double totalGpuErrorMs = 0.0;
+    for (const FrameTimeSample& sample : trace) {
+        const double delayMs = controller.GetFrameStartDelayMs();
+        if (controller.GetFrameCount() > 0) {
+            const double predictedGpuMs = controller.GetPredictedGpuMs();
+            totalGpuErrorMs += std::fabs(sample.gpuMs - predictedGpuMs);
+            result.gpuUnderpredictions += sample.gpuMs > predictedGpuMs ? 1 : 0;
+        }
+        // 遅らせなくても間に合わないフレームは遅延のせいで落としたとは数えない
+        const double busyMs = sample.cpuMs + sample.gpuMs;
+        if (busyMs <= settings.refreshIntervalMs && delayMs + busyMs > settings.refreshIntervalMs) {
+            ++result.missedDeadlines;
+        }
+        totalDelayMs += delayMs;
+        result.maxDelayMs = std::max(result.maxDelayMs, delayMs);
+        controller.AddFrame(sample);
+    }
+    result.frameCount = static_cast<uint32_t>(trace.size());
+    if (result.frameCount > 0) {
+        result.averageDelayMs = totalDelayMs / result.frameCount;
+    }
+    if (result.frameCount > 1) {
+        result.gpuPredictionErrorMs = totalGpuErrorMs / (result.frameCount - 1);
+    }
+    return result;
+}
+
+std::vector<FrameTimeSample> LoadFrameTimeTrace(const std::filesystem::path& path)
+{
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Failed to open frame time trace: " + path.string());
+    }
+    std::vector<FrameTimeSample> trace;
+    std::string line;
+    uint32_t lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        if (lineNumber == 1 || line.empty() || line == "\r") {
+            continue;
+        }
+        FrameTimeSample sample;
+        if (std::sscanf(line.c_str(), "%lf,%lf", &sample.cpuMs, &sample.gpuMs) != 2) {
+            throw std::runtime_error("Invalid frame time trace line " + std::to_string(lineNumber) + ": " + path.string());
+        }
+        trace.push_back(sample);
+    }
+    return trace;
+}
+
+bool WriteFrameTimeTrace(const std::filesystem::path& path, const std::vector<FrameTimeSample>& trace)
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    file << "cpuMs,gpuMs\n";
+    char line[64];
+    for (const FrameTimeSample& sample : trace) {
+        std::snprintf(line, sizeof(line), "%.4f,%.4f\n", sample.cpuMs, sample.gpuMs);
+        file << line;
+    }
+    return static_cast<bool>(file);
+}
+
+void SleepUntil(uint64_t targetNs)
+{
+    const uint64_t now = Profiler::Now();
+    if (targetNs > now + SPIN_THRESHOLD_NS) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(targetNs - now - SPIN_THRESHOLD_NS));
+    }
+    while (Profiler::Now() < targetNs) {
+        std::this_thread::yield();
+    }
+}
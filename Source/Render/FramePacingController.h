@@ -0,0 +1,87 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+// スワップチェーンの表示方式
+enum class PresentMode : uint8_t {
+    VSync,      // 垂直同期（Present(1, 0)、キューが詰まるまで CPU が先行する）
+    LowLatency, // 待機可能オブジェクトで 1 フレームずつ待ち、予測した余裕分だけ開始を遅らせる
+    Uncapped,   // 垂直同期なし（対応環境ではティアリングを許可）
+};
+
+const char* GetPresentModeName(PresentMode mode);
+// 戻り値: "vsync" / "low-latency" / "uncapped" 以外の場合は false
+bool ParsePresentMode(std::string_view name, PresentMode& mode);
+
+// 1 フレーム分の CPU/GPU 時間（ミリ秒）
+struct FrameTimeSample {
+    double cpuMs = 0.0;
+    double gpuMs = 0.0;
+};
+
+struct FramePacingSettings {
+    double refreshIntervalMs = 1000.0 / 60.0;
+    double safetyMarginMs = 1.0;  // 予測が外れたときのための余裕
+    double smoothing = 0.1;       // 指数移動平均の係数（大きいほど直近のフレームを重視）
+    double deviationScale = 2.0;  // 予測値に加える平均絶対偏差の倍数
+};
+
+// CPU/GPU のフレーム時間を予測し、入力の読み取りとフレームの開始をどれだけ遅らせられるかを決める。
+// 待機可能オブジェクトが通知してから次の垂直同期までの 1 リフレッシュ間隔に CPU と GPU の処理が
+// 収まるように、余った時間だけ開始を遅らせる（遅らせた分だけ入力から表示までの遅延が短くなる）。
+// 時刻は扱わず計測値だけで動作するため、記録したトレースを再生して検証できる。
+class FramePacingController {
+public:
+    void Initialize(const FramePacingSettings& settings);
+    void Reset();
+
+    // 完了したフレームの計測値を追加する（GPU 時間は数フレーム遅れて届いてもよい）
+    void AddFrame(const FrameTimeSample& sample);
+
+    // 次のフレームの予測値（平均 + deviationScale × 平均絶対偏差）
+    double GetPredictedCpuMs() const;
+    double GetPredictedGpuMs() const;
+    // フレームの開始を遅らせる時間（計測値がない間は 0）
+    double GetFrameStartDelayMs() const;
+
+    const FramePacingSettings& GetSettings() const { return settings; }
+    uint32_t GetFrameCount() const { return frameCount; }
+
+private:
+    struct Estimate {
+        double mean = 0.0;
+        double deviation = 0.0;
+    };
+
+    void UpdateEstimate(Estimate& estimate, double value) const;
+    double Predict(const Estimate& estimate) const;
+
+    FramePacingSettings settings;
+    Estimate cpu;
+    Estimate gpu;
+    uint32_t frameCount = 0;
+};
+
+// トレースを FramePacingController に 1 フレームずつ与えたときの結果
+struct PacingReplayResult {
+    uint32_t frameCount = 0;
+    uint32_t missedDeadlines = 0;     // 遅延 + CPU + GPU がリフレッシュ間隔を超えたフレーム数
+    double averageDelayMs = 0.0;      // 短縮できた入力遅延の平均
+    double maxDelayMs = 0.0;
+    double gpuPredictionErrorMs = 0.0; // GPU 時間の予測誤差（平均絶対誤差）
+    uint32_t gpuUnderpredictions = 0;  // 実測が予測を上回ったフレーム数
+};
+
+// 各フレームの遅延はそのフレームより前の計測値だけから決める
+PacingReplayResult ReplayFramePacing(const std::vector<FrameTimeSample>& trace, const FramePacingSettings& settings);
+
+// CSV（1 行目はヘッダ "cpuMs,gpuMs"、以降 1 行 1 フレーム）
+// 例外: ファイルを開けない場合や数値として読めない行がある場合は std::runtime_error を送出
+std::vector<FrameTimeSample> LoadFrameTimeTrace(const std::filesystem::path& path);
+bool WriteFrameTimeTrace(const std::filesystem::path& path, const std::vector<FrameTimeSample>& trace);
+
+// targetNs（Profiler::Now の時刻）まで待つ。OS のスリープは精度が低いため、最後の区間はスピンで待つ
+void SleepUntil(uint64_t targetNs);
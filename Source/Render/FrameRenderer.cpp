@@ -0,0 +1,308 @@
+﻿#include "FrameRenderer.h"
+#include "../Core/FixedTimestep.h"
+#include "../Core/Profiler.h"
+#include <algorithm>
+
+const char* GetParticleSimulationPathName(ParticleSimulationPath path)
+{
+    switch (path) {
+    case ParticleSimulationPath::Cpu:
+        return "cpu";
+    case ParticleSimulationPath::GpuAsyncCompute:
+        return "gpuAsyncCompute";
+    }
+    return "unknown";
+}
+
+// 引数:
+//  - renderBackend: フレームを投入するバックエンド
+//  - jobs: インスタンスの更新と並列記録に使用するジョブシステム
+void FrameRenderer::Initialize(IRenderBackend* renderBackend, JobSystem* jobs)
+{
+    backend = renderBackend;
+    jobSystem = jobs;
+    instances.Initialize(jobs);
+    staticDrawItems.clear();
+    cursorBatch = {};
+    latchedInput = {};
+    dynamicResolutionEnabled = false;
+    particlesEnabled = false;
+    gpuParticles = nullptr;
+    lastParticleTimeNs = 0;
+    frameTimeStats.Initialize();
+    lastFrameEndNs = 0;
+    for (FrameArena& arena : frameArenas) {
+        arena.Initialize(FRAME_ARENA_BLOCK_SIZE);
+    }
+    allocationTracker.Reset();
+}
+
+void FrameRenderer::EnableDynamicResolution(const DynamicResolutionSettings& settings)
+{
+    dynamicResolution.Initialize(settings);
+    dynamicResolutionEnabled = true;
+}
+
+// GPU 経路は初期状態を CPU の ParticleSystem で作ってから GPU 側へ取り込むため、どちらの経路も同じ粒子から始まる。
+// 引数:
+//  - desc: 粒子数と発生源の設定
+//  - mesh: 1 粒子の形状（BuiltinPipeline::Instanced のパイプラインとメッシュ）
+//  - path: 更新方法（バックエンドが非同期コンピュートに対応しない場合は Cpu）
+//  - level: CPU 経路のカーネルの命令セット
+// 例外: GPU 側のリソースの作成に失敗した場合は std::runtime_error を送出
+void FrameRenderer::EnableParticles(const ParticleEmitterDesc& desc, const InstanceBatchDesc& mesh, ParticleSimulationPath path, SimdLevel level)
+{
+    particles.Initialize(jobSystem, desc, level);
+    particleBatch = mesh;
+    gpuParticles = path == ParticleSimulationPath::GpuAsyncCompute ? backend->GetGpuParticleSimulator() : nullptr;
+    if (gpuParticles) {
+        gpuParticles->Initialize(particles);
+    }
+    particlesEnabled = true;
+    lastParticleTimeNs = 0;
+}
+
+void FrameRenderer::Update(float deltaTime)
+{
+    AllocationTagScope tagScope(AllocationTag::Instances);
+    instances.Update(deltaTime);
+}
+
+void FrameRenderer::PublishSnapshot(uint64_t timeNs)
+{
+    AllocationTagScope tagScope(AllocationTag::Instances);
+    instances.WriteSnapshot(instanceSnapshots.GetWriteBuffer(), timeNs);
+    instanceSnapshots.Publish();
+}
+
+// 三角形/インスタンス描画フレームの発行処理。
+// コマンド記録、リソース遷移、RTV クリア、描画、（動的解像度が有効なら）拡大、Present を行う。
+// パスとリソースの状態はレンダーグラフで宣言し、遷移はグラフがまとめて記録する。
+// 描画コマンドはジョブシステム上で複数のコマンドリストへ並列に記録し、
+// 前後の遷移用リストと合わせて 1 回の投入で実行する。
+// GPU の完了は待たず、フレームスロットのリングが一周したときだけ BeginFrame で待機する。
+// インスタンスは公開済みの最新スナップショットを renderTimeNs の時点に補間して描画する。
+// パスが参照するフレームのデータはスロットのフレームアリーナに置き、フレーム中のヒープ確保を避ける。
+void FrameRenderer::Render(uint64_t renderTimeNs)
+{
+    PROFILE_SCOPE("Render");
+    // このスロットを前回使用したフレームの完了を待ってから記録を開始する
+    const BackendFrame frame = backend->BeginFrame();
+    FrameArena& frameArena = frameArenas[frame.frameSlot];
+    frameArena.Reset();
+
+    // 補間したインスタンスデータをフレームメモリへ書き出し、バッチごとの描画を追加
+    // （領域が足りないフレームはインスタンスの描画を省略する）
+    instanceSnapshots.Acquire();
+    const InstanceSnapshot& snapshot = instanceSnapshots.GetReadBuffer();
+    frameDrawItems.assign(staticDrawItems.begin(), staticDrawItems.end());
+    bool instancesWritten = false;
+    {
+        AllocationTagScope tagScope(AllocationTag::Instances);
+        instancesWritten = instances.WriteDrawItems(snapshot, GetInterpolationAlpha(snapshot.previousTimeNs, snapshot.currentTimeNs, renderTimeNs), [this](uint64_t size, FrameAllocation& allocation) {
+            return backend->AllocateFrameMemory(size, INSTANCE_DATA_ALIGNMENT, allocation);
+        }, frameDrawItems);
+    }
+
+    // 粒子は描画するフレームの時刻まで進める（GPU 経路は更新をコンピュートキューへ投入し、描画キューに完了を待たせる）
+    uint32_t particleCount = 0;
+    double particleUpdateMs = 0.0;
+    if (particlesEnabled) {
+        AllocationTagScope tagScope(AllocationTag::Particles);
+        const uint64_t particleStartNs = Profiler::Now();
+        particleCount = WriteParticleDrawItem(frame.frameSlot, renderTimeNs);
+        particleUpdateMs = static_cast<double>(Profiler::Now() - particleStartNs) / 1e6;
+    }
+
+    // カーソルはインスタンスデータの領域だけ確保して描画を記録し、内容は投入直前に書き込む
+    InstanceGpuData* cursorData = nullptr;
+    FrameAllocation cursorAllocation;
+    if (cursorBatch.vertexCount != 0 && backend->AllocateFrameMemory(sizeof(InstanceGpuData), INSTANCE_DATA_ALIGNMENT, cursorAllocation)) {
+        cursorData = static_cast<InstanceGpuData*>(cursorAllocation.cpuAddress);
+        DrawItem cursorDraw;
+        cursorDraw.pipeline = cursorBatch.pipeline;
+        cursorDraw.topology = cursorBatch.topology;
+        cursorDraw.vertexBuffer = cursorBatch.mesh;
+        cursorDraw.instanceBuffer.gpuAddress = cursorAllocation.gpuAddress;
+        cursorDraw.instanceBuffer.sizeInBytes = sizeof(InstanceGpuData);
+        cursorDraw.instanceBuffer.strideInBytes = sizeof(InstanceGpuData);
+        cursorDraw.vertexCount = cursorBatch.vertexCount;
+        cursorDraw.instanceCount = 1;
+        frameDrawItems.push_back(cursorDraw);
+    }
+
+    // 動的解像度が有効な場合は、数フレーム前に完了したフレームの GPU 時間から今フレームの描画解像度を決める
+    AllocationTagScope graphTagScope(AllocationTag::RenderGraph);
+    FramePassData* data = frameArena.New<FramePassData>();
+    data->frame = frame;
+    data->sceneTarget = frame.target;
+    const uint32_t backBufferWidth = static_cast<uint32_t>(frame.target.viewport.width);
+    const uint32_t backBufferHeight = static_cast<uint32_t>(frame.target.viewport.height);
+    data->renderWidth = backBufferWidth;
+    data->renderHeight = backBufferHeight;
+    if (dynamicResolutionEnabled) {
+        dynamicResolution.AddFrame(backend->GetLastGpuFrameTimeMs());
+        dynamicResolution.GetScaledSize(backBufferWidth, backBufferHeight, data->renderWidth, data->renderHeight);
+        data->sceneTarget.viewport = { 0.0f, 0.0f, static_cast<float>(data->renderWidth), static_cast<float>(data->renderHeight), 0.0f, 1.0f };
+        data->sceneTarget.scissor = { 0, 0, static_cast<int32_t>(data->renderWidth), static_cast<int32_t>(data->renderHeight) };
+    }
+
+    // バックバッファを取り込み、Clear → Draw（→ Upscale）のパスを宣言する。
+    // 動的解像度が有効な場合、Clear/Draw は一時テクスチャ SceneColor へ描画し、Upscale でバックバッファへ拡大する。
+    // 遷移はレンダーグラフが宣言した状態から求めて、パスの間にまとめて発行する。
+    // GPU のパス区間はタイムスタンプクエリで囲む（Draw はワーカーのリスト全体を前後のリストで挟む）
+    renderGraph.Reset();
+    data->backBuffer = renderGraph.ImportTexture("BackBuffer", frame.backBuffer, frame.target.renderTarget, ResourceState::Present, ResourceState::Present);
+    data->sceneColor = data->backBuffer;
+    renderGraph.AddPass("Clear", [this, data](RenderGraphBuilder& builder) {
+        if (dynamicResolutionEnabled) {
+            TextureDesc desc;
+            desc.width = data->renderWidth;
+            desc.height = data->renderHeight;
+            desc.format = TextureFormat::RGBA8Unorm;
+            data->sceneColor = builder.CreateTexture("SceneColor", desc);
+        }
+        builder.Write(data->sceneColor, ResourceState::RenderTarget);
+    }, [this, data](RenderPassContext& context) {
+        const uint32_t clearScope = backend->BeginGpuScope(*context.commandList, "Clear");
+        const float clearColor[] = { 0.39f, 0.58f, 0.93f, 1.0f };
+        context.commandList->ClearRenderTarget(context.graph->GetTexture(data->sceneColor).renderTarget, clearColor);
+        backend->EndGpuScope(*context.commandList, clearScope);
+    });
+    renderGraph.AddPass("Draw", [data](RenderGraphBuilder& builder) {
+        builder.Write(data->sceneColor, ResourceState::RenderTarget);
+    }, [this, data](RenderPassContext& context) {
+        // 描画アイテムをワーカーごとのコマンドリストへ並列に記録し、後続のバリアは末尾のリストへ記録する
+        const uint32_t drawScope = backend->BeginGpuScope(*context.commandList, "Draw");
+        context.commandList->End();
+        context.submitLists->push_back(context.commandList);
+        data->sceneTarget.renderTarget = context.graph->GetTexture(data->sceneColor).renderTarget;
+        const std::vector<ICommandList*>* drawLists = nullptr;
+        {
+            AllocationTagScope tagScope(AllocationTag::CommandRecording);
+            drawLists = &backend->GetCommandRecorder().RecordDraws(data->frame.frameSlot, data->sceneTarget, frameDrawItems, DRAWS_PER_RECORDING_TASK);
+        }
+        context.submitLists->insert(context.submitLists->end(), drawLists->begin(), drawLists->end());
+        ICommandList& endList = backend->GetFrameEndCommandList();
+        endList.Begin(data->frame.frameSlot);
+        backend->EndGpuScope(endList, drawScope);
+        context.commandList = &endList;
+    });
+    if (dynamicResolutionEnabled) {
+        renderGraph.AddPass("Upscale", [data](RenderGraphBuilder& builder) {
+            builder.Read(data->sceneColor, ResourceState::ShaderResource);
+            builder.Write(data->backBuffer, ResourceState::RenderTarget);
+        }, [this, data](RenderPassContext& context) {
+            ICommandList& commandList = *context.commandList;
+            const uint32_t upscaleScope = backend->BeginGpuScope(commandList, "Upscale");
+            commandList.SetRenderTarget(context.graph->GetTexture(data->backBuffer).renderTarget);
+            commandList.SetViewport(data->frame.target.viewport);
+            commandList.SetScissorRect(data->frame.target.scissor);
+            commandList.SetPipeline(backend->GetBuiltinPipeline(BuiltinPipeline::Upscale));
+            commandList.SetPrimitiveTopology(PrimitiveTopology::TriangleList);
+            commandList.SetShaderResource(0, context.graph->GetTexture(data->sceneColor).shaderResource);
+            commandList.DrawInstanced(3, 1, 0, 0);
+            backend->EndGpuScope(commandList, upscaleScope);
+        });
+    }
+    renderGraph.Compile([this](const TextureDesc& desc) {
+        return backend->GetTransientMemoryRequirements(desc);
+    });
+
+    ICommandList& beginList = backend->GetFrameBeginCommandList();
+    beginList.Begin(frame.frameSlot);
+    const uint32_t frameScope = backend->BeginGpuScope(beginList, "GPU Frame");
+    submitLists.clear();
+    RenderPassContext passContext;
+    passContext.commandList = &beginList;
+    passContext.submitLists = &submitLists;
+    passContext.frameSlot = frame.frameSlot;
+    renderGraph.Execute(passContext, [this](const TextureDesc& desc, ResourceState initialState, uint64_t heapOffset, uint64_t heapSize) {
+        return backend->AcquireTransientTexture(desc, initialState, heapOffset, heapSize);
+    });
+
+    // 最後のリストを閉じる
+    ICommandList& lastList = *passContext.commandList;
+    backend->EndGpuScope(lastList, frameScope);
+    backend->ResolveGpuScopes(lastList);
+    lastList.End();
+    submitLists.push_back(&lastList);
+
+    // 入力をレイトラッチする。GPU はこのデータを実行時に読むため、記録済みのコマンドはそのまま使える
+    if (cursorData) {
+        PROFILE_SCOPE("LatchInput");
+        if (inputLatch) {
+            LatchedInput input = latchedInput;
+            if (inputLatch(input)) {
+                latchedInput = input;
+            }
+        }
+        *cursorData = { latchedInput.cursorX, latchedInput.cursorY, 0.0f, CURSOR_SCALE, 1.0f, 1.0f, 1.0f, 1.0f };
+    }
+
+    // 記録順のまま 1 回で投入して表示する
+    backend->SubmitAndPresent(submitLists.data(), static_cast<uint32_t>(submitLists.size()));
+
+    lastFrameStats.drawItemCount = static_cast<uint32_t>(frameDrawItems.size());
+    lastFrameStats.instanceCount = instancesWritten ? static_cast<uint32_t>(snapshot.current.size()) : 0;
+    lastFrameStats.commandListCount = static_cast<uint32_t>(submitLists.size());
+    lastFrameStats.instancesSkipped = !instancesWritten;
+    lastFrameStats.particleCount = particleCount;
+    lastFrameStats.particleUpdateMs = particleUpdateMs;
+    lastFrameStats.renderScale = dynamicResolutionEnabled ? dynamicResolution.GetScale() : 1.0f;
+    lastFrameStats.renderWidth = data->renderWidth;
+    lastFrameStats.renderHeight = data->renderHeight;
+    lastFrameStats.renderGraph = renderGraph.GetStats();
+
+    // フレーム時間を記録し、各スレッドのプロファイルリングを空にする
+    const uint64_t frameEndNs = Profiler::Now();
+    if (lastFrameEndNs != 0) {
+        frameTimeStats.AddSample(static_cast<double>(frameEndNs - lastFrameEndNs) / 1e6);
+    }
+    lastFrameEndNs = frameEndNs;
+    GetProfiler().Collect();
+    allocationTracker.EndFrame();
+}
+
+// CPU 経路はジョブシステムで更新してからフレームメモリへ並列に書き出す（領域が足りない場合は描画を省略する）。
+// GPU 経路はスロットごとのインスタンスバッファへコンピュートシェーダが書き出すため、フレームメモリを使わない
+uint32_t FrameRenderer::WriteParticleDrawItem(uint32_t frameSlot, uint64_t renderTimeNs)
+{
+    PROFILE_SCOPE("Particles");
+    float deltaTime = 0.0f;
+    if (lastParticleTimeNs != 0 && renderTimeNs > lastParticleTimeNs) {
+        deltaTime = (std::min)(static_cast<float>(static_cast<double>(renderTimeNs - lastParticleTimeNs) / 1e9), MAX_PARTICLE_STEP);
+    }
+    lastParticleTimeNs = renderTimeNs;
+
+    const uint32_t count = particles.GetParticleCount();
+    DrawItem draw;
+    draw.pipeline = particleBatch.pipeline;
+    draw.topology = particleBatch.topology;
+    draw.vertexBuffer = particleBatch.mesh;
+    draw.vertexCount = particleBatch.vertexCount;
+    draw.instanceCount = count;
+    if (gpuParticles) {
+        draw.instanceBuffer = gpuParticles->Simulate(frameSlot, particles.GetSimulationParams(deltaTime), particles.GetEmitter().appearance);
+    }
+    else {
+        particles.Simulate(deltaTime);
+        const uint64_t size = static_cast<uint64_t>(count) * sizeof(InstanceGpuData);
+        FrameAllocation allocation;
+        if (count == 0 || !backend->AllocateFrameMemory(size, INSTANCE_DATA_ALIGNMENT, allocation)) {
+            return 0;
+        }
+        particles.WriteInstances(static_cast<InstanceGpuData*>(allocation.cpuAddress));
+        draw.instanceBuffer.gpuAddress = allocation.gpuAddress;
+        draw.instanceBuffer.sizeInBytes = static_cast<uint32_t>(size);
+        draw.instanceBuffer.strideInBytes = sizeof(InstanceGpuData);
+    }
+    frameDrawItems.push_back(draw);
+    return count;
+}
+
+void FrameRenderer::ResetFrameTimeStats()
+{
+    frameTimeStats.Reset();
+    lastFrameEndNs = 0;
+}
@@ -0,0 +1,146 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "../Core/AllocationTracker.h"
+#include "../Core/FrameArena.h"
+#include "../Core/FrameTimeStats.h"
+#include "../Core/TripleBuffer.h"
+#include "DynamicResolutionController.h"
+#include "FrameScheduler.h"
+#include "InstancedBatchRenderer.h"
+#include "ParallelCommandRecorder.h"
+#include "ParticleSystem.h"
+#include "RenderBackend.h"
+#include "RenderGraph.h"
+
+class JobSystem;
+
+// 1 フレーム分の描画の統計
+struct FrameRenderStats {
+    uint32_t drawItemCount = 0;
+    uint32_t instanceCount = 0;
+    uint32_t commandListCount = 0; // 投入したコマンドリスト数（前後の遷移用リストを含む）
+    bool instancesSkipped = false; // フレームメモリが足りずにインスタンスの描画を省略した
+    float renderScale = 1.0f;      // 動的解像度の倍率（無効の場合は 1）
+    uint32_t renderWidth = 0;      // シーンを描画した解像度
+    uint32_t renderHeight = 0;
+    uint32_t particleCount = 0;    // 描画した粒子数
+    double particleUpdateMs = 0.0; // 粒子の更新と書き出し（GPU 経路ではコンピュートへの投入）にかかった描画スレッドの時間
+    RenderGraphStats renderGraph;
+};
+
+// 粒子の更新方法
+enum class ParticleSimulationPath : uint8_t {
+    Cpu,             // ParticleSystem の SIMD カーネルでジョブシステム上で更新し、フレームメモリへ書き出す
+    GpuAsyncCompute, // バックエンドのコンピュートキューで更新する（対応しないバックエンドでは Cpu になる）
+};
+
+const char* GetParticleSimulationPathName(ParticleSimulationPath path);
+
+// 投入の直前に読み取る入力（正規化デバイス座標のカーソル位置）
+struct LatchedInput {
+    float cursorX = 0.0f;
+    float cursorY = 0.0f;
+};
+
+// 最新の入力を input に書き込む関数。読み取れなかった場合は false を返す（前回の値を使う）。
+using InputLatchFunction = std::function<bool(LatchedInput& input)>;
+
+// バックエンドに依存しないフレームの更新/記録/投入。
+// 静的な描画アイテムとインスタンスバッチを保持し、毎フレーム IRenderBackend を通して
+// レンダーグラフのパス（クリア → 並列記録した描画 → 動的解像度が有効なら拡大）とその間の遷移を 1 回で投入する。
+// Update/PublishSnapshot はシミュレーションスレッド、Render は描画スレッドから呼び出せる
+// （インスタンスの状態はトリプルバッファのスナップショットを通してだけ受け渡す）。
+class FrameRenderer {
+public:
+    // 並列記録の 1 タスクに割り当てる描画数の目安
+    static constexpr uint32_t DRAWS_PER_RECORDING_TASK = 256;
+    // フレームスロットごとのアリーナの初期ブロックサイズ
+    static constexpr size_t FRAME_ARENA_BLOCK_SIZE = 64 * 1024;
+    // インスタンスデータの書き込み先のアライメント
+    static constexpr uint64_t INSTANCE_DATA_ALIGNMENT = 16;
+    // カーソルの大きさ（インスタンスの scale）
+    static constexpr float CURSOR_SCALE = 0.03f;
+    // 粒子を 1 フレームで進める時間の上限（秒）。停止後の再開などで大きく飛ばないようにする
+    static constexpr float MAX_PARTICLE_STEP = 0.1f;
+
+    // renderBackend/jobs: 使用するバックエンドとジョブシステム（所有しない）
+    void Initialize(IRenderBackend* renderBackend, JobSystem* jobs);
+
+    // 毎フレーム描画するアイテムを追加する
+    void AddStaticDraw(const DrawItem& draw) { staticDrawItems.push_back(draw); }
+    InstancedBatchRenderer& GetInstances() { return instances; }
+    // 入力位置に描画するカーソル（vertexCount == 0 の場合は描画しない）
+    void SetCursorBatch(const InstanceBatchDesc& desc) { cursorBatch = desc; }
+    // カーソル位置の読み取り方法。描画の記録後、投入の直前に呼び出す（レイトラッチ）
+    void SetInputLatch(InputLatchFunction function) { inputLatch = std::move(function); }
+    IRenderBackend& GetBackend() { return *backend; }
+    // シーンを GPU 時間に合わせて縮小した中間テクスチャへ描画し、バックバッファへ拡大する
+    void EnableDynamicResolution(const DynamicResolutionSettings& settings);
+    bool IsDynamicResolutionEnabled() const { return dynamicResolutionEnabled; }
+    const DynamicResolutionController& GetDynamicResolution() const { return dynamicResolution; }
+    // desc の粒子を毎フレームの描画時刻の差分だけ進めて描画する（mesh は 1 粒子の形状）。
+    // 粒子はスナップショットを介さず、描画スレッドで描画するフレームの時刻まで更新する
+    void EnableParticles(const ParticleEmitterDesc& desc, const InstanceBatchDesc& mesh, ParticleSimulationPath path, SimdLevel level = GetSupportedSimdLevel());
+    bool IsParticlesEnabled() const { return particlesEnabled; }
+    ParticleSimulationPath GetParticlePath() const { return gpuParticles ? ParticleSimulationPath::GpuAsyncCompute : ParticleSimulationPath::Cpu; }
+    const ParticleSystem& GetParticles() const { return particles; }
+
+    // シミュレーション側: インスタンスを deltaTime 秒ぶん更新する
+    void Update(float deltaTime);
+    // シミュレーション側: 現在の状態を timeNs の状態として描画側へ公開する
+    void PublishSnapshot(uint64_t timeNs);
+    // 描画側: 最新のスナップショットを renderTimeNs の時点に補間して 1 フレームを記録/投入し、表示する
+    void Render(uint64_t renderTimeNs);
+
+    const FrameRenderStats& GetLastFrameStats() const { return lastFrameStats; }
+    // Render の呼び出し間隔（CPU 側のフレーム時間）
+    const FrameTimeStats& GetFrameTimeStats() const { return frameTimeStats; }
+    void ResetFrameTimeStats();
+    // タグごとのフレーム単位の確保数（Render の最後に 1 フレーム分を締める）
+    AllocationTracker& GetAllocationTracker() { return allocationTracker; }
+    const AllocationTracker& GetAllocationTracker() const { return allocationTracker; }
+    // フレームスロットの一時データ用アリーナ。スロットの前回のフレームの完了後（BeginFrame の直後）に Reset する
+    const FrameArena& GetFrameArena(uint32_t frameSlot) const { return frameArenas[frameSlot]; }
+
+private:
+    // 粒子を進めて描画アイテムを追加する。戻り値: 描画した粒子数
+    uint32_t WriteParticleDrawItem(uint32_t frameSlot, uint64_t renderTimeNs);
+
+    // レンダーグラフのパスが参照する今フレームのデータ（フレームアリーナに置き、パスの関数は this とこのポインタだけをキャプチャする）
+    struct FramePassData {
+        BackendFrame frame;
+        PassTarget sceneTarget;
+        RenderGraphHandle backBuffer = INVALID_RENDER_GRAPH_HANDLE;
+        RenderGraphHandle sceneColor = INVALID_RENDER_GRAPH_HANDLE;
+        uint32_t renderWidth = 0;
+        uint32_t renderHeight = 0;
+    };
+
+    IRenderBackend* backend = nullptr;
+    JobSystem* jobSystem = nullptr;
+    InstancedBatchRenderer instances;
+    TripleBuffer<InstanceSnapshot> instanceSnapshots;
+    std::vector<DrawItem> staticDrawItems;
+    InstanceBatchDesc cursorBatch;
+    InputLatchFunction inputLatch;
+    DynamicResolutionController dynamicResolution;
+    bool dynamicResolutionEnabled = false;
+    ParticleSystem particles;
+    InstanceBatchDesc particleBatch;
+    IGpuParticleSimulator* gpuParticles = nullptr; // GPU 経路の場合だけ設定する（バックエンドが所有）
+    bool particlesEnabled = false;
+    uint64_t lastParticleTimeNs = 0;
+    LatchedInput latchedInput;
+    std::vector<DrawItem> frameDrawItems;  // staticDrawItems にインスタンスバッチを加えた今フレームの描画
+    std::vector<ICommandList*> submitLists;
+    RenderGraph renderGraph;
+    FrameArena frameArenas[MAX_FRAMES_IN_FLIGHT];
+    AllocationTracker allocationTracker;
+    FrameRenderStats lastFrameStats;
+    FrameTimeStats frameTimeStats;
+    uint64_t lastFrameEndNs = 0;
+};
@@ -0,0 +1,92 @@
+﻿#include "FrameScheduler.h"
+#include "../Core/Profiler.h"
+#include <algorithm>
+
+// スケジューラを初期化する。
+// 引数:
+//  - gpuTimeline: フェンスの Signal/待機を委譲するタイムライン
+//  - count: 同時に GPU へ投入するフレーム数（1 ～ MAX_FRAMES_IN_FLIGHT）
+void FrameScheduler::Initialize(IGpuTimeline* gpuTimeline, uint32_t count)
+{
+    timeline = gpuTimeline;
+    framesInFlight = std::clamp<uint32_t>(count, 1, MAX_FRAMES_IN_FLIGHT);
+    frameSlot = 0;
+    nextFenceValue = timeline->GetCompletedValue() + 1;
+    std::fill(std::begin(slotFenceValues), std::end(slotFenceValues), 0);
+    stallCount = 0;
+}
+
+// 今回のスロットを前回使用したフレームの完了を待つ。
+// リングが埋まっていない間（スロットが未使用、または既に完了済み）は待機しない。
+uint32_t FrameScheduler::BeginFrame()
+{
+    const uint64_t slotFence = slotFenceValues[frameSlot];
+    if (slotFence != 0 && timeline->GetCompletedValue() < slotFence) {
+        PROFILE_SCOPE("WaitForFrameSlot");
+        ++stallCount;
+        timeline->WaitForValue(slotFence);
+    }
+    return frameSlot;
+}
+
+// 現フレームの完了値を Signal してスロットに記録し、次のスロットへ進める。
+uint64_t FrameScheduler::EndFrame()
+{
+    const uint64_t fenceValue = nextFenceValue++;
+    timeline->Signal(fenceValue);
+    slotFenceValues[frameSlot] = fenceValue;
+    frameSlot = (frameSlot + 1) % framesInFlight;
+    return fenceValue;
+}
+
+// 最後に発行したフェンス値まで待機する（終了処理やリソース再作成前に使用）。
+void FrameScheduler::WaitForIdle()
+{
+    const uint64_t lastFenceValue = nextFenceValue - 1;
+    if (lastFenceValue != 0 && timeline->GetCompletedValue() < lastFenceValue) {
+        timeline->WaitForValue(lastFenceValue);
+    }
+}
+
+uint64_t FrameScheduler::GetCompletedFenceValue() const
+{
+    return timeline->GetCompletedValue();
+}
+
+// GPU は直前のフレームの処理が終わってから次のフレームに着手する。
+void SimulatedGpuTimeline::Signal(uint64_t value)
+{
+    const double start = std::max(cpuTime, gpuBusyUntil);
+    gpuBusyUntil = start + gpuFrameTime;
+    pending.push_back({ value, gpuBusyUntil });
+}
+
+uint64_t SimulatedGpuTimeline::GetCompletedValue() const
+{
+    Retire();
+    return completedValue;
+}
+
+// 対象の値を持つシグナルの完了時刻まで CPU 時刻を進める。
+void SimulatedGpuTimeline::WaitForValue(uint64_t value)
+{
+    Retire();
+    for (const PendingSignal& signal : pending) {
+        if (signal.value >= value) {
+            if (signal.completeTime > cpuTime) {
+                totalWaitTime += signal.completeTime - cpuTime;
+                cpuTime = signal.completeTime;
+            }
+            break;
+        }
+    }
+    Retire();
+}
+
+void SimulatedGpuTimeline::Retire() const
+{
+    while (!pending.empty() && pending.front().completeTime <= cpuTime) {
+        completedValue = std::max(completedValue, pending.front().value);
+        pending.pop_front();
+    }
+}
@@ -0,0 +1,96 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <deque>
+
+// 同時に GPU へ投入できるフレーム数の上限（コマンドアロケータ等の静的配列サイズ）
+constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 3;
+// 既定の同時投入フレーム数
+constexpr uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
+
+// GPU のタイムライン（フェンス）を抽象化したインターフェース。
+// D3D12 実装と、テスト用のシミュレーション実装を差し替えられるようにする。
+class IGpuTimeline {
+public:
+    virtual ~IGpuTimeline() = default;
+
+    // 直前までに投入した GPU 作業が完了した時点で value に到達するようシグナルを積む
+    virtual void Signal(uint64_t value) = 0;
+    // GPU が完了済みのフェンス値を返す
+    virtual uint64_t GetCompletedValue() const = 0;
+    // 完了値が value に到達するまで CPU をブロックする
+    virtual void WaitForValue(uint64_t value) = 0;
+};
+
+// 複数フレームを GPU に先行投入するためのフレームスケジューラ。
+// フレームスロットごとにフェンス値を記録し、リングが一周して同じスロットを
+// 再利用するときだけ待機する。
+class FrameScheduler {
+public:
+    // gpuTimeline: フェンス操作の委譲先（所有しない）
+    // count: 同時投入フレーム数（1 ～ MAX_FRAMES_IN_FLIGHT に丸める）
+    void Initialize(IGpuTimeline* gpuTimeline, uint32_t count);
+
+    // 次フレームの記録を開始する。スロットの前回使用分が GPU で未完了なら待機する。
+    // 戻り値: 今回のフレームが使用するスロット番号（アロケータ等のインデックス）
+    uint32_t BeginFrame();
+
+    // 現フレームの GPU 作業投入後に呼び出し、スロットへフェンス値を記録する。
+    // 戻り値: 今回のフレームに割り当てたフェンス値
+    uint64_t EndFrame();
+
+    // 投入済みのすべてのフレームが GPU で完了するまで待機する
+    void WaitForIdle();
+
+    uint32_t GetFramesInFlight() const { return framesInFlight; }
+    uint32_t GetFrameSlot() const { return frameSlot; }
+    // 現在記録中のフレームが EndFrame で発行するフェンス値
+    uint64_t GetCurrentFenceValue() const { return nextFenceValue; }
+    // GPU が完了済みのフェンス値
+    uint64_t GetCompletedFenceValue() const;
+    // BeginFrame で実際に CPU がブロックした回数
+    uint64_t GetStallCount() const { return stallCount; }
+
+private:
+    IGpuTimeline* timeline = nullptr;
+    uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT;
+    uint32_t frameSlot = 0;
+    uint64_t nextFenceValue = 1;
+    uint64_t slotFenceValues[MAX_FRAMES_IN_FLIGHT] = {};
+    uint64_t stallCount = 0;
+};
+
+// D3D12 を使わずにペーシングを検証するための GPU タイムラインのシミュレーション。
+// GPU は投入順に 1 フレームずつ処理し、各フレームに gpuFrameTime だけ時間がかかる。
+// 時刻はミリ秒単位の仮想時刻で、CPU 側は AdvanceCpuTime で進める。
+class SimulatedGpuTimeline : public IGpuTimeline {
+public:
+    void Signal(uint64_t value) override;
+    uint64_t GetCompletedValue() const override;
+    void WaitForValue(uint64_t value) override;
+
+    // 以降に Signal されるフレームの GPU 処理時間を設定する
+    void SetGpuFrameTime(double milliseconds) { gpuFrameTime = milliseconds; }
+    // CPU 側の処理時間を経過させる
+    void AdvanceCpuTime(double milliseconds) { cpuTime += milliseconds; }
+
+    double GetCpuTime() const { return cpuTime; }
+    // WaitForValue で CPU がブロックした累積時間
+    double GetTotalWaitTime() const { return totalWaitTime; }
+
+private:
+    struct PendingSignal {
+        uint64_t value;
+        double completeTime;
+    };
+
+    // cpuTime までに完了したシグナルを反映する
+    void Retire() const;
+
+    double cpuTime = 0.0;
+    double gpuFrameTime = 0.0;
+    double gpuBusyUntil = 0.0;
+    double totalWaitTime = 0.0;
+    mutable uint64_t completedValue = 0;
+    mutable std::deque<PendingSignal> pending;
+};
@@ -0,0 +1,274 @@
+﻿#include "GpuHeapAllocator.h"
+#include "LinearRingAllocator.h"
+#include <algorithm>
+#include <cassert>
+
+const char* GetGpuHeapClassName(GpuHeapClass heapClass)
+{
+    switch (heapClass) {
+    case GpuHeapClass::Buffer:
+        return "buffer";
+    case GpuHeapClass::Texture:
+        return "texture";
+    case GpuHeapClass::RenderTarget:
+        return "renderTarget";
+    case GpuHeapClass::Count:
+        break;
+    }
+    return "unknown";
+}
+
+const char* GetGpuSizeClassName(GpuSizeClass sizeClass)
+{
+    switch (sizeClass) {
+    case GpuSizeClass::Small:
+        return "small";
+    case GpuSizeClass::Large:
+        return "large";
+    case GpuSizeClass::Dedicated:
+        return "dedicated";
+    case GpuSizeClass::Count:
+        break;
+    }
+    return "unknown";
+}
+
+void GpuHeapAllocator::Initialize(IGpuHeapBackend* heapBackend, const GpuHeapAllocatorDesc& allocatorDesc)
+{
+    assert(allocatorDesc.dedicatedResourceLimit <= allocatorDesc.largeHeapSize);
+    backend = heapBackend;
+    desc = allocatorDesc;
+    heaps.clear();
+    unusedHeaps.clear();
+    for (auto& classPools : pools) {
+        for (std::vector<uint32_t>& pool : classPools) {
+            pool.clear();
+        }
+    }
+    stats = {};
+}
+
+void GpuHeapAllocator::Shutdown()
+{
+    for (uint32_t heap = 0; heap < heaps.size(); ++heap) {
+        if (heaps[heap].alive) {
+            DestroyHeap(heap);
+        }
+    }
+}
+
+// プールのヒープを作成順に探す（古いヒープから埋まり、新しいヒープが空になりやすい）。
+// 引数:
+//  - heapClass: リソースの種類
+//  - size/alignment: 配置に必要なバイト数とアライメント（D3D12 では GetResourceAllocationInfo の値）
+//  - allowNewHeap: 既存のヒープに収まらない場合に新しいヒープを作成してよいか
+GpuAllocation GpuHeapAllocator::Allocate(GpuHeapClass heapClass, uint64_t size, uint64_t alignment, bool allowNewHeap)
+{
+    const GpuSizeClass sizeClass = GetSizeClass(size);
+    GpuAllocation allocation;
+    uint32_t block = TlsfAllocator::INVALID_BLOCK;
+    if (sizeClass != GpuSizeClass::Dedicated) {
+        for (uint32_t heap : GetPool(heapClass, sizeClass)) {
+            if (heaps[heap].excluded) {
+                continue;
+            }
+            block = heaps[heap].allocator.Allocate(size, alignment);
+            if (block != TlsfAllocator::INVALID_BLOCK) {
+                allocation.heap = heap;
+                break;
+            }
+        }
+    }
+    if (!allocation.IsValid() && allowNewHeap) {
+        const uint32_t heap = CreateHeap(heapClass, sizeClass, GetNewHeapSize(size, alignment));
+        if (heap != INVALID_GPU_HEAP) {
+            block = heaps[heap].allocator.Allocate(size, alignment);
+            assert(block != TlsfAllocator::INVALID_BLOCK);
+            allocation.heap = heap;
+        }
+    }
+    if (!allocation.IsValid()) {
+        if (allowNewHeap) {
+            ++stats.failedAllocations;
+        }
+        return allocation;
+    }
+
+    const TlsfAllocator& tlsf = heaps[allocation.heap].allocator;
+    allocation.block = block;
+    allocation.offset = tlsf.GetOffset(block);
+    allocation.size = tlsf.GetSize(block);
+    stats.usedBytes += allocation.size;
+    ++stats.allocationCount;
+    ++stats.totalAllocations;
+    return allocation;
+}
+
+// 空になったヒープは、プールに残す数を超えた分を破棄する（専用ヒープは常に破棄する）。
+// 最適化で除外していたヒープも、残す数に満たなければ除外を解いて空きヒープとして使い回す
+void GpuHeapAllocator::Free(const GpuAllocation& allocation)
+{
+    assert(allocation.IsValid() && allocation.heap < heaps.size() && heaps[allocation.heap].alive);
+    Heap& heap = heaps[allocation.heap];
+    heap.allocator.Free(allocation.block);
+    stats.usedBytes -= allocation.size;
+    --stats.allocationCount;
+    if (heap.allocator.GetAllocationCount() == 0) {
+        ReleaseEmptyHeap(allocation.heap);
+    }
+}
+
+GpuSizeClass GpuHeapAllocator::GetSizeClass(uint64_t size) const
+{
+    if (size <= desc.smallResourceLimit) {
+        return GpuSizeClass::Small;
+    }
+    return size < desc.dedicatedResourceLimit ? GpuSizeClass::Large : GpuSizeClass::Dedicated;
+}
+
+uint64_t GpuHeapAllocator::GetNewHeapSize(uint64_t size, uint64_t alignment) const
+{
+    switch (GetSizeClass(size)) {
+    case GpuSizeClass::Small:
+        return desc.smallHeapSize;
+    case GpuSizeClass::Large:
+        return desc.largeHeapSize;
+    default:
+        break;
+    }
+    // ヒープの先頭はヒープのアライメントに合っているため、余白なしで収まる
+    return AlignUp(size, (std::max)(alignment, desc.largeGranularity));
+}
+
+void GpuHeapAllocator::SetHeapExcluded(uint32_t heap, bool excluded)
+{
+    heaps[heap].excluded = excluded;
+    if (excluded && heaps[heap].allocator.GetAllocationCount() == 0) {
+        ReleaseEmptyHeap(heap);
+    }
+}
+
+GpuHeapInfo GpuHeapAllocator::GetHeapInfo(uint32_t heap) const
+{
+    const Heap& h = heaps[heap];
+    GpuHeapInfo info;
+    info.heapClass = h.heapClass;
+    info.sizeClass = h.sizeClass;
+    info.size = h.allocator.GetCapacity();
+    info.usedBytes = h.allocator.GetUsedSize();
+    info.allocationCount = h.allocator.GetAllocationCount();
+    info.alive = h.alive;
+    info.excluded = h.excluded;
+    return info;
+}
+
+GpuHeapPoolStats GpuHeapAllocator::GetPoolStats(GpuHeapClass heapClass, GpuSizeClass sizeClass) const
+{
+    GpuHeapPoolStats pool;
+    for (uint32_t heap : GetPool(heapClass, sizeClass)) {
+        const TlsfAllocator& tlsf = heaps[heap].allocator;
+        ++pool.heapCount;
+        pool.allocationCount += tlsf.GetAllocationCount();
+        pool.freeBlockCount += tlsf.GetFreeBlockCount();
+        pool.heapBytes += tlsf.GetCapacity();
+        pool.usedBytes += tlsf.GetUsedSize();
+        pool.largestFreeBlock = (std::max)(pool.largestFreeBlock, tlsf.GetLargestFreeBlock());
+    }
+    return pool;
+}
+
+// 専用ヒープは空きを持たないため、Small/Large のプールの空きの重み付き平均になる
+double GpuHeapAllocator::GetFragmentation() const
+{
+    uint64_t freeBytes = 0;
+    double fragmentedBytes = 0.0;
+    for (uint32_t heapClass = 0; heapClass < GPU_HEAP_CLASS_COUNT; ++heapClass) {
+        for (uint32_t sizeClass = 0; sizeClass < GPU_SIZE_CLASS_COUNT; ++sizeClass) {
+            const GpuHeapPoolStats pool = GetPoolStats(static_cast<GpuHeapClass>(heapClass), static_cast<GpuSizeClass>(sizeClass));
+            freeBytes += pool.GetFreeBytes();
+            fragmentedBytes += pool.GetFragmentation() * static_cast<double>(pool.GetFreeBytes());
+        }
+    }
+    return freeBytes != 0 ? fragmentedBytes / static_cast<double>(freeBytes) : 0.0;
+}
+
+uint32_t GpuHeapAllocator::CreateHeap(GpuHeapClass heapClass, GpuSizeClass sizeClass, uint64_t size)
+{
+    uint32_t heap = INVALID_GPU_HEAP;
+    if (!unusedHeaps.empty()) {
+        heap = unusedHeaps.back();
+    }
+    else {
+        heap = static_cast<uint32_t>(heaps.size());
+    }
+    if (!backend->CreateHeap(heap, heapClass, size)) {
+        ++stats.heapCreateFailures;
+        return INVALID_GPU_HEAP;
+    }
+    if (heap == heaps.size()) {
+        heaps.emplace_back();
+    }
+    else {
+        unusedHeaps.pop_back();
+    }
+
+    Heap& h = heaps[heap];
+    const uint64_t granularity = sizeClass == GpuSizeClass::Small ? desc.smallGranularity : desc.largeGranularity;
+    h.allocator.Initialize(size, granularity);
+    h.heapClass = heapClass;
+    h.sizeClass = sizeClass;
+    h.alive = true;
+    h.excluded = false;
+    GetPool(heapClass, sizeClass).push_back(heap);
+
+    ++stats.heapCount;
+    ++stats.heapsCreated;
+    stats.heapBytes += h.allocator.GetCapacity();
+    stats.peakHeapBytes = (std::max)(stats.peakHeapBytes, stats.heapBytes);
+    return heap;
+}
+
+void GpuHeapAllocator::ReleaseEmptyHeap(uint32_t heap)
+{
+    Heap& h = heaps[heap];
+    h.excluded = false;
+    if (h.sizeClass == GpuSizeClass::Dedicated) {
+        DestroyHeap(heap);
+        return;
+    }
+    uint32_t emptyHeaps = 0;
+    for (uint32_t other : GetPool(h.heapClass, h.sizeClass)) {
+        if (heaps[other].allocator.GetAllocationCount() == 0 && !heaps[other].excluded) {
+            ++emptyHeaps;
+        }
+    }
+    if (emptyHeaps > desc.emptyHeapsToKeep) {
+        DestroyHeap(heap);
+    }
+}
+
+void GpuHeapAllocator::DestroyHeap(uint32_t heap)
+{
+    Heap& h = heaps[heap];
+    backend->DestroyHeap(heap);
+    std::vector<uint32_t>& pool = GetPool(h.heapClass, h.sizeClass);
+    pool.erase(std::find(pool.begin(), pool.end(), heap));
+
+    --stats.heapCount;
+    ++stats.heapsDestroyed;
+    stats.heapBytes -= h.allocator.GetCapacity();
+    h.allocator.Initialize(0, 1);
+    h.alive = false;
+    h.excluded = false;
+    unusedHeaps.push_back(heap);
+}
+
+std::vector<uint32_t>& GpuHeapAllocator::GetPool(GpuHeapClass heapClass, GpuSizeClass sizeClass)
+{
+    return pools[static_cast<uint32_t>(heapClass)][static_cast<uint32_t>(sizeClass)];
+}
+
+const std::vector<uint32_t>& GpuHeapAllocator::GetPool(GpuHeapClass heapClass, GpuSizeClass sizeClass) const
+{
+    return pools[static_cast<uint32_t>(heapClass)][static_cast<uint32_t>(sizeClass)];
+}
@@ -0,0 +1,163 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "TlsfAllocator.h"
+
+// GPU メモリのヒープを作成し、その中に配置リソースの領域を切り出すアロケータ（デバイス非依存）。
+// リソースごとに暗黙のヒープを作る（CreateCommittedResource）代わりに、大きなヒープを
+// リソースの種類（ヒープ区分）と大きさ（サイズ区分）ごとのプールにまとめ、各ヒープの中を TLSF で管理する。
+// プールに置くと断片化の原因になる大きなリソースには、専用のヒープを作成する。
+
+// 1 つのヒープに置けるリソースの種類（D3D12 のリソースヒープ階層 1 の制約に合わせて分ける）
+enum class GpuHeapClass : uint8_t {
+    Buffer,
+    Texture,      // レンダーターゲット/深度以外のテクスチャ
+    RenderTarget, // レンダーターゲット/深度テクスチャ
+    Count,
+};
+
+enum class GpuSizeClass : uint8_t {
+    Small,     // smallHeapSize のヒープに smallGranularity 単位で置く
+    Large,     // largeHeapSize のヒープに largeGranularity 単位で置く
+    Dedicated, // 1 リソースで 1 ヒープ
+    Count,
+};
+
+constexpr uint32_t GPU_HEAP_CLASS_COUNT = static_cast<uint32_t>(GpuHeapClass::Count);
+constexpr uint32_t GPU_SIZE_CLASS_COUNT = static_cast<uint32_t>(GpuSizeClass::Count);
+constexpr uint32_t INVALID_GPU_HEAP = UINT32_MAX;
+
+const char* GetGpuHeapClassName(GpuHeapClass heapClass);
+const char* GetGpuSizeClassName(GpuSizeClass sizeClass);
+
+// ヒープ内の領域（heap はバックエンドの CreateHeap に渡した番号）
+struct GpuAllocation {
+    uint32_t heap = INVALID_GPU_HEAP;
+    uint32_t block = TlsfAllocator::INVALID_BLOCK;
+    uint64_t offset = 0;
+    uint64_t size = 0; // 確保の単位に切り上げた大きさ
+
+    bool IsValid() const { return heap != INVALID_GPU_HEAP; }
+};
+
+struct GpuHeapAllocatorDesc {
+    uint64_t smallHeapSize = 16ull * 1024 * 1024;
+    uint64_t largeHeapSize = 64ull * 1024 * 1024;
+    uint64_t smallResourceLimit = 256ull * 1024;            // この大きさ以下を Small に置く
+    uint64_t dedicatedResourceLimit = 8ull * 1024 * 1024;   // この大きさ以上を専用ヒープにする（largeHeapSize 以下）
+    uint64_t smallGranularity = 4096;                       // D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT
+    uint64_t largeGranularity = 65536;                      // D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT
+    uint32_t emptyHeapsToKeep = 1; // プールごとに破棄せず残す空のヒープ数（作成と破棄の繰り返しを防ぐ）
+};
+
+// ヒープの作成/破棄を行うバックエンド
+class IGpuHeapBackend {
+public:
+    virtual ~IGpuHeapBackend() = default;
+
+    // heap 番号のヒープを作成する。
+    // 戻り値: メモリ不足などで作成できない場合は false
+    virtual bool CreateHeap(uint32_t heap, GpuHeapClass heapClass, uint64_t size) = 0;
+    // heap に置いたリソースはすべて解放済み
+    virtual void DestroyHeap(uint32_t heap) = 0;
+};
+
+// プール（ヒープ区分とサイズ区分の組）の使用状況
+struct GpuHeapPoolStats {
+    uint32_t heapCount = 0;
+    uint32_t allocationCount = 0;
+    uint32_t freeBlockCount = 0;
+    uint64_t heapBytes = 0;
+    uint64_t usedBytes = 0;
+    uint64_t largestFreeBlock = 0; // ヒープをまたいだ最大値
+
+    uint64_t GetFreeBytes() const { return heapBytes - usedBytes; }
+    // 外部断片化: 空きのうち最大の空きブロックに収まらない割合（0 = 空きが 1 か所にまとまっている）
+    double GetFragmentation() const
+    {
+        const uint64_t freeBytes = GetFreeBytes();
+        return freeBytes != 0 ? 1.0 - static_cast<double>(largestFreeBlock) / static_cast<double>(freeBytes) : 0.0;
+    }
+};
+
+struct GpuHeapAllocatorStats {
+    uint32_t heapCount = 0;
+    uint32_t allocationCount = 0;
+    uint64_t heapBytes = 0;
+    uint64_t usedBytes = 0;
+    uint64_t peakHeapBytes = 0;
+    uint64_t totalAllocations = 0;
+    uint64_t failedAllocations = 0;   // 既存のヒープに収まらず、新しいヒープも作れなかった
+    uint64_t heapsCreated = 0;
+    uint64_t heapsDestroyed = 0;
+    uint64_t heapCreateFailures = 0;
+};
+
+// 作成済みのヒープ（最適化で空にするヒープを選ぶために公開する）
+struct GpuHeapInfo {
+    GpuHeapClass heapClass = GpuHeapClass::Buffer;
+    GpuSizeClass sizeClass = GpuSizeClass::Small;
+    uint64_t size = 0;
+    uint64_t usedBytes = 0;
+    uint32_t allocationCount = 0;
+    bool alive = false;    // false の番号は破棄済み（次に作成するヒープで再利用する）
+    bool excluded = false; // 新しい領域を置かない
+};
+
+// 呼び出しは 1 スレッド（描画スレッド）から行うこと。
+class GpuHeapAllocator {
+public:
+    // heapBackend: ヒープの作成先（所有しない）
+    void Initialize(IGpuHeapBackend* heapBackend, const GpuHeapAllocatorDesc& allocatorDesc);
+    // 残っているヒープをすべて破棄する（確保済みの領域は無効になる）
+    void Shutdown();
+
+    // size バイトを alignment 境界に確保する。既存のヒープに空きがなければ新しいヒープを作成する。
+    // allowNewHeap: false の場合は既存のヒープだけから探す
+    // 戻り値: 確保できない場合は無効な GpuAllocation
+    GpuAllocation Allocate(GpuHeapClass heapClass, uint64_t size, uint64_t alignment, bool allowNewHeap = true);
+    // GPU が領域を参照し終えてから呼び出すこと。空になったヒープは必要に応じて破棄する
+    void Free(const GpuAllocation& allocation);
+
+    GpuSizeClass GetSizeClass(uint64_t size) const;
+    // Allocate で新しいヒープを作る場合のヒープの大きさ
+    uint64_t GetNewHeapSize(uint64_t size, uint64_t alignment) const;
+
+    // heap に新しい領域を置かないようにする（空になった時点で除外を解き、プールに残す数を超えていれば破棄する）
+    void SetHeapExcluded(uint32_t heap, bool excluded);
+    uint32_t GetHeapSlotCount() const { return static_cast<uint32_t>(heaps.size()); }
+    GpuHeapInfo GetHeapInfo(uint32_t heap) const;
+    // ヒープ内の最大の空きブロック（計測用）
+    uint64_t GetHeapLargestFreeBlock(uint32_t heap) const { return heaps[heap].allocator.GetLargestFreeBlock(); }
+
+    GpuHeapPoolStats GetPoolStats(GpuHeapClass heapClass, GpuSizeClass sizeClass) const;
+    // 全プールの空きを合計した外部断片化
+    double GetFragmentation() const;
+    const GpuHeapAllocatorStats& GetStats() const { return stats; }
+    const GpuHeapAllocatorDesc& GetDesc() const { return desc; }
+
+private:
+    struct Heap {
+        TlsfAllocator allocator;
+        GpuHeapClass heapClass = GpuHeapClass::Buffer;
+        GpuSizeClass sizeClass = GpuSizeClass::Small;
+        bool alive = false;
+        bool excluded = false;
+    };
+
+    // 戻り値: 作成できない場合は INVALID_GPU_HEAP
+    uint32_t CreateHeap(GpuHeapClass heapClass, GpuSizeClass sizeClass, uint64_t size);
+    // 空になった heap を、プールに残す数を超えていれば破棄し、そうでなければ空きヒープとして残す
+    void ReleaseEmptyHeap(uint32_t heap);
+    void DestroyHeap(uint32_t heap);
+    std::vector<uint32_t>& GetPool(GpuHeapClass heapClass, GpuSizeClass sizeClass);
+    const std::vector<uint32_t>& GetPool(GpuHeapClass heapClass, GpuSizeClass sizeClass) const;
+
+    IGpuHeapBackend* backend = nullptr;
+    GpuHeapAllocatorDesc desc;
+    std::vector<Heap> heaps; // ヒープ番号で引く
+    std::vector<uint32_t> unusedHeaps; // 破棄済みで再利用できるヒープ番号
+    std::vector<uint32_t> pools[GPU_HEAP_CLASS_COUNT][GPU_SIZE_CLASS_COUNT]; // 作成順のヒープ番号
+    GpuHeapAllocatorStats stats;
+};
@@ -0,0 +1,366 @@
+﻿#include "InstanceKernels.h"
+
+#if SIMD_X86
+#include <immintrin.h>
+#endif
+
+// すべての実装で同じ結果になるように、分岐は比較マスクと選択で表現できる形にそろえている。
+// （AVX2 版は積和に FMA を使うため、位置と回転は丸め誤差の範囲で異なる）
+
+namespace {
+
+constexpr float PI = 3.14159265358979f;
+constexpr float TWO_PI = 2.0f * PI;
+// 明滅の振幅（基本色に対する明るさ 0.5 ～ 1.0）
+constexpr float PULSE_MIN = 0.5f;
+constexpr float PULSE_RANGE = 0.5f;
+
+void UpdateTransformsScalar(const InstanceStreams& s, uint32_t begin, uint32_t end, const InstanceUpdateParams& params)
+{
+    const float dt = params.deltaTime;
+    const float bounds = params.bounds;
+    for (uint32_t i = begin; i < end; ++i) {
+        float x = s.positionX[i] + s.velocityX[i] * dt;
+        float y = s.positionY[i] + s.velocityY[i] * dt;
+        if (x < -bounds || x > bounds) {
+            s.velocityX[i] = -s.velocityX[i];
+            x = x < -bounds ? -bounds : bounds;
+        }
+        if (y < -bounds || y > bounds) {
+            s.velocityY[i] = -s.velocityY[i];
+            y = y < -bounds ? -bounds : bounds;
+        }
+        s.positionX[i] = x;
+        s.positionY[i] = y;
+
+        float angle = s.rotation[i] + s.angularVelocity[i] * dt;
+        if (angle > PI) {
+            angle -= TWO_PI;
+        }
+        if (angle < -PI) {
+            angle += TWO_PI;
+        }
+        s.rotation[i] = angle;
+    }
+}
+
+// 明るさ = PULSE_MIN + PULSE_RANGE * |2 * frac(phase + pulseTime) - 1|（三角波）
+void UpdateColorsScalar(const InstanceStreams& s, uint32_t begin, uint32_t end, const InstanceUpdateParams& params)
+{
+    for (uint32_t i = begin; i < end; ++i) {
+        float t = s.phase[i] + params.pulseTime;
+        if (t >= 1.0f) {
+            t -= 1.0f;
+        }
+        const float wave = 2.0f * t - 1.0f;
+        const float brightness = PULSE_MIN + PULSE_RANGE * (wave < 0.0f ? -wave : wave);
+        s.colorR[i] = s.baseColorR[i] * brightness;
+        s.colorG[i] = s.baseColorG[i] * brightness;
+        s.colorB[i] = s.baseColorB[i] * brightness;
+    }
+}
+
+void PackInstancesScalar(const InstanceStreams& s, uint32_t begin, uint32_t end, InstanceGpuData* output)
+{
+    for (uint32_t i = begin; i < end; ++i) {
+        InstanceGpuData& instance = output[i - begin];
+        instance.positionX = s.positionX[i];
+        instance.positionY = s.positionY[i];
+        instance.rotation = s.rotation[i];
+        instance.scale = s.scale[i];
+        instance.colorR = s.colorR[i];
+        instance.colorG = s.colorG[i];
+        instance.colorB = s.colorB[i];
+        instance.colorA = 1.0f;
+    }
+}
+
+// 回転は [-PI, PI] で折り返すため、差分を最短方向に直してから補間する
+void InterpolateInstancesScalar(const InstanceGpuData* previous, const InstanceGpuData* current, uint32_t begin, uint32_t end, float alpha, InstanceGpuData* output)
+{
+    for (uint32_t i = begin; i < end; ++i) {
+        const InstanceGpuData& a = previous[i];
+        const InstanceGpuData& b = current[i];
+        float rotationDelta = b.rotation - a.rotation;
+        if (rotationDelta > PI) {
+            rotationDelta -= TWO_PI;
+        }
+        if (rotationDelta < -PI) {
+            rotationDelta += TWO_PI;
+        }
+        InstanceGpuData& instance = output[i - begin];
+        instance.positionX = a.positionX + (b.positionX - a.positionX) * alpha;
+        instance.positionY = a.positionY + (b.positionY - a.positionY) * alpha;
+        instance.rotation = a.rotation + rotationDelta * alpha;
+        instance.scale = a.scale + (b.scale - a.scale) * alpha;
+        instance.colorR = a.colorR + (b.colorR - a.colorR) * alpha;
+        instance.colorG = a.colorG + (b.colorG - a.colorG) * alpha;
+        instance.colorB = a.colorB + (b.colorB - a.colorB) * alpha;
+        instance.colorA = a.colorA + (b.colorA - a.colorA) * alpha;
+    }
+}
+
+#if SIMD_X86
+
+// ---- SSE2（4 インスタンス単位、端数はスカラー版で処理） ----
+
+void UpdateTransformsSSE2(const InstanceStreams& s, uint32_t begin, uint32_t end, const InstanceUpdateParams& params)
+{
+    const __m128 dt = _mm_set1_ps(params.deltaTime);
+    const __m128 maxBounds = _mm_set1_ps(params.bounds);
+    const __m128 minBounds = _mm_set1_ps(-params.bounds);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    const __m128 pi = _mm_set1_ps(PI);
+    const __m128 minusPi = _mm_set1_ps(-PI);
+    const __m128 twoPi = _mm_set1_ps(TWO_PI);
+
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 vx = _mm_loadu_ps(s.velocityX + i);
+        __m128 vy = _mm_loadu_ps(s.velocityY + i);
+        __m128 x = _mm_add_ps(_mm_loadu_ps(s.positionX + i), _mm_mul_ps(vx, dt));
+        __m128 y = _mm_add_ps(_mm_loadu_ps(s.positionY + i), _mm_mul_ps(vy, dt));
+        // 範囲外の成分だけ速度の符号を反転し、位置を境界へ戻す
+        const __m128 outX = _mm_or_ps(_mm_cmplt_ps(x, minBounds), _mm_cmpgt_ps(x, maxBounds));
+        const __m128 outY = _mm_or_ps(_mm_cmplt_ps(y, minBounds), _mm_cmpgt_ps(y, maxBounds));
+        vx = _mm_xor_ps(vx, _mm_and_ps(outX, signMask));
+        vy = _mm_xor_ps(vy, _mm_and_ps(outY, signMask));
+        x = _mm_min_ps(_mm_max_ps(x, minBounds), maxBounds);
+        y = _mm_min_ps(_mm_max_ps(y, minBounds), maxBounds);
+        _mm_storeu_ps(s.velocityX + i, vx);
+        _mm_storeu_ps(s.velocityY + i, vy);
+        _mm_storeu_ps(s.positionX + i, x);
+        _mm_storeu_ps(s.positionY + i, y);
+
+        __m128 angle = _mm_add_ps(_mm_loadu_ps(s.rotation + i), _mm_mul_ps(_mm_loadu_ps(s.angularVelocity + i), dt));
+        angle = _mm_sub_ps(angle, _mm_and_ps(_mm_cmpgt_ps(angle, pi), twoPi));
+        angle = _mm_add_ps(angle, _mm_and_ps(_mm_cmplt_ps(angle, minusPi), twoPi));
+        _mm_storeu_ps(s.rotation + i, angle);
+    }
+    UpdateTransformsScalar(s, i, end, params);
+}
+
+void UpdateColorsSSE2(const InstanceStreams& s, uint32_t begin, uint32_t end, const InstanceUpdateParams& params)
+{
+    const __m128 pulseTime = _mm_set1_ps(params.pulseTime);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 pulseMin = _mm_set1_ps(PULSE_MIN);
+    const __m128 pulseRange = _mm_set1_ps(PULSE_RANGE);
+
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 t = _mm_add_ps(_mm_loadu_ps(s.phase + i), pulseTime);
+        t = _mm_sub_ps(t, _mm_and_ps(_mm_cmpge_ps(t, one), one));
+        const __m128 wave = _mm_and_ps(_mm_sub_ps(_mm_mul_ps(two, t), one), absMask);
+        const __m128 brightness = _mm_add_ps(pulseMin, _mm_mul_ps(pulseRange, wave));
+        _mm_storeu_ps(s.colorR + i, _mm_mul_ps(_mm_loadu_ps(s.baseColorR + i), brightness));
+        _mm_storeu_ps(s.colorG + i, _mm_mul_ps(_mm_loadu_ps(s.baseColorG + i), brightness));
+        _mm_storeu_ps(s.colorB + i, _mm_mul_ps(_mm_loadu_ps(s.baseColorB + i), brightness));
+    }
+    UpdateColorsScalar(s, i, end, params);
+}
+
+// 4 インスタンス × 4 属性を転置して、1 インスタンス 16 バイト単位で書き出す
+void PackInstancesSSE2(const InstanceStreams& s, uint32_t begin, uint32_t end, InstanceGpuData* output)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    float* out = reinterpret_cast<float*>(output);
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4, out += 32) {
+        __m128 px = _mm_loadu_ps(s.positionX + i);
+        __m128 py = _mm_loadu_ps(s.positionY + i);
+        __m128 rot = _mm_loadu_ps(s.rotation + i);
+        __m128 scl = _mm_loadu_ps(s.scale + i);
+        _MM_TRANSPOSE4_PS(px, py, rot, scl);
+        __m128 r = _mm_loadu_ps(s.colorR + i);
+        __m128 g = _mm_loadu_ps(s.colorG + i);
+        __m128 b = _mm_loadu_ps(s.colorB + i);
+        __m128 a = one;
+        _MM_TRANSPOSE4_PS(r, g, b, a);
+        _mm_storeu_ps(out + 0, px);
+        _mm_storeu_ps(out + 4, r);
+        _mm_storeu_ps(out + 8, py);
+        _mm_storeu_ps(out + 12, g);
+        _mm_storeu_ps(out + 16, rot);
+        _mm_storeu_ps(out + 20, b);
+        _mm_storeu_ps(out + 24, scl);
+        _mm_storeu_ps(out + 28, a);
+    }
+    PackInstancesScalar(s, i, end, output + (i - begin));
+}
+
+// 1 インスタンス = 2 レジスタ（変換 / 色）。回転の折り返しは変換側の 3 要素目だけに適用する
+void InterpolateInstancesSSE2(const InstanceGpuData* previous, const InstanceGpuData* current, uint32_t begin, uint32_t end, float alpha, InstanceGpuData* output)
+{
+    const __m128 t = _mm_set1_ps(alpha);
+    const __m128 rotationLane = _mm_castsi128_ps(_mm_set_epi32(0, -1, 0, 0));
+    const __m128 pi = _mm_set1_ps(PI);
+    const __m128 minusPi = _mm_set1_ps(-PI);
+    const __m128 twoPi = _mm_and_ps(_mm_set1_ps(TWO_PI), rotationLane);
+    const float* a = reinterpret_cast<const float*>(previous + begin);
+    const float* b = reinterpret_cast<const float*>(current + begin);
+    float* out = reinterpret_cast<float*>(output);
+    for (uint32_t i = begin; i < end; ++i, a += 8, b += 8, out += 8) {
+        const __m128 a0 = _mm_loadu_ps(a);
+        const __m128 a1 = _mm_loadu_ps(a + 4);
+        __m128 d0 = _mm_sub_ps(_mm_loadu_ps(b), a0);
+        const __m128 d1 = _mm_sub_ps(_mm_loadu_ps(b + 4), a1);
+        d0 = _mm_sub_ps(d0, _mm_and_ps(_mm_cmpgt_ps(d0, pi), twoPi));
+        d0 = _mm_add_ps(d0, _mm_and_ps(_mm_cmplt_ps(d0, minusPi), twoPi));
+        _mm_storeu_ps(out, _mm_add_ps(a0, _mm_mul_ps(d0, t)));
+        _mm_storeu_ps(out + 4, _mm_add_ps(a1, _mm_mul_ps(d1, t)));
+    }
+}
+
+// ---- AVX2 + FMA（8 インスタンス単位、端数は SSE2 版で処理） ----
+
+SIMD_TARGET_AVX2 void UpdateTransformsAVX2(const InstanceStreams& s, uint32_t begin, uint32_t end, const InstanceUpdateParams& params)
+{
+    const __m256 dt = _mm256_set1_ps(params.deltaTime);
+    const __m256 maxBounds = _mm256_set1_ps(params.bounds);
+    const __m256 minBounds = _mm256_set1_ps(-params.bounds);
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const __m256 pi = _mm256_set1_ps(PI);
+    const __m256 minusPi = _mm256_set1_ps(-PI);
+    const __m256 twoPi = _mm256_set1_ps(TWO_PI);
+
+    uint32_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 vx = _mm256_loadu_ps(s.velocityX + i);
+        __m256 vy = _mm256_loadu_ps(s.velocityY + i);
+        __m256 x = _mm256_fmadd_ps(vx, dt, _mm256_loadu_ps(s.positionX + i));
+        __m256 y = _mm256_fmadd_ps(vy, dt, _mm256_loadu_ps(s.positionY + i));
+        const __m256 outX = _mm256_or_ps(_mm256_cmp_ps(x, minBounds, _CMP_LT_OQ), _mm256_cmp_ps(x, maxBounds, _CMP_GT_OQ));
+        const __m256 outY = _mm256_or_ps(_mm256_cmp_ps(y, minBounds, _CMP_LT_OQ), _mm256_cmp_ps(y, maxBounds, _CMP_GT_OQ));
+        vx = _mm256_xor_ps(vx, _mm256_and_ps(outX, signMask));
+        vy = _mm256_xor_ps(vy, _mm256_and_ps(outY, signMask));
+        x = _mm256_min_ps(_mm256_max_ps(x, minBounds), maxBounds);
+        y = _mm256_min_ps(_mm256_max_ps(y, minBounds), maxBounds);
+        _mm256_storeu_ps(s.velocityX + i, vx);
+        _mm256_storeu_ps(s.velocityY + i, vy);
+        _mm256_storeu_ps(s.positionX + i, x);
+        _mm256_storeu_ps(s.positionY + i, y);
+
+        __m256 angle = _mm256_fmadd_ps(_mm256_loadu_ps(s.angularVelocity + i), dt, _mm256_loadu_ps(s.rotation + i));
+        angle = _mm256_sub_ps(angle, _mm256_and_ps(_mm256_cmp_ps(angle, pi, _CMP_GT_OQ), twoPi));
+        angle = _mm256_add_ps(angle, _mm256_and_ps(_mm256_cmp_ps(angle, minusPi, _CMP_LT_OQ), twoPi));
+        _mm256_storeu_ps(s.rotation + i, angle);
+    }
+    UpdateTransformsSSE2(s, i, end, params);
+}
+
+SIMD_TARGET_AVX2 void UpdateColorsAVX2(const InstanceStreams& s, uint32_t begin, uint32_t end, const InstanceUpdateParams& params)
+{
+    const __m256 pulseTime = _mm256_set1_ps(params.pulseTime);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 two = _mm256_set1_ps(2.0f);
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 pulseMin = _mm256_set1_ps(PULSE_MIN);
+    const __m256 pulseRange = _mm256_set1_ps(PULSE_RANGE);
+
+    uint32_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 t = _mm256_add_ps(_mm256_loadu_ps(s.phase + i), pulseTime);
+        t = _mm256_sub_ps(t, _mm256_and_ps(_mm256_cmp_ps(t, one, _CMP_GE_OQ), one));
+        const __m256 wave = _mm256_and_ps(_mm256_sub_ps(_mm256_mul_ps(two, t), one), absMask);
+        const __m256 brightness = _mm256_add_ps(pulseMin, _mm256_mul_ps(pulseRange, wave));
+        _mm256_storeu_ps(s.colorR + i, _mm256_mul_ps(_mm256_loadu_ps(s.baseColorR + i), brightness));
+        _mm256_storeu_ps(s.colorG + i, _mm256_mul_ps(_mm256_loadu_ps(s.baseColorG + i), brightness));
+        _mm256_storeu_ps(s.colorB + i, _mm256_mul_ps(_mm256_loadu_ps(s.baseColorB + i), brightness));
+    }
+    UpdateColorsSSE2(s, i, end, params);
+}
+
+// 8 インスタンス × 8 属性を 8x8 転置し、1 インスタンス 32 バイト（= 1 レジスタ）単位で書き出す
+SIMD_TARGET_AVX2 void PackInstancesAVX2(const InstanceStreams& s, uint32_t begin, uint32_t end, InstanceGpuData* output)
+{
+    const __m256 one = _mm256_set1_ps(1.0f);
+    float* out = reinterpret_cast<float*>(output);
+    uint32_t i = begin;
+    for (; i + 8 <= end; i += 8, out += 64) {
+        const __m256 row0 = _mm256_loadu_ps(s.positionX + i);
+        const __m256 row1 = _mm256_loadu_ps(s.positionY + i);
+        const __m256 row2 = _mm256_loadu_ps(s.rotation + i);
+        const __m256 row3 = _mm256_loadu_ps(s.scale + i);
+        const __m256 row4 = _mm256_loadu_ps(s.colorR + i);
+        const __m256 row5 = _mm256_loadu_ps(s.colorG + i);
+        const __m256 row6 = _mm256_loadu_ps(s.colorB + i);
+        const __m256 row7 = one;
+
+        const __m256 t0 = _mm256_unpacklo_ps(row0, row1);
+        const __m256 t1 = _mm256_unpackhi_ps(row0, row1);
+        const __m256 t2 = _mm256_unpacklo_ps(row2, row3);
+        const __m256 t3 = _mm256_unpackhi_ps(row2, row3);
+        const __m256 t4 = _mm256_unpacklo_ps(row4, row5);
+        const __m256 t5 = _mm256_unpackhi_ps(row4, row5);
+        const __m256 t6 = _mm256_unpacklo_ps(row6, row7);
+        const __m256 t7 = _mm256_unpackhi_ps(row6, row7);
+        const __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+        _mm256_storeu_ps(out + 0, _mm256_permute2f128_ps(u0, u4, 0x20));
+        _mm256_storeu_ps(out + 8, _mm256_permute2f128_ps(u1, u5, 0x20));
+        _mm256_storeu_ps(out + 16, _mm256_permute2f128_ps(u2, u6, 0x20));
+        _mm256_storeu_ps(out + 24, _mm256_permute2f128_ps(u3, u7, 0x20));
+        _mm256_storeu_ps(out + 32, _mm256_permute2f128_ps(u0, u4, 0x31));
+        _mm256_storeu_ps(out + 40, _mm256_permute2f128_ps(u1, u5, 0x31));
+        _mm256_storeu_ps(out + 48, _mm256_permute2f128_ps(u2, u6, 0x31));
+        _mm256_storeu_ps(out + 56, _mm256_permute2f128_ps(u3, u7, 0x31));
+    }
+    PackInstancesSSE2(s, i, end, output + (i - begin));
+}
+
+// 1 インスタンス = 1 レジスタ（32 バイト）
+SIMD_TARGET_AVX2 void InterpolateInstancesAVX2(const InstanceGpuData* previous, const InstanceGpuData* current, uint32_t begin, uint32_t end, float alpha, InstanceGpuData* output)
+{
+    const __m256 t = _mm256_set1_ps(alpha);
+    const __m256 rotationLane = _mm256_castsi256_ps(_mm256_set_epi32(0, 0, 0, 0, 0, -1, 0, 0));
+    const __m256 pi = _mm256_set1_ps(PI);
+    const __m256 minusPi = _mm256_set1_ps(-PI);
+    const __m256 twoPi = _mm256_and_ps(_mm256_set1_ps(TWO_PI), rotationLane);
+    const float* a = reinterpret_cast<const float*>(previous + begin);
+    const float* b = reinterpret_cast<const float*>(current + begin);
+    float* out = reinterpret_cast<float*>(output);
+    for (uint32_t i = begin; i < end; ++i, a += 8, b += 8, out += 8) {
+        const __m256 va = _mm256_loadu_ps(a);
+        __m256 d = _mm256_sub_ps(_mm256_loadu_ps(b), va);
+        d = _mm256_sub_ps(d, _mm256_and_ps(_mm256_cmp_ps(d, pi, _CMP_GT_OQ), twoPi));
+        d = _mm256_add_ps(d, _mm256_and_ps(_mm256_cmp_ps(d, minusPi, _CMP_LT_OQ), twoPi));
+        _mm256_storeu_ps(out, _mm256_fmadd_ps(d, t, va));
+    }
+}
+
+#endif // SIMD_X86
+
+const InstanceKernelTable SCALAR_KERNELS = { SimdLevel::Scalar, UpdateTransformsScalar, UpdateColorsScalar, PackInstancesScalar, InterpolateInstancesScalar };
+#if SIMD_X86
+const InstanceKernelTable SSE2_KERNELS = { SimdLevel::SSE2, UpdateTransformsSSE2, UpdateColorsSSE2, PackInstancesSSE2, InterpolateInstancesSSE2 };
+const InstanceKernelTable AVX2_KERNELS = { SimdLevel::AVX2, UpdateTransformsAVX2, UpdateColorsAVX2, PackInstancesAVX2, InterpolateInstancesAVX2 };
+#endif
+
+} // namespace
+
+const InstanceKernelTable& GetInstanceKernels(SimdLevel level)
+{
+    if (level > GetSupportedSimdLevel()) {
+        level = GetSupportedSimdLevel();
+    }
+#if SIMD_X86
+    switch (level) {
+    case SimdLevel::AVX2:
+        return AVX2_KERNELS;
+    case SimdLevel::SSE2:
+        return SSE2_KERNELS;
+    case SimdLevel::Scalar:
+        break;
+    }
+#endif
+    return SCALAR_KERNELS;
+}
@@ -0,0 +1,31 @@
+﻿#pragma once
+
+#include <cstdint>
+#include "../Core/CpuFeatures.h"
+#include "InstanceStorage.h"
+
+// 1 回の更新に共通するパラメータ
+struct InstanceUpdateParams {
+    float deltaTime = 0.0f;
+    float bounds = 1.0f;     // 位置の範囲 [-bounds, bounds]。外に出た成分は速度を反転する
+    float pulseTime = 0.0f;  // 明滅のアニメーション時刻 [0, 1)
+};
+
+// [begin, end) のインスタンスを更新するカーネル
+using InstanceUpdateKernel = void (*)(const InstanceStreams& streams, uint32_t begin, uint32_t end, const InstanceUpdateParams& params);
+// [begin, end) のインスタンスを output[0 ～ end-begin) へ GPU 形式で書き出すカーネル
+using InstancePackKernel = void (*)(const InstanceStreams& streams, uint32_t begin, uint32_t end, InstanceGpuData* output);
+// previous と current の [begin, end) を alpha (0 = previous, 1 = current) で補間して output[0 ～ end-begin) へ書き出すカーネル
+using InstanceInterpolateKernel = void (*)(const InstanceGpuData* previous, const InstanceGpuData* current, uint32_t begin, uint32_t end, float alpha, InstanceGpuData* output);
+
+// 同じ命令セットで実装したカーネルの組
+struct InstanceKernelTable {
+    SimdLevel level = SimdLevel::Scalar;
+    InstanceUpdateKernel updateTransforms = nullptr; // 位置の移動と反射、回転
+    InstanceUpdateKernel updateColors = nullptr;     // 位相に応じた色の明滅
+    InstancePackKernel packInstances = nullptr;      // SoA -> InstanceGpuData への転置
+    InstanceInterpolateKernel interpolateInstances = nullptr; // 2 つのスナップショット間の補間
+};
+
+// level の実装を返す。CPU がサポートしないレベルを指定した場合はサポートする最上位のレベルに落とす。
+const InstanceKernelTable& GetInstanceKernels(SimdLevel level);
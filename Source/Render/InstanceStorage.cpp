@@ -0,0 +1,80 @@
+﻿#include "InstanceStorage.h"
+#include <cassert>
+
+void InstanceStorage::Reserve(uint32_t capacity)
+{
+    AlignedVector<float>* streams[STREAM_COUNT];
+    GetAllStreams(streams);
+    for (AlignedVector<float>* stream : streams) {
+        stream->reserve(capacity);
+    }
+}
+
+uint32_t InstanceStorage::Add(const InstanceDesc& desc)
+{
+    const uint32_t index = GetCount();
+    positionX.push_back(desc.positionX);
+    positionY.push_back(desc.positionY);
+    velocityX.push_back(desc.velocityX);
+    velocityY.push_back(desc.velocityY);
+    rotation.push_back(desc.rotation);
+    angularVelocity.push_back(desc.angularVelocity);
+    scale.push_back(desc.scale);
+    baseColorR.push_back(desc.colorR);
+    baseColorG.push_back(desc.colorG);
+    baseColorB.push_back(desc.colorB);
+    colorR.push_back(desc.colorR);
+    colorG.push_back(desc.colorG);
+    colorB.push_back(desc.colorB);
+    phase.push_back(desc.phase);
+    return index;
+}
+
+void InstanceStorage::Remove(uint32_t index)
+{
+    assert(index < GetCount());
+    AlignedVector<float>* streams[STREAM_COUNT];
+    GetAllStreams(streams);
+    for (AlignedVector<float>* stream : streams) {
+        (*stream)[index] = stream->back();
+        stream->pop_back();
+    }
+}
+
+void InstanceStorage::Clear()
+{
+    AlignedVector<float>* streams[STREAM_COUNT];
+    GetAllStreams(streams);
+    for (AlignedVector<float>* stream : streams) {
+        stream->clear();
+    }
+}
+
+InstanceStreams InstanceStorage::GetStreams()
+{
+    InstanceStreams streams;
+    streams.positionX = positionX.data();
+    streams.positionY = positionY.data();
+    streams.velocityX = velocityX.data();
+    streams.velocityY = velocityY.data();
+    streams.rotation = rotation.data();
+    streams.angularVelocity = angularVelocity.data();
+    streams.scale = scale.data();
+    streams.baseColorR = baseColorR.data();
+    streams.baseColorG = baseColorG.data();
+    streams.baseColorB = baseColorB.data();
+    streams.colorR = colorR.data();
+    streams.colorG = colorG.data();
+    streams.colorB = colorB.data();
+    streams.phase = phase.data();
+    return streams;
+}
+
+void InstanceStorage::GetAllStreams(AlignedVector<float>* (&streams)[STREAM_COUNT])
+{
+    AlignedVector<float>* const all[STREAM_COUNT] = { &positionX, &positionY, &velocityX, &velocityY, &rotation, &angularVelocity, &scale,
+                                                      &baseColorR, &baseColorG, &baseColorB, &colorR, &colorG, &colorB, &phase };
+    for (uint32_t i = 0; i < STREAM_COUNT; ++i) {
+        streams[i] = all[i];
+    }
+}
@@ -0,0 +1,86 @@
+﻿#pragma once
+
+#include <cstdint>
+#include "../Core/AlignedAllocator.h"
+
+// GPU のインスタンスバッファ 1 要素分（頂点シェーダの PER_INSTANCE 入力と一致させる）
+struct InstanceGpuData {
+    float positionX;
+    float positionY;
+    float rotation;
+    float scale;
+    float colorR;
+    float colorG;
+    float colorB;
+    float colorA;
+};
+static_assert(sizeof(InstanceGpuData) == 32, "instance data must match the input layout stride");
+
+// SoA 配列への生ポインタ。カーネルはこのビューを通して [begin, end) の範囲を更新する。
+struct InstanceStreams {
+    float* positionX = nullptr;
+    float* positionY = nullptr;
+    float* velocityX = nullptr;
+    float* velocityY = nullptr;
+    float* rotation = nullptr;
+    float* angularVelocity = nullptr;
+    float* scale = nullptr;
+    float* baseColorR = nullptr; // 生成時の色
+    float* baseColorG = nullptr;
+    float* baseColorB = nullptr;
+    float* colorR = nullptr; // UpdateColors で計算する現在の色
+    float* colorG = nullptr;
+    float* colorB = nullptr;
+    float* phase = nullptr; // 明滅の位相 [0, 1)
+};
+
+// 1 インスタンス分の初期値
+struct InstanceDesc {
+    float positionX = 0.0f;
+    float positionY = 0.0f;
+    float velocityX = 0.0f;
+    float velocityY = 0.0f;
+    float rotation = 0.0f;
+    float angularVelocity = 0.0f;
+    float scale = 1.0f;
+    float colorR = 1.0f;
+    float colorG = 1.0f;
+    float colorB = 1.0f;
+    float phase = 0.0f;
+};
+
+// インスタンスの属性を属性ごとの連続配列（SoA）で保持する。
+// 各配列は 32 バイト境界にそろえるため、SIMD カーネルが同じ属性を連続してロードできる。
+class InstanceStorage {
+public:
+    void Reserve(uint32_t capacity);
+    // 戻り値: 追加したインスタンスのインデックス
+    uint32_t Add(const InstanceDesc& desc);
+    // 末尾の要素と入れ替えて削除する（インデックスの順序は保持しない）
+    void Remove(uint32_t index);
+    void Clear();
+
+    uint32_t GetCount() const { return static_cast<uint32_t>(positionX.size()); }
+    // 戻り値: 現在の配列へのポインタ（Add/Remove/Reserve で無効になる）
+    InstanceStreams GetStreams();
+
+private:
+    static constexpr uint32_t STREAM_COUNT = 14;
+    // Reserve/Remove/Clear ですべての配列を同じように扱うための一覧
+    void GetAllStreams(AlignedVector<float>* (&streams)[STREAM_COUNT]);
+
+    AlignedVector<float> positionX;
+    AlignedVector<float> positionY;
+    AlignedVector<float> velocityX;
+    AlignedVector<float> velocityY;
+    AlignedVector<float> rotation;
+    AlignedVector<float> angularVelocity;
+    AlignedVector<float> scale;
+    AlignedVector<float> baseColorR;
+    AlignedVector<float> baseColorG;
+    AlignedVector<float> baseColorB;
+    AlignedVector<float> colorR;
+    AlignedVector<float> colorG;
+    AlignedVector<float> colorB;
+    AlignedVector<float> phase;
+};
@@ -0,0 +1,142 @@
+﻿#include "InstancedBatchRenderer.h"
+#include "../Core/JobSystem.h"
+#include "../Core/Profiler.h"
+#include <cmath>
+
+// 引数:
+//  - jobs: 更新と書き出しに使用するジョブシステム
+//  - level: カーネルの命令セット（GetSupportedSimdLevel() を超える場合は下げる）
+void InstancedBatchRenderer::Initialize(JobSystem* jobs, SimdLevel level)
+{
+    jobSystem = jobs;
+    kernels = &GetInstanceKernels(level);
+    batches.clear();
+    pulseTime = 0.0f;
+    lastState.clear();
+    lastBatchCounts.clear();
+    lastStateTimeNs = 0;
+}
+
+void InstancedBatchRenderer::SetSimdLevel(SimdLevel level)
+{
+    kernels = &GetInstanceKernels(level);
+}
+
+InstanceBatchId InstancedBatchRenderer::CreateBatch(const InstanceBatchDesc& desc)
+{
+    batches.push_back(Batch{ desc, {} });
+    return static_cast<InstanceBatchId>(batches.size() - 1);
+}
+
+// 変換と色のカーネルを同じジョブで続けて実行し、範囲内のデータがキャッシュにあるうちに処理する
+void InstancedBatchRenderer::Update(float deltaTime)
+{
+    pulseTime += deltaTime * PULSE_FREQUENCY;
+    pulseTime -= std::floor(pulseTime);
+    InstanceUpdateParams params;
+    params.deltaTime = deltaTime;
+    params.bounds = bounds;
+    params.pulseTime = pulseTime;
+
+    const InstanceKernelTable& table = *kernels;
+    for (Batch& batch : batches) {
+        const InstanceStreams streams = batch.instances.GetStreams();
+        jobSystem->ParallelFor(batch.instances.GetCount(), INSTANCES_PER_JOB, [&](uint32_t begin, uint32_t end) {
+            PROFILE_SCOPE("UpdateInstances");
+            table.updateTransforms(streams, begin, end, params);
+            table.updateColors(streams, begin, end, params);
+        });
+    }
+}
+
+// 前回の状態はスナップショットのバッファと交換して渡し、コピーは今回の状態の 1 回だけにする。
+// インスタンスの追加/削除で並びが変わった場合は補間できないため、previous にも今回の状態を入れる。
+void InstancedBatchRenderer::WriteSnapshot(InstanceSnapshot& snapshot, uint64_t timeNs)
+{
+    PROFILE_SCOPE("WriteSnapshot");
+    snapshot.batchCounts.clear();
+    for (const Batch& batch : batches) {
+        snapshot.batchCounts.push_back(batch.instances.GetCount());
+    }
+    snapshot.current.resize(GetInstanceCount());
+
+    const InstanceKernelTable& table = *kernels;
+    InstanceGpuData* output = snapshot.current.data();
+    for (Batch& batch : batches) {
+        const InstanceStreams streams = batch.instances.GetStreams();
+        jobSystem->ParallelFor(batch.instances.GetCount(), INSTANCES_PER_JOB, [&](uint32_t begin, uint32_t end) {
+            table.packInstances(streams, begin, end, output + begin);
+        });
+        output += batch.instances.GetCount();
+    }
+
+    if (snapshot.batchCounts == lastBatchCounts) {
+        snapshot.previous.swap(lastState);
+        snapshot.previousTimeNs = lastStateTimeNs;
+    }
+    else {
+        snapshot.previous = snapshot.current;
+        snapshot.previousTimeNs = timeNs;
+    }
+    snapshot.currentTimeNs = timeNs;
+    lastState = snapshot.current;
+    lastBatchCounts = snapshot.batchCounts;
+    lastStateTimeNs = timeNs;
+}
+
+// 全バッチ分の領域を 1 回で確保し、バッチを連続して配置する。
+// 書き込み先は UPLOAD ヒープ（ライトコンバイン）を想定し、先頭から順に書き出すだけで読み戻さない。
+bool InstancedBatchRenderer::WriteDrawItems(const InstanceSnapshot& snapshot, float alpha, const AllocateFunction& allocate, std::vector<DrawItem>& drawItems)
+{
+    const uint32_t instanceCount = static_cast<uint32_t>(snapshot.current.size());
+    if (instanceCount == 0) {
+        return true;
+    }
+    FrameAllocation allocation;
+    if (!allocate(static_cast<uint64_t>(instanceCount) * sizeof(InstanceGpuData), allocation)) {
+        return false;
+    }
+
+    const InstanceKernelTable& table = *kernels;
+    const InstanceGpuData* previous = snapshot.previous.data();
+    const InstanceGpuData* current = snapshot.current.data();
+    auto* output = static_cast<InstanceGpuData*>(allocation.cpuAddress);
+    uint64_t gpuAddress = allocation.gpuAddress;
+    for (size_t batchIndex = 0; batchIndex < snapshot.batchCounts.size(); ++batchIndex) {
+        const uint32_t count = snapshot.batchCounts[batchIndex];
+        if (count == 0) {
+            continue;
+        }
+        jobSystem->ParallelFor(count, INSTANCES_PER_JOB, [&](uint32_t begin, uint32_t end) {
+            PROFILE_SCOPE("InterpolateInstances");
+            table.interpolateInstances(previous, current, begin, end, alpha, output + begin);
+        });
+
+        const InstanceBatchDesc& desc = batches[batchIndex].desc;
+        DrawItem draw;
+        draw.pipeline = desc.pipeline;
+        draw.topology = desc.topology;
+        draw.vertexBuffer = desc.mesh;
+        draw.instanceBuffer.gpuAddress = gpuAddress;
+        draw.instanceBuffer.sizeInBytes = count * static_cast<uint32_t>(sizeof(InstanceGpuData));
+        draw.instanceBuffer.strideInBytes = sizeof(InstanceGpuData);
+        draw.vertexCount = desc.vertexCount;
+        draw.instanceCount = count;
+        drawItems.push_back(draw);
+
+        previous += count;
+        current += count;
+        output += count;
+        gpuAddress += static_cast<uint64_t>(count) * sizeof(InstanceGpuData);
+    }
+    return true;
+}
+
+uint32_t InstancedBatchRenderer::GetInstanceCount() const
+{
+    uint32_t count = 0;
+    for (const Batch& batch : batches) {
+        count += batch.instances.GetCount();
+    }
+    return count;
+}
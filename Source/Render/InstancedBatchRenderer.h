@@ -0,0 +1,89 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "../Core/AlignedAllocator.h"
+#include "../Core/CpuFeatures.h"
+#include "InstanceKernels.h"
+#include "InstanceStorage.h"
+#include "ParallelCommandRecorder.h"
+#include "RenderBackend.h"
+
+class JobSystem;
+
+using InstanceBatchId = uint32_t;
+
+// マテリアル（パイプライン + メッシュ）ごとのバッチ。1 バッチを 1 回の DrawInstanced で描画する。
+struct InstanceBatchDesc {
+    PipelineId pipeline = 0;
+    PrimitiveTopology topology = PrimitiveTopology::TriangleList;
+    VertexBufferView mesh; // スロット 0（頂点ごとのデータ）
+    uint32_t vertexCount = 0;
+};
+
+// シミュレーションから描画へ渡すインスタンスの状態（GPU 形式、全バッチをバッチ順に連続して配置）。
+// 描画側は previous と current を時刻で補間して書き出す。
+struct InstanceSnapshot {
+    AlignedVector<InstanceGpuData> previous; // previousTimeNs の状態（current と同じ並び）
+    AlignedVector<InstanceGpuData> current;
+    std::vector<uint32_t> batchCounts;       // バッチごとのインスタンス数
+    uint64_t previousTimeNs = 0;
+    uint64_t currentTimeNs = 0;
+};
+
+// インスタンスを SoA で保持し、SIMD カーネルで更新して GPU 形式のインスタンスバッファへ書き出す。
+// Update/WriteSnapshot（シミュレーション側）と WriteDrawItems（描画側）はどれもジョブシステム上で
+// 範囲を分割して並列に実行する。描画側はスナップショットだけを参照するため、両者は別スレッドで実行できる。
+// バッチの作成はシミュレーションの開始前に行うこと。
+class InstancedBatchRenderer {
+public:
+    // size バイトの領域を確保する関数。確保できない場合は false を返す。
+    using AllocateFunction = std::function<bool(uint64_t size, FrameAllocation& allocation)>;
+
+    // 1 ジョブで処理するインスタンス数の目安
+    static constexpr uint32_t INSTANCES_PER_JOB = 16384;
+    // 明滅の速さ（1 秒あたりの周期数）
+    static constexpr float PULSE_FREQUENCY = 0.5f;
+
+    // jobs: 更新を実行するジョブシステム（所有しない）
+    // level: 使用するカーネルの命令セット（サポート外の場合は自動的に下げる）
+    void Initialize(JobSystem* jobs, SimdLevel level = GetSupportedSimdLevel());
+    // カーネルの命令セットを切り替える（比較計測用）
+    void SetSimdLevel(SimdLevel level);
+
+    InstanceBatchId CreateBatch(const InstanceBatchDesc& desc);
+    InstanceStorage& GetInstances(InstanceBatchId batch) { return batches[batch].instances; }
+
+    // 全インスタンスの位置/回転/色を deltaTime 秒ぶん進める
+    void Update(float deltaTime);
+
+    // 現在の状態を timeNs の状態として snapshot.current へ書き出し、前回書き出した状態を snapshot.previous に設定する
+    void WriteSnapshot(InstanceSnapshot& snapshot, uint64_t timeNs);
+
+    // snapshot を alpha (0 = previous, 1 = current) で補間して allocate で確保した領域へ書き出し、
+    // バッチごとの描画アイテムを drawItems に追加する。
+    // 戻り値: 領域を確保できずに描画を省略した場合は false
+    bool WriteDrawItems(const InstanceSnapshot& snapshot, float alpha, const AllocateFunction& allocate, std::vector<DrawItem>& drawItems);
+
+    void SetBounds(float value) { bounds = value; }
+    SimdLevel GetSimdLevel() const { return kernels->level; }
+    uint32_t GetBatchCount() const { return static_cast<uint32_t>(batches.size()); }
+    uint32_t GetInstanceCount() const;
+
+private:
+    struct Batch {
+        InstanceBatchDesc desc;
+        InstanceStorage instances;
+    };
+
+    JobSystem* jobSystem = nullptr;
+    const InstanceKernelTable* kernels = nullptr;
+    std::vector<Batch> batches;
+    float bounds = 1.0f;
+    float pulseTime = 0.0f;
+    // 前回 WriteSnapshot で書き出した状態（次のスナップショットの previous になる）
+    AlignedVector<InstanceGpuData> lastState;
+    std::vector<uint32_t> lastBatchCounts;
+    uint64_t lastStateTimeNs = 0;
+};
@@ -0,0 +1,77 @@
+﻿#include "LinearRingAllocator.h"
+#include <cassert>
+
+void LinearRingAllocator::Initialize(uint64_t ringCapacity)
+{
+    capacity = ringCapacity;
+    head = 0;
+    tail = 0;
+    usedSize = 0;
+    currentFrameSize = 0;
+    frames.clear();
+}
+
+// head から tail までが空き領域。head >= tail の場合は [head, capacity) と [0, tail) の 2 区間になる。
+// 折り返したときに末尾で捨てた領域も、そのフレームの使用量として解放まで保持する。
+uint64_t LinearRingAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+    assert(alignment != 0 && (alignment & (alignment - 1)) == 0);
+    if (size == 0 || size > capacity) {
+        return INVALID_OFFSET;
+    }
+
+    const bool empty = usedSize == 0;
+    const uint64_t alignedHead = AlignUp(head, alignment);
+    uint64_t offset = INVALID_OFFSET;
+    uint64_t consumed = 0;
+
+    if (empty || head > tail) {
+        if (alignedHead + size <= capacity) {
+            offset = alignedHead;
+            consumed = alignedHead + size - head;
+        }
+        else if (size <= tail || (empty && size <= capacity)) {
+            // 末尾の残りを捨てて先頭へ折り返す
+            offset = 0;
+            consumed = capacity - head + size;
+        }
+    }
+    else if (head < tail && alignedHead + size <= tail) {
+        offset = alignedHead;
+        consumed = alignedHead + size - head;
+    }
+
+    if (offset == INVALID_OFFSET) {
+        return INVALID_OFFSET;
+    }
+    if (empty) {
+        // 空のときは tail を割り当て位置にそろえ、捨てた領域を使用量に含めない
+        tail = offset;
+        consumed = size;
+    }
+    head = offset + size;
+    if (head == capacity) {
+        head = 0;
+    }
+    usedSize += consumed;
+    currentFrameSize += consumed;
+    return offset;
+}
+
+void LinearRingAllocator::FinishFrame(uint64_t fenceValue)
+{
+    if (currentFrameSize == 0) {
+        return;
+    }
+    frames.push_back({ fenceValue, head, currentFrameSize });
+    currentFrameSize = 0;
+}
+
+void LinearRingAllocator::Retire(uint64_t completedFenceValue)
+{
+    while (!frames.empty() && frames.front().fenceValue <= completedFenceValue) {
+        tail = frames.front().endOffset;
+        usedSize -= frames.front().size;
+        frames.pop_front();
+    }
+}
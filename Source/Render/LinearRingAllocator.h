@@ -0,0 +1,49 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <deque>
+
+// 固定容量の領域を先頭から順に切り出すリングアロケータ。
+// 割り当てはフレーム（フェンス値）単位でまとめて解放し、GPU が参照し終えた領域だけを再利用する。
+// オフセット計算のみを行うため、アップロードバッファやディスクリプタヒープなど任意の領域に使用できる。
+class LinearRingAllocator {
+public:
+    static constexpr uint64_t INVALID_OFFSET = UINT64_MAX;
+
+    void Initialize(uint64_t ringCapacity);
+
+    // size バイトを alignment 境界で割り当てる（alignment は 2 のべき乗）。
+    // 末尾に収まらない場合は先頭へ折り返す。
+    // 戻り値: 領域の先頭オフセット。空きが足りない場合は INVALID_OFFSET
+    uint64_t Allocate(uint64_t size, uint64_t alignment);
+
+    // ここまでの割り当てを fenceValue のフレームに属するものとして締める
+    void FinishFrame(uint64_t fenceValue);
+    // completedFenceValue 以下のフェンス値を持つフレームの領域を解放する
+    void Retire(uint64_t completedFenceValue);
+
+    uint64_t GetCapacity() const { return capacity; }
+    // 未解放の使用量（折り返しやアライメントで捨てた領域を含む）
+    uint64_t GetUsedSize() const { return usedSize; }
+    // 解放待ちのフレーム数
+    uint32_t GetPendingFrameCount() const { return static_cast<uint32_t>(frames.size()); }
+
+private:
+    struct FrameMarker {
+        uint64_t fenceValue;
+        uint64_t endOffset;
+        uint64_t size;
+    };
+
+    uint64_t capacity = 0;
+    uint64_t head = 0; // 次に割り当てる位置
+    uint64_t tail = 0; // 最も古い未解放領域の先頭
+    uint64_t usedSize = 0;
+    uint64_t currentFrameSize = 0;
+    std::deque<FrameMarker> frames;
+};
+
+inline constexpr uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
@@ -0,0 +1,42 @@
+﻿#include "NullGpuParticleSimulator.h"
+#include "LinearRingAllocator.h"
+
+void NullGpuParticleSimulator::Create(QueueDependencyScheduler* queueScheduler, uint64_t bufferGpuBase)
+{
+    scheduler = queueScheduler;
+    gpuBase = bufferGpuBase;
+    particleCount = 0;
+    for (QueueSyncPoint& point : slotReadSyncPoints) {
+        point = {};
+    }
+}
+
+// 状態は保持しない（インスタンスバッファのアドレスを決めるために粒子数だけを使う）
+void NullGpuParticleSimulator::Initialize(const ParticleSystem& initialState)
+{
+    particleCount = initialState.GetParticleCount();
+    instanceBufferStride = AlignUp(static_cast<uint64_t>(particleCount) * sizeof(InstanceGpuData), 256);
+}
+
+// D3D12ParticleSimulator::Simulate と同じ依存で投入する。
+//  - コンピュート: スロットのバッファを前回読んだ描画の完了を待つ（通常は BeginFrame で完了済みのため省略される）
+//  - 描画: 今回の更新の完了を、次の描画の投入（SubmitAndPresent）で待つ
+VertexBufferView NullGpuParticleSimulator::Simulate(uint32_t frameSlot, const ParticleSimulationParams&, const ParticleAppearance&)
+{
+    RecordingCommandList& commandList = commandLists[frameSlot];
+    commandList.Begin(frameSlot);
+    commandList.Dispatch((particleCount + THREAD_GROUP_SIZE - 1) / THREAD_GROUP_SIZE, 1, 1);
+    commandList.End();
+
+    ICommandList* lists[] = { &commandList };
+    const QueueSyncPoint previousRead = slotReadSyncPoints[frameSlot];
+    const QueueSyncPoint simulated = scheduler->Submit(GpuQueueType::Compute, lists, 1, &previousRead, 1);
+    scheduler->AddPendingWait(GpuQueueType::Graphics, simulated);
+    slotReadSyncPoints[frameSlot] = scheduler->GetNextSyncPoint(GpuQueueType::Graphics);
+
+    VertexBufferView view;
+    view.gpuAddress = gpuBase + instanceBufferStride * frameSlot;
+    view.sizeInBytes = particleCount * static_cast<uint32_t>(sizeof(InstanceGpuData));
+    view.strideInBytes = sizeof(InstanceGpuData);
+    return view;
+}
@@ -0,0 +1,33 @@
+﻿#pragma once
+
+#include <cstdint>
+#include "FrameScheduler.h"
+#include "ParticleSystem.h"
+#include "QueueDependencyScheduler.h"
+#include "RecordingCommandList.h"
+
+// ヌルバックエンドの非同期コンピュート。粒子の計算は行わず、D3D12 版と同じ手順で
+// ディスパッチを記録してコンピュートキューへ投入し、キュー間の依存をスケジューラで解決する。
+// GPU のない環境で、投入とフェンス待ちの CPU 側の経路と依存の正しさ（デッドロックしないこと）を検証するために使う。
+class NullGpuParticleSimulator : public IGpuParticleSimulator {
+public:
+    // 1 スレッドグループで更新する粒子数（D3D12 版のコンピュートシェーダと同じ）
+    static constexpr uint32_t THREAD_GROUP_SIZE = 256;
+
+    // scheduler: 描画/コンピュートのキューを登録済みのスケジューラ（所有しない）
+    // bufferGpuBase: インスタンスバッファに割り当てる仮想 GPU アドレスの先頭
+    void Create(QueueDependencyScheduler* queueScheduler, uint64_t bufferGpuBase);
+
+    void Initialize(const ParticleSystem& initialState) override;
+    VertexBufferView Simulate(uint32_t frameSlot, const ParticleSimulationParams& params, const ParticleAppearance& appearance) override;
+    uint32_t GetParticleCount() const override { return particleCount; }
+    const QueueSchedulerStats& GetQueueStats() const override { return scheduler->GetStats(); }
+
+private:
+    QueueDependencyScheduler* scheduler = nullptr;
+    RecordingCommandList commandLists[MAX_FRAMES_IN_FLIGHT]; // フレームスロットごと
+    QueueSyncPoint slotReadSyncPoints[MAX_FRAMES_IN_FLIGHT]; // スロットのインスタンスバッファを最後に読む描画の完了点
+    uint64_t gpuBase = 0;
+    uint64_t instanceBufferStride = 0;
+    uint32_t particleCount = 0;
+};
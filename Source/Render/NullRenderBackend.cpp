@@ -0,0 +1,120 @@
+﻿#include "NullRenderBackend.h"
+#include <algorithm>
+
+// 引数:
+//  - jobs: 並列記録に使用するジョブシステム
+//  - width/height: 仮想バックバッファのサイズ（ビューポートの計算に使用）
+//  - framesInFlight: フレームスロット数
+//  - frameMemoryCapacity: フレームメモリ（インスタンスデータなど）のリング容量
+void NullRenderBackend::Initialize(JobSystem* jobs, uint32_t width, uint32_t height, uint32_t framesInFlight, uint64_t frameMemoryCapacity)
+{
+    backBufferWidth = width;
+    backBufferHeight = height;
+    frameScheduler.Initialize(&gpuTimeline, framesInFlight);
+    queueScheduler.Initialize();
+    queueScheduler.SetQueue(GpuQueueType::Graphics, &graphicsQueue);
+    queueScheduler.SetQueue(GpuQueueType::Compute, &computeQueue);
+    particleSimulator.Create(&queueScheduler, PARTICLE_BUFFER_GPU_BASE);
+
+    recordingCommandLists = std::make_unique<RecordingCommandList[]>(RECORDING_COMMAND_LIST_COUNT);
+    std::vector<ICommandList*> lists;
+    for (uint32_t i = 0; i < RECORDING_COMMAND_LIST_COUNT; ++i) {
+        lists.push_back(&recordingCommandLists[i]);
+    }
+    commandRecorder.Initialize(jobs, std::move(lists));
+
+    frameMemory.resize(static_cast<size_t>(frameMemoryCapacity));
+    frameMemoryRing.Initialize(frameMemoryCapacity);
+    transientEntries.clear();
+    transientHeapSize = 0;
+}
+
+// D3D12 バックエンドと同じく、バックバッファごとに別のリソース ID を返す。
+// スロットの前回のフレームを待った時点で、それまでに投入した各キューの作業は完了している
+BackendFrame NullRenderBackend::BeginFrame()
+{
+    BackendFrame frame;
+    frame.frameSlot = frameScheduler.BeginFrame();
+    graphicsQueue.CompleteSubmittedWork();
+    computeQueue.CompleteSubmittedWork();
+    frameMemoryRing.Retire(frameScheduler.GetCompletedFenceValue());
+    frame.backBuffer = backBufferIndex;
+    frame.target.renderTarget = backBufferIndex;
+    frame.target.viewport = { 0.0f, 0.0f, static_cast<float>(backBufferWidth), static_cast<float>(backBufferHeight), 0.0f, 1.0f };
+    frame.target.scissor = { 0, 0, static_cast<int32_t>(backBufferWidth), static_cast<int32_t>(backBufferHeight) };
+    return frame;
+}
+
+bool NullRenderBackend::AllocateFrameMemory(uint64_t size, uint64_t alignment, FrameAllocation& allocation)
+{
+    const uint64_t offset = frameMemoryRing.Allocate(size, alignment);
+    if (offset == LinearRingAllocator::INVALID_OFFSET) {
+        return false;
+    }
+    allocation.cpuAddress = frameMemory.data() + offset;
+    allocation.gpuAddress = FRAME_MEMORY_GPU_BASE + offset;
+    return true;
+}
+
+// 記録済みのコマンドは複製せずに数えるだけにする（次の Begin で破棄される）。
+// 描画キューへの投入はスケジューラを通し、今フレームのコンピュートの更新を待たせる
+void NullRenderBackend::SubmitAndPresent(ICommandList* const* lists, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i) {
+        const auto* recorded = static_cast<const RecordingCommandList*>(lists[i]);
+        executedCommandCount += recorded->GetCommands().size();
+        for (const RecordedCommand& command : recorded->GetCommands()) {
+            if (command.type == RecordedCommandType::DrawInstanced) {
+                ++drawCount;
+            }
+        }
+    }
+    queueScheduler.Submit(GpuQueueType::Graphics, lists, count);
+    ++submitCount;
+    submittedListCount += count;
+
+    const uint64_t fenceValue = frameScheduler.EndFrame();
+    frameMemoryRing.FinishFrame(fenceValue);
+    backBufferIndex = (backBufferIndex + 1) % BACK_BUFFER_COUNT;
+}
+
+void NullRenderBackend::WaitForIdle()
+{
+    frameScheduler.WaitForIdle();
+    graphicsQueue.CompleteSubmittedWork();
+    computeQueue.CompleteSubmittedWork();
+}
+
+// 内容は保持するだけで参照しない（GPU アドレスの重複しない値を返すため）
+uint64_t NullRenderBackend::CreateStaticBuffer(const void* data, uint64_t size)
+{
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    staticBuffers.emplace_back(bytes, bytes + size);
+    const uint64_t address = nextStaticBufferAddress;
+    nextStaticBufferAddress += AlignUp(size, 256);
+    return address;
+}
+
+PipelineId NullRenderBackend::GetBuiltinPipeline(BuiltinPipeline pipeline) const
+{
+    return static_cast<PipelineId>(pipeline) + 1;
+}
+
+// メモリは確保せず、要求ごとに重複しない ID だけを返す（ヒープサイズは最大値を記録する）
+TransientTexture NullRenderBackend::AcquireTransientTexture(const TextureDesc& desc, ResourceState initialState, uint64_t heapOffset, uint64_t heapSize)
+{
+    transientHeapSize = (std::max)(transientHeapSize, heapSize);
+    size_t index = 0;
+    while (index < transientEntries.size()) {
+        const TransientEntry& entry = transientEntries[index];
+        if (entry.desc == desc && entry.initialState == initialState && entry.heapOffset == heapOffset) {
+            break;
+        }
+        ++index;
+    }
+    if (index == transientEntries.size()) {
+        transientEntries.push_back({ desc, initialState, heapOffset });
+    }
+    const ResourceId id = TRANSIENT_RESOURCE_ID_BASE + static_cast<ResourceId>(index);
+    return { id, id, id };
+}
@@ -0,0 +1,88 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "FrameScheduler.h"
+#include "LinearRingAllocator.h"
+#include "NullGpuParticleSimulator.h"
+#include "QueueDependencyScheduler.h"
+#include "RecordingCommandList.h"
+#include "RenderBackend.h"
+
+class JobSystem;
+
+// GPU を使わない IRenderBackend。コマンドは RecordingCommandList に記録して数えるだけで、
+// GPU は投入と同時に完了したものとして扱う。GPU のない環境で CPU 側の経路を計測するために使用する。
+// 描画とコンピュートの 2 つのキューを QueueDependencyScheduler で扱い、キュー間の待機は次の BeginFrame まで未完了として扱う。
+class NullRenderBackend : public IRenderBackend {
+public:
+    static constexpr uint32_t BACK_BUFFER_COUNT = 2;
+    static constexpr uint32_t RECORDING_COMMAND_LIST_COUNT = 8;
+
+    // jobs: 並列記録に使用するジョブシステム（所有しない）
+    void Initialize(JobSystem* jobs, uint32_t width, uint32_t height, uint32_t framesInFlight, uint64_t frameMemoryCapacity);
+
+    const char* GetName() const override { return "null"; }
+    BackendFrame BeginFrame() override;
+    ICommandList& GetFrameBeginCommandList() override { return frameBeginCommandList; }
+    ICommandList& GetFrameEndCommandList() override { return frameEndCommandList; }
+    ParallelCommandRecorder& GetCommandRecorder() override { return commandRecorder; }
+    bool AllocateFrameMemory(uint64_t size, uint64_t alignment, FrameAllocation& allocation) override;
+    uint32_t BeginGpuScope(ICommandList&, const char*) override { return 0; }
+    void EndGpuScope(ICommandList&, uint32_t) override {}
+    void ResolveGpuScopes(ICommandList&) override {}
+    void SubmitAndPresent(ICommandList* const* lists, uint32_t count) override;
+    void WaitForIdle() override;
+    uint64_t CreateStaticBuffer(const void* data, uint64_t size) override;
+    PipelineId GetBuiltinPipeline(BuiltinPipeline pipeline) const override;
+    TransientTexture AcquireTransientTexture(const TextureDesc& desc, ResourceState initialState, uint64_t heapOffset, uint64_t heapSize) override;
+    // コンピュートキューへ投入したコマンドを含む
+    uint64_t GetExecutedCommandCount() const override { return executedCommandCount + computeQueue.GetExecutedCommandCount(); }
+    IGpuParticleSimulator* GetGpuParticleSimulator() override { return &particleSimulator; }
+
+    uint64_t GetSubmitCount() const { return submitCount; }
+    uint64_t GetSubmittedListCount() const { return submittedListCount; }
+    uint64_t GetDrawCount() const { return drawCount; }
+    uint64_t GetTransientHeapSize() const { return transientHeapSize; }
+
+private:
+    // 仮想 GPU アドレス空間の先頭（0 を無効値として扱うため）
+    static constexpr uint64_t FRAME_MEMORY_GPU_BASE = 0x100000000ull;
+    static constexpr uint64_t STATIC_BUFFER_GPU_BASE = 0x800000000ull;
+    static constexpr uint64_t PARTICLE_BUFFER_GPU_BASE = 0xC00000000ull;
+    // 一時テクスチャのリソース ID（バックバッファの ID と重ならないようにする）
+    static constexpr ResourceId TRANSIENT_RESOURCE_ID_BASE = 0x10000;
+
+    struct TransientEntry {
+        TextureDesc desc;
+        ResourceState initialState = ResourceState::Common;
+        uint64_t heapOffset = 0;
+    };
+
+    SimulatedGpuTimeline gpuTimeline; // GPU 時間 0 = Signal と同時に完了
+    FrameScheduler frameScheduler;
+    SimulatedGpuQueue graphicsQueue;
+    SimulatedGpuQueue computeQueue;
+    QueueDependencyScheduler queueScheduler;
+    NullGpuParticleSimulator particleSimulator;
+    RecordingCommandList frameBeginCommandList;
+    RecordingCommandList frameEndCommandList;
+    std::unique_ptr<RecordingCommandList[]> recordingCommandLists;
+    ParallelCommandRecorder commandRecorder;
+
+    std::vector<uint8_t> frameMemory;
+    LinearRingAllocator frameMemoryRing;
+    std::vector<std::vector<uint8_t>> staticBuffers;
+    uint64_t nextStaticBufferAddress = STATIC_BUFFER_GPU_BASE;
+    std::vector<TransientEntry> transientEntries; // 添字 + TRANSIENT_RESOURCE_ID_BASE がリソース ID
+    uint64_t transientHeapSize = 0;
+
+    uint32_t backBufferWidth = 0;
+    uint32_t backBufferHeight = 0;
+    uint32_t backBufferIndex = 0;
+    uint64_t executedCommandCount = 0;
+    uint64_t submitCount = 0;
+    uint64_t submittedListCount = 0;
+    uint64_t drawCount = 0;
+};
@@ -0,0 +1,54 @@
+﻿#include "ParallelCommandRecorder.h"
+#include <algorithm>
+
+void ParallelCommandRecorder::Initialize(JobSystem* jobs, std::vector<ICommandList*> lists)
+{
+    jobSystem = jobs;
+    commandLists = std::move(lists);
+    recordedLists.clear();
+    recordedLists.reserve(commandLists.size());
+}
+
+// 描画アイテムを連続した範囲ごとにタスクへ割り当てる。
+// 各タスクは描画先を設定したうえで、パイプライン/トポロジが変化したときだけステートを設定する。
+const std::vector<ICommandList*>& ParallelCommandRecorder::RecordDraws(uint32_t frameSlot, const PassTarget& target, const std::vector<DrawItem>& draws, uint32_t drawsPerTask)
+{
+    const uint32_t drawCount = static_cast<uint32_t>(draws.size());
+    if (drawCount == 0 || commandLists.empty()) {
+        recordedLists.clear();
+        return recordedLists;
+    }
+    const uint32_t maxTasks = GetMaxTaskCount();
+    drawsPerTask = std::max<uint32_t>(drawsPerTask, 1);
+    drawsPerTask = std::max(drawsPerTask, (drawCount + maxTasks - 1) / maxTasks);
+    const uint32_t taskCount = (drawCount + drawsPerTask - 1) / drawsPerTask;
+
+    return Record(frameSlot, taskCount, [&](ICommandList& commandList, uint32_t taskIndex) {
+        commandList.SetRenderTarget(target.renderTarget);
+        commandList.SetViewport(target.viewport);
+        commandList.SetScissorRect(target.scissor);
+
+        const uint32_t begin = taskIndex * drawsPerTask;
+        const uint32_t end = std::min(begin + drawsPerTask, drawCount);
+        bool first = true;
+        PipelineId currentPipeline = 0;
+        PrimitiveTopology currentTopology = PrimitiveTopology::TriangleList;
+        for (uint32_t i = begin; i < end; ++i) {
+            const DrawItem& draw = draws[i];
+            if (first || draw.pipeline != currentPipeline) {
+                commandList.SetPipeline(draw.pipeline);
+                currentPipeline = draw.pipeline;
+            }
+            if (first || draw.topology != currentTopology) {
+                commandList.SetPrimitiveTopology(draw.topology);
+                currentTopology = draw.topology;
+            }
+            first = false;
+            commandList.SetVertexBuffer(0, draw.vertexBuffer);
+            if (draw.instanceBuffer.sizeInBytes != 0) {
+                commandList.SetVertexBuffer(1, draw.instanceBuffer);
+            }
+            commandList.DrawInstanced(draw.vertexCount, draw.instanceCount, 0, 0);
+        }
+    });
+}
@@ -0,0 +1,84 @@
+﻿#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include "CommandList.h"
+#include "../Core/JobSystem.h"
+#include "../Core/Profiler.h"
+
+// 1 回の描画呼び出しに必要な情報
+struct DrawItem {
+    PipelineId pipeline = 0;
+    PrimitiveTopology topology = PrimitiveTopology::TriangleList;
+    VertexBufferView vertexBuffer;
+    VertexBufferView instanceBuffer; // スロット 1 のインスタンスごとのデータ（sizeInBytes == 0 なら設定しない）
+    uint32_t vertexCount = 0;
+    uint32_t instanceCount = 1;
+};
+
+// パスの描画先（各ワーカーのコマンドリストはステートを継承しないため毎回設定する）
+struct PassTarget {
+    RenderTargetId renderTarget = 0;
+    Viewport viewport;
+    ScissorRect scissor;
+};
+
+// ジョブシステム上で複数のコマンドリストへ並列に記録する。
+// タスク i は常に i 番目のコマンドリストへ記録されるため、どのワーカーが実行しても
+// 投入順（= タスク順）は決定的になる。
+class ParallelCommandRecorder {
+public:
+    // jobs: タスクを実行するジョブシステム（所有しない）
+    // lists: タスクごとに使用するコマンドリスト（所有しない）
+    void Initialize(JobSystem* jobs, std::vector<ICommandList*> lists);
+
+    // taskCount 個のタスクを並列に記録し、すべて完了するまで待つ。
+    // function(ICommandList& commandList, uint32_t taskIndex) は各タスクから参照するだけで、コピーしない。
+    // 戻り値: 記録済みのコマンドリスト（タスク順、次回の Record 呼び出しまで有効）
+    template <typename Function>
+    const std::vector<ICommandList*>& Record(uint32_t frameSlot, uint32_t taskCount, const Function& function);
+
+    // draws を drawsPerTask 件ずつのタスクに分割して記録する。
+    // タスク数がコマンドリスト数を超える場合は 1 タスクあたりの件数を増やす。
+    const std::vector<ICommandList*>& RecordDraws(uint32_t frameSlot, const PassTarget& target, const std::vector<DrawItem>& draws, uint32_t drawsPerTask);
+
+    uint32_t GetMaxTaskCount() const { return static_cast<uint32_t>(commandLists.size()); }
+
+private:
+    JobSystem* jobSystem = nullptr;
+    std::vector<ICommandList*> commandLists;
+    std::vector<ICommandList*> recordedLists;
+};
+
+// 各タスクを 1 ジョブとして投入し、呼び出し元もジョブを消化しながら完了を待つ。
+// ジョブはスタック上のタスク情報とタスク番号だけをキャプチャし、std::function の内部バッファに収める。
+// 引数:
+//  - frameSlot: コマンドアロケータを選択するフレームスロット
+//  - taskCount: タスク数（GetMaxTaskCount() 以下）
+//  - function: タスク番号とコマンドリストを受け取り、Begin/End の間のコマンドを記録する関数
+template <typename Function>
+const std::vector<ICommandList*>& ParallelCommandRecorder::Record(uint32_t frameSlot, uint32_t taskCount, const Function& function)
+{
+    assert(taskCount <= commandLists.size());
+    recordedLists.assign(commandLists.begin(), commandLists.begin() + taskCount);
+
+    struct RecordTask {
+        ICommandList* const* commandLists;
+        const Function* function;
+        uint32_t frameSlot;
+    };
+    const RecordTask task = { recordedLists.data(), &function, frameSlot };
+    JobCounter counter;
+    for (uint32_t i = 0; i < taskCount; ++i) {
+        jobSystem->Schedule([&task, i]() {
+            PROFILE_SCOPE("RecordCommandList");
+            ICommandList& commandList = *task.commandLists[i];
+            commandList.Begin(task.frameSlot);
+            (*task.function)(commandList, i);
+            commandList.End();
+        }, &counter);
+    }
+    jobSystem->Wait(counter);
+    return recordedLists;
+}
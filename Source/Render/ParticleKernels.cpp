@@ -0,0 +1,269 @@
+﻿#include "ParticleKernels.h"
+
+#if SIMD_X86
+#include <immintrin.h>
+#endif
+
+// InstanceKernels と同じく、分岐は比較マスクと選択で表現できる形にそろえている。
+// （AVX2 版は積和に FMA を使うため、位置と見た目は丸め誤差の範囲で異なる）
+// GPU 版（D3D12ParticleSimulator のコンピュートシェーダ）も同じ式で更新する。
+
+namespace {
+
+void SimulateParticlesScalar(const ParticleStreams& s, uint32_t begin, uint32_t end, const ParticleSimulationParams& params)
+{
+    const float dt = params.deltaTime;
+    const float gravityX = params.gravityX * dt;
+    const float gravityY = params.gravityY * dt;
+    const float bounce = -params.restitution;
+    for (uint32_t i = begin; i < end; ++i) {
+        float vx = (s.velocityX[i] + gravityX) * params.damping;
+        float vy = (s.velocityY[i] + gravityY) * params.damping;
+        float x = s.positionX[i] + vx * dt;
+        float y = s.positionY[i] + vy * dt;
+        if (y < params.floorY) {
+            y = params.floorY;
+            vy *= bounce;
+        }
+        float age = s.age[i] + s.ageRate[i] * dt;
+        if (age >= 1.0f) {
+            age -= 1.0f;
+            x = params.emitterX;
+            y = params.emitterY;
+            vx = s.launchVelocityX[i];
+            vy = s.launchVelocityY[i];
+        }
+        s.positionX[i] = x;
+        s.positionY[i] = y;
+        s.velocityX[i] = vx;
+        s.velocityY[i] = vy;
+        s.age[i] = age;
+    }
+}
+
+// 回転は使わない（0）。大きさと色は age で開始 → 終了を補間する
+void PackParticlesScalar(const ParticleStreams& s, uint32_t begin, uint32_t end, const ParticleAppearance& appearance, InstanceGpuData* output)
+{
+    const float scaleDelta = appearance.endScale - appearance.startScale;
+    float colorDelta[4];
+    for (int c = 0; c < 4; ++c) {
+        colorDelta[c] = appearance.endColor[c] - appearance.startColor[c];
+    }
+    for (uint32_t i = begin; i < end; ++i) {
+        const float t = s.age[i];
+        InstanceGpuData& instance = output[i - begin];
+        instance.positionX = s.positionX[i];
+        instance.positionY = s.positionY[i];
+        instance.rotation = 0.0f;
+        instance.scale = appearance.startScale + scaleDelta * t;
+        instance.colorR = appearance.startColor[0] + colorDelta[0] * t;
+        instance.colorG = appearance.startColor[1] + colorDelta[1] * t;
+        instance.colorB = appearance.startColor[2] + colorDelta[2] * t;
+        instance.colorA = appearance.startColor[3] + colorDelta[3] * t;
+    }
+}
+
+#if SIMD_X86
+
+// ---- SSE2（4 粒子単位、端数はスカラー版で処理） ----
+
+// mask の立っているレーンは a、それ以外は b
+inline __m128 SelectSSE2(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+void SimulateParticlesSSE2(const ParticleStreams& s, uint32_t begin, uint32_t end, const ParticleSimulationParams& params)
+{
+    const __m128 dt = _mm_set1_ps(params.deltaTime);
+    const __m128 gravityX = _mm_set1_ps(params.gravityX * params.deltaTime);
+    const __m128 gravityY = _mm_set1_ps(params.gravityY * params.deltaTime);
+    const __m128 damping = _mm_set1_ps(params.damping);
+    const __m128 floorY = _mm_set1_ps(params.floorY);
+    const __m128 bounce = _mm_set1_ps(-params.restitution);
+    const __m128 emitterX = _mm_set1_ps(params.emitterX);
+    const __m128 emitterY = _mm_set1_ps(params.emitterY);
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        __m128 vx = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(s.velocityX + i), gravityX), damping);
+        __m128 vy = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(s.velocityY + i), gravityY), damping);
+        __m128 x = _mm_add_ps(_mm_loadu_ps(s.positionX + i), _mm_mul_ps(vx, dt));
+        __m128 y = _mm_add_ps(_mm_loadu_ps(s.positionY + i), _mm_mul_ps(vy, dt));
+        // 床より下に出た粒子は床へ戻し、縦の速度を反転して減衰させる
+        const __m128 below = _mm_cmplt_ps(y, floorY);
+        y = _mm_max_ps(y, floorY);
+        vy = SelectSSE2(below, _mm_mul_ps(vy, bounce), vy);
+        // 寿命に達した粒子は発生源から初速で出し直す
+        __m128 age = _mm_add_ps(_mm_loadu_ps(s.age + i), _mm_mul_ps(_mm_loadu_ps(s.ageRate + i), dt));
+        const __m128 expired = _mm_cmpge_ps(age, one);
+        age = _mm_sub_ps(age, _mm_and_ps(expired, one));
+        x = SelectSSE2(expired, emitterX, x);
+        y = SelectSSE2(expired, emitterY, y);
+        vx = SelectSSE2(expired, _mm_loadu_ps(s.launchVelocityX + i), vx);
+        vy = SelectSSE2(expired, _mm_loadu_ps(s.launchVelocityY + i), vy);
+        _mm_storeu_ps(s.positionX + i, x);
+        _mm_storeu_ps(s.positionY + i, y);
+        _mm_storeu_ps(s.velocityX + i, vx);
+        _mm_storeu_ps(s.velocityY + i, vy);
+        _mm_storeu_ps(s.age + i, age);
+    }
+    SimulateParticlesScalar(s, i, end, params);
+}
+
+// 4 粒子 × 4 属性を転置して、1 粒子 16 バイト単位で書き出す
+void PackParticlesSSE2(const ParticleStreams& s, uint32_t begin, uint32_t end, const ParticleAppearance& appearance, InstanceGpuData* output)
+{
+    const __m128 startScale = _mm_set1_ps(appearance.startScale);
+    const __m128 scaleDelta = _mm_set1_ps(appearance.endScale - appearance.startScale);
+    __m128 startColor[4];
+    __m128 colorDelta[4];
+    for (int c = 0; c < 4; ++c) {
+        startColor[c] = _mm_set1_ps(appearance.startColor[c]);
+        colorDelta[c] = _mm_set1_ps(appearance.endColor[c] - appearance.startColor[c]);
+    }
+    float* out = reinterpret_cast<float*>(output);
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4, out += 32) {
+        const __m128 t = _mm_loadu_ps(s.age + i);
+        __m128 px = _mm_loadu_ps(s.positionX + i);
+        __m128 py = _mm_loadu_ps(s.positionY + i);
+        __m128 rot = _mm_setzero_ps();
+        __m128 scl = _mm_add_ps(startScale, _mm_mul_ps(scaleDelta, t));
+        _MM_TRANSPOSE4_PS(px, py, rot, scl);
+        __m128 r = _mm_add_ps(startColor[0], _mm_mul_ps(colorDelta[0], t));
+        __m128 g = _mm_add_ps(startColor[1], _mm_mul_ps(colorDelta[1], t));
+        __m128 b = _mm_add_ps(startColor[2], _mm_mul_ps(colorDelta[2], t));
+        __m128 a = _mm_add_ps(startColor[3], _mm_mul_ps(colorDelta[3], t));
+        _MM_TRANSPOSE4_PS(r, g, b, a);
+        _mm_storeu_ps(out + 0, px);
+        _mm_storeu_ps(out + 4, r);
+        _mm_storeu_ps(out + 8, py);
+        _mm_storeu_ps(out + 12, g);
+        _mm_storeu_ps(out + 16, rot);
+        _mm_storeu_ps(out + 20, b);
+        _mm_storeu_ps(out + 24, scl);
+        _mm_storeu_ps(out + 28, a);
+    }
+    PackParticlesScalar(s, i, end, appearance, output + (i - begin));
+}
+
+// ---- AVX2 + FMA（8 粒子単位、端数は SSE2 版で処理） ----
+
+SIMD_TARGET_AVX2 void SimulateParticlesAVX2(const ParticleStreams& s, uint32_t begin, uint32_t end, const ParticleSimulationParams& params)
+{
+    const __m256 dt = _mm256_set1_ps(params.deltaTime);
+    const __m256 gravityX = _mm256_set1_ps(params.gravityX * params.deltaTime);
+    const __m256 gravityY = _mm256_set1_ps(params.gravityY * params.deltaTime);
+    const __m256 damping = _mm256_set1_ps(params.damping);
+    const __m256 floorY = _mm256_set1_ps(params.floorY);
+    const __m256 bounce = _mm256_set1_ps(-params.restitution);
+    const __m256 emitterX = _mm256_set1_ps(params.emitterX);
+    const __m256 emitterY = _mm256_set1_ps(params.emitterY);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    uint32_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        __m256 vx = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(s.velocityX + i), gravityX), damping);
+        __m256 vy = _mm256_mul_ps(_mm256_add_ps(_mm256_loadu_ps(s.velocityY + i), gravityY), damping);
+        __m256 x = _mm256_fmadd_ps(vx, dt, _mm256_loadu_ps(s.positionX + i));
+        __m256 y = _mm256_fmadd_ps(vy, dt, _mm256_loadu_ps(s.positionY + i));
+        const __m256 below = _mm256_cmp_ps(y, floorY, _CMP_LT_OQ);
+        y = _mm256_max_ps(y, floorY);
+        vy = _mm256_blendv_ps(vy, _mm256_mul_ps(vy, bounce), below);
+        __m256 age = _mm256_fmadd_ps(_mm256_loadu_ps(s.ageRate + i), dt, _mm256_loadu_ps(s.age + i));
+        const __m256 expired = _mm256_cmp_ps(age, one, _CMP_GE_OQ);
+        age = _mm256_sub_ps(age, _mm256_and_ps(expired, one));
+        x = _mm256_blendv_ps(x, emitterX, expired);
+        y = _mm256_blendv_ps(y, emitterY, expired);
+        vx = _mm256_blendv_ps(vx, _mm256_loadu_ps(s.launchVelocityX + i), expired);
+        vy = _mm256_blendv_ps(vy, _mm256_loadu_ps(s.launchVelocityY + i), expired);
+        _mm256_storeu_ps(s.positionX + i, x);
+        _mm256_storeu_ps(s.positionY + i, y);
+        _mm256_storeu_ps(s.velocityX + i, vx);
+        _mm256_storeu_ps(s.velocityY + i, vy);
+        _mm256_storeu_ps(s.age + i, age);
+    }
+    SimulateParticlesSSE2(s, i, end, params);
+}
+
+// 8 粒子 × 8 属性を 8x8 転置し、1 粒子 32 バイト（= 1 レジスタ）単位で書き出す
+SIMD_TARGET_AVX2 void PackParticlesAVX2(const ParticleStreams& s, uint32_t begin, uint32_t end, const ParticleAppearance& appearance, InstanceGpuData* output)
+{
+    const __m256 startScale = _mm256_set1_ps(appearance.startScale);
+    const __m256 scaleDelta = _mm256_set1_ps(appearance.endScale - appearance.startScale);
+    __m256 startColor[4];
+    __m256 colorDelta[4];
+    for (int c = 0; c < 4; ++c) {
+        startColor[c] = _mm256_set1_ps(appearance.startColor[c]);
+        colorDelta[c] = _mm256_set1_ps(appearance.endColor[c] - appearance.startColor[c]);
+    }
+    float* out = reinterpret_cast<float*>(output);
+    uint32_t i = begin;
+    for (; i + 8 <= end; i += 8, out += 64) {
+        const __m256 t = _mm256_loadu_ps(s.age + i);
+        const __m256 row0 = _mm256_loadu_ps(s.positionX + i);
+        const __m256 row1 = _mm256_loadu_ps(s.positionY + i);
+        const __m256 row2 = _mm256_setzero_ps();
+        const __m256 row3 = _mm256_fmadd_ps(scaleDelta, t, startScale);
+        const __m256 row4 = _mm256_fmadd_ps(colorDelta[0], t, startColor[0]);
+        const __m256 row5 = _mm256_fmadd_ps(colorDelta[1], t, startColor[1]);
+        const __m256 row6 = _mm256_fmadd_ps(colorDelta[2], t, startColor[2]);
+        const __m256 row7 = _mm256_fmadd_ps(colorDelta[3], t, startColor[3]);
+
+        const __m256 t0 = _mm256_unpacklo_ps(row0, row1);
+        const __m256 t1 = _mm256_unpackhi_ps(row0, row1);
+        const __m256 t2 = _mm256_unpacklo_ps(row2, row3);
+        const __m256 t3 = _mm256_unpackhi_ps(row2, row3);
+        const __m256 t4 = _mm256_unpacklo_ps(row4, row5);
+        const __m256 t5 = _mm256_unpackhi_ps(row4, row5);
+        const __m256 t6 = _mm256_unpacklo_ps(row6, row7);
+        const __m256 t7 = _mm256_unpackhi_ps(row6, row7);
+        const __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+        const __m256 u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+        const __m256 u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+        _mm256_storeu_ps(out + 0, _mm256_permute2f128_ps(u0, u4, 0x20));
+        _mm256_storeu_ps(out + 8, _mm256_permute2f128_ps(u1, u5, 0x20));
+        _mm256_storeu_ps(out + 16, _mm256_permute2f128_ps(u2, u6, 0x20));
+        _mm256_storeu_ps(out + 24, _mm256_permute2f128_ps(u3, u7, 0x20));
+        _mm256_storeu_ps(out + 32, _mm256_permute2f128_ps(u0, u4, 0x31));
+        _mm256_storeu_ps(out + 40, _mm256_permute2f128_ps(u1, u5, 0x31));
+        _mm256_storeu_ps(out + 48, _mm256_permute2f128_ps(u2, u6, 0x31));
+        _mm256_storeu_ps(out + 56, _mm256_permute2f128_ps(u3, u7, 0x31));
+    }
+    PackParticlesSSE2(s, i, end, appearance, output + (i - begin));
+}
+
+#endif // SIMD_X86
+
+const ParticleKernelTable SCALAR_KERNELS = { SimdLevel::Scalar, SimulateParticlesScalar, PackParticlesScalar };
+#if SIMD_X86
+const ParticleKernelTable SSE2_KERNELS = { SimdLevel::SSE2, SimulateParticlesSSE2, PackParticlesSSE2 };
+const ParticleKernelTable AVX2_KERNELS = { SimdLevel::AVX2, SimulateParticlesAVX2, PackParticlesAVX2 };
+#endif
+
+} // namespace
+
+const ParticleKernelTable& GetParticleKernels(SimdLevel level)
+{
+    if (level > GetSupportedSimdLevel()) {
+        level = GetSupportedSimdLevel();
+    }
+#if SIMD_X86
+    switch (level) {
+    case SimdLevel::AVX2:
+        return AVX2_KERNELS;
+    case SimdLevel::SSE2:
+        return SSE2_KERNELS;
+    case SimdLevel::Scalar:
+        break;
+    }
+#endif
+    return SCALAR_KERNELS;
+}
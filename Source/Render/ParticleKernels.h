@@ -0,0 +1,52 @@
+﻿#pragma once
+
+#include <cstdint>
+#include "../Core/CpuFeatures.h"
+#include "InstanceStorage.h"
+
+// パーティクルの SoA 配列への生ポインタ。カーネルはこのビューを通して [begin, end) の範囲を更新する。
+struct ParticleStreams {
+    float* positionX = nullptr;
+    float* positionY = nullptr;
+    float* velocityX = nullptr;
+    float* velocityY = nullptr;
+    float* age = nullptr;             // 寿命に対する経過の割合 [0, 1)。1 に達したら発生源から出し直す
+    float* ageRate = nullptr;         // 1 秒あたりの age の増分（1 / 寿命）
+    float* launchVelocityX = nullptr; // 発生源から出し直すときの初速
+    float* launchVelocityY = nullptr;
+};
+
+// 1 回の更新に共通するパラメータ
+struct ParticleSimulationParams {
+    float deltaTime = 0.0f;
+    float gravityX = 0.0f;
+    float gravityY = 0.0f;
+    float damping = 1.0f;     // 1 ステップで速度に掛ける係数（空気抵抗）
+    float emitterX = 0.0f;    // 発生源の位置
+    float emitterY = 0.0f;
+    float floorY = -1.0f;     // この高さより下に出た粒子は跳ね返す
+    float restitution = 0.5f; // 跳ね返りの反発係数
+};
+
+// 寿命の割合 age に応じた見た目（開始 → 終了を線形補間する）
+struct ParticleAppearance {
+    float startScale = 0.01f;
+    float endScale = 0.002f;
+    float startColor[4] = { 1.0f, 0.9f, 0.5f, 1.0f };
+    float endColor[4] = { 0.8f, 0.2f, 0.1f, 0.0f };
+};
+
+// [begin, end) の粒子を deltaTime 秒ぶん進めるカーネル
+using ParticleSimulateKernel = void (*)(const ParticleStreams& streams, uint32_t begin, uint32_t end, const ParticleSimulationParams& params);
+// [begin, end) の粒子を output[0 ～ end-begin) へ GPU のインスタンス形式で書き出すカーネル
+using ParticlePackKernel = void (*)(const ParticleStreams& streams, uint32_t begin, uint32_t end, const ParticleAppearance& appearance, InstanceGpuData* output);
+
+// 同じ命令セットで実装したカーネルの組
+struct ParticleKernelTable {
+    SimdLevel level = SimdLevel::Scalar;
+    ParticleSimulateKernel simulate = nullptr; // 重力/抵抗/床での反射/寿命による出し直し
+    ParticlePackKernel pack = nullptr;         // SoA -> InstanceGpuData への転置と見た目の補間
+};
+
+// level の実装を返す。CPU がサポートしないレベルを指定した場合はサポートする最上位のレベルに落とす。
+const ParticleKernelTable& GetParticleKernels(SimdLevel level);
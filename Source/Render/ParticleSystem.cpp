@@ -0,0 +1,101 @@
+﻿#include "ParticleSystem.h"
+#include "../Core/JobSystem.h"
+#include "../Core/Profiler.h"
+#include <cmath>
+#include <random>
+
+// 粒子ごとの初速と寿命を乱数で決め、寿命のどこまで進んだ状態から始めるかもばらつかせる
+// （全粒子が同時に発生源から出ないようにするため）。
+// 初期位置は抵抗と床を無視した放物線で、経過時間ぶん進めた位置にする。
+// 引数:
+//  - jobs: 更新と書き出しに使用するジョブシステム
+//  - desc: 粒子数と発生源の設定
+//  - level: カーネルの命令セット（GetSupportedSimdLevel() を超える場合は下げる）
+void ParticleSystem::Initialize(JobSystem* jobs, const ParticleEmitterDesc& desc, SimdLevel level)
+{
+    jobSystem = jobs;
+    kernels = &GetParticleKernels(level);
+    emitter = desc;
+
+    AlignedVector<float>* streams[STREAM_COUNT] = { &positionX, &positionY, &velocityX, &velocityY, &age, &ageRate, &launchVelocityX, &launchVelocityY };
+    for (AlignedVector<float>* stream : streams) {
+        stream->assign(desc.particleCount, 0.0f);
+    }
+
+    std::mt19937 random(desc.seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (uint32_t i = 0; i < desc.particleCount; ++i) {
+        const float angle = (2.0f * unit(random) - 1.0f) * desc.spreadAngle;
+        const float speed = desc.speedMin + (desc.speedMax - desc.speedMin) * unit(random);
+        const float lifetime = desc.lifetimeMin + (desc.lifetimeMax - desc.lifetimeMin) * unit(random);
+        launchVelocityX[i] = std::sin(angle) * speed;
+        launchVelocityY[i] = std::cos(angle) * speed;
+        ageRate[i] = 1.0f / lifetime;
+        age[i] = unit(random);
+
+        const float elapsed = age[i] * lifetime;
+        positionX[i] = desc.emitterX + launchVelocityX[i] * elapsed + 0.5f * desc.gravityX * elapsed * elapsed;
+        positionY[i] = desc.emitterY + launchVelocityY[i] * elapsed + 0.5f * desc.gravityY * elapsed * elapsed;
+        positionY[i] = positionY[i] < desc.floorY ? desc.floorY : positionY[i];
+        velocityX[i] = launchVelocityX[i] + desc.gravityX * elapsed;
+        velocityY[i] = launchVelocityY[i] + desc.gravityY * elapsed;
+    }
+}
+
+void ParticleSystem::SetSimdLevel(SimdLevel level)
+{
+    kernels = &GetParticleKernels(level);
+}
+
+void ParticleSystem::Simulate(float deltaTime)
+{
+    const ParticleSimulationParams params = GetSimulationParams(deltaTime);
+    const ParticleStreams streams = GetStreams();
+    const ParticleKernelTable& table = *kernels;
+    jobSystem->ParallelFor(GetParticleCount(), PARTICLES_PER_JOB, [&](uint32_t begin, uint32_t end) {
+        PROFILE_SCOPE("SimulateParticles");
+        table.simulate(streams, begin, end, params);
+    });
+}
+
+void ParticleSystem::WriteInstances(InstanceGpuData* output) const
+{
+    const ParticleStreams streams = GetStreams();
+    const ParticleKernelTable& table = *kernels;
+    const ParticleAppearance& appearance = emitter.appearance;
+    jobSystem->ParallelFor(GetParticleCount(), PARTICLES_PER_JOB, [&](uint32_t begin, uint32_t end) {
+        PROFILE_SCOPE("PackParticles");
+        table.pack(streams, begin, end, appearance, output + begin);
+    });
+}
+
+// 抵抗は 1 ステップの減衰率に直す（大きな deltaTime で速度が反転しないよう 0 で止める）
+ParticleSimulationParams ParticleSystem::GetSimulationParams(float deltaTime) const
+{
+    ParticleSimulationParams params;
+    params.deltaTime = deltaTime;
+    params.gravityX = emitter.gravityX;
+    params.gravityY = emitter.gravityY;
+    const float damping = 1.0f - emitter.drag * deltaTime;
+    params.damping = damping > 0.0f ? damping : 0.0f;
+    params.emitterX = emitter.emitterX;
+    params.emitterY = emitter.emitterY;
+    params.floorY = emitter.floorY;
+    params.restitution = emitter.restitution;
+    return params;
+}
+
+// カーネルは配列の中身だけを書き換えるため、const なメンバからもビューを作る
+ParticleStreams ParticleSystem::GetStreams() const
+{
+    ParticleStreams streams;
+    streams.positionX = const_cast<float*>(positionX.data());
+    streams.positionY = const_cast<float*>(positionY.data());
+    streams.velocityX = const_cast<float*>(velocityX.data());
+    streams.velocityY = const_cast<float*>(velocityY.data());
+    streams.age = const_cast<float*>(age.data());
+    streams.ageRate = const_cast<float*>(ageRate.data());
+    streams.launchVelocityX = const_cast<float*>(launchVelocityX.data());
+    streams.launchVelocityY = const_cast<float*>(launchVelocityY.data());
+    return streams;
+}
@@ -0,0 +1,89 @@
+﻿#pragma once
+
+#include <cstdint>
+#include "../Core/AlignedAllocator.h"
+#include "../Core/CpuFeatures.h"
+#include "CommandList.h"
+#include "ParticleKernels.h"
+#include "QueueDependencyScheduler.h"
+
+class JobSystem;
+
+// 1 つの発生源から出る粒子の設定
+struct ParticleEmitterDesc {
+    uint32_t particleCount = 0;
+    float emitterX = 0.0f;
+    float emitterY = -0.8f;
+    float speedMin = 0.8f;          // 初速の大きさの範囲
+    float speedMax = 1.6f;
+    float spreadAngle = 0.5f;       // 真上からの初速の向きのばらつき（ラジアン、±）
+    float lifetimeMin = 1.0f;       // 寿命の範囲（秒）
+    float lifetimeMax = 3.0f;
+    float gravityX = 0.0f;
+    float gravityY = -1.5f;
+    float drag = 0.2f;              // 1 秒あたりに失う速度の割合
+    float floorY = -1.0f;
+    float restitution = 0.4f;
+    ParticleAppearance appearance;
+    uint32_t seed = 1;              // 初速/寿命/初期の経過を決める乱数のシード
+};
+
+// 粒子を SoA で保持し、SIMD カーネルで更新して GPU のインスタンス形式へ書き出す。
+// Simulate/WriteInstances はジョブシステム上で範囲を分割して並列に実行する。
+// 初速と寿命は生成時に決めておき、寿命に達した粒子は同じ初速で発生源から出し直す（更新中に乱数を使わない）。
+class ParticleSystem {
+public:
+    // 1 ジョブで処理する粒子数の目安
+    static constexpr uint32_t PARTICLES_PER_JOB = 16384;
+
+    // jobs: 更新を実行するジョブシステム（所有しない）
+    // level: 使用するカーネルの命令セット（サポート外の場合は自動的に下げる）
+    void Initialize(JobSystem* jobs, const ParticleEmitterDesc& desc, SimdLevel level = GetSupportedSimdLevel());
+    // カーネルの命令セットを切り替える（比較計測用）
+    void SetSimdLevel(SimdLevel level);
+
+    // 全粒子を deltaTime 秒ぶん進める
+    void Simulate(float deltaTime);
+    // 全粒子を output[0 ～ GetParticleCount()) へ書き出す
+    void WriteInstances(InstanceGpuData* output) const;
+    // deltaTime 秒の更新に使うパラメータ（GPU 版も同じ値で更新する）
+    ParticleSimulationParams GetSimulationParams(float deltaTime) const;
+
+    const ParticleEmitterDesc& GetEmitter() const { return emitter; }
+    ParticleStreams GetStreams() const;
+    uint32_t GetParticleCount() const { return static_cast<uint32_t>(positionX.size()); }
+    SimdLevel GetSimdLevel() const { return kernels->level; }
+
+private:
+    static constexpr uint32_t STREAM_COUNT = 8;
+
+    JobSystem* jobSystem = nullptr;
+    const ParticleKernelTable* kernels = nullptr;
+    ParticleEmitterDesc emitter;
+    AlignedVector<float> positionX;
+    AlignedVector<float> positionY;
+    AlignedVector<float> velocityX;
+    AlignedVector<float> velocityY;
+    AlignedVector<float> age;
+    AlignedVector<float> ageRate;
+    AlignedVector<float> launchVelocityX;
+    AlignedVector<float> launchVelocityY;
+};
+
+// 非同期コンピュートで粒子を更新するバックエンドの実装（IRenderBackend::GetGpuParticleSimulator）。
+// 更新はコンピュートキューへ投入し、同じフレームの描画キューの投入はその完了を GPU 上で待つ。
+// CPU は GPU の更新を待たないため、コンピュートキューの更新は前のフレームの描画と並行して実行できる。
+class IGpuParticleSimulator {
+public:
+    virtual ~IGpuParticleSimulator() = default;
+
+    // initialState の粒子を GPU 側の状態として取り込む（以降の更新は GPU 側だけで行う）。
+    // 例外: GPU リソースの作成に失敗した場合は std::runtime_error を送出
+    virtual void Initialize(const ParticleSystem& initialState) = 0;
+    // 今フレームの更新をコンピュートキューへ投入する。BeginFrame の後、SubmitAndPresent の前に呼び出すこと。
+    // 戻り値: 更新結果を書き出したインスタンスバッファ（フレームスロットごとに別の領域）
+    virtual VertexBufferView Simulate(uint32_t frameSlot, const ParticleSimulationParams& params, const ParticleAppearance& appearance) = 0;
+    virtual uint32_t GetParticleCount() const = 0;
+    // キュー間の依存の統計
+    virtual const QueueSchedulerStats& GetQueueStats() const = 0;
+};
@@ -0,0 +1,118 @@
+﻿#pragma once
+
+#include <cstdint>
+#include "../Core/Hash.h"
+#include "CommandList.h"
+#include "VertexFormat.h"
+
+// シェーダ以外の固定機能ステート（ブレンド/ラスタライズ/深度/出力形式/入力レイアウト）の記述。
+// PipelineStateBuilder で constexpr に組み立て、内容の 64bit ハッシュをキーとしてコンパイル時に求める。
+// 同じキーのステートは同じ内容なので、描画時の比較は整数 1 つの比較で済む。
+
+enum class BlendMode : uint8_t {
+    Opaque,
+    AlphaBlend,    // src * a + dst * (1 - a)
+    Premultiplied, // src + dst * (1 - a)
+    Additive,      // src * a + dst
+};
+
+enum class CullMode : uint8_t {
+    None,
+    Front,
+    Back,
+};
+
+enum class FillMode : uint8_t {
+    Solid,
+    Wireframe,
+};
+
+enum class DepthMode : uint8_t {
+    Disabled,
+    TestOnly,  // LessEqual で比較し、書き込まない
+    TestWrite, // Less で比較して書き込む
+};
+
+enum class PrimitiveTopologyType : uint8_t {
+    Triangle,
+    Line,
+    Point,
+};
+
+// 深度バッファなしを表す出力形式
+constexpr uint8_t NO_DEPTH_FORMAT = UINT8_MAX;
+
+struct PipelineStateDesc {
+    BlendMode blend = BlendMode::Opaque;
+    CullMode cull = CullMode::Back;
+    FillMode fill = FillMode::Solid;
+    DepthMode depth = DepthMode::Disabled;
+    PrimitiveTopologyType topology = PrimitiveTopologyType::Triangle;
+    bool frontCounterClockwise = false;
+    bool depthClip = true;
+    uint8_t renderTargetCount = 1;
+    TextureFormat renderTargetFormat = TextureFormat::RGBA8Unorm;
+    uint8_t depthFormat = NO_DEPTH_FORMAT; // TextureFormat の値、または NO_DEPTH_FORMAT
+    uint8_t sampleCount = 1;
+    uint64_t inputLayoutHash = EmptyVertexLayout::HASH;
+};
+
+// 組み立て済みのステートとそのキー
+struct PipelineStateKey {
+    PipelineStateDesc desc;
+    uint64_t hash = 0;
+
+    constexpr bool operator==(const PipelineStateKey& other) const { return hash == other.hash; }
+};
+
+constexpr uint64_t HashPipelineState(const PipelineStateDesc& desc)
+{
+    uint64_t hash = HASH_SEED;
+    hash = HashCombine(hash, static_cast<uint64_t>(desc.blend));
+    hash = HashCombine(hash, static_cast<uint64_t>(desc.cull));
+    hash = HashCombine(hash, static_cast<uint64_t>(desc.fill));
+    hash = HashCombine(hash, static_cast<uint64_t>(desc.depth));
+    hash = HashCombine(hash, static_cast<uint64_t>(desc.topology));
+    hash = HashCombine(hash, desc.frontCounterClockwise ? 1 : 0);
+    hash = HashCombine(hash, desc.depthClip ? 1 : 0);
+    hash = HashCombine(hash, desc.renderTargetCount);
+    hash = HashCombine(hash, static_cast<uint64_t>(desc.renderTargetFormat));
+    hash = HashCombine(hash, desc.depthFormat);
+    hash = HashCombine(hash, desc.sampleCount);
+    hash = HashCombine(hash, desc.inputLayoutHash);
+    return hash;
+}
+
+// 既定値は不透明、背面カリング、深度なし、RGBA8 の 1 ターゲット、頂点入力なし。
+// 例: constexpr PipelineStateKey key = PipelineStateBuilder().Cull(CullMode::None).InputLayout<MyLayout>().Build();
+class PipelineStateBuilder {
+public:
+    constexpr PipelineStateBuilder Blend(BlendMode mode) const { PipelineStateBuilder builder = *this; builder.desc.blend = mode; return builder; }
+    constexpr PipelineStateBuilder Cull(CullMode mode) const { PipelineStateBuilder builder = *this; builder.desc.cull = mode; return builder; }
+    constexpr PipelineStateBuilder Fill(FillMode mode) const { PipelineStateBuilder builder = *this; builder.desc.fill = mode; return builder; }
+    constexpr PipelineStateBuilder FrontCounterClockwise(bool enable) const { PipelineStateBuilder builder = *this; builder.desc.frontCounterClockwise = enable; return builder; }
+    constexpr PipelineStateBuilder DepthClip(bool enable) const { PipelineStateBuilder builder = *this; builder.desc.depthClip = enable; return builder; }
+    constexpr PipelineStateBuilder Topology(PrimitiveTopologyType type) const { PipelineStateBuilder builder = *this; builder.desc.topology = type; return builder; }
+    constexpr PipelineStateBuilder RenderTarget(TextureFormat format, uint8_t count = 1) const
+    {
+        PipelineStateBuilder builder = *this;
+        builder.desc.renderTargetFormat = format;
+        builder.desc.renderTargetCount = count;
+        return builder;
+    }
+    constexpr PipelineStateBuilder Depth(DepthMode mode, TextureFormat format = TextureFormat::D32Float) const
+    {
+        PipelineStateBuilder builder = *this;
+        builder.desc.depth = mode;
+        builder.desc.depthFormat = mode == DepthMode::Disabled ? NO_DEPTH_FORMAT : static_cast<uint8_t>(format);
+        return builder;
+    }
+    constexpr PipelineStateBuilder SampleCount(uint8_t count) const { PipelineStateBuilder builder = *this; builder.desc.sampleCount = count; return builder; }
+    template <typename Layout>
+    constexpr PipelineStateBuilder InputLayout() const { PipelineStateBuilder builder = *this; builder.desc.inputLayoutHash = Layout::HASH; return builder; }
+
+    constexpr PipelineStateKey Build() const { return { desc, HashPipelineState(desc) }; }
+
+private:
+    PipelineStateDesc desc;
+};
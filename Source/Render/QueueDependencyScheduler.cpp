@@ -0,0 +1,134 @@
+﻿#include "QueueDependencyScheduler.h"
+#include "RecordingCommandList.h"
+#include <stdexcept>
+#include <string>
+
+const char* GetGpuQueueTypeName(GpuQueueType type)
+{
+    switch (type) {
+    case GpuQueueType::Graphics:
+        return "graphics";
+    case GpuQueueType::Compute:
+        return "compute";
+    case GpuQueueType::Copy:
+        return "copy";
+    case GpuQueueType::Count:
+        break;
+    }
+    return "unknown";
+}
+
+void QueueDependencyScheduler::Initialize()
+{
+    for (QueueState& state : queues) {
+        state = {};
+    }
+    stats = {};
+}
+
+void QueueDependencyScheduler::SetQueue(GpuQueueType type, IGpuQueue* queue)
+{
+    queues[static_cast<uint32_t>(type)].queue = queue;
+}
+
+// 依存の待機を積んでから投入し、続けてこの投入の完了値を通知する。
+// 引数:
+//  - type: 投入先のキュー（SetQueue で登録済みであること）
+//  - lists/count: 投入するコマンドリスト（配列の順序どおりに 1 回で投入する。count == 0 の場合は待機と通知だけを行う）
+//  - waits/waitCount: この投入より先に完了している必要がある同期点
+// 例外: 未登録のキューを指定した場合は std::runtime_error を送出
+QueueSyncPoint QueueDependencyScheduler::Submit(GpuQueueType type, ICommandList* const* lists, uint32_t count, const QueueSyncPoint* waits, uint32_t waitCount)
+{
+    QueueState& state = queues[static_cast<uint32_t>(type)];
+    if (!state.queue) {
+        throw std::runtime_error(std::string("No GPU queue registered for ") + GetGpuQueueTypeName(type));
+    }
+    for (const QueueSyncPoint& point : state.pendingWaits) {
+        ResolveWait(state, type, point);
+    }
+    state.pendingWaits.clear();
+    for (uint32_t i = 0; i < waitCount; ++i) {
+        ResolveWait(state, type, waits[i]);
+    }
+
+    if (count != 0) {
+        state.queue->ExecuteCommandLists(lists, count);
+    }
+    const uint64_t value = state.nextValue++;
+    state.queue->Signal(value);
+    ++stats.submits[static_cast<uint32_t>(type)];
+    return { type, value };
+}
+
+void QueueDependencyScheduler::AddPendingWait(GpuQueueType type, const QueueSyncPoint& point)
+{
+    queues[static_cast<uint32_t>(type)].pendingWaits.push_back(point);
+}
+
+QueueSyncPoint QueueDependencyScheduler::GetNextSyncPoint(GpuQueueType type) const
+{
+    return { type, queues[static_cast<uint32_t>(type)].nextValue };
+}
+
+QueueSyncPoint QueueDependencyScheduler::GetLastSubmitted(GpuQueueType type) const
+{
+    return { type, queues[static_cast<uint32_t>(type)].nextValue - 1 };
+}
+
+bool QueueDependencyScheduler::IsComplete(const QueueSyncPoint& point) const
+{
+    const QueueState& source = queues[static_cast<uint32_t>(point.queue)];
+    return point.value == 0 || (source.queue && source.queue->GetCompletedValue() >= point.value);
+}
+
+// 待機はソースキューの値で単調なので、積み済みの最大値以下の待機は不要
+void QueueDependencyScheduler::ResolveWait(QueueState& state, GpuQueueType type, const QueueSyncPoint& point)
+{
+    if (point.value == 0) {
+        return;
+    }
+    ++stats.waitsRequested;
+    if (point.queue == type) {
+        ++stats.waitsElidedSameQueue;
+        return;
+    }
+    uint64_t& waitedValue = state.waitedValues[static_cast<uint32_t>(point.queue)];
+    if (waitedValue >= point.value) {
+        ++stats.waitsElidedRedundant;
+        return;
+    }
+    if (IsComplete(point)) {
+        ++stats.waitsElidedCompleted;
+        return;
+    }
+    state.queue->Wait(*queues[static_cast<uint32_t>(point.queue)].queue, point.value);
+    waitedValue = point.value;
+    ++stats.waitsIssued;
+}
+
+// コマンドリストは RecordingCommandList（ヌルバックエンドが作成したもの）
+void SimulatedGpuQueue::ExecuteCommandLists(ICommandList* const* lists, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i) {
+        executedCommandCount += static_cast<const RecordingCommandList*>(lists[i])->GetCommands().size();
+    }
+    executedListCount += count;
+}
+
+void SimulatedGpuQueue::Signal(uint64_t value)
+{
+    if (value < signaledValue) {
+        throw std::runtime_error("Simulated GPU queue signaled a decreasing fence value");
+    }
+    signaledValue = value;
+}
+
+// 待機は GPU 上のものなので CPU はブロックしない。
+// 通知済みの値であれば、このキューの以降の作業はいずれ実行できる
+void SimulatedGpuQueue::Wait(IGpuQueue& source, uint64_t value)
+{
+    if (static_cast<const SimulatedGpuQueue&>(source).signaledValue < value) {
+        throw std::runtime_error("Simulated GPU queue waits for a fence value that was never signaled (deadlock)");
+    }
+    ++waitCount;
+}
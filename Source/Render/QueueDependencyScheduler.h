@@ -0,0 +1,115 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "CommandList.h"
+
+// 複数の GPU キュー（描画/コンピュート/コピー）への投入と、キュー間の依存（フェンス待ち）を管理する。
+// キューごとに単調増加するフェンス値のタイムラインを持ち、投入の完了を QueueSyncPoint で表す。
+// 依存は GPU 上の待機として積むため、CPU はどのキューの完了も待たない。
+
+enum class GpuQueueType : uint8_t {
+    Graphics,
+    Compute,
+    Copy,
+    Count,
+};
+
+constexpr uint32_t GPU_QUEUE_TYPE_COUNT = static_cast<uint32_t>(GpuQueueType::Count);
+
+const char* GetGpuQueueTypeName(GpuQueueType type);
+
+// queue のタイムラインが value に達した時点（value == 0 は「待つものがない」）
+struct QueueSyncPoint {
+    GpuQueueType queue = GpuQueueType::Graphics;
+    uint64_t value = 0;
+};
+
+// スケジューラが扱う GPU キュー
+class IGpuQueue : public ICommandQueue {
+public:
+    // これまでに投入した作業の完了時に、このキューのタイムラインを value にする
+    virtual void Signal(uint64_t value) = 0;
+    // これ以降に投入する作業を、source のタイムラインが value に達するまで GPU 上で待たせる
+    virtual void Wait(IGpuQueue& source, uint64_t value) = 0;
+    // GPU が完了済みの値
+    virtual uint64_t GetCompletedValue() const = 0;
+};
+
+struct QueueSchedulerStats {
+    uint64_t submits[GPU_QUEUE_TYPE_COUNT] = {};
+    uint64_t waitsRequested = 0;     // 投入時に指定された依存の数
+    uint64_t waitsIssued = 0;        // 実際に積んだ GPU 上の待機
+    uint64_t waitsElidedSameQueue = 0; // 同じキューの依存（投入順に実行されるため不要）
+    uint64_t waitsElidedCompleted = 0; // 投入時点で完了済み
+    uint64_t waitsElidedRedundant = 0; // 同じキューの値以上を待つ待機を積み済み
+};
+
+// キューへの投入と依存の解決。
+// 依存は次の 3 つの場合に省略し、必要な待機だけをキューに積む。
+//  - 同じキューの依存（キュー内は投入順に実行される）
+//  - 投入時点で GPU が完了済みの依存
+//  - 同じソースキューのより大きい値をこのキューが既に待っている依存
+// 呼び出しは 1 スレッド（描画スレッド）から行うこと。
+class QueueDependencyScheduler {
+public:
+    // 登録済みのキューと統計を破棄する
+    void Initialize();
+    // type のキューを登録する（所有しない）
+    void SetQueue(GpuQueueType type, IGpuQueue* queue);
+    bool HasQueue(GpuQueueType type) const { return queues[static_cast<uint32_t>(type)].queue != nullptr; }
+
+    // waits と、AddPendingWait で積んだ type 宛ての依存を解決してから lists を投入し、完了を通知する。
+    // 戻り値: この投入の完了を表す同期点
+    QueueSyncPoint Submit(GpuQueueType type, ICommandList* const* lists, uint32_t count, const QueueSyncPoint* waits = nullptr, uint32_t waitCount = 0);
+    // type の次の Submit に依存を追加する（別のサブシステムが投入する作業を待たせる場合に使う）
+    void AddPendingWait(GpuQueueType type, const QueueSyncPoint& point);
+
+    // type の次の Submit が返す同期点（投入前に「このフレームの描画」の完了点を予約する場合に使う）
+    QueueSyncPoint GetNextSyncPoint(GpuQueueType type) const;
+    QueueSyncPoint GetLastSubmitted(GpuQueueType type) const;
+    bool IsComplete(const QueueSyncPoint& point) const;
+
+    const QueueSchedulerStats& GetStats() const { return stats; }
+    void ResetStats() { stats = {}; }
+
+private:
+    struct QueueState {
+        IGpuQueue* queue = nullptr;
+        uint64_t nextValue = 1;
+        uint64_t waitedValues[GPU_QUEUE_TYPE_COUNT] = {}; // ソースキューごとに積み済みの待機の最大値
+        std::vector<QueueSyncPoint> pendingWaits;
+    };
+
+    // point を type のキューに積む必要があれば積む
+    void ResolveWait(QueueState& state, GpuQueueType type, const QueueSyncPoint& point);
+
+    QueueState queues[GPU_QUEUE_TYPE_COUNT];
+    QueueSchedulerStats stats;
+};
+
+// GPU を使わないキュー。投入されたコマンドを数え、CompleteSubmittedWork の呼び出しで投入済みの作業を完了させる。
+// 通知されていない値を待つ待機（実際の GPU ではデッドロックになる）を検出する。
+class SimulatedGpuQueue : public IGpuQueue {
+public:
+    void ExecuteCommandLists(ICommandList* const* lists, uint32_t count) override;
+    // 例外: 値が減少する場合は std::runtime_error を送出
+    void Signal(uint64_t value) override;
+    // 例外: source がまだ value を通知していない場合は std::runtime_error を送出
+    void Wait(IGpuQueue& source, uint64_t value) override;
+    uint64_t GetCompletedValue() const override { return completedValue; }
+
+    // 通知済みの値まで完了したことにする（ヌルバックエンドではフレームの開始時に呼び出す）
+    void CompleteSubmittedWork() { completedValue = signaledValue; }
+    uint64_t GetSignaledValue() const { return signaledValue; }
+    uint64_t GetExecutedListCount() const { return executedListCount; }
+    uint64_t GetExecutedCommandCount() const { return executedCommandCount; }
+    uint64_t GetWaitCount() const { return waitCount; }
+
+private:
+    uint64_t signaledValue = 0;
+    uint64_t completedValue = 0;
+    uint64_t executedListCount = 0;
+    uint64_t executedCommandCount = 0;
+    uint64_t waitCount = 0;
+};
@@ -0,0 +1,116 @@
+﻿#include "RecordingCommandList.h"
+#include <cassert>
+
+// 記録を開始する。前フレームのコマンドは破棄する。
+void RecordingCommandList::Begin(uint32_t frameSlot)
+{
+    assert(!recording);
+    commands.clear();
+    recording = true;
+    Push(RecordedCommandType::Begin, frameSlot);
+}
+
+void RecordingCommandList::End()
+{
+    assert(recording);
+    Push(RecordedCommandType::End);
+    recording = false;
+}
+
+void RecordingCommandList::TransitionResource(ResourceId resource, ResourceState before, ResourceState after)
+{
+    Push(RecordedCommandType::TransitionResource, resource, static_cast<uint32_t>(before), static_cast<uint32_t>(after));
+}
+
+void RecordingCommandList::ResourceBarriers(const ResourceBarrier* barriers, uint32_t count)
+{
+    Push(RecordedCommandType::BarrierBatch, count);
+    for (uint32_t i = 0; i < count; ++i) {
+        const ResourceBarrier& barrier = barriers[i];
+        Push(RecordedCommandType::ResourceBarrier, barrier.resource,
+             static_cast<uint32_t>(barrier.before) | static_cast<uint32_t>(barrier.after) << 8,
+             static_cast<uint32_t>(barrier.type) | static_cast<uint32_t>(barrier.split) << 8,
+             barrier.aliasBefore);
+    }
+}
+
+void RecordingCommandList::SetRenderTarget(RenderTargetId target)
+{
+    Push(RecordedCommandType::SetRenderTarget, target);
+}
+
+void RecordingCommandList::ClearRenderTarget(RenderTargetId target, const float[4])
+{
+    Push(RecordedCommandType::ClearRenderTarget, target);
+}
+
+// ビューポートは整数に丸めて記録する（順序と大きさの検証用途のため）
+void RecordingCommandList::SetViewport(const Viewport& viewport)
+{
+    Push(RecordedCommandType::SetViewport,
+         static_cast<uint32_t>(viewport.x), static_cast<uint32_t>(viewport.y),
+         static_cast<uint32_t>(viewport.width), static_cast<uint32_t>(viewport.height));
+}
+
+void RecordingCommandList::SetScissorRect(const ScissorRect& rect)
+{
+    Push(RecordedCommandType::SetScissorRect,
+         static_cast<uint32_t>(rect.left), static_cast<uint32_t>(rect.top),
+         static_cast<uint32_t>(rect.right), static_cast<uint32_t>(rect.bottom));
+}
+
+void RecordingCommandList::SetPipeline(PipelineId pipeline)
+{
+    Push(RecordedCommandType::SetPipeline, pipeline);
+}
+
+void RecordingCommandList::SetPrimitiveTopology(PrimitiveTopology topology)
+{
+    Push(RecordedCommandType::SetPrimitiveTopology, static_cast<uint32_t>(topology));
+}
+
+void RecordingCommandList::SetVertexBuffer(uint32_t slot, const VertexBufferView& view)
+{
+    Push(RecordedCommandType::SetVertexBuffer, slot, view.sizeInBytes, view.strideInBytes);
+}
+
+void RecordingCommandList::SetShaderResource(uint32_t slot, ShaderResourceId view)
+{
+    Push(RecordedCommandType::SetShaderResource, slot, view);
+}
+
+void RecordingCommandList::DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance)
+{
+    Push(RecordedCommandType::DrawInstanced, vertexCount, instanceCount, startVertex, startInstance);
+}
+
+void RecordingCommandList::Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+    Push(RecordedCommandType::Dispatch, groupCountX, groupCountY, groupCountZ);
+}
+
+void RecordingCommandList::Push(RecordedCommandType type, uint32_t a0, uint32_t a1, uint32_t a2, uint32_t a3)
+{
+    assert(recording);
+    commands.push_back({ type, { a0, a1, a2, a3 } });
+}
+
+// 記録済みのリストを配列順に連結する。記録中のリストを投入するのは誤用。
+void RecordingCommandQueue::ExecuteCommandLists(ICommandList* const* lists, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i) {
+        const auto* list = static_cast<const RecordingCommandList*>(lists[i]);
+        assert(!list->IsRecording());
+        const std::vector<RecordedCommand>& commands = list->GetCommands();
+        executedCommands.insert(executedCommands.end(), commands.begin(), commands.end());
+    }
+    ++submitCount;
+    submittedListCount += count;
+}
+
+void RecordingCommandQueue::Reset()
+{
+    executedCommands.clear();
+    submitCount = 0;
+    submittedListCount = 0;
+}
@@ -0,0 +1,79 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "CommandList.h"
+
+// GPU を使わずにコマンドの順序を検証するための記録専用バックエンド。
+
+enum class RecordedCommandType : uint8_t {
+    Begin,
+    End,
+    TransitionResource,
+    BarrierBatch,    // ResourceBarriers の呼び出し 1 回（args[0] = バリア数）。直後に ResourceBarrier が続く
+    ResourceBarrier, // resource, before | after << 8, type | split << 8, aliasBefore
+    SetRenderTarget,
+    ClearRenderTarget,
+    SetViewport,
+    SetScissorRect,
+    SetPipeline,
+    SetPrimitiveTopology,
+    SetVertexBuffer,
+    SetShaderResource,
+    DrawInstanced,
+    Dispatch,
+};
+
+// 記録された 1 コマンド。args の意味はコマンド種別ごとに異なる
+// （例: DrawInstanced は vertexCount, instanceCount, startVertex, startInstance）。
+struct RecordedCommand {
+    RecordedCommandType type;
+    uint32_t args[4] = {};
+};
+
+// 呼び出されたコマンドをそのまま配列に保存する ICommandList 実装。
+class RecordingCommandList : public ICommandList {
+public:
+    void Begin(uint32_t frameSlot) override;
+    void End() override;
+    void TransitionResource(ResourceId resource, ResourceState before, ResourceState after) override;
+    void ResourceBarriers(const ResourceBarrier* barriers, uint32_t count) override;
+    void SetRenderTarget(RenderTargetId target) override;
+    void ClearRenderTarget(RenderTargetId target, const float color[4]) override;
+    void SetViewport(const Viewport& viewport) override;
+    void SetScissorRect(const ScissorRect& rect) override;
+    void SetPipeline(PipelineId pipeline) override;
+    void SetPrimitiveTopology(PrimitiveTopology topology) override;
+    void SetVertexBuffer(uint32_t slot, const VertexBufferView& view) override;
+    void SetShaderResource(uint32_t slot, ShaderResourceId view) override;
+    void DrawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertex, uint32_t startInstance) override;
+    void Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) override;
+
+    const std::vector<RecordedCommand>& GetCommands() const { return commands; }
+    bool IsRecording() const { return recording; }
+
+private:
+    void Push(RecordedCommandType type, uint32_t a0 = 0, uint32_t a1 = 0, uint32_t a2 = 0, uint32_t a3 = 0);
+
+    std::vector<RecordedCommand> commands;
+    bool recording = false;
+};
+
+// 投入されたコマンドリストの内容を投入順に連結して保存する ICommandQueue 実装。
+class RecordingCommandQueue : public ICommandQueue {
+public:
+    void ExecuteCommandLists(ICommandList* const* lists, uint32_t count) override;
+
+    // これまでに実行されたコマンドを投入順に連結したもの
+    const std::vector<RecordedCommand>& GetExecutedCommands() const { return executedCommands; }
+    // ExecuteCommandLists の呼び出し回数
+    uint32_t GetSubmitCount() const { return submitCount; }
+    // 投入されたコマンドリストの総数
+    uint32_t GetSubmittedListCount() const { return submittedListCount; }
+    void Reset();
+
+private:
+    std::vector<RecordedCommand> executedCommands;
+    uint32_t submitCount = 0;
+    uint32_t submittedListCount = 0;
+};
@@ -0,0 +1,79 @@
+﻿#pragma once
+
+#include <cstdint>
+#include "CommandList.h"
+#include "ParallelCommandRecorder.h"
+#include "RenderGraph.h"
+
+class IGpuParticleSimulator;
+
+// このフレームでのみ使用する CPU 書き込み可能な GPU メモリ
+struct FrameAllocation {
+    void* cpuAddress = nullptr;
+    uint64_t gpuAddress = 0;
+};
+
+// バックエンドが用意する組み込みパイプライン（シーンはこれらの頂点形式に合わせてデータを作る。
+// 頂点構造体と入力レイアウト、固定機能ステートは BuiltinPipelineStates.h）
+enum class BuiltinPipeline : uint8_t {
+    VertexColor, // スロット 0: float2 位置 + float3 色（20 バイト）
+    Instanced,   // スロット 0: float2 位置（8 バイト）、スロット 1: InstanceGpuData
+    Upscale,     // 頂点入力なし（3 頂点の全画面三角形）。テクスチャ入力 0 をバイリニアで拡大して書き出す
+    Count,
+};
+
+// BeginFrame で得る今フレームの記録先
+struct BackendFrame {
+    uint32_t frameSlot = 0;
+    ResourceId backBuffer = INVALID_RESOURCE_ID;
+    PassTarget target;
+};
+
+// 描画 API ごとの差異を吸収するバックエンド。
+// FrameRenderer はこのインターフェースだけを通してフレームを記録/投入するため、
+// 同じ CPU 経路を D3D12 と GPU を使わないヌルバックエンドの両方で実行できる。
+class IRenderBackend {
+public:
+    virtual ~IRenderBackend() = default;
+
+    virtual const char* GetName() const = 0;
+
+    // 次のフレームスロットが空くまで待ち、完了済みフレームのフレームメモリなどを回収する
+    virtual BackendFrame BeginFrame() = 0;
+    // フレームの先頭/末尾に実行するコマンドリスト（バックバッファの遷移とクリア）
+    virtual ICommandList& GetFrameBeginCommandList() = 0;
+    virtual ICommandList& GetFrameEndCommandList() = 0;
+    // 描画アイテムを並列に記録するレコーダ
+    virtual ParallelCommandRecorder& GetCommandRecorder() = 0;
+    // 戻り値: 空きが足りない場合は false
+    virtual bool AllocateFrameMemory(uint64_t size, uint64_t alignment, FrameAllocation& allocation) = 0;
+
+    // GPU の計測区間（計測に対応しないバックエンドは何もしない）
+    virtual uint32_t BeginGpuScope(ICommandList& commandList, const char* name) = 0;
+    virtual void EndGpuScope(ICommandList& commandList, uint32_t scope) = 0;
+    // フレーム最後のコマンドリストに、計測結果の解決を記録する
+    virtual void ResolveGpuScopes(ICommandList& commandList) = 0;
+
+    // lists を順序どおりに 1 回で投入し、表示して次のフレームへ進める
+    virtual void SubmitAndPresent(ICommandList* const* lists, uint32_t count) = 0;
+    // 投入済みのすべてのフレームの完了を待つ
+    virtual void WaitForIdle() = 0;
+
+    // 初期化時に一度だけ転送する静的な頂点バッファを作成する。
+    // 戻り値: バッファの GPU アドレス（バックエンドが破棄まで保持する）
+    virtual uint64_t CreateStaticBuffer(const void* data, uint64_t size) = 0;
+    virtual PipelineId GetBuiltinPipeline(BuiltinPipeline pipeline) const = 0;
+
+    // レンダーグラフの一時テクスチャのメモリ要件（既定は EstimateTextureMemory の見積もり）
+    virtual TransientMemoryRequirements GetTransientMemoryRequirements(const TextureDesc& desc) const { return EstimateTextureMemory(desc); }
+    // 今フレームのスロットの一時テクスチャ用ヒープ（heapSize 以上に広げる）の heapOffset に配置したテクスチャを返す。
+    // 同じ引数の要求には前回と同じ実体を返す
+    virtual TransientTexture AcquireTransientTexture(const TextureDesc& desc, ResourceState initialState, uint64_t heapOffset, uint64_t heapSize) = 0;
+
+    // 直近に計測できた GPU のフレーム時間（ミリ秒）。計測しないバックエンドは 0
+    virtual double GetLastGpuFrameTimeMs() const { return 0.0; }
+    // これまでに投入したコマンド数。数えないバックエンドは 0
+    virtual uint64_t GetExecutedCommandCount() const { return 0; }
+    // 非同期コンピュートで粒子を更新する実装（ParticleSystem.h）。対応しないバックエンドは nullptr
+    virtual IGpuParticleSimulator* GetGpuParticleSimulator() { return nullptr; }
+};
@@ -0,0 +1,424 @@
+﻿#include "RenderGraph.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// 一時テクスチャを配置するヒープの既定のアライメント（D3D12 の既定の配置アライメントと同じ）
+constexpr uint64_t DEFAULT_TRANSIENT_ALIGNMENT = 64 * 1024;
+// まだ一度も使用していないリソース
+constexpr uint32_t NO_USE = UINT32_MAX;
+
+uint32_t GetBytesPerPixel(TextureFormat format)
+{
+    switch (format) {
+    case TextureFormat::RGBA8Unorm:
+        return 4;
+    case TextureFormat::RGBA16Float:
+        return 8;
+    case TextureFormat::R32Float:
+        return 4;
+    case TextureFormat::D32Float:
+        return 4;
+    case TextureFormat::BC1Unorm:
+    case TextureFormat::BC3Unorm:
+    case TextureFormat::BC7Unorm:
+        // 圧縮形式はレンダーターゲットにできないため、一時テクスチャには使われない
+        return 1;
+    }
+    return 4;
+}
+
+uint64_t AlignUp(uint64_t value, uint64_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+bool LifetimesOverlap(const TransientPlacement& a, const TransientPlacement& b)
+{
+    return a.firstPass <= b.lastPass && b.firstPass <= a.lastPass;
+}
+
+bool MemoryOverlaps(const TransientPlacement& a, const TransientPlacement& b)
+{
+    return a.offset < b.offset + b.size && b.offset < a.offset + a.size;
+}
+
+} // namespace
+
+TransientMemoryRequirements EstimateTextureMemory(const TextureDesc& desc)
+{
+    const uint64_t size = static_cast<uint64_t>(desc.width) * desc.height * GetBytesPerPixel(desc.format);
+    return { AlignUp((std::max)(size, uint64_t(1)), DEFAULT_TRANSIENT_ALIGNMENT), DEFAULT_TRANSIENT_ALIGNMENT };
+}
+
+RenderGraphHandle RenderGraphBuilder::CreateTexture(const char* name, const TextureDesc& desc)
+{
+    RenderGraph::Resource resource;
+    resource.name = name;
+    resource.desc = desc;
+    graph.resources.push_back(resource);
+    return static_cast<RenderGraphHandle>(graph.resources.size() - 1);
+}
+
+void RenderGraphBuilder::Read(RenderGraphHandle texture, ResourceState state)
+{
+    graph.AddAccess(pass, texture, state, false);
+}
+
+void RenderGraphBuilder::Write(RenderGraphHandle texture, ResourceState state)
+{
+    graph.AddAccess(pass, texture, state, true);
+}
+
+void RenderGraphBuilder::SetSideEffect()
+{
+    graph.passes[pass].sideEffect = true;
+}
+
+void RenderGraph::Reset()
+{
+    resources.clear();
+    accesses.clear();
+    passes.clear();
+    executedPasses.clear();
+    placements.clear();
+    plannedBarriers.clear();
+    batchOffsets.clear();
+    transientHeapSize = 0;
+    stats = {};
+}
+
+RenderGraphHandle RenderGraph::ImportTexture(const char* name, ResourceId resource, RenderTargetId renderTarget, ResourceState initialState, ResourceState finalState)
+{
+    Resource imported;
+    imported.name = name;
+    imported.imported = true;
+    imported.physical = { resource, renderTarget };
+    imported.initialState = initialState;
+    imported.finalState = finalState;
+    resources.push_back(imported);
+    return static_cast<RenderGraphHandle>(resources.size() - 1);
+}
+
+void RenderGraph::AddPass(const char* name, const RenderPassSetupFunction& setup, RenderPassExecuteFunction execute)
+{
+    const uint32_t index = static_cast<uint32_t>(passes.size());
+    Pass pass;
+    pass.name = name;
+    pass.execute = std::move(execute);
+    pass.firstAccess = static_cast<uint32_t>(accesses.size());
+    passes.push_back(std::move(pass));
+
+    RenderGraphBuilder builder(*this, index);
+    setup(builder);
+    passes[index].accessCount = static_cast<uint32_t>(accesses.size()) - passes[index].firstAccess;
+}
+
+// 同じパスで同じテクスチャを複数回宣言した場合は 1 つにまとめる（書き込みの状態を優先する）
+// 例外: texture が無効なハンドルの場合 std::runtime_error
+void RenderGraph::AddAccess(uint32_t pass, RenderGraphHandle texture, ResourceState state, bool write)
+{
+    if (texture >= resources.size()) {
+        throw std::runtime_error("RenderGraph: invalid texture handle");
+    }
+    for (uint32_t i = passes[pass].firstAccess; i < accesses.size(); ++i) {
+        Access& access = accesses[i];
+        if (access.texture == texture) {
+            if (write || !access.write) {
+                access.state = state;
+            }
+            access.write = access.write || write;
+            return;
+        }
+    }
+    accesses.push_back({ texture, state, write });
+}
+
+// 引数:
+//  - memoryFunction: 一時テクスチャのメモリ要件（空の場合は EstimateTextureMemory で見積もる）
+void RenderGraph::Compile(const TransientMemoryFunction& memoryFunction)
+{
+    CullPasses();
+    PlaceTransients(memoryFunction);
+    PlanBarriers();
+}
+
+// 後ろのパスから、取り込んだテクスチャかすでに必要なテクスチャへ書き込むパスと、
+// 副作用のあるパスを残す。書き込みは以前の内容を保持するものとして扱い、
+// 同じテクスチャへ先に書き込んだパスも残す。
+void RenderGraph::CullPasses()
+{
+    resourceNeeded.assign(resources.size(), 0);
+    for (size_t i = 0; i < resources.size(); ++i) {
+        resourceNeeded[i] = resources[i].imported ? 1 : 0;
+    }
+
+    for (size_t p = passes.size(); p-- > 0;) {
+        Pass& pass = passes[p];
+        bool alive = pass.sideEffect;
+        for (uint32_t i = pass.firstAccess; i < pass.firstAccess + pass.accessCount; ++i) {
+            if (accesses[i].write && resourceNeeded[accesses[i].texture]) {
+                alive = true;
+            }
+        }
+        pass.culled = !alive;
+        if (alive) {
+            for (uint32_t i = pass.firstAccess; i < pass.firstAccess + pass.accessCount; ++i) {
+                resourceNeeded[accesses[i].texture] = 1;
+            }
+        }
+    }
+
+    executedPasses.clear();
+    for (uint32_t p = 0; p < passes.size(); ++p) {
+        if (!passes[p].culled) {
+            executedPasses.push_back(p);
+        }
+    }
+    stats.passCount = static_cast<uint32_t>(passes.size());
+    stats.culledPassCount = static_cast<uint32_t>(passes.size() - executedPasses.size());
+}
+
+// 一時テクスチャの使用区間を求め、大きい順に、区間の重なるテクスチャとメモリが重ならない最小のオフセットへ配置する
+void RenderGraph::PlaceTransients(const TransientMemoryFunction& memoryFunction)
+{
+    placements.clear();
+    for (Resource& resource : resources) {
+        resource.placement = UINT32_MAX;
+    }
+    for (uint32_t e = 0; e < executedPasses.size(); ++e) {
+        const Pass& pass = passes[executedPasses[e]];
+        for (uint32_t i = pass.firstAccess; i < pass.firstAccess + pass.accessCount; ++i) {
+            Resource& resource = resources[accesses[i].texture];
+            if (resource.imported) {
+                continue;
+            }
+            if (resource.placement == UINT32_MAX) {
+                const TransientMemoryRequirements requirements = memoryFunction ? memoryFunction(resource.desc) : EstimateTextureMemory(resource.desc);
+                TransientPlacement placement;
+                placement.texture = accesses[i].texture;
+                placement.alignment = (std::max)(requirements.alignment, uint64_t(1));
+                placement.size = AlignUp(requirements.size, placement.alignment);
+                placement.firstPass = e;
+                placement.lastPass = e;
+                resource.placement = static_cast<uint32_t>(placements.size());
+                placements.push_back(placement);
+            }
+            else {
+                placements[resource.placement].lastPass = e;
+            }
+        }
+    }
+
+    placementOrder.clear();
+    for (uint32_t i = 0; i < placements.size(); ++i) {
+        placementOrder.push_back(i);
+    }
+    std::sort(placementOrder.begin(), placementOrder.end(), [this](uint32_t a, uint32_t b) {
+        if (placements[a].size != placements[b].size) {
+            return placements[a].size > placements[b].size;
+        }
+        return placements[a].firstPass < placements[b].firstPass;
+    });
+
+    transientHeapSize = 0;
+    stats.transientBytes = 0;
+    for (size_t placed = 0; placed < placementOrder.size(); ++placed) {
+        TransientPlacement& placement = placements[placementOrder[placed]];
+        // 候補は 0 と、区間の重なる配置済みテクスチャの終端
+        uint64_t bestOffset = UINT64_MAX;
+        for (size_t candidate = 0; candidate <= placed; ++candidate) {
+            uint64_t offset = 0;
+            if (candidate < placed) {
+                const TransientPlacement& other = placements[placementOrder[candidate]];
+                if (!LifetimesOverlap(placement, other)) {
+                    continue;
+                }
+                offset = AlignUp(other.offset + other.size, placement.alignment);
+            }
+            if (offset >= bestOffset) {
+                continue;
+            }
+            placement.offset = offset;
+            bool fits = true;
+            for (size_t other = 0; other < placed && fits; ++other) {
+                const TransientPlacement& otherPlacement = placements[placementOrder[other]];
+                fits = !LifetimesOverlap(placement, otherPlacement) || !MemoryOverlaps(placement, otherPlacement);
+            }
+            if (fits) {
+                bestOffset = offset;
+            }
+        }
+        placement.offset = bestOffset;
+        transientHeapSize = (std::max)(transientHeapSize, placement.offset + placement.size);
+        stats.transientBytes += placement.size;
+    }
+    stats.transientTextureCount = static_cast<uint32_t>(placements.size());
+    stats.transientHeapBytes = transientHeapSize;
+}
+
+// lastUse の直後から batch の直前まで間があれば分割バリアにする
+void RenderGraph::AddTransition(RenderGraphHandle texture, ResourceState before, ResourceState after, uint32_t lastUse, uint32_t batch)
+{
+    ResourceBarrier barrier;
+    barrier.resource = texture;
+    barrier.before = before;
+    barrier.after = after;
+    const uint32_t beginBatch = lastUse == NO_USE ? 0 : lastUse + 1;
+    if (beginBatch < batch) {
+        barrier.split = BarrierSplit::BeginOnly;
+        plannedBarriers.push_back({ beginBatch, false, barrier });
+        barrier.split = BarrierSplit::EndOnly;
+        ++stats.splitBarrierCount;
+    }
+    plannedBarriers.push_back({ batch, false, barrier });
+}
+
+// 実行するパスの順にリソースの状態を追跡し、状態が変わる箇所に遷移を、
+// 一時テクスチャの最初の使用の前に（メモリを共有する場合）エイリアシングバリアを置く。
+// 一時テクスチャは最初に使用する状態で作成されているものとし、使用を終えたらその状態へ戻す。
+// 同じ位置のバリアは 1 回の ResourceBarriers にまとめる。
+void RenderGraph::PlanBarriers()
+{
+    plannedBarriers.clear();
+    stats.splitBarrierCount = 0;
+    stats.aliasingBarrierCount = 0;
+    resourceStates.resize(resources.size());
+    resourceLastUses.assign(resources.size(), NO_USE);
+    for (size_t i = 0; i < resources.size(); ++i) {
+        resourceStates[i] = resources[i].initialState;
+    }
+
+    const uint32_t finalBatch = static_cast<uint32_t>(executedPasses.size());
+    for (uint32_t e = 0; e < finalBatch; ++e) {
+        const Pass& pass = passes[executedPasses[e]];
+        for (uint32_t i = pass.firstAccess; i < pass.firstAccess + pass.accessCount; ++i) {
+            const Access& access = accesses[i];
+            Resource& resource = resources[access.texture];
+            if (!resource.imported && resourceLastUses[access.texture] == NO_USE) {
+                resource.initialState = access.state;
+                resourceStates[access.texture] = access.state;
+
+                // メモリを共有するテクスチャがあればエイリアシングバリアを置く。
+                // 直前に使い終えたテクスチャが 1 つに決まる場合だけ切り替え前のリソースを指定する
+                const TransientPlacement& placement = placements[resource.placement];
+                bool shared = false;
+                uint32_t predecessorCount = 0;
+                RenderGraphHandle predecessor = INVALID_RENDER_GRAPH_HANDLE;
+                for (const TransientPlacement& other : placements) {
+                    if (other.texture == placement.texture || !MemoryOverlaps(placement, other)) {
+                        continue;
+                    }
+                    shared = true;
+                    if (other.lastPass < placement.firstPass) {
+                        ++predecessorCount;
+                        predecessor = other.texture;
+                    }
+                }
+                if (shared) {
+                    ResourceBarrier barrier;
+                    barrier.type = BarrierType::Aliasing;
+                    barrier.resource = access.texture;
+                    barrier.aliasBefore = predecessorCount == 1 ? predecessor : INVALID_RESOURCE_ID;
+                    plannedBarriers.push_back({ e, false, barrier });
+                    ++stats.aliasingBarrierCount;
+                }
+            }
+            else if (resourceStates[access.texture] != access.state) {
+                AddTransition(access.texture, resourceStates[access.texture], access.state, resourceLastUses[access.texture], e);
+            }
+            resourceStates[access.texture] = access.state;
+            resourceLastUses[access.texture] = e;
+        }
+    }
+
+    // 取り込んだテクスチャはフレームの最後に、一時テクスチャは使用を終えた直後に
+    // （同じメモリを次のテクスチャが使い始める前に）既定の状態へ戻す
+    for (uint32_t r = 0; r < resources.size(); ++r) {
+        const Resource& resource = resources[r];
+        if (resource.imported) {
+            if (resourceStates[r] != resource.finalState) {
+                AddTransition(r, resourceStates[r], resource.finalState, resourceLastUses[r], finalBatch);
+            }
+        }
+        else if (resourceLastUses[r] != NO_USE && resourceStates[r] != resource.initialState) {
+            ResourceBarrier barrier;
+            barrier.resource = r;
+            barrier.before = resourceStates[r];
+            barrier.after = resource.initialState;
+            plannedBarriers.push_back({ resourceLastUses[r] + 1, true, barrier });
+        }
+    }
+
+    // ほぼ整列済みで件数も少ないため、一時バッファを確保しない安定な挿入ソートで並べる
+    for (size_t i = 1; i < plannedBarriers.size(); ++i) {
+        const PlannedBarrier planned = plannedBarriers[i];
+        size_t j = i;
+        while (j > 0 && (plannedBarriers[j - 1].batch > planned.batch ||
+                         (plannedBarriers[j - 1].batch == planned.batch && planned.retire && !plannedBarriers[j - 1].retire))) {
+            plannedBarriers[j] = plannedBarriers[j - 1];
+            --j;
+        }
+        plannedBarriers[j] = planned;
+    }
+    batchOffsets.assign(finalBatch + 2, 0);
+    for (const PlannedBarrier& planned : plannedBarriers) {
+        ++batchOffsets[planned.batch + 1];
+    }
+    stats.barrierBatchCount = 0;
+    for (uint32_t batch = 0; batch <= finalBatch; ++batch) {
+        if (batchOffsets[batch + 1] != 0) {
+            ++stats.barrierBatchCount;
+        }
+        batchOffsets[batch + 1] += batchOffsets[batch];
+    }
+    stats.barrierCount = static_cast<uint32_t>(plannedBarriers.size());
+}
+
+// 引数:
+//  - context: 記録先。commandList はパスが差し替えた後のリストへ続けて記録する
+//  - transientFunction: 一時テクスチャの実体を用意する関数（配置したテクスチャがない場合は呼び出さない）
+void RenderGraph::Execute(RenderPassContext& context, const TransientTextureFunction& transientFunction)
+{
+    for (const TransientPlacement& placement : placements) {
+        Resource& resource = resources[placement.texture];
+        resource.physical = transientFunction(resource.desc, resource.initialState, placement.offset, transientHeapSize);
+    }
+
+    context.graph = this;
+    const uint32_t finalBatch = static_cast<uint32_t>(executedPasses.size());
+    for (uint32_t batch = 0; batch <= finalBatch; ++batch) {
+        IssueBarriers(batch, *context.commandList);
+        if (batch < finalBatch) {
+            const Pass& pass = passes[executedPasses[batch]];
+            if (pass.execute) {
+                pass.execute(context);
+            }
+        }
+    }
+}
+
+void RenderGraph::IssueBarriers(uint32_t batch, ICommandList& commandList)
+{
+    barrierScratch.clear();
+    for (uint32_t i = batchOffsets[batch]; i < batchOffsets[batch + 1]; ++i) {
+        ResourceBarrier barrier = plannedBarriers[i].barrier;
+        barrier.resource = resources[barrier.resource].physical.resource;
+        if (barrier.aliasBefore != INVALID_RESOURCE_ID) {
+            barrier.aliasBefore = resources[barrier.aliasBefore].physical.resource;
+        }
+        barrierScratch.push_back(barrier);
+    }
+    if (!barrierScratch.empty()) {
+        commandList.ResourceBarriers(barrierScratch.data(), static_cast<uint32_t>(barrierScratch.size()));
+    }
+}
+
+void RenderGraph::GetPlannedBarriers(uint32_t before, std::vector<ResourceBarrier>& barriers) const
+{
+    barriers.clear();
+    for (uint32_t i = batchOffsets[before]; i < batchOffsets[before + 1]; ++i) {
+        barriers.push_back(plannedBarriers[i].barrier);
+    }
+}
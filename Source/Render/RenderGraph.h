@@ -0,0 +1,166 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "CommandList.h"
+
+class RenderGraph;
+
+using RenderGraphHandle = uint32_t;
+constexpr RenderGraphHandle INVALID_RENDER_GRAPH_HANDLE = UINT32_MAX;
+
+// 一時テクスチャを配置するためのメモリ要件
+struct TransientMemoryRequirements {
+    uint64_t size = 0;
+    uint64_t alignment = 0;
+};
+
+// バックエンドに問い合わせずに見積もる一時テクスチャのメモリ要件（64KB 単位に切り上げ）
+TransientMemoryRequirements EstimateTextureMemory(const TextureDesc& desc);
+
+// 一時テクスチャのメモリ要件を返す関数
+using TransientMemoryFunction = std::function<TransientMemoryRequirements(const TextureDesc& desc)>;
+// heapOffset に配置した一時テクスチャを返す関数。
+// テクスチャは initialState の状態で返し、heapSize 以上のヒープに配置する。
+using TransientTextureFunction = std::function<TransientTexture(const TextureDesc& desc, ResourceState initialState, uint64_t heapOffset, uint64_t heapSize)>;
+
+// パスのセットアップ時に使用するリソースを宣言する
+class RenderGraphBuilder {
+public:
+    // このパスで最初に書き込む一時テクスチャを作成する
+    RenderGraphHandle CreateTexture(const char* name, const TextureDesc& desc);
+    // texture を state の状態で読み取る / 書き込む
+    void Read(RenderGraphHandle texture, ResourceState state);
+    void Write(RenderGraphHandle texture, ResourceState state);
+    // 出力を読むパスがなくてもカリングしない
+    void SetSideEffect();
+
+private:
+    friend class RenderGraph;
+    RenderGraphBuilder(RenderGraph& renderGraph, uint32_t passIndex) : graph(renderGraph), pass(passIndex) {}
+
+    RenderGraph& graph;
+    uint32_t pass;
+};
+
+// パスの実行時に渡す状態
+struct RenderPassContext {
+    // 記録中のコマンドリスト。パスは記録を終えたリストを submitLists に追加し、別のリストへ差し替えてよい
+    ICommandList* commandList = nullptr;
+    std::vector<ICommandList*>* submitLists = nullptr;
+    uint32_t frameSlot = 0;
+    const RenderGraph* graph = nullptr;
+};
+
+using RenderPassSetupFunction = std::function<void(RenderGraphBuilder& builder)>;
+using RenderPassExecuteFunction = std::function<void(RenderPassContext& context)>;
+
+struct RenderGraphStats {
+    uint32_t passCount = 0;
+    uint32_t culledPassCount = 0;
+    uint32_t barrierBatchCount = 0;      // ResourceBarriers の呼び出し回数
+    uint32_t barrierCount = 0;
+    uint32_t splitBarrierCount = 0;      // BeginOnly/EndOnly の組の数
+    uint32_t aliasingBarrierCount = 0;
+    uint32_t transientTextureCount = 0;
+    uint64_t transientBytes = 0;         // エイリアシングしない場合の一時テクスチャのメモリ量
+    uint64_t transientHeapBytes = 0;     // エイリアシング後のヒープサイズ
+};
+
+// 一時テクスチャのヒープ内の配置
+struct TransientPlacement {
+    RenderGraphHandle texture = INVALID_RENDER_GRAPH_HANDLE;
+    uint64_t offset = 0;
+    uint64_t size = 0;
+    uint64_t alignment = 0;
+    uint32_t firstPass = 0; // 使用する最初/最後のパス（実行するパスだけを数えた順番）
+    uint32_t lastPass = 0;
+};
+
+// 1 フレーム分のパスとリソースの依存関係を宣言し、
+// 不要なパスのカリング、リソース状態の追跡とバリアの一括発行、一時テクスチャのメモリのエイリアシングを行う。
+// 毎フレーム Reset → Import/AddPass → Compile → Execute の順に呼び出す（容量は再利用する）。
+// バリアの計画はデバイスを使わずに行うため、Compile の結果だけを検証できる。
+class RenderGraph {
+public:
+    void Reset();
+
+    // 外部のテクスチャを取り込む。Execute の最後に finalState へ戻す
+    RenderGraphHandle ImportTexture(const char* name, ResourceId resource, RenderTargetId renderTarget, ResourceState initialState, ResourceState finalState);
+    // パスを追加する。setup はこの場で呼び出し、execute は Execute で宣言順に呼び出す
+    void AddPass(const char* name, const RenderPassSetupFunction& setup, RenderPassExecuteFunction execute);
+
+    // memoryFunction: 一時テクスチャのメモリ要件（省略時は EstimateTextureMemory）
+    void Compile(const TransientMemoryFunction& memoryFunction = {});
+    // 一時テクスチャを用意し、バリアとパスを context.commandList に順に記録する
+    void Execute(RenderPassContext& context, const TransientTextureFunction& transientFunction);
+
+    // Execute 中に実体を取得する
+    TransientTexture GetTexture(RenderGraphHandle texture) const { return resources[texture].physical; }
+
+    const RenderGraphStats& GetStats() const { return stats; }
+    bool IsPassCulled(uint32_t pass) const { return passes[pass].culled; }
+    // 実行するパスの before 番目の直前（before == 実行するパス数ならフレームの最後）に発行するバリア。
+    // resource/aliasBefore にはリソースのハンドルが入る
+    void GetPlannedBarriers(uint32_t before, std::vector<ResourceBarrier>& barriers) const;
+    const std::vector<TransientPlacement>& GetTransientPlacements() const { return placements; }
+
+private:
+    friend class RenderGraphBuilder;
+
+    struct Resource {
+        const char* name = nullptr;
+        bool imported = false;
+        TextureDesc desc;
+        TransientTexture physical;
+        ResourceState initialState = ResourceState::Common; // 一時テクスチャは最初に使用する状態（フレーム間で保つ状態）
+        ResourceState finalState = ResourceState::Common;
+        uint32_t placement = UINT32_MAX;
+    };
+
+    struct Access {
+        RenderGraphHandle texture = INVALID_RENDER_GRAPH_HANDLE;
+        ResourceState state = ResourceState::Common;
+        bool write = false;
+    };
+
+    struct Pass {
+        const char* name = nullptr;
+        RenderPassExecuteFunction execute;
+        uint32_t firstAccess = 0;
+        uint32_t accessCount = 0;
+        bool sideEffect = false;
+        bool culled = false;
+    };
+
+    // 計画したバリアと発行する位置（実行するパスの番号）。
+    // 同じ位置では使用を終えるテクスチャの遷移（retire）を他のバリアより先に発行する
+    struct PlannedBarrier {
+        uint32_t batch = 0;
+        bool retire = false;
+        ResourceBarrier barrier;
+    };
+
+    void AddAccess(uint32_t pass, RenderGraphHandle texture, ResourceState state, bool write);
+    void CullPasses();
+    void PlaceTransients(const TransientMemoryFunction& memoryFunction);
+    void PlanBarriers();
+    void AddTransition(RenderGraphHandle texture, ResourceState before, ResourceState after, uint32_t lastUse, uint32_t batch);
+    void IssueBarriers(uint32_t batch, ICommandList& commandList);
+
+    std::vector<Resource> resources;
+    std::vector<Access> accesses;
+    std::vector<Pass> passes;
+    std::vector<uint32_t> executedPasses; // カリング後に実行するパスの番号
+    std::vector<TransientPlacement> placements;
+    std::vector<PlannedBarrier> plannedBarriers; // batch の昇順
+    std::vector<uint32_t> batchOffsets;          // batch ごとの plannedBarriers の開始位置（末尾に総数）
+    std::vector<ResourceBarrier> barrierScratch;
+    std::vector<uint8_t> resourceNeeded;
+    std::vector<ResourceState> resourceStates;
+    std::vector<uint32_t> resourceLastUses;
+    std::vector<uint32_t> placementOrder;
+    uint64_t transientHeapSize = 0;
+    RenderGraphStats stats;
+};
@@ -0,0 +1,366 @@
+﻿#include "ResidencyManager.h"
+#include <cassert>
+#include <stdexcept>
+
+void ResidencyManager::Initialize(GpuHeapAllocator* heapAllocator, IResidencyBackend* residencyBackend, const ResidencyManagerDesc& managerDesc)
+{
+    allocator = heapAllocator;
+    backend = residencyBackend;
+    desc = managerDesc;
+    resources.clear();
+    unusedHandles.clear();
+    lruHead = INVALID_GPU_RESOURCE;
+    lruTail = INVALID_GPU_RESOURCE;
+    pendingFrees.clear();
+    defragmentHeap = INVALID_GPU_HEAP;
+    currentFence = 1;
+    completedFence = 0;
+    stats = {};
+}
+
+// 予算を下げた場合や、退避できるリソースがなく超過して配置した場合は、ここで超過分を退避する
+void ResidencyManager::BeginFrame(uint64_t currentFenceValue, uint64_t completedFenceValue)
+{
+    currentFence = currentFenceValue;
+    completedFence = completedFenceValue;
+    RetirePendingFrees();
+    if (stats.residentBytes > desc.budgetBytes) {
+        EvictUntil(desc.budgetBytes);
+    }
+    Defragment();
+}
+
+GpuResourceHandle ResidencyManager::CreateResource(const GpuResourceDesc& resourceDesc)
+{
+    GpuResourceHandle handle = INVALID_GPU_RESOURCE;
+    if (!unusedHandles.empty()) {
+        handle = unusedHandles.back();
+        unusedHandles.pop_back();
+    }
+    else {
+        handle = static_cast<GpuResourceHandle>(resources.size());
+        resources.emplace_back();
+    }
+    Resource& resource = resources[handle];
+    resource = {};
+    resource.desc = resourceDesc;
+    resource.alive = true;
+    ++stats.resourceCount;
+    return handle;
+}
+
+void ResidencyManager::DestroyResource(GpuResourceHandle handle)
+{
+    Resource& resource = resources[handle];
+    assert(resource.alive);
+    if (resource.allocation.IsValid()) {
+        if (!resource.desc.pinned) {
+            UnlinkLru(handle);
+        }
+        FreeAfterFrame(resource.allocation);
+        stats.residentBytes -= resource.allocation.size;
+        --stats.residentCount;
+    }
+    backend->ReleaseResource(handle);
+    resource.alive = false;
+    resource.allocation = {};
+    unusedHandles.push_back(handle);
+    --stats.resourceCount;
+}
+
+// 常駐中のリソースは LRU の末尾へ移すだけ
+const GpuAllocation& ResidencyManager::Use(GpuResourceHandle handle)
+{
+    Resource& resource = resources[handle];
+    assert(resource.alive);
+    if (!resource.allocation.IsValid()) {
+        const GpuAllocation allocation = AllocateWithinBudget(handle);
+        if (!allocation.IsValid()) {
+            throw std::runtime_error("Failed to allocate GPU memory for a placed resource");
+        }
+        const bool restoring = resource.placed;
+        resource.allocation = allocation;
+        resource.placed = true;
+        stats.residentBytes += allocation.size;
+        ++stats.residentCount;
+        if (restoring) {
+            ++stats.restores;
+        }
+        backend->PlaceResource(handle, allocation, restoring);
+        if (!resource.desc.pinned) {
+            LinkLru(handle);
+        }
+    }
+    else if (!resource.desc.pinned && lruTail != handle) {
+        UnlinkLru(handle);
+        LinkLru(handle);
+    }
+    resource.lastUsedFence = currentFence;
+    return resource.allocation;
+}
+
+// 予算は常駐しているリソースのバイト数に対して適用する（ヒープの空きは段階的な最適化で詰める）。
+// ヒープを作成できない場合（デバイスのメモリ不足）は、予算内でも古いリソースを退避して空きを作る。
+GpuAllocation ResidencyManager::AllocateWithinBudget(GpuResourceHandle handle)
+{
+    const GpuResourceDesc& resourceDesc = resources[handle].desc;
+    if (stats.residentBytes + resourceDesc.size > desc.budgetBytes) {
+        EvictUntil(desc.budgetBytes > resourceDesc.size ? desc.budgetBytes - resourceDesc.size : 0);
+    }
+    GpuAllocation allocation = allocator->Allocate(resourceDesc.heapClass, resourceDesc.size, resourceDesc.alignment);
+    while (!allocation.IsValid() && EvictOldest()) {
+        allocation = allocator->Allocate(resourceDesc.heapClass, resourceDesc.size, resourceDesc.alignment);
+    }
+    if (allocation.IsValid() && stats.residentBytes + allocation.size > desc.budgetBytes) {
+        ++stats.budgetOverruns;
+    }
+    return allocation;
+}
+
+// LRU は最後に使ったフレームの順なので、GPU が参照している可能性のあるリソースに達したら以降はすべて使用中
+void ResidencyManager::EvictUntil(uint64_t target)
+{
+    uint32_t handle = lruHead;
+    while (handle != INVALID_GPU_RESOURCE && stats.residentBytes > target) {
+        const Resource& resource = resources[handle];
+        const uint32_t next = resource.lruNext;
+        if (resource.lastUsedFence > completedFence) {
+            break;
+        }
+        if (IsEvictable(resource)) {
+            Evict(handle);
+        }
+        handle = next;
+    }
+}
+
+bool ResidencyManager::EvictOldest()
+{
+    for (uint32_t handle = lruHead; handle != INVALID_GPU_RESOURCE; handle = resources[handle].lruNext) {
+        const Resource& resource = resources[handle];
+        if (resource.lastUsedFence > completedFence) {
+            return false;
+        }
+        if (IsEvictable(resource)) {
+            Evict(handle);
+            return true;
+        }
+    }
+    return false;
+}
+
+// GPU は参照し終えているため、領域はすぐに解放できる
+void ResidencyManager::Evict(GpuResourceHandle handle)
+{
+    Resource& resource = resources[handle];
+    UnlinkLru(handle);
+    backend->EvictResource(handle);
+    allocator->Free(resource.allocation);
+    stats.residentBytes -= resource.allocation.size;
+    --stats.residentCount;
+    ++stats.evictions;
+    stats.evictedBytes += resource.allocation.size;
+    resource.allocation = {};
+}
+
+bool ResidencyManager::IsEvictable(const Resource& resource) const
+{
+    return resource.lastUsedFence <= completedFence && resource.busyFence <= completedFence;
+}
+
+void ResidencyManager::FreeAfterFrame(const GpuAllocation& allocation)
+{
+    pendingFrees.push_back({ allocation, currentFence });
+    stats.pendingFreeBytes += allocation.size;
+}
+
+void ResidencyManager::RetirePendingFrees()
+{
+    while (!pendingFrees.empty() && pendingFrees.front().fenceValue <= completedFence) {
+        allocator->Free(pendingFrees.front().allocation);
+        stats.pendingFreeBytes -= pendingFrees.front().allocation.size;
+        pendingFrees.pop_front();
+    }
+}
+
+// 対象のヒープに新しい領域を置かないようにしてから、リソースを同じプールの他のヒープへ移す。
+// 移し終えたヒープは、古い領域の解放（GPU のコピー完了後）で空になった時点でアロケータが破棄する。
+// 他のヒープに空きがなくなった場合は中断し、対象を選び直す。
+void ResidencyManager::Defragment()
+{
+    if (desc.defragmentBytesPerFrame == 0) {
+        return;
+    }
+    if (defragmentHeap == INVALID_GPU_HEAP) {
+        defragmentHeap = SelectDefragmentHeap();
+        if (defragmentHeap == INVALID_GPU_HEAP) {
+            return;
+        }
+        allocator->SetHeapExcluded(defragmentHeap, true);
+    }
+
+    uint64_t movedBytes = 0;
+    for (GpuResourceHandle handle = 0; handle < resources.size(); ++handle) {
+        Resource& resource = resources[handle];
+        if (!resource.alive || resource.allocation.heap != defragmentHeap) {
+            continue;
+        }
+        if (movedBytes >= desc.defragmentBytesPerFrame) {
+            return;
+        }
+        assert(!resource.desc.pinned);
+        const GpuAllocation to = allocator->Allocate(resource.desc.heapClass, resource.desc.size, resource.desc.alignment, false);
+        if (!to.IsValid()) {
+            allocator->SetHeapExcluded(defragmentHeap, false);
+            defragmentHeap = INVALID_GPU_HEAP;
+            return;
+        }
+        const GpuAllocation from = resource.allocation;
+        backend->MoveResource(handle, from, to);
+        FreeAfterFrame(from);
+        resource.allocation = to;
+        resource.busyFence = currentFence;
+        stats.residentBytes += to.size - from.size;
+        ++stats.moves;
+        stats.movedBytes += to.size;
+        movedBytes += to.size;
+    }
+    ++stats.defragmentedHeaps;
+    defragmentHeap = INVALID_GPU_HEAP;
+}
+
+// Small/Large のプールのうち、使用率が defragmentOccupancy 未満で最も低いヒープを選ぶ。
+// 固定のリソースを含むヒープ、空のヒープ（残しておく分）は対象にしない。同じプールの他のヒープの空きが
+// 使用量の 2 倍とヒープ 1 つ分の合計に満たない場合も、断片化した空きに収まらないか、空にしても
+// 新しい確保ですぐに埋まるため対象にしない。
+uint32_t ResidencyManager::SelectDefragmentHeap() const
+{
+    const uint32_t heapCount = allocator->GetHeapSlotCount();
+    std::vector<uint8_t> hasPinned(heapCount, 0);
+    for (const Resource& resource : resources) {
+        if (resource.alive && resource.desc.pinned && resource.allocation.IsValid()) {
+            hasPinned[resource.allocation.heap] = 1;
+        }
+    }
+    uint64_t poolFreeBytes[GPU_HEAP_CLASS_COUNT][GPU_SIZE_CLASS_COUNT] = {};
+    for (uint32_t heap = 0; heap < heapCount; ++heap) {
+        const GpuHeapInfo info = allocator->GetHeapInfo(heap);
+        if (info.alive && !info.excluded) {
+            poolFreeBytes[static_cast<uint32_t>(info.heapClass)][static_cast<uint32_t>(info.sizeClass)] += info.size - info.usedBytes;
+        }
+    }
+
+    uint32_t selected = INVALID_GPU_HEAP;
+    double lowestOccupancy = desc.defragmentOccupancy;
+    for (uint32_t heap = 0; heap < heapCount; ++heap) {
+        const GpuHeapInfo info = allocator->GetHeapInfo(heap);
+        if (!info.alive || info.excluded || info.sizeClass == GpuSizeClass::Dedicated || info.allocationCount == 0 || hasPinned[heap]) {
+            continue;
+        }
+        const double occupancy = static_cast<double>(info.usedBytes) / static_cast<double>(info.size);
+        const uint64_t otherFreeBytes = poolFreeBytes[static_cast<uint32_t>(info.heapClass)][static_cast<uint32_t>(info.sizeClass)] - (info.size - info.usedBytes);
+        if (occupancy < lowestOccupancy && otherFreeBytes >= 2 * info.usedBytes + info.size) {
+            selected = heap;
+            lowestOccupancy = occupancy;
+        }
+    }
+    return selected;
+}
+
+void ResidencyManager::LinkLru(GpuResourceHandle handle)
+{
+    Resource& resource = resources[handle];
+    resource.lruPrev = lruTail;
+    resource.lruNext = INVALID_GPU_RESOURCE;
+    if (lruTail != INVALID_GPU_RESOURCE) {
+        resources[lruTail].lruNext = handle;
+    }
+    else {
+        lruHead = handle;
+    }
+    lruTail = handle;
+}
+
+void ResidencyManager::UnlinkLru(GpuResourceHandle handle)
+{
+    Resource& resource = resources[handle];
+    if (resource.lruPrev != INVALID_GPU_RESOURCE) {
+        resources[resource.lruPrev].lruNext = resource.lruNext;
+    }
+    else {
+        lruHead = resource.lruNext;
+    }
+    if (resource.lruNext != INVALID_GPU_RESOURCE) {
+        resources[resource.lruNext].lruPrev = resource.lruPrev;
+    }
+    else {
+        lruTail = resource.lruPrev;
+    }
+    resource.lruPrev = INVALID_GPU_RESOURCE;
+    resource.lruNext = INVALID_GPU_RESOURCE;
+}
+
+bool SimulatedGpuMemoryBackend::CreateHeap(uint32_t heap, GpuHeapClass heapClass, uint64_t size)
+{
+    (void)heapClass;
+    if (heapBytes + size > deviceMemory) {
+        return false;
+    }
+    if (heap >= heaps.size()) {
+        heaps.resize(heap + 1);
+    }
+    heaps[heap] = { size, 0 };
+    heapBytes += size;
+    return true;
+}
+
+void SimulatedGpuMemoryBackend::DestroyHeap(uint32_t heap)
+{
+    if (heaps[heap].resourceCount != 0) {
+        throw std::runtime_error("Simulated GPU heap destroyed while resources are still placed in it");
+    }
+    heapBytes -= heaps[heap].size;
+    heaps[heap] = {};
+}
+
+void SimulatedGpuMemoryBackend::PlaceResource(GpuResourceHandle resource, const GpuAllocation& allocation, bool restoring)
+{
+    (void)restoring;
+    if (resource >= placements.size()) {
+        placements.resize(resource + 1);
+    }
+    if (placements[resource].IsValid()) {
+        throw std::runtime_error("Simulated GPU resource placed twice");
+    }
+    if (allocation.heap >= heaps.size() || allocation.offset + allocation.size > heaps[allocation.heap].size) {
+        throw std::runtime_error("Simulated GPU resource placed outside of its heap");
+    }
+    placements[resource] = allocation;
+    ++heaps[allocation.heap].resourceCount;
+    uploadedBytes += allocation.size;
+}
+
+void SimulatedGpuMemoryBackend::EvictResource(GpuResourceHandle resource)
+{
+    --heaps[placements[resource].heap].resourceCount;
+    placements[resource] = {};
+}
+
+// 古いリソースは今フレームの完了まで残るが、シミュレーションではすぐに新しい配置先へ数え直す
+void SimulatedGpuMemoryBackend::MoveResource(GpuResourceHandle resource, const GpuAllocation& from, const GpuAllocation& to)
+{
+    if (placements[resource].heap != from.heap || placements[resource].offset != from.offset) {
+        throw std::runtime_error("Simulated GPU resource moved from a location it does not occupy");
+    }
+    --heaps[from.heap].resourceCount;
+    ++heaps[to.heap].resourceCount;
+    placements[resource] = to;
+    copiedBytes += to.size;
+}
+
+void SimulatedGpuMemoryBackend::ReleaseResource(GpuResourceHandle resource)
+{
+    if (resource < placements.size() && placements[resource].IsValid()) {
+        EvictResource(resource);
+    }
+}
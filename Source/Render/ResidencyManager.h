@@ -0,0 +1,168 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "GpuHeapAllocator.h"
+
+// 配置リソースの常駐を予算内に保つマネージャ（デバイス非依存）。
+// リソースを最後に使ったフレームの順（LRU）に並べ、常駐しているバイト数が予算を超えると
+// GPU が参照し終えた古いリソースから退避（ヒープの領域を解放）する。退避したリソースは次に使うときに配置し直す。
+// 毎フレーム一定のバイト数まで、使用率の低いヒープのリソースを他のヒープへ移し、空になったヒープを破棄する（段階的な最適化）。
+// フレームは FrameScheduler のフェンス値で表し、GPU が参照している可能性のある領域の解放はそのフェンスの完了まで遅らせる。
+
+using GpuResourceHandle = uint32_t;
+constexpr GpuResourceHandle INVALID_GPU_RESOURCE = UINT32_MAX;
+
+struct GpuResourceDesc {
+    GpuHeapClass heapClass = GpuHeapClass::Buffer;
+    uint64_t size = 0;      // 配置に必要なバイト数（D3D12 では GetResourceAllocationInfo の値）
+    uint64_t alignment = 0;
+    bool pinned = false;    // 退避/再配置しない（GPU アドレスを保持し続けるリソースや、GPU が書き込むリソース）
+};
+
+// 配置リソースの作成と内容の移動を行うバックエンド。
+// 退避/再配置の対象になるリソースの内容は GPU から読むだけであること（移動中の書き込みは失われる）。
+class IResidencyBackend {
+public:
+    virtual ~IResidencyBackend() = default;
+
+    // allocation の位置にリソースを作成し、内容を用意する
+    // restoring: 退避したリソースを配置し直す場合は true（初回は false）
+    virtual void PlaceResource(GpuResourceHandle resource, const GpuAllocation& allocation, bool restoring) = 0;
+    // 退避するリソースを解放する（GPU は参照し終えている。内容は破棄してよい）
+    virtual void EvictResource(GpuResourceHandle resource) = 0;
+    // from の内容を to へコピーするコマンドを記録し、以降は to のリソースを使う。
+    // from の領域は今フレームのフェンスの完了後に解放されるため、それまでは古いリソースも保持すること
+    virtual void MoveResource(GpuResourceHandle resource, const GpuAllocation& from, const GpuAllocation& to) = 0;
+    // DestroyResource で破棄したリソースを解放する（GPU が参照し終えるまで保持すること）
+    virtual void ReleaseResource(GpuResourceHandle resource) = 0;
+};
+
+struct ResidencyManagerDesc {
+    uint64_t budgetBytes = UINT64_MAX;              // 常駐させるリソースのバイト数の上限
+    uint64_t defragmentBytesPerFrame = 8ull * 1024 * 1024; // 1 フレームで移動するバイト数の目安（0 で最適化しない）
+    double defragmentOccupancy = 0.5;               // 使用率がこれ未満のヒープを空にする対象にする
+};
+
+struct ResidencyStats {
+    uint32_t resourceCount = 0;
+    uint32_t residentCount = 0;
+    uint64_t residentBytes = 0;
+    uint64_t pendingFreeBytes = 0; // GPU の完了待ちで解放できていない領域
+    uint64_t evictions = 0;
+    uint64_t evictedBytes = 0;
+    uint64_t restores = 0;
+    uint64_t moves = 0;
+    uint64_t movedBytes = 0;
+    uint64_t defragmentedHeaps = 0; // 最適化で空にしたヒープ数
+    uint64_t budgetOverruns = 0;    // 退避できるリソースがなく、予算を超えて配置した回数
+};
+
+// 呼び出しは 1 スレッド（描画スレッド）から行うこと。
+class ResidencyManager {
+public:
+    // heapAllocator/residencyBackend: 領域の確保先とリソースの作成先（所有しない）
+    void Initialize(GpuHeapAllocator* heapAllocator, IResidencyBackend* residencyBackend, const ResidencyManagerDesc& managerDesc);
+
+    // 予算を変更する（超えている分は次の BeginFrame で退避する）
+    void SetBudget(uint64_t bytes) { desc.budgetBytes = bytes; }
+    uint64_t GetBudget() const { return desc.budgetBytes; }
+
+    // フレームの先頭で呼び出し、完了したフレームの領域を解放して予算の超過分を退避し、段階的な最適化を 1 ステップ進める。
+    // currentFenceValue: 今フレームが完了時に発行するフェンス値、completedFenceValue: GPU が完了済みのフェンス値
+    void BeginFrame(uint64_t currentFenceValue, uint64_t completedFenceValue);
+
+    // リソースを登録する（常駐させるのは最初の Use の時点）
+    GpuResourceHandle CreateResource(const GpuResourceDesc& resourceDesc);
+    // 今フレームのコマンドを記録した後でも呼び出せる（領域はこのフレームの完了まで解放しない）
+    void DestroyResource(GpuResourceHandle resource);
+    // resource を今フレームで使う。常駐していなければ領域を確保して配置する（必要なら古いリソースを退避する）。
+    // 例外: 退避できるリソースがなく、新しいヒープも作成できない場合は std::runtime_error を送出
+    const GpuAllocation& Use(GpuResourceHandle resource);
+
+    bool IsResident(GpuResourceHandle resource) const { return resources[resource].allocation.IsValid(); }
+    const GpuAllocation& GetAllocation(GpuResourceHandle resource) const { return resources[resource].allocation; }
+    const ResidencyStats& GetStats() const { return stats; }
+
+private:
+    struct Resource {
+        GpuResourceDesc desc;
+        GpuAllocation allocation;     // 常駐していない間は無効
+        uint64_t lastUsedFence = 0;   // 最後に使ったフレーム（LRU の順序）
+        uint64_t busyFence = 0;       // 移動のコピーが完了するフレーム（それまでは退避しない）
+        uint32_t lruPrev = INVALID_GPU_RESOURCE;
+        uint32_t lruNext = INVALID_GPU_RESOURCE;
+        bool alive = false;
+        bool placed = false;          // 一度でも配置したか（配置し直しを restores として数える）
+    };
+    struct PendingFree {
+        GpuAllocation allocation;
+        uint64_t fenceValue;
+    };
+
+    // 予算内に収まるよう退避してから領域を確保する
+    GpuAllocation AllocateWithinBudget(GpuResourceHandle resource);
+    // 常駐バイト数が target 以下になるまで、GPU が参照し終えた古いリソースから退避する
+    void EvictUntil(uint64_t target);
+    // 退避できる最も古いリソースを 1 つ退避する
+    // 戻り値: 退避できるリソースがない場合は false
+    bool EvictOldest();
+    void Evict(GpuResourceHandle resource);
+    bool IsEvictable(const Resource& resource) const;
+    void FreeAfterFrame(const GpuAllocation& allocation);
+    void RetirePendingFrees();
+
+    void Defragment();
+    // 戻り値: 空にするヒープ。対象がなければ INVALID_GPU_HEAP
+    uint32_t SelectDefragmentHeap() const;
+
+    void LinkLru(GpuResourceHandle resource);
+    void UnlinkLru(GpuResourceHandle resource);
+
+    GpuHeapAllocator* allocator = nullptr;
+    IResidencyBackend* backend = nullptr;
+    ResidencyManagerDesc desc;
+    std::vector<Resource> resources; // ハンドルで引く
+    std::vector<GpuResourceHandle> unusedHandles;
+    uint32_t lruHead = INVALID_GPU_RESOURCE; // 常駐中の固定でないリソース。先頭が最も古い
+    uint32_t lruTail = INVALID_GPU_RESOURCE;
+    std::deque<PendingFree> pendingFrees; // フェンス値の順
+    uint32_t defragmentHeap = INVALID_GPU_HEAP; // 空にしている途中のヒープ
+    uint64_t currentFence = 1;
+    uint64_t completedFence = 0;
+    ResidencyStats stats;
+};
+
+// GPU を使わないバックエンド。ヒープとリソースを数え、作成できるヒープの合計を deviceMemoryBytes に制限する
+// （デバイスのメモリ不足を再現する）。配置/退避/移動の整合性（二重配置、ヒープ外への配置）を検査する。
+class SimulatedGpuMemoryBackend : public IGpuHeapBackend, public IResidencyBackend {
+public:
+    explicit SimulatedGpuMemoryBackend(uint64_t deviceMemoryBytes = UINT64_MAX) : deviceMemory(deviceMemoryBytes) {}
+
+    bool CreateHeap(uint32_t heap, GpuHeapClass heapClass, uint64_t size) override;
+    // 例外: リソースが残っているヒープを破棄した場合は std::runtime_error を送出
+    void DestroyHeap(uint32_t heap) override;
+    // 例外: 配置済みのリソースを配置した場合や、ヒープの範囲外の場合は std::runtime_error を送出
+    void PlaceResource(GpuResourceHandle resource, const GpuAllocation& allocation, bool restoring) override;
+    void EvictResource(GpuResourceHandle resource) override;
+    void MoveResource(GpuResourceHandle resource, const GpuAllocation& from, const GpuAllocation& to) override;
+    void ReleaseResource(GpuResourceHandle resource) override;
+
+    uint64_t GetHeapBytes() const { return heapBytes; }
+    uint64_t GetCopiedBytes() const { return copiedBytes; }
+    uint64_t GetUploadedBytes() const { return uploadedBytes; }
+
+private:
+    struct HeapState {
+        uint64_t size = 0;
+        uint32_t resourceCount = 0;
+    };
+
+    uint64_t deviceMemory = 0;
+    uint64_t heapBytes = 0;
+    uint64_t copiedBytes = 0;
+    uint64_t uploadedBytes = 0; // 配置時の内容の転送（初回と配置し直し）
+    std::vector<HeapState> heaps;
+    std::vector<GpuAllocation> placements; // リソースごとの配置先（無効 = 配置していない）
+};
@@ -0,0 +1,197 @@
+﻿#include "ShaderCache.h"
+#include "../Core/Hash.h"
+#include "../Core/JobSystem.h"
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct ShaderCacheFileHeader {
+    uint32_t magic;
+    uint32_t formatVersion;
+    uint64_t key;
+    uint64_t payloadSize;
+    uint64_t payloadHash;
+};
+static_assert(sizeof(ShaderCacheFileHeader) == 32, "cache file header must be tightly packed");
+
+// 区切りを入れて連結の曖昧さ（"ab"+"c" と "a"+"bc"）をなくす
+uint64_t HashField(uint64_t seed, std::string_view field)
+{
+    return HashCombine(HashString(field, seed), field.size());
+}
+
+// 一時ファイル名の接尾辞。同じキーを別のプロセスやスレッド（ワーカー以外を含む）が同時に書き出しても衝突しない
+std::string MakeTempFileSuffix()
+{
+#ifdef _WIN32
+    const long long processId = _getpid();
+#else
+    const long long processId = getpid();
+#endif
+    const size_t threadId = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    return ".tmp" + std::to_string(processId) + "-" + std::to_string(threadId);
+}
+
+} // namespace
+
+// 引数:
+//  - directory: キャッシュファイルの保存先
+//  - compilerId: コンパイラ識別子（変更されると既存のキャッシュはすべて別キーになる）
+void ShaderCache::Initialize(const std::filesystem::path& directory, std::string_view compilerId)
+{
+    cacheDirectory = directory;
+    compilerHash = HashCombine(HashString(compilerId), FILE_FORMAT_VERSION);
+    std::error_code error;
+    std::filesystem::create_directories(cacheDirectory, error);
+}
+
+uint64_t ShaderCache::ComputeKey(const ShaderCompileRequest& request) const
+{
+    uint64_t hash = compilerHash;
+    hash = HashField(hash, request.source);
+    hash = HashCombine(hash, request.defines.size());
+    for (const auto& [name, value] : request.defines) {
+        hash = HashField(hash, name);
+        hash = HashField(hash, value);
+    }
+    hash = HashField(hash, request.entryPoint);
+    hash = HashField(hash, request.profile);
+    hash = HashCombine(hash, request.flags);
+    return hash;
+}
+
+// メモリ → ディスク → コンパイルの順に探す。コンパイル中はロックを保持しない。
+bool ShaderCache::GetOrCompile(const ShaderCompileRequest& request, const ShaderCompileFunction& compile, ShaderBytecode& bytecode, std::string& errors)
+{
+    const uint64_t key = ComputeKey(request);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = memoryCache.find(key);
+        if (it != memoryCache.end()) {
+            bytecode = it->second;
+            ++stats.memoryHits;
+            return true;
+        }
+    }
+
+    if (LoadFromDisk(key, bytecode)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.diskHits;
+        memoryCache.emplace(key, bytecode);
+        return true;
+    }
+
+    if (!compile(request, bytecode, errors)) {
+        return false;
+    }
+    StoreToDisk(key, bytecode);
+    std::lock_guard<std::mutex> lock(mutex);
+    ++stats.compiles;
+    memoryCache.emplace(key, bytecode);
+    return true;
+}
+
+std::vector<ShaderBytecode> ShaderCache::GetOrCompileAll(const std::vector<ShaderCompileRequest>& requests, const ShaderCompileFunction& compile, JobSystem& jobSystem)
+{
+    const uint32_t count = static_cast<uint32_t>(requests.size());
+    std::vector<ShaderBytecode> results(count);
+    std::vector<std::string> errors(count);
+    std::vector<uint8_t> succeeded(count, 0);
+
+    jobSystem.ParallelFor(count, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            succeeded[i] = GetOrCompile(requests[i], compile, results[i], errors[i]) ? 1 : 0;
+        }
+    });
+
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!succeeded[i]) {
+            throw std::runtime_error("Failed to compile shader '" + requests[i].name + "': " + errors[i]);
+        }
+    }
+    return results;
+}
+
+// ヘッダのマジック/バージョン/キー/サイズとペイロードのハッシュを検証する。
+// 壊れている、または古い形式のファイルは削除して false を返す。
+bool ShaderCache::LoadFromDisk(uint64_t key, ShaderBytecode& bytecode)
+{
+    const std::filesystem::path path = GetFilePath(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+
+    std::error_code sizeError;
+    const uintmax_t fileSize = std::filesystem::file_size(path, sizeError);
+    ShaderCacheFileHeader header{};
+    bool valid = !sizeError && fileSize >= sizeof(header) && static_cast<bool>(file.read(reinterpret_cast<char*>(&header), sizeof(header)));
+    valid = valid && header.magic == FILE_MAGIC && header.formatVersion == FILE_FORMAT_VERSION && header.key == key;
+    valid = valid && header.payloadSize == fileSize - sizeof(header);
+    if (valid) {
+        bytecode.resize(static_cast<size_t>(header.payloadSize));
+        valid = static_cast<bool>(file.read(reinterpret_cast<char*>(bytecode.data()), static_cast<std::streamsize>(bytecode.size())));
+        valid = valid && HashBytes(bytecode.data(), bytecode.size()) == header.payloadHash;
+    }
+    if (!valid) {
+        file.close();
+        bytecode.clear();
+        std::error_code error;
+        std::filesystem::remove(path, error);
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.invalidatedFiles;
+    }
+    return valid;
+}
+
+// 一時ファイルに書き出してから置き換え、書き込み途中のファイルが読まれないようにする
+bool ShaderCache::StoreToDisk(uint64_t key, const ShaderBytecode& bytecode)
+{
+    const std::filesystem::path path = GetFilePath(key);
+    std::filesystem::path tempPath = path;
+    tempPath += MakeTempFileSuffix();
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return false;
+        }
+        const ShaderCacheFileHeader header{ FILE_MAGIC, FILE_FORMAT_VERSION, key, bytecode.size(), HashBytes(bytecode.data(), bytecode.size()) };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(bytecode.data()), static_cast<std::streamsize>(bytecode.size()));
+        if (!file) {
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error) {
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
+
+ShaderCacheStats ShaderCache::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+std::filesystem::path ShaderCache::GetFilePath(uint64_t key) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.cso", static_cast<unsigned long long>(key));
+    return cacheDirectory / name;
+}
@@ -0,0 +1,77 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class JobSystem;
+
+using ShaderBytecode = std::vector<uint8_t>;
+
+// シェーダのコンパイル条件。キャッシュキーはこの内容すべてから計算する。
+struct ShaderCompileRequest {
+    std::string name; // ログ用の名前（キーには含めない）
+    std::string source;
+    std::vector<std::pair<std::string, std::string>> defines;
+    std::string entryPoint;
+    std::string profile;
+    uint32_t flags = 0;
+};
+
+// request をコンパイルして bytecode に格納する関数。失敗時は false を返し errors にメッセージを格納する。
+// 複数のワーカースレッドから同時に呼び出される。
+using ShaderCompileFunction = std::function<bool(const ShaderCompileRequest& request, ShaderBytecode& bytecode, std::string& errors)>;
+
+struct ShaderCacheStats {
+    uint32_t memoryHits = 0;
+    uint32_t diskHits = 0;
+    uint32_t compiles = 0;
+    uint32_t invalidatedFiles = 0;
+};
+
+// コンパイル済みシェーダのコンテンツアドレス型キャッシュ。
+// キー（ソース/マクロ/エントリポイント/プロファイル/フラグ/コンパイラ識別子のハッシュ）を
+// ファイル名にしてディスクへ保存し、ヘッダの検証に失敗したファイルは破棄して再コンパイルする。
+//
+// ファイル形式（リトルエンディアン）:
+//   uint32 magic 'SHDC' / uint32 formatVersion / uint64 key / uint64 payloadSize / uint64 payloadHash / payload
+class ShaderCache {
+public:
+    static constexpr uint32_t FILE_MAGIC = 0x43444853; // "SHDC"
+    static constexpr uint32_t FILE_FORMAT_VERSION = 1;
+
+    // directory: キャッシュファイルの保存先（存在しなければ作成する）
+    // compilerId: コンパイラのバージョンなど、変わったらキャッシュを無効にしたい識別子
+    void Initialize(const std::filesystem::path& directory, std::string_view compilerId);
+
+    uint64_t ComputeKey(const ShaderCompileRequest& request) const;
+
+    // キャッシュを検索し、見つからなければ compile でコンパイルして保存する。
+    // 戻り値: 成功時 true。失敗時は errors にコンパイラのメッセージを格納する
+    bool GetOrCompile(const ShaderCompileRequest& request, const ShaderCompileFunction& compile, ShaderBytecode& bytecode, std::string& errors);
+
+    // 複数のシェーダをジョブシステム上で並列に取得/コンパイルする。
+    // 例外: いずれかのコンパイルに失敗した場合は std::runtime_error を送出（メッセージにシェーダ名とエラーを含む）
+    std::vector<ShaderBytecode> GetOrCompileAll(const std::vector<ShaderCompileRequest>& requests, const ShaderCompileFunction& compile, JobSystem& jobSystem);
+
+    // ディスクからの読み込み/書き込み（ヘッダの検証を含む）
+    bool LoadFromDisk(uint64_t key, ShaderBytecode& bytecode);
+    bool StoreToDisk(uint64_t key, const ShaderBytecode& bytecode);
+
+    ShaderCacheStats GetStats() const;
+
+private:
+    std::filesystem::path GetFilePath(uint64_t key) const;
+
+    std::filesystem::path cacheDirectory;
+    uint64_t compilerHash = 0;
+
+    mutable std::mutex mutex; // 以下をワーカースレッドから保護する
+    std::unordered_map<uint64_t, ShaderBytecode> memoryCache;
+    ShaderCacheStats stats;
+};
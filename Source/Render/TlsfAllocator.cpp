@@ -0,0 +1,233 @@
+﻿#include "TlsfAllocator.h"
+#include "LinearRingAllocator.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+// 範囲全体を 1 つの空きブロックにする（末尾の granularity に満たない端数は使わない）
+void TlsfAllocator::Initialize(uint64_t rangeCapacity, uint64_t granularity)
+{
+    assert(std::has_single_bit(granularity));
+    granularityLog2 = static_cast<uint32_t>(std::countr_zero(granularity));
+    capacity = rangeCapacity & ~(granularity - 1);
+    usedSize = 0;
+    allocationCount = 0;
+    freeBlockCount = 0;
+    flBitmap = 0;
+    std::fill(std::begin(slBitmaps), std::end(slBitmaps), 0u);
+    for (auto& heads : freeHeads) {
+        std::fill(std::begin(heads), std::end(heads), INVALID_BLOCK);
+    }
+    blocks.clear();
+    unusedBlocks.clear();
+    if (capacity == 0) {
+        return;
+    }
+    const uint32_t block = NewBlock();
+    blocks[block].size = capacity;
+    InsertFree(block);
+}
+
+// 区分は先頭の空きブロックだけを見る（区分内の大きさの差は 1/16 未満）。
+// 検索の切り上げで範囲ちょうどの空きブロックを見落とす場合に備え、切り上げ前の区分のリストも確認する。
+uint32_t TlsfAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+    const uint64_t granularity = 1ull << granularityLog2;
+    size = AlignUp((std::max)(size, uint64_t(1)), granularity);
+    alignment = (std::max)(alignment, granularity);
+    const uint64_t searchSize = size + alignment - granularity; // 先頭を alignment に合わせる余白を含む
+    if (searchSize > capacity - usedSize) {
+        return INVALID_BLOCK;
+    }
+
+    uint32_t block = INVALID_BLOCK;
+    uint32_t fl = 0;
+    uint32_t sl = 0;
+    MapSearch(searchSize, fl, sl);
+    uint32_t slMap = slBitmaps[fl] & (~0u << sl);
+    if (slMap == 0) {
+        const uint64_t flMap = flBitmap & (~0ull << (fl + 1));
+        if (flMap != 0) {
+            fl = static_cast<uint32_t>(std::countr_zero(flMap));
+            slMap = slBitmaps[fl];
+        }
+    }
+    if (slMap != 0) {
+        sl = static_cast<uint32_t>(std::countr_zero(slMap));
+        block = freeHeads[fl][sl];
+    }
+    if (block == INVALID_BLOCK) {
+        MapInsert(searchSize, fl, sl);
+        for (uint32_t candidate = freeHeads[fl][sl]; candidate != INVALID_BLOCK; candidate = blocks[candidate].nextFree) {
+            const Block& b = blocks[candidate];
+            if (AlignUp(b.offset, alignment) - b.offset + size <= b.size) {
+                block = candidate;
+                break;
+            }
+        }
+        if (block == INVALID_BLOCK) {
+            return INVALID_BLOCK;
+        }
+    }
+
+    RemoveFree(block);
+    const uint64_t padding = AlignUp(blocks[block].offset, alignment) - blocks[block].offset;
+    if (padding != 0) {
+        const uint32_t aligned = Split(block, padding);
+        InsertFree(block);
+        block = aligned;
+    }
+    if (blocks[block].size > size) {
+        InsertFree(Split(block, size));
+    }
+    usedSize += size;
+    ++allocationCount;
+    return block;
+}
+
+void TlsfAllocator::Free(uint32_t block)
+{
+    assert(block < blocks.size() && !blocks[block].isFree && "TLSF block freed twice");
+    usedSize -= blocks[block].size;
+    --allocationCount;
+
+    const uint32_t next = blocks[block].nextPhysical;
+    if (next != INVALID_BLOCK && blocks[next].isFree) {
+        RemoveFree(next);
+        blocks[block].size += blocks[next].size;
+        blocks[block].nextPhysical = blocks[next].nextPhysical;
+        if (blocks[block].nextPhysical != INVALID_BLOCK) {
+            blocks[blocks[block].nextPhysical].prevPhysical = block;
+        }
+        ReleaseBlock(next);
+    }
+    const uint32_t prev = blocks[block].prevPhysical;
+    if (prev != INVALID_BLOCK && blocks[prev].isFree) {
+        RemoveFree(prev);
+        blocks[prev].size += blocks[block].size;
+        blocks[prev].nextPhysical = blocks[block].nextPhysical;
+        if (blocks[prev].nextPhysical != INVALID_BLOCK) {
+            blocks[blocks[prev].nextPhysical].prevPhysical = prev;
+        }
+        ReleaseBlock(block);
+        block = prev;
+    }
+    InsertFree(block);
+}
+
+uint64_t TlsfAllocator::GetLargestFreeBlock() const
+{
+    if (flBitmap == 0) {
+        return 0;
+    }
+    const uint32_t fl = 63 - static_cast<uint32_t>(std::countl_zero(flBitmap));
+    const uint32_t sl = 31 - static_cast<uint32_t>(std::countl_zero(slBitmaps[fl]));
+    uint64_t largest = 0;
+    for (uint32_t block = freeHeads[fl][sl]; block != INVALID_BLOCK; block = blocks[block].nextFree) {
+        largest = (std::max)(largest, blocks[block].size);
+    }
+    return largest;
+}
+
+// granularity 単位の大きさ u が 16 未満なら第 1 段 0 の u 番目、
+// それ以上なら最上位ビットの位置で第 1 段を決め、その下の 4 ビットを第 2 段にする
+void TlsfAllocator::MapInsert(uint64_t size, uint32_t& fl, uint32_t& sl) const
+{
+    const uint64_t units = size >> granularityLog2;
+    if (units < SL_COUNT) {
+        fl = 0;
+        sl = static_cast<uint32_t>(units);
+        return;
+    }
+    const uint32_t topBit = static_cast<uint32_t>(std::bit_width(units)) - 1;
+    fl = topBit - SL_LOG2 + 1;
+    sl = static_cast<uint32_t>(units >> (topBit - SL_LOG2)) - SL_COUNT;
+}
+
+// 区分の幅ぶん切り上げてから区分を求めると、その区分以上の空きブロックはすべて size 以上になる
+void TlsfAllocator::MapSearch(uint64_t size, uint32_t& fl, uint32_t& sl) const
+{
+    uint64_t units = size >> granularityLog2;
+    if (units >= SL_COUNT) {
+        const uint32_t topBit = static_cast<uint32_t>(std::bit_width(units)) - 1;
+        units += (1ull << (topBit - SL_LOG2)) - 1;
+    }
+    MapInsert(units << granularityLog2, fl, sl);
+}
+
+uint32_t TlsfAllocator::NewBlock()
+{
+    if (!unusedBlocks.empty()) {
+        const uint32_t block = unusedBlocks.back();
+        unusedBlocks.pop_back();
+        blocks[block] = {};
+        return block;
+    }
+    blocks.emplace_back();
+    return static_cast<uint32_t>(blocks.size() - 1);
+}
+
+void TlsfAllocator::ReleaseBlock(uint32_t block)
+{
+    unusedBlocks.push_back(block);
+}
+
+void TlsfAllocator::InsertFree(uint32_t block)
+{
+    uint32_t fl = 0;
+    uint32_t sl = 0;
+    MapInsert(blocks[block].size, fl, sl);
+    Block& b = blocks[block];
+    b.isFree = true;
+    b.prevFree = INVALID_BLOCK;
+    b.nextFree = freeHeads[fl][sl];
+    if (b.nextFree != INVALID_BLOCK) {
+        blocks[b.nextFree].prevFree = block;
+    }
+    freeHeads[fl][sl] = block;
+    flBitmap |= 1ull << fl;
+    slBitmaps[fl] |= 1u << sl;
+    ++freeBlockCount;
+}
+
+void TlsfAllocator::RemoveFree(uint32_t block)
+{
+    uint32_t fl = 0;
+    uint32_t sl = 0;
+    MapInsert(blocks[block].size, fl, sl);
+    Block& b = blocks[block];
+    if (b.prevFree != INVALID_BLOCK) {
+        blocks[b.prevFree].nextFree = b.nextFree;
+    }
+    else {
+        freeHeads[fl][sl] = b.nextFree;
+    }
+    if (b.nextFree != INVALID_BLOCK) {
+        blocks[b.nextFree].prevFree = b.prevFree;
+    }
+    if (freeHeads[fl][sl] == INVALID_BLOCK) {
+        slBitmaps[fl] &= ~(1u << sl);
+        if (slBitmaps[fl] == 0) {
+            flBitmap &= ~(1ull << fl);
+        }
+    }
+    b.isFree = false;
+    --freeBlockCount;
+}
+
+uint32_t TlsfAllocator::Split(uint32_t block, uint64_t size)
+{
+    const uint32_t rest = NewBlock(); // blocks が再確保される場合があるので参照は後で取る
+    Block& b = blocks[block];
+    Block& r = blocks[rest];
+    r.offset = b.offset + size;
+    r.size = b.size - size;
+    r.prevPhysical = block;
+    r.nextPhysical = b.nextPhysical;
+    if (b.nextPhysical != INVALID_BLOCK) {
+        blocks[b.nextPhysical].prevPhysical = rest;
+    }
+    b.nextPhysical = rest;
+    b.size = size;
+    return rest;
+}
@@ -0,0 +1,77 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// 固定容量の範囲から任意の大きさの領域を確保/解放する TLSF（Two-Level Segregated Fit）アロケータ。
+// 空きブロックを大きさの 2 段階の区分（2 のべき乗の区分と、それを 16 等分した区分）ごとのリストで管理し、
+// 解放と通常の確保はビットマップの検索だけで O(1) に行う。ただし切り上げた区分に空きがないときは、
+// 切り上げ前の区分の空きリストを先頭から線形にたどって収まるブロックを探す（そのリストの長さに比例する）。
+// 解放したブロックは前後の空きブロックと結合する。
+// オフセット計算のみを行い管理情報は範囲の外に持つため、CPU から書き込めない GPU ヒープにも使用できる。
+class TlsfAllocator {
+public:
+    static constexpr uint32_t INVALID_BLOCK = UINT32_MAX;
+
+    // rangeCapacity: 範囲のバイト数
+    // granularity: 確保の最小単位（2 のべき乗。オフセットと大きさはすべてこの倍数になる）
+    void Initialize(uint64_t rangeCapacity, uint64_t granularity);
+
+    // size バイトを alignment 境界に確保する（alignment は 2 のべき乗）。
+    // 戻り値: ブロック番号。収まる空きがない場合は INVALID_BLOCK
+    uint32_t Allocate(uint64_t size, uint64_t alignment);
+    void Free(uint32_t block);
+
+    uint64_t GetOffset(uint32_t block) const { return blocks[block].offset; }
+    // 確保したブロックの大きさ（granularity に切り上げた値）
+    uint64_t GetSize(uint32_t block) const { return blocks[block].size; }
+
+    uint64_t GetCapacity() const { return capacity; }
+    uint64_t GetUsedSize() const { return usedSize; }
+    uint64_t GetFreeSize() const { return capacity - usedSize; }
+    uint32_t GetAllocationCount() const { return allocationCount; }
+    uint32_t GetFreeBlockCount() const { return freeBlockCount; }
+    // 最大の空きブロックのバイト数（最上位の区分のリストをたどるため、計測用）
+    uint64_t GetLargestFreeBlock() const;
+
+private:
+    // 第 2 段の区分数（2 のべき乗の区分を 16 等分する）
+    static constexpr uint32_t SL_LOG2 = 4;
+    static constexpr uint32_t SL_COUNT = 1u << SL_LOG2;
+    // 第 1 段の区分数（granularity 単位の大きさが 2^63 までを扱える数）
+    static constexpr uint32_t FL_COUNT = 64 - SL_LOG2 + 1;
+
+    struct Block {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint32_t prevPhysical = INVALID_BLOCK; // 範囲内で直前/直後のブロック
+        uint32_t nextPhysical = INVALID_BLOCK;
+        uint32_t prevFree = INVALID_BLOCK;     // 同じ区分の空きリスト（空きブロックのときだけ有効）
+        uint32_t nextFree = INVALID_BLOCK;
+        bool isFree = false;
+    };
+
+    // 大きさ size の空きブロックを入れる区分
+    void MapInsert(uint64_t size, uint32_t& fl, uint32_t& sl) const;
+    // 大きさ size 以上のブロックだけを持つ最小の区分
+    void MapSearch(uint64_t size, uint32_t& fl, uint32_t& sl) const;
+
+    uint32_t NewBlock();
+    void ReleaseBlock(uint32_t block);
+    void InsertFree(uint32_t block);
+    void RemoveFree(uint32_t block);
+    // block の先頭 size バイトを残し、残りを新しいブロックとして直後に置く
+    // 戻り値: 新しいブロックの番号
+    uint32_t Split(uint32_t block, uint64_t size);
+
+    uint64_t capacity = 0;
+    uint32_t granularityLog2 = 0;
+    uint64_t usedSize = 0;
+    uint32_t allocationCount = 0;
+    uint32_t freeBlockCount = 0;
+    uint64_t flBitmap = 0;
+    uint32_t slBitmaps[FL_COUNT] = {};
+    uint32_t freeHeads[FL_COUNT][SL_COUNT] = {};
+    std::vector<Block> blocks;
+    std::vector<uint32_t> unusedBlocks; // blocks の再利用できる要素
+};
@@ -0,0 +1,153 @@
+﻿#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "../Core/Hash.h"
+
+// 頂点入力レイアウトをコンパイル時に記述するテンプレート。
+// 属性の並びから各要素のオフセットとストライドを求め、頂点構造体の大きさと一致することを static_assert で検証する。
+// バックエンドは GetElements() の結果を自身の入力レイアウト記述へ変換する（D3D12 は D3D12PipelineState.h）。
+
+enum class VertexElementFormat : uint8_t {
+    Float1,
+    Float2,
+    Float3,
+    Float4,
+    UNorm8x4,
+};
+
+enum class VertexInputRate : uint8_t {
+    PerVertex,
+    PerInstance, // 1 インスタンスごとに進める
+};
+
+constexpr uint32_t GetVertexElementSize(VertexElementFormat format)
+{
+    switch (format) {
+    case VertexElementFormat::Float1:
+        return 4;
+    case VertexElementFormat::Float2:
+        return 8;
+    case VertexElementFormat::Float3:
+        return 12;
+    case VertexElementFormat::Float4:
+        return 16;
+    case VertexElementFormat::UNorm8x4:
+        return 4;
+    }
+    return 0;
+}
+
+// テンプレート引数に渡すセマンティクス名（文字列リテラルから作る）
+template <size_t N>
+struct VertexSemantic {
+    char name[N] = {};
+
+    constexpr VertexSemantic(const char (&text)[N])
+    {
+        for (size_t i = 0; i < N; ++i) {
+            name[i] = text[i];
+        }
+    }
+};
+
+// 1 つの頂点属性。例: VertexAttribute<"POSITION", VertexElementFormat::Float2>
+template <VertexSemantic Semantic, VertexElementFormat Format, uint32_t SemanticIndex = 0>
+struct VertexAttribute {
+    static constexpr const char* SEMANTIC = Semantic.name;
+    static constexpr VertexElementFormat FORMAT = Format;
+    static constexpr uint32_t SEMANTIC_INDEX = SemanticIndex;
+    static constexpr uint32_t SIZE = GetVertexElementSize(Format);
+};
+
+// バックエンドへ渡す入力要素 1 つ分
+struct VertexElement {
+    const char* semantic = nullptr;
+    uint32_t semanticIndex = 0;
+    VertexElementFormat format = VertexElementFormat::Float1;
+    uint32_t slot = 0;
+    uint32_t offset = 0;
+    VertexInputRate rate = VertexInputRate::PerVertex;
+};
+
+// 1 つの入力スロット（頂点バッファ）の形式。属性は Vertex の先頭から詰めて並んでいるものとする
+template <typename Vertex, VertexInputRate Rate, typename... Attributes>
+struct VertexStream {
+    static_assert(sizeof...(Attributes) > 0, "a vertex stream needs at least one attribute");
+
+    using VertexType = Vertex;
+    static constexpr VertexInputRate RATE = Rate;
+    static constexpr uint32_t ELEMENT_COUNT = sizeof...(Attributes);
+    static constexpr uint32_t STRIDE = (Attributes::SIZE + ...);
+    static_assert(STRIDE == sizeof(Vertex), "vertex attributes must cover the vertex struct exactly");
+
+    // 属性 i の先頭からのオフセット
+    static constexpr std::array<uint32_t, ELEMENT_COUNT> OFFSETS = [] {
+        std::array<uint32_t, ELEMENT_COUNT> offsets = {};
+        const uint32_t sizes[] = { Attributes::SIZE... };
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < ELEMENT_COUNT; ++i) {
+            offsets[i] = offset;
+            offset += sizes[i];
+        }
+        return offsets;
+    }();
+
+    static constexpr std::array<VertexElement, ELEMENT_COUNT> GetElements(uint32_t slot)
+    {
+        std::array<VertexElement, ELEMENT_COUNT> elements = { VertexElement{ Attributes::SEMANTIC, Attributes::SEMANTIC_INDEX, Attributes::FORMAT }... };
+        for (uint32_t i = 0; i < ELEMENT_COUNT; ++i) {
+            elements[i].slot = slot;
+            elements[i].offset = OFFSETS[i];
+            elements[i].rate = Rate;
+        }
+        return elements;
+    }
+};
+
+// 入力スロット 0, 1, ... に Streams を割り当てた入力レイアウト全体
+template <typename... Streams>
+struct VertexLayout {
+    static constexpr uint32_t STREAM_COUNT = sizeof...(Streams);
+    static constexpr uint32_t ELEMENT_COUNT = (0 + ... + Streams::ELEMENT_COUNT);
+    static constexpr std::array<uint32_t, STREAM_COUNT> STRIDES = { Streams::STRIDE... };
+
+    static constexpr std::array<VertexElement, ELEMENT_COUNT> GetElements()
+    {
+        std::array<VertexElement, ELEMENT_COUNT> elements = {};
+        uint32_t count = 0;
+        uint32_t slot = 0;
+        ((AppendElements(Streams::GetElements(slot++), elements, count)), ...);
+        (void)count; // スロットがない場合は使わない
+        (void)slot;
+        return elements;
+    }
+    static constexpr std::array<VertexElement, ELEMENT_COUNT> ELEMENTS = GetElements();
+
+    // 要素の内容から求めた 64bit ハッシュ（パイプラインステートのキーに含める）
+    static constexpr uint64_t HASH = [] {
+        uint64_t hash = HashCombine(HASH_SEED, ELEMENT_COUNT);
+        for (const VertexElement& element : ELEMENTS) {
+            hash = HashString(element.semantic, hash);
+            hash = HashCombine(hash, element.semanticIndex);
+            hash = HashCombine(hash, static_cast<uint64_t>(element.format));
+            hash = HashCombine(hash, element.slot);
+            hash = HashCombine(hash, element.offset);
+            hash = HashCombine(hash, static_cast<uint64_t>(element.rate));
+        }
+        return hash;
+    }();
+
+private:
+    template <size_t N>
+    static constexpr void AppendElements(const std::array<VertexElement, N>& source, std::array<VertexElement, ELEMENT_COUNT>& elements, uint32_t& count)
+    {
+        for (const VertexElement& element : source) {
+            elements[count++] = element;
+        }
+    }
+};
+
+// 頂点入力を使わないパイプライン（SV_VertexID から頂点を作る）
+using EmptyVertexLayout = VertexLayout<>;
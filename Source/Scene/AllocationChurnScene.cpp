@@ -0,0 +1,194 @@
+﻿#include "AllocationChurnScene.h"
+#include "SceneRegistry.h"
+#include "../Core/FixedSizePool.h"
+#include "../Core/FrameArena.h"
+#include "../Core/JobSystem.h"
+#include "../Core/Profiler.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// 1 ステップで並列に実行するタスク数と、1 タスクが確保するオブジェクト数
+constexpr uint32_t CHURN_TASK_COUNT = 64;
+constexpr uint32_t CHURN_OBJECTS_PER_TASK = 256;
+// プールが 1 チャンクで確保するオブジェクト数
+constexpr uint32_t CHURN_POOL_OBJECTS_PER_CHUNK = 1024;
+
+// 描画パケット相当の大きさ（96 バイト）のオブジェクト
+struct ChurnPacket {
+    float transform[16];
+    uint32_t pipeline;
+    uint32_t mesh;
+    uint32_t material;
+    uint32_t sortKey;
+    uint32_t instanceOffset;
+    uint32_t instanceCount;
+    uint32_t task;
+    uint32_t index;
+};
+
+void FillPacket(ChurnPacket& packet, uint32_t task, uint32_t index)
+{
+    for (uint32_t i = 0; i < 16; ++i) {
+        packet.transform[i] = static_cast<float>(index + i);
+    }
+    packet.pipeline = task & 3;
+    packet.mesh = index & 15;
+    packet.material = (task + index) & 7;
+    packet.sortKey = (packet.pipeline << 24) | (packet.material << 16) | packet.mesh;
+    packet.instanceOffset = index;
+    packet.instanceCount = 1;
+    packet.task = task;
+    packet.index = index;
+}
+
+// 確保方法ごとのタスクの出力（二重バッファの世代）
+struct ChurnGenerations {
+    std::vector<ChurnPacket*> lists[2][CHURN_TASK_COUNT];
+
+    ChurnGenerations()
+    {
+        for (auto& generation : lists) {
+            for (std::vector<ChurnPacket*>& list : generation) {
+                list.reserve(CHURN_OBJECTS_PER_TASK);
+            }
+        }
+    }
+};
+
+// 毎ステップ、タスク i が前の世代のタスク (i + 1) の出力を解放し（別のスレッドで確保したものの解放になる）、
+// 今の世代の出力を CHURN_OBJECTS_PER_TASK 個確保して書き込む。これを 3 つの確保方法で繰り返す。
+//  - new/delete: グローバルヒープ
+//  - pool: ObjectPool（ワーカーごとのキャッシュ）
+//  - arena: 2 つの FrameArena を交互に使い、世代ごとにまとめて Reset する（個別の解放なし）
+// 計測値: 1 ステップあたりの時間と、ヒープに対する速度比、プールのチャンク数、アリーナの最大使用量。
+class AllocationChurnScene : public IScene {
+public:
+    void Initialize(FrameRenderer& renderer) override
+    {
+        (void)renderer;
+        JobSystem& jobSystem = GetJobSystem();
+        pool.Initialize(CHURN_POOL_OBJECTS_PER_CHUNK, jobSystem.GetThreadCount());
+        for (FrameArena& arena : arenas) {
+            arena.Initialize(CHURN_TASK_COUNT * CHURN_OBJECTS_PER_TASK * sizeof(ChurnPacket));
+        }
+    }
+
+    ~AllocationChurnScene() override
+    {
+        for (auto& generation : heapGenerations.lists) {
+            for (std::vector<ChurnPacket*>& list : generation) {
+                for (ChurnPacket* packet : list) {
+                    delete packet;
+                }
+            }
+        }
+        for (auto& generation : poolGenerations.lists) {
+            for (std::vector<ChurnPacket*>& list : generation) {
+                for (ChurnPacket* packet : list) {
+                    pool.Delete(packet);
+                }
+            }
+        }
+    }
+
+    void Update(float deltaTime) override
+    {
+        (void)deltaTime;
+        PROFILE_SCOPE("AllocationChurn");
+        JobSystem& jobSystem = GetJobSystem();
+        const uint32_t current = stepCount & 1;
+        const uint32_t previous = current ^ 1;
+
+        uint64_t startNs = Profiler::Now();
+        jobSystem.ParallelFor(CHURN_TASK_COUNT, 1, [this, current, previous](uint32_t begin, uint32_t end) {
+            for (uint32_t task = begin; task < end; ++task) {
+                std::vector<ChurnPacket*>& freed = heapGenerations.lists[previous][(task + 1) % CHURN_TASK_COUNT];
+                for (ChurnPacket* packet : freed) {
+                    delete packet;
+                }
+                freed.clear();
+                std::vector<ChurnPacket*>& output = heapGenerations.lists[current][task];
+                for (uint32_t i = 0; i < CHURN_OBJECTS_PER_TASK; ++i) {
+                    ChurnPacket* packet = new ChurnPacket;
+                    FillPacket(*packet, task, i);
+                    output.push_back(packet);
+                }
+            }
+        });
+        newDeleteNs += Profiler::Now() - startNs;
+
+        startNs = Profiler::Now();
+        jobSystem.ParallelFor(CHURN_TASK_COUNT, 1, [this, current, previous](uint32_t begin, uint32_t end) {
+            for (uint32_t task = begin; task < end; ++task) {
+                std::vector<ChurnPacket*>& freed = poolGenerations.lists[previous][(task + 1) % CHURN_TASK_COUNT];
+                for (ChurnPacket* packet : freed) {
+                    pool.Delete(packet);
+                }
+                freed.clear();
+                std::vector<ChurnPacket*>& output = poolGenerations.lists[current][task];
+                for (uint32_t i = 0; i < CHURN_OBJECTS_PER_TASK; ++i) {
+                    ChurnPacket* packet = pool.New();
+                    FillPacket(*packet, task, i);
+                    output.push_back(packet);
+                }
+            }
+        });
+        poolNs += Profiler::Now() - startNs;
+
+        // 今の世代のアリーナは 2 ステップ前の出力を持つので、まとめて解放してから使う
+        startNs = Profiler::Now();
+        FrameArena& arena = arenas[current];
+        arena.Reset();
+        jobSystem.ParallelFor(CHURN_TASK_COUNT, 1, [this, &arena, current, previous](uint32_t begin, uint32_t end) {
+            for (uint32_t task = begin; task < end; ++task) {
+                arenaGenerations.lists[previous][(task + 1) % CHURN_TASK_COUNT].clear();
+                std::vector<ChurnPacket*>& output = arenaGenerations.lists[current][task];
+                for (uint32_t i = 0; i < CHURN_OBJECTS_PER_TASK; ++i) {
+                    ChurnPacket* packet = arena.New<ChurnPacket>();
+                    FillPacket(*packet, task, i);
+                    output.push_back(packet);
+                }
+            }
+        });
+        arenaNs += Profiler::Now() - startNs;
+        ++stepCount;
+    }
+
+    void GetMetrics(SceneMetrics& metrics) const override
+    {
+        const double steps = stepCount != 0 ? static_cast<double>(stepCount) : 1.0;
+        const double newDeleteMs = static_cast<double>(newDeleteNs) / 1e6 / steps;
+        const double poolMs = static_cast<double>(poolNs) / 1e6 / steps;
+        const double arenaMs = static_cast<double>(arenaNs) / 1e6 / steps;
+        metrics.emplace_back("objectsPerStep", static_cast<double>(CHURN_TASK_COUNT * CHURN_OBJECTS_PER_TASK));
+        metrics.emplace_back("newDeleteMs", newDeleteMs);
+        metrics.emplace_back("poolMs", poolMs);
+        metrics.emplace_back("arenaMs", arenaMs);
+        metrics.emplace_back("poolSpeedup", poolMs > 0.0 ? newDeleteMs / poolMs : 0.0);
+        metrics.emplace_back("arenaSpeedup", arenaMs > 0.0 ? newDeleteMs / arenaMs : 0.0);
+        metrics.emplace_back("poolChunks", static_cast<double>(pool.GetPool().GetChunkCount()));
+        metrics.emplace_back("arenaPeakKB", static_cast<double>((std::max)(arenas[0].GetPeakBytes(), arenas[1].GetPeakBytes())) / 1024.0);
+    }
+
+private:
+    ObjectPool<ChurnPacket> pool;
+    FrameArena arenas[2];
+    ChurnGenerations heapGenerations;
+    ChurnGenerations poolGenerations;
+    ChurnGenerations arenaGenerations;
+    uint64_t newDeleteNs = 0;
+    uint64_t poolNs = 0;
+    uint64_t arenaNs = 0;
+    uint32_t stepCount = 0;
+};
+
+} // namespace
+
+void RegisterAllocationChurnScenes(SceneRegistry& registry)
+{
+    registry.Register("alloc-churn", "16k packet-sized objects churned across workers with new/delete, a pooled allocator and a frame arena",
+                      [] { return std::make_unique<AllocationChurnScene>(); });
+}
@@ -0,0 +1,6 @@
+﻿#pragma once
+
+class SceneRegistry;
+
+// 描画パケット大のオブジェクトを大量に確保/解放し、ヒープ・固定サイズプール・フレームアリーナを比較するシーンを登録する
+void RegisterAllocationChurnScenes(SceneRegistry& registry);
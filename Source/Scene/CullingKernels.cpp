@@ -0,0 +1,199 @@
+﻿#include "CullingKernels.h"
+
+#if SIMD_X86
+#include <immintrin.h>
+#endif
+
+// どの実装も同じ要素を残すように、判定は「すべての平面で距離 >= -半径」の 1 通りにそろえている。
+// （AVX2 版は距離の計算に FMA を使うため、平面にちょうど接する要素は丸め誤差の範囲で異なりうる）
+// 出力は分岐せずに書くため、判定に関係なく output[count] へ番号を書いてから count を進める。
+
+namespace {
+
+uint32_t CullSpheresScalar(const BoundsStreams& b, uint32_t begin, uint32_t end, const Frustum& frustum, uint32_t* output)
+{
+    uint32_t count = 0;
+    for (uint32_t i = begin; i < end; ++i) {
+        bool visible = true;
+        for (const Plane& plane : frustum.planes) {
+            const float distance = plane.nx * b.centerX[i] + plane.ny * b.centerY[i] + plane.nz * b.centerZ[i] + plane.d;
+            visible = visible && distance >= -b.radius[i];
+        }
+        output[count] = i;
+        count += visible ? 1 : 0;
+    }
+    return count;
+}
+
+uint32_t CullAabbsScalar(const BoundsStreams& b, uint32_t begin, uint32_t end, const Frustum& frustum, uint32_t* output)
+{
+    uint32_t count = 0;
+    for (uint32_t i = begin; i < end; ++i) {
+        bool visible = true;
+        for (const Plane& plane : frustum.planes) {
+            const float distance = plane.nx * b.centerX[i] + plane.ny * b.centerY[i] + plane.nz * b.centerZ[i] + plane.d;
+            const float radius = (plane.nx < 0.0f ? -plane.nx : plane.nx) * b.extentX[i]
+                + (plane.ny < 0.0f ? -plane.ny : plane.ny) * b.extentY[i]
+                + (plane.nz < 0.0f ? -plane.nz : plane.nz) * b.extentZ[i];
+            visible = visible && distance >= -radius;
+        }
+        output[count] = i;
+        count += visible ? 1 : 0;
+    }
+    return count;
+}
+
+#if SIMD_X86
+
+// ---- SSE2（4 要素単位、端数はスカラー版で処理） ----
+
+uint32_t AppendVisibleSSE2(__m128 visible, uint32_t index, uint32_t* output, uint32_t count)
+{
+    const int mask = _mm_movemask_ps(visible);
+    for (uint32_t lane = 0; lane < 4; ++lane) {
+        output[count] = index + lane;
+        count += (mask >> lane) & 1;
+    }
+    return count;
+}
+
+uint32_t CullSpheresSSE2(const BoundsStreams& b, uint32_t begin, uint32_t end, const Frustum& frustum, uint32_t* output)
+{
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    uint32_t count = 0;
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        const __m128 cx = _mm_loadu_ps(b.centerX + i);
+        const __m128 cy = _mm_loadu_ps(b.centerY + i);
+        const __m128 cz = _mm_loadu_ps(b.centerZ + i);
+        const __m128 minusRadius = _mm_xor_ps(_mm_loadu_ps(b.radius + i), signMask);
+        __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const Plane& plane : frustum.planes) {
+            __m128 distance = _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane.nx)), _mm_mul_ps(cy, _mm_set1_ps(plane.ny)));
+            distance = _mm_add_ps(distance, _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane.nz)), _mm_set1_ps(plane.d)));
+            visible = _mm_and_ps(visible, _mm_cmpge_ps(distance, minusRadius));
+        }
+        count = AppendVisibleSSE2(visible, i, output, count);
+    }
+    return count + CullSpheresScalar(b, i, end, frustum, output + count);
+}
+
+uint32_t CullAabbsSSE2(const BoundsStreams& b, uint32_t begin, uint32_t end, const Frustum& frustum, uint32_t* output)
+{
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    uint32_t count = 0;
+    uint32_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        const __m128 cx = _mm_loadu_ps(b.centerX + i);
+        const __m128 cy = _mm_loadu_ps(b.centerY + i);
+        const __m128 cz = _mm_loadu_ps(b.centerZ + i);
+        const __m128 ex = _mm_loadu_ps(b.extentX + i);
+        const __m128 ey = _mm_loadu_ps(b.extentY + i);
+        const __m128 ez = _mm_loadu_ps(b.extentZ + i);
+        __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (const Plane& plane : frustum.planes) {
+            __m128 distance = _mm_add_ps(_mm_mul_ps(cx, _mm_set1_ps(plane.nx)), _mm_mul_ps(cy, _mm_set1_ps(plane.ny)));
+            distance = _mm_add_ps(distance, _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane.nz)), _mm_set1_ps(plane.d)));
+            const float ax = plane.nx < 0.0f ? -plane.nx : plane.nx;
+            const float ay = plane.ny < 0.0f ? -plane.ny : plane.ny;
+            const float az = plane.nz < 0.0f ? -plane.nz : plane.nz;
+            __m128 radius = _mm_add_ps(_mm_mul_ps(ex, _mm_set1_ps(ax)), _mm_mul_ps(ey, _mm_set1_ps(ay)));
+            radius = _mm_add_ps(radius, _mm_mul_ps(ez, _mm_set1_ps(az)));
+            visible = _mm_and_ps(visible, _mm_cmpge_ps(distance, _mm_xor_ps(radius, signMask)));
+        }
+        count = AppendVisibleSSE2(visible, i, output, count);
+    }
+    return count + CullAabbsScalar(b, i, end, frustum, output + count);
+}
+
+// ---- AVX2 + FMA（8 要素単位、端数は SSE2 版で処理） ----
+
+SIMD_TARGET_AVX2 uint32_t AppendVisibleAVX2(__m256 visible, uint32_t index, uint32_t* output, uint32_t count)
+{
+    const int mask = _mm256_movemask_ps(visible);
+    for (uint32_t lane = 0; lane < 8; ++lane) {
+        output[count] = index + lane;
+        count += (mask >> lane) & 1;
+    }
+    return count;
+}
+
+SIMD_TARGET_AVX2 uint32_t CullSpheresAVX2(const BoundsStreams& b, uint32_t begin, uint32_t end, const Frustum& frustum, uint32_t* output)
+{
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    uint32_t count = 0;
+    uint32_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        const __m256 cx = _mm256_loadu_ps(b.centerX + i);
+        const __m256 cy = _mm256_loadu_ps(b.centerY + i);
+        const __m256 cz = _mm256_loadu_ps(b.centerZ + i);
+        const __m256 minusRadius = _mm256_xor_ps(_mm256_loadu_ps(b.radius + i), signMask);
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const Plane& plane : frustum.planes) {
+            __m256 distance = _mm256_fmadd_ps(cz, _mm256_set1_ps(plane.nz), _mm256_set1_ps(plane.d));
+            distance = _mm256_fmadd_ps(cy, _mm256_set1_ps(plane.ny), distance);
+            distance = _mm256_fmadd_ps(cx, _mm256_set1_ps(plane.nx), distance);
+            visible = _mm256_and_ps(visible, _mm256_cmp_ps(distance, minusRadius, _CMP_GE_OQ));
+        }
+        count = AppendVisibleAVX2(visible, i, output, count);
+    }
+    return count + CullSpheresSSE2(b, i, end, frustum, output + count);
+}
+
+SIMD_TARGET_AVX2 uint32_t CullAabbsAVX2(const BoundsStreams& b, uint32_t begin, uint32_t end, const Frustum& frustum, uint32_t* output)
+{
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    uint32_t count = 0;
+    uint32_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        const __m256 cx = _mm256_loadu_ps(b.centerX + i);
+        const __m256 cy = _mm256_loadu_ps(b.centerY + i);
+        const __m256 cz = _mm256_loadu_ps(b.centerZ + i);
+        const __m256 ex = _mm256_loadu_ps(b.extentX + i);
+        const __m256 ey = _mm256_loadu_ps(b.extentY + i);
+        const __m256 ez = _mm256_loadu_ps(b.extentZ + i);
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (const Plane& plane : frustum.planes) {
+            __m256 distance = _mm256_fmadd_ps(cz, _mm256_set1_ps(plane.nz), _mm256_set1_ps(plane.d));
+            distance = _mm256_fmadd_ps(cy, _mm256_set1_ps(plane.ny), distance);
+            distance = _mm256_fmadd_ps(cx, _mm256_set1_ps(plane.nx), distance);
+            const float ax = plane.nx < 0.0f ? -plane.nx : plane.nx;
+            const float ay = plane.ny < 0.0f ? -plane.ny : plane.ny;
+            const float az = plane.nz < 0.0f ? -plane.nz : plane.nz;
+            __m256 radius = _mm256_mul_ps(ez, _mm256_set1_ps(az));
+            radius = _mm256_fmadd_ps(ey, _mm256_set1_ps(ay), radius);
+            radius = _mm256_fmadd_ps(ex, _mm256_set1_ps(ax), radius);
+            visible = _mm256_and_ps(visible, _mm256_cmp_ps(distance, _mm256_xor_ps(radius, signMask), _CMP_GE_OQ));
+        }
+        count = AppendVisibleAVX2(visible, i, output, count);
+    }
+    return count + CullAabbsSSE2(b, i, end, frustum, output + count);
+}
+
+#endif // SIMD_X86
+
+const CullingKernelTable SCALAR_KERNELS = { SimdLevel::Scalar, CullSpheresScalar, CullAabbsScalar };
+#if SIMD_X86
+const CullingKernelTable SSE2_KERNELS = { SimdLevel::SSE2, CullSpheresSSE2, CullAabbsSSE2 };
+const CullingKernelTable AVX2_KERNELS = { SimdLevel::AVX2, CullSpheresAVX2, CullAabbsAVX2 };
+#endif
+
+} // namespace
+
+const CullingKernelTable& GetCullingKernels(SimdLevel level)
+{
+    if (level > GetSupportedSimdLevel()) {
+        level = GetSupportedSimdLevel();
+    }
+#if SIMD_X86
+    switch (level) {
+    case SimdLevel::AVX2:
+        return AVX2_KERNELS;
+    case SimdLevel::SSE2:
+        return SSE2_KERNELS;
+    case SimdLevel::Scalar:
+        break;
+    }
+#endif
+    return SCALAR_KERNELS;
+}
@@ -0,0 +1,30 @@
+﻿#pragma once
+
+#include <cstdint>
+#include "../Core/CpuFeatures.h"
+#include "Frustum.h"
+
+// カリング対象の境界の SoA。境界球は center と radius、AABB は center と extent（半分の大きさ）を使う
+struct BoundsStreams {
+    float* centerX = nullptr;
+    float* centerY = nullptr;
+    float* centerZ = nullptr;
+    float* radius = nullptr;
+    float* extentX = nullptr;
+    float* extentY = nullptr;
+    float* extentZ = nullptr;
+};
+
+// [begin, end) のうち視錐台と交差する（内側を含む）要素の番号を output の先頭から書き出し、個数を返すカーネル。
+// output には end - begin 個分の領域が必要（書き出す個数を超えて一時的に書き込むことがある）
+using FrustumCullKernel = uint32_t (*)(const BoundsStreams& bounds, uint32_t begin, uint32_t end, const Frustum& frustum, uint32_t* output);
+
+// 同じ命令セットで実装したカーネルの組
+struct CullingKernelTable {
+    SimdLevel level = SimdLevel::Scalar;
+    FrustumCullKernel cullSpheres = nullptr; // 境界球の判定（平面までの距離 >= -radius）
+    FrustumCullKernel cullAabbs = nullptr;   // AABB の判定（平面までの距離 >= -(|n|・extent)）
+};
+
+// level の実装を返す。CPU がサポートしないレベルを指定した場合はサポートする最上位のレベルに落とす。
+const CullingKernelTable& GetCullingKernels(SimdLevel level);
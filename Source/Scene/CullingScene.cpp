@@ -0,0 +1,274 @@
+﻿#include "CullingScene.h"
+#include "CullingSystem.h"
+#include "SceneRegistry.h"
+#include "../Core/JobSystem.h"
+#include "../Core/Profiler.h"
+#include "../Render/BuiltinPipelineStates.h"
+#include "../Render/FrameRenderer.h"
+#include <cmath>
+#include <memory>
+#include <random>
+
+namespace {
+
+// 1 平方単位あたりの物体数（物体数に応じて世界を広げ、画面内の物体数をそろえる）
+constexpr float CULLING_OBJECT_DENSITY = 1000.0f;
+// 画面に映す範囲（カメラの中心から上下左右の距離）
+constexpr float CULLING_VIEW_HALF_EXTENT = 1.0f;
+// 動く物体の割合と速さ（残りは静止している）
+constexpr float CULLING_DYNAMIC_FRACTION = 0.25f;
+constexpr float CULLING_MAX_SPEED = 0.05f;
+// Refit による階層の劣化（表面積の合計の比）がこれを超えたら作り直す
+constexpr float CULLING_REBUILD_DEGRADATION = 2.0f;
+// 比較用の他の方式を計測する間隔（ステップ数）
+constexpr uint32_t CULLING_COMPARISON_INTERVAL = 30;
+constexpr uint32_t CULLING_JOB_OBJECTS = 16384;
+
+double ToMilliseconds(uint64_t ns)
+{
+    return static_cast<double>(ns) / 1e6;
+}
+
+// 広い世界を動き回る多数の物体を CullingSystem で毎ステップ視錐台カリングし、
+// 画面内の物体だけをインスタンスバッチに詰めて描画する。
+// カメラは世界の中を巡回し、正射影の視錐台を行列から取り出して使う。
+// 計測値: カリング/Refit/移動の時間、可視数、一定間隔で計測した総当たりやスカラー版との比較。
+class CullingScene : public IScene {
+public:
+    explicit CullingScene(uint32_t count) : objectCount(count) {}
+
+    void Initialize(FrameRenderer& renderer) override
+    {
+        worldHalfExtent = 0.5f * std::sqrt(objectCount / CULLING_OBJECT_DENSITY);
+
+        std::mt19937 random(24680);
+        std::uniform_real_distribution<float> signedUnit(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::vector<CullingObjectDesc> objects(objectCount);
+        for (CullingObjectDesc& object : objects) {
+            object.centerX = signedUnit(random) * worldHalfExtent;
+            object.centerY = signedUnit(random) * worldHalfExtent;
+            object.centerZ = 0.1f + unit(random) * 0.8f;
+            object.extentX = 0.004f + unit(random) * 0.008f;
+            object.extentY = object.extentX;
+            object.extentZ = 0.01f;
+        }
+        culling.Initialize(&GetJobSystem());
+        culling.Build(objects);
+
+        velocityX.resize(objectCount);
+        velocityY.resize(objectCount);
+        for (uint32_t i = 0; i < objectCount; ++i) {
+            const bool dynamic = unit(random) < CULLING_DYNAMIC_FRACTION;
+            velocityX[i] = dynamic ? signedUnit(random) * CULLING_MAX_SPEED : 0.0f;
+            velocityY[i] = dynamic ? signedUnit(random) * CULLING_MAX_SPEED : 0.0f;
+        }
+
+        const MeshVertex quad[] = {
+            { -1.0f,  1.0f }, {  1.0f,  1.0f }, {  1.0f, -1.0f },
+            { -1.0f,  1.0f }, {  1.0f, -1.0f }, { -1.0f, -1.0f },
+        };
+        IRenderBackend& backend = renderer.GetBackend();
+        InstanceBatchDesc batchDesc;
+        batchDesc.pipeline = backend.GetBuiltinPipeline(BuiltinPipeline::Instanced);
+        batchDesc.topology = PrimitiveTopology::TriangleList;
+        batchDesc.mesh.gpuAddress = backend.CreateStaticBuffer(quad, sizeof(quad));
+        batchDesc.mesh.strideInBytes = MeshVertexStream::STRIDE;
+        batchDesc.mesh.sizeInBytes = sizeof(quad);
+        batchDesc.vertexCount = 6;
+        instances = &renderer.GetInstances();
+        batch = instances->CreateBatch(batchDesc);
+        // 画面の端にかかる物体の位置を押し戻さないよう、インスタンスの反射の範囲を画面より広げる
+        instances->SetBounds(2.0f);
+    }
+
+    void Update(float deltaTime) override
+    {
+        time += deltaTime;
+        const uint64_t startNs = Profiler::Now();
+        MoveObjects(deltaTime);
+        const uint64_t moveEndNs = Profiler::Now();
+        const bool rebuild = culling.GetDegradation() > CULLING_REBUILD_DEGRADATION;
+        if (rebuild) {
+            RebuildHierarchy();
+        }
+        else {
+            culling.Refit();
+        }
+        const uint64_t refitEndNs = Profiler::Now();
+        moveNs += moveEndNs - startNs;
+        (rebuild ? rebuildNs : refitNs) += refitEndNs - moveEndNs;
+
+        const Frustum frustum = UpdateCamera();
+        culling.Cull(frustum, CullingShape::Aabb, CullingMethod::Hierarchy, visibleSlots);
+        cullNs += Profiler::Now() - refitEndNs;
+        visibleTotal += culling.GetStats().visibleCount;
+        testedTotal += culling.GetStats().testedObjects;
+        ++stepCount;
+
+        if (stepCount % CULLING_COMPARISON_INTERVAL == 0) {
+            MeasureAlternatives(frustum);
+        }
+        WriteVisibleInstances();
+    }
+
+    void GetMetrics(SceneMetrics& metrics) const override
+    {
+        const double steps = stepCount != 0 ? static_cast<double>(stepCount) : 1.0;
+        const double comparisons = comparisonCount != 0 ? static_cast<double>(comparisonCount) : 1.0;
+        const double bruteForceMs = ToMilliseconds(bruteForceNs) / comparisons;
+        const double cullMs = ToMilliseconds(cullNs) / steps;
+        metrics.emplace_back("objects", static_cast<double>(objectCount));
+        metrics.emplace_back("hierarchyNodes", static_cast<double>(culling.GetNodeCount()));
+        metrics.emplace_back("averageVisible", static_cast<double>(visibleTotal) / steps);
+        metrics.emplace_back("averageTestedObjects", static_cast<double>(testedTotal) / steps);
+        metrics.emplace_back("cullMs", cullMs);
+        metrics.emplace_back("refitMs", ToMilliseconds(refitNs) / (steps - rebuildCount > 0 ? steps - rebuildCount : 1.0));
+        metrics.emplace_back("moveMs", ToMilliseconds(moveNs) / steps);
+        metrics.emplace_back("rebuilds", static_cast<double>(rebuildCount));
+        metrics.emplace_back("rebuildMs", rebuildCount != 0 ? ToMilliseconds(rebuildNs) / rebuildCount : 0.0);
+        metrics.emplace_back("cullBruteForceMs", bruteForceMs);
+        metrics.emplace_back("cullHierarchySpheresMs", ToMilliseconds(hierarchySpheresNs) / comparisons);
+        metrics.emplace_back("cullHierarchyScalarMs", ToMilliseconds(hierarchyScalarNs) / comparisons);
+        metrics.emplace_back("cullBruteForceScalarMs", ToMilliseconds(bruteForceScalarNs) / comparisons);
+        metrics.emplace_back("speedupVsBruteForce", cullMs > 0.0 && comparisonCount != 0 ? bruteForceMs / cullMs : 0.0);
+    }
+
+private:
+    // 世界の端で速度を反転する
+    void MoveObjects(float deltaTime)
+    {
+        PROFILE_SCOPE("MoveCullingObjects");
+        const BoundsStreams& bounds = culling.GetBounds();
+        const float limit = worldHalfExtent;
+        GetJobSystem().ParallelFor(objectCount, CULLING_JOB_OBJECTS, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; ++i) {
+                float x = bounds.centerX[i] + velocityX[i] * deltaTime;
+                float y = bounds.centerY[i] + velocityY[i] * deltaTime;
+                if (x < -limit || x > limit) {
+                    velocityX[i] = -velocityX[i];
+                    x = x < -limit ? -limit : limit;
+                }
+                if (y < -limit || y > limit) {
+                    velocityY[i] = -velocityY[i];
+                    y = y < -limit ? -limit : limit;
+                }
+                bounds.centerX[i] = x;
+                bounds.centerY[i] = y;
+            }
+        });
+    }
+
+    // スロット順に持つ速度を新しい並びに合わせる
+    void RebuildHierarchy()
+    {
+        const std::vector<uint32_t>& previousSlots = culling.Rebuild();
+        scratch.resize(objectCount);
+        AlignedVector<float>* streams[] = { &velocityX, &velocityY };
+        for (AlignedVector<float>* stream : streams) {
+            for (uint32_t i = 0; i < objectCount; ++i) {
+                scratch[i] = (*stream)[previousSlots[i]];
+            }
+            stream->swap(scratch);
+        }
+        ++rebuildCount;
+    }
+
+    // カメラは世界の中をリサージュ曲線で巡回する
+    Frustum UpdateCamera()
+    {
+        const float range = (std::max)(worldHalfExtent - CULLING_VIEW_HALF_EXTENT, 0.0f);
+        cameraX = range * std::sin(time * 0.11f);
+        cameraY = range * std::cos(time * 0.07f);
+        float viewProjection[16];
+        MakeOrthographicViewProjection(cameraX - CULLING_VIEW_HALF_EXTENT, cameraX + CULLING_VIEW_HALF_EXTENT,
+                                       cameraY - CULLING_VIEW_HALF_EXTENT, cameraY + CULLING_VIEW_HALF_EXTENT, 0.0f, 1.0f, viewProjection);
+        return ExtractFrustum(viewProjection);
+    }
+
+    // 同じ視錐台で他の方式を 1 回ずつ実行して時間を計る（結果は使わない）
+    void MeasureAlternatives(const Frustum& frustum)
+    {
+        const SimdLevel level = culling.GetSimdLevel();
+        uint64_t startNs = Profiler::Now();
+        culling.Cull(frustum, CullingShape::Aabb, CullingMethod::BruteForce, comparisonSlots);
+        bruteForceNs += Profiler::Now() - startNs;
+
+        startNs = Profiler::Now();
+        culling.Cull(frustum, CullingShape::Sphere, CullingMethod::Hierarchy, comparisonSlots);
+        hierarchySpheresNs += Profiler::Now() - startNs;
+
+        culling.SetSimdLevel(SimdLevel::Scalar);
+        startNs = Profiler::Now();
+        culling.Cull(frustum, CullingShape::Aabb, CullingMethod::Hierarchy, comparisonSlots);
+        hierarchyScalarNs += Profiler::Now() - startNs;
+
+        startNs = Profiler::Now();
+        culling.Cull(frustum, CullingShape::Aabb, CullingMethod::BruteForce, comparisonSlots);
+        bruteForceScalarNs += Profiler::Now() - startNs;
+        culling.SetSimdLevel(level);
+        ++comparisonCount;
+    }
+
+    // 可視の物体をカメラ基準の正規化座標に直してバッチに詰め直す。
+    // 並びが毎ステップ変わるため、描画側の補間は行われない（InstancedBatchRenderer::WriteSnapshot）。
+    void WriteVisibleInstances()
+    {
+        PROFILE_SCOPE("WriteVisibleInstances");
+        const BoundsStreams& bounds = culling.GetBounds();
+        const float scale = 1.0f / CULLING_VIEW_HALF_EXTENT;
+        InstanceStorage& storage = instances->GetInstances(batch);
+        storage.Clear();
+        storage.Reserve(static_cast<uint32_t>(visibleSlots.size()));
+        for (uint32_t slot : visibleSlots) {
+            const uint32_t id = culling.GetObjectId(slot);
+            InstanceDesc instance;
+            instance.positionX = (bounds.centerX[slot] - cameraX) * scale;
+            instance.positionY = (bounds.centerY[slot] - cameraY) * scale;
+            instance.scale = bounds.extentX[slot] * scale;
+            instance.colorR = static_cast<float>((id * 2654435761u) >> 24) / 255.0f;
+            instance.colorG = static_cast<float>((id * 40503u) >> 8 & 0xFF) / 255.0f;
+            instance.colorB = 0.5f + bounds.centerZ[slot] * 0.5f;
+            instance.phase = static_cast<float>(id & 0xFF) / 256.0f;
+            storage.Add(instance);
+        }
+    }
+
+    uint32_t objectCount;
+    float worldHalfExtent = 1.0f;
+    float time = 0.0f;
+    float cameraX = 0.0f;
+    float cameraY = 0.0f;
+    CullingSystem culling;
+    AlignedVector<float> velocityX; // スロット順
+    AlignedVector<float> velocityY;
+    AlignedVector<float> scratch;
+    std::vector<uint32_t> visibleSlots;
+    std::vector<uint32_t> comparisonSlots;
+    InstancedBatchRenderer* instances = nullptr;
+    InstanceBatchId batch = 0;
+
+    uint64_t stepCount = 0;
+    uint64_t comparisonCount = 0;
+    uint64_t visibleTotal = 0;
+    uint64_t testedTotal = 0;
+    uint32_t rebuildCount = 0;
+    uint64_t moveNs = 0;
+    uint64_t refitNs = 0;
+    uint64_t rebuildNs = 0;
+    uint64_t cullNs = 0;
+    uint64_t bruteForceNs = 0;
+    uint64_t hierarchySpheresNs = 0;
+    uint64_t hierarchyScalarNs = 0;
+    uint64_t bruteForceScalarNs = 0;
+};
+
+} // namespace
+
+void RegisterCullingScenes(SceneRegistry& registry)
+{
+    registry.Register("culling-100k", "100k moving objects frustum-culled through a refitted BVH with SIMD kernels",
+                      [] { return std::make_unique<CullingScene>(100000); });
+    registry.Register("culling-1m", "1M moving objects frustum-culled through a refitted BVH with SIMD kernels",
+                      [] { return std::make_unique<CullingScene>(1000000); });
+}
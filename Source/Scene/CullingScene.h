@@ -0,0 +1,6 @@
+﻿#pragma once
+
+class SceneRegistry;
+
+// 階層と SIMD カーネルで視錐台カリングを行う大規模なシーンを登録する
+void RegisterCullingScenes(SceneRegistry& registry);
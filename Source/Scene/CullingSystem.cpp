@@ -0,0 +1,374 @@
+﻿#include "CullingSystem.h"
+#include "../Core/JobSystem.h"
+#include "../Core/Profiler.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+constexpr uint32_t ALL_PLANES = (1u << FRUSTUM_PLANE_COUNT) - 1;
+// TestNode の戻り値: ノードが視錐台の外側にある
+constexpr uint32_t OUTSIDE = UINT32_MAX;
+// たどる深さの上限（中央値で分割するため深さは log2(物体数 / MAX_OBJECTS_PER_LEAF) 程度に収まる）
+constexpr uint32_t MAX_TRAVERSAL_DEPTH = 64;
+
+float Abs(float value)
+{
+    return value < 0.0f ? -value : value;
+}
+
+// 物体数 count と count + 1 の部分木のノード数。
+// 中央値で分割するためノード数は物体数だけで決まり、構築前に各部分木の位置を求められる。
+std::pair<uint32_t, uint32_t> CountNodes(uint32_t count, uint32_t maxObjectsPerLeaf)
+{
+    if (count + 1 <= maxObjectsPerLeaf) {
+        return { 1, 1 };
+    }
+    // half と half + 1 のノード数から、count = 2 * half (+ 1) と count + 1 のノード数を求める
+    const uint32_t half = count / 2;
+    const auto [halfNodes, halfPlusOneNodes] = CountNodes(half, maxObjectsPerLeaf);
+    const bool even = count % 2 == 0;
+    const uint32_t countNodes = count <= maxObjectsPerLeaf ? 1 : (even ? 1 + 2 * halfNodes : 1 + halfNodes + halfPlusOneNodes);
+    const uint32_t nextNodes = even ? 1 + halfNodes + halfPlusOneNodes : 1 + 2 * halfPlusOneNodes;
+    return { countNodes, nextNodes };
+}
+
+} // namespace
+
+void CullingSystem::Initialize(JobSystem* jobs, SimdLevel level)
+{
+    jobSystem = jobs;
+    SetSimdLevel(level);
+}
+
+void CullingSystem::SetSimdLevel(SimdLevel level)
+{
+    kernels = &GetCullingKernels(level);
+}
+
+void CullingSystem::ResizeStreams(uint32_t count)
+{
+    AlignedVector<float>* streams[] = { &centerX, &centerY, &centerZ, &radius, &extentX, &extentY, &extentZ };
+    for (AlignedVector<float>* stream : streams) {
+        stream->resize(count);
+    }
+    bounds = { centerX.data(), centerY.data(), centerZ.data(), radius.data(), extentX.data(), extentY.data(), extentZ.data() };
+}
+
+void CullingSystem::Build(const std::vector<CullingObjectDesc>& objects)
+{
+    const uint32_t count = static_cast<uint32_t>(objects.size());
+    ResizeStreams(count);
+    objectIds.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        const CullingObjectDesc& object = objects[i];
+        centerX[i] = object.centerX;
+        centerY[i] = object.centerY;
+        centerZ[i] = object.centerZ;
+        extentX[i] = object.extentX;
+        extentY[i] = object.extentY;
+        extentZ[i] = object.extentZ;
+        radius[i] = std::sqrt(object.extentX * object.extentX + object.extentY * object.extentY + object.extentZ * object.extentZ);
+        objectIds[i] = i;
+    }
+    BuildHierarchy();
+}
+
+const std::vector<uint32_t>& CullingSystem::Rebuild()
+{
+    BuildHierarchy();
+    return buildOrder;
+}
+
+// 物体を中心の範囲が最も広い軸の中央値で 2 分割していく。
+// 分割は中心とスロットを詰めた buildItems の上で行い（間接参照を避ける）、
+// 並べ替えたスロットの順に境界の配列を並べ直すと、どの部分木の物体も連続した範囲になる。
+void CullingSystem::BuildHierarchy()
+{
+    PROFILE_SCOPE("BuildCullingHierarchy");
+    const uint32_t count = GetObjectCount();
+    const uint32_t nodeCount = count != 0 ? CountNodes(count, MAX_OBJECTS_PER_LEAF).first : 0;
+    nodes.resize(nodeCount);
+    rightChildren.resize(nodeCount);
+    buildItems.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        buildItems[i] = { { centerX[i], centerY[i], centerZ[i] }, i };
+    }
+    if (count != 0) {
+        BuildNode(0, 0, count);
+    }
+    leafNodes.clear();
+    for (uint32_t i = 0; i < nodeCount; ++i) {
+        if (IsLeaf(i)) {
+            leafNodes.push_back(i);
+        }
+    }
+    buildOrder.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        buildOrder[i] = buildItems[i].slot;
+    }
+
+    buildScratch.resize(count);
+    AlignedVector<float>* streams[] = { &centerX, &centerY, &centerZ, &radius, &extentX, &extentY, &extentZ };
+    for (AlignedVector<float>* stream : streams) {
+        for (uint32_t i = 0; i < count; ++i) {
+            buildScratch[i] = (*stream)[buildOrder[i]];
+        }
+        stream->swap(buildScratch);
+    }
+    bounds = { centerX.data(), centerY.data(), centerZ.data(), radius.data(), extentX.data(), extentY.data(), extentZ.data() };
+    std::vector<uint32_t> previousIds(objectIds);
+    for (uint32_t i = 0; i < count; ++i) {
+        objectIds[i] = previousIds[buildOrder[i]];
+    }
+    outputScratch.resize(count);
+
+    Refit();
+    buildSurfaceArea = surfaceArea;
+}
+
+// index のノードに [begin, end) の物体を入れる。
+// 大きな部分木は左の子をジョブに任せて並列に構築する（書き込む範囲は部分木ごとに重ならない）。
+void CullingSystem::BuildNode(uint32_t index, uint32_t begin, uint32_t end)
+{
+    Node node = {};
+    node.firstObject = begin;
+    node.objectCount = end - begin;
+    nodes[index] = node;
+    rightChildren[index] = 0;
+    if (end - begin <= MAX_OBJECTS_PER_LEAF) {
+        return;
+    }
+
+    float minimum[3] = { buildItems[begin].center[0], buildItems[begin].center[1], buildItems[begin].center[2] };
+    float maximum[3] = { minimum[0], minimum[1], minimum[2] };
+    for (uint32_t i = begin + 1; i < end; ++i) {
+        for (int axis = 0; axis < 3; ++axis) {
+            minimum[axis] = (std::min)(minimum[axis], buildItems[i].center[axis]);
+            maximum[axis] = (std::max)(maximum[axis], buildItems[i].center[axis]);
+        }
+    }
+    int splitAxis = 0;
+    for (int axis = 1; axis < 3; ++axis) {
+        if (maximum[axis] - minimum[axis] > maximum[splitAxis] - minimum[splitAxis]) {
+            splitAxis = axis;
+        }
+    }
+    const uint32_t middle = begin + (end - begin) / 2;
+    std::nth_element(buildItems.begin() + begin, buildItems.begin() + middle, buildItems.begin() + end,
+                     [splitAxis](const BuildItem& a, const BuildItem& b) { return a.center[splitAxis] < b.center[splitAxis]; });
+
+    const uint32_t right = index + 1 + CountNodes(middle - begin, MAX_OBJECTS_PER_LEAF).first;
+    rightChildren[index] = right;
+    if (end - begin >= OBJECTS_PER_BUILD_JOB) {
+        JobCounter counter;
+        jobSystem->Schedule([this, index, begin, middle]() { BuildNode(index + 1, begin, middle); }, &counter);
+        BuildNode(right, middle, end);
+        jobSystem->Wait(counter);
+    }
+    else {
+        BuildNode(index + 1, begin, middle);
+        BuildNode(right, middle, end);
+    }
+}
+
+// リーフは物体の境界から並列に、内部ノードは子から順に求める。
+// どちらの形で判定しても外側のノードで物体を取りこぼさないよう、リーフは AABB ではなく境界球を囲む
+// （radius は extent のどの成分より大きい）。
+// 子は親より後ろに並ぶため、後ろから処理すれば子は常に更新済みになる。
+void CullingSystem::Refit()
+{
+    PROFILE_SCOPE("RefitCullingHierarchy");
+    jobSystem->ParallelFor(static_cast<uint32_t>(leafNodes.size()), LEAVES_PER_REFIT_JOB, [this](uint32_t begin, uint32_t end) {
+        for (uint32_t leaf = begin; leaf < end; ++leaf) {
+            Node& node = nodes[leafNodes[leaf]];
+            const uint32_t first = node.firstObject;
+            float minX = centerX[first] - radius[first];
+            float minY = centerY[first] - radius[first];
+            float minZ = centerZ[first] - radius[first];
+            float maxX = centerX[first] + radius[first];
+            float maxY = centerY[first] + radius[first];
+            float maxZ = centerZ[first] + radius[first];
+            for (uint32_t i = first + 1; i < first + node.objectCount; ++i) {
+                minX = (std::min)(minX, centerX[i] - radius[i]);
+                minY = (std::min)(minY, centerY[i] - radius[i]);
+                minZ = (std::min)(minZ, centerZ[i] - radius[i]);
+                maxX = (std::max)(maxX, centerX[i] + radius[i]);
+                maxY = (std::max)(maxY, centerY[i] + radius[i]);
+                maxZ = (std::max)(maxZ, centerZ[i] + radius[i]);
+            }
+            node.minX = minX;
+            node.minY = minY;
+            node.minZ = minZ;
+            node.maxX = maxX;
+            node.maxY = maxY;
+            node.maxZ = maxZ;
+        }
+    });
+
+    float area = 0.0f;
+    for (uint32_t i = static_cast<uint32_t>(nodes.size()); i-- > 0;) {
+        Node& node = nodes[i];
+        if (!IsLeaf(i)) {
+            const Node& left = nodes[i + 1];
+            const Node& right = nodes[rightChildren[i]];
+            node.minX = (std::min)(left.minX, right.minX);
+            node.minY = (std::min)(left.minY, right.minY);
+            node.minZ = (std::min)(left.minZ, right.minZ);
+            node.maxX = (std::max)(left.maxX, right.maxX);
+            node.maxY = (std::max)(left.maxY, right.maxY);
+            node.maxZ = (std::max)(left.maxZ, right.maxZ);
+        }
+        const float dx = node.maxX - node.minX;
+        const float dy = node.maxY - node.minY;
+        const float dz = node.maxZ - node.minZ;
+        area += 2.0f * (dx * dy + dy * dz + dz * dx);
+    }
+    surfaceArea = area;
+}
+
+// planeMask の平面だけを判定する。親が内側に完全に含まれる平面は子も含まれるため判定を省ける。
+// 戻り値: 外側なら OUTSIDE、それ以外は子で判定が必要な平面（0 なら視錐台の内側に完全に含まれる）
+uint32_t CullingSystem::TestNode(const Node& node, const Frustum& frustum, uint32_t planeMask) const
+{
+    const float cx = (node.minX + node.maxX) * 0.5f;
+    const float cy = (node.minY + node.maxY) * 0.5f;
+    const float cz = (node.minZ + node.maxZ) * 0.5f;
+    const float ex = (node.maxX - node.minX) * 0.5f;
+    const float ey = (node.maxY - node.minY) * 0.5f;
+    const float ez = (node.maxZ - node.minZ) * 0.5f;
+    uint32_t remaining = planeMask;
+    for (uint32_t p = 0; p < FRUSTUM_PLANE_COUNT; ++p) {
+        if ((planeMask & (1u << p)) == 0) {
+            continue;
+        }
+        const Plane& plane = frustum.planes[p];
+        const float distance = plane.nx * cx + plane.ny * cy + plane.nz * cz + plane.d;
+        const float extent = Abs(plane.nx) * ex + Abs(plane.ny) * ey + Abs(plane.nz) * ez;
+        if (distance + extent < 0.0f) {
+            return OUTSIDE;
+        }
+        if (distance - extent >= 0.0f) {
+            remaining &= ~(1u << p);
+        }
+    }
+    return remaining;
+}
+
+// 呼び出し元のスレッドで根から OBJECTS_PER_TRAVERSAL_JOB 程度の部分木まで下り、並列にたどる部分木を集める。
+// 左の子を先にたどるため、タスクはスロットの昇順に並ぶ。
+void CullingSystem::CollectTasks(const Frustum& frustum)
+{
+    tasks.clear();
+    if (nodes.empty()) {
+        return;
+    }
+    TraversalTask stack[MAX_TRAVERSAL_DEPTH];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = { 0, ALL_PLANES };
+    while (stackSize != 0) {
+        const TraversalTask entry = stack[--stackSize];
+        const Node& node = nodes[entry.node];
+        const uint32_t planeMask = TestNode(node, frustum, entry.planeMask);
+        if (planeMask == OUTSIDE) {
+            continue;
+        }
+        if (planeMask == 0 || IsLeaf(entry.node) || node.objectCount <= OBJECTS_PER_TRAVERSAL_JOB) {
+            tasks.push_back({ entry.node, entry.planeMask });
+            continue;
+        }
+        stack[stackSize++] = { rightChildren[entry.node], planeMask };
+        stack[stackSize++] = { entry.node + 1, planeMask };
+    }
+}
+
+// 部分木の結果はスロットと同じ位置から outputScratch に書き出す（タスク間で領域が重ならない）
+void CullingSystem::TraverseTask(const TraversalTask& task, const Frustum& frustum, FrustumCullKernel kernel, TaskResult& result)
+{
+    uint32_t* output = outputScratch.data() + nodes[task.node].firstObject;
+    uint32_t count = 0;
+    TraversalTask stack[MAX_TRAVERSAL_DEPTH];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = task;
+    while (stackSize != 0) {
+        const TraversalTask entry = stack[--stackSize];
+        const Node& node = nodes[entry.node];
+        ++result.visitedNodes;
+        const uint32_t planeMask = TestNode(node, frustum, entry.planeMask);
+        if (planeMask == OUTSIDE) {
+            continue;
+        }
+        if (planeMask == 0) {
+            for (uint32_t i = 0; i < node.objectCount; ++i) {
+                output[count + i] = node.firstObject + i;
+            }
+            count += node.objectCount;
+            result.acceptedObjects += node.objectCount;
+            continue;
+        }
+        if (IsLeaf(entry.node)) {
+            count += kernel(bounds, node.firstObject, node.firstObject + node.objectCount, frustum, output + count);
+            result.testedObjects += node.objectCount;
+            continue;
+        }
+        stack[stackSize++] = { rightChildren[entry.node], planeMask };
+        stack[stackSize++] = { entry.node + 1, planeMask };
+    }
+    result.visibleCount = count;
+}
+
+void CullingSystem::Cull(const Frustum& frustum, CullingShape shape, CullingMethod method, std::vector<uint32_t>& visibleSlots)
+{
+    PROFILE_SCOPE("FrustumCull");
+    const FrustumCullKernel kernel = shape == CullingShape::Sphere ? kernels->cullSpheres : kernels->cullAabbs;
+    taskOffsets.clear();
+
+    if (method == CullingMethod::BruteForce) {
+        const uint32_t count = GetObjectCount();
+        const uint32_t taskCount = (count + OBJECTS_PER_JOB - 1) / OBJECTS_PER_JOB;
+        taskResults.assign(taskCount, TaskResult());
+        jobSystem->ParallelFor(count, OBJECTS_PER_JOB, [&](uint32_t begin, uint32_t end) {
+            TaskResult& result = taskResults[begin / OBJECTS_PER_JOB];
+            result.visibleCount = kernel(bounds, begin, end, frustum, outputScratch.data() + begin);
+            result.testedObjects = end - begin;
+        });
+        for (uint32_t task = 0; task < taskCount; ++task) {
+            taskOffsets.push_back(task * OBJECTS_PER_JOB);
+        }
+    }
+    else {
+        CollectTasks(frustum);
+        const uint32_t taskCount = static_cast<uint32_t>(tasks.size());
+        taskResults.assign(taskCount, TaskResult());
+        jobSystem->ParallelFor(taskCount, 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t task = begin; task < end; ++task) {
+                TraverseTask(tasks[task], frustum, kernel, taskResults[task]);
+            }
+        });
+        for (const TraversalTask& task : tasks) {
+            taskOffsets.push_back(nodes[task.node].firstObject);
+        }
+    }
+    GatherResults(visibleSlots);
+}
+
+// 各タスクの結果をタスクの順（スロットの昇順）に詰めて visibleSlots へ書き出す
+void CullingSystem::GatherResults(std::vector<uint32_t>& visibleSlots)
+{
+    stats = CullingStats();
+    stats.taskCount = static_cast<uint32_t>(taskResults.size());
+    for (const TaskResult& result : taskResults) {
+        stats.visibleCount += result.visibleCount;
+        stats.visitedNodes += result.visitedNodes;
+        stats.testedObjects += result.testedObjects;
+        stats.acceptedObjects += result.acceptedObjects;
+    }
+    visibleSlots.resize(stats.visibleCount);
+    uint32_t* output = visibleSlots.data();
+    for (size_t task = 0; task < taskResults.size(); ++task) {
+        const uint32_t count = taskResults[task].visibleCount;
+        std::copy(outputScratch.begin() + taskOffsets[task], outputScratch.begin() + taskOffsets[task] + count, output);
+        output += count;
+    }
+}
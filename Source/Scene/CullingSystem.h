@@ -0,0 +1,151 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "../Core/AlignedAllocator.h"
+#include "../Core/CpuFeatures.h"
+#include "CullingKernels.h"
+#include "Frustum.h"
+
+class JobSystem;
+
+// カリング対象の物体の初期値（境界球の半径は extent の長さ）
+struct CullingObjectDesc {
+    float centerX = 0.0f;
+    float centerY = 0.0f;
+    float centerZ = 0.0f;
+    float extentX = 0.0f;
+    float extentY = 0.0f;
+    float extentZ = 0.0f;
+};
+
+// 物体ごとに判定する境界の形
+enum class CullingShape : uint8_t {
+    Sphere,
+    Aabb,
+};
+
+enum class CullingMethod : uint8_t {
+    Hierarchy,  // 階層をたどり、視錐台と交差するリーフの物体だけを判定する
+    BruteForce, // 全物体を判定する（比較用）
+};
+
+// 直近の Cull の統計
+struct CullingStats {
+    uint32_t visibleCount = 0;
+    uint32_t visitedNodes = 0;
+    uint32_t testedObjects = 0;   // カーネルで判定した物体の数
+    uint32_t acceptedObjects = 0; // 視錐台の内側のノードに含まれ、判定せずに可視とした物体の数
+    uint32_t taskCount = 0;
+};
+
+// 物体の境界を BVH のリーフ順に並べた SoA で保持し、視錐台カリングを SIMD カーネルとジョブシステムで並列に行う。
+// 物体の番号（Build に渡した順番）とは別に、配列上の位置（スロット）は構築のたびに並べ替える。
+// 物体を動かす場合は GetBounds の配列を直接書き換えてから Refit を呼ぶ（構造は変えずにノードの AABB を更新する）。
+// Refit を繰り返して階層の質が落ちたら（GetDegradation が大きくなったら）Rebuild で作り直す。
+class CullingSystem {
+public:
+    // リーフに入れる物体の最大数
+    static constexpr uint32_t MAX_OBJECTS_PER_LEAF = 16;
+    // 1 ジョブで判定する物体数の目安（総当たり）、1 ジョブでたどる部分木の物体数の目安（階層）
+    static constexpr uint32_t OBJECTS_PER_JOB = 16384;
+    static constexpr uint32_t OBJECTS_PER_TRAVERSAL_JOB = 8192;
+    // これより多くの物体を持つ部分木は子を並列に構築する
+    static constexpr uint32_t OBJECTS_PER_BUILD_JOB = 65536;
+    // 1 ジョブで Refit するリーフ数
+    static constexpr uint32_t LEAVES_PER_REFIT_JOB = 1024;
+
+    // jobs: カリングを実行するジョブシステム（所有しない）
+    // level: 使用するカーネルの命令セット（サポート外の場合は自動的に下げる）
+    void Initialize(JobSystem* jobs, SimdLevel level = GetSupportedSimdLevel());
+    // カーネルの命令セットを切り替える（比較計測用）
+    void SetSimdLevel(SimdLevel level);
+    SimdLevel GetSimdLevel() const { return kernels->level; }
+
+    // 物体を置き換えて階層を構築する
+    void Build(const std::vector<CullingObjectDesc>& objects);
+    // 現在の境界で階層を作り直す。
+    // 戻り値: 新しいスロットごとの元のスロット（呼び出し側がスロット順に持つデータを並べ替えるために使う）
+    const std::vector<uint32_t>& Rebuild();
+    // 物体の移動に合わせてノードの AABB を更新する
+    void Refit();
+    // 構築直後に対する現在のノードの表面積の合計の比（1 = 構築直後と同じ）
+    float GetDegradation() const { return buildSurfaceArea > 0.0f ? surfaceArea / buildSurfaceArea : 1.0f; }
+
+    // frustum と交差する物体のスロットを visibleSlots に書き出す（スロットの昇順）
+    void Cull(const Frustum& frustum, CullingShape shape, CullingMethod method, std::vector<uint32_t>& visibleSlots);
+
+    // 戻り値: スロット順の境界の配列（Build/Rebuild で無効になる）
+    const BoundsStreams& GetBounds() const { return bounds; }
+    uint32_t GetObjectCount() const { return static_cast<uint32_t>(objectIds.size()); }
+    uint32_t GetObjectId(uint32_t slot) const { return objectIds[slot]; }
+    uint32_t GetNodeCount() const { return static_cast<uint32_t>(nodes.size()); }
+    const CullingStats& GetStats() const { return stats; }
+
+private:
+    // 深さ優先順に並べた 32 バイトのノード。左の子は直後のノード、右の子は rightChildren に持つ。
+    // 部分木の物体はスロット [firstObject, firstObject + objectCount) に連続して並ぶ。
+    struct Node {
+        float minX, minY, minZ;
+        uint32_t firstObject;
+        float maxX, maxY, maxZ;
+        uint32_t objectCount;
+    };
+
+    // 並列にたどる部分木と、その根で判定が必要な平面のビットマスク
+    struct TraversalTask {
+        uint32_t node = 0;
+        uint32_t planeMask = 0;
+    };
+
+    // 構築中に分割する物体（中心と元のスロット）
+    struct BuildItem {
+        float center[3];
+        uint32_t slot;
+    };
+
+    struct TaskResult {
+        uint32_t visibleCount = 0;
+        uint32_t visitedNodes = 0;
+        uint32_t testedObjects = 0;
+        uint32_t acceptedObjects = 0;
+    };
+
+    bool IsLeaf(uint32_t node) const { return rightChildren[node] == 0; }
+    void BuildNode(uint32_t index, uint32_t begin, uint32_t end);
+    void BuildHierarchy();
+    void ResizeStreams(uint32_t count);
+    uint32_t TestNode(const Node& node, const Frustum& frustum, uint32_t planeMask) const;
+    void CollectTasks(const Frustum& frustum);
+    void TraverseTask(const TraversalTask& task, const Frustum& frustum, FrustumCullKernel kernel, TaskResult& result);
+    void GatherResults(std::vector<uint32_t>& visibleSlots);
+
+    JobSystem* jobSystem = nullptr;
+    const CullingKernelTable* kernels = nullptr;
+
+    AlignedVector<float> centerX;
+    AlignedVector<float> centerY;
+    AlignedVector<float> centerZ;
+    AlignedVector<float> radius;
+    AlignedVector<float> extentX;
+    AlignedVector<float> extentY;
+    AlignedVector<float> extentZ;
+    BoundsStreams bounds;
+    std::vector<uint32_t> objectIds; // スロットごとの物体の番号
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> rightChildren; // リーフは 0
+    std::vector<uint32_t> leafNodes;
+    std::vector<BuildItem> buildItems;
+    std::vector<uint32_t> buildOrder;    // 新しいスロットごとの元のスロット（Rebuild の戻り値）
+    AlignedVector<float> buildScratch;
+    float surfaceArea = 0.0f;
+    float buildSurfaceArea = 0.0f;
+
+    // Cull の作業領域（容量は再利用する）。outputScratch はスロットと同じ位置に各タスクの結果を書き出す
+    std::vector<uint32_t> outputScratch;
+    std::vector<TraversalTask> tasks;
+    std::vector<TaskResult> taskResults;
+    std::vector<uint32_t> taskOffsets;   // タスクの結果を書き出した outputScratch 上の位置
+    CullingStats stats;
+};
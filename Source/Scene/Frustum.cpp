@@ -0,0 +1,57 @@
+﻿#include "Frustum.h"
+#include <cmath>
+
+namespace {
+
+// row * viewProjection の列 column の要素を返す
+float GetColumn(const float m[16], int row, int column)
+{
+    return m[row * 4 + column];
+}
+
+Plane MakePlane(const float m[16], int column, float sign, int baseColumn)
+{
+    Plane plane;
+    plane.nx = GetColumn(m, 0, baseColumn) + sign * GetColumn(m, 0, column);
+    plane.ny = GetColumn(m, 1, baseColumn) + sign * GetColumn(m, 1, column);
+    plane.nz = GetColumn(m, 2, baseColumn) + sign * GetColumn(m, 2, column);
+    plane.d = GetColumn(m, 3, baseColumn) + sign * GetColumn(m, 3, column);
+    return plane;
+}
+
+Plane Normalize(const Plane& plane)
+{
+    const float length = std::sqrt(plane.nx * plane.nx + plane.ny * plane.ny + plane.nz * plane.nz);
+    const float scale = length > 0.0f ? 1.0f / length : 0.0f;
+    return { plane.nx * scale, plane.ny * scale, plane.nz * scale, plane.d * scale };
+}
+
+} // namespace
+
+// クリップ座標 (x, y, z, w) の条件 -w <= x <= w、-w <= y <= w、0 <= z <= w を
+// 行列の列の線形結合として表す（Gribb/Hartmann の方法）
+Frustum ExtractFrustum(const float viewProjection[16])
+{
+    Frustum frustum;
+    frustum.planes[FRUSTUM_LEFT] = Normalize(MakePlane(viewProjection, 0, 1.0f, 3));
+    frustum.planes[FRUSTUM_RIGHT] = Normalize(MakePlane(viewProjection, 0, -1.0f, 3));
+    frustum.planes[FRUSTUM_BOTTOM] = Normalize(MakePlane(viewProjection, 1, 1.0f, 3));
+    frustum.planes[FRUSTUM_TOP] = Normalize(MakePlane(viewProjection, 1, -1.0f, 3));
+    frustum.planes[FRUSTUM_NEAR] = Normalize(MakePlane(viewProjection, 2, 0.0f, 2));
+    frustum.planes[FRUSTUM_FAR] = Normalize(MakePlane(viewProjection, 2, -1.0f, 3));
+    return frustum;
+}
+
+void MakeOrthographicViewProjection(float left, float right, float bottom, float top, float nearZ, float farZ, float viewProjection[16])
+{
+    for (int i = 0; i < 16; ++i) {
+        viewProjection[i] = 0.0f;
+    }
+    viewProjection[0] = 2.0f / (right - left);
+    viewProjection[5] = 2.0f / (top - bottom);
+    viewProjection[10] = 1.0f / (farZ - nearZ);
+    viewProjection[12] = -(right + left) / (right - left);
+    viewProjection[13] = -(top + bottom) / (top - bottom);
+    viewProjection[14] = -nearZ / (farZ - nearZ);
+    viewProjection[15] = 1.0f;
+}
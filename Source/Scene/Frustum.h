@@ -0,0 +1,31 @@
+﻿#pragma once
+
+// 平面 nx*x + ny*y + nz*z + d = 0（法線は内側向きで、内側の点は正の距離になる）
+struct Plane {
+    float nx = 0.0f;
+    float ny = 0.0f;
+    float nz = 0.0f;
+    float d = 0.0f;
+};
+
+enum FrustumPlane {
+    FRUSTUM_LEFT,
+    FRUSTUM_RIGHT,
+    FRUSTUM_BOTTOM,
+    FRUSTUM_TOP,
+    FRUSTUM_NEAR,
+    FRUSTUM_FAR,
+    FRUSTUM_PLANE_COUNT,
+};
+
+// 視錐台の 6 平面（法線は正規化済み）
+struct Frustum {
+    Plane planes[FRUSTUM_PLANE_COUNT];
+};
+
+// 行ベクトル規約（clip = float4(position, 1) * viewProjection、DirectXMath と同じ）の
+// 行優先 4x4 行列から視錐台を取り出す。クリップ空間の z は D3D と同じ [0, 1]。
+Frustum ExtractFrustum(const float viewProjection[16]);
+
+// 軸に沿った直方体を [-1, 1] x [-1, 1] x [0, 1] へ写す正射影行列（行ベクトル規約、行優先）
+void MakeOrthographicViewProjection(float left, float right, float bottom, float top, float nearZ, float farZ, float viewProjection[16]);
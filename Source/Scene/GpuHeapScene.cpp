@@ -0,0 +1,224 @@
+﻿#include "GpuHeapScene.h"
+#include "SceneRegistry.h"
+#include "../Core/Profiler.h"
+#include "../Render/FrameScheduler.h"
+#include "../Render/LinearRingAllocator.h"
+#include "../Render/ResidencyManager.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+// 常駐させるリソースの予算と、シミュレーションのデバイスが作成できるヒープの合計
+constexpr uint64_t GPU_HEAP_SCENE_BUDGET = 1024ull * 1024 * 1024;
+constexpr uint64_t GPU_HEAP_SCENE_DEVICE_MEMORY = 2048ull * 1024 * 1024;
+// 生存させておくリソース数と、1 フレームで破棄/作成するリソース数
+constexpr uint32_t GPU_HEAP_SCENE_RESOURCE_COUNT = 1500;
+constexpr uint32_t GPU_HEAP_SCENE_CHURN_PER_FRAME = 48;
+// 1 フレームで使用するリソース数。毎フレーム使う範囲（生存中のリソースの先頭の一定割合）と、
+// それ以外からまれに使うリソース数（退避済みであれば配置し直しになる）
+constexpr uint32_t GPU_HEAP_SCENE_USES_PER_FRAME = 256;
+constexpr float GPU_HEAP_SCENE_HOT_RATIO = 0.3f;
+constexpr uint32_t GPU_HEAP_SCENE_COLD_USES_PER_FRAME = 8;
+// リソースを固定（退避/再配置しない）にする割合
+constexpr float GPU_HEAP_SCENE_PINNED_RATIO = 0.03f;
+
+// 大きさの範囲 [minBytes, maxBytes) から対数一様に選ぶ
+uint64_t PickLogUniform(std::mt19937& random, double minBytes, double maxBytes)
+{
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    return static_cast<uint64_t>(minBytes * std::pow(maxBytes / minBytes, unit(random)));
+}
+
+// テクスチャとバッファの混在を想定した大きさと種類の分布。
+// 約 6 割が 256KB 以下の小さいリソース、3 割強が 8MB までの中くらいのリソース、残りが 32MB までの大きいリソース。
+GpuResourceDesc MakeRandomResourceDesc(std::mt19937& random)
+{
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    GpuResourceDesc desc;
+    const float kind = unit(random);
+    desc.heapClass = kind < 0.5f ? GpuHeapClass::Texture : kind < 0.85f ? GpuHeapClass::Buffer : GpuHeapClass::RenderTarget;
+    const float size = unit(random);
+    if (size < 0.6f) {
+        desc.size = PickLogUniform(random, 4.0 * 1024, 256.0 * 1024);
+    }
+    else if (size < 0.97f) {
+        desc.size = PickLogUniform(random, 256.0 * 1024, 8.0 * 1024 * 1024);
+    }
+    else {
+        desc.size = PickLogUniform(random, 8.0 * 1024 * 1024, 32.0 * 1024 * 1024);
+    }
+    // D3D12 と同じく、64KB 以下のテクスチャだけが 4KB アライメントで置ける
+    const bool smallTexture = desc.heapClass == GpuHeapClass::Texture && desc.size <= 64 * 1024;
+    desc.alignment = smallTexture ? 4096 : 65536;
+    desc.size = AlignUp(desc.size, desc.alignment);
+    desc.pinned = unit(random) < GPU_HEAP_SCENE_PINNED_RATIO;
+    return desc;
+}
+
+// 予算を超える量のリソースを作成/破棄しながら、毎フレーム一部（予算に収まる範囲と、まれに使うリソース）を使用する。
+// フェンス値は DEFAULT_FRAMES_IN_FLIGHT 前のフレームが完了している想定で進める。
+// 計測値: 作成（最初の配置まで）/使用/破棄/フレーム先頭の処理の時間、ヒープの使用率と断片化、
+// 退避/配置し直し/最適化の量、リソースごとにヒープを作る方式（CreateCommittedResource 相当）とのヒープ数の比較。
+class GpuHeapScene : public IScene {
+public:
+    explicit GpuHeapScene(bool enableDefragment) : defragment(enableDefragment), backend(GPU_HEAP_SCENE_DEVICE_MEMORY) {}
+
+    void Initialize(FrameRenderer& renderer) override
+    {
+        (void)renderer;
+        allocator.Initialize(&backend, GpuHeapAllocatorDesc{});
+        ResidencyManagerDesc residencyDesc;
+        residencyDesc.budgetBytes = GPU_HEAP_SCENE_BUDGET;
+        residencyDesc.defragmentBytesPerFrame = defragment ? residencyDesc.defragmentBytesPerFrame : 0;
+        residency.Initialize(&allocator, &backend, residencyDesc);
+
+        // 読み込みと同じく複数フレームに分けて作成する（1 フレームで予算を超えると退避できるリソースがない）
+        live.reserve(GPU_HEAP_SCENE_RESOURCE_COUNT);
+        for (uint32_t i = 0; i < GPU_HEAP_SCENE_RESOURCE_COUNT; ++i) {
+            if (i % GPU_HEAP_SCENE_CHURN_PER_FRAME == 0) {
+                AdvanceFrame();
+            }
+            CreateResource();
+        }
+        createNs.clear();
+        loadFrameCount = fenceValue;
+    }
+
+    // 破棄した領域の解放待ちをすべて完了させてから、ヒープを破棄する
+    ~GpuHeapScene() override
+    {
+        for (GpuResourceHandle resource : live) {
+            residency.DestroyResource(resource);
+        }
+        residency.BeginFrame(UINT64_MAX, UINT64_MAX);
+        allocator.Shutdown();
+    }
+
+    void Update(float deltaTime) override
+    {
+        (void)deltaTime;
+        PROFILE_SCOPE("GpuHeapStress");
+        uint64_t startNs = Profiler::Now();
+        AdvanceFrame();
+        beginFrameNs += Profiler::Now() - startNs;
+
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        for (uint32_t i = 0; i < GPU_HEAP_SCENE_CHURN_PER_FRAME; ++i) {
+            const size_t index = static_cast<size_t>(unit(random) * static_cast<float>(live.size())) % live.size();
+            startNs = Profiler::Now();
+            residency.DestroyResource(live[index]);
+            destroyNs += Profiler::Now() - startNs;
+            ++destroyCount;
+            live[index] = live.back();
+            live.pop_back();
+        }
+        for (uint32_t i = 0; i < GPU_HEAP_SCENE_CHURN_PER_FRAME; ++i) {
+            CreateResource();
+        }
+
+        // 破棄した位置には末尾のリソースが入るため、毎フレーム使う範囲も少しずつ入れ替わる
+        startNs = Profiler::Now();
+        const float hotCount = static_cast<float>(live.size()) * GPU_HEAP_SCENE_HOT_RATIO;
+        for (uint32_t i = 0; i < GPU_HEAP_SCENE_USES_PER_FRAME; ++i) {
+            const float u = unit(random);
+            const float position = i < GPU_HEAP_SCENE_COLD_USES_PER_FRAME ? hotCount + u * (static_cast<float>(live.size()) - hotCount) : u * hotCount;
+            residency.Use(live[static_cast<size_t>(position) % live.size()]);
+        }
+        useNs += Profiler::Now() - startNs;
+        useCount += GPU_HEAP_SCENE_USES_PER_FRAME;
+
+        const GpuHeapAllocatorStats& heapStats = allocator.GetStats();
+        fragmentationSum += allocator.GetFragmentation();
+        peakFragmentation = (std::max)(peakFragmentation, allocator.GetFragmentation());
+        utilizationSum += heapStats.heapBytes != 0 ? static_cast<double>(heapStats.usedBytes) / static_cast<double>(heapStats.heapBytes) : 0.0;
+    }
+
+    void GetMetrics(SceneMetrics& metrics) const override
+    {
+        const double frames = fenceValue > loadFrameCount ? static_cast<double>(fenceValue - loadFrameCount) : 1.0;
+        const double mb = 1024.0 * 1024.0;
+        const ResidencyStats& stats = residency.GetStats();
+        const GpuHeapAllocatorStats& heapStats = allocator.GetStats();
+
+        std::vector<uint64_t> sorted = createNs;
+        std::sort(sorted.begin(), sorted.end());
+        const auto percentile = [&sorted](double p) {
+            return sorted.empty() ? 0.0 : static_cast<double>(sorted[static_cast<size_t>(p * static_cast<double>(sorted.size() - 1))]);
+        };
+        metrics.emplace_back("resources", static_cast<double>(stats.resourceCount));
+        metrics.emplace_back("budgetMB", static_cast<double>(GPU_HEAP_SCENE_BUDGET) / mb);
+        metrics.emplace_back("residentMB", static_cast<double>(stats.residentBytes) / mb);
+        metrics.emplace_back("heapMB", static_cast<double>(heapStats.heapBytes) / mb);
+        metrics.emplace_back("peakHeapMB", static_cast<double>(heapStats.peakHeapBytes) / mb);
+        metrics.emplace_back("heaps", static_cast<double>(heapStats.heapCount));
+        metrics.emplace_back("averageHeapUtilization", utilizationSum / frames);
+        metrics.emplace_back("averageFragmentation", fragmentationSum / frames);
+        metrics.emplace_back("peakFragmentation", peakFragmentation);
+        metrics.emplace_back("createP50Ns", percentile(0.5));
+        metrics.emplace_back("createP99Ns", percentile(0.99));
+        metrics.emplace_back("createMaxNs", sorted.empty() ? 0.0 : static_cast<double>(sorted.back()));
+        metrics.emplace_back("useAverageNs", useCount != 0 ? static_cast<double>(useNs) / static_cast<double>(useCount) : 0.0);
+        metrics.emplace_back("destroyAverageNs", destroyCount != 0 ? static_cast<double>(destroyNs) / static_cast<double>(destroyCount) : 0.0);
+        metrics.emplace_back("beginFrameUs", static_cast<double>(beginFrameNs) / 1e3 / frames);
+        metrics.emplace_back("evictionsPerFrame", static_cast<double>(stats.evictions) / frames);
+        metrics.emplace_back("restoresPerFrame", static_cast<double>(stats.restores) / frames);
+        metrics.emplace_back("movedMBPerFrame", static_cast<double>(stats.movedBytes) / mb / frames);
+        metrics.emplace_back("defragmentedHeaps", static_cast<double>(stats.defragmentedHeaps));
+        metrics.emplace_back("budgetOverruns", static_cast<double>(stats.budgetOverruns));
+        metrics.emplace_back("heapsCreated", static_cast<double>(heapStats.heapsCreated));
+        metrics.emplace_back("heapsDestroyed", static_cast<double>(heapStats.heapsDestroyed));
+        // リソースごとにヒープを作る方式では、配置のたびに 1 つヒープを作る
+        metrics.emplace_back("committedHeapsCreated", static_cast<double>(heapStats.totalAllocations));
+    }
+
+private:
+    // 次のフレームのフェンス値へ進める
+    void AdvanceFrame()
+    {
+        ++fenceValue;
+        residency.BeginFrame(fenceValue, fenceValue > DEFAULT_FRAMES_IN_FLIGHT ? fenceValue - DEFAULT_FRAMES_IN_FLIGHT : 0);
+    }
+
+    // 作成から最初の配置（Use）までを 1 回の確保として計測する
+    void CreateResource()
+    {
+        const GpuResourceDesc desc = MakeRandomResourceDesc(random);
+        const uint64_t startNs = Profiler::Now();
+        const GpuResourceHandle resource = residency.CreateResource(desc);
+        residency.Use(resource);
+        createNs.push_back(Profiler::Now() - startNs);
+        live.push_back(resource);
+    }
+
+    bool defragment = true;
+    SimulatedGpuMemoryBackend backend;
+    GpuHeapAllocator allocator;
+    ResidencyManager residency;
+    std::mt19937 random{ 24680 };
+    std::vector<GpuResourceHandle> live;
+    std::vector<uint64_t> createNs;
+    uint64_t fenceValue = 0;
+    uint64_t loadFrameCount = 0; // Initialize で作成に使ったフレーム数
+    uint64_t beginFrameNs = 0;
+    uint64_t useNs = 0;
+    uint64_t useCount = 0;
+    uint64_t destroyNs = 0;
+    uint64_t destroyCount = 0;
+    double fragmentationSum = 0.0;
+    double peakFragmentation = 0.0;
+    double utilizationSum = 0.0;
+};
+
+} // namespace
+
+void RegisterGpuHeapScenes(SceneRegistry& registry)
+{
+    registry.Register("gpu-heap-stress", "1500 placed resources churned through TLSF heap pools under a 1GB residency budget with LRU eviction and incremental defragmentation",
+                      [] { return std::make_unique<GpuHeapScene>(true); });
+    registry.Register("gpu-heap-stress-nodefrag", "1500 placed resources churned through TLSF heap pools under a 1GB residency budget without defragmentation",
+                      [] { return std::make_unique<GpuHeapScene>(false); });
+}
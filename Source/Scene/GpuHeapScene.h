@@ -0,0 +1,6 @@
+﻿#pragma once
+
+class SceneRegistry;
+
+// 配置リソースのヒープアロケータと常駐マネージャに、GPU を使わずに作成/破棄/使用を繰り返すシーンを登録する
+void RegisterGpuHeapScenes(SceneRegistry& registry);
@@ -0,0 +1,6 @@
+﻿#pragma once
+
+class SceneRegistry;
+
+// CPU（SIMD カーネル）と非同期コンピュートの 2 つの経路で粒子を更新するシーンを登録する
+void RegisterParticleScenes(SceneRegistry& registry);
@@ -0,0 +1,149 @@
+﻿#include "SampleScenes.h"
+#include "AllocationChurnScene.h"
+#include "CullingScene.h"
+#include "GpuHeapScene.h"
+#include "ParticleScene.h"
+#include "SceneRegistry.h"
+#include "StreamingScene.h"
+#include "../Core/CpuFeatures.h"
+#include "../Render/BuiltinPipelineStates.h"
+#include "../Render/FrameRenderer.h"
+#include <memory>
+#include <random>
+
+namespace {
+
+// スプライトシーンのバッチ数と 1 バッチあたりのインスタンス数
+constexpr uint32_t SPRITE_BATCH_COUNT = 2;
+constexpr uint32_t SPRITES_PER_BATCH = 100000;
+// 描画コールシーンの描画アイテム数
+constexpr uint32_t DRAW_CALL_SCENE_DRAW_COUNT = 20000;
+
+DrawItem CreateTriangleDraw(FrameRenderer& renderer)
+{
+    // 3 つの色付き頂点を持つ頂点バッファを作成
+    const ColorVertex triangle[] = {
+        {  0.0f,  0.5f, 1.0f, 0.0f, 0.0f },
+        {  0.5f, -0.5f, 0.0f, 1.0f, 0.0f },
+        { -0.5f, -0.5f, 0.0f, 0.0f, 1.0f },
+    };
+    IRenderBackend& backend = renderer.GetBackend();
+    DrawItem draw;
+    draw.pipeline = backend.GetBuiltinPipeline(BuiltinPipeline::VertexColor);
+    draw.topology = PrimitiveTopology::TriangleList;
+    draw.vertexBuffer.gpuAddress = backend.CreateStaticBuffer(triangle, sizeof(triangle));
+    draw.vertexBuffer.strideInBytes = ColorVertexStream::STRIDE;
+    draw.vertexBuffer.sizeInBytes = sizeof(triangle);
+    draw.vertexCount = 3;
+    draw.instanceCount = 1;
+    return draw;
+}
+
+// 画面中央に 1 つの三角形を描画する
+class TriangleScene : public IScene {
+public:
+    void Initialize(FrameRenderer& renderer) override
+    {
+        renderer.AddStaticDraw(CreateTriangleDraw(renderer));
+    }
+};
+
+// 三角形の上に、跳ね回りながら明滅する小さな三角形/四角形を多数インスタンス描画する。
+// マウスカーソルの位置には白い四角形を描く。
+// simdLevel でインスタンス更新カーネルの命令セットを固定できる（カーネル比較の計測用）。
+class SpriteScene : public IScene {
+public:
+    explicit SpriteScene(SimdLevel level) : simdLevel(level) {}
+
+    void Initialize(FrameRenderer& renderer) override
+    {
+        renderer.AddStaticDraw(CreateTriangleDraw(renderer));
+
+        // 三角形（3 頂点）と四角形（6 頂点）のメッシュを 1 つのバッファに並べる
+        const MeshVertex meshVertices[] = {
+            {  0.0f,  1.0f }, {  0.87f, -0.5f }, { -0.87f, -0.5f },
+            { -0.7f,  0.7f }, {  0.7f,  0.7f }, {  0.7f, -0.7f },
+            { -0.7f,  0.7f }, {  0.7f, -0.7f }, { -0.7f, -0.7f },
+        };
+        const uint32_t meshVertexCounts[SPRITE_BATCH_COUNT] = { 3, 6 };
+        IRenderBackend& backend = renderer.GetBackend();
+        const uint64_t meshAddress = backend.CreateStaticBuffer(meshVertices, sizeof(meshVertices));
+
+        InstancedBatchRenderer& instances = renderer.GetInstances();
+        instances.SetSimdLevel(simdLevel);
+
+        // バッチごとにランダムな位置/速度/色のインスタンスを生成（シード固定で毎回同じ配置）
+        std::mt19937 random(12345);
+        std::uniform_real_distribution<float> signedUnit(-1.0f, 1.0f);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        uint32_t meshOffset = 0;
+        for (uint32_t batchIndex = 0; batchIndex < SPRITE_BATCH_COUNT; ++batchIndex) {
+            InstanceBatchDesc batchDesc;
+            batchDesc.pipeline = backend.GetBuiltinPipeline(BuiltinPipeline::Instanced);
+            batchDesc.topology = PrimitiveTopology::TriangleList;
+            batchDesc.mesh.gpuAddress = meshAddress + meshOffset;
+            batchDesc.mesh.strideInBytes = MeshVertexStream::STRIDE;
+            batchDesc.mesh.sizeInBytes = meshVertexCounts[batchIndex] * MeshVertexStream::STRIDE;
+            batchDesc.vertexCount = meshVertexCounts[batchIndex];
+            meshOffset += batchDesc.mesh.sizeInBytes;
+
+            InstanceStorage& storage = instances.GetInstances(instances.CreateBatch(batchDesc));
+            storage.Reserve(SPRITES_PER_BATCH);
+            for (uint32_t i = 0; i < SPRITES_PER_BATCH; ++i) {
+                InstanceDesc instance;
+                instance.positionX = signedUnit(random);
+                instance.positionY = signedUnit(random);
+                instance.velocityX = signedUnit(random) * 0.3f;
+                instance.velocityY = signedUnit(random) * 0.3f;
+                instance.rotation = signedUnit(random) * 3.14159265f;
+                instance.angularVelocity = signedUnit(random) * 2.0f;
+                instance.scale = 0.004f + unit(random) * 0.006f;
+                instance.colorR = unit(random);
+                instance.colorG = unit(random);
+                instance.colorB = unit(random);
+                instance.phase = unit(random);
+                storage.Add(instance);
+            }
+            // 入力のレイトラッチを確認できるように、四角形のメッシュでカーソルを描く
+            if (meshVertexCounts[batchIndex] == 6) {
+                renderer.SetCursorBatch(batchDesc);
+            }
+        }
+    }
+
+private:
+    SimdLevel simdLevel;
+};
+
+// 同じ三角形を多数の個別の描画コールで描画し、並列記録の負荷を計測する
+class DrawCallScene : public IScene {
+public:
+    void Initialize(FrameRenderer& renderer) override
+    {
+        const DrawItem draw = CreateTriangleDraw(renderer);
+        for (uint32_t i = 0; i < DRAW_CALL_SCENE_DRAW_COUNT; ++i) {
+            renderer.AddStaticDraw(draw);
+        }
+    }
+};
+
+} // namespace
+
+void RegisterSampleScenes(SceneRegistry& registry)
+{
+    registry.Register("triangle", "Single vertex-colored triangle", [] { return std::make_unique<TriangleScene>(); });
+    registry.Register("sprites", "200k instanced sprites updated with the best supported SIMD kernels",
+                      [] { return std::make_unique<SpriteScene>(GetSupportedSimdLevel()); });
+    registry.Register("sprites-scalar", "200k instanced sprites updated with the scalar kernels",
+                      [] { return std::make_unique<SpriteScene>(SimdLevel::Scalar); });
+    registry.Register("sprites-sse2", "200k instanced sprites updated with the SSE2 kernels",
+                      [] { return std::make_unique<SpriteScene>(SimdLevel::SSE2); });
+    registry.Register("sprites-avx2", "200k instanced sprites updated with the AVX2 kernels",
+                      [] { return std::make_unique<SpriteScene>(SimdLevel::AVX2); });
+    registry.Register("draw-calls", "20k individual triangle draws recorded in parallel", [] { return std::make_unique<DrawCallScene>(); });
+    RegisterStreamingScenes(registry);
+    RegisterCullingScenes(registry);
+    RegisterAllocationChurnScenes(registry);
+    RegisterParticleScenes(registry);
+    RegisterGpuHeapScenes(registry);
+}
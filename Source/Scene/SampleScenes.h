@@ -0,0 +1,9 @@
+﻿#pragma once
+
+class SceneRegistry;
+
+// ウィンドウモードで既定に使用するシーン
+constexpr const char* DEFAULT_SCENE_NAME = "sprites";
+
+// 三角形/インスタンス描画/描画コール数/ストリーミングのサンプルシーンを登録する
+void RegisterSampleScenes(SceneRegistry& registry);
@@ -0,0 +1,22 @@
+﻿#include "SceneRegistry.h"
+#include <stdexcept>
+
+void SceneRegistry::Register(std::string name, std::string description, SceneFactory factory)
+{
+    for (const SceneEntry& entry : entries) {
+        if (entry.name == name) {
+            throw std::runtime_error("Scene already registered: " + name);
+        }
+    }
+    entries.push_back({ std::move(name), std::move(description), std::move(factory) });
+}
+
+std::unique_ptr<IScene> SceneRegistry::Create(std::string_view name) const
+{
+    for (const SceneEntry& entry : entries) {
+        if (entry.name == name) {
+            return entry.factory();
+        }
+    }
+    return nullptr;
+}
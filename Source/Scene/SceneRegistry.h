@@ -0,0 +1,53 @@
+﻿#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+class FrameRenderer;
+
+// シーン固有の計測値（名前と値。ベンチマークの出力に含める）
+using SceneMetrics = std::vector<std::pair<std::string, double>>;
+
+// 描画内容と毎フレームの更新をまとめたシーン。
+// バックエンドに依存しない FrameRenderer だけを使うため、D3D12 でもヌルバックエンドでも動作する。
+class IScene {
+public:
+    virtual ~IScene() = default;
+
+    // 静的な描画アイテムとインスタンスバッチを renderer に登録する
+    virtual void Initialize(FrameRenderer& renderer) = 0;
+    // シーン固有の毎フレームの更新（FrameRenderer::Update より先に呼び出される）
+    virtual void Update(float deltaTime) { (void)deltaTime; }
+    // 描画スレッドで FrameRenderer::Render の直前に呼び出す（読み込みを終えたリソースの登録など）
+    virtual void PrepareRender(FrameRenderer& renderer) { (void)renderer; }
+    // ベンチマークの終了時に呼び出す
+    virtual void GetMetrics(SceneMetrics& metrics) const { (void)metrics; }
+};
+
+using SceneFactory = std::function<std::unique_ptr<IScene>()>;
+
+struct SceneEntry {
+    std::string name;
+    std::string description;
+    SceneFactory factory;
+};
+
+// 名前でシーンを作成するためのレジストリ（ウィンドウモードと --headless ベンチマークで共用）
+class SceneRegistry {
+public:
+    // 例外: 同じ名前のシーンが登録済みの場合は std::runtime_error を送出
+    void Register(std::string name, std::string description, SceneFactory factory);
+    // 戻り値: 未登録の名前の場合は nullptr
+    std::unique_ptr<IScene> Create(std::string_view name) const;
+
+    const std::vector<SceneEntry>& GetEntries() const { return entries; }
+
+private:
+    std::vector<SceneEntry> entries; // 登録順
+};
+
+inline SceneRegistry& GetSceneRegistry() { static SceneRegistry registry; return registry; }
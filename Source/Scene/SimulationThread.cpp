@@ -0,0 +1,98 @@
+﻿#include "SimulationThread.h"
+#include "../Core/AllocationTracker.h"
+#include "../Core/Profiler.h"
+#include "../Render/FrameRenderer.h"
+#include "SceneRegistry.h"
+#include <chrono>
+#include <utility>
+
+SimulationThread::~SimulationThread()
+{
+    Stop();
+}
+
+// 時計の現在時刻を時刻 0 の状態として公開し、最初のフレームから描画できるようにする。
+// 引数:
+//  - scene: 固有の更新を行うシーン（nullptr の場合はインスタンスのみ更新）
+//  - renderer: インスタンスの更新とスナップショットの公開先
+//  - clock: 時刻の取得に使う時計（Start した場合は専用スレッドからも呼び出される）
+//  - stepNs: 1 ステップの長さ
+void SimulationThread::Initialize(IScene* scene, FrameRenderer* renderer, SimulationClock clock, uint64_t stepNs)
+{
+    Stop();
+    this->scene = scene;
+    this->renderer = renderer;
+    this->clock = std::move(clock);
+    timestep.Initialize(stepNs, MAX_STEPS_PER_ADVANCE);
+    timestep.Reset(this->clock());
+    stepCount.store(0, std::memory_order_relaxed);
+    renderer->PublishSnapshot(timestep.GetStateTimeNs());
+}
+
+// 複数ステップを実行した場合も公開は最後の 1 回だけ行う（描画側は前回公開した状態との間を補間する）
+uint32_t SimulationThread::Advance()
+{
+    const uint32_t steps = timestep.Advance(clock());
+    if (steps == 0) {
+        return 0;
+    }
+    PROFILE_SCOPE("Simulate");
+    const float deltaTime = timestep.GetStepSeconds();
+    for (uint32_t i = 0; i < steps; ++i) {
+        if (scene) {
+            AllocationTagScope tagScope(AllocationTag::Scene);
+            scene->Update(deltaTime);
+        }
+        renderer->Update(deltaTime);
+    }
+    renderer->PublishSnapshot(timestep.GetStateTimeNs());
+    stepCount.fetch_add(steps, std::memory_order_relaxed);
+    return steps;
+}
+
+void SimulationThread::Start()
+{
+    if (thread.joinable()) {
+        return;
+    }
+    stopRequested = false;
+    thread = std::thread(&SimulationThread::ThreadMain, this);
+}
+
+void SimulationThread::Stop()
+{
+    if (!thread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(stopMutex);
+        stopRequested = true;
+    }
+    stopCondition.notify_all();
+    thread.join();
+}
+
+uint64_t SimulationThread::GetRenderTimeNs() const
+{
+    const uint64_t now = clock();
+    const uint64_t stepNs = timestep.GetStepNs();
+    return now > stepNs ? now - stepNs : 0;
+}
+
+// 次のステップの時刻まで待機し、Stop が呼ばれたらすぐに抜ける。
+// OS のスリープの精度で起床が遅れても、遅れた分は次の Advance でまとめて実行される。
+void SimulationThread::ThreadMain()
+{
+    GetProfiler().SetThreadName("Simulation");
+    std::unique_lock<std::mutex> lock(stopMutex);
+    while (!stopRequested) {
+        lock.unlock();
+        Advance();
+        const uint64_t now = clock();
+        const uint64_t next = timestep.GetNextStepTimeNs();
+        lock.lock();
+        if (next > now) {
+            stopCondition.wait_for(lock, std::chrono::nanoseconds(next - now), [this]() { return stopRequested; });
+        }
+    }
+}
@@ -0,0 +1,59 @@
+﻿#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "../Core/FixedTimestep.h"
+
+class FrameRenderer;
+class IScene;
+
+// 現在時刻（ナノ秒）を返す時計。テストやベンチマークでは模擬クロックに差し替える。
+using SimulationClock = std::function<uint64_t()>;
+
+// シーンとインスタンスを固定刻みで更新し、ステップごとの状態を FrameRenderer のスナップショットとして公開する。
+// Start すると専用スレッドで実行し、描画ループのフレームレートとは独立に進む。
+// Start せずに Advance を呼び出せば、呼び出し元のスレッドで同じ処理を決定的に実行できる。
+class SimulationThread {
+public:
+    // 1 ステップの長さ（60Hz）
+    static constexpr uint64_t DEFAULT_STEP_NS = 1000000000ull / 60;
+    // 処理が追いつかないときに 1 回の Advance で実行するステップ数の上限
+    static constexpr uint32_t MAX_STEPS_PER_ADVANCE = 8;
+
+    ~SimulationThread();
+
+    // scene/renderer: 更新対象（所有しない。シーンの Initialize は済ませておく）
+    // clock: 時刻の取得に使う時計
+    void Initialize(IScene* scene, FrameRenderer* renderer, SimulationClock clock, uint64_t stepNs = DEFAULT_STEP_NS);
+
+    // clock の現在時刻までに溜まったステップを実行し、1 回でも進めば状態を公開する。
+    // 戻り値: 実行したステップ数
+    uint32_t Advance();
+
+    // 専用スレッドで Advance を繰り返す／停止して終了を待つ
+    void Start();
+    void Stop();
+    bool IsRunning() const { return thread.joinable(); }
+
+    // 描画に使う時刻。1 ステップ遅らせ、常に公開済みの 2 状態の間を補間できるようにする
+    uint64_t GetRenderTimeNs() const;
+    uint64_t GetStepCount() const { return stepCount.load(std::memory_order_relaxed); }
+
+private:
+    void ThreadMain();
+
+    IScene* scene = nullptr;
+    FrameRenderer* renderer = nullptr;
+    SimulationClock clock;
+    FixedTimestep timestep;
+    std::atomic<uint64_t> stepCount{ 0 };
+
+    std::thread thread;
+    std::mutex stopMutex;
+    std::condition_variable stopCondition;
+    bool stopRequested = false;
+};
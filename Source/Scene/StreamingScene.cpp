@@ -0,0 +1,139 @@
+﻿#include "StreamingScene.h"
+#include "SceneRegistry.h"
+#include "../Asset/AssetContainer.h"
+#include "../Asset/AssetStreamer.h"
+#include "../Core/JobSystem.h"
+#include "../Core/Profiler.h"
+#include "../Render/BuiltinPipelineStates.h"
+#include "../Render/FrameRenderer.h"
+#include <cmath>
+#include <memory>
+#include <string>
+
+namespace {
+
+// 画面を STREAMING_GRID_SIZE x STREAMING_GRID_SIZE に分け、各セルに 1 つのメッシュを置く
+constexpr uint32_t STREAMING_GRID_SIZE = 16;
+constexpr uint32_t STREAMING_MESH_COUNT = STREAMING_GRID_SIZE * STREAMING_GRID_SIZE;
+// 1 メッシュの三角形数（6144 頂点 x 20 バイト = 約 120KB）
+constexpr uint32_t TRIANGLES_PER_STREAMING_MESH = 2048;
+// 読み込み中 + アップロード待ちのメッシュに使えるメモリ
+constexpr uint64_t STREAMING_MEMORY_BUDGET = 512ull * 1024;
+constexpr const char* STREAMING_CONTAINER_FILE_NAME = "StreamingScene.assets";
+
+std::string GetStreamingMeshName(uint32_t index)
+{
+    return "mesh" + std::to_string(index);
+}
+
+float GetCellCenter(uint32_t cell)
+{
+    return (static_cast<float>(cell) + 0.5f) / STREAMING_GRID_SIZE * 2.0f - 1.0f;
+}
+
+// セルごとに色の異なる円盤（三角形リストの扇形）を並べたコンテナを書き出す
+void WriteStreamingContainer(const std::filesystem::path& path)
+{
+    AssetContainerWriter writer;
+    std::vector<ColorVertex> vertices(TRIANGLES_PER_STREAMING_MESH * 3);
+    const float radius = 0.8f / STREAMING_GRID_SIZE;
+    for (uint32_t mesh = 0; mesh < STREAMING_MESH_COUNT; ++mesh) {
+        const float centerX = GetCellCenter(mesh % STREAMING_GRID_SIZE);
+        const float centerY = GetCellCenter(mesh / STREAMING_GRID_SIZE);
+        const float r = static_cast<float>(mesh % STREAMING_GRID_SIZE) / STREAMING_GRID_SIZE;
+        const float g = static_cast<float>(mesh / STREAMING_GRID_SIZE) / STREAMING_GRID_SIZE;
+        for (uint32_t i = 0; i < TRIANGLES_PER_STREAMING_MESH; ++i) {
+            const float angle0 = 6.2831853f * i / TRIANGLES_PER_STREAMING_MESH;
+            const float angle1 = 6.2831853f * (i + 1) / TRIANGLES_PER_STREAMING_MESH;
+            vertices[i * 3 + 0] = { centerX, centerY, r, g, 1.0f };
+            vertices[i * 3 + 1] = { centerX + radius * std::cos(angle1), centerY + radius * std::sin(angle1), r, g, 0.5f };
+            vertices[i * 3 + 2] = { centerX + radius * std::cos(angle0), centerY + radius * std::sin(angle0), r, g, 0.5f };
+        }
+        writer.AddVertexBuffer(GetStreamingMeshName(mesh), vertices.data(), vertices.size() * sizeof(ColorVertex), ColorVertexStream::STRIDE);
+    }
+    writer.Write(path);
+}
+
+// 一時ディレクトリに書き出したコンテナからメッシュを画面中央に近い順に読み込み、
+// 読み込めたものから描画に加える。マップしたペイロードはそのまま CreateStaticBuffer に渡し、
+// アップロード後は Release して次の読み込みに予算を空ける。
+// 計測値: 読み込み量と速度、最初の描画までの時間、全メッシュの読み込みまでの時間。
+class StreamingScene : public IScene {
+public:
+    void Initialize(FrameRenderer& renderer) override
+    {
+        (void)renderer;
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / STREAMING_CONTAINER_FILE_NAME;
+        WriteStreamingContainer(path);
+
+        startNs = Profiler::Now();
+        container.Open(path);
+        streamer.Initialize(&GetJobSystem(), STREAMING_MEMORY_BUDGET);
+        for (uint32_t mesh = 0; mesh < STREAMING_MESH_COUNT; ++mesh) {
+            const uint32_t entry = container.Find(GetStreamingMeshName(mesh));
+            const float x = GetCellCenter(mesh % STREAMING_GRID_SIZE);
+            const float y = GetCellCenter(mesh / STREAMING_GRID_SIZE);
+            streamer.Request(container, entry, std::sqrt(x * x + y * y));
+        }
+    }
+
+    void PrepareRender(FrameRenderer& renderer) override
+    {
+        streamer.Update();
+        IRenderBackend& backend = renderer.GetBackend();
+        for (const AssetStreamResult& result : streamer.GetCompleted()) {
+            const AssetEntry& entry = container.GetEntry(result.entry);
+            DrawItem draw;
+            draw.pipeline = backend.GetBuiltinPipeline(BuiltinPipeline::VertexColor);
+            draw.topology = PrimitiveTopology::TriangleList;
+            draw.vertexBuffer.gpuAddress = backend.CreateStaticBuffer(result.data, result.size);
+            draw.vertexBuffer.strideInBytes = entry.stride;
+            draw.vertexBuffer.sizeInBytes = static_cast<uint32_t>(result.size);
+            draw.vertexCount = entry.elementCount;
+            draw.instanceCount = 1;
+            renderer.AddStaticDraw(draw);
+            streamer.Release(result.id);
+
+            totalLatencyNs += result.latencyNs;
+            ++loadedCount;
+            if (firstDrawNs == 0) {
+                firstDrawNs = Profiler::Now();
+            }
+            if (loadedCount == STREAMING_MESH_COUNT) {
+                allLoadedNs = Profiler::Now();
+            }
+        }
+    }
+
+    void GetMetrics(SceneMetrics& metrics) const override
+    {
+        const AssetStreamerStats& stats = streamer.GetStats();
+        const double streamedMB = static_cast<double>(stats.streamedBytes) / (1024.0 * 1024.0);
+        const double allLoadedMs = allLoadedNs != 0 ? static_cast<double>(allLoadedNs - startNs) / 1e6 : 0.0;
+        metrics.emplace_back("meshesLoaded", static_cast<double>(loadedCount));
+        metrics.emplace_back("streamedMB", streamedMB);
+        metrics.emplace_back("throughputMBps", allLoadedMs > 0.0 ? streamedMB / (allLoadedMs / 1000.0) : 0.0);
+        metrics.emplace_back("timeToFirstDrawMs", firstDrawNs != 0 ? static_cast<double>(firstDrawNs - startNs) / 1e6 : 0.0);
+        metrics.emplace_back("timeToAllLoadedMs", allLoadedMs);
+        metrics.emplace_back("averageLatencyMs", loadedCount != 0 ? static_cast<double>(totalLatencyNs) / loadedCount / 1e6 : 0.0);
+        metrics.emplace_back("peakResidentMB", static_cast<double>(stats.peakResidentBytes) / (1024.0 * 1024.0));
+        metrics.emplace_back("budgetStalls", static_cast<double>(stats.budgetStalls));
+    }
+
+private:
+    AssetContainer container; // streamer より先に破棄しないよう先に宣言する
+    AssetStreamer streamer;
+    uint64_t startNs = 0;
+    uint64_t firstDrawNs = 0;
+    uint64_t allLoadedNs = 0;
+    uint64_t totalLatencyNs = 0;
+    uint32_t loadedCount = 0;
+};
+
+} // namespace
+
+void RegisterStreamingScenes(SceneRegistry& registry)
+{
+    registry.Register("streaming", "256 meshes streamed from a memory-mapped asset container under a 512KB budget",
+                      [] { return std::make_unique<StreamingScene>(); });
+}
@@ -0,0 +1,6 @@
+﻿#pragma once
+
+class SceneRegistry;
+
+// アセットコンテナからメッシュを非同期に読み込むストリーミングのシーンを登録する
+void RegisterStreamingScenes(SceneRegistry& registry);
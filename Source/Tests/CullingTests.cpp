@@ -0,0 +1,309 @@
+﻿#include "TestCheck.h"
+#include "Core/JobSystem.h"
+#include "Scene/CullingKernels.h"
+#include "Scene/CullingSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// 視錐台カリングの SSE2/AVX2 カーネルと CullingSystem の階層（内側のノードを判定せずに受け入れる近道、Refit/Rebuild 後を含む）が、
+// テスト側で直接判定した結果と同じ物体を残すことを検証する
+
+namespace {
+
+const SimdLevel SIMD_LEVELS[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2 };
+const CullingShape SHAPES[] = { CullingShape::Sphere, CullingShape::Aabb };
+
+// CullingSystem::Build と同じく、境界球の半径は extent の長さ
+struct BoundsData {
+    std::vector<float> centerX, centerY, centerZ, radius, extentX, extentY, extentZ;
+
+    explicit BoundsData(const std::vector<CullingObjectDesc>& objects)
+    {
+        for (const CullingObjectDesc& object : objects) {
+            centerX.push_back(object.centerX);
+            centerY.push_back(object.centerY);
+            centerZ.push_back(object.centerZ);
+            radius.push_back(std::sqrt(object.extentX * object.extentX + object.extentY * object.extentY + object.extentZ * object.extentZ));
+            extentX.push_back(object.extentX);
+            extentY.push_back(object.extentY);
+            extentZ.push_back(object.extentZ);
+        }
+    }
+
+    BoundsStreams GetStreams()
+    {
+        return { centerX.data(), centerY.data(), centerZ.data(), radius.data(), extentX.data(), extentY.data(), extentZ.data() };
+    }
+};
+
+// カーネルの仕様どおりの判定（すべての平面で 距離 >= -半径）
+bool IsVisible(const BoundsStreams& bounds, uint32_t i, const Frustum& frustum, CullingShape shape)
+{
+    for (const Plane& plane : frustum.planes) {
+        const float distance = plane.nx * bounds.centerX[i] + plane.ny * bounds.centerY[i] + plane.nz * bounds.centerZ[i] + plane.d;
+        const float radius = shape == CullingShape::Sphere
+            ? bounds.radius[i]
+            : std::fabs(plane.nx) * bounds.extentX[i] + std::fabs(plane.ny) * bounds.extentY[i] + std::fabs(plane.nz) * bounds.extentZ[i];
+        if (distance < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<uint32_t> CullReference(const BoundsStreams& bounds, uint32_t begin, uint32_t end, const Frustum& frustum, CullingShape shape)
+{
+    std::vector<uint32_t> visible;
+    for (uint32_t i = begin; i < end; ++i) {
+        if (IsVisible(bounds, i, frustum, shape)) {
+            visible.push_back(i);
+        }
+    }
+    return visible;
+}
+
+std::vector<uint32_t> CullWithKernel(const CullingKernelTable& kernels, const BoundsStreams& bounds, uint32_t begin, uint32_t end, const Frustum& frustum,
+                                     CullingShape shape)
+{
+    // 出力には end - begin 個分の領域が必要（番兵を 1 つ置いて範囲外への書き込みを確かめる）
+    std::vector<uint32_t> output(end - begin + 1, UINT32_MAX);
+    const FrustumCullKernel kernel = shape == CullingShape::Sphere ? kernels.cullSpheres : kernels.cullAabbs;
+    const uint32_t count = kernel(bounds, begin, end, frustum, output.data());
+    CHECK(output.back() == UINT32_MAX);
+    output.resize(count);
+    return output;
+}
+
+// x ∈ [-8, 8]、y ∈ [-4, 4]、z ∈ [0, 16] の正射影（平面の係数が 2 のべき乗で正確に表せる）
+Frustum MakeBoxFrustum()
+{
+    float viewProjection[16];
+    MakeOrthographicViewProjection(-8.0f, 8.0f, -4.0f, 4.0f, 0.0f, 16.0f, viewProjection);
+    return ExtractFrustum(viewProjection);
+}
+
+// (1, 2, -5) から +z を見る透視投影（左右上下の平面が軸に対して傾く）
+Frustum MakePerspectiveFrustum()
+{
+    const float nearZ = 0.5f;
+    const float farZ = 60.0f;
+    const float xScale = 1.2f;
+    const float yScale = 1.8f;
+    const float q = farZ / (farZ - nearZ);
+    const float projection[16] = {
+        xScale, 0.0f, 0.0f, 0.0f,
+        0.0f, yScale, 0.0f, 0.0f,
+        0.0f, 0.0f, q, 1.0f,
+        0.0f, 0.0f, -nearZ * q, 0.0f,
+    };
+    // 行ベクトル規約: clip = (position - eye) * projection
+    const float eye[3] = { 1.0f, 2.0f, -5.0f };
+    float viewProjection[16];
+    std::copy(projection, projection + 16, viewProjection);
+    for (int column = 0; column < 4; ++column) {
+        viewProjection[12 + column] = projection[12 + column] - eye[0] * projection[column] - eye[1] * projection[4 + column] - eye[2] * projection[8 + column];
+    }
+    return ExtractFrustum(viewProjection);
+}
+
+std::vector<CullingObjectDesc> MakeRandomObjects(uint32_t count, uint32_t seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> position(-30.0f, 30.0f);
+    std::uniform_real_distribution<float> depth(-10.0f, 70.0f);
+    std::uniform_real_distribution<float> extent(0.05f, 1.5f);
+    std::vector<CullingObjectDesc> objects(count);
+    for (CullingObjectDesc& object : objects) {
+        object = { position(random), position(random) * 0.5f, depth(random), extent(random), extent(random), extent(random) };
+    }
+    return objects;
+}
+
+// 平面にちょうど接する物体と、わずかに外れた物体（すべて 2 のべき乗の和で正確に表せる値）
+std::vector<CullingObjectDesc> MakeEdgeObjects()
+{
+    return {
+        { -9.0f, 0.0f, 8.0f, 1.0f, 0.0f, 0.0f },      // 左の平面に外側から接する
+        { -9.0009765625f, 0.0f, 8.0f, 1.0f, 0.0f, 0.0f }, // 左の平面からわずかに外
+        { 9.0f, 0.0f, 8.0f, 1.0f, 0.0f, 0.0f },       // 右
+        { 9.0009765625f, 0.0f, 8.0f, 1.0f, 0.0f, 0.0f },
+        { 0.0f, -4.5f, 8.0f, 0.0f, 0.5f, 0.0f },      // 下
+        { 0.0f, 4.5f, 8.0f, 0.0f, 0.5f, 0.0f },       // 上
+        { 0.0f, 4.5009765625f, 8.0f, 0.0f, 0.5f, 0.0f },
+        { 0.0f, 0.0f, -2.0f, 0.0f, 0.0f, 2.0f },      // 手前
+        { 0.0f, 0.0f, -2.0009765625f, 0.0f, 0.0f, 2.0f },
+        { 0.0f, 0.0f, 18.0f, 0.0f, 0.0f, 2.0f },      // 奥
+        { 0.0f, 0.0f, 18.0009765625f, 0.0f, 0.0f, 2.0f },
+        { 8.0f, 4.0f, 16.0f, 0.0f, 0.0f, 0.0f },      // 大きさ 0 で角の上
+        { 0.0f, 0.0f, 8.0f, 0.0f, 0.0f, 0.0f },       // 中央
+    };
+}
+
+void CheckKernels(const char* label, BoundsData& data, const Frustum& frustum)
+{
+    const BoundsStreams bounds = data.GetStreams();
+    const uint32_t count = static_cast<uint32_t>(data.centerX.size());
+    for (const SimdLevel level : SIMD_LEVELS) {
+        const CullingKernelTable& kernels = GetCullingKernels(level);
+        if (kernels.level != level) {
+            continue;
+        }
+        for (const CullingShape shape : SHAPES) {
+            // 範囲の先頭と長さをベクトル幅にそろえない組み合わせも含める
+            for (const uint32_t begin : { 0u, 1u, 3u, 5u }) {
+                for (const uint32_t length : { 0u, 1u, 3u, 4u, 5u, 7u, 8u, 9u, 15u, 16u, 17u, 31u, count }) {
+                    const uint32_t end = (std::min)(begin + length, count);
+                    if (begin > end) {
+                        continue;
+                    }
+                    const bool same = CullWithKernel(kernels, bounds, begin, end, frustum, shape) == CullReference(bounds, begin, end, frustum, shape);
+                    if (!same) {
+                        std::fprintf(stderr, "%s: %s %s kernel differs on [%u, %u)\n", label, GetSimdLevelName(level),
+                                     shape == CullingShape::Sphere ? "sphere" : "aabb", begin, end);
+                    }
+                    CHECK(same);
+                }
+            }
+        }
+    }
+}
+
+void TestKernels()
+{
+    const Frustum box = MakeBoxFrustum();
+    CHECK(box.planes[FRUSTUM_LEFT].nx == 1.0f && box.planes[FRUSTUM_LEFT].d == 8.0f);
+    CHECK(box.planes[FRUSTUM_FAR].nz == -1.0f && box.planes[FRUSTUM_FAR].d == 16.0f);
+
+    // 平面上の物体は接していれば残り、わずかでも外れていれば除く
+    BoundsData edges(MakeEdgeObjects());
+    for (const CullingShape shape : SHAPES) {
+        const std::vector<uint32_t> expected = { 0, 2, 4, 5, 7, 9, 11, 12 };
+        CHECK(CullReference(edges.GetStreams(), 0, static_cast<uint32_t>(edges.centerX.size()), box, shape) == expected);
+    }
+    CheckKernels("edges", edges, box);
+
+    // 4/8 の倍数でない個数の乱数の物体
+    BoundsData random(MakeRandomObjects(4099, 1357));
+    CheckKernels("random box", random, box);
+    CheckKernels("random perspective", random, MakePerspectiveFrustum());
+
+    // すべて内側 / すべて外側
+    std::vector<CullingObjectDesc> inside(37, CullingObjectDesc{ 0.5f, -0.5f, 8.0f, 0.25f, 0.25f, 0.25f });
+    BoundsData insideData(inside);
+    CHECK(CullReference(insideData.GetStreams(), 0, 37, box, CullingShape::Aabb).size() == 37);
+    CheckKernels("inside", insideData, box);
+    std::vector<CullingObjectDesc> outside(37, CullingObjectDesc{ 100.0f, 0.0f, 8.0f, 0.25f, 0.25f, 0.25f });
+    BoundsData outsideData(outside);
+    CHECK(CullReference(outsideData.GetStreams(), 0, 37, box, CullingShape::Aabb).empty());
+    CheckKernels("outside", outsideData, box);
+}
+
+// CullingSystem の結果（スロット）を、GetBounds の同じ値をテスト側で判定した結果と比べる
+void CheckSystem(const char* label, CullingSystem& culling, const Frustum& frustum, uint32_t& acceptedObjects)
+{
+    const BoundsStreams& bounds = culling.GetBounds();
+    std::vector<uint32_t> visibleSlots;
+    for (const CullingShape shape : SHAPES) {
+        const std::vector<uint32_t> expected = CullReference(bounds, 0, culling.GetObjectCount(), frustum, shape);
+        for (const CullingMethod method : { CullingMethod::Hierarchy, CullingMethod::BruteForce }) {
+            culling.Cull(frustum, shape, method, visibleSlots);
+            const bool same = visibleSlots == expected;
+            if (!same) {
+                std::fprintf(stderr, "%s: %s %s %s: %zu visible, expected %zu\n", label, GetSimdLevelName(culling.GetSimdLevel()),
+                             shape == CullingShape::Sphere ? "sphere" : "aabb", method == CullingMethod::Hierarchy ? "hierarchy" : "brute force",
+                             visibleSlots.size(), expected.size());
+            }
+            CHECK(same);
+            CHECK(culling.GetStats().visibleCount == expected.size());
+            if (method == CullingMethod::Hierarchy) {
+                acceptedObjects += culling.GetStats().acceptedObjects;
+            }
+        }
+    }
+}
+
+void TestSystem(JobSystem& jobs)
+{
+    const std::vector<CullingObjectDesc> objects = MakeRandomObjects(20011, 2468);
+    const Frustum frustums[] = { MakeBoxFrustum(), MakePerspectiveFrustum() };
+    for (const SimdLevel level : SIMD_LEVELS) {
+        CullingSystem culling;
+        culling.Initialize(&jobs, level);
+        if (culling.GetSimdLevel() != level) {
+            continue;
+        }
+        culling.Build(objects);
+        CHECK(culling.GetObjectCount() == objects.size());
+
+        // 内側のノードを判定せずに受け入れる近道を実際に通っていること
+        uint32_t acceptedObjects = 0;
+        for (const Frustum& frustum : frustums) {
+            CheckSystem("build", culling, frustum, acceptedObjects);
+        }
+        CHECK(acceptedObjects > 0);
+
+        // 物体を動かして Refit した後（階層の構造は古いまま）
+        std::mt19937 random(97);
+        std::uniform_real_distribution<float> move(-6.0f, 6.0f);
+        const BoundsStreams& bounds = culling.GetBounds();
+        for (uint32_t slot = 0; slot < culling.GetObjectCount(); ++slot) {
+            bounds.centerX[slot] += move(random);
+            bounds.centerY[slot] += move(random);
+            bounds.centerZ[slot] += move(random);
+        }
+        culling.Refit();
+        CHECK(culling.GetDegradation() > 1.0f);
+        for (const Frustum& frustum : frustums) {
+            CheckSystem("refit", culling, frustum, acceptedObjects);
+        }
+
+        // Rebuild で並べ替えても同じ物体が残る
+        std::vector<uint32_t> before;
+        std::vector<uint32_t> visibleSlots;
+        culling.Cull(frustums[1], CullingShape::Aabb, CullingMethod::Hierarchy, visibleSlots);
+        for (const uint32_t slot : visibleSlots) {
+            before.push_back(culling.GetObjectId(slot));
+        }
+        culling.Rebuild();
+        for (const Frustum& frustum : frustums) {
+            CheckSystem("rebuild", culling, frustum, acceptedObjects);
+        }
+        std::vector<uint32_t> after;
+        culling.Cull(frustums[1], CullingShape::Aabb, CullingMethod::Hierarchy, visibleSlots);
+        for (const uint32_t slot : visibleSlots) {
+            after.push_back(culling.GetObjectId(slot));
+        }
+        std::sort(before.begin(), before.end());
+        std::sort(after.begin(), after.end());
+        CHECK(before == after);
+
+        // すべて内側なら根で受け入れて 1 つも判定しない / すべて外側なら何も残らない
+        float everything[16];
+        MakeOrthographicViewProjection(-1000.0f, 1000.0f, -1000.0f, 1000.0f, -1000.0f, 1000.0f, everything);
+        culling.Cull(ExtractFrustum(everything), CullingShape::Sphere, CullingMethod::Hierarchy, visibleSlots);
+        CHECK(visibleSlots.size() == objects.size());
+        CHECK(culling.GetStats().testedObjects == 0);
+        CHECK(culling.GetStats().acceptedObjects == objects.size());
+        float nothing[16];
+        MakeOrthographicViewProjection(500.0f, 600.0f, 500.0f, 600.0f, 0.0f, 10.0f, nothing);
+        culling.Cull(ExtractFrustum(nothing), CullingShape::Aabb, CullingMethod::Hierarchy, visibleSlots);
+        CHECK(visibleSlots.empty());
+        culling.Cull(ExtractFrustum(nothing), CullingShape::Aabb, CullingMethod::BruteForce, visibleSlots);
+        CHECK(visibleSlots.empty());
+    }
+}
+
+} // namespace
+
+int main()
+{
+    TestKernels();
+    JobSystem jobs;
+    jobs.Initialize(3);
+    TestSystem(jobs);
+    jobs.Shutdown();
+    return FinishTests();
+}
@@ -0,0 +1,144 @@
+﻿#include "TestCheck.h"
+#include "Render/DescriptorAllocator.h"
+#include <stdexcept>
+#include <vector>
+
+// DescriptorFreeList の払い出し順と再利用、二重解放の検出、DescriptorRing のフェンス値ごとの再利用、
+// DescriptorCopyBatch による隣接コピーのまとめを検証する
+
+namespace {
+
+template <typename Function>
+bool Throws(Function function)
+{
+    try {
+        function();
+    }
+    catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+void TestFreeList()
+{
+    DescriptorFreeList freeList;
+    freeList.Initialize(4);
+    const DescriptorHeapStats& stats = freeList.GetStats();
+    CHECK(stats.capacity == 4);
+
+    // 小さいインデックスから払い出す
+    for (uint32_t i = 0; i < 4; ++i) {
+        CHECK(freeList.Allocate() == i);
+    }
+    CHECK(freeList.Allocate() == INVALID_DESCRIPTOR_INDEX);
+    CHECK(stats.used == 4 && stats.peakUsed == 4);
+    CHECK(stats.allocationCount == 4 && stats.failedAllocationCount == 1);
+
+    // 解放したものは最後に解放したものから再利用する（スタック）
+    freeList.Free(1);
+    freeList.Free(3);
+    CHECK(stats.used == 2);
+    CHECK(freeList.Allocate() == 3);
+    CHECK(freeList.Allocate() == 1);
+    CHECK(freeList.Allocate() == INVALID_DESCRIPTOR_INDEX);
+
+    // 二重解放と範囲外は払い出し状態を壊さずに例外にする
+    freeList.Free(2);
+    CHECK(Throws([&] { freeList.Free(2); }));
+    CHECK(Throws([&] { freeList.Free(4); }));
+    CHECK(Throws([&] { freeList.Free(INVALID_DESCRIPTOR_INDEX); }));
+    CHECK(stats.used == 3);
+    CHECK(freeList.Allocate() == 2);
+    CHECK(freeList.Allocate() == INVALID_DESCRIPTOR_INDEX);
+
+    // 確保と解放を繰り返すと、直前に解放したものを払い出し続ける
+    for (uint32_t i = 0; i < 4; ++i) {
+        freeList.Free(i);
+    }
+    bool reused = true;
+    for (uint32_t round = 0; round < 1000; ++round) {
+        const uint32_t index = freeList.Allocate();
+        reused = reused && index == 3;
+        freeList.Free(index);
+    }
+    CHECK(reused);
+    CHECK(stats.used == 0 && stats.peakUsed == 4);
+}
+
+void TestRing()
+{
+    DescriptorRing ring;
+    ring.Initialize(16);
+    const DescriptorHeapStats& stats = ring.GetStats();
+
+    // フレーム 1: 6 + 4、フレーム 2: 5
+    CHECK(ring.Allocate(6) == 0);
+    CHECK(ring.Allocate(4) == 6);
+    ring.FinishFrame(1);
+    CHECK(ring.Allocate(5) == 10);
+    ring.FinishFrame(2);
+    CHECK(stats.used == 15 && stats.peakUsed == 15);
+
+    // フレーム 1 が完了するまでは折り返せない
+    CHECK(ring.Allocate(3) == INVALID_DESCRIPTOR_INDEX);
+    CHECK(stats.failedAllocationCount == 1);
+    ring.Retire(0);
+    CHECK(ring.Allocate(3) == INVALID_DESCRIPTOR_INDEX);
+
+    // フレーム 1 の完了で先頭の 10 個が空き、末尾の 1 個を捨てて折り返す
+    ring.Retire(1);
+    CHECK(stats.used == 5);
+    CHECK(ring.Allocate(3) == 0);
+    CHECK(stats.used == 5 + 1 + 3);
+    ring.FinishFrame(3);
+
+    // フレーム 2 の完了では、フレーム 3 の領域は残る
+    ring.Retire(2);
+    CHECK(stats.used == 1 + 3);
+    ring.Retire(3);
+    CHECK(stats.used == 0);
+    CHECK(stats.allocationCount == 4 && stats.peakUsed == 15);
+}
+
+void TestCopyBatch()
+{
+    constexpr uint64_t STRIDE = 32;
+    constexpr uint64_t TABLE = 0x10000;
+    constexpr uint64_t STAGING = 0x80000;
+    DescriptorCopyBatch batch;
+    batch.Initialize(static_cast<uint32_t>(STRIDE));
+
+    // コピー先とコピー元の両方が連続する 3 個は 1 範囲になる
+    for (uint64_t slot = 0; slot < 3; ++slot) {
+        batch.Add(TABLE + slot * STRIDE, STAGING + (5 + slot) * STRIDE);
+    }
+    CHECK(batch.GetRanges().size() == 1);
+    CHECK(batch.GetRanges()[0].dest == TABLE && batch.GetRanges()[0].source == STAGING + 5 * STRIDE && batch.GetRanges()[0].count == 3);
+
+    // コピー元だけが連続しない場合とコピー先だけが連続しない場合は新しい範囲になる
+    batch.Add(TABLE + 3 * STRIDE, STAGING + 20 * STRIDE);
+    batch.Add(TABLE + 5 * STRIDE, STAGING + 21 * STRIDE);
+    // 続きは直前の範囲に連なる
+    batch.Add(TABLE + 6 * STRIDE, STAGING + 22 * STRIDE);
+    const std::vector<DescriptorCopyRange>& ranges = batch.GetRanges();
+    CHECK(ranges.size() == 3);
+    CHECK(ranges.size() == 3 && ranges[1].count == 1 && ranges[2].dest == TABLE + 5 * STRIDE && ranges[2].count == 2);
+    CHECK(batch.GetCopyCount() == 6);
+
+    batch.Clear();
+    CHECK(batch.GetRanges().empty() && batch.GetCopyCount() == 0);
+    // 消去後は直前の範囲に連なっても新しい範囲から始める
+    batch.Add(TABLE + 7 * STRIDE, STAGING + 23 * STRIDE);
+    CHECK(batch.GetRanges().size() == 1 && batch.GetRanges()[0].count == 1);
+}
+
+} // namespace
+
+int main()
+{
+    TestFreeList();
+    TestRing();
+    TestCopyBatch();
+    return FinishTests();
+}
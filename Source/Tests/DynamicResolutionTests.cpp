@@ -0,0 +1,88 @@
+﻿#include "TestCheck.h"
+#include "Render/DynamicResolutionController.h"
+#include <cstdio>
+#include <string>
+
+// 合成した負荷を DynamicResolutionController に再生し、CheckSyntheticReplay の条件（振動しない、落ち着く、
+// 単発の重いフレームに反応しない）を満たすこと、また満たさない制御を CheckSyntheticReplay が検出することを検証する
+
+namespace {
+
+// 戻り値: 条件を満たせば空文字列、満たさなければ理由
+std::string ReplayAndCheck(SyntheticLoad load, uint32_t frameCount, const DynamicResolutionSettings& settings)
+{
+    const ResolutionReplayResult result = ReplayDynamicResolution(GenerateSyntheticLoad(load, frameCount, settings.targetFrameMs), settings, ResolutionReplayModel());
+    std::string failure;
+    CheckSyntheticReplay(load, result, settings, failure);
+    return failure;
+}
+
+void TestSyntheticLoads()
+{
+    for (const double targetFrameMs : { 1000.0 / 60.0, 1000.0 / 120.0, 1000.0 / 30.0 }) {
+        for (const uint32_t frameCount : { 180u, 1000u, 10000u }) {
+            DynamicResolutionSettings settings;
+            settings.targetFrameMs = targetFrameMs;
+            for (uint32_t i = 0; i < static_cast<uint32_t>(SyntheticLoad::Count); ++i) {
+                const SyntheticLoad load = static_cast<SyntheticLoad>(i);
+                const std::string failure = ReplayAndCheck(load, frameCount, settings);
+                if (!failure.empty()) {
+                    std::fprintf(stderr, "%s (%u frames, target %.2f ms): %s\n", GetSyntheticLoadName(load), frameCount, targetFrameMs, failure.c_str());
+                }
+                CHECK(failure.empty());
+            }
+        }
+    }
+}
+
+void TestScaleRange()
+{
+    DynamicResolutionSettings settings;
+    DynamicResolutionController controller;
+    controller.Initialize(settings);
+    CHECK(controller.GetScale() == settings.maxScale);
+    for (uint32_t i = 0; i < 1000; ++i) {
+        controller.AddFrame(settings.targetFrameMs * 10.0);
+    }
+    CHECK(controller.GetScale() == settings.minScale);
+    uint32_t width = 0;
+    uint32_t height = 0;
+    controller.GetScaledSize(1920, 1080, width, height);
+    CHECK(width == 960 && height == 540);
+
+    // 計測値なしは無視する
+    const uint32_t changes = controller.GetChangeCount();
+    for (uint32_t i = 0; i < 1000; ++i) {
+        controller.AddFrame(0.0);
+    }
+    CHECK(controller.GetChangeCount() == changes);
+    controller.Reset();
+    CHECK(controller.GetScale() == settings.maxScale);
+}
+
+// 平滑化と不感帯を外した制御は揺らぎで振動し、落ち着かないので検出される
+void TestCheckRejectsUnstableControl()
+{
+    DynamicResolutionSettings unstable;
+    unstable.smoothing = 1.0;
+    unstable.tolerance = 0.0;
+    unstable.settleFrames = 0;
+    CHECK(!ReplayAndCheck(SyntheticLoad::Noisy, 1000, unstable).empty());
+    CHECK(!ReplayAndCheck(SyntheticLoad::Spikes, 1000, unstable).empty());
+
+    ResolutionReplayResult result;
+    result.frameCount = 100;
+    std::string failure;
+    CHECK(!CheckSyntheticReplay(SyntheticLoad::Noisy, result, DynamicResolutionSettings(), failure));
+    CHECK(!failure.empty());
+}
+
+} // namespace
+
+int main()
+{
+    TestSyntheticLoads();
+    TestScaleRange();
+    TestCheckRejectsUnstableControl();
+    return FinishTests();
+}
@@ -0,0 +1,144 @@
+﻿#include "TestCheck.h"
+#include "Core/FixedTimestep.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+// 模擬クロックで FixedTimestep を進め、ステップ数（刻みのずれが蓄積しないこと）、上限による時間の切り捨て、
+// 公開した 2 状態の間の補間係数を検証する
+
+namespace {
+
+constexpr uint64_t MS = 1000000;
+constexpr uint64_t STEP_NS = 10 * MS;
+constexpr uint32_t MAX_STEPS = 4;
+// 時計の起点（0 以外から始まる時計でも同じに動くこと）
+constexpr uint64_t START_NS = 123456789;
+
+void TestStepCount()
+{
+    FixedTimestep timestep;
+    timestep.Initialize(STEP_NS, MAX_STEPS);
+    timestep.Reset(START_NS);
+    CHECK(timestep.Advance(START_NS) == 0);
+
+    // 1 ステップ分に 1ns 足りない間は進めず、ちょうどで 1 ステップ
+    CHECK(timestep.Advance(START_NS + STEP_NS - 1) == 0);
+    CHECK(timestep.GetAccumulatedNs() == STEP_NS - 1);
+    CHECK(timestep.Advance(START_NS + STEP_NS) == 1);
+    CHECK(timestep.GetAccumulatedNs() == 0);
+    CHECK(timestep.GetStateTimeNs() == START_NS + STEP_NS);
+    CHECK(timestep.GetNextStepTimeNs() == START_NS + 2 * STEP_NS);
+
+    // 時計が戻った場合は経過 0 として扱い、戻る前の時刻から数え直す
+    CHECK(timestep.Advance(START_NS) == 0);
+    CHECK(timestep.Advance(START_NS + 2 * STEP_NS) == 1);
+    CHECK(timestep.GetStepCount() == 2);
+
+    // 不規則な間隔で 10000 回進めても、ステップ数は経過時間 / 刻みに一致し、余りは積算に残る
+    std::mt19937 random(2024);
+    std::uniform_int_distribution<uint64_t> interval(1, 3 * STEP_NS - 1);
+    uint64_t now = START_NS + 2 * STEP_NS;
+    uint64_t steps = timestep.GetStepCount();
+    for (uint32_t frame = 0; frame < 10000; ++frame) {
+        now += interval(random);
+        steps += timestep.Advance(now);
+    }
+    CHECK(timestep.GetDroppedNs() == 0);
+    CHECK(steps == (now - START_NS) / STEP_NS);
+    CHECK(timestep.GetStepCount() == steps);
+    CHECK(timestep.GetAccumulatedNs() == (now - START_NS) % STEP_NS);
+    CHECK(timestep.GetStateTimeNs() == START_NS + steps * STEP_NS);
+
+    // 0 の指定は 1 に丸める
+    FixedTimestep minimal;
+    minimal.Initialize(0, 0);
+    CHECK(minimal.GetStepNs() == 1);
+    CHECK(minimal.Advance(5) == 1);
+    CHECK(minimal.GetDroppedNs() == 4);
+}
+
+// 処理落ちで 1 秒止まっても実行は上限までで、残りは捨てて状態の時刻だけ時計に追いつかせる（spiral of death の防止）
+void TestClamp()
+{
+    FixedTimestep timestep;
+    timestep.Initialize(STEP_NS, MAX_STEPS);
+    timestep.Reset(START_NS);
+    const uint64_t now = START_NS + 1000 * MS + 3 * MS;
+    CHECK(timestep.Advance(now) == MAX_STEPS);
+    CHECK(timestep.GetStepCount() == MAX_STEPS);
+    CHECK(timestep.GetDroppedNs() == (100 - MAX_STEPS) * STEP_NS);
+    CHECK(timestep.GetStateTimeNs() == START_NS + 100 * STEP_NS);
+    CHECK(timestep.GetAccumulatedNs() == 3 * MS);
+
+    // 捨てた分を後から取り戻そうとはしない
+    CHECK(timestep.Advance(now) == 0);
+    CHECK(timestep.Advance(now + 7 * MS) == 1);
+    CHECK(timestep.GetDroppedNs() == (100 - MAX_STEPS) * STEP_NS);
+
+    // 上限ちょうどなら捨てない
+    CHECK(timestep.Advance(now + 7 * MS + MAX_STEPS * STEP_NS) == MAX_STEPS);
+    CHECK(timestep.GetDroppedNs() == (100 - MAX_STEPS) * STEP_NS);
+}
+
+bool Near(float value, float expected)
+{
+    return std::fabs(value - expected) < 1e-5f;
+}
+
+void TestInterpolationAlpha()
+{
+    // 範囲の端と外は丸め、同じ時刻の 2 状態は最新をそのまま使う
+    CHECK(GetInterpolationAlpha(100, 200, 125) == 0.25f);
+    CHECK(GetInterpolationAlpha(100, 200, 100) == 0.0f);
+    CHECK(GetInterpolationAlpha(100, 200, 50) == 0.0f);
+    CHECK(GetInterpolationAlpha(100, 200, 200) == 1.0f);
+    CHECK(GetInterpolationAlpha(100, 200, 300) == 1.0f);
+    CHECK(GetInterpolationAlpha(100, 100, 50) == 1.0f);
+
+    // SimulationThread と同じく、1 回でも進んだら状態の時刻を公開し、描画は 1 ステップ遅らせた時刻で補間する。
+    // 補間係数は常に [0, 1) に収まり、1 ステップだけ進んだ直後は積算の残り / 刻み に一致する。
+    // 次のステップまでは時計が進むにつれて増えていく
+    FixedTimestep timestep;
+    timestep.Initialize(STEP_NS, MAX_STEPS);
+    timestep.Reset(START_NS);
+    uint64_t previousTimeNs = START_NS;
+    uint64_t currentTimeNs = START_NS;
+    std::mt19937 random(77);
+    std::uniform_int_distribution<uint64_t> interval(MS / 2, 25 * MS);
+    uint64_t now = START_NS + STEP_NS;
+    float lastAlpha = -1.0f;
+    bool inRange = true;
+    bool matchesAccumulator = true;
+    bool increasing = true;
+    for (uint32_t frame = 0; frame < 5000; ++frame) {
+        now += interval(random);
+        const uint32_t steps = timestep.Advance(now);
+        if (steps != 0) {
+            previousTimeNs = currentTimeNs;
+            currentTimeNs = timestep.GetStateTimeNs();
+        }
+        const float alpha = GetInterpolationAlpha(previousTimeNs, currentTimeNs, now - STEP_NS);
+        inRange = inRange && alpha >= 0.0f && alpha < 1.0f;
+        if (steps == 1) {
+            matchesAccumulator = matchesAccumulator && Near(alpha, static_cast<float>(timestep.GetAccumulatedNs()) / STEP_NS);
+        }
+        if (steps == 0) {
+            increasing = increasing && alpha > lastAlpha;
+        }
+        lastAlpha = alpha;
+    }
+    CHECK(inRange);
+    CHECK(matchesAccumulator);
+    CHECK(increasing);
+}
+
+} // namespace
+
+int main()
+{
+    TestStepCount();
+    TestClamp();
+    TestInterpolationAlpha();
+    return FinishTests();
+}
@@ -0,0 +1,159 @@
+﻿#include "TestCheck.h"
+#include "Render/FramePacingController.h"
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+// FramePacingController の予測（平均 + 平均絶対偏差）と開始の遅延、記録したトレースの再生と読み書きを検証する
+
+namespace {
+
+constexpr double REFRESH_MS = 1000.0 / 60.0;
+
+bool Near(double value, double expected)
+{
+    return std::fabs(value - expected) < 1e-9;
+}
+
+FramePacingSettings MakeSettings()
+{
+    FramePacingSettings settings;
+    settings.refreshIntervalMs = REFRESH_MS;
+    settings.safetyMarginMs = 1.0;
+    settings.smoothing = 0.1;
+    settings.deviationScale = 2.0;
+    return settings;
+}
+
+void TestPrediction()
+{
+    FramePacingController controller;
+    controller.Initialize(MakeSettings());
+    CHECK(controller.GetFrameStartDelayMs() == 0.0);
+
+    // 最初の計測値は平均そのもの（偏差 0）
+    controller.AddFrame({ 4.0, 6.0 });
+    CHECK(Near(controller.GetPredictedCpuMs(), 4.0));
+    CHECK(Near(controller.GetPredictedGpuMs(), 6.0));
+    CHECK(Near(controller.GetFrameStartDelayMs(), REFRESH_MS - (4.0 + 6.0 + 1.0)));
+
+    // GPU が 2ms 遅れた: 平均 6 + 0.1 × 2 = 6.2、偏差 0.1 × 2 = 0.2、予測 6.2 + 2 × 0.2 = 6.6
+    controller.AddFrame({ 4.0, 8.0 });
+    CHECK(Near(controller.GetPredictedCpuMs(), 4.0));
+    CHECK(Near(controller.GetPredictedGpuMs(), 6.6));
+    CHECK(Near(controller.GetFrameStartDelayMs(), REFRESH_MS - (4.0 + 6.6 + 1.0)));
+
+    // 6 に戻る: 誤差 -0.2、平均 6.18、偏差 0.2 + 0.1 × (0.2 - 0.2) = 0.2、予測 6.58
+    controller.AddFrame({ 4.0, 6.0 });
+    CHECK(Near(controller.GetPredictedGpuMs(), 6.58));
+
+    // 予測が間隔を超える場合は遅らせない
+    controller.AddFrame({ 20.0, 20.0 });
+    CHECK(controller.GetFrameStartDelayMs() == 0.0);
+
+    controller.Reset();
+    CHECK(controller.GetFrameCount() == 0);
+    CHECK(controller.GetFrameStartDelayMs() == 0.0);
+}
+
+// トレースをファイルに書いて読み直し、再生する
+std::vector<FrameTimeSample> RoundTrip(const std::filesystem::path& path, const std::vector<FrameTimeSample>& trace)
+{
+    CHECK(WriteFrameTimeTrace(path, trace));
+    return LoadFrameTimeTrace(path);
+}
+
+void TestConstantTrace(const std::filesystem::path& directory)
+{
+    const std::vector<FrameTimeSample> trace(10, FrameTimeSample{ 3.0, 5.0 });
+    const std::vector<FrameTimeSample> loaded = RoundTrip(directory / "constant.csv", trace);
+    CHECK(loaded.size() == trace.size());
+
+    // 最初のフレームは計測値がないので遅らせず、以降は毎フレーム同じだけ遅らせる
+    const PacingReplayResult result = ReplayFramePacing(loaded, MakeSettings());
+    const double delayMs = REFRESH_MS - (3.0 + 5.0 + 1.0);
+    CHECK(result.frameCount == 10);
+    CHECK(Near(result.maxDelayMs, delayMs));
+    CHECK(Near(result.averageDelayMs, delayMs * 9 / 10));
+    CHECK(result.missedDeadlines == 0);
+    CHECK(result.gpuPredictionErrorMs == 0.0);
+    CHECK(result.gpuUnderpredictions == 0);
+}
+
+// 揺らぎのある GPU 時間では、平均絶対偏差の余裕が実測の大半を上回り、締め切りを落とさない。
+// 余裕なし（deviationScale = 0）では約半数のフレームで実測が予測を上回る
+void TestJitterBound(const std::filesystem::path& directory)
+{
+    std::mt19937 random(97531);
+    std::uniform_real_distribution<double> jitter(-1.0, 1.0);
+    std::vector<FrameTimeSample> trace;
+    for (uint32_t i = 0; i < 600; ++i) {
+        trace.push_back({ 4.0 + 0.25 * jitter(random), 7.0 + jitter(random) });
+    }
+    const std::vector<FrameTimeSample> loaded = RoundTrip(directory / "jitter.csv", trace);
+
+    const PacingReplayResult bounded = ReplayFramePacing(loaded, MakeSettings());
+    CHECK(bounded.missedDeadlines == 0);
+    CHECK(bounded.gpuUnderpredictions < bounded.frameCount / 20);
+    // 遅延は間隔から最悪の処理時間（CPU 4.25 + GPU 8 + 余裕 1）を引いた程度は確保できる
+    CHECK(bounded.averageDelayMs > REFRESH_MS - 13.25 - 1.0);
+    CHECK(bounded.maxDelayMs < REFRESH_MS - 11.0);
+    CHECK(bounded.gpuPredictionErrorMs > 0.5 && bounded.gpuPredictionErrorMs < 2.0);
+
+    FramePacingSettings unbounded = MakeSettings();
+    unbounded.deviationScale = 0.0;
+    const PacingReplayResult meanOnly = ReplayFramePacing(loaded, unbounded);
+    CHECK(meanOnly.gpuUnderpredictions > meanOnly.frameCount / 3);
+    CHECK(meanOnly.averageDelayMs > bounded.averageDelayMs);
+}
+
+void TestTraceFiles(const std::filesystem::path& directory)
+{
+    {
+        std::ofstream file(directory / "windows.csv", std::ios::binary);
+        file << "cpuMs,gpuMs\r\n1.5,2.5\r\n\r\n3,4\r\n";
+    }
+    const std::vector<FrameTimeSample> loaded = LoadFrameTimeTrace(directory / "windows.csv");
+    CHECK(loaded.size() == 2);
+    CHECK(loaded.size() == 2 && loaded[0].cpuMs == 1.5 && loaded[0].gpuMs == 2.5 && loaded[1].cpuMs == 3.0 && loaded[1].gpuMs == 4.0);
+
+    {
+        std::ofstream file(directory / "broken.csv");
+        file << "cpuMs,gpuMs\n1.0,2.0\nnot a number\n";
+    }
+    bool threw = false;
+    try {
+        LoadFrameTimeTrace(directory / "broken.csv");
+    }
+    catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+
+    threw = false;
+    try {
+        LoadFrameTimeTrace(directory / "missing.csv");
+    }
+    catch (const std::runtime_error&) {
+        threw = true;
+    }
+    CHECK(threw);
+}
+
+} // namespace
+
+int main()
+{
+    const std::filesystem::path directory = std::filesystem::temp_directory_path() / "FramePacingTests";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    TestPrediction();
+    TestConstantTrace(directory);
+    TestJitterBound(directory);
+    TestTraceFiles(directory);
+    std::filesystem::remove_all(directory);
+    return FinishTests();
+}
@@ -0,0 +1,148 @@
+﻿#include "TestCheck.h"
+#include "Render/FrameScheduler.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// FrameScheduler が SimulatedGpuTimeline 上で、スロットの前回のフェンスが未完了のときだけ待機すること、
+// 2/3 フレーム先行投入での待機の回数と時刻、スロットとフェンス値の割り当てを検証する
+
+namespace {
+
+// 待機の呼び出しを記録して SimulatedGpuTimeline へ委譲する
+class RecordingTimeline : public IGpuTimeline {
+public:
+    void Signal(uint64_t value) override { simulated.Signal(value); }
+    uint64_t GetCompletedValue() const override { return simulated.GetCompletedValue(); }
+    void WaitForValue(uint64_t value) override
+    {
+        waitedValues.push_back(value);
+        simulated.WaitForValue(value);
+    }
+
+    SimulatedGpuTimeline simulated;
+    std::vector<uint64_t> waitedValues;
+};
+
+bool Near(double value, double expected)
+{
+    return std::fabs(value - expected) < 1e-9;
+}
+
+// CPU cpuMs、GPU gpuMs のフレームを frameCount 回流す。各フレームの開始で、
+// 待機したのはスロットの前回のフェンスが未完了だった場合だけで、そのフェンス値を待ったことを確かめる
+void RunFrames(FrameScheduler& scheduler, RecordingTimeline& timeline, uint32_t frameCount, double cpuMs, std::vector<double>& beginTimes)
+{
+    const uint32_t framesInFlight = scheduler.GetFramesInFlight();
+    std::vector<uint64_t> issued;
+    for (uint32_t frame = 0; frame < frameCount; ++frame) {
+        const uint64_t previousFence = frame >= framesInFlight ? issued[frame - framesInFlight] : 0;
+        const bool incomplete = previousFence != 0 && timeline.GetCompletedValue() < previousFence;
+        const size_t waitsBefore = timeline.waitedValues.size();
+        const uint64_t stallsBefore = scheduler.GetStallCount();
+
+        const uint32_t slot = scheduler.BeginFrame();
+        CHECK(slot == frame % framesInFlight);
+        CHECK(timeline.waitedValues.size() == waitsBefore + (incomplete ? 1 : 0));
+        CHECK(scheduler.GetStallCount() == stallsBefore + (incomplete ? 1 : 0));
+        if (incomplete) {
+            CHECK(timeline.waitedValues.back() == previousFence);
+            CHECK(timeline.GetCompletedValue() >= previousFence);
+        }
+        beginTimes.push_back(timeline.simulated.GetCpuTime());
+
+        timeline.simulated.AdvanceCpuTime(cpuMs);
+        CHECK(scheduler.GetCurrentFenceValue() == frame + 1);
+        issued.push_back(scheduler.EndFrame());
+        CHECK(issued.back() == frame + 1);
+    }
+}
+
+// GPU が律速（CPU 4ms、GPU 10ms）: 最初の framesInFlight フレームは待たず、以降は毎フレーム
+// framesInFlight 前のフレームの GPU 完了（4 + 10 × (k - framesInFlight + 1)）まで待つ
+void TestGpuBound(uint32_t framesInFlight)
+{
+    constexpr uint32_t FRAME_COUNT = 20;
+    RecordingTimeline timeline;
+    timeline.simulated.SetGpuFrameTime(10.0);
+    FrameScheduler scheduler;
+    scheduler.Initialize(&timeline, framesInFlight);
+    CHECK(scheduler.GetFramesInFlight() == framesInFlight);
+
+    std::vector<double> beginTimes;
+    RunFrames(scheduler, timeline, FRAME_COUNT, 4.0, beginTimes);
+    CHECK(scheduler.GetStallCount() == FRAME_COUNT - framesInFlight);
+    for (uint32_t frame = 0; frame < FRAME_COUNT; ++frame) {
+        const double expected = frame < framesInFlight ? 4.0 * frame : 4.0 + 10.0 * (frame - framesInFlight + 1);
+        if (!Near(beginTimes[frame], expected)) {
+            std::fprintf(stderr, "%u frames in flight: frame %u began at %f, expected %f\n", framesInFlight, frame, beginTimes[frame], expected);
+        }
+        CHECK(Near(beginTimes[frame], expected));
+    }
+
+    // 待機は「最後の開始時刻 - 待たずに済んだ場合の開始時刻」の合計
+    double expectedWait = 0.0;
+    for (uint32_t frame = framesInFlight; frame < FRAME_COUNT; ++frame) {
+        expectedWait += beginTimes[frame] - (beginTimes[frame - 1] + 4.0);
+    }
+    CHECK(Near(timeline.simulated.GetTotalWaitTime(), expectedWait));
+
+    // WaitForIdle は最後のフレームの GPU 完了まで待つ
+    scheduler.WaitForIdle();
+    CHECK(scheduler.GetCompletedFenceValue() == FRAME_COUNT);
+    CHECK(Near(timeline.simulated.GetCpuTime(), 4.0 + 10.0 * FRAME_COUNT));
+    const size_t waits = timeline.waitedValues.size();
+    scheduler.WaitForIdle();
+    CHECK(timeline.waitedValues.size() == waits);
+}
+
+// CPU が律速（CPU 8ms、GPU 3ms）またはちょうど釣り合う（4ms / 4ms）場合は、スロットを再利用する時点で完了済みなので待たない
+void TestNoStall(uint32_t framesInFlight, double cpuMs, double gpuMs)
+{
+    RecordingTimeline timeline;
+    timeline.simulated.SetGpuFrameTime(gpuMs);
+    FrameScheduler scheduler;
+    scheduler.Initialize(&timeline, framesInFlight);
+    std::vector<double> beginTimes;
+    RunFrames(scheduler, timeline, 20, cpuMs, beginTimes);
+    CHECK(scheduler.GetStallCount() == 0);
+    CHECK(timeline.waitedValues.empty());
+    CHECK(timeline.simulated.GetTotalWaitTime() == 0.0);
+}
+
+void TestInitialize()
+{
+    RecordingTimeline timeline;
+    FrameScheduler scheduler;
+    scheduler.Initialize(&timeline, 0);
+    CHECK(scheduler.GetFramesInFlight() == 1);
+    scheduler.Initialize(&timeline, MAX_FRAMES_IN_FLIGHT + 2);
+    CHECK(scheduler.GetFramesInFlight() == MAX_FRAMES_IN_FLIGHT);
+
+    // 1 フレームだけなら、GPU 時間があるかぎり毎フレーム直前のフレームを待つ
+    timeline.simulated.SetGpuFrameTime(1.0);
+    scheduler.Initialize(&timeline, 1);
+    std::vector<double> beginTimes;
+    RunFrames(scheduler, timeline, 5, 1.0, beginTimes);
+    CHECK(scheduler.GetStallCount() == 4);
+
+    // タイムラインの完了値の続きからフェンス値を振り直し、待機の回数も数え直す
+    scheduler.WaitForIdle();
+    scheduler.Initialize(&timeline, 2);
+    CHECK(scheduler.GetCurrentFenceValue() == 6);
+    CHECK(scheduler.GetStallCount() == 0);
+    CHECK(scheduler.GetFrameSlot() == 0);
+}
+
+} // namespace
+
+int main()
+{
+    TestGpuBound(2);
+    TestGpuBound(3);
+    TestNoStall(2, 8.0, 3.0);
+    TestNoStall(3, 8.0, 3.0);
+    TestNoStall(2, 4.0, 4.0);
+    TestInitialize();
+    return FinishTests();
+}
@@ -0,0 +1,142 @@
+﻿#include "TestCheck.h"
+#include "Render/InstanceKernels.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// 同じ SoA をスカラー/SSE2/AVX2 のインスタンスカーネルで更新して書き出し、InstanceGpuData が許容誤差内で一致することを検証する。
+// インスタンス数はベクトル幅の倍数にせず、端数をスカラー版で処理する経路も通す
+
+namespace {
+
+// 8 の倍数 + 5（SSE2 と AVX2 の両方で端数が出る）
+constexpr uint32_t INSTANCE_COUNT = 8 * 64 + 5;
+constexpr uint32_t STEP_COUNT = 90;
+// 範囲の先頭をベクトル幅にそろえない
+constexpr uint32_t BEGIN = 3;
+// AVX2 版は積和に FMA を使うため丸め誤差の分だけずれる
+constexpr float TOLERANCE = 1e-4f;
+constexpr float PI = 3.14159265358979f;
+
+// 境界で跳ね返る/回転が ±PI で折り返す/明滅の位相が 1 を越えるインスタンスが混ざるようにする
+InstanceStorage MakeInstances()
+{
+    std::mt19937 random(4321);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_real_distribution<float> signedUnit(-1.0f, 1.0f);
+    InstanceStorage storage;
+    storage.Reserve(INSTANCE_COUNT);
+    for (uint32_t i = 0; i < INSTANCE_COUNT; ++i) {
+        InstanceDesc desc;
+        desc.positionX = signedUnit(random);
+        desc.positionY = signedUnit(random);
+        desc.velocityX = signedUnit(random) * 2.0f;
+        desc.velocityY = signedUnit(random) * 2.0f;
+        desc.rotation = signedUnit(random) * PI;
+        desc.angularVelocity = signedUnit(random) * 6.0f;
+        desc.scale = 0.01f + unit(random) * 0.05f;
+        desc.colorR = unit(random);
+        desc.colorG = unit(random);
+        desc.colorB = unit(random);
+        desc.phase = unit(random) * 0.999f;
+        storage.Add(desc);
+    }
+    return storage;
+}
+
+bool Near(float value, float expected)
+{
+    return std::fabs(value - expected) <= TOLERANCE * (1.0f + std::fabs(expected));
+}
+
+// 最初に食い違った要素を表示する
+bool SameInstances(const char* label, SimdLevel level, const std::vector<InstanceGpuData>& values, const std::vector<InstanceGpuData>& expected)
+{
+    for (size_t i = 0; i < values.size(); ++i) {
+        const InstanceGpuData& a = values[i];
+        const InstanceGpuData& b = expected[i];
+        if (!Near(a.positionX, b.positionX) || !Near(a.positionY, b.positionY) || !Near(a.rotation, b.rotation) || !Near(a.scale, b.scale) ||
+            !Near(a.colorR, b.colorR) || !Near(a.colorG, b.colorG) || !Near(a.colorB, b.colorB) || !Near(a.colorA, b.colorA)) {
+            std::fprintf(stderr, "%s: %s instance %zu differs (rotation %f, expected %f)\n", label, GetSimdLevelName(level), i, a.rotation, b.rotation);
+            return false;
+        }
+    }
+    return true;
+}
+
+// [BEGIN, INSTANCE_COUNT) を更新して書き出す。出力の末尾の 1 要素は番兵（書き換えられないこと）
+std::vector<InstanceGpuData> RunKernels(const InstanceKernelTable& kernels)
+{
+    InstanceStorage storage = MakeInstances();
+    const InstanceStreams streams = storage.GetStreams();
+    InstanceUpdateParams params;
+    params.deltaTime = 1.0f / 60.0f;
+    params.bounds = 0.95f;
+    for (uint32_t step = 0; step < STEP_COUNT; ++step) {
+        params.pulseTime = std::fmod(step * 0.037f, 1.0f);
+        kernels.updateTransforms(streams, BEGIN, INSTANCE_COUNT, params);
+        kernels.updateColors(streams, BEGIN, INSTANCE_COUNT, params);
+    }
+    std::vector<InstanceGpuData> instances(INSTANCE_COUNT - BEGIN + 1, InstanceGpuData{});
+    instances.back().scale = -1.0f;
+    kernels.packInstances(streams, BEGIN, INSTANCE_COUNT, instances.data());
+    CHECK(instances.back().scale == -1.0f);
+    instances.pop_back();
+    return instances;
+}
+
+// 回転が ±PI をまたぐ組を含む 2 つのスナップショットを補間する
+std::vector<InstanceGpuData> RunInterpolation(const InstanceKernelTable& kernels, float alpha)
+{
+    std::mt19937 random(8765);
+    std::uniform_real_distribution<float> signedUnit(-1.0f, 1.0f);
+    std::vector<InstanceGpuData> previous(INSTANCE_COUNT);
+    std::vector<InstanceGpuData> current(INSTANCE_COUNT);
+    for (uint32_t i = 0; i < INSTANCE_COUNT; ++i) {
+        for (InstanceGpuData* data : { &previous[i], &current[i] }) {
+            *data = { signedUnit(random), signedUnit(random), signedUnit(random) * PI, 0.05f + 0.01f * signedUnit(random),
+                      0.5f + 0.5f * signedUnit(random), 0.5f + 0.5f * signedUnit(random), 0.5f + 0.5f * signedUnit(random), 1.0f };
+        }
+    }
+    std::vector<InstanceGpuData> output(INSTANCE_COUNT - BEGIN + 1, InstanceGpuData{});
+    output.back().scale = -1.0f;
+    kernels.interpolateInstances(previous.data(), current.data(), BEGIN, INSTANCE_COUNT, alpha, output.data());
+    CHECK(output.back().scale == -1.0f);
+    output.pop_back();
+    return output;
+}
+
+void TestKernelsMatchScalar()
+{
+    const InstanceKernelTable& scalar = GetInstanceKernels(SimdLevel::Scalar);
+    CHECK(scalar.level == SimdLevel::Scalar);
+    const std::vector<InstanceGpuData> expected = RunKernels(scalar);
+    const std::vector<InstanceGpuData> expectedInterpolated = RunInterpolation(scalar, 0.3f);
+
+    // 範囲内は境界の内側、回転は [-PI, PI]、不透明
+    bool valid = true;
+    for (const InstanceGpuData& instance : expected) {
+        valid = valid && std::fabs(instance.positionX) <= 0.95f && std::fabs(instance.positionY) <= 0.95f && std::fabs(instance.rotation) <= PI &&
+                instance.colorA == 1.0f;
+    }
+    CHECK(valid);
+
+    for (const SimdLevel level : { SimdLevel::SSE2, SimdLevel::AVX2 }) {
+        const InstanceKernelTable& kernels = GetInstanceKernels(level);
+        if (kernels.level != level) {
+            std::printf("%s is not supported on this CPU; skipped\n", GetSimdLevelName(level));
+            continue;
+        }
+        CHECK(SameInstances("update", level, RunKernels(kernels), expected));
+        CHECK(SameInstances("interpolate", level, RunInterpolation(kernels, 0.3f), expectedInterpolated));
+    }
+}
+
+} // namespace
+
+int main()
+{
+    TestKernelsMatchScalar();
+    return FinishTests();
+}
@@ -0,0 +1,237 @@
+﻿#include "TestCheck.h"
+#include "Core/JobSystem.h"
+#include "Render/ParallelCommandRecorder.h"
+#include "Render/RecordingCommandList.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// JobSystem のワークスティーリング（他スレッドのキューからの取り出し）ですべてのジョブが 1 回ずつ実行されること、
+// ジョブの中から投入したジョブを含めて Wait が完了を待つこと、
+// ParallelCommandRecorder で並列に記録したコマンドの順序が 1 スレッドで記録した場合と一致することを検証する
+
+namespace {
+
+constexpr uint32_t WORKER_THREAD_COUNT = 3;
+
+void TestEveryJobRunsOnce(JobSystem& jobs)
+{
+    constexpr uint32_t JOB_COUNT = 20000;
+    std::unique_ptr<std::atomic<uint32_t>[]> runCounts(new std::atomic<uint32_t>[JOB_COUNT]);
+    for (uint32_t i = 0; i < JOB_COUNT; ++i) {
+        runCounts[i].store(0);
+    }
+    JobCounter counter;
+    for (uint32_t i = 0; i < JOB_COUNT; ++i) {
+        jobs.Schedule([&runCounts, i]() { runCounts[i].fetch_add(1, std::memory_order_relaxed); }, &counter);
+    }
+    jobs.Wait(counter);
+    CHECK(counter.IsDone());
+    uint32_t wrong = 0;
+    for (uint32_t i = 0; i < JOB_COUNT; ++i) {
+        wrong += runCounts[i].load() != 1 ? 1 : 0;
+    }
+    if (wrong != 0) {
+        std::fprintf(stderr, "%u of %u jobs did not run exactly once\n", wrong, JOB_COUNT);
+    }
+    CHECK(wrong == 0);
+
+    // ParallelFor は端数の範囲を含めて各インデックスを 1 回ずつ渡す
+    std::vector<uint32_t> visits(1003, 0);
+    jobs.ParallelFor(1003, 64, [&visits](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            ++visits[i];
+        }
+    });
+    CHECK(std::count(visits.begin(), visits.end(), 1u) == 1003);
+}
+
+// 呼び出し元（ワーカー 0）のキューに積んだジョブを、呼び出し元が実行せずに他のワーカーが盗んで実行する。
+// 先に積んだジョブは後に積んだジョブの実行を待つため、2 つは別々のワーカーが取り出さないと終わらない
+void TestStealing(JobSystem& jobs)
+{
+    CHECK(JobSystem::GetCurrentWorkerIndex() == 0);
+    std::atomic<bool> released{ false };
+    std::atomic<uint32_t> blockedWorker{ JobSystem::INVALID_WORKER_INDEX };
+    std::atomic<uint32_t> releasingWorker{ JobSystem::INVALID_WORKER_INDEX };
+    JobCounter counter;
+    jobs.Schedule([&]() {
+        blockedWorker = JobSystem::GetCurrentWorkerIndex();
+        while (!released.load()) {
+            std::this_thread::yield();
+        }
+    }, &counter);
+    jobs.Schedule([&]() {
+        releasingWorker = JobSystem::GetCurrentWorkerIndex();
+        released = true;
+    }, &counter);
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!counter.IsDone() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK(counter.IsDone());
+    // 盗まれなかった場合もテストを終えられるように解放する
+    released = true;
+    jobs.Wait(counter);
+    CHECK(blockedWorker != 0 && blockedWorker != JobSystem::INVALID_WORKER_INDEX);
+    CHECK(releasingWorker != 0 && releasingWorker != JobSystem::INVALID_WORKER_INDEX);
+    CHECK(blockedWorker != releasingWorker);
+}
+
+// ジョブの中から同じカウンタへ投入したジョブと、ジョブの中で Wait した別カウンタのジョブの両方が、
+// 外側の Wait が戻る時点で完了している
+void TestNestedWait(JobSystem& jobs)
+{
+    constexpr uint32_t PARENT_COUNT = 8;
+    constexpr uint32_t CHILD_COUNT = 16;
+    std::atomic<uint32_t> sameCounterChildren{ 0 };
+    std::atomic<uint32_t> localCounterChildren{ 0 };
+    std::atomic<uint32_t> parentsAfterLocalWait{ 0 };
+    JobCounter counter;
+    for (uint32_t parent = 0; parent < PARENT_COUNT; ++parent) {
+        jobs.Schedule([&]() {
+            for (uint32_t child = 0; child < CHILD_COUNT; ++child) {
+                jobs.Schedule([&]() {
+                    std::this_thread::yield();
+                    sameCounterChildren.fetch_add(1);
+                }, &counter);
+            }
+            JobCounter localCounter;
+            for (uint32_t child = 0; child < CHILD_COUNT; ++child) {
+                jobs.Schedule([&]() { localCounterChildren.fetch_add(1); }, &localCounter);
+            }
+            jobs.Wait(localCounter);
+            CHECK(localCounter.IsDone());
+            parentsAfterLocalWait.fetch_add(1);
+        }, &counter);
+    }
+    jobs.Wait(counter);
+    CHECK(sameCounterChildren.load() == PARENT_COUNT * CHILD_COUNT);
+    CHECK(localCounterChildren.load() == PARENT_COUNT * CHILD_COUNT);
+    CHECK(parentsAfterLocalWait.load() == PARENT_COUNT);
+}
+
+bool SameCommands(const std::vector<RecordedCommand>& commands, const std::vector<RecordedCommand>& expected)
+{
+    if (commands.size() != expected.size()) {
+        std::fprintf(stderr, "%zu commands recorded, expected %zu\n", commands.size(), expected.size());
+        return false;
+    }
+    for (size_t i = 0; i < commands.size(); ++i) {
+        const RecordedCommand& a = commands[i];
+        const RecordedCommand& b = expected[i];
+        if (a.type != b.type || a.args[0] != b.args[0] || a.args[1] != b.args[1] || a.args[2] != b.args[2] || a.args[3] != b.args[3]) {
+            std::fprintf(stderr, "command %zu differs (type %u, expected %u)\n", i, static_cast<uint32_t>(a.type), static_cast<uint32_t>(b.type));
+            return false;
+        }
+    }
+    return true;
+}
+
+// パイプラインとトポロジが途中で変わり、一部だけインスタンスバッファを持つ描画列
+std::vector<DrawItem> MakeDraws(uint32_t count)
+{
+    std::vector<DrawItem> draws(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        DrawItem& draw = draws[i];
+        draw.pipeline = 1 + i / 7;
+        draw.topology = (i / 5) % 2 == 0 ? PrimitiveTopology::TriangleList : PrimitiveTopology::TriangleStrip;
+        draw.vertexBuffer = { 0x1000 + 0x100ull * i, 0x100, 16 };
+        if (i % 3 == 0) {
+            draw.instanceBuffer = { 0x80000 + 0x40ull * i, 0x40, 32 };
+        }
+        draw.vertexCount = i + 1;
+        draw.instanceCount = 1 + i % 4;
+    }
+    return draws;
+}
+
+// lists へ記録して投入し、実行されたコマンドを投入順に連結したものを返す
+struct Recorder {
+    std::vector<RecordingCommandList> lists;
+    ParallelCommandRecorder recorder;
+    RecordingCommandQueue queue;
+
+    Recorder(JobSystem* jobs, uint32_t listCount)
+        : lists(listCount)
+    {
+        std::vector<ICommandList*> pointers;
+        for (RecordingCommandList& list : lists) {
+            pointers.push_back(&list);
+        }
+        recorder.Initialize(jobs, pointers);
+    }
+
+    std::vector<RecordedCommand> Execute(const std::vector<ICommandList*>& recorded)
+    {
+        queue.Reset();
+        queue.ExecuteCommandLists(recorded.data(), static_cast<uint32_t>(recorded.size()));
+        return queue.GetExecutedCommands();
+    }
+};
+
+void TestParallelRecording(JobSystem& jobs)
+{
+    constexpr uint32_t LIST_COUNT = 6;
+    JobSystem singleThreaded; // 未初期化のジョブシステムは投入したその場で実行する
+    Recorder serial(&singleThreaded, LIST_COUNT);
+    Recorder parallel(&jobs, LIST_COUNT);
+
+    PassTarget target;
+    target.renderTarget = 3;
+    target.viewport = { 0.0f, 0.0f, 1280.0f, 720.0f, 0.0f, 1.0f };
+    target.scissor = { 0, 0, 1280, 720 };
+    const std::vector<DrawItem> draws = MakeDraws(103);
+    const std::vector<RecordedCommand> expected = serial.Execute(serial.recorder.RecordDraws(1, target, draws, 10));
+
+    // 描画は元の順に並ぶ
+    std::vector<uint32_t> vertexCounts;
+    for (const RecordedCommand& command : expected) {
+        if (command.type == RecordedCommandType::DrawInstanced) {
+            vertexCounts.push_back(command.args[0]);
+        }
+    }
+    bool ordered = vertexCounts.size() == draws.size();
+    for (size_t i = 0; ordered && i < vertexCounts.size(); ++i) {
+        ordered = vertexCounts[i] == draws[i].vertexCount;
+    }
+    CHECK(ordered);
+
+    // 並列の記録は、どのワーカーがどのタスクを実行しても同じ列になる（繰り返して実行順の揺らぎを拾う）
+    bool same = true;
+    for (uint32_t round = 0; round < 200 && same; ++round) {
+        const std::vector<ICommandList*>& recorded = parallel.recorder.RecordDraws(1, target, draws, 10);
+        same = recorded.size() == LIST_COUNT && SameCommands(parallel.Execute(recorded), expected);
+    }
+    CHECK(same);
+
+    // 任意の関数によるタスク番号ごとの記録も同じ
+    const auto dispatch = [](ICommandList& commandList, uint32_t taskIndex) {
+        for (uint32_t i = 0; i <= taskIndex; ++i) {
+            commandList.Dispatch(taskIndex, i, 1);
+        }
+    };
+    const std::vector<RecordedCommand> expectedDispatches = serial.Execute(serial.recorder.Record(0, 5, dispatch));
+    CHECK(expectedDispatches.size() == 5 * 2 + (1 + 2 + 3 + 4 + 5));
+    CHECK(SameCommands(parallel.Execute(parallel.recorder.Record(0, 5, dispatch)), expectedDispatches));
+}
+
+} // namespace
+
+int main()
+{
+    JobSystem jobs;
+    jobs.Initialize(WORKER_THREAD_COUNT);
+    CHECK(jobs.GetThreadCount() == WORKER_THREAD_COUNT + 1);
+    TestEveryJobRunsOnce(jobs);
+    TestStealing(jobs);
+    TestNestedWait(jobs);
+    TestParallelRecording(jobs);
+    jobs.Shutdown();
+    return FinishTests();
+}
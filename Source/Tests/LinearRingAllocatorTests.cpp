@@ -0,0 +1,131 @@
+﻿#include "TestCheck.h"
+#include "Render/LinearRingAllocator.h"
+
+// LinearRingAllocator の折り返し、未解放領域による割り当て失敗、フェンス値ごとの部分的な解放、容量ちょうどの割り当てを検証する
+
+namespace {
+
+constexpr uint64_t CAPACITY = 1024;
+constexpr uint64_t INVALID = LinearRingAllocator::INVALID_OFFSET;
+
+void TestAlignment()
+{
+    LinearRingAllocator ring;
+    ring.Initialize(CAPACITY);
+    CHECK(ring.Allocate(10, 1) == 0);
+    // アライメントで飛ばした領域も使用量に含める
+    CHECK(ring.Allocate(16, 256) == 256);
+    CHECK(ring.GetUsedSize() == 256 + 16);
+    CHECK(ring.Allocate(0, 1) == INVALID);
+    CHECK(ring.Allocate(CAPACITY + 1, 1) == INVALID);
+}
+
+void TestWrap()
+{
+    LinearRingAllocator ring;
+    ring.Initialize(CAPACITY);
+    CHECK(ring.Allocate(400, 16) == 0);
+    CHECK(ring.Allocate(400, 16) == 400);
+    ring.FinishFrame(1);
+    CHECK(ring.Allocate(100, 16) == 800);
+    ring.FinishFrame(2);
+    ring.Retire(1);
+    CHECK(ring.GetUsedSize() == 100);
+
+    // 末尾の残り 124 バイトに収まらないので先頭へ折り返し、捨てた末尾もこのフレームの使用量にする
+    CHECK(ring.Allocate(200, 16) == 0);
+    CHECK(ring.GetUsedSize() == 100 + 124 + 200);
+    ring.FinishFrame(3);
+    ring.Retire(2);
+    CHECK(ring.GetUsedSize() == 124 + 200);
+    ring.Retire(3);
+    CHECK(ring.GetUsedSize() == 0);
+    CHECK(ring.GetPendingFrameCount() == 0);
+
+    // 空になったリングは末尾に収まらなければ先頭から使い直し、捨てた末尾を使用量に含めない
+    CHECK(ring.Allocate(900, 16) == 0);
+    CHECK(ring.GetUsedSize() == 900);
+}
+
+void TestFullWhileUnretired()
+{
+    LinearRingAllocator ring;
+    ring.Initialize(CAPACITY);
+    CHECK(ring.Allocate(600, 16) == 0);
+    ring.FinishFrame(1);
+    CHECK(ring.Allocate(400, 8) == 600);
+    ring.FinishFrame(2);
+
+    // 最も古い領域 [0, 600) が解放されるまで先頭へ折り返せない
+    CHECK(ring.Allocate(100, 16) == INVALID);
+    CHECK(ring.GetUsedSize() == 1000);
+    ring.Retire(0);
+    CHECK(ring.Allocate(100, 16) == INVALID);
+
+    ring.Retire(1);
+    CHECK(ring.Allocate(100, 16) == 0);
+    // 折り返した後は tail（600）を越えられない。ちょうど tail までなら収まる
+    CHECK(ring.Allocate(501, 1) == INVALID);
+    CHECK(ring.Allocate(500, 1) == 100);
+    CHECK(ring.GetUsedSize() == CAPACITY);
+    CHECK(ring.Allocate(1, 1) == INVALID);
+}
+
+void TestPartialRetire()
+{
+    LinearRingAllocator ring;
+    ring.Initialize(CAPACITY);
+    for (uint64_t frame = 1; frame <= 4; ++frame) {
+        CHECK(ring.Allocate(100, 16) == (frame - 1) * 112);
+        ring.FinishFrame(frame);
+    }
+    CHECK(ring.GetPendingFrameCount() == 4);
+    CHECK(ring.GetUsedSize() == 100 + 3 * 112);
+
+    // 完了したフェンス値以下のフレームだけを解放する
+    ring.Retire(2);
+    CHECK(ring.GetPendingFrameCount() == 2);
+    CHECK(ring.GetUsedSize() == 2 * 112);
+    ring.Retire(2);
+    CHECK(ring.GetPendingFrameCount() == 2);
+
+    // 割り当てのないフレームはマーカーを残さない
+    ring.FinishFrame(5);
+    CHECK(ring.GetPendingFrameCount() == 2);
+    ring.Retire(4);
+    CHECK(ring.GetPendingFrameCount() == 0);
+    CHECK(ring.GetUsedSize() == 0);
+}
+
+void TestExactFit()
+{
+    LinearRingAllocator ring;
+    ring.Initialize(CAPACITY);
+    CHECK(ring.Allocate(CAPACITY, 256) == 0);
+    CHECK(ring.GetUsedSize() == CAPACITY);
+    CHECK(ring.Allocate(1, 1) == INVALID);
+    ring.FinishFrame(1);
+    ring.Retire(1);
+    CHECK(ring.GetUsedSize() == 0);
+
+    // 末尾までちょうど使い切ると次は先頭から割り当てる
+    CHECK(ring.Allocate(1000, 8) == 0);
+    CHECK(ring.Allocate(24, 8) == 1000);
+    ring.FinishFrame(2);
+    CHECK(ring.Allocate(8, 8) == INVALID);
+    ring.Retire(2);
+    CHECK(ring.Allocate(8, 8) == 0);
+    CHECK(ring.GetUsedSize() == 8);
+}
+
+} // namespace
+
+int main()
+{
+    TestAlignment();
+    TestWrap();
+    TestFullWhileUnretired();
+    TestPartialRetire();
+    TestExactFit();
+    return FinishTests();
+}
@@ -0,0 +1,164 @@
+﻿#include "TestCheck.h"
+#include "Render/ParticleKernels.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// 同じ SoA をスカラー/SSE2/AVX2 のカーネルで進め、結果が許容誤差内で一致することを検証する。
+// 粒子数はベクトル幅の倍数にせず、端数をスカラー版で処理する経路も通す
+
+namespace {
+
+// 8 の倍数 + 5（SSE2 と AVX2 の両方で端数が出る）
+constexpr uint32_t PARTICLE_COUNT = 8 * 125 + 5;
+constexpr uint32_t STEP_COUNT = 120;
+// AVX2 版は積和に FMA を使うため丸め誤差の分だけずれる
+constexpr float TOLERANCE = 1e-4f;
+
+struct ParticleSoA {
+    std::vector<float> positionX;
+    std::vector<float> positionY;
+    std::vector<float> velocityX;
+    std::vector<float> velocityY;
+    std::vector<float> age;
+    std::vector<float> ageRate;
+    std::vector<float> launchVelocityX;
+    std::vector<float> launchVelocityY;
+
+    ParticleStreams GetStreams()
+    {
+        return { positionX.data(), positionY.data(), velocityX.data(), velocityY.data(), age.data(), ageRate.data(), launchVelocityX.data(),
+                 launchVelocityY.data() };
+    }
+};
+
+// 床で跳ね返る粒子と寿命で出し直す粒子が混ざるようにする
+ParticleSoA MakeParticles()
+{
+    std::mt19937 random(8642);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_real_distribution<float> signedUnit(-1.0f, 1.0f);
+    ParticleSoA particles;
+    for (uint32_t i = 0; i < PARTICLE_COUNT; ++i) {
+        particles.positionX.push_back(signedUnit(random));
+        particles.positionY.push_back(signedUnit(random) * 0.9f);
+        particles.velocityX.push_back(signedUnit(random) * 0.5f);
+        particles.velocityY.push_back(signedUnit(random) * 0.5f);
+        particles.age.push_back(unit(random) * 0.99f);
+        particles.ageRate.push_back(0.2f + unit(random));
+        particles.launchVelocityX.push_back(signedUnit(random) * 0.3f);
+        particles.launchVelocityY.push_back(0.5f + unit(random));
+    }
+    return particles;
+}
+
+ParticleSimulationParams MakeParams()
+{
+    ParticleSimulationParams params;
+    params.deltaTime = 1.0f / 60.0f;
+    params.gravityY = -2.0f;
+    params.damping = 0.995f;
+    params.emitterX = 0.1f;
+    params.emitterY = -0.5f;
+    params.floorY = -0.9f;
+    params.restitution = 0.6f;
+    return params;
+}
+
+bool Near(float value, float expected)
+{
+    return std::fabs(value - expected) <= TOLERANCE * (1.0f + std::fabs(expected));
+}
+
+// 最初に食い違った要素を表示する
+bool SameStream(const char* name, SimdLevel level, const std::vector<float>& values, const std::vector<float>& expected)
+{
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (!Near(values[i], expected[i])) {
+            std::fprintf(stderr, "%s: %s[%zu] = %f, expected %f\n", GetSimdLevelName(level), name, i, values[i], expected[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SameInstances(SimdLevel level, const std::vector<InstanceGpuData>& values, const std::vector<InstanceGpuData>& expected)
+{
+    for (size_t i = 0; i < values.size(); ++i) {
+        const InstanceGpuData& a = values[i];
+        const InstanceGpuData& b = expected[i];
+        if (!Near(a.positionX, b.positionX) || !Near(a.positionY, b.positionY) || a.rotation != b.rotation || !Near(a.scale, b.scale) ||
+            !Near(a.colorR, b.colorR) || !Near(a.colorG, b.colorG) || !Near(a.colorB, b.colorB) || !Near(a.colorA, b.colorA)) {
+            std::fprintf(stderr, "%s: instance %zu differs\n", GetSimdLevelName(level), i);
+            return false;
+        }
+    }
+    return true;
+}
+
+// 範囲の先頭をベクトル幅にそろえない [begin, end) で進め、範囲外を書き換えないことも確かめる
+void RunKernels(const ParticleKernelTable& kernels, ParticleSoA& particles, std::vector<InstanceGpuData>& instances, uint32_t begin)
+{
+    const ParticleSimulationParams params = MakeParams();
+    const ParticleStreams streams = particles.GetStreams();
+    for (uint32_t step = 0; step < STEP_COUNT; ++step) {
+        kernels.simulate(streams, begin, PARTICLE_COUNT, params);
+    }
+    instances.assign(PARTICLE_COUNT - begin + 1, InstanceGpuData{});
+    // 出力の末尾の 1 要素は番兵（書き換えられないこと）
+    instances.back().scale = -1.0f;
+    kernels.pack(streams, begin, PARTICLE_COUNT, ParticleAppearance(), instances.data());
+}
+
+void TestKernelsMatchScalar()
+{
+    constexpr uint32_t BEGIN = 3;
+    const ParticleSoA initial = MakeParticles();
+    ParticleSoA expected = initial;
+    std::vector<InstanceGpuData> expectedInstances;
+    const ParticleKernelTable& scalar = GetParticleKernels(SimdLevel::Scalar);
+    CHECK(scalar.level == SimdLevel::Scalar);
+    RunKernels(scalar, expected, expectedInstances, BEGIN);
+    CHECK(expectedInstances.back().scale == -1.0f);
+
+    // 範囲外の粒子はそのまま、範囲内は床より下に出ず、寿命の割合は [0, 1)
+    bool untouched = true;
+    bool valid = true;
+    for (uint32_t i = 0; i < PARTICLE_COUNT; ++i) {
+        if (i < BEGIN) {
+            untouched = untouched && expected.positionX[i] == initial.positionX[i] && expected.age[i] == initial.age[i];
+        }
+        else {
+            valid = valid && expected.positionY[i] >= MakeParams().floorY && expected.age[i] >= 0.0f && expected.age[i] < 1.0f;
+        }
+    }
+    CHECK(untouched);
+    CHECK(valid);
+
+    for (const SimdLevel level : { SimdLevel::SSE2, SimdLevel::AVX2 }) {
+        const ParticleKernelTable& kernels = GetParticleKernels(level);
+        if (kernels.level != level) {
+            std::printf("%s is not supported on this CPU; skipped\n", GetSimdLevelName(level));
+            continue;
+        }
+        ParticleSoA particles = initial;
+        std::vector<InstanceGpuData> instances;
+        RunKernels(kernels, particles, instances, BEGIN);
+        CHECK(SameStream("positionX", level, particles.positionX, expected.positionX));
+        CHECK(SameStream("positionY", level, particles.positionY, expected.positionY));
+        CHECK(SameStream("velocityX", level, particles.velocityX, expected.velocityX));
+        CHECK(SameStream("velocityY", level, particles.velocityY, expected.velocityY));
+        CHECK(SameStream("age", level, particles.age, expected.age));
+        CHECK(SameInstances(level, instances, expectedInstances));
+        CHECK(instances.back().scale == -1.0f);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    TestKernelsMatchScalar();
+    return FinishTests();
+}
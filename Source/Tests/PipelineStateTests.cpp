@@ -0,0 +1,160 @@
+﻿#include "TestCheck.h"
+#include "Render/BuiltinPipelineStates.h"
+#include <array>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// VertexLayout が求めるオフセット/ストライド/スロット/入力レートと、PipelineStateBuilder のキーを検証する
+
+namespace {
+
+// 形式の異なる属性を混ぜた頂点（12 + 4 + 8 + 4 = 28 バイト）
+struct MixedVertex {
+    float position[3];
+    uint32_t color;
+    float uv[2];
+    float weight;
+};
+
+struct InstanceData {
+    float transform[4];
+    float layer;
+};
+
+struct ExtraVertex {
+    float tangent[2];
+};
+
+using MixedStream = VertexStream<MixedVertex, VertexInputRate::PerVertex,
+                                 VertexAttribute<"POSITION", VertexElementFormat::Float3>,
+                                 VertexAttribute<"COLOR", VertexElementFormat::UNorm8x4>,
+                                 VertexAttribute<"TEXCOORD", VertexElementFormat::Float2>,
+                                 VertexAttribute<"TEXCOORD", VertexElementFormat::Float1, 1>>;
+using InstanceDataStream = VertexStream<InstanceData, VertexInputRate::PerInstance,
+                                        VertexAttribute<"TRANSFORM", VertexElementFormat::Float4>,
+                                        VertexAttribute<"LAYER", VertexElementFormat::Float1>>;
+using ExtraStream = VertexStream<ExtraVertex, VertexInputRate::PerVertex,
+                                 VertexAttribute<"TANGENT", VertexElementFormat::Float2>>;
+using MultiSlotLayout = VertexLayout<MixedStream, InstanceDataStream, ExtraStream>;
+
+// 属性の順序だけを入れ替えたレイアウト（オフセットが変わるのでハッシュも変わる）
+struct SwappedVertex {
+    float uv[2];
+    float position[3];
+};
+using SwappedLayout = VertexLayout<VertexStream<SwappedVertex, VertexInputRate::PerVertex,
+                                                VertexAttribute<"TEXCOORD", VertexElementFormat::Float2>,
+                                                VertexAttribute<"POSITION", VertexElementFormat::Float3>>>;
+using UnswappedLayout = VertexLayout<VertexStream<SwappedVertex, VertexInputRate::PerVertex,
+                                                  VertexAttribute<"POSITION", VertexElementFormat::Float3>,
+                                                  VertexAttribute<"TEXCOORD", VertexElementFormat::Float2>>>;
+
+bool ElementIs(const VertexElement& element, const char* semantic, uint32_t semanticIndex, VertexElementFormat format, uint32_t slot, uint32_t offset,
+               VertexInputRate rate)
+{
+    return std::strcmp(element.semantic, semantic) == 0 && element.semanticIndex == semanticIndex && element.format == format &&
+           element.slot == slot && element.offset == offset && element.rate == rate;
+}
+
+void TestVertexLayout()
+{
+    CHECK(MixedStream::STRIDE == 28);
+    CHECK((MixedStream::OFFSETS == std::array<uint32_t, 4>{ 0, 12, 16, 24 }));
+    CHECK(MixedStream::OFFSETS[1] == offsetof(MixedVertex, color));
+    CHECK(MixedStream::OFFSETS[2] == offsetof(MixedVertex, uv));
+    CHECK(MixedStream::OFFSETS[3] == offsetof(MixedVertex, weight));
+    CHECK(InstanceDataStream::STRIDE == 20);
+    CHECK(InstanceDataStream::OFFSETS[1] == offsetof(InstanceData, layer));
+
+    CHECK(MultiSlotLayout::STREAM_COUNT == 3);
+    CHECK(MultiSlotLayout::ELEMENT_COUNT == 7);
+    CHECK((MultiSlotLayout::STRIDES == std::array<uint32_t, 3>{ 28, 20, 8 }));
+    const auto& elements = MultiSlotLayout::ELEMENTS;
+    CHECK(ElementIs(elements[0], "POSITION", 0, VertexElementFormat::Float3, 0, 0, VertexInputRate::PerVertex));
+    CHECK(ElementIs(elements[1], "COLOR", 0, VertexElementFormat::UNorm8x4, 0, 12, VertexInputRate::PerVertex));
+    CHECK(ElementIs(elements[2], "TEXCOORD", 0, VertexElementFormat::Float2, 0, 16, VertexInputRate::PerVertex));
+    CHECK(ElementIs(elements[3], "TEXCOORD", 1, VertexElementFormat::Float1, 0, 24, VertexInputRate::PerVertex));
+    CHECK(ElementIs(elements[4], "TRANSFORM", 0, VertexElementFormat::Float4, 1, 0, VertexInputRate::PerInstance));
+    CHECK(ElementIs(elements[5], "LAYER", 0, VertexElementFormat::Float1, 1, 16, VertexInputRate::PerInstance));
+    CHECK(ElementIs(elements[6], "TANGENT", 0, VertexElementFormat::Float2, 2, 0, VertexInputRate::PerVertex));
+
+    // 組み込みのレイアウト
+    CHECK(InstancedLayout::ELEMENT_COUNT == 5);
+    CHECK((InstancedLayout::STRIDES == std::array<uint32_t, 2>{ sizeof(MeshVertex), sizeof(InstanceGpuData) }));
+    for (uint32_t i = 1; i < InstancedLayout::ELEMENT_COUNT; ++i) {
+        CHECK(InstancedLayout::ELEMENTS[i].slot == 1 && InstancedLayout::ELEMENTS[i].rate == VertexInputRate::PerInstance);
+    }
+    CHECK(EmptyVertexLayout::ELEMENT_COUNT == 0);
+
+    // レイアウトのハッシュはスロット構成と属性の順序で変わる
+    CHECK(MultiSlotLayout::HASH != (VertexLayout<MixedStream, InstanceDataStream>::HASH));
+    CHECK(MultiSlotLayout::HASH != (VertexLayout<MixedStream, ExtraStream, InstanceDataStream>::HASH));
+    CHECK(SwappedLayout::HASH != UnswappedLayout::HASH);
+    CHECK(MultiSlotLayout::HASH == (VertexLayout<MixedStream, InstanceDataStream, ExtraStream>::HASH));
+}
+
+void TestPipelineStateKeys()
+{
+    constexpr PipelineStateBuilder base = PipelineStateBuilder().InputLayout<VertexColorLayout>();
+    constexpr PipelineStateKey baseKey = base.Build();
+    static_assert(baseKey.hash == HashPipelineState(baseKey.desc));
+
+    // 各フィールドを既定値から変えたキーはすべて基準とも互いとも異なる
+    const std::vector<PipelineStateKey> changed = {
+        base.Blend(BlendMode::AlphaBlend).Build(),
+        base.Blend(BlendMode::Premultiplied).Build(),
+        base.Blend(BlendMode::Additive).Build(),
+        base.Cull(CullMode::None).Build(),
+        base.Cull(CullMode::Front).Build(),
+        base.Fill(FillMode::Wireframe).Build(),
+        base.FrontCounterClockwise(true).Build(),
+        base.DepthClip(false).Build(),
+        base.Depth(DepthMode::TestOnly).Build(),
+        base.Depth(DepthMode::TestWrite).Build(),
+        base.Depth(DepthMode::TestWrite, TextureFormat::R32Float).Build(),
+        base.Topology(PrimitiveTopologyType::Line).Build(),
+        base.Topology(PrimitiveTopologyType::Point).Build(),
+        base.RenderTarget(TextureFormat::RGBA8Unorm, 2).Build(),
+        base.RenderTarget(TextureFormat::RGBA16Float).Build(),
+        base.SampleCount(4).Build(),
+        base.InputLayout<InstancedLayout>().Build(),
+        base.InputLayout<EmptyVertexLayout>().Build(),
+        base.InputLayout<MultiSlotLayout>().Build(),
+    };
+    for (size_t i = 0; i < changed.size(); ++i) {
+        CHECK(changed[i].hash != baseKey.hash);
+        CHECK(!(changed[i] == baseKey));
+        for (size_t j = i + 1; j < changed.size(); ++j) {
+            if (changed[i].hash == changed[j].hash) {
+                std::fprintf(stderr, "pipeline state keys %zu and %zu collide\n", i, j);
+            }
+            CHECK(changed[i].hash != changed[j].hash);
+        }
+    }
+
+    // 同じ内容なら組み立ての順序によらず同じキーになる
+    const PipelineStateKey forward = base.Blend(BlendMode::AlphaBlend).Cull(CullMode::None).Depth(DepthMode::TestOnly).SampleCount(4).Build();
+    const PipelineStateKey reverse = PipelineStateBuilder().SampleCount(4).Depth(DepthMode::TestOnly).Cull(CullMode::None).Blend(BlendMode::AlphaBlend)
+                                         .InputLayout<VertexColorLayout>()
+                                         .Build();
+    CHECK(forward == reverse);
+    CHECK(base.Blend(BlendMode::Additive).Blend(BlendMode::Opaque).Build() == baseKey);
+
+    // 深度を無効にすると深度の形式は指定によらず「なし」になる
+    CHECK(base.Depth(DepthMode::Disabled, TextureFormat::R32Float).Build() == baseKey);
+    CHECK(base.Depth(DepthMode::TestWrite).Build().desc.depthFormat == static_cast<uint8_t>(TextureFormat::D32Float));
+
+    CHECK(VERTEX_COLOR_PIPELINE_STATE == baseKey);
+    CHECK(!(INSTANCED_PIPELINE_STATE == UPSCALE_PIPELINE_STATE));
+}
+
+} // namespace
+
+int main()
+{
+    TestVertexLayout();
+    TestPipelineStateKeys();
+    return FinishTests();
+}
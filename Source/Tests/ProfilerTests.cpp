@@ -0,0 +1,314 @@
+﻿#include "TestCheck.h"
+#include "Core/FrameTimeStats.h"
+#include "Core/Profiler.h"
+#include <atomic>
+#include <cctype>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// プロファイラのリング（折り返し、溢れたときの破棄数、スレッド間の受け渡し）、
+// Chrome トレースの出力、フレーム時間のパーセンタイルを検証する
+
+namespace {
+
+// JSON として構文が正しいかだけを調べる最小限のパーサ
+class JsonValidator {
+public:
+    explicit JsonValidator(const std::string& json) : text(json) {}
+
+    bool Validate()
+    {
+        SkipSpace();
+        if (!ParseValue()) {
+            return false;
+        }
+        SkipSpace();
+        return position == text.size();
+    }
+
+private:
+    bool ParseValue()
+    {
+        SkipSpace();
+        if (position >= text.size()) {
+            return false;
+        }
+        switch (text[position]) {
+        case '{':
+            return ParseContainer('}', true);
+        case '[':
+            return ParseContainer(']', false);
+        case '"':
+            return ParseString();
+        default:
+            return ParseLiteral();
+        }
+    }
+
+    bool ParseContainer(char close, bool object)
+    {
+        ++position;
+        SkipSpace();
+        if (Consume(close)) {
+            return true;
+        }
+        do {
+            SkipSpace();
+            if (object && !(ParseString() && (SkipSpace(), Consume(':')))) {
+                return false;
+            }
+            if (!ParseValue()) {
+                return false;
+            }
+            SkipSpace();
+        } while (Consume(','));
+        return Consume(close);
+    }
+
+    bool ParseString()
+    {
+        if (!Consume('"')) {
+            return false;
+        }
+        while (position < text.size() && text[position] != '"') {
+            const unsigned char c = static_cast<unsigned char>(text[position]);
+            if (c < 0x20) {
+                return false;
+            }
+            position += c == '\\' ? 2 : 1;
+        }
+        return Consume('"');
+    }
+
+    // 数値と true/false/null
+    bool ParseLiteral()
+    {
+        const size_t start = position;
+        while (position < text.size() && (std::isalnum(static_cast<unsigned char>(text[position])) || text[position] == '.' ||
+                                          text[position] == '-' || text[position] == '+')) {
+            ++position;
+        }
+        return position != start;
+    }
+
+    void SkipSpace()
+    {
+        while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position]))) {
+            ++position;
+        }
+    }
+
+    bool Consume(char c)
+    {
+        if (position < text.size() && text[position] == c) {
+            ++position;
+            return true;
+        }
+        return false;
+    }
+
+    const std::string& text;
+    size_t position = 0;
+};
+
+ProfileEvent MakeEvent(uint64_t sequence)
+{
+    return { "event", sequence, sequence + 1 };
+}
+
+void TestRingWraparound()
+{
+    auto ring = std::make_unique<ProfileEventRing>();
+    ProfileEvent event;
+    CHECK(!ring->Pop(event));
+
+    // 容量の 3/4 ずつ書いて読み、位置が何周も折り返しても順序が保たれること
+    const uint32_t chunk = ProfileEventRing::CAPACITY / 4 * 3;
+    uint64_t written = 0;
+    uint64_t read = 0;
+    bool ordered = true;
+    for (uint32_t round = 0; round < 10; ++round) {
+        for (uint32_t i = 0; i < chunk; ++i) {
+            ordered = ring->Push(MakeEvent(written++)) && ordered;
+        }
+        while (ring->Pop(event)) {
+            ordered = event.startNs == read++ && ordered;
+        }
+    }
+    CHECK(ordered);
+    CHECK(read == written);
+    CHECK(ring->GetDroppedCount() == 0);
+}
+
+void TestRingDrops()
+{
+    auto ring = std::make_unique<ProfileEventRing>();
+    for (uint32_t i = 0; i < ProfileEventRing::CAPACITY; ++i) {
+        CHECK(ring->Push(MakeEvent(i)));
+    }
+    // 満杯の間の書き込みは捨てられ、既存の内容は上書きされない
+    CHECK(!ring->Push(MakeEvent(1000000)));
+    CHECK(!ring->Push(MakeEvent(1000001)));
+    CHECK(ring->GetDroppedCount() == 2);
+
+    ProfileEvent event;
+    CHECK(ring->Pop(event) && event.startNs == 0);
+    CHECK(ring->Push(MakeEvent(ProfileEventRing::CAPACITY)));
+    uint32_t count = 1;
+    uint64_t last = 0;
+    while (ring->Pop(event)) {
+        CHECK(event.startNs == last + 1);
+        last = event.startNs;
+        ++count;
+    }
+    CHECK(count == ProfileEventRing::CAPACITY + 1);
+    CHECK(ring->GetDroppedCount() == 2);
+}
+
+// 書き込みスレッドと読み出しスレッドを同時に動かし、受け取った順序と「受信数 + 破棄数 = 送信数」を確かめる
+void TestRingConcurrent()
+{
+    auto ring = std::make_unique<ProfileEventRing>();
+    constexpr uint64_t EVENT_COUNT = 2000000;
+    std::atomic<bool> finished{ false };
+    std::thread producer([&ring, &finished]() {
+        for (uint64_t i = 0; i < EVENT_COUNT; ++i) {
+            ring->Push(MakeEvent(i));
+        }
+        finished.store(true, std::memory_order_release);
+    });
+
+    uint64_t received = 0;
+    uint64_t previous = 0;
+    bool ordered = true;
+    bool consistent = true;
+    ProfileEvent event;
+    for (;;) {
+        // 書き込みの完了を先に読み、その後に空なら残りはない
+        const bool done = finished.load(std::memory_order_acquire);
+        if (!ring->Pop(event)) {
+            if (done) {
+                break;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+        ordered = (received == 0 || event.startNs > previous) && ordered;
+        consistent = event.endNs == event.startNs + 1 && consistent;
+        previous = event.startNs;
+        ++received;
+    }
+    producer.join();
+    CHECK(ordered);
+    CHECK(consistent);
+    CHECK(received + ring->GetDroppedCount() == EVENT_COUNT);
+}
+
+// Profiler はスレッドローカルにトラックをキャッシュするため、テストの間は破棄しない
+void TestProfilerCapture(Profiler& profiler)
+{
+    profiler.SetThreadName("Main \"thread\"");
+    profiler.Record({ "before capture", 1, 2 });
+    profiler.BeginCapture();
+    CHECK(profiler.GetCapturedEventCount() == 0);
+
+    const uint64_t start = Profiler::Now();
+    profiler.Record({ "Update", start, start + 2500 });
+    profiler.Record({ "Say \"hi\"\n\\", start + 3000, start + 3001 });
+    profiler.RecordGpuEvent({ "Gpu", start + 100, start + 1100 });
+    profiler.SetEnabled(false);
+    profiler.Record({ "disabled", start, start + 1 });
+    profiler.SetEnabled(true);
+    profiler.EndCapture();
+    profiler.Record({ "after capture", start, start + 1 });
+    profiler.Collect();
+    CHECK(profiler.GetCapturedEventCount() == 3);
+
+    std::ostringstream stream;
+    profiler.WriteChromeTrace(stream);
+    const std::string json = stream.str();
+    CHECK(JsonValidator(json).Validate());
+    CHECK(json.find("\"traceEvents\":[") != std::string::npos);
+    CHECK(json.find("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}") != std::string::npos);
+    CHECK(json.find("\"args\":{\"name\":\"Main \\\"thread\\\"\"}") != std::string::npos);
+    CHECK(json.find("{\"name\":\"Update\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":") != std::string::npos);
+    CHECK(json.find(",\"dur\":2.500}") != std::string::npos);
+    CHECK(json.find(",\"dur\":1.000}") != std::string::npos);
+    CHECK(json.find("\"name\":\"Say \\\"hi\\\"\\n\\\\\"") != std::string::npos);
+    CHECK(json.find("before capture") == std::string::npos);
+    CHECK(json.find("after capture") == std::string::npos);
+    CHECK(json.find("disabled") == std::string::npos);
+}
+
+void TestProfilerDroppedCount(Profiler& profiler)
+{
+    for (uint32_t i = 0; i < ProfileEventRing::CAPACITY + 5; ++i) {
+        profiler.Record(MakeEvent(i));
+    }
+    CHECK(profiler.GetDroppedEventCount() == 5);
+    profiler.Collect();
+    profiler.Record(MakeEvent(0));
+    CHECK(profiler.GetDroppedEventCount() == 5);
+}
+
+void TestFrameTimeStats()
+{
+    FrameTimeStats stats;
+    stats.Initialize(100);
+    const FrameTimeSummary empty = stats.GetSummary();
+    CHECK(empty.sampleCount == 0 && empty.averageMs == 0.0 && empty.p99Ms == 0.0 && empty.maxMs == 0.0);
+
+    // 1 ～ 100 を逆順に入れる（最近傍順位法では pN = N）
+    for (int i = 100; i >= 1; --i) {
+        stats.AddSample(static_cast<double>(i));
+    }
+    FrameTimeSummary summary = stats.GetSummary();
+    CHECK(summary.sampleCount == 100);
+    CHECK(summary.averageMs == 50.5);
+    CHECK(summary.p50Ms == 50.0);
+    CHECK(summary.p95Ms == 95.0);
+    CHECK(summary.p99Ms == 99.0);
+    CHECK(summary.maxMs == 100.0);
+
+    // ウィンドウを超えたら古いサンプルから捨てる
+    FrameTimeStats window;
+    window.Initialize(4);
+    for (int i = 1; i <= 6; ++i) {
+        window.AddSample(static_cast<double>(i));
+    }
+    summary = window.GetSummary();
+    CHECK(summary.sampleCount == 4);
+    CHECK(summary.averageMs == 4.5);
+    CHECK(summary.p50Ms == 4.0);
+    CHECK(summary.p95Ms == 6.0);
+    CHECK(summary.maxMs == 6.0);
+    window.Reset();
+    CHECK(window.GetSummary().sampleCount == 0);
+
+    const std::vector<double> sorted = { 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 10.0 };
+    CHECK(GetSortedPercentile(sorted, 0.0) == 1.0);
+    CHECK(GetSortedPercentile(sorted, 10.0) == 1.0);
+    CHECK(GetSortedPercentile(sorted, 11.0) == 2.0);
+    CHECK(GetSortedPercentile(sorted, 95.0) == 10.0);
+    CHECK(GetSortedPercentile(sorted, 100.0) == 10.0);
+    CHECK(GetSortedPercentile({ 7.0 }, 99.0) == 7.0);
+    CHECK(GetSortedPercentile({}, 50.0) == 0.0);
+}
+
+} // namespace
+
+int main()
+{
+    TestRingWraparound();
+    TestRingDrops();
+    TestRingConcurrent();
+    Profiler captureProfiler;
+    TestProfilerCapture(captureProfiler);
+    Profiler dropProfiler;
+    TestProfilerDroppedCount(dropProfiler);
+    TestFrameTimeStats();
+    return FinishTests();
+}
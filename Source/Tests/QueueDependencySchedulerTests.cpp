@@ -0,0 +1,179 @@
+﻿#include "TestCheck.h"
+#include "Render/QueueDependencyScheduler.h"
+#include "Render/RecordingCommandList.h"
+#include <stdexcept>
+
+// QueueDependencyScheduler の依存の省略（同じキュー/完了済み/積み済み）と AddPendingWait、
+// SimulatedGpuQueue による通知されない値への待機（デッドロック）の検出を検証する
+
+namespace {
+
+struct Queues {
+    SimulatedGpuQueue graphics;
+    SimulatedGpuQueue compute;
+    SimulatedGpuQueue copy;
+    QueueDependencyScheduler scheduler;
+
+    Queues()
+    {
+        scheduler.Initialize();
+        scheduler.SetQueue(GpuQueueType::Graphics, &graphics);
+        scheduler.SetQueue(GpuQueueType::Compute, &compute);
+        scheduler.SetQueue(GpuQueueType::Copy, &copy);
+    }
+
+    QueueSyncPoint Submit(GpuQueueType type, const QueueSyncPoint* waits = nullptr, uint32_t waitCount = 0)
+    {
+        return scheduler.Submit(type, nullptr, 0, waits, waitCount);
+    }
+};
+
+template <typename Function>
+bool Throws(Function function)
+{
+    try {
+        function();
+    }
+    catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+void TestElision()
+{
+    Queues queues;
+    const QueueSchedulerStats& stats = queues.scheduler.GetStats();
+
+    // 未完了の別キューへの依存は GPU 上の待機として積む
+    const QueueSyncPoint compute1 = queues.Submit(GpuQueueType::Compute);
+    CHECK(compute1.queue == GpuQueueType::Compute && compute1.value == 1);
+    CHECK(!queues.scheduler.IsComplete(compute1));
+    const QueueSyncPoint graphics1 = queues.Submit(GpuQueueType::Graphics, &compute1, 1);
+    CHECK(stats.waitsRequested == 1 && stats.waitsIssued == 1);
+    CHECK(queues.graphics.GetWaitCount() == 1);
+
+    // 同じキューの依存は投入順に実行されるので積まない
+    queues.Submit(GpuQueueType::Graphics, &graphics1, 1);
+    CHECK(stats.waitsElidedSameQueue == 1);
+    CHECK(queues.graphics.GetWaitCount() == 1);
+
+    // 同じソースの同じ値以下の待機は積み済み（waitedValue >= point.value）
+    queues.Submit(GpuQueueType::Graphics, &compute1, 1);
+    const QueueSyncPoint compute0 = { GpuQueueType::Compute, 0 };
+    queues.Submit(GpuQueueType::Graphics, &compute0, 1); // 値 0 は依存なし（数えない）
+    CHECK(stats.waitsElidedRedundant == 1);
+    CHECK(stats.waitsRequested == 3);
+    CHECK(queues.graphics.GetWaitCount() == 1);
+
+    // 投入時点で完了済みの依存は積まない（別のキューからは初めて待つ場合でも）
+    queues.compute.CompleteSubmittedWork();
+    CHECK(queues.scheduler.IsComplete(compute1));
+    queues.Submit(GpuQueueType::Copy, &compute1, 1);
+    CHECK(stats.waitsElidedCompleted == 1);
+    CHECK(queues.copy.GetWaitCount() == 0);
+
+    // より大きい値は改めて積む
+    const QueueSyncPoint compute2 = queues.Submit(GpuQueueType::Compute);
+    queues.Submit(GpuQueueType::Graphics, &compute2, 1);
+    CHECK(queues.graphics.GetWaitCount() == 2);
+
+    CHECK(stats.waitsRequested == stats.waitsIssued + stats.waitsElidedSameQueue + stats.waitsElidedCompleted + stats.waitsElidedRedundant);
+    CHECK(stats.waitsIssued == 2);
+    CHECK(stats.submits[static_cast<uint32_t>(GpuQueueType::Graphics)] == 5);
+    CHECK(stats.submits[static_cast<uint32_t>(GpuQueueType::Compute)] == 2);
+    CHECK(stats.submits[static_cast<uint32_t>(GpuQueueType::Copy)] == 1);
+    queues.scheduler.ResetStats();
+    CHECK(queues.scheduler.GetStats().waitsRequested == 0);
+}
+
+void TestPendingWaits()
+{
+    Queues queues;
+    const QueueSyncPoint copy1 = queues.Submit(GpuQueueType::Copy);
+    const QueueSyncPoint compute1 = queues.Submit(GpuQueueType::Compute);
+
+    // AddPendingWait は次の Submit まで積まない
+    queues.scheduler.AddPendingWait(GpuQueueType::Graphics, copy1);
+    queues.scheduler.AddPendingWait(GpuQueueType::Graphics, copy1);
+    CHECK(queues.graphics.GetWaitCount() == 0);
+    CHECK(queues.scheduler.GetStats().waitsRequested == 0);
+
+    // 次の投入で引数の依存と合わせて解決し、重複は省略する
+    queues.Submit(GpuQueueType::Graphics, &compute1, 1);
+    CHECK(queues.graphics.GetWaitCount() == 2);
+    CHECK(queues.scheduler.GetStats().waitsRequested == 3);
+    CHECK(queues.scheduler.GetStats().waitsElidedRedundant == 1);
+
+    // 解決した依存は消え、その次の投入には残らない
+    queues.Submit(GpuQueueType::Graphics);
+    CHECK(queues.graphics.GetWaitCount() == 2);
+    CHECK(queues.scheduler.GetStats().waitsRequested == 3);
+
+    // 別のキュー宛ての依存は影響しない
+    queues.scheduler.AddPendingWait(GpuQueueType::Compute, copy1);
+    queues.Submit(GpuQueueType::Graphics);
+    CHECK(queues.compute.GetWaitCount() == 0);
+    queues.Submit(GpuQueueType::Compute);
+    CHECK(queues.compute.GetWaitCount() == 1);
+}
+
+void TestSyncPointsAndCommands()
+{
+    Queues queues;
+    CHECK(queues.scheduler.GetNextSyncPoint(GpuQueueType::Graphics).value == 1);
+    CHECK(queues.scheduler.GetLastSubmitted(GpuQueueType::Graphics).value == 0);
+    CHECK(queues.scheduler.IsComplete(queues.scheduler.GetLastSubmitted(GpuQueueType::Graphics)));
+
+    RecordingCommandList first;
+    first.Begin(0);
+    first.SetPipeline(1);
+    first.End();
+    RecordingCommandList second;
+    second.Begin(0);
+    second.End();
+    ICommandList* lists[] = { &first, &second };
+    const QueueSyncPoint reserved = queues.scheduler.GetNextSyncPoint(GpuQueueType::Graphics);
+    const QueueSyncPoint submitted = queues.scheduler.Submit(GpuQueueType::Graphics, lists, 2);
+    CHECK(submitted.queue == reserved.queue && submitted.value == reserved.value);
+    CHECK(queues.graphics.GetExecutedListCount() == 2);
+    CHECK(queues.graphics.GetExecutedCommandCount() == 5);
+    CHECK(queues.graphics.GetSignaledValue() == 1);
+    CHECK(queues.graphics.GetCompletedValue() == 0);
+    queues.graphics.CompleteSubmittedWork();
+    CHECK(queues.scheduler.IsComplete(submitted));
+}
+
+void TestErrors()
+{
+    // 通知されない値への待機は実際の GPU ではデッドロックになるため例外にする
+    Queues queues;
+    queues.Submit(GpuQueueType::Compute);
+    const QueueSyncPoint never = { GpuQueueType::Compute, 5 };
+    CHECK(Throws([&] { queues.Submit(GpuQueueType::Graphics, &never, 1); }));
+    CHECK(Throws([&] { queues.graphics.Wait(queues.compute, 2); }));
+    // 投入前に予約した同期点を先に待つのも同じ
+    const QueueSyncPoint reserved = queues.scheduler.GetNextSyncPoint(GpuQueueType::Copy);
+    CHECK(Throws([&] { queues.Submit(GpuQueueType::Graphics, &reserved, 1); }));
+    CHECK(!Throws([&] { queues.graphics.Wait(queues.compute, 1); }));
+
+    SimulatedGpuQueue queue;
+    queue.Signal(3);
+    CHECK(Throws([&] { queue.Signal(2); }));
+
+    QueueDependencyScheduler unregistered;
+    unregistered.Initialize();
+    CHECK(!unregistered.HasQueue(GpuQueueType::Compute));
+    CHECK(Throws([&] { unregistered.Submit(GpuQueueType::Compute, nullptr, 0); }));
+}
+
+} // namespace
+
+int main()
+{
+    TestElision();
+    TestPendingWaits();
+    TestSyncPointsAndCommands();
+    TestErrors();
+    return FinishTests();
+}
@@ -0,0 +1,293 @@
+﻿#include "TestCheck.h"
+#include "Render/RecordingCommandList.h"
+#include "Render/RenderGraph.h"
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+// RenderGraph の Compile（パスのカリング、バリアの計画、一時テクスチャの配置）と Execute の記録を検証する
+
+namespace {
+
+constexpr uint64_t MB = 1024 * 1024;
+constexpr ResourceId BACKBUFFER_RESOURCE = 100;
+
+TextureDesc MakeDesc(uint32_t width, uint32_t height, TextureFormat format)
+{
+    TextureDesc desc;
+    desc.width = width;
+    desc.height = height;
+    desc.format = format;
+    return desc;
+}
+
+ResourceBarrier MakeTransition(RenderGraphHandle texture, ResourceState before, ResourceState after, BarrierSplit split = BarrierSplit::None)
+{
+    ResourceBarrier barrier;
+    barrier.split = split;
+    barrier.resource = texture;
+    barrier.before = before;
+    barrier.after = after;
+    return barrier;
+}
+
+ResourceBarrier MakeAliasing(RenderGraphHandle texture, RenderGraphHandle aliasBefore)
+{
+    ResourceBarrier barrier;
+    barrier.type = BarrierType::Aliasing;
+    barrier.resource = texture;
+    barrier.aliasBefore = aliasBefore;
+    return barrier;
+}
+
+bool SameBarrier(const ResourceBarrier& a, const ResourceBarrier& b)
+{
+    if (a.type != b.type || a.resource != b.resource) {
+        return false;
+    }
+    if (a.type == BarrierType::Aliasing) {
+        return a.aliasBefore == b.aliasBefore;
+    }
+    return a.split == b.split && a.before == b.before && a.after == b.after;
+}
+
+void CheckBatch(const RenderGraph& graph, uint32_t batch, const std::vector<ResourceBarrier>& expected)
+{
+    std::vector<ResourceBarrier> barriers;
+    graph.GetPlannedBarriers(batch, barriers);
+    bool same = barriers.size() == expected.size();
+    for (size_t i = 0; same && i < barriers.size(); ++i) {
+        same = SameBarrier(barriers[i], expected[i]);
+    }
+    if (!same) {
+        std::fprintf(stderr, "unexpected barriers before executed pass %u\n", batch);
+    }
+    CHECK(same);
+}
+
+// 区間の重なる一時テクスチャがメモリを共有せず、アライメントとヒープサイズに収まること
+bool PlacementsAreDisjoint(const RenderGraph& graph)
+{
+    const std::vector<TransientPlacement>& placements = graph.GetTransientPlacements();
+    for (size_t i = 0; i < placements.size(); ++i) {
+        const TransientPlacement& a = placements[i];
+        if (a.offset % a.alignment != 0 || a.offset + a.size > graph.GetStats().transientHeapBytes) {
+            return false;
+        }
+        for (size_t j = i + 1; j < placements.size(); ++j) {
+            const TransientPlacement& b = placements[j];
+            const bool lifetimesOverlap = a.firstPass <= b.lastPass && b.firstPass <= a.lastPass;
+            const bool memoryOverlaps = a.offset < b.offset + b.size && b.offset < a.offset + a.size;
+            if (lifetimesOverlap && memoryOverlaps) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// 宣言順のパス（括弧内は実行順の番号）:
+//  0 Unused: U に書く（誰も読まない → カリング）
+//  1 GBuffer (0): A（1MB）、D（256KB）に書く
+//  2 Shadow (1): B（2MB）に書く
+//  3 Lighting (2): A、D を読み、バックバッファに書く
+//  4 Composite (3): B を読み、バックバッファに書く
+//  5 Debug (4): E（1MB）に書く（副作用ありのため残る）
+//  6 Orphan: A を読み、F に書く（誰も読まない → カリング）
+// 配置は大きい順に B → 0、A → 2MB、E → 0（B の後に使う）、D → 3MB になる
+void TestCompile()
+{
+    RenderGraph graph;
+    RenderGraphHandle backbuffer = INVALID_RENDER_GRAPH_HANDLE;
+    RenderGraphHandle u = INVALID_RENDER_GRAPH_HANDLE;
+    RenderGraphHandle a = INVALID_RENDER_GRAPH_HANDLE;
+    RenderGraphHandle d = INVALID_RENDER_GRAPH_HANDLE;
+    RenderGraphHandle b = INVALID_RENDER_GRAPH_HANDLE;
+    RenderGraphHandle e = INVALID_RENDER_GRAPH_HANDLE;
+    std::vector<std::string> executed;
+    const auto record = [&executed](const char* name) {
+        return [&executed, name](RenderPassContext&) { executed.push_back(name); };
+    };
+
+    // 2 回目は Reset 後に容量を再利用して同じ結果になること
+    for (int frame = 0; frame < 2; ++frame) {
+        graph.Reset();
+        executed.clear();
+        backbuffer = graph.ImportTexture("Backbuffer", BACKBUFFER_RESOURCE, BACKBUFFER_RESOURCE, ResourceState::Present, ResourceState::Present);
+        graph.AddPass("Unused", [&](RenderGraphBuilder& builder) {
+            u = builder.CreateTexture("U", MakeDesc(512, 512, TextureFormat::RGBA8Unorm));
+            builder.Write(u, ResourceState::RenderTarget);
+        }, record("Unused"));
+        graph.AddPass("GBuffer", [&](RenderGraphBuilder& builder) {
+            a = builder.CreateTexture("A", MakeDesc(512, 512, TextureFormat::RGBA8Unorm));
+            d = builder.CreateTexture("D", MakeDesc(256, 256, TextureFormat::D32Float));
+            builder.Write(a, ResourceState::RenderTarget);
+            builder.Write(d, ResourceState::DepthWrite);
+        }, record("GBuffer"));
+        graph.AddPass("Shadow", [&](RenderGraphBuilder& builder) {
+            b = builder.CreateTexture("B", MakeDesc(512, 512, TextureFormat::RGBA16Float));
+            builder.Write(b, ResourceState::RenderTarget);
+        }, record("Shadow"));
+        graph.AddPass("Lighting", [&](RenderGraphBuilder& builder) {
+            builder.Read(a, ResourceState::ShaderResource);
+            builder.Read(d, ResourceState::DepthRead);
+            builder.Write(backbuffer, ResourceState::RenderTarget);
+        }, record("Lighting"));
+        graph.AddPass("Composite", [&](RenderGraphBuilder& builder) {
+            builder.Read(b, ResourceState::ShaderResource);
+            builder.Write(backbuffer, ResourceState::RenderTarget);
+        }, record("Composite"));
+        graph.AddPass("Debug", [&](RenderGraphBuilder& builder) {
+            e = builder.CreateTexture("E", MakeDesc(512, 512, TextureFormat::RGBA8Unorm));
+            builder.Write(e, ResourceState::RenderTarget);
+            builder.SetSideEffect();
+        }, record("Debug"));
+        graph.AddPass("Orphan", [&](RenderGraphBuilder& builder) {
+            builder.Read(a, ResourceState::ShaderResource);
+            builder.Write(builder.CreateTexture("F", MakeDesc(64, 64, TextureFormat::RGBA8Unorm)), ResourceState::RenderTarget);
+        }, record("Orphan"));
+        graph.Compile();
+
+        CHECK(graph.IsPassCulled(0));
+        CHECK(!graph.IsPassCulled(1) && !graph.IsPassCulled(2) && !graph.IsPassCulled(3) && !graph.IsPassCulled(4));
+        CHECK(!graph.IsPassCulled(5));
+        CHECK(graph.IsPassCulled(6));
+
+        const RenderGraphStats& stats = graph.GetStats();
+        CHECK(stats.passCount == 7);
+        CHECK(stats.culledPassCount == 2);
+        CHECK(stats.barrierBatchCount == 6);
+        CHECK(stats.barrierCount == 15);
+        CHECK(stats.splitBarrierCount == 5);
+        CHECK(stats.aliasingBarrierCount == 2);
+        CHECK(stats.transientTextureCount == 4);
+        CHECK(stats.transientBytes == 4 * MB + MB / 4);
+        CHECK(stats.transientHeapBytes == 3 * MB + MB / 4);
+
+        // 分割バリアは前回の使用の直後に BeginOnly、次の使用の直前に EndOnly を置く。
+        // 同じ位置では使用を終えた一時テクスチャを戻す遷移を先に発行する
+        CheckBatch(graph, 0, { MakeTransition(backbuffer, ResourceState::Present, ResourceState::RenderTarget, BarrierSplit::BeginOnly) });
+        CheckBatch(graph, 1, {
+            MakeAliasing(b, INVALID_RESOURCE_ID),
+            MakeTransition(a, ResourceState::RenderTarget, ResourceState::ShaderResource, BarrierSplit::BeginOnly),
+            MakeTransition(d, ResourceState::DepthWrite, ResourceState::DepthRead, BarrierSplit::BeginOnly),
+        });
+        CheckBatch(graph, 2, {
+            MakeTransition(a, ResourceState::RenderTarget, ResourceState::ShaderResource, BarrierSplit::EndOnly),
+            MakeTransition(d, ResourceState::DepthWrite, ResourceState::DepthRead, BarrierSplit::EndOnly),
+            MakeTransition(backbuffer, ResourceState::Present, ResourceState::RenderTarget, BarrierSplit::EndOnly),
+            MakeTransition(b, ResourceState::RenderTarget, ResourceState::ShaderResource, BarrierSplit::BeginOnly),
+        });
+        CheckBatch(graph, 3, {
+            MakeTransition(a, ResourceState::ShaderResource, ResourceState::RenderTarget),
+            MakeTransition(d, ResourceState::DepthRead, ResourceState::DepthWrite),
+            MakeTransition(b, ResourceState::RenderTarget, ResourceState::ShaderResource, BarrierSplit::EndOnly),
+        });
+        CheckBatch(graph, 4, {
+            MakeTransition(b, ResourceState::ShaderResource, ResourceState::RenderTarget),
+            MakeAliasing(e, b),
+            MakeTransition(backbuffer, ResourceState::RenderTarget, ResourceState::Present, BarrierSplit::BeginOnly),
+        });
+        CheckBatch(graph, 5, { MakeTransition(backbuffer, ResourceState::RenderTarget, ResourceState::Present, BarrierSplit::EndOnly) });
+
+        const std::vector<TransientPlacement>& placements = graph.GetTransientPlacements();
+        CHECK(placements.size() == 4);
+        for (const TransientPlacement& placement : placements) {
+            CHECK(placement.texture != u);
+            if (placement.texture == a) {
+                CHECK(placement.offset == 2 * MB && placement.firstPass == 0 && placement.lastPass == 2);
+            }
+            else if (placement.texture == d) {
+                CHECK(placement.offset == 3 * MB && placement.firstPass == 0 && placement.lastPass == 2);
+            }
+            else if (placement.texture == b) {
+                CHECK(placement.offset == 0 && placement.firstPass == 1 && placement.lastPass == 3);
+            }
+            else if (placement.texture == e) {
+                CHECK(placement.offset == 0 && placement.firstPass == 4 && placement.lastPass == 4);
+            }
+        }
+        CHECK(PlacementsAreDisjoint(graph));
+
+        // Execute は実行するパスだけを宣言順に呼び、バリアを実体のリソースに置き換えて位置ごとに 1 回で発行する
+        RecordingCommandList commandList;
+        std::vector<ICommandList*> submitLists;
+        RenderPassContext context;
+        context.commandList = &commandList;
+        context.submitLists = &submitLists;
+        std::vector<uint64_t> transientOffsets;
+        graph.Execute(context, [&](const TextureDesc&, ResourceState, uint64_t heapOffset, uint64_t heapSize) {
+            CHECK(heapSize == 3 * MB + MB / 4);
+            transientOffsets.push_back(heapOffset);
+            const ResourceId resource = static_cast<ResourceId>(1000 + transientOffsets.size());
+            return TransientTexture{ resource, resource, INVALID_RESOURCE_ID };
+        });
+        CHECK((executed == std::vector<std::string>{ "GBuffer", "Shadow", "Lighting", "Composite", "Debug" }));
+        CHECK(transientOffsets.size() == 4);
+        uint32_t batchCount = 0;
+        uint32_t barrierCount = 0;
+        bool physical = true;
+        for (const RecordedCommand& command : commandList.GetCommands()) {
+            if (command.type == RecordedCommandType::BarrierBatch) {
+                ++batchCount;
+            }
+            else if (command.type == RecordedCommandType::ResourceBarrier) {
+                ++barrierCount;
+                physical = physical && (command.args[0] == BACKBUFFER_RESOURCE || (command.args[0] > 1000 && command.args[0] <= 1004));
+            }
+        }
+        CHECK(batchCount == 6);
+        CHECK(barrierCount == 15);
+        CHECK(physical);
+    }
+}
+
+// 乱数で作ったグラフでも、区間の重なる一時テクスチャにメモリが重ならない配置になること
+void TestRandomPlacements()
+{
+    std::mt19937 generator(24680);
+    const TextureFormat formats[] = { TextureFormat::RGBA8Unorm, TextureFormat::RGBA16Float, TextureFormat::R32Float, TextureFormat::D32Float };
+    RenderGraph graph;
+    for (uint32_t iteration = 0; iteration < 200; ++iteration) {
+        graph.Reset();
+        std::vector<RenderGraphHandle> textures;
+        textures.push_back(graph.ImportTexture("Output", BACKBUFFER_RESOURCE, BACKBUFFER_RESOURCE, ResourceState::Present, ResourceState::Present));
+        const uint32_t passCount = 2 + generator() % 14;
+        for (uint32_t p = 0; p < passCount; ++p) {
+            graph.AddPass("Pass", [&](RenderGraphBuilder& builder) {
+                const uint32_t reads = generator() % 3;
+                for (uint32_t r = 0; r < reads && textures.size() > 1; ++r) {
+                    builder.Read(textures[1 + generator() % (textures.size() - 1)], ResourceState::ShaderResource);
+                }
+                if (generator() % 4 == 0) {
+                    builder.Write(textures[0], ResourceState::RenderTarget);
+                }
+                else {
+                    const uint32_t size = 64u << (generator() % 5);
+                    const RenderGraphHandle texture = builder.CreateTexture("T", MakeDesc(size, size, formats[generator() % 4]));
+                    builder.Write(texture, ResourceState::RenderTarget);
+                    textures.push_back(texture);
+                }
+            }, {});
+        }
+        graph.Compile([&](const TextureDesc& desc) {
+            // 64KB 以外のアライメントも混ぜる
+            TransientMemoryRequirements requirements = EstimateTextureMemory(desc);
+            if (desc.format == TextureFormat::D32Float) {
+                requirements.alignment = 4 * MB;
+            }
+            return requirements;
+        });
+        CHECK(PlacementsAreDisjoint(graph));
+    }
+}
+
+} // namespace
+
+int main()
+{
+    TestCompile();
+    TestRandomPlacements();
+    return FinishTests();
+}
@@ -0,0 +1,183 @@
+﻿#include "TestCheck.h"
+#include "Render/ResidencyManager.h"
+#include <vector>
+
+// ResidencyManager の LRU による退避（未完了のフレームで使ったリソースは退避しない）、
+// 破棄したリソースの領域がフェンスの完了で解放されること、
+// 段階的な最適化で空にしたヒープが移動元の領域の解放後に破棄されることを SimulatedGpuMemoryBackend 上で検証する
+
+namespace {
+
+constexpr uint64_t KB = 1024;
+constexpr uint64_t RESOURCE_SIZE = 64 * KB;
+
+GpuHeapAllocatorDesc MakeAllocatorDesc()
+{
+    GpuHeapAllocatorDesc desc;
+    desc.smallHeapSize = 1024 * KB;
+    desc.largeHeapSize = 4096 * KB;
+    desc.smallResourceLimit = 256 * KB;
+    desc.dedicatedResourceLimit = 2048 * KB;
+    desc.smallGranularity = 4 * KB;
+    desc.emptyHeapsToKeep = 0;
+    return desc;
+}
+
+// 64KB のバッファを count 個作る
+std::vector<GpuResourceHandle> CreateResources(ResidencyManager& residency, uint32_t count)
+{
+    std::vector<GpuResourceHandle> handles;
+    for (uint32_t i = 0; i < count; ++i) {
+        handles.push_back(residency.CreateResource({ GpuHeapClass::Buffer, RESOURCE_SIZE, 4 * KB, false }));
+    }
+    return handles;
+}
+
+void TestLruEviction()
+{
+    SimulatedGpuMemoryBackend backend;
+    GpuHeapAllocator allocator;
+    allocator.Initialize(&backend, MakeAllocatorDesc());
+    ResidencyManager residency;
+    ResidencyManagerDesc desc;
+    desc.budgetBytes = 4 * RESOURCE_SIZE;
+    desc.defragmentBytesPerFrame = 0;
+    residency.Initialize(&allocator, &backend, desc);
+    const std::vector<GpuResourceHandle> r = CreateResources(residency, 6);
+    const ResidencyStats& stats = residency.GetStats();
+
+    // フレーム 1 で予算ちょうどまで使う
+    residency.BeginFrame(1, 0);
+    for (uint32_t i = 0; i < 4; ++i) {
+        residency.Use(r[i]);
+    }
+    CHECK(stats.residentBytes == 4 * RESOURCE_SIZE && stats.evictions == 0);
+
+    // フレーム 1 が未完了の間は、予算を超えても GPU が参照している可能性のあるリソースを退避しない
+    residency.BeginFrame(2, 0);
+    residency.Use(r[4]);
+    CHECK(stats.evictions == 0 && stats.budgetOverruns == 1);
+    for (uint32_t i = 0; i < 5; ++i) {
+        CHECK(residency.IsResident(r[i]));
+    }
+
+    // フレーム 1 が完了すると、超過分を最も古いものから退避する（r4 はフレーム 2 で使ったので残る）
+    residency.BeginFrame(3, 1);
+    CHECK(!residency.IsResident(r[0]));
+    CHECK(stats.evictions == 1 && stats.residentBytes == 4 * RESOURCE_SIZE);
+    // 使い直した r1 は LRU の末尾へ移り、次の退避は r2 になる
+    residency.Use(r[1]);
+    residency.Use(r[5]);
+    CHECK(!residency.IsResident(r[2]));
+    CHECK(residency.IsResident(r[1]) && residency.IsResident(r[3]) && residency.IsResident(r[4]) && residency.IsResident(r[5]));
+    // 退避したリソースを使い直すと配置し直す（次に古い r3 を退避）
+    residency.Use(r[0]);
+    CHECK(!residency.IsResident(r[3]));
+    CHECK(stats.restores == 1 && stats.evictions == 3);
+
+    // 予算を 0 にしても、完了していないフレーム 3 で使ったリソースは退避しない
+    residency.SetBudget(0);
+    residency.BeginFrame(4, 2);
+    CHECK(!residency.IsResident(r[4]));
+    CHECK(residency.IsResident(r[0]) && residency.IsResident(r[1]) && residency.IsResident(r[5]));
+    CHECK(stats.residentCount == 3);
+    residency.BeginFrame(5, 3);
+    CHECK(stats.residentCount == 0 && stats.residentBytes == 0);
+    CHECK(allocator.GetStats().usedBytes == 0);
+}
+
+void TestDeferredFree()
+{
+    SimulatedGpuMemoryBackend backend;
+    GpuHeapAllocator allocator;
+    allocator.Initialize(&backend, MakeAllocatorDesc());
+    ResidencyManager residency;
+    ResidencyManagerDesc desc;
+    desc.defragmentBytesPerFrame = 0;
+    residency.Initialize(&allocator, &backend, desc);
+    const std::vector<GpuResourceHandle> r = CreateResources(residency, 2);
+    const ResidencyStats& stats = residency.GetStats();
+
+    residency.BeginFrame(5, 3);
+    residency.Use(r[0]);
+    residency.Use(r[1]);
+    // 破棄は常駐数からすぐに除くが、領域はフレーム 5 が完了するまで解放しない
+    residency.DestroyResource(r[0]);
+    CHECK(stats.resourceCount == 1 && stats.residentCount == 1);
+    CHECK(stats.pendingFreeBytes == RESOURCE_SIZE);
+    CHECK(allocator.GetStats().usedBytes == 2 * RESOURCE_SIZE);
+
+    residency.BeginFrame(6, 4);
+    CHECK(stats.pendingFreeBytes == RESOURCE_SIZE);
+    CHECK(allocator.GetStats().usedBytes == 2 * RESOURCE_SIZE);
+    residency.BeginFrame(7, 5);
+    CHECK(stats.pendingFreeBytes == 0);
+    CHECK(allocator.GetStats().usedBytes == RESOURCE_SIZE);
+
+    // 破棄したハンドルは再利用し、新しいリソースとして配置する
+    const GpuResourceHandle reused = residency.CreateResource({ GpuHeapClass::Buffer, RESOURCE_SIZE, 4 * KB, false });
+    CHECK(reused == r[0]);
+    residency.Use(reused);
+    CHECK(stats.restores == 0 && allocator.GetStats().usedBytes == 2 * RESOURCE_SIZE);
+}
+
+// 3 つの 1MB ヒープを 16/16/8 個で埋め、最初のヒープを 2 個、次を 4 個まで減らす。
+// 使用率の最も低い最初のヒープを空にし、移動元の領域が解放された時点でヒープを破棄する
+void TestDefragmentReleasesHeap()
+{
+    SimulatedGpuMemoryBackend backend;
+    GpuHeapAllocator allocator;
+    allocator.Initialize(&backend, MakeAllocatorDesc());
+    ResidencyManager residency;
+    residency.Initialize(&allocator, &backend, ResidencyManagerDesc());
+    std::vector<GpuResourceHandle> r = CreateResources(residency, 40);
+    const ResidencyStats& stats = residency.GetStats();
+
+    residency.BeginFrame(1, 0);
+    for (const GpuResourceHandle handle : r) {
+        residency.Use(handle);
+    }
+    CHECK(allocator.GetStats().heapCount == 3);
+    CHECK(residency.GetAllocation(r[0]).heap == 0 && residency.GetAllocation(r[16]).heap == 1 && residency.GetAllocation(r[39]).heap == 2);
+
+    residency.BeginFrame(2, 1);
+    // 最初のヒープは r0, r1 の 2 個、次のヒープは r28..r31 の 4 個だけ残す
+    for (uint32_t i = 2; i < 28; ++i) {
+        residency.DestroyResource(r[i]);
+    }
+    CHECK(stats.defragmentedHeaps == 0);
+
+    // 破棄した領域が解放された後、最初のヒープの 2 個を他のヒープへ移す
+    residency.BeginFrame(3, 2);
+    CHECK(stats.defragmentedHeaps == 1 && stats.moves == 2 && stats.movedBytes == 2 * RESOURCE_SIZE);
+    CHECK(residency.GetAllocation(r[0]).heap != 0 && residency.GetAllocation(r[1]).heap != 0);
+    CHECK(backend.GetCopiedBytes() == 2 * RESOURCE_SIZE);
+    // 移動元の領域はコピーの完了（フェンス 3）まで残るため、ヒープはまだ破棄しない
+    CHECK(stats.pendingFreeBytes == 2 * RESOURCE_SIZE);
+    CHECK(allocator.GetHeapInfo(0).alive && allocator.GetHeapInfo(0).excluded);
+    CHECK(backend.GetHeapBytes() == 3 * 1024 * KB);
+    residency.BeginFrame(4, 2);
+    CHECK(allocator.GetHeapInfo(0).alive);
+
+    // 除外したヒープには新しい領域を置かない
+    const GpuResourceHandle extra = residency.CreateResource({ GpuHeapClass::Buffer, RESOURCE_SIZE, 4 * KB, false });
+    residency.Use(extra);
+    CHECK(residency.GetAllocation(extra).heap != 0);
+
+    residency.BeginFrame(5, 3);
+    CHECK(stats.pendingFreeBytes == 0);
+    CHECK(!allocator.GetHeapInfo(0).alive);
+    CHECK(allocator.GetStats().heapCount == 2 && allocator.GetStats().heapsDestroyed == 1);
+    CHECK(backend.GetHeapBytes() == 2 * 1024 * KB);
+    CHECK(stats.residentCount == 2 + 12 + 1);
+}
+
+} // namespace
+
+int main()
+{
+    TestLruEviction();
+    TestDeferredFree();
+    TestDefragmentReleasesHeap();
+    return FinishTests();
+}
@@ -0,0 +1,205 @@
+﻿#include "TestCheck.h"
+#include "Render/ShaderCache.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// ShaderCache のキー計算、ディスクへの保存/読み込み、壊れたファイルの破棄を検証する
+
+namespace {
+
+ShaderCompileRequest MakeRequest()
+{
+    ShaderCompileRequest request;
+    request.name = "TestVS";
+    request.source = "float4 main(float4 p : POSITION) : SV_POSITION { return p; }";
+    request.defines = { { "USE_COLOR", "1" }, { "MAX_LIGHTS", "4" } };
+    request.entryPoint = "main";
+    request.profile = "vs_5_0";
+    request.flags = 0x800;
+    return request;
+}
+
+// ShaderCache::GetFilePath と同じ命名（ヘッダに記載したファイル形式の一部）
+std::filesystem::path GetCacheFilePath(const std::filesystem::path& directory, uint64_t key)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.cso", static_cast<unsigned long long>(key));
+    return directory / name;
+}
+
+std::vector<char> ReadFile(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void WriteFile(const std::filesystem::path& path, const std::vector<char>& bytes)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+void TestKeyStability(const std::filesystem::path& directory)
+{
+    ShaderCache cache;
+    cache.Initialize(directory, "compiler-a");
+    ShaderCache sameCompiler;
+    sameCompiler.Initialize(directory, "compiler-a");
+    ShaderCache otherCompiler;
+    otherCompiler.Initialize(directory, "compiler-b");
+
+    const ShaderCompileRequest base = MakeRequest();
+    const uint64_t key = cache.ComputeKey(base);
+    CHECK(cache.ComputeKey(base) == key);
+    CHECK(sameCompiler.ComputeKey(base) == key);
+    CHECK(otherCompiler.ComputeKey(base) != key);
+
+    // 名前はログ用でキーに含めない
+    ShaderCompileRequest renamed = base;
+    renamed.name = "Renamed";
+    CHECK(cache.ComputeKey(renamed) == key);
+
+    ShaderCompileRequest changed = base;
+    changed.source += " ";
+    CHECK(cache.ComputeKey(changed) != key);
+    changed = base;
+    changed.defines[0].first = "USE_COLOUR";
+    CHECK(cache.ComputeKey(changed) != key);
+    changed = base;
+    changed.defines[1].second = "8";
+    CHECK(cache.ComputeKey(changed) != key);
+    changed = base;
+    changed.defines.push_back({ "EXTRA", "" });
+    CHECK(cache.ComputeKey(changed) != key);
+    changed = base;
+    changed.defines.pop_back();
+    CHECK(cache.ComputeKey(changed) != key);
+    changed = base;
+    changed.entryPoint = "mainVS";
+    CHECK(cache.ComputeKey(changed) != key);
+    changed = base;
+    changed.profile = "vs_5_1";
+    CHECK(cache.ComputeKey(changed) != key);
+    changed = base;
+    changed.flags |= 1;
+    CHECK(cache.ComputeKey(changed) != key);
+
+    // フィールドの境界をずらしただけの連結は別キーになる
+    ShaderCompileRequest left = base;
+    left.defines = { { "AB", "C" } };
+    ShaderCompileRequest right = base;
+    right.defines = { { "A", "BC" } };
+    CHECK(cache.ComputeKey(left) != cache.ComputeKey(right));
+}
+
+void TestRoundTrip(const std::filesystem::path& directory)
+{
+    const ShaderCompileRequest request = MakeRequest();
+    const ShaderBytecode compiled = { 0x44, 0x58, 0x42, 0x43, 0x00, 0xff, 0x10, 0x20 };
+    uint32_t compileCalls = 0;
+    const ShaderCompileFunction compile = [&](const ShaderCompileRequest&, ShaderBytecode& bytecode, std::string&) {
+        ++compileCalls;
+        bytecode = compiled;
+        return true;
+    };
+
+    uint64_t key = 0;
+    {
+        ShaderCache cache;
+        cache.Initialize(directory, "compiler-a");
+        key = cache.ComputeKey(request);
+        ShaderBytecode bytecode;
+        std::string errors;
+        CHECK(cache.GetOrCompile(request, compile, bytecode, errors));
+        CHECK(bytecode == compiled);
+        CHECK(cache.GetOrCompile(request, compile, bytecode, errors));
+        const ShaderCacheStats stats = cache.GetStats();
+        CHECK(stats.compiles == 1);
+        CHECK(stats.memoryHits == 1);
+        CHECK(stats.diskHits == 0);
+    }
+    CHECK(std::filesystem::exists(GetCacheFilePath(directory, key)));
+
+    // 別のインスタンス（次回の起動）はディスクから読み、コンパイルしない
+    ShaderCache reloaded;
+    reloaded.Initialize(directory, "compiler-a");
+    ShaderBytecode bytecode;
+    std::string errors;
+    CHECK(reloaded.GetOrCompile(request, compile, bytecode, errors));
+    CHECK(bytecode == compiled);
+    CHECK(compileCalls == 1);
+    CHECK(reloaded.GetStats().diskHits == 1);
+
+    // 空のバイトコードも保存/読み込みできる
+    const uint64_t emptyKey = key ^ 1;
+    CHECK(reloaded.StoreToDisk(emptyKey, {}));
+    ShaderBytecode empty = { 1 };
+    CHECK(reloaded.LoadFromDisk(emptyKey, empty));
+    CHECK(empty.empty());
+
+    // 一時ファイルは残らない
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        CHECK(entry.path().extension() == ".cso");
+    }
+}
+
+// 書き換えたファイルが読み込みで拒否され、削除されて invalidatedFiles に数えられること
+void CheckInvalidated(const std::filesystem::path& directory, const char* label, void (*corrupt)(std::vector<char>& bytes))
+{
+    ShaderCache cache;
+    cache.Initialize(directory, "compiler-a");
+    const uint64_t key = 0x0123456789abcdefull;
+    const ShaderBytecode payload(64, 0x5a);
+    CHECK(cache.StoreToDisk(key, payload));
+    const std::filesystem::path path = GetCacheFilePath(directory, key);
+    std::vector<char> bytes = ReadFile(path);
+    corrupt(bytes);
+    WriteFile(path, bytes);
+
+    ShaderBytecode bytecode;
+    const bool loaded = cache.LoadFromDisk(key, bytecode);
+    if (loaded || std::filesystem::exists(path) || cache.GetStats().invalidatedFiles != 1 || !bytecode.empty()) {
+        std::fprintf(stderr, "invalid cache file was accepted or kept: %s\n", label);
+    }
+    CHECK(!loaded);
+    CHECK(bytecode.empty());
+    CHECK(!std::filesystem::exists(path));
+    CHECK(cache.GetStats().invalidatedFiles == 1);
+}
+
+void TestInvalidFiles(const std::filesystem::path& directory)
+{
+    // ヘッダ: magic(0) / formatVersion(4) / key(8) / payloadSize(16) / payloadHash(24) / payload(32)
+    CheckInvalidated(directory, "payload", [](std::vector<char>& bytes) { bytes[40] ^= 1; });
+    CheckInvalidated(directory, "truncated payload", [](std::vector<char>& bytes) { bytes.resize(bytes.size() - 1); });
+    CheckInvalidated(directory, "truncated header", [](std::vector<char>& bytes) { bytes.resize(12); });
+    CheckInvalidated(directory, "empty", [](std::vector<char>& bytes) { bytes.clear(); });
+    CheckInvalidated(directory, "magic", [](std::vector<char>& bytes) { bytes[0] ^= 1; });
+    CheckInvalidated(directory, "version", [](std::vector<char>& bytes) { bytes[4] = static_cast<char>(ShaderCache::FILE_FORMAT_VERSION + 1); });
+    CheckInvalidated(directory, "key", [](std::vector<char>& bytes) { bytes[8] ^= 1; });
+    CheckInvalidated(directory, "payload size", [](std::vector<char>& bytes) { bytes[16] ^= 1; });
+    CheckInvalidated(directory, "trailing bytes", [](std::vector<char>& bytes) { bytes.push_back(0); });
+
+    // 存在しないファイルは無効化として数えない
+    ShaderCache cache;
+    cache.Initialize(directory, "compiler-a");
+    ShaderBytecode bytecode;
+    CHECK(!cache.LoadFromDisk(0x42, bytecode));
+    CHECK(cache.GetStats().invalidatedFiles == 0);
+}
+
+} // namespace
+
+int main()
+{
+    const std::filesystem::path root = std::filesystem::temp_directory_path() / "ShaderCacheTests";
+    std::filesystem::remove_all(root);
+    TestKeyStability(root / "keys");
+    TestRoundTrip(root / "roundtrip");
+    TestInvalidFiles(root / "invalid");
+    std::filesystem::remove_all(root);
+    return FinishTests();
+}
@@ -0,0 +1,32 @@
+﻿#pragma once
+
+#include <cstdio>
+
+// テスト実行ファイル用の最小限のチェック。失敗した式と場所を表示して数え、終了コードに反映する。
+// 各テストは main から関数を順に呼び出し、最後に FinishTests() の値を返す。
+
+inline int& GetTestFailureCount()
+{
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(expression)                                                                  \
+    do {                                                                                   \
+        if (!(expression)) {                                                               \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #expression); \
+            ++GetTestFailureCount();                                                       \
+        }                                                                                  \
+    } while (false)
+
+// 戻り値: プロセスの終了コード（失敗がなければ 0）
+inline int FinishTests()
+{
+    const int failures = GetTestFailureCount();
+    if (failures != 0) {
+        std::fprintf(stderr, "%d check(s) failed\n", failures);
+        return 1;
+    }
+    std::printf("All checks passed\n");
+    return 0;
+}
@@ -0,0 +1,120 @@
+﻿#include "TestCheck.h"
+#include "Render/TlsfAllocator.h"
+
+// TlsfAllocator の分割と解放時の結合、アライメントの余白の空きリストへの戻し、
+// 切り上げた区分に空きがないときに切り上げ前の区分のリストから収まるブロックを探す経路を検証する
+
+namespace {
+
+constexpr uint64_t GRANULARITY = 256;
+constexpr uint64_t CAPACITY = 256 * GRANULARITY;
+constexpr uint32_t INVALID = TlsfAllocator::INVALID_BLOCK;
+
+void TestSplitAndCoalesce()
+{
+    TlsfAllocator tlsf;
+    tlsf.Initialize(CAPACITY + 100, GRANULARITY);
+    // 末尾の granularity に満たない端数は使わない
+    CHECK(tlsf.GetCapacity() == CAPACITY);
+    CHECK(tlsf.GetFreeBlockCount() == 1);
+
+    // 大きさは granularity に切り上げ、空きブロックの先頭から切り出して残りを空きに戻す
+    const uint32_t a = tlsf.Allocate(1000, 1);
+    const uint32_t b = tlsf.Allocate(3000, 1);
+    const uint32_t c = tlsf.Allocate(512, 1);
+    CHECK(tlsf.GetOffset(a) == 0 && tlsf.GetSize(a) == 1024);
+    CHECK(tlsf.GetOffset(b) == 1024 && tlsf.GetSize(b) == 3072);
+    CHECK(tlsf.GetOffset(c) == 4096 && tlsf.GetSize(c) == 512);
+    CHECK(tlsf.GetUsedSize() == 4608 && tlsf.GetAllocationCount() == 3);
+    CHECK(tlsf.GetFreeBlockCount() == 1);
+    CHECK(tlsf.GetLargestFreeBlock() == CAPACITY - 4608);
+
+    // 隣が使用中なら結合しない
+    tlsf.Free(a);
+    CHECK(tlsf.GetFreeBlockCount() == 2);
+    // 後ろの空きブロックと結合
+    tlsf.Free(c);
+    CHECK(tlsf.GetFreeBlockCount() == 2);
+    CHECK(tlsf.GetLargestFreeBlock() == CAPACITY - 4096);
+    // 前後の両方と結合して範囲全体の 1 ブロックに戻る
+    tlsf.Free(b);
+    CHECK(tlsf.GetFreeBlockCount() == 1);
+    CHECK(tlsf.GetLargestFreeBlock() == CAPACITY);
+    CHECK(tlsf.GetUsedSize() == 0 && tlsf.GetAllocationCount() == 0);
+
+    // 結合したブロックから再び先頭に切り出せる
+    const uint32_t whole = tlsf.Allocate(CAPACITY, 1);
+    CHECK(whole != INVALID && tlsf.GetOffset(whole) == 0);
+    CHECK(tlsf.GetFreeBlockCount() == 0);
+    CHECK(tlsf.Allocate(1, 1) == INVALID);
+    tlsf.Free(whole);
+    CHECK(tlsf.GetFreeBlockCount() == 1);
+}
+
+void TestAlignmentPadding()
+{
+    TlsfAllocator tlsf;
+    tlsf.Initialize(CAPACITY, GRANULARITY);
+    const uint32_t head = tlsf.Allocate(GRANULARITY, 1);
+    CHECK(tlsf.GetOffset(head) == 0);
+
+    // 先頭を 4096 にそろえるため [256, 4096) を余白として空きリストへ戻す
+    const uint32_t aligned = tlsf.Allocate(1024, 4096);
+    CHECK(tlsf.GetOffset(aligned) == 4096);
+    CHECK(tlsf.GetUsedSize() == GRANULARITY + 1024);
+    CHECK(tlsf.GetFreeBlockCount() == 2);
+
+    // 余白はちょうどの大きさの確保に使える
+    const uint32_t padding = tlsf.Allocate(4096 - GRANULARITY, 1);
+    CHECK(padding != INVALID && tlsf.GetOffset(padding) == GRANULARITY);
+    CHECK(tlsf.GetFreeBlockCount() == 1);
+
+    // 解放すると余白だった領域も含めて 1 ブロックに戻る
+    tlsf.Free(aligned);
+    tlsf.Free(head);
+    CHECK(tlsf.GetFreeBlockCount() == 2);
+    tlsf.Free(padding);
+    CHECK(tlsf.GetFreeBlockCount() == 1);
+    CHECK(tlsf.GetLargestFreeBlock() == CAPACITY);
+}
+
+// 35 単位の要求は 36 単位以上の区分から探すため、同じ区分 [34, 35] にある 35 単位の空きブロックを見落とす。
+// その場合は切り上げ前の区分のリストをたどって（先頭の 34 単位を飛ばして）収まるブロックを使う
+void TestUnroundedClassFallback()
+{
+    TlsfAllocator tlsf;
+    tlsf.Initialize(CAPACITY, GRANULARITY);
+    const uint32_t fits = tlsf.Allocate(35 * GRANULARITY, 1);
+    const uint32_t separator1 = tlsf.Allocate(GRANULARITY, 1);
+    const uint32_t tooSmall = tlsf.Allocate(34 * GRANULARITY, 1);
+    const uint32_t separator2 = tlsf.Allocate(GRANULARITY, 1);
+    // 残り 185 単位もちょうどの大きさなので同じ経路で見つかる
+    const uint32_t rest = tlsf.Allocate(CAPACITY - 71 * GRANULARITY, 1);
+    CHECK(rest != INVALID);
+    CHECK(tlsf.GetFreeBlockCount() == 0);
+
+    tlsf.Free(fits);
+    tlsf.Free(tooSmall);
+    CHECK(tlsf.GetFreeBlockCount() == 2);
+    CHECK(tlsf.Allocate(36 * GRANULARITY, 1) == INVALID);
+    const uint32_t block = tlsf.Allocate(35 * GRANULARITY, 1);
+    CHECK(block != INVALID && tlsf.GetOffset(block) == 0);
+    CHECK(tlsf.GetFreeBlockCount() == 1);
+
+    tlsf.Free(block);
+    tlsf.Free(separator1);
+    tlsf.Free(separator2);
+    tlsf.Free(rest);
+    CHECK(tlsf.GetFreeBlockCount() == 1);
+    CHECK(tlsf.GetUsedSize() == 0);
+}
+
+} // namespace
+
+int main()
+{
+    TestSplitAndCoalesce();
+    TestAlignmentPadding();
+    TestUnroundedClassFallback();
+    return FinishTests();
+}
@@ -0,0 +1,115 @@
+﻿#include "TestCheck.h"
+#include "Core/TripleBuffer.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+// TripleBuffer の受け渡し（最新の値だけが届く、書き込み先が読み出し中のバッファと重ならない）と、
+// 別スレッドで書き込みと読み出しを続けても、読み出し側が書きかけの値や前に見た値より古い値を見ないことを検証する
+
+namespace {
+
+// 全要素が sequence から決まる値（1 つでも食い違えば書きかけ）
+struct Snapshot {
+    uint64_t sequence = 0;
+    uint64_t values[31] = {};
+
+    void Fill(uint64_t value)
+    {
+        sequence = value;
+        for (uint64_t i = 0; i < 31; ++i) {
+            values[i] = value * 31 + i;
+        }
+    }
+
+    bool IsConsistent() const
+    {
+        for (uint64_t i = 0; i < 31; ++i) {
+            if (values[i] != sequence * 31 + i) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+void TestHandoff()
+{
+    TripleBuffer<Snapshot> buffer;
+    CHECK(!buffer.Acquire());
+    CHECK(buffer.GetReadBuffer().sequence == 0);
+
+    buffer.GetWriteBuffer().Fill(1);
+    buffer.Publish();
+    CHECK(buffer.Acquire());
+    CHECK(buffer.GetReadBuffer().sequence == 1);
+    // 新しい公開がなければ前回の値のまま
+    CHECK(!buffer.Acquire());
+    CHECK(buffer.GetReadBuffer().sequence == 1);
+
+    // 読まれなかった値は次の公開で上書きされ、最新だけが届く
+    buffer.GetWriteBuffer().Fill(2);
+    buffer.Publish();
+    buffer.GetWriteBuffer().Fill(3);
+    buffer.Publish();
+    CHECK(buffer.Acquire());
+    CHECK(buffer.GetReadBuffer().sequence == 3);
+
+    // 書き込み先は読み出し中のバッファとも受け渡し待ちのバッファとも重ならない
+    buffer.GetWriteBuffer().Fill(4);
+    buffer.Publish();
+    CHECK(&buffer.GetWriteBuffer() != &buffer.GetReadBuffer());
+    buffer.GetWriteBuffer().Fill(99);
+    CHECK(buffer.GetReadBuffer().sequence == 3);
+    CHECK(buffer.Acquire());
+    CHECK(buffer.GetReadBuffer().sequence == 4);
+    CHECK(buffer.GetReadBuffer().IsConsistent());
+}
+
+void TestConcurrentHandoff()
+{
+    constexpr uint64_t PUBLISH_COUNT = 200000;
+    TripleBuffer<Snapshot> buffer;
+    std::thread writer([&buffer]() {
+        for (uint64_t sequence = 1; sequence <= PUBLISH_COUNT; ++sequence) {
+            buffer.GetWriteBuffer().Fill(sequence);
+            buffer.Publish();
+        }
+    });
+
+    uint64_t lastSequence = 0;
+    uint64_t acquired = 0;
+    uint64_t torn = 0;
+    uint64_t older = 0;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (lastSequence != PUBLISH_COUNT && std::chrono::steady_clock::now() < deadline) {
+        if (!buffer.Acquire()) {
+            continue;
+        }
+        ++acquired;
+        const Snapshot& snapshot = buffer.GetReadBuffer();
+        torn += snapshot.IsConsistent() ? 0 : 1;
+        older += snapshot.sequence <= lastSequence ? 1 : 0;
+        lastSequence = snapshot.sequence;
+    }
+    writer.join();
+    if (torn != 0 || older != 0) {
+        std::fprintf(stderr, "%llu acquires: %llu torn, %llu not newer\n", static_cast<unsigned long long>(acquired),
+                     static_cast<unsigned long long>(torn), static_cast<unsigned long long>(older));
+    }
+    CHECK(torn == 0);
+    CHECK(older == 0);
+    // 最後の公開は必ず届く
+    CHECK(lastSequence == PUBLISH_COUNT);
+    CHECK(!buffer.Acquire());
+}
+
+} // namespace
+
+int main()
+{
+    TestHandoff();
+    TestConcurrentHandoff();
+    return FinishTests();
+}
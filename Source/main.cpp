@@ -1,16 +1,57 @@
-﻿#include <windows.h>
-#include <exception>
+﻿#include <exception>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Benchmark/HeadlessBenchmark.h"
+#include "Core/JobSystem.h"
+#include "Core/Profiler.h"
+#include "Scene/SampleScenes.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <shellapi.h>
+#include <cwchar>
 #include "Render/DirectXMain.h"
 
+#pragma comment(lib, "shell32.lib")
+
 constexpr UINT WIDTH = 1280;
 constexpr UINT HEIGHT = 720;
+// F9 で開始/停止したプロファイルの書き出し先（chrome://tracing や Perfetto で開く）
+constexpr const wchar_t* PROFILE_TRACE_PATH = L"ProfileTrace.json";
+// 同じキャプチャ区間のフレーム時間（--headless --pacing-trace で再生できる）
+constexpr const wchar_t* FRAME_TIME_TRACE_PATH = L"FrameTimes.csv";
+// ウィンドウタイトルのフレーム時間統計を更新する間隔
+constexpr uint64_t STATS_TITLE_INTERVAL_NS = 1000000000ull;
 
 bool g_isRunning = true;
+// WM_SIZE で受け取り、次のフレームの前にスワップチェーンへ反映するクライアント領域のサイズ
+UINT g_pendingWidth = 0;
+UINT g_pendingHeight = 0;
+bool g_resizePending = false;
+bool g_isMinimized = false;
 
 LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam);
+void ToggleProfileCapture();
+void UpdateStatsTitle(HWND hwnd);
+std::vector<std::string> GetCommandLineArgs();
 
 int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine, int nCmdShow)
 {
+    // --headless / --list-scenes はウィンドウを作らずにベンチマークとして実行する
+    BenchmarkOptions options;
+    try {
+        options = ParseBenchmarkOptions(GetCommandLineArgs());
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    if (options.headless || options.listScenes) {
+        return RunHeadlessBenchmark(options);
+    }
+
     const wchar_t CLASS_NAME[] = L"DX12GameWindowClass";
 
     WNDCLASSEXW wc = {};
@@ -43,8 +84,19 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine
         return 0;
     }
 
+    // 描画コマンドの並列記録や Update() から使用するジョブシステムを起動
+    GetProfiler().SetThreadName("Main");
+    GetJobSystem().Initialize(options.threads);
+
     try {
-        InitD3D12(hwnd, WIDTH, HEIGHT);
+        RegisterSampleScenes(GetSceneRegistry());
+        InitD3D12(hwnd, WIDTH, HEIGHT, options.framesInFlight, options.presentMode);
+        LoadScene(options.scene.empty() ? DEFAULT_SCENE_NAME : options.scene);
+        if (options.dynamicResolution) {
+            DynamicResolutionSettings resolutionSettings;
+            resolutionSettings.targetFrameMs = options.targetFrameMs;
+            GetD3D12Context().renderer.EnableDynamicResolution(resolutionSettings);
+        }
     }
     catch (const std::exception& e) {
         MessageBoxA(hwnd, e.what(), "DirectX12 Initialization Failed", MB_OK | MB_ICONERROR);
@@ -54,25 +106,44 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine
     ShowWindow(hwnd, nCmdShow ? nCmdShow : SW_SHOWDEFAULT);
     UpdateWindow(hwnd);
 
-    // Game loop with PeekMessage for non-blocking message processing
+    // Game loop: 溜まっているメッセージをすべて処理してから 1 フレーム描画する。
+    // ゲームロジックはシミュレーションスレッドが固定刻みで更新するため、入力が集中しても
+    // 描画が止まることはなく、シミュレーションの速度もフレームレートに依存しない。
     MSG msg = {};
     while (g_isRunning) {
-        if (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
+        while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE)) {
             if (msg.message == WM_QUIT) {
                 g_isRunning = false;
+                break;
             }
             TranslateMessage(&msg);
             DispatchMessageW(&msg);
         }
-        else {
-            // Game update and render when no messages to process
-            Update();
-            Render();
+        if (!g_isRunning) {
+            break;
+        }
+        // 最小化中はバックバッファのサイズが 0 になるため描画しない
+        if (g_isMinimized) {
+            WaitMessage();
+            continue;
         }
+        if (g_resizePending) {
+            g_resizePending = false;
+            try {
+                ResizeSwapChain(g_pendingWidth, g_pendingHeight);
+            }
+            catch (const std::exception& e) {
+                MessageBoxA(hwnd, e.what(), "DirectX12 Resize Failed", MB_OK | MB_ICONERROR);
+                break;
+            }
+        }
+        Render();
+        UpdateStatsTitle(hwnd);
     }
 
-    WaitForPreviousFrame();
+    WaitForGpuIdle();
     CleanupD3D12();
+    GetJobSystem().Shutdown();
 
     return static_cast<int>(msg.wParam);
 }
@@ -83,17 +154,109 @@ LRESULT CALLBACK WndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM lParam)
     case WM_DESTROY:
         PostQuitMessage(0);
         return 0;
+    case WM_SIZE:
+        // サイズ変更中は連続して届くため、ここでは記録だけ行い、ゲームループで 1 回だけ作り直す
+        g_isMinimized = wParam == SIZE_MINIMIZED;
+        if (!g_isMinimized) {
+            g_pendingWidth = LOWORD(lParam);
+            g_pendingHeight = HIWORD(lParam);
+            g_resizePending = true;
+        }
+        return 0;
     case WM_KEYDOWN:
         if (wParam == VK_ESCAPE) {
             PostQuitMessage(0);
         }
+        else if (wParam == VK_F9) {
+            ToggleProfileCapture();
+        }
         return 0;
     default:
         return DefWindowProc(hwnd, msg, wParam, lParam);
     }
 }
 
+// プロファイルのキャプチャを開始/停止し、停止時に Chrome トレースとフレーム時間の CSV を書き出す
+void ToggleProfileCapture()
+{
+    Profiler& profiler = GetProfiler();
+    auto& ctx = GetD3D12Context();
+    if (!profiler.IsCapturing()) {
+        ctx.frameTimeTrace.clear();
+        profiler.BeginCapture();
+        return;
+    }
+    profiler.EndCapture();
+    if (!profiler.WriteChromeTrace(PROFILE_TRACE_PATH)) {
+        OutputDebugStringW(L"Failed to write profile trace\n");
+    }
+    if (!WriteFrameTimeTrace(FRAME_TIME_TRACE_PATH, ctx.frameTimeTrace)) {
+        OutputDebugStringW(L"Failed to write frame time trace\n");
+    }
+}
+
+// 直近のフレーム時間（CPU）のパーセンタイル、GPU 時間、描画解像度をウィンドウタイトルに表示する
+void UpdateStatsTitle(HWND hwnd)
+{
+    static uint64_t lastUpdateNs = 0;
+    const uint64_t now = Profiler::Now();
+    if (now - lastUpdateNs < STATS_TITLE_INTERVAL_NS) {
+        return;
+    }
+    lastUpdateNs = now;
+
+    const auto& ctx = GetD3D12Context();
+    const FrameTimeSummary summary = ctx.renderer.GetFrameTimeStats().GetSummary();
+    const FrameRenderStats& stats = ctx.renderer.GetLastFrameStats();
+    wchar_t title[256];
+    swprintf(title, 256, L"DirectX12 Game Loop [%hs] - p50 %.2f ms / p95 %.2f ms / p99 %.2f ms / GPU %.2f ms / delay %.2f ms / %ux%u (%.0f%%)%ls",
+             GetPresentModeName(ctx.presentMode), summary.p50Ms, summary.p95Ms, summary.p99Ms, ctx.backend.GetLastGpuFrameTimeMs(),
+             ctx.presentMode == PresentMode::LowLatency ? ctx.pacing.GetFrameStartDelayMs() : 0.0,
+             stats.renderWidth, stats.renderHeight, stats.renderScale * 100.0f,
+             GetProfiler().IsCapturing() ? L" [capturing]" : L"");
+    SetWindowTextW(hwnd, title);
+}
+
+// プログラム名を除いたコマンドライン引数を UTF-8 で返す
+std::vector<std::string> GetCommandLineArgs()
+{
+    std::vector<std::string> args;
+    int argc = 0;
+    LPWSTR* argv = CommandLineToArgvW(GetCommandLineW(), &argc);
+    if (!argv) {
+        return args;
+    }
+    for (int i = 1; i < argc; ++i) {
+        const int size = WideCharToMultiByte(CP_UTF8, 0, argv[i], -1, nullptr, 0, nullptr, nullptr);
+        std::string arg(size > 0 ? size - 1 : 0, '\0');
+        if (size > 1) {
+            WideCharToMultiByte(CP_UTF8, 0, argv[i], -1, arg.data(), size, nullptr, nullptr);
+        }
+        args.push_back(std::move(arg));
+    }
+    LocalFree(argv);
+    return args;
+}
+
 int main()
 {
     return wWinMain(GetModuleHandleW(nullptr), nullptr, GetCommandLineW(), SW_SHOWDEFAULT);
 }
+
+#else
+
+// Windows 以外ではヘッドレスのベンチマークのみ実行できる
+int main(int argc, char** argv)
+{
+    BenchmarkOptions options;
+    try {
+        options = ParseBenchmarkOptions(std::vector<std::string>(argv + 1, argv + argc));
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return RunHeadlessBenchmark(options);
+}
+
+#endif